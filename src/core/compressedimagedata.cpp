@@ -0,0 +1,576 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: compressedimagedata.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the per-slice lossless volume compression
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "compressedimagedata.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <type_traits>
+
+#include <vtkDataArray.h>
+#include <vtkMatrix3x3.h>
+#include <vtkPointData.h>
+
+namespace
+{
+        // Residuals share one Rice parameter per block
+        constexpr int kBlockSamples = 32;
+        // Quotients this long are written as the bit length and the value instead
+        constexpr std::uint64_t kEscapeQuotient = 32;
+        constexpr int kMaxRiceParameter = 56;
+        // Whole numbers beyond this are left raw so residuals stay far from overflow
+        constexpr double kMaxIntegralMagnitude = 2147483648.0;
+
+        constexpr std::uint8_t kSliceCoded = 0;
+        constexpr std::uint8_t kSliceRaw = 1;
+
+        std::uint64_t lowMask(int t_bits)
+        {
+                return t_bits >= 64 ? ~0ULL : ((1ULL << t_bits) - 1ULL);
+        }
+
+        std::uint64_t zigzag(std::int64_t t_value)
+        {
+                return (static_cast<std::uint64_t>(t_value) << 1) ^ static_cast<std::uint64_t>(t_value >> 63);
+        }
+
+        std::int64_t unzigzag(std::uint64_t t_value)
+        {
+                return static_cast<std::int64_t>(t_value >> 1) ^ -static_cast<std::int64_t>(t_value & 1ULL);
+        }
+
+        // Median edge detector of LOCO-I: left, above and above-left neighbours
+        std::int64_t predict(std::int64_t t_left, std::int64_t t_above, std::int64_t t_aboveLeft)
+        {
+                const auto [low, high] = std::minmax(t_left, t_above);
+                if (t_aboveLeft >= high)
+                {
+                        return low;
+                }
+                if (t_aboveLeft <= low)
+                {
+                        return high;
+                }
+                return t_left + t_above - t_aboveLeft;
+        }
+
+        class BitWriter
+        {
+        public:
+                explicit BitWriter(std::vector<std::uint8_t>& t_bytes) : m_bytes(t_bytes) {}
+
+                // Up to 56 bits go in one step
+                void write(std::uint64_t t_bits, int t_count)
+                {
+                        if (t_count <= 56)
+                        {
+                                writeShort(t_bits, t_count);
+                                return;
+                        }
+                        while (t_count > 32)
+                        {
+                                writeShort(t_bits, 32);
+                                t_bits >>= 32;
+                                t_count -= 32;
+                        }
+                        writeShort(t_bits, t_count);
+                }
+
+                void writeOnes(std::uint64_t t_count)
+                {
+                        for (; t_count >= 32; t_count -= 32)
+                        {
+                                writeShort(0xFFFFFFFFULL, 32);
+                        }
+                        writeShort(lowMask(static_cast<int>(t_count)), static_cast<int>(t_count));
+                }
+
+                void flush()
+                {
+                        if (m_used > 0)
+                        {
+                                m_bytes.push_back(static_cast<std::uint8_t>(m_accumulator));
+                        }
+                        m_accumulator = 0;
+                        m_used = 0;
+                }
+
+        private:
+                std::vector<std::uint8_t>& m_bytes;
+                std::uint64_t m_accumulator = 0;
+                int m_used = 0;
+
+                void writeShort(std::uint64_t t_bits, int t_count)
+                {
+                        m_accumulator |= (t_bits & lowMask(t_count)) << m_used;
+                        m_used += t_count;
+                        while (m_used >= 8)
+                        {
+                                m_bytes.push_back(static_cast<std::uint8_t>(m_accumulator));
+                                m_accumulator >>= 8;
+                                m_used -= 8;
+                        }
+                }
+        };
+
+        class BitReader
+        {
+        public:
+                BitReader(const std::uint8_t* t_data, std::size_t t_size) : m_data(t_data), m_size(t_size) {}
+
+                std::uint64_t read(int t_count)
+                {
+                        std::uint64_t value = 0;
+                        int shift = 0;
+                        while (t_count > 32)
+                        {
+                                value |= readShort(32) << shift;
+                                shift += 32;
+                                t_count -= 32;
+                        }
+                        return value | (readShort(t_count) << shift);
+                }
+
+                // Ones up to the first zero (consumed), or t_limit ones
+                std::uint64_t readOnes(std::uint64_t t_limit)
+                {
+                        std::uint64_t count = 0;
+                        while (count < t_limit)
+                        {
+                                if (m_available == 0)
+                                {
+                                        refill();
+                                }
+                                if ((m_accumulator & 1ULL) == 0)
+                                {
+                                        m_accumulator >>= 1;
+                                        --m_available;
+                                        break;
+                                }
+                                m_accumulator >>= 1;
+                                --m_available;
+                                ++count;
+                        }
+                        return count;
+                }
+
+        private:
+                const std::uint8_t* m_data = nullptr;
+                std::size_t m_size = 0;
+                std::size_t m_position = 0;
+                std::uint64_t m_accumulator = 0;
+                int m_available = 0;
+
+                void refill()
+                {
+                        // Past the end reads zeros, which ends any unary run
+                        while (m_available <= 56)
+                        {
+                                const std::uint64_t byte = m_position < m_size ? m_data[m_position] : 0;
+                                ++m_position;
+                                m_accumulator |= byte << m_available;
+                                m_available += 8;
+                        }
+                }
+
+                std::uint64_t readShort(int t_count)
+                {
+                        if (m_available < t_count)
+                        {
+                                refill();
+                        }
+                        const std::uint64_t value = m_accumulator & lowMask(t_count);
+                        m_accumulator = t_count >= 64 ? 0 : (m_accumulator >> t_count);
+                        m_available -= t_count;
+                        return value;
+                }
+        };
+
+        int riceParameter(const std::uint64_t* t_values, int t_count)
+        {
+                std::uint64_t sum = 0;
+                for (int index = 0; index < t_count; ++index)
+                {
+                        sum += t_values[index];
+                }
+                int parameter = 0;
+                while (parameter < kMaxRiceParameter
+                        && (static_cast<std::uint64_t>(t_count) << (parameter + 1)) <= sum)
+                {
+                        ++parameter;
+                }
+                return parameter;
+        }
+
+        void writeBlock(BitWriter& t_writer, const std::uint64_t* t_values, int t_count)
+        {
+                const int parameter = riceParameter(t_values, t_count);
+                t_writer.write(static_cast<std::uint64_t>(parameter), 6);
+                for (int index = 0; index < t_count; ++index)
+                {
+                        const std::uint64_t value = t_values[index];
+                        const std::uint64_t quotient = value >> parameter;
+                        if (quotient < kEscapeQuotient)
+                        {
+                                // Unary quotient, its terminating zero and the remainder in one write
+                                const int length = static_cast<int>(quotient) + 1 + parameter;
+                                if (length <= 56)
+                                {
+                                        t_writer.write(lowMask(static_cast<int>(quotient))
+                                                | ((value & lowMask(parameter)) << (quotient + 1)), length);
+                                }
+                                else
+                                {
+                                        t_writer.writeOnes(quotient);
+                                        t_writer.write(0, 1);
+                                        t_writer.write(value, parameter);
+                                }
+                                continue;
+                        }
+                        int bits = 1;
+                        while (bits < 64 && (value >> bits) != 0)
+                        {
+                                ++bits;
+                        }
+                        t_writer.writeOnes(kEscapeQuotient);
+                        t_writer.write(static_cast<std::uint64_t>(bits - 1), 6);
+                        t_writer.write(value, bits);
+                }
+        }
+
+        void readBlock(BitReader& t_reader, std::uint64_t* t_values, int t_count)
+        {
+                const int parameter = static_cast<int>(t_reader.read(6));
+                for (int index = 0; index < t_count; ++index)
+                {
+                        const std::uint64_t quotient = t_reader.readOnes(kEscapeQuotient);
+                        if (quotient < kEscapeQuotient)
+                        {
+                                t_values[index] = (quotient << parameter) | t_reader.read(parameter);
+                                continue;
+                        }
+                        const int bits = static_cast<int>(t_reader.read(6)) + 1;
+                        t_values[index] = t_reader.read(bits);
+                }
+        }
+
+        template <typename T>
+        bool isCodable(const T* t_samples, std::size_t t_count)
+        {
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                        for (std::size_t index = 0; index < t_count; ++index)
+                        {
+                                const double value = static_cast<double>(t_samples[index]);
+                                if (!(std::abs(value) < kMaxIntegralMagnitude) || value != std::floor(value)
+                                        || (value == 0.0 && std::signbit(value)))
+                                {
+                                        return false;
+                                }
+                        }
+                        return true;
+                }
+                else
+                {
+                        return sizeof(T) <= 4;
+                }
+        }
+
+        // Visits the samples of a slice in raster order with their prediction
+        template <typename T, typename Visitor>
+        void forEachPrediction(T* t_samples, int t_width, int t_height, int t_components, Visitor&& t_visit)
+        {
+                const std::size_t row = static_cast<std::size_t>(t_width) * static_cast<std::size_t>(t_components);
+                const std::size_t pixel = static_cast<std::size_t>(t_components);
+                for (int y = 0; y < t_height; ++y)
+                {
+                        T* const current = t_samples + row * static_cast<std::size_t>(y);
+                        const T* const above = y > 0 ? current - row : nullptr;
+                        for (std::size_t index = 0; index < row; ++index)
+                        {
+                                std::int64_t prediction = 0;
+                                if (index >= pixel && above)
+                                {
+                                        prediction = predict(static_cast<std::int64_t>(current[index - pixel]),
+                                                static_cast<std::int64_t>(above[index]),
+                                                static_cast<std::int64_t>(above[index - pixel]));
+                                }
+                                else if (index >= pixel)
+                                {
+                                        prediction = static_cast<std::int64_t>(current[index - pixel]);
+                                }
+                                else if (above)
+                                {
+                                        prediction = static_cast<std::int64_t>(above[index]);
+                                }
+                                t_visit(current[index], prediction);
+                        }
+                }
+        }
+
+        template <typename T>
+        void encodeSlice(const T* t_samples, int t_width, int t_height, int t_components,
+                std::vector<std::uint8_t>& t_block)
+        {
+                const std::size_t count = static_cast<std::size_t>(t_width) * static_cast<std::size_t>(t_height)
+                        * static_cast<std::size_t>(t_components);
+                const std::size_t rawBytes = count * sizeof(T);
+                const auto storeRaw = [&]()
+                {
+                        t_block.assign(1, kSliceRaw);
+                        t_block.resize(1 + rawBytes);
+                        std::memcpy(t_block.data() + 1, t_samples, rawBytes);
+                };
+                if (!isCodable(t_samples, count))
+                {
+                        storeRaw();
+                        return;
+                }
+
+                t_block.assign(1, kSliceCoded);
+                BitWriter writer(t_block);
+                std::uint64_t residuals[kBlockSamples];
+                int buffered = 0;
+                forEachPrediction(const_cast<T*>(t_samples), t_width, t_height, t_components,
+                        [&](const T& t_sample, std::int64_t t_prediction)
+                        {
+                                residuals[buffered++] = zigzag(static_cast<std::int64_t>(t_sample) - t_prediction);
+                                if (buffered == kBlockSamples)
+                                {
+                                        writeBlock(writer, residuals, buffered);
+                                        buffered = 0;
+                                }
+                        });
+                if (buffered > 0)
+                {
+                        writeBlock(writer, residuals, buffered);
+                }
+                writer.flush();
+
+                if (t_block.size() > 1 + rawBytes)
+                {
+                        storeRaw();
+                }
+                t_block.shrink_to_fit();
+        }
+
+        template <typename T>
+        void decodeSlice(const std::uint8_t* t_data, std::size_t t_size,
+                T* t_samples, int t_width, int t_height, int t_components)
+        {
+                const std::size_t count = static_cast<std::size_t>(t_width) * static_cast<std::size_t>(t_height)
+                        * static_cast<std::size_t>(t_components);
+                BitReader reader(t_data, t_size);
+                std::uint64_t residuals[kBlockSamples];
+                int next = kBlockSamples;
+                std::size_t remaining = count;
+                forEachPrediction(t_samples, t_width, t_height, t_components,
+                        [&](T& t_sample, std::int64_t t_prediction)
+                        {
+                                if (next == kBlockSamples)
+                                {
+                                        readBlock(reader, residuals,
+                                                static_cast<int>(std::min<std::size_t>(remaining, kBlockSamples)));
+                                        next = 0;
+                                }
+                                --remaining;
+                                t_sample = static_cast<T>(t_prediction + unzigzag(residuals[next++]));
+                        });
+        }
+
+        void runOnThreads(int t_threads, int t_count, const std::function<void(int)>& t_work)
+        {
+                const int threads = std::clamp(
+                        t_threads > 0 ? t_threads : static_cast<int>(std::thread::hardware_concurrency()), 1, std::max(1, t_count));
+                std::atomic<int> next{0};
+                const auto worker = [&]()
+                {
+                        for (int index = next++; index < t_count; index = next++)
+                        {
+                                t_work(index);
+                        }
+                };
+                std::vector<std::thread> workers;
+                workers.reserve(static_cast<std::size_t>(threads - 1));
+                for (int index = 1; index < threads; ++index)
+                {
+                        workers.emplace_back(worker);
+                }
+                worker();
+                for (std::thread& thread : workers)
+                {
+                        thread.join();
+                }
+        }
+}
+
+//-----------------------------------------------------------------------------
+std::unique_ptr<isis::core::CompressedImageData> isis::core::CompressedImageData::compress(
+        vtkImageData* t_image,
+        const int t_threads)
+{
+        vtkPointData* const pointData = t_image ? t_image->GetPointData() : nullptr;
+        vtkDataArray* const scalars = pointData ? pointData->GetScalars() : nullptr;
+        if (!scalars || pointData->GetNumberOfArrays() != 1 || !scalars->GetVoidPointer(0))
+        {
+                return nullptr;
+        }
+
+        auto compressed = std::unique_ptr<CompressedImageData>(new CompressedImageData());
+        t_image->GetExtent(compressed->m_extent);
+        t_image->GetSpacing(compressed->m_spacing);
+        t_image->GetOrigin(compressed->m_origin);
+        if (vtkMatrix3x3* const direction = t_image->GetDirectionMatrix())
+        {
+                std::memcpy(compressed->m_direction, direction->GetData(), sizeof(compressed->m_direction));
+        }
+        compressed->m_scalarType = scalars->GetDataType();
+        compressed->m_components = scalars->GetNumberOfComponents();
+        compressed->m_scalarName = scalars->GetName() ? scalars->GetName() : "";
+
+        const int width = compressed->width();
+        const int height = compressed->height();
+        const int slices = compressed->m_extent[5] - compressed->m_extent[4] + 1;
+        if (width <= 0 || height <= 0 || slices <= 0
+                || scalars->GetNumberOfTuples() != static_cast<vtkIdType>(width) * height * slices)
+        {
+                return nullptr;
+        }
+
+        switch (compressed->m_scalarType)
+        {
+        case VTK_FLOAT:
+        case VTK_DOUBLE:
+                compressed->m_encoding = Encoding::IntegralFloat;
+                break;
+        default:
+                compressed->m_encoding = scalars->GetDataTypeSize() <= 4 ? Encoding::Integer : Encoding::Raw;
+                break;
+        }
+
+        compressed->m_slices.resize(static_cast<std::size_t>(slices));
+        const std::size_t sliceBytes = compressed->sliceBytes();
+        const auto* const source = static_cast<const unsigned char*>(scalars->GetVoidPointer(0));
+        const int components = compressed->m_components;
+        runOnThreads(t_threads, slices, [&](int t_slice)
+        {
+                const unsigned char* const samples = source + sliceBytes * static_cast<std::size_t>(t_slice);
+                auto& block = compressed->m_slices[static_cast<std::size_t>(t_slice)];
+                switch (compressed->m_scalarType)
+                {
+                        vtkTemplateMacro(encodeSlice(reinterpret_cast<const VTK_TT*>(samples),
+                                width, height, components, block));
+                default:
+                        block.clear();
+                        break;
+                }
+        });
+        if (std::any_of(compressed->m_slices.begin(), compressed->m_slices.end(),
+                [](const std::vector<std::uint8_t>& t_block) { return t_block.empty(); }))
+        {
+                return nullptr;
+        }
+        return compressed;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> isis::core::CompressedImageData::decompress(const int t_threads) const
+{
+        auto image = vtkSmartPointer<vtkImageData>::New();
+        image->SetExtent(const_cast<int*>(m_extent));
+        image->SetSpacing(m_spacing);
+        image->SetOrigin(m_origin);
+        image->SetDirectionMatrix(m_direction);
+        image->AllocateScalars(m_scalarType, m_components);
+        vtkDataArray* const scalars = image->GetPointData()->GetScalars();
+        if (!m_scalarName.empty())
+        {
+                scalars->SetName(m_scalarName.c_str());
+        }
+
+        auto* const destination = static_cast<unsigned char*>(image->GetScalarPointer());
+        const std::size_t bytes = sliceBytes();
+        std::atomic<bool> failed{false};
+        runOnThreads(t_threads, sliceCount(), [&](int t_slice)
+        {
+                if (!decompressSlice(t_slice, destination + bytes * static_cast<std::size_t>(t_slice)))
+                {
+                        failed = true;
+                }
+        });
+        return failed ? nullptr : image;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::CompressedImageData::decompressSlice(const int t_slice, void* t_destination) const
+{
+        if (t_slice < 0 || t_slice >= sliceCount() || !t_destination)
+        {
+                return false;
+        }
+        const auto& block = m_slices[static_cast<std::size_t>(t_slice)];
+        if (block.empty())
+        {
+                return false;
+        }
+        if (block.front() == kSliceRaw)
+        {
+                if (block.size() != 1 + sliceBytes())
+                {
+                        return false;
+                }
+                std::memcpy(t_destination, block.data() + 1, sliceBytes());
+                return true;
+        }
+
+        const int width = this->width();
+        const int height = this->height();
+        switch (m_scalarType)
+        {
+                vtkTemplateMacro(decodeSlice(block.data() + 1, block.size() - 1,
+                        static_cast<VTK_TT*>(t_destination), width, height, m_components));
+        default:
+                return false;
+        }
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::core::CompressedImageData::sliceBytes() const
+{
+        return static_cast<std::size_t>(std::max(width(), 0)) * static_cast<std::size_t>(std::max(height(), 0))
+                * static_cast<std::size_t>(m_components) * static_cast<std::size_t>(vtkDataArray::GetDataTypeSize(m_scalarType));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::core::CompressedImageData::compressedBytes() const
+{
+        std::size_t bytes = sizeof(*this);
+        for (const auto& block : m_slices)
+        {
+                bytes += block.capacity() + sizeof(block);
+        }
+        return bytes;
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::core::CompressedImageData::expandedBytes() const
+{
+        return sliceBytes() * m_slices.size();
+}
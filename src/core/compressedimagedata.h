@@ -0,0 +1,79 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: compressedimagedata.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Lossless in-memory compression of volume scalars, one block per slice:
+ *      a median edge predictor followed by adaptive Rice coding, which suits
+ *      the smooth integer data of CT and MR.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include "utils.h"
+
+namespace isis::core
+{
+        class export CompressedImageData
+        {
+        public:
+                enum class Encoding
+                {
+                        Integer,                // Integer scalars
+                        IntegralFloat,          // Floating point scalars holding whole numbers (rescaled CT)
+                        Raw                     // Anything else, kept as is
+                };
+
+                /**
+                 * @brief Compress the scalars of t_image on t_threads threads (0 for one per core)
+                 * @return nullptr when the image has no scalars or carries other point arrays
+                 */
+                [[nodiscard]] static std::unique_ptr<CompressedImageData> compress(vtkImageData* t_image, int t_threads = 0);
+
+                /**
+                 * @brief Rebuild the image, decoding its slices on t_threads threads
+                 */
+                [[nodiscard]] vtkSmartPointer<vtkImageData> decompress(int t_threads = 0) const;
+
+                /**
+                 * @brief Decode one slice into t_destination, which holds sliceBytes()
+                 */
+                bool decompressSlice(int t_slice, void* t_destination) const;
+
+                [[nodiscard]] Encoding encoding() const { return m_encoding; }
+                [[nodiscard]] int sliceCount() const { return static_cast<int>(m_slices.size()); }
+                [[nodiscard]] int width() const { return m_extent[1] - m_extent[0] + 1; }
+                [[nodiscard]] int height() const { return m_extent[3] - m_extent[2] + 1; }
+                [[nodiscard]] int components() const { return m_components; }
+                [[nodiscard]] std::size_t sliceBytes() const;
+                [[nodiscard]] std::size_t compressedBytes() const;
+                [[nodiscard]] std::size_t expandedBytes() const;
+
+        private:
+                int m_extent[6] = {0, -1, 0, -1, 0, -1};
+                double m_spacing[3] = {1.0, 1.0, 1.0};
+                double m_origin[3] = {0.0, 0.0, 0.0};
+                double m_direction[9] = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+                int m_scalarType = 0;
+                int m_components = 1;
+                std::string m_scalarName;
+                Encoding m_encoding = Encoding::Raw;
+                std::vector<std::vector<std::uint8_t>> m_slices;
+        };
+}
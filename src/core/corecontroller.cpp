@@ -43,6 +43,7 @@
 #include <QLoggingCategory>
 #include <QString>
 #include <stdexcept>
+#include "utils/structuredlog.h"
 
 namespace isis::core
 {
@@ -66,8 +67,6 @@ isis::core::CoreController::CoreController()
 //-----------------------------------------------------------------------------
 void isis::core::CoreController::readData(const std::string& t_filepath) const
 {
-        const auto sanitizedPath = sanitizePath(t_filepath);
-        qInfo(lcCoreController) << "Request to read data from" << sanitizedPath;
         try
         {
                 m_dicomReader->readFile(t_filepath);
@@ -82,11 +81,28 @@ void isis::core::CoreController::readData(const std::string& t_filepath) const
         }
         catch (const std::exception& ex)
         {
-                qCritical(lcCoreController) << "Exception while reading data from" << sanitizedPath << ":" << ex.what();
+                qCritical(lcCoreController) << "Exception while reading data from" << sanitizePath(t_filepath) << ":" << ex.what();
                 throw;
         }
 }
 
+//-----------------------------------------------------------------------------
+void isis::core::CoreController::readParsedData(const DicomInstanceHeader& t_header) const
+{
+        if (t_header.values.empty())
+        {
+                throw std::runtime_error("Empty instance header");
+        }
+        m_dicomReader->readHeader(t_header);
+        insertDataInRepo();
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::CoreController::lastReadIsStructuredReport() const
+{
+        return m_dicomReader && m_dicomReader->isStructuredReport();
+}
+
 //-----------------------------------------------------------------------------
 int isis::core::CoreController::getLastSeriesSize() const
 {
@@ -125,12 +141,6 @@ void isis::core::CoreController::insertDataInRepo() const
 	if (!newSeries) return;
 	m_coreRepository->addSeries(std::move(newSeries));
 	m_coreRepository->addImage(m_dicomReader->getReadImage());
-        const auto* const lastImage = m_coreRepository->getLastImage();
-        auto* const lastSeries = m_coreRepository->getLastSeries();
-        const auto frameCount = (!lastImage || !lastSeries)
-                ? 0
-                : (lastImage->getIsMultiFrame() ? lastImage->getNumberOfFrames()
-                                                : static_cast<int>(lastSeries->snapshotSingleFramePaths().size()));
-	qInfo(lcCoreController) << "Repository updated with" << frameCount
-	                        << (lastImage->getIsMultiFrame() ? "frames from multi-frame image" : "single-frame images");
+	// Progress is reported by the import queue statistics, not once per file
+	utils::telemetry().increment("repository.images_inserted");
 }
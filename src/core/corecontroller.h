@@ -56,6 +56,7 @@ namespace isis::core
 		~CoreController() = default;
 
 		void readData(const std::string& t_filepath) const;
+		void readParsedData(const DicomInstanceHeader& t_header) const;
 		[[nodiscard]] std::vector<std::unique_ptr<Patient>>& getPatients() const { return m_coreRepository->getPatients(); }
 		[[nodiscard]] Patient* getLastPatient() const { return m_coreRepository ? m_coreRepository->getLastPatient() : nullptr; }
 		[[nodiscard]] int getLastPatientIndex() const { return m_coreRepository && m_coreRepository->getLastPatient() ? m_coreRepository->getLastPatient()->getIndex() : -1; }
@@ -68,6 +69,7 @@ namespace isis::core
 		[[nodiscard]] int getLastImageIndex() const { return m_coreRepository && m_coreRepository->getLastImage() ? m_coreRepository->getLastImage()->getIndex() : -1; }
 		[[nodiscard]] bool newSeriesAdded() const { return m_coreRepository && m_coreRepository->newSeriesAdded(); }
 		[[nodiscard]] bool newImageAdded() const { return m_coreRepository && m_coreRepository->newImageAdded(); }
+		[[nodiscard]] bool lastReadIsStructuredReport() const;
 
 		void resetData();
 
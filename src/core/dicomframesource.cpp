@@ -0,0 +1,590 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomframesource.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of frame-by-frame access to multi-frame objects
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dicomframesource.h"
+
+#include "dicomvolumemetadata.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include <gdcmDataElement.h>
+#include <gdcmDataSet.h>
+#include <gdcmFragment.h>
+#include <gdcmImage.h>
+#include <gdcmImageHelper.h>
+#include <gdcmPhotometricInterpretation.h>
+#include <gdcmPixelFormat.h>
+#include <gdcmReader.h>
+#include <gdcmSequenceOfFragments.h>
+#include <gdcmSequenceOfItems.h>
+#include <gdcmTransferSyntax.h>
+
+#include <QLoggingCategory>
+#include <QString>
+
+Q_LOGGING_CATEGORY(lcDicomFrameSource, "isis.core.framesource")
+
+namespace
+{
+        constexpr std::uint32_t UndefinedLength = 0xFFFFFFFFu;
+
+        const gdcm::Tag PixelDataTag(0x7fe0, 0x0010);
+        const gdcm::Tag ExtendedOffsetTableTag(0x7fe0, 0x0001);
+        const gdcm::Tag SharedFunctionalGroupsTag(0x5200, 0x9229);
+        const gdcm::Tag PerFrameFunctionalGroupsTag(0x5200, 0x9230);
+
+        template <typename T>
+        bool readLittleEndian(std::istream& stream, T& value)
+        {
+                unsigned char bytes[sizeof(T)] = {};
+                if (!stream.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+                {
+                        return false;
+                }
+                value = 0;
+                for (std::size_t i = sizeof(T); i-- > 0;)
+                {
+                        value = static_cast<T>((value << 8) | bytes[i]);
+                }
+                return true;
+        }
+
+        std::vector<std::uint64_t> readOffsets(const std::vector<char>& bytes, std::size_t width)
+        {
+                std::vector<std::uint64_t> offsets;
+                offsets.reserve(bytes.size() / width);
+                for (std::size_t position = 0; position + width <= bytes.size(); position += width)
+                {
+                        std::uint64_t value = 0;
+                        for (std::size_t i = width; i-- > 0;)
+                        {
+                                value = (value << 8) | static_cast<unsigned char>(bytes[position + i]);
+                        }
+                        offsets.push_back(value);
+                }
+                return offsets;
+        }
+
+        bool isCodestreamStart(const unsigned char* bytes, std::size_t size)
+        {
+                if (size >= 2 && bytes[0] == 0xFF && (bytes[1] == 0xD8 || bytes[1] == 0x4F))
+                {
+                        return true;                    // JPEG, JPEG-LS or JPEG 2000 codestream
+                }
+                if (size >= 8)
+                {
+                        // RLE header: segment count, then the first segment right after the 64-byte header
+                        const std::uint32_t segments = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16)
+                                | (static_cast<std::uint32_t>(bytes[3]) << 24);
+                        const std::uint32_t firstOffset = bytes[4] | (bytes[5] << 8) | (bytes[6] << 16)
+                                | (static_cast<std::uint32_t>(bytes[7]) << 24);
+                        return segments >= 1 && segments <= 15 && firstOffset == 64;
+                }
+                return false;
+        }
+
+        // Runs t_apply on the first item of a functional group macro; the sequence is kept
+        // alive while its item is in use
+        template <typename Apply>
+        void withFirstItem(const gdcm::DataSet& t_group, const gdcm::Tag& t_sequence, Apply t_apply)
+        {
+                if (!t_group.FindDataElement(t_sequence))
+                {
+                        return;
+                }
+                const gdcm::SmartPointer<gdcm::SequenceOfItems> items =
+                        t_group.GetDataElement(t_sequence).GetValueAsSQ();
+                if (items && items->GetNumberOfItems() > 0)
+                {
+                        t_apply(items->GetItem(1).GetNestedDataSet());
+                }
+        }
+
+        void applyFunctionalGroups(const gdcm::DataSet& t_group, isis::core::DicomFrameInfo& t_info)
+        {
+                using isis::core::metadata::getNumericValues;
+                withFirstItem(t_group, gdcm::Tag(0x0020, 0x9113), [&t_info](const gdcm::DataSet& item)
+                {
+                        const auto position = getNumericValues(item, gdcm::Tag(0x0020, 0x0032));
+                        if (position.size() >= 3)
+                        {
+                                t_info.Position = {position[0], position[1], position[2]};
+                                t_info.HasPosition = true;
+                        }
+                });
+                withFirstItem(t_group, gdcm::Tag(0x0028, 0x9145), [&t_info](const gdcm::DataSet& item)
+                {
+                        const auto intercept = getNumericValues(item, gdcm::Tag(0x0028, 0x1052));
+                        const auto slope = getNumericValues(item, gdcm::Tag(0x0028, 0x1053));
+                        if (!intercept.empty())
+                        {
+                                t_info.RescaleIntercept = intercept.front();
+                        }
+                        if (!slope.empty() && slope.front() != 0.0)
+                        {
+                                t_info.RescaleSlope = slope.front();
+                        }
+                });
+                withFirstItem(t_group, gdcm::Tag(0x0028, 0x9132), [&t_info](const gdcm::DataSet& item)
+                {
+                        const auto center = getNumericValues(item, gdcm::Tag(0x0028, 0x1050));
+                        const auto width = getNumericValues(item, gdcm::Tag(0x0028, 0x1051));
+                        if (!center.empty() && !width.empty() && width.front() > 0.0)
+                        {
+                                t_info.WindowCenter = center.front();
+                                t_info.WindowWidth = width.front();
+                        }
+                });
+        }
+}
+
+std::shared_ptr<isis::core::DicomFrameSource> isis::core::DicomFrameSource::open(const std::string& t_path)
+{
+        const auto unsupported = [&t_path](const char* t_reason) -> std::shared_ptr<DicomFrameSource>
+        {
+                qCInfo(lcDicomFrameSource) << "Frames of" << QString::fromStdString(t_path)
+                        << "are decoded with the whole object:" << t_reason;
+                return {};
+        };
+
+        gdcm::Reader reader;
+        reader.SetFileName(t_path.c_str());
+        if (!reader.ReadUpToTag(PixelDataTag))
+        {
+                return unsupported("the header could not be read");
+        }
+        const gdcm::File& file = reader.GetFile();
+        const gdcm::TransferSyntax& transferSyntax = file.GetHeader().GetDataSetTransferSyntax();
+        if (transferSyntax.GetSwapCode() == gdcm::SwapCode::BigEndian
+                || transferSyntax == gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian)
+        {
+                return unsupported("big endian or deflated transfer syntax");
+        }
+
+        const gdcm::PixelFormat pixelFormat = gdcm::ImageHelper::GetPixelFormatValue(file);
+        const auto bitsAllocated = pixelFormat.GetBitsAllocated();
+        if (pixelFormat.GetSamplesPerPixel() != 1 || (bitsAllocated != 8 && bitsAllocated != 16 && bitsAllocated != 32))
+        {
+                return unsupported("colour or packed samples");
+        }
+        const std::vector<unsigned int> dimensions = gdcm::ImageHelper::GetDimensionsValue(file);
+        if (dimensions.size() < 3 || dimensions[0] == 0 || dimensions[1] == 0 || dimensions[2] == 0)
+        {
+                return unsupported("no frame dimensions");
+        }
+
+        std::shared_ptr<DicomFrameSource> source(new DicomFrameSource());
+        source->m_path = t_path;
+        source->m_width = static_cast<int>(dimensions[0]);
+        source->m_height = static_cast<int>(dimensions[1]);
+        source->m_bitsAllocated = bitsAllocated;
+        source->m_bitsStored = pixelFormat.GetBitsStored();
+        source->m_highBit = pixelFormat.GetHighBit();
+        source->m_pixelRepresentation = pixelFormat.GetPixelRepresentation();
+        source->m_transferSyntax = static_cast<int>(static_cast<gdcm::TransferSyntax::TSType>(transferSyntax));
+        const char* photometric = gdcm::PhotometricInterpretation::GetPIString(
+                gdcm::ImageHelper::GetPhotometricInterpretationValue(file));
+        source->m_photometric = photometric ? photometric : "MONOCHROME2";
+
+        // Object-wide description; enhanced objects keep geometry in the shared functional groups
+        const auto metadataBundle = metadata::loadVolumeMetadata(file);
+        auto header = std::make_shared<DicomVolume>();
+        header->Metadata = metadataBundle.Metadata;
+        header->Geometry = metadataBundle.Geometry;
+        header->PixelInfo = metadataBundle.PixelInfo;
+        header->PixelInfo.BitsAllocated = bitsAllocated;
+        header->PixelInfo.IsSigned = source->isSigned();
+        header->PixelInfo.OriginalIsSigned = source->isSigned();
+        header->NumberOfFrames = static_cast<int>(dimensions[2]);
+        header->SourceFiles = {t_path};
+        const std::vector<double> cosines = gdcm::ImageHelper::GetDirectionCosinesValue(file);
+        const std::vector<double> spacing = gdcm::ImageHelper::GetSpacingValue(file);
+        if (cosines.size() == 6)
+        {
+                std::copy(cosines.begin(), cosines.begin() + 3, header->Geometry.RowDirection);
+                std::copy(cosines.begin() + 3, cosines.end(), header->Geometry.ColumnDirection);
+                const auto* row = header->Geometry.RowDirection;
+                const auto* column = header->Geometry.ColumnDirection;
+                header->Geometry.NormalDirection[0] = row[1] * column[2] - row[2] * column[1];
+                header->Geometry.NormalDirection[1] = row[2] * column[0] - row[0] * column[2];
+                header->Geometry.NormalDirection[2] = row[0] * column[1] - row[1] * column[0];
+                metadata::normalizeDirections(header->Geometry);
+        }
+        for (std::size_t axis = 0; axis < std::min<std::size_t>(spacing.size(), 3); ++axis)
+        {
+                if (spacing[axis] > 0.0)
+                {
+                        header->Geometry.Spacing[axis] = spacing[axis];
+                }
+        }
+
+        // Top level, then shared, then per-frame functional groups
+        DicomFrameInfo defaults;
+        defaults.RescaleSlope = header->PixelInfo.RescaleSlope;
+        defaults.RescaleIntercept = header->PixelInfo.RescaleIntercept;
+        defaults.WindowCenter = header->PixelInfo.WindowCenter;
+        defaults.WindowWidth = std::max(header->PixelInfo.WindowWidth, 0.0);
+        const gdcm::DataSet& dataSet = file.GetDataSet();
+        withFirstItem(dataSet, SharedFunctionalGroupsTag, [&defaults](const gdcm::DataSet& shared)
+        {
+                applyFunctionalGroups(shared, defaults);
+        });
+        source->m_frames.assign(dimensions[2], defaults);
+        if (dataSet.FindDataElement(PerFrameFunctionalGroupsTag))
+        {
+                const gdcm::SmartPointer<gdcm::SequenceOfItems> perFrame =
+                        dataSet.GetDataElement(PerFrameFunctionalGroupsTag).GetValueAsSQ();
+                const std::size_t items = perFrame ? std::min<std::size_t>(perFrame->GetNumberOfItems(), dimensions[2]) : 0;
+                for (std::size_t frame = 0; frame < items; ++frame)
+                {
+                        applyFunctionalGroups(perFrame->GetItem(frame + 1).GetNestedDataSet(), source->m_frames[frame]);
+                }
+        }
+        const DicomFrameInfo& first = source->m_frames.front();
+        header->PixelInfo.RescaleSlope = first.RescaleSlope;
+        header->PixelInfo.RescaleIntercept = first.RescaleIntercept;
+        if (first.WindowWidth > 0.0)
+        {
+                header->PixelInfo.WindowCenter = first.WindowCenter;
+                header->PixelInfo.WindowWidth = first.WindowWidth;
+        }
+        if (first.HasPosition)
+        {
+                std::copy(first.Position.begin(), first.Position.end(), header->Geometry.Origin);
+        }
+        source->m_header = std::move(header);
+
+        std::vector<std::uint64_t> extendedOffsets;
+        if (dataSet.FindDataElement(ExtendedOffsetTableTag))
+        {
+                if (const gdcm::ByteValue* value = dataSet.GetDataElement(ExtendedOffsetTableTag).GetByteValue())
+                {
+                        extendedOffsets = readOffsets(std::vector<char>(value->GetPointer(),
+                                value->GetPointer() + value->GetLength()), sizeof(std::uint64_t));
+                }
+        }
+
+        source->m_file.open(t_path, std::ios::binary);
+        if (!source->m_file
+                || !source->locatePixelData(reader.GetStreamCurrentPosition(), transferSyntax.IsExplicit(), extendedOffsets))
+        {
+                return unsupported("the pixel data of each frame could not be located");
+        }
+
+        qCInfo(lcDicomFrameSource) << "Opened" << QString::fromStdString(t_path)
+                << "frames" << source->frameCount()
+                << "size" << source->m_width << "x" << source->m_height
+                << "fragments" << source->m_fragments.size();
+        return source;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::DicomFrameSource::locatePixelData(const std::uint64_t t_elementOffset, const bool t_explicitVR,
+        const std::vector<std::uint64_t>& t_extendedOffsets)
+{
+        m_file.seekg(static_cast<std::streamoff>(t_elementOffset));
+        std::uint16_t group = 0;
+        std::uint16_t element = 0;
+        std::uint32_t length = 0;
+        if (!readLittleEndian(m_file, group) || !readLittleEndian(m_file, element)
+                || group != PixelDataTag.GetGroup() || element != PixelDataTag.GetElement())
+        {
+                return false;
+        }
+        if (t_explicitVR)
+        {
+                char vr[2] = {};
+                std::uint16_t reserved = 0;
+                if (!m_file.read(vr, 2) || !readLittleEndian(m_file, reserved))
+                {
+                        return false;
+                }
+        }
+        if (!readLittleEndian(m_file, length))
+        {
+                return false;
+        }
+
+        const std::size_t frameCount = m_frames.size();
+        if (length != UndefinedLength)
+        {
+                m_nativeOffset = static_cast<std::uint64_t>(m_file.tellg());
+                return static_cast<std::uint64_t>(length) >= frameByteCount() * frameCount;
+        }
+
+        // Encapsulated: the Basic Offset Table item, then one item per fragment
+        std::vector<std::uint64_t> basicOffsets;
+        std::vector<std::uint64_t> positions;
+        std::uint64_t firstFragment = 0;
+        bool offsetTableRead = false;
+        for (;;)
+        {
+                const auto itemOffset = static_cast<std::uint64_t>(m_file.tellg());
+                if (!readLittleEndian(m_file, group) || !readLittleEndian(m_file, element)
+                        || !readLittleEndian(m_file, length) || group != 0xFFFE)
+                {
+                        return false;
+                }
+                if (element == 0xE0DD)
+                {
+                        break;
+                }
+                if (element != 0xE000 || length == UndefinedLength)
+                {
+                        return false;
+                }
+                if (!offsetTableRead)
+                {
+                        std::vector<char> table(length);
+                        if (length > 0 && !m_file.read(table.data(), length))
+                        {
+                                return false;
+                        }
+                        basicOffsets = readOffsets(table, sizeof(std::uint32_t));
+                        offsetTableRead = true;
+                        firstFragment = static_cast<std::uint64_t>(m_file.tellg());
+                        continue;
+                }
+                positions.push_back(itemOffset - firstFragment);
+                m_fragments.push_back({itemOffset + 8, length});
+                m_file.seekg(length, std::ios::cur);
+        }
+        if (m_fragments.empty())
+        {
+                return false;
+        }
+
+        const auto& frameOffsets = t_extendedOffsets.size() == frameCount ? t_extendedOffsets : basicOffsets;
+        m_frameFragments = mapFramesToFragments(positions, frameOffsets, {}, frameCount);
+        if (m_frameFragments.empty())
+        {
+                // Several fragments per frame and no usable table: one read per fragment, once
+                std::vector<bool> starts;
+                starts.reserve(m_fragments.size());
+                for (const auto& fragment : m_fragments)
+                {
+                        unsigned char bytes[8] = {};
+                        const std::size_t size = std::min<std::size_t>(sizeof(bytes), fragment.length);
+                        m_file.seekg(static_cast<std::streamoff>(fragment.valueOffset));
+                        m_file.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(size));
+                        starts.push_back(m_file && isCodestreamStart(bytes, size));
+                }
+                m_frameFragments = mapFramesToFragments(positions, frameOffsets, starts, frameCount);
+        }
+        m_file.clear();
+        return !m_frameFragments.empty();
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::size_t> isis::core::DicomFrameSource::mapFramesToFragments(
+        const std::vector<std::uint64_t>& t_fragmentPositions,
+        const std::vector<std::uint64_t>& t_frameOffsets,
+        const std::vector<bool>& t_codestreamStarts,
+        const std::size_t t_frameCount)
+{
+        const std::size_t fragmentCount = t_fragmentPositions.size();
+        if (t_frameCount == 0 || fragmentCount < t_frameCount)
+        {
+                return {};
+        }
+
+        std::vector<std::size_t> starts;
+        starts.reserve(t_frameCount + 1);
+        if (t_frameOffsets.size() == t_frameCount)
+        {
+                for (const std::uint64_t offset : t_frameOffsets)
+                {
+                        const auto it = std::lower_bound(t_fragmentPositions.begin(), t_fragmentPositions.end(), offset);
+                        const auto fragment = static_cast<std::size_t>(it - t_fragmentPositions.begin());
+                        if (it == t_fragmentPositions.end() || *it != offset
+                                || (!starts.empty() && fragment <= starts.back()))
+                        {
+                                starts.clear();
+                                break;
+                        }
+                        starts.push_back(fragment);
+                }
+        }
+        if (starts.empty() && fragmentCount == t_frameCount)
+        {
+                starts.resize(t_frameCount);
+                std::iota(starts.begin(), starts.end(), std::size_t{0});
+        }
+        if (starts.empty() && t_frameCount == 1)
+        {
+                starts.push_back(0);
+        }
+        if (starts.empty() && t_codestreamStarts.size() == fragmentCount && t_codestreamStarts.front())
+        {
+                for (std::size_t fragment = 0; fragment < fragmentCount; ++fragment)
+                {
+                        if (t_codestreamStarts[fragment])
+                        {
+                                starts.push_back(fragment);
+                        }
+                }
+                if (starts.size() != t_frameCount)
+                {
+                        starts.clear();
+                }
+        }
+        if (starts.empty() || starts.front() != 0)
+        {
+                return {};
+        }
+        starts.push_back(fragmentCount);
+        return starts;
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::core::DicomFrameSource::frameByteCount() const
+{
+        return static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height)
+                * static_cast<std::size_t>(m_bitsAllocated / 8);
+}
+
+//-----------------------------------------------------------------------------
+isis::core::DicomPixelInfo isis::core::DicomFrameSource::pixelInfo(const int t_frame) const
+{
+        DicomPixelInfo info = m_header->PixelInfo;
+        const DicomFrameInfo& frame = m_frames.at(t_frame);
+        info.RescaleSlope = frame.RescaleSlope;
+        info.RescaleIntercept = frame.RescaleIntercept;
+        if (frame.WindowWidth > 0.0)
+        {
+                info.WindowCenter = frame.WindowCenter;
+                info.WindowWidth = frame.WindowWidth;
+        }
+        return info;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<int> isis::core::DicomFrameSource::spatialOrder() const
+{
+        std::vector<int> order(m_frames.size());
+        std::iota(order.begin(), order.end(), 0);
+        const bool positioned = std::all_of(m_frames.begin(), m_frames.end(),
+                [](const DicomFrameInfo& frame) { return frame.HasPosition; });
+        if (!positioned)
+        {
+                return order;
+        }
+        const double* normal = m_header->Geometry.NormalDirection;
+        const auto distance = [this, normal](int frame)
+        {
+                const auto& position = m_frames[static_cast<std::size_t>(frame)].Position;
+                return position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2];
+        };
+        // Frames at the same position (temporal phases, diffusion directions) keep their file order
+        std::stable_sort(order.begin(), order.end(), [&distance](int lhs, int rhs)
+        {
+                return distance(lhs) < distance(rhs);
+        });
+        return order;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::DicomFrameSource::readFrame(const int t_frame, char* t_buffer) const
+{
+        if (t_frame < 0 || t_frame >= frameCount() || !t_buffer)
+        {
+                throw std::runtime_error("Requested frame index exceeds the frames of the object.");
+        }
+        const std::size_t byteCount = frameByteCount();
+
+        if (m_fragments.empty())
+        {
+                std::lock_guard<std::mutex> lock(m_fileMutex);
+                m_file.clear();
+                m_file.seekg(static_cast<std::streamoff>(m_nativeOffset + static_cast<std::uint64_t>(t_frame) * byteCount));
+                if (!m_file.read(t_buffer, static_cast<std::streamsize>(byteCount)))
+                {
+                        throw std::runtime_error("Failed to read frame " + std::to_string(t_frame) + " of " + m_path);
+                }
+        }
+        else
+        {
+                const auto frame = static_cast<std::size_t>(t_frame);
+                gdcm::SmartPointer<gdcm::SequenceOfFragments> fragments = new gdcm::SequenceOfFragments;
+                {
+                        std::lock_guard<std::mutex> lock(m_fileMutex);
+                        std::vector<char> bytes;
+                        for (std::size_t index = m_frameFragments[frame]; index < m_frameFragments[frame + 1]; ++index)
+                        {
+                                const Fragment& fragment = m_fragments[index];
+                                bytes.resize(fragment.length);
+                                m_file.clear();
+                                m_file.seekg(static_cast<std::streamoff>(fragment.valueOffset));
+                                if (!m_file.read(bytes.data(), static_cast<std::streamsize>(fragment.length)))
+                                {
+                                        throw std::runtime_error("Failed to read frame " + std::to_string(t_frame) + " of " + m_path);
+                                }
+                                gdcm::Fragment item;
+                                item.SetByteValue(bytes.data(), fragment.length);
+                                fragments->AddFragment(item);
+                        }
+                }
+
+                // A one-frame image made of this frame's fragments, decoded by the GDCM codecs
+                gdcm::DataElement pixelData(PixelDataTag);
+                pixelData.SetVLToUndefined();
+                pixelData.SetValue(*fragments);
+                gdcm::Image image;
+                image.SetNumberOfDimensions(2);
+                image.SetDimension(0, static_cast<unsigned int>(m_width));
+                image.SetDimension(1, static_cast<unsigned int>(m_height));
+                image.SetPixelFormat(gdcm::PixelFormat(1,
+                        static_cast<unsigned short>(m_bitsAllocated),
+                        static_cast<unsigned short>(m_bitsStored),
+                        static_cast<unsigned short>(m_highBit),
+                        static_cast<unsigned short>(m_pixelRepresentation)));
+                image.SetPhotometricInterpretation(gdcm::PhotometricInterpretation::GetPIType(m_photometric.c_str()));
+                image.SetTransferSyntax(gdcm::TransferSyntax(static_cast<gdcm::TransferSyntax::TSType>(m_transferSyntax)));
+                image.SetDataElement(pixelData);
+                if (image.GetBufferLength() != byteCount || !image.GetBuffer(t_buffer))
+                {
+                        throw std::runtime_error("Failed to decode frame " + std::to_string(t_frame) + " of " + m_path);
+                }
+        }
+        normalizeStoredBits(t_buffer);
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::DicomFrameSource::normalizeStoredBits(char* t_buffer) const
+{
+        // Bits above High Bit may hold overlays; signed values need their sign extended
+        if (m_bitsAllocated != 16 || m_bitsStored >= 16 || m_bitsStored <= 0 || m_highBit != m_bitsStored - 1)
+        {
+                return;
+        }
+        const auto mask = static_cast<std::uint16_t>((1u << m_bitsStored) - 1u);
+        const auto signBit = static_cast<std::uint16_t>(1u << (m_bitsStored - 1));
+        const std::size_t count = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+                std::uint16_t value = 0;
+                std::memcpy(&value, t_buffer + i * 2, sizeof(value));
+                value &= mask;
+                if (m_pixelRepresentation != 0 && (value & signBit))
+                {
+                        value |= static_cast<std::uint16_t>(~mask);
+                }
+                std::memcpy(t_buffer + i * 2, &value, sizeof(value));
+        }
+}
@@ -0,0 +1,142 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomframesource.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Frame-by-frame access to large multi-frame objects (enhanced CT/MR,
+ *      tomosynthesis). Only the header is parsed when the file is opened; each
+ *      frame is read and decoded on request from the position of its pixel data
+ *      or compressed fragments, with position and rescale taken from the
+ *      per-frame functional groups.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+#include "dicomvolume.h"
+
+namespace isis::core
+{
+        /**
+         * @brief Attributes of one frame, from the per-frame or shared functional groups
+         */
+        struct DicomFrameInfo
+        {
+                std::array<double, 3> Position = {0.0, 0.0, 0.0};
+                bool HasPosition = false;
+                double RescaleSlope = 1.0;
+                double RescaleIntercept = 0.0;
+                double WindowCenter = 0.0;
+                double WindowWidth = 0.0;               // 0 when the frame has no window
+        };
+
+        class export DicomFrameSource
+        {
+        public:
+                /**
+                 * @brief Parse the header and locate the pixel data of every frame
+                 * @return nullptr when the frames cannot be read one at a time (colour or
+                 *         packed samples, big endian or deflated files, fragments that cannot
+                 *         be assigned to frames); the whole object is decoded instead
+                 */
+                [[nodiscard]] static std::shared_ptr<DicomFrameSource> open(const std::string& t_path);
+
+                /**
+                 * @brief First fragment of each frame, followed by the fragment count
+                 *
+                 * Frames are located with the Extended Offset Table, then the Basic
+                 * Offset Table, then one fragment per frame; when none of these apply
+                 * and t_codestreamStarts is given, with the fragments that begin a
+                 * JPEG, JPEG 2000 or RLE codestream.
+                 *
+                 * @param t_fragmentPositions offset of each fragment item from the first one
+                 * @param t_frameOffsets offsets from the Extended or Basic Offset Table, empty when absent
+                 * @return empty when the fragments cannot be assigned to t_frameCount frames
+                 */
+                [[nodiscard]] static std::vector<std::size_t> mapFramesToFragments(
+                        const std::vector<std::uint64_t>& t_fragmentPositions,
+                        const std::vector<std::uint64_t>& t_frameOffsets,
+                        const std::vector<bool>& t_codestreamStarts,
+                        std::size_t t_frameCount);
+
+                [[nodiscard]] int frameCount() const { return static_cast<int>(m_frames.size()); }
+                [[nodiscard]] int width() const { return m_width; }
+                [[nodiscard]] int height() const { return m_height; }
+                [[nodiscard]] int bitsAllocated() const { return m_bitsAllocated; }
+                [[nodiscard]] bool isSigned() const { return m_pixelRepresentation != 0; }
+                [[nodiscard]] bool isEncapsulated() const { return !m_fragments.empty(); }
+                [[nodiscard]] std::size_t frameByteCount() const;
+
+                /**
+                 * @brief Metadata, geometry and pixel description of the object, without voxels
+                 */
+                [[nodiscard]] std::shared_ptr<const DicomVolume> header() const { return m_header; }
+                [[nodiscard]] const DicomFrameInfo& frameInfo(int t_frame) const { return m_frames.at(t_frame); }
+
+                /**
+                 * @brief Pixel description of the object with the rescale and window of one frame
+                 */
+                [[nodiscard]] DicomPixelInfo pixelInfo(int t_frame) const;
+
+                /**
+                 * @brief Frames sorted by position along the slice normal, in file order when
+                 *        frames have no position
+                 */
+                [[nodiscard]] std::vector<int> spatialOrder() const;
+
+                /**
+                 * @brief Read and decode one frame into t_buffer (frameByteCount() bytes),
+                 *        stored values, rows from top to bottom
+                 *
+                 * May be called from several threads; only the file reads are serialised.
+                 * Throws std::runtime_error when the frame cannot be read or decoded.
+                 */
+                void readFrame(int t_frame, char* t_buffer) const;
+
+        private:
+                struct Fragment
+                {
+                        std::uint64_t valueOffset = 0;
+                        std::uint32_t length = 0;
+                };
+
+                DicomFrameSource() = default;
+
+                bool locatePixelData(std::uint64_t t_elementOffset, bool t_explicitVR,
+                        const std::vector<std::uint64_t>& t_extendedOffsets);
+                void normalizeStoredBits(char* t_buffer) const;
+
+                std::string m_path;
+                int m_width = 0;
+                int m_height = 0;
+                int m_bitsAllocated = 16;
+                int m_bitsStored = 16;
+                int m_highBit = 15;
+                int m_pixelRepresentation = 0;
+                int m_transferSyntax = 0;                       // gdcm::TransferSyntax::TSType
+                std::string m_photometric;
+                std::uint64_t m_nativeOffset = 0;               // Start of native pixel data
+                std::vector<Fragment> m_fragments;              // Encapsulated pixel data only
+                std::vector<std::size_t> m_frameFragments;      // See mapFramesToFragments
+                std::vector<DicomFrameInfo> m_frames;
+                std::shared_ptr<DicomVolume> m_header;
+                mutable std::mutex m_fileMutex;
+                mutable std::ifstream m_file;
+        };
+}
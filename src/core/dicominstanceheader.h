@@ -0,0 +1,96 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicominstanceheader.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Header attributes of one stored DICOM instance, parsed once by the component
+ *      that received it and handed to the repository without reading the file again.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace isis::core
+{
+        /**
+         * @brief Attribute values needed to insert an instance into the repository
+         *
+         * Values are kept as their string representation (multi-valued attributes
+         * joined with '\'), trimmed of padding, so DicomReader interprets them exactly
+         * as it interprets a file it parsed itself. The file at filePath is still used
+         * for pixel data.
+         */
+        struct DicomInstanceHeader
+        {
+                std::string filePath;
+                std::map<std::uint32_t, std::string> values;    // Keyed by makeKey(group, element)
+
+                [[nodiscard]] static constexpr std::uint32_t makeKey(std::uint16_t group, std::uint16_t element)
+                {
+                        return (static_cast<std::uint32_t>(group) << 16) | element;
+                }
+
+                [[nodiscard]] std::string getValue(std::uint16_t group, std::uint16_t element) const
+                {
+                        const auto it = values.find(makeKey(group, element));
+                        return it != values.end() ? it->second : std::string();
+                }
+
+                void setValue(std::uint16_t group, std::uint16_t element, std::string value)
+                {
+                        values[makeKey(group, element)] = std::move(value);
+                }
+        };
+
+        /**
+         * @brief Attributes read by DicomReader when building patient, study, series and image
+         *
+         * Body Part Examined is used to pick the relevant priors of a received study and
+         * to match hanging protocols.
+         */
+        inline constexpr std::array<std::uint32_t, 31> RepositoryHeaderTags = {
+                DicomInstanceHeader::makeKey(0x0008, 0x0016),   // SOP Class UID
+                DicomInstanceHeader::makeKey(0x0008, 0x0018),   // SOP Instance UID
+                DicomInstanceHeader::makeKey(0x0008, 0x0020),   // Study Date
+                DicomInstanceHeader::makeKey(0x0008, 0x0021),   // Series Date
+                DicomInstanceHeader::makeKey(0x0008, 0x0060),   // Modality
+                DicomInstanceHeader::makeKey(0x0008, 0x1030),   // Study Description
+                DicomInstanceHeader::makeKey(0x0008, 0x103E),   // Series Description
+                DicomInstanceHeader::makeKey(0x0010, 0x0010),   // Patient's Name
+                DicomInstanceHeader::makeKey(0x0010, 0x0020),   // Patient ID
+                DicomInstanceHeader::makeKey(0x0010, 0x0030),   // Patient's Birth Date
+                DicomInstanceHeader::makeKey(0x0010, 0x1010),   // Patient's Age
+                DicomInstanceHeader::makeKey(0x0018, 0x0015),   // Body Part Examined
+                DicomInstanceHeader::makeKey(0x0018, 0x1164),   // Imager Pixel Spacing
+                DicomInstanceHeader::makeKey(0x0020, 0x000D),   // Study Instance UID
+                DicomInstanceHeader::makeKey(0x0020, 0x000E),   // Series Instance UID
+                DicomInstanceHeader::makeKey(0x0020, 0x0010),   // Study ID
+                DicomInstanceHeader::makeKey(0x0020, 0x0011),   // Series Number
+                DicomInstanceHeader::makeKey(0x0020, 0x0012),   // Acquisition Number
+                DicomInstanceHeader::makeKey(0x0020, 0x0013),   // Instance Number
+                DicomInstanceHeader::makeKey(0x0020, 0x0032),   // Image Position (Patient)
+                DicomInstanceHeader::makeKey(0x0020, 0x0037),   // Image Orientation (Patient)
+                DicomInstanceHeader::makeKey(0x0020, 0x0052),   // Frame of Reference UID
+                DicomInstanceHeader::makeKey(0x0020, 0x1041),   // Slice Location
+                DicomInstanceHeader::makeKey(0x0028, 0x0008),   // Number of Frames
+                DicomInstanceHeader::makeKey(0x0028, 0x0010),   // Rows
+                DicomInstanceHeader::makeKey(0x0028, 0x0011),   // Columns
+                DicomInstanceHeader::makeKey(0x0028, 0x0030),   // Pixel Spacing
+                DicomInstanceHeader::makeKey(0x0028, 0x1050),   // Window Center
+                DicomInstanceHeader::makeKey(0x0028, 0x1051),   // Window Width
+                DicomInstanceHeader::makeKey(0x0028, 0x1052),   // Rescale Intercept
+                DicomInstanceHeader::makeKey(0x0028, 0x1053),   // Rescale Slope
+        };
+}
@@ -0,0 +1,286 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomparalleldecoder.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the parallel decoder for compressed slice series
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dicomparalleldecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gdcmAttribute.h>
+#include <gdcmFile.h>
+#include <gdcmReader.h>
+#include <gdcmTransferSyntax.h>
+
+#include <QLoggingCategory>
+
+#include <vtkDataArray.h>
+#include <vtkGDCMImageReader2.h>
+#include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkStringArray.h>
+
+#include "utils/structuredlog.h"
+
+Q_LOGGING_CATEGORY(lcDicomParallelDecoder, "isis.core.paralleldecoder")
+
+namespace
+{
+        struct SliceHeader
+        {
+                unsigned short rows = 0;
+                unsigned short columns = 0;
+                unsigned short samplesPerPixel = 0;
+                unsigned short bitsAllocated = 0;
+
+                bool operator==(const SliceHeader& t_other) const
+                {
+                        return rows == t_other.rows && columns == t_other.columns
+                                && samplesPerPixel == t_other.samplesPerPixel && bitsAllocated == t_other.bitsAllocated;
+                }
+        };
+
+        bool readSliceHeader(const std::string& t_path, SliceHeader& t_header)
+        {
+                gdcm::Reader reader;
+                reader.SetFileName(t_path.c_str());
+                if (!reader.ReadUpToTag(gdcm::Tag(0x7fe0, 0x0010)))
+                {
+                        return false;
+                }
+                const gdcm::DataSet& dataSet = reader.GetFile().GetDataSet();
+                gdcm::Attribute<0x0028, 0x0010> rows{};
+                gdcm::Attribute<0x0028, 0x0011> columns{};
+                gdcm::Attribute<0x0028, 0x0002> samplesPerPixel{};
+                gdcm::Attribute<0x0028, 0x0100> bitsAllocated{};
+                rows.SetFromDataSet(dataSet);
+                columns.SetFromDataSet(dataSet);
+                samplesPerPixel.SetFromDataSet(dataSet);
+                bitsAllocated.SetFromDataSet(dataSet);
+                t_header = {rows.GetValue(), columns.GetValue(), samplesPerPixel.GetValue(), bitsAllocated.GetValue()};
+                return true;
+        }
+
+        // The reader's own per-file decode, which applies the same rescale, flip and
+        // colour conversion as Update() over the file list, into a caller buffer
+        class SliceDecoder : public vtkGDCMImageReader2
+        {
+        public:
+                static SliceDecoder* New();
+                vtkTypeMacro(SliceDecoder, vtkGDCMImageReader2);
+
+                // Conversions derived from the first file, as one reader over the series uses them
+                void prepare(vtkStringArray* t_files)
+                {
+                        SetFileNames(t_files);
+                        LoadOverlaysOff();
+                        LoadIconImageOff();
+                        UpdateInformation();
+                        m_firstShift = Shift;
+                        m_firstScale = Scale;
+                }
+
+                bool decode(const std::string& t_path, char* t_destination, std::size_t t_bytes)
+                {
+                        Shift = m_firstShift;
+                        Scale = m_firstScale;
+                        unsigned long length = 0;
+                        return LoadSingleFile(t_path.c_str(), t_destination, length) != 0 && length == t_bytes;
+                }
+
+        private:
+                double m_firstShift = 0.0;
+                double m_firstScale = 1.0;
+        };
+        vtkStandardNewMacro(SliceDecoder);
+
+        void runOnThreads(int t_threads, int t_count, const std::function<void(int)>& t_work)
+        {
+                std::atomic<int> next{0};
+                const auto worker = [&]()
+                {
+                        for (int index = next++; index < t_count; index = next++)
+                        {
+                                t_work(index);
+                        }
+                };
+                std::vector<std::thread> workers;
+                workers.reserve(static_cast<std::size_t>(std::max(0, t_threads - 1)));
+                for (int index = 1; index < t_threads; ++index)
+                {
+                        workers.emplace_back(worker);
+                }
+                worker();
+                for (std::thread& thread : workers)
+                {
+                        thread.join();
+                }
+        }
+}
+
+isis::core::DicomParallelDecoder::DicomParallelDecoder(const Options& t_options)
+        : m_options(t_options)
+{
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::DicomParallelDecoder::isCompressed(const gdcm::File& t_file)
+{
+        return t_file.GetHeader().GetDataSetTransferSyntax().IsEncapsulated();
+}
+
+//-----------------------------------------------------------------------------
+int isis::core::DicomParallelDecoder::threadCount() const
+{
+        if (m_options.Threads > 0)
+        {
+                return m_options.Threads;
+        }
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> isis::core::DicomParallelDecoder::decodeSeries(
+        const std::vector<std::string>& t_files,
+        vtkGDCMImageReader2* t_reference) const
+{
+        vtkInformation* information = t_reference ? t_reference->GetOutputInformation(0) : nullptr;
+        if (!information || t_files.empty() || !t_reference->GetFileNames()
+                || !information->Has(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+        {
+                return nullptr;
+        }
+
+        int extent[6] = {0, 0, 0, 0, 0, 0};
+        information->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+        const int width = extent[1] - extent[0] + 1;
+        const int height = extent[3] - extent[2] + 1;
+        const int sliceCount = static_cast<int>(t_files.size());
+        if (width <= 0 || height <= 0 || extent[5] - extent[4] + 1 != sliceCount)
+        {
+                return nullptr;
+        }
+        const int threads = std::min(threadCount(), sliceCount);
+        const auto started = std::chrono::steady_clock::now();
+
+        // Slices of another size would not fit their place; one reader decides what to do with them
+        std::vector<SliceHeader> headers(t_files.size());
+        std::atomic<bool> unreadable{false};
+        runOnThreads(threads, sliceCount, [&](int t_slice)
+        {
+                if (!readSliceHeader(t_files[static_cast<std::size_t>(t_slice)], headers[static_cast<std::size_t>(t_slice)]))
+                {
+                        unreadable = true;
+                }
+        });
+        if (unreadable || std::any_of(headers.begin(), headers.end(),
+                [&](const SliceHeader& t_header) { return !(t_header == headers.front()); }))
+        {
+                qCInfo(lcDicomParallelDecoder) << "Slices differ in size from the first one; reading the series on one thread";
+                return nullptr;
+        }
+
+        auto destination = vtkSmartPointer<vtkImageData>::New();
+        destination->SetExtent(extent);
+        destination->SetSpacing(information->Get(vtkDataObject::SPACING()));
+        destination->SetOrigin(information->Get(vtkDataObject::ORIGIN()));
+        destination->AllocateScalars(vtkImageData::GetScalarType(information),
+                vtkImageData::GetNumberOfScalarComponents(information));
+        if (vtkInformation* const scalarsInformation = vtkDataObject::GetActiveFieldInformation(information,
+                vtkDataObject::FIELD_ASSOCIATION_POINTS, vtkDataSetAttributes::SCALARS))
+        {
+                if (scalarsInformation->Has(vtkDataObject::FIELD_NAME()))
+                {
+                        destination->GetPointData()->GetScalars()->SetName(scalarsInformation->Get(vtkDataObject::FIELD_NAME()));
+                }
+        }
+
+        // Every worker decodes its slices straight into their place in the volume
+        const std::size_t sliceBytes = static_cast<std::size_t>(width) * static_cast<std::size_t>(height)
+                * static_cast<std::size_t>(destination->GetScalarSize())
+                * static_cast<std::size_t>(destination->GetNumberOfScalarComponents());
+        auto* const voxels = static_cast<char*>(destination->GetScalarPointer());
+        std::vector<int> failedSlices;
+        std::mutex failedMutex;
+        std::atomic<int> nextSlice{0};
+        const auto worker = [&]()
+        {
+                vtkNew<SliceDecoder> decoder;
+                decoder->prepare(t_reference->GetFileNames());
+                for (int slice = nextSlice++; slice < sliceCount; slice = nextSlice++)
+                {
+                        bool decoded = false;
+                        try
+                        {
+                                decoded = decoder->decode(t_files[static_cast<std::size_t>(slice)],
+                                        voxels + sliceBytes * static_cast<std::size_t>(slice), sliceBytes);
+                        }
+                        catch (const std::exception& ex)
+                        {
+                                qCWarning(lcDicomParallelDecoder) << "Slice decode failed:" << ex.what();
+                        }
+                        catch (...)
+                        {
+                        }
+                        if (!decoded)
+                        {
+                                std::lock_guard<std::mutex> lock(failedMutex);
+                                failedSlices.push_back(slice);
+                        }
+                }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<std::size_t>(threads - 1));
+        for (int index = 1; index < threads; ++index)
+        {
+                workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : workers)
+        {
+                thread.join();
+        }
+
+        // Only the slices that failed are decoded again, on this thread
+        if (!failedSlices.empty())
+        {
+                utils::telemetry().increment("decode.parallel_slice_retries", failedSlices.size());
+                vtkNew<SliceDecoder> decoder;
+                decoder->prepare(t_reference->GetFileNames());
+                for (const int slice : failedSlices)
+                {
+                        if (!decoder->decode(t_files[static_cast<std::size_t>(slice)],
+                                voxels + sliceBytes * static_cast<std::size_t>(slice), sliceBytes))
+                        {
+                                qCWarning(lcDicomParallelDecoder) << "Slice" << slice << "could not be decoded";
+                                return nullptr;
+                        }
+                }
+        }
+
+        utils::telemetry().increment("decode.parallel_slices", static_cast<std::uint64_t>(sliceCount));
+        utils::telemetry().recordDuration("decode.parallel_series",
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+        return destination;
+}
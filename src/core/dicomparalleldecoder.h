@@ -0,0 +1,77 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomparalleldecoder.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Decodes compressed (JPEG 2000, JPEG-LS, JPEG, RLE) slice series on a pool
+ *      of workers sized to the cores. Each worker decodes slices with its own
+ *      GDCM reader straight into their place in the destination volume, with
+ *      the conversions one reader over all the files would apply.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include "utils.h"
+
+class vtkGDCMImageReader2;
+
+namespace gdcm
+{
+        class File;
+}
+
+namespace isis::core
+{
+        class export DicomParallelDecoder
+        {
+        public:
+                struct Options
+                {
+                        int Threads = 0;                        // 0 for one worker per core
+                };
+
+                DicomParallelDecoder() = default;
+                explicit DicomParallelDecoder(const Options& t_options);
+
+                /**
+                 * @brief Whether the pixel data is encapsulated, so decode time dominates reading
+                 */
+                [[nodiscard]] static bool isCompressed(const gdcm::File& t_file);
+
+                [[nodiscard]] int threadCount() const;
+
+                /**
+                 * @brief Decode sorted single-frame slices as t_reference would read them
+                 *
+                 * t_reference holds the same file names and has its information updated;
+                 * it is not executed.
+                 *
+                 * Every slice is converted with the rescale derived from the first one,
+                 * as one reader over the series does. A slice that fails to decode is
+                 * decoded once more on the calling thread.
+                 *
+                 * @return nullptr when the series has to be read by t_reference on one
+                 *         thread: multi-frame files, slices whose size or pixel layout
+                 *         differs from the first, or a slice that cannot be decoded
+                 */
+                [[nodiscard]] vtkSmartPointer<vtkImageData> decodeSeries(
+                        const std::vector<std::string>& t_files,
+                        vtkGDCMImageReader2* t_reference) const;
+
+        private:
+                Options m_options = {};
+        };
+}
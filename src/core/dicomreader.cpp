@@ -25,6 +25,9 @@
 #include <QLoggingCategory>
 #include <QString>
 
+#include "gzipinputstream.h"
+#include "utils/structuredlog.h"
+
 namespace isis::core
 {
         Q_LOGGING_CATEGORY(lcDicomReader, "isis.core.dicom")
@@ -218,21 +221,45 @@ namespace
 void isis::core::DicomReader::readFile(const std::string& filePath)
 {
         m_filePath = filePath;
-        const auto sanitizedPath = sanitizePath(filePath);
-        qInfo(lcDicomReader) << "[Logging] Starting DICOM read for" << sanitizedPath;
+        m_hasHeader = false;
 
         gdcm::Reader reader;
-        reader.SetFileName(filePath.c_str());
-        if (!reader.Read())
+        bool read = false;
+        if (GzipInputStream::isGzipFile(filePath))
         {
-                qCritical(lcDicomReader) << "[Logging] Failed to load DICOM file" << sanitizedPath;
+                // Header only: pixel data is inflated when the series is loaded
+                GzipInputStream stream(filePath);
+                reader.SetStream(stream);
+                read = stream && reader.ReadUpToTag(gdcm::Tag(0x7fe0, 0x0010));
+                utils::telemetry().increment("dicom.read_gzip");
+        }
+        else
+        {
+                reader.SetFileName(filePath.c_str());
+                read = reader.Read();
+        }
+        if (!read)
+        {
+                utils::telemetry().increment("dicom.read_failed");
+                qCritical(lcDicomReader) << "[Logging] Failed to load DICOM file" << sanitizePath(filePath);
                 m_hasFile = false;
                 throw std::runtime_error("Cannot open file!");
         }
 
         m_file = reader.GetFile();
         m_hasFile = true;
-        qInfo(lcDicomReader) << "[Logging] Successfully loaded DICOM file" << sanitizedPath;
+        utils::telemetry().increment("dicom.read_ok");
+}
+
+void isis::core::DicomReader::readHeader(const DicomInstanceHeader& header)
+{
+        // Attributes were already parsed by whoever stored the file; no second read
+        m_filePath = header.filePath;
+        m_header = header;
+        m_hasHeader = true;
+        m_hasFile = false;
+        m_file = {};
+        utils::telemetry().increment("dicom.header_ingested");
 }
 
 std::unique_ptr<isis::core::Patient> isis::core::DicomReader::getReadPatient() const
@@ -274,6 +301,7 @@ std::unique_ptr<isis::core::Series> isis::core::DicomReader::getReadSeries() con
         series->setDescription(getTagValue({0x0008, 0x103E}));
         series->setUID(getTagValue({0x0020, 0x000E}));
         series->setDate(getTagValue({0x0008, 0x0021}));
+        series->setBodyPartExamined(getTagValue({0x0018, 0x0015}));
         return series;
 }
 
@@ -282,6 +310,7 @@ std::unique_ptr<isis::core::Image> isis::core::DicomReader::getReadImage() const
         auto image = std::make_unique<Image>();
         const auto modality = getTagValue({0x0008, 0x0060});
         image->setImagePath(m_filePath);
+        image->setModality(modality);
         image->setSOPInstanceUID(getTagValue({0x0008, 0x0018}));
         image->setClassUID(getTagValue({0x0008, 0x0016}));
 
@@ -345,6 +374,11 @@ std::unique_ptr<isis::core::Image> isis::core::DicomReader::getReadImage() const
 
 std::string isis::core::DicomReader::getTagValue(const gdcm::Tag& tag) const
 {
+        if (m_hasHeader)
+        {
+                return m_header.getValue(tag.GetGroup(), tag.GetElement());
+        }
+
         if (!m_hasFile)
         {
                 return {};
@@ -378,6 +412,11 @@ std::string isis::core::DicomReader::getTagValue(const gdcm::Tag& tag) const
         }
 }
 
+bool isis::core::DicomReader::isStructuredReport() const
+{
+        return dataSetExists() && getTagValue({0x0008, 0x0060}) == "SR";
+}
+
 bool isis::core::DicomReader::isModalitySupported(const std::string& modality)
 {
         return modality != "PR" && modality != "KO" && modality != "SR";
@@ -439,6 +478,12 @@ std::tuple<int, int> isis::core::DicomReader::getWindowLevel() const
                         static_cast<int>(std::lround(std::max(*widthValue, 1.0)))};
         }
 
+        // Left unset for gzip'd files: the series loader takes it from the decoded volume
+        if (GzipInputStream::isGzipFile(m_filePath))
+        {
+                return {0, 0};
+        }
+
         const auto fallback = computeWindowLevelFromPixels();
         const double minValue = fallback.first;
         const double maxValue = fallback.second;
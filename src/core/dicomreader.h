@@ -40,6 +40,7 @@
 #pragma once
 
 #include "patient.h"
+#include "dicominstanceheader.h"
 
 #include <gdcmFile.h>
 #include <gdcmTag.h>
@@ -56,15 +57,19 @@ namespace isis::core
 		~DicomReader() = default;
 
 		void readFile(const std::string& t_filePath);
+		void readHeader(const DicomInstanceHeader& t_header);
 		[[nodiscard]] std::unique_ptr<Patient> getReadPatient() const;
 		[[nodiscard]] std::unique_ptr<Study> getReadStudy() const;
 		[[nodiscard]] std::unique_ptr<Series> getReadSeries() const;
 		[[nodiscard]] std::unique_ptr<Image> getReadImage() const;
-		[[nodiscard]] bool dataSetExists() const { return m_hasFile; }
+		[[nodiscard]] bool dataSetExists() const { return m_hasFile || m_hasHeader; }
+		[[nodiscard]] bool isStructuredReport() const;
 
 	private:
 		gdcm::File m_file = {};
 		bool m_hasFile = false;
+		DicomInstanceHeader m_header = {};
+		bool m_hasHeader = false;
 		std::string m_filePath = {};
 
 		[[nodiscard]] std::string getTagValue(const gdcm::Tag& tag) const;
@@ -1,12 +1,21 @@
 #include "dicomseriesloader.h"
 
+#include "dicomparalleldecoder.h"
 #include "dicomvolumemetadata.h"
+#include "gzipinputstream.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
+#include <gdcmImageHelper.h>
 #include <gdcmImageReader.h>
 #include <gdcmIPPSorter.h>
 #include <gdcmReader.h>
@@ -34,6 +43,7 @@ using isis::core::DicomVolume;
 namespace
 {
         constexpr double kRescaleEpsilon = 1e-8;
+        constexpr double kPositionEpsilon = 1e-4;
 
         std::vector<std::string> sortSeriesFiles(const std::vector<std::string>& filePaths, double& computedSpacing)
         {
@@ -107,9 +117,30 @@ namespace
                 }
         }
 
-        void populatePixelInfoFromReader(vtkGDCMImageReader2* reader, isis::core::DicomPixelInfo& info)
+        // What the decoder reports besides the voxels: vtkGDCMImageReader2, or the gzip path
+        struct DecodedPixelProperties
         {
-                if (auto* output = reader->GetOutput())
+                bool planar = false;
+                bool inverseLuminance = false;
+                double shift = 0.0;
+                double scale = 1.0;
+        };
+
+        DecodedPixelProperties readerPixelProperties(vtkGDCMImageReader2* reader)
+        {
+                DecodedPixelProperties properties;
+                properties.planar = reader->GetPlanarConfiguration() != 0;
+                properties.inverseLuminance = reader->GetImageFormat() == VTK_INVERSE_LUMINANCE;
+                properties.shift = reader->GetShift();
+                properties.scale = reader->GetScale();
+                return properties;
+        }
+
+        void populatePixelInfoFromReader(const DecodedPixelProperties& reader,
+                vtkImageData* output,
+                isis::core::DicomPixelInfo& info)
+        {
+                if (output)
                 {
                         auto* scalars = output->GetPointData() ? output->GetPointData()->GetScalars() : nullptr;
                         if (scalars)
@@ -136,12 +167,12 @@ namespace
                         }
                 }
 
-                info.IsPlanar = (reader->GetPlanarConfiguration() != 0);
-                info.InvertMonochrome = (reader->GetImageFormat() == VTK_INVERSE_LUMINANCE);
+                info.IsPlanar = reader.planar;
+                info.InvertMonochrome = reader.inverseLuminance;
                 const double metadataSlope = info.RescaleSlope;
                 const double metadataIntercept = info.RescaleIntercept;
-                const double readerSlope = reader->GetScale();
-                const double readerIntercept = reader->GetShift();
+                const double readerSlope = reader.scale;
+                const double readerIntercept = reader.shift;
                 info.RescaleSlope = readerSlope;
                 info.RescaleIntercept = readerIntercept;
 
@@ -270,14 +301,11 @@ namespace
                         << range[1];
         }
 
-        std::shared_ptr<DicomVolume> assembleVolume(vtkGDCMImageReader2* reader,
+        std::shared_ptr<DicomVolume> assembleVolume(const DecodedPixelProperties& reader,
+                vtkImageData* rawOutput,
                 const gdcm::File& referenceFile,
                 double ippSpacing)
         {
-                reader->Update();
-
-                vtkImageData* rawOutput = reader->GetOutput();
-
                 auto volume = std::make_shared<DicomVolume>();
 
                 // Populate metadata / geometry from the reference dataset.
@@ -325,12 +353,318 @@ namespace
                         }
                 }
 
-                populatePixelInfoFromReader(reader, volume->PixelInfo);
+                populatePixelInfoFromReader(reader, rawOutput, volume->PixelInfo);
                 rescaleVolumeScalarsIfNeeded(*volume);
                 populateDirectionMatrix(*volume);
 
                 return volume;
         }
+
+        std::unique_ptr<std::istream> openInflatedStream(const std::string& path)
+        {
+                // Streamed through bounded buffers: no temporary file, no compressed copy in memory
+                if (isis::core::GzipInputStream::isGzipFile(path))
+                {
+                        return std::make_unique<isis::core::GzipInputStream>(path);
+                }
+                return std::make_unique<std::ifstream>(path, std::ios::binary);
+        }
+
+        // Header of one file of a gzip-compressed series, read up to the pixel data
+        struct InflatedSlice
+        {
+                std::string path;
+                gdcm::File header;
+                unsigned int frames = 1;
+                double position = 0.0;
+        };
+
+        InflatedSlice readInflatedHeader(const std::string& path)
+        {
+                const auto stream = openInflatedStream(path);
+                gdcm::Reader reader;
+                reader.SetStream(*stream);
+                if (!*stream || !reader.ReadUpToTag(gdcm::Tag(0x7fe0, 0x0010)))
+                {
+                        throw std::runtime_error("Failed to read DICOM header with GDCM: " + path);
+                }
+
+                InflatedSlice slice;
+                slice.path = path;
+                slice.header = reader.GetFile();
+                const std::vector<unsigned int> dimensions = gdcm::ImageHelper::GetDimensionsValue(slice.header);
+                slice.frames = dimensions.size() > 2 ? std::max(1u, dimensions[2]) : 1u;
+                return slice;
+        }
+
+        // Pixels of one file, decoded by a worker and released once copied into the volume
+        struct DecodedSlice
+        {
+                std::vector<char> pixels;
+                unsigned int width = 0;
+                unsigned int height = 0;
+                unsigned int frames = 1;
+                gdcm::PixelFormat pixelFormat;
+                unsigned int planarConfiguration = 0;
+                gdcm::PhotometricInterpretation photometric;
+        };
+
+        DecodedSlice decodeInflatedSlice(const std::string& path)
+        {
+                const auto stream = openInflatedStream(path);
+                gdcm::ImageReader reader;
+                reader.SetStream(*stream);
+                if (!*stream || !reader.Read())
+                {
+                        throw std::runtime_error("Failed to read DICOM file with GDCM: " + path);
+                }
+
+                const gdcm::Image& image = reader.GetImage();
+                DecodedSlice slice;
+                slice.width = image.GetDimension(0);
+                slice.height = image.GetDimension(1);
+                slice.frames = image.GetNumberOfDimensions() > 2 ? std::max(1u, image.GetDimension(2)) : 1u;
+                slice.pixelFormat = image.GetPixelFormat();
+                slice.planarConfiguration = image.GetPlanarConfiguration();
+                slice.photometric = image.GetPhotometricInterpretation();
+                slice.pixels.resize(image.GetBufferLength());
+                if (slice.pixels.empty() || !image.GetBuffer(slice.pixels.data()))
+                {
+                        throw std::runtime_error("Failed to decode pixel data of " + path);
+                }
+                return slice;
+        }
+
+        // Runs work on every index across all cores; the first error is thrown once the workers stopped
+        void runOnSlices(const std::size_t count, const std::function<void(std::size_t)>& work)
+        {
+                std::atomic<std::size_t> nextSlice{0};
+                std::mutex errorMutex;
+                std::string error;
+                auto worker = [&]()
+                {
+                        for (std::size_t index = nextSlice++; index < count; index = nextSlice++)
+                        {
+                                try
+                                {
+                                        work(index);
+                                }
+                                catch (const std::exception& ex)
+                                {
+                                        std::lock_guard<std::mutex> lock(errorMutex);
+                                        if (error.empty())
+                                        {
+                                                error = ex.what();
+                                        }
+                                }
+                        }
+                };
+                const auto threads = std::min<std::size_t>(
+                        static_cast<std::size_t>(isis::core::DicomParallelDecoder().threadCount()), count);
+                std::vector<std::thread> workers;
+                for (std::size_t index = 1; index < threads; ++index)
+                {
+                        workers.emplace_back(worker);
+                }
+                worker();
+                for (std::thread& thread : workers)
+                {
+                        thread.join();
+                }
+                if (!error.empty())
+                {
+                        throw std::runtime_error(error);
+                }
+        }
+
+        int vtkScalarTypeFor(const gdcm::PixelFormat& pixelFormat)
+        {
+                switch (pixelFormat.GetScalarType())
+                {
+                case gdcm::PixelFormat::UINT8:
+                        return VTK_UNSIGNED_CHAR;
+                case gdcm::PixelFormat::INT8:
+                        return VTK_SIGNED_CHAR;
+                case gdcm::PixelFormat::UINT12:
+                case gdcm::PixelFormat::UINT16:
+                        return VTK_UNSIGNED_SHORT;
+                case gdcm::PixelFormat::INT12:
+                case gdcm::PixelFormat::INT16:
+                        return VTK_SHORT;
+                case gdcm::PixelFormat::UINT32:
+                        return VTK_UNSIGNED_INT;
+                case gdcm::PixelFormat::INT32:
+                        return VTK_INT;
+                case gdcm::PixelFormat::FLOAT32:
+                        return VTK_FLOAT;
+                case gdcm::PixelFormat::FLOAT64:
+                        return VTK_DOUBLE;
+                default:
+                        throw std::runtime_error("Unsupported pixel format in gzip-compressed series.");
+                }
+        }
+
+        // Same order and spacing rules as sortSeriesFiles: along the slice normal, duplicates dropped
+        double sortInflatedSlices(std::vector<InflatedSlice>& slices)
+        {
+                const std::vector<double> cosines = gdcm::ImageHelper::GetDirectionCosinesValue(slices.front().header);
+                if (slices.size() < 2 || cosines.size() != 6
+                        || std::any_of(slices.begin(), slices.end(), [](const InflatedSlice& slice) { return slice.frames != 1; }))
+                {
+                        return 0.0;
+                }
+                const double normal[3] = {
+                        cosines[1] * cosines[5] - cosines[2] * cosines[4],
+                        cosines[2] * cosines[3] - cosines[0] * cosines[5],
+                        cosines[0] * cosines[4] - cosines[1] * cosines[3]};
+                for (auto& slice : slices)
+                {
+                        // Slices without a position keep the order they were given in
+                        if (!slice.header.GetDataSet().FindDataElement(gdcm::Tag(0x0020, 0x0032)))
+                        {
+                                return 0.0;
+                        }
+                        const std::vector<double> origin = gdcm::ImageHelper::GetOriginValue(slice.header);
+                        slice.position = origin[0] * normal[0] + origin[1] * normal[1] + origin[2] * normal[2];
+                }
+                std::stable_sort(slices.begin(), slices.end(), [](const InflatedSlice& lhs, const InflatedSlice& rhs)
+                {
+                        return lhs.position < rhs.position;
+                });
+                slices.erase(std::unique(slices.begin(), slices.end(), [](const InflatedSlice& lhs, const InflatedSlice& rhs)
+                {
+                        return std::abs(lhs.position - rhs.position) < kPositionEpsilon;
+                }), slices.end());
+                if (slices.size() < 2)
+                {
+                        return 0.0;
+                }
+
+                const double spacing = slices[1].position - slices[0].position;
+                for (std::size_t index = 2; index < slices.size(); ++index)
+                {
+                        const double step = slices[index].position - slices[index - 1].position;
+                        if (std::abs(step - spacing) > kPositionEpsilon * std::max(1.0, spacing))
+                        {
+                                return 0.0;
+                        }
+                }
+                return spacing;
+        }
+
+        /**
+         * Inflates and decodes the files of a gzip-compressed series on all cores and lays
+         * the slices out as vtkGDCMImageReader2 does (rows from the bottom). Stored values
+         * are kept; the rescale is applied with the rest of the volume.
+         *
+         * Headers are read first so every slice has its place in the volume before any
+         * pixel is decoded; each decoded slice is then copied in and released, keeping
+         * one slice per worker in memory besides the volume.
+         */
+        std::shared_ptr<DicomVolume> loadInflatedSeries(const std::vector<std::string>& slicePaths)
+        {
+                std::vector<InflatedSlice> slices(slicePaths.size());
+                runOnSlices(slicePaths.size(), [&](std::size_t index)
+                {
+                        slices[index] = readInflatedHeader(slicePaths[index]);
+                });
+
+                const double computedSpacing = sortInflatedSlices(slices);
+                std::vector<std::size_t> firstFrames(slices.size());
+                int totalFrames = 0;
+                for (std::size_t index = 0; index < slices.size(); ++index)
+                {
+                        firstFrames[index] = static_cast<std::size_t>(totalFrames);
+                        totalFrames += static_cast<int>(slices[index].frames);
+                }
+
+                // The first slice sets the layout every other one has to match
+                const InflatedSlice& first = slices.front();
+                DecodedSlice reference = decodeInflatedSlice(first.path);
+                if (reference.frames != first.frames || reference.height == 0)
+                {
+                        throw std::runtime_error("Pixel data of " + first.path + " does not match its header.");
+                }
+                const auto samples = reference.pixelFormat.GetSamplesPerPixel();
+                const std::size_t frameBytes = reference.pixels.size() / reference.frames;
+
+                auto rawOutput = vtkSmartPointer<vtkImageData>::New();
+                rawOutput->SetDimensions(static_cast<int>(reference.width), static_cast<int>(reference.height), totalFrames);
+                const std::vector<double> pixelSpacing = gdcm::ImageHelper::GetSpacingValue(first.header);
+                const std::vector<double> origin = gdcm::ImageHelper::GetOriginValue(first.header);
+                rawOutput->SetSpacing(pixelSpacing.size() > 0 ? pixelSpacing[0] : 1.0,
+                        pixelSpacing.size() > 1 ? pixelSpacing[1] : 1.0,
+                        computedSpacing > 0.0 ? computedSpacing : (pixelSpacing.size() > 2 ? pixelSpacing[2] : 1.0));
+                if (origin.size() >= 3)
+                {
+                        rawOutput->SetOrigin(origin[0], origin[1], origin[2]);
+                }
+                rawOutput->AllocateScalars(vtkScalarTypeFor(reference.pixelFormat), static_cast<int>(samples));
+
+                // Rows are flipped within each plane (planar colour keeps one plane per sample)
+                const std::size_t planes = reference.planarConfiguration != 0 ? samples : 1;
+                const std::size_t rowBytes = frameBytes / planes / reference.height;
+                auto* const volumeBytes = static_cast<char*>(rawOutput->GetScalarPointer());
+                const auto copySlice = [&](const DecodedSlice& slice, const std::size_t index)
+                {
+                        if (slice.width != reference.width || slice.height != reference.height
+                                || slice.pixelFormat != reference.pixelFormat
+                                || slice.frames != slices[index].frames
+                                || slice.pixels.size() != frameBytes * slice.frames)
+                        {
+                                throw std::runtime_error("Slices of the gzip-compressed series differ in size or pixel type.");
+                        }
+                        char* destination = volumeBytes + frameBytes * firstFrames[index];
+                        for (unsigned int frame = 0; frame < slice.frames; ++frame)
+                        {
+                                const char* source = slice.pixels.data() + frameBytes * frame;
+                                for (std::size_t plane = 0; plane < planes; ++plane)
+                                {
+                                        const std::size_t planeOffset = plane * rowBytes * reference.height;
+                                        for (unsigned int row = 0; row < reference.height; ++row)
+                                        {
+                                                std::memcpy(destination + planeOffset + rowBytes * (reference.height - 1 - row),
+                                                        source + planeOffset + rowBytes * row, rowBytes);
+                                        }
+                                }
+                                destination += frameBytes;
+                        }
+                };
+                copySlice(reference, 0);
+                std::vector<char>().swap(reference.pixels);
+
+                runOnSlices(slices.size() - 1, [&](std::size_t index)
+                {
+                        copySlice(decodeInflatedSlice(slices[index + 1].path), index + 1);
+                });
+
+                DecodedPixelProperties properties;
+                properties.planar = reference.planarConfiguration != 0;
+                properties.inverseLuminance = reference.photometric == gdcm::PhotometricInterpretation::MONOCHROME1;
+                const std::vector<double> rescale = gdcm::ImageHelper::GetRescaleInterceptSlopeValue(first.header);
+                if (rescale.size() == 2)
+                {
+                        properties.shift = rescale[0];
+                        properties.scale = rescale[1];
+                }
+
+                auto volume = assembleVolume(properties, rawOutput, first.header, computedSpacing);
+                volume->SourceFiles.clear();
+                for (const auto& slice : slices)
+                {
+                        volume->SourceFiles.push_back(slice.path);
+                }
+
+                // Import does not inflate the pixels for a window; without one in the header, use the decoded range
+                if (!(volume->PixelInfo.WindowWidth > 0.0) && volume->ImageData)
+                {
+                        double range[2] = {0.0, 0.0};
+                        volume->ImageData->GetScalarRange(range);
+                        volume->PixelInfo.WindowWidth = std::max(range[1] - range[0], 1.0);
+                        volume->PixelInfo.WindowCenter = range[0] + volume->PixelInfo.WindowWidth * 0.5;
+                }
+                return volume;
+        }
 }
 
 namespace isis::core::seriesloader
@@ -352,6 +686,21 @@ namespace isis::core::seriesloader
                         throw std::invalid_argument("No DICOM files provided to loadVolumeFromSeries.");
                 }
 
+                if (std::any_of(slicePaths.begin(), slicePaths.end(), GzipInputStream::isGzipFile))
+                {
+                        try
+                        {
+                                return loadInflatedSeries(slicePaths);
+                        }
+                        catch (const std::exception& ex)
+                        {
+                                qCCritical(lcDicomSeriesLoader)
+                                        << "Gzip-compressed series assembly failed:"
+                                        << QString::fromStdString(ex.what());
+                                throw;
+                        }
+                }
+
                 double computedSpacing = 0.0;
                 const auto sortedFiles = sortSeriesFiles(slicePaths, computedSpacing);
                 const auto referenceFile = readGdcmFile(sortedFiles.front());
@@ -367,7 +716,22 @@ namespace isis::core::seriesloader
 
                 try
                 {
-                        auto volume = assembleVolume(reader, referenceFile, computedSpacing);
+                        // Compressed slices are decoded on all cores; the reader keeps the other cases
+                        vtkSmartPointer<vtkImageData> rawOutput;
+                        const DicomParallelDecoder decoder;
+                        if (sortedFiles.size() > 1 && decoder.threadCount() > 1
+                                && DicomParallelDecoder::isCompressed(referenceFile))
+                        {
+                                reader->UpdateInformation();
+                                rawOutput = decoder.decodeSeries(sortedFiles, reader);
+                        }
+                        if (!rawOutput)
+                        {
+                                reader->Update();
+                                rawOutput = reader->GetOutput();
+                        }
+
+                        auto volume = assembleVolume(readerPixelProperties(reader), rawOutput, referenceFile, computedSpacing);
                         if (volume)
                         {
                                 volume->SourceFiles = sortedFiles;
@@ -50,6 +50,8 @@
 
 namespace isis::core
 {
+	class CompressedImageData;
+
 	struct DicomTag
 	{
 		unsigned short Group = 0;
@@ -121,6 +123,9 @@ namespace isis::core
 		DicomMetadata Metadata = {};
 		int NumberOfFrames = 1;
 		std::vector<std::string> SourceFiles = {};
+		// Only on volumes the volume cache built to hold compressed slices; ImageData is null there
+		// and neither member changes once the volume is handed out
+		std::shared_ptr<const CompressedImageData> CompressedScalars = {};
 	};
 
         class DicomVolumeLoader
@@ -11,9 +11,13 @@
 
 #include "dicomvolumecache.h"
 
-#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <system_error>
 #include <unordered_map>
@@ -21,41 +25,30 @@
 #include <QLoggingCategory>
 #include <QString>
 
+#include <vtkDataArray.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
 
+#include "compressedimagedata.h"
+#include "utils/structuredlog.h"
+
 Q_DECLARE_LOGGING_CATEGORY(lcDicomVolumeLoader)
 
 namespace
 {
         constexpr std::size_t kDefaultCacheCapacityBytes = 512ULL * 1024ULL * 1024ULL;
 
-        std::atomic<std::uint64_t> g_volumeCacheHits = 0;
-        std::atomic<std::uint64_t> g_volumeCacheMisses = 0;
-
+        // Hits and misses only count (see volumecache.hit/.miss in the telemetry report);
+        // the rarer events below also get their own record.
         void logVolumeCacheTelemetry(const char* event,
+                const char* counterName,
                 const std::string& studyUid,
                 const std::string& seriesUid)
         {
-                const auto hits = g_volumeCacheHits.load(std::memory_order_relaxed);
-                const auto misses = g_volumeCacheMisses.load(std::memory_order_relaxed);
-                const auto total = hits + misses;
-                const double hitRate = (total > 0)
-                        ? (static_cast<double>(hits) * 100.0) / static_cast<double>(total)
-                        : 0.0;
-                const QString qStudyUid = studyUid.empty()
-                        ? QStringLiteral("n/a")
-                        : QString::fromStdString(studyUid);
-                const QString qSeriesUid = seriesUid.empty()
-                        ? QStringLiteral("n/a")
-                        : QString::fromStdString(seriesUid);
-                qCInfo(lcDicomVolumeLoader)
-                        << "[Telemetry] Volume cache" << event
-                        << "studyUid" << qStudyUid
-                        << "seriesUid" << qSeriesUid
-                        << "hits" << static_cast<unsigned long long>(hits)
-                        << "misses" << static_cast<unsigned long long>(misses)
-                        << "hitRatePct" << hitRate;
+                isis::core::utils::telemetry().increment(counterName);
+                isis::core::utils::logEvent(lcDicomVolumeLoader(), isis::core::utils::LogLevel::Info,
+                        "[Telemetry] Volume cache",
+                        {{"event", event}, {"studyUid", studyUid}, {"seriesUid", seriesUid}});
         }
 
         class DicomVolumeCacheImpl
@@ -76,18 +69,22 @@ namespace
                         std::unique_lock<std::mutex> lock(m_mutex);
                         onStudyAccessLocked(studyUid);
                         const std::string key = composeKey(studyUid, seriesUid);
-                        auto mapIt = m_entries.find(key);
+                        auto mapIt = waitForConversionLocked(lock, key);
                         if (mapIt != m_entries.end())
                         {
                                 if (isValidLocked(mapIt->second, paths))
                                 {
                                         touchLocked(mapIt->second);
-                                        g_volumeCacheHits.fetch_add(1, std::memory_order_relaxed);
-                                        logVolumeCacheTelemetry("hit", studyUid, seriesUid);
-                                        return mapIt->second.Volume;
+                                        if (VolumePtr volume = expandLocked(lock, key))
+                                        {
+                                                isis::core::utils::telemetry().increment("volumecache.hit");
+                                                evictIfNeededLocked(lock);
+                                                return volume;
+                                        }
                                 }
 
-                                removeEntryLocked(mapIt);
+                                // The entry may have changed while it was being expanded
+                                removeEntryLocked(m_entries.find(key));
                         }
 
                         lock.unlock();
@@ -101,8 +98,7 @@ namespace
                         auto timestamps = collectTimestamps(paths);
                         if (timestamps.size() != paths.size())
                         {
-                                g_volumeCacheMisses.fetch_add(1, std::memory_order_relaxed);
-                                logVolumeCacheTelemetry("miss", studyUid, seriesUid);
+                                isis::core::utils::telemetry().increment("volumecache.miss");
                                 return volume;
                         }
 
@@ -126,9 +122,8 @@ namespace
                         entry.LruIt = m_lru.emplace(m_lru.begin(), key);
                         m_memoryBytes += entry.MemoryBytes;
                         m_entries.emplace(key, std::move(entry));
-                        g_volumeCacheMisses.fetch_add(1, std::memory_order_relaxed);
-                        logVolumeCacheTelemetry("miss", studyUid, seriesUid);
-                        evictIfNeededLocked();
+                        isis::core::utils::telemetry().increment("volumecache.miss");
+                        evictIfNeededLocked(lock);
                         return volume;
                 }
 
@@ -145,7 +140,7 @@ namespace
                         if (it != m_entries.end())
                         {
                                 removeEntryLocked(it);
-                                logVolumeCacheTelemetry("invalidate", studyUid, seriesUid);
+                                logVolumeCacheTelemetry("invalidate", "volumecache.invalidate", studyUid, seriesUid);
                         }
                 }
 
@@ -160,6 +155,19 @@ namespace
                         invalidateStudyLocked(studyUid);
                 }
 
+                void setCapacityBytes(std::size_t capacityBytes)
+                {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_capacityBytes = capacityBytes;
+                        evictIfNeededLocked(lock);
+                }
+
+                std::size_t residentBytes() const
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        return m_memoryBytes;
+                }
+
         private:
                 struct CacheEntry
                 {
@@ -170,6 +178,9 @@ namespace
                         std::list<std::string>::iterator LruIt = {};
                         std::string StudyUid = {};
                         std::string SeriesUid = {};
+                        bool Incompressible = false;
+                        // Being compressed or expanded outside the lock; other requests wait for it
+                        bool Converting = false;
                 };
 
                 using EntryMap = std::unordered_map<std::string, CacheEntry>;
@@ -243,6 +254,150 @@ namespace
                         return true;
                 }
 
+                // Nobody but the cache holds the volume, its image or its scalars
+                static bool isInactive(const CacheEntry& entry)
+                {
+                        if (!entry.Volume || entry.Volume.use_count() != 1 || !entry.Volume->ImageData)
+                        {
+                                return false;
+                        }
+                        vtkImageData* const imageData = entry.Volume->ImageData;
+                        vtkDataArray* const scalars = imageData->GetPointData()
+                                ? imageData->GetPointData()->GetScalars()
+                                : nullptr;
+                        return imageData->GetReferenceCount() == 1 && scalars && scalars->GetReferenceCount() == 1;
+                }
+
+                static bool isCompressible(const CacheEntry& entry)
+                {
+                        return !entry.Incompressible && !entry.Converting && isInactive(entry);
+                }
+
+                EntryMap::iterator waitForConversionLocked(std::unique_lock<std::mutex>& lock, const std::string& key)
+                {
+                        auto mapIt = m_entries.find(key);
+                        while (mapIt != m_entries.end() && mapIt->second.Converting)
+                        {
+                                m_converted.wait(lock);
+                                mapIt = m_entries.find(key);
+                        }
+                        return mapIt;
+                }
+
+                // The entry converted for the key, unless it was removed or replaced meanwhile
+                CacheEntry* finishConversionLocked(const std::string& key, const VolumePtr& volume)
+                {
+                        m_converted.notify_all();
+                        auto mapIt = m_entries.find(key);
+                        if (mapIt == m_entries.end() || mapIt->second.Volume != volume)
+                        {
+                                return nullptr;
+                        }
+                        mapIt->second.Converting = false;
+                        return &mapIt->second;
+                }
+
+                // The scalars are compressed without holding the lock; the entry is marked
+                // so a request for it waits meanwhile. A volume handed out is never changed:
+                // the entry gets a new volume holding the compressed slices instead.
+                bool compressLocked(std::unique_lock<std::mutex>& lock, const std::string& key)
+                {
+                        auto mapIt = m_entries.find(key);
+                        if (mapIt == m_entries.end() || !isCompressible(mapIt->second))
+                        {
+                                return false;
+                        }
+                        CacheEntry& entry = mapIt->second;
+                        const VolumePtr volume = entry.Volume;
+                        const vtkSmartPointer<vtkImageData> imageData = volume->ImageData;
+                        const std::size_t expandedBytes = entry.MemoryBytes;
+                        entry.Converting = true;
+                        lock.unlock();
+
+                        const auto started = std::chrono::steady_clock::now();
+                        std::shared_ptr<const isis::core::CompressedImageData> compressed
+                                = isis::core::CompressedImageData::compress(imageData);
+                        VolumePtr compressedVolume;
+                        if (compressed && compressed->compressedBytes() < expandedBytes)
+                        {
+                                compressedVolume = std::make_shared<isis::core::DicomVolume>(*volume);
+                                compressedVolume->ImageData = nullptr;
+                                compressedVolume->CompressedScalars = compressed;
+                        }
+                        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - started);
+
+                        lock.lock();
+                        CacheEntry* const converted = finishConversionLocked(key, volume);
+                        // A viewer that took the volume meanwhile keeps it expanded, so nothing would be freed
+                        if (!converted || volume.use_count() != 2 || imageData->GetReferenceCount() != 2)
+                        {
+                                return false;
+                        }
+                        if (!compressedVolume)
+                        {
+                                // Noise or fractional values: not worth trying again
+                                converted->Incompressible = true;
+                                return false;
+                        }
+
+                        const std::size_t compressedBytes = compressed->compressedBytes();
+                        isis::core::utils::telemetry().increment("volumecache.compress_saved_bytes",
+                                static_cast<std::uint64_t>(converted->MemoryBytes - std::min(converted->MemoryBytes, compressedBytes)));
+                        isis::core::utils::telemetry().recordDuration("volumecache.compress", elapsed);
+                        converted->Volume = std::move(compressedVolume);
+                        m_memoryBytes = m_memoryBytes - std::min(m_memoryBytes, converted->MemoryBytes) + compressedBytes;
+                        converted->MemoryBytes = compressedBytes;
+                        return true;
+                }
+
+                // The volume of the key's entry with its scalars expanded, or nullptr when
+                // they cannot be decoded; the decoding runs without holding the lock and
+                // the expanded volume replaces the compressed one rather than changing it
+                VolumePtr expandLocked(std::unique_lock<std::mutex>& lock, const std::string& key)
+                {
+                        auto mapIt = m_entries.find(key);
+                        if (mapIt == m_entries.end())
+                        {
+                                return nullptr;
+                        }
+                        CacheEntry& entry = mapIt->second;
+                        const VolumePtr volume = entry.Volume;
+                        const auto compressed = volume->CompressedScalars;
+                        if (!compressed)
+                        {
+                                return volume;
+                        }
+                        entry.Converting = true;
+                        lock.unlock();
+
+                        const auto started = std::chrono::steady_clock::now();
+                        VolumePtr expanded;
+                        if (auto imageData = compressed->decompress())
+                        {
+                                expanded = std::make_shared<isis::core::DicomVolume>(*volume);
+                                expanded->ImageData = imageData;
+                                expanded->CompressedScalars.reset();
+                        }
+
+                        lock.lock();
+                        CacheEntry* const converted = finishConversionLocked(key, volume);
+                        if (!expanded)
+                        {
+                                return nullptr;
+                        }
+                        if (converted)
+                        {
+                                converted->Volume = expanded;
+                                const std::size_t expandedBytes = calculateMemoryUsage(expanded);
+                                m_memoryBytes = m_memoryBytes - std::min(m_memoryBytes, converted->MemoryBytes) + expandedBytes;
+                                converted->MemoryBytes = expandedBytes;
+                        }
+                        isis::core::utils::telemetry().recordDuration("volumecache.expand",
+                                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+                        return expanded;
+                }
+
                 void touchLocked(CacheEntry& entry)
                 {
                         m_lru.splice(m_lru.begin(), m_lru, entry.LruIt);
@@ -269,8 +424,25 @@ namespace
                         return m_entries.erase(it);
                 }
 
-                void evictIfNeededLocked()
+                void evictIfNeededLocked(std::unique_lock<std::mutex>& lock)
                 {
+                        // Compress inactive volumes, least recently used first, before dropping any.
+                        // The lock is released while compressing, so the candidate is looked up again each time.
+                        while (m_memoryBytes > m_capacityBytes)
+                        {
+                                const auto candidate = std::find_if(m_lru.rbegin(), m_lru.rend(), [this](const std::string& t_key)
+                                {
+                                        const auto mapIt = m_entries.find(t_key);
+                                        return mapIt != m_entries.end() && isCompressible(mapIt->second);
+                                });
+                                if (candidate == m_lru.rend())
+                                {
+                                        break;
+                                }
+                                const std::string key = *candidate;
+                                compressLocked(lock, key);
+                        }
+
                         while (!m_lru.empty() && m_memoryBytes > m_capacityBytes)
                         {
                                 auto backIt = std::prev(m_lru.end());
@@ -282,7 +454,7 @@ namespace
                                         continue;
                                 }
 
-                                logVolumeCacheTelemetry("evict", mapIt->second.StudyUid, mapIt->second.SeriesUid);
+                                logVolumeCacheTelemetry("evict", "volumecache.evict", mapIt->second.StudyUid, mapIt->second.SeriesUid);
                                 removeEntryLocked(mapIt);
                         }
                 }
@@ -293,7 +465,7 @@ namespace
                         {
                                 if (it->second.StudyUid == studyUid)
                                 {
-                                        logVolumeCacheTelemetry("purge", it->second.StudyUid, it->second.SeriesUid);
+                                        logVolumeCacheTelemetry("purge", "volumecache.purge", it->second.StudyUid, it->second.SeriesUid);
                                         it = removeEntryLocked(it);
                                 }
                                 else
@@ -323,7 +495,8 @@ namespace
                         m_activeStudyUid = studyUid;
                 }
 
-                std::mutex m_mutex = {};
+                mutable std::mutex m_mutex = {};
+                std::condition_variable m_converted = {};
                 EntryMap m_entries = {};
                 std::list<std::string> m_lru = {};
                 std::size_t m_memoryBytes = 0;
@@ -359,6 +532,16 @@ namespace isis::core
                 cacheImpl().invalidateStudy(studyUid);
         }
 
+        void DicomVolumeCache::setCapacityBytes(std::size_t capacityBytes)
+        {
+                cacheImpl().setCapacityBytes(capacityBytes);
+        }
+
+        std::size_t DicomVolumeCache::residentBytes() const
+        {
+                return cacheImpl().residentBytes();
+        }
+
         DicomVolumeCache& volumeCache()
         {
                 static DicomVolumeCache cache;
@@ -12,7 +12,9 @@
 #pragma once
 
 #include "dicomvolume.h"
+#include "utils.h"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -20,7 +22,11 @@
 
 namespace isis::core
 {
-        class DicomVolumeCache
+        /**
+         * Volumes nobody else holds are compressed in place (see CompressedImageData)
+         * before any entry is evicted, and expanded again when they are requested.
+         */
+        class export DicomVolumeCache
         {
         public:
                 using VolumePtr = std::shared_ptr<DicomVolume>;
@@ -34,7 +40,14 @@ namespace isis::core
                         const std::string& seriesUid);
 
                 void invalidateStudy(const std::string& studyUid);
+
+                void setCapacityBytes(std::size_t capacityBytes);
+
+                /**
+                 * @brief Memory held by cached volumes, compressed ones at their compressed size
+                 */
+                [[nodiscard]] std::size_t residentBytes() const;
         };
 
-        DicomVolumeCache& volumeCache();
+        export DicomVolumeCache& volumeCache();
 }
@@ -282,4 +282,18 @@ namespace isis::core::metadata
                 normalizeVector(geometry.ColumnDirection);
                 normalizeVector(geometry.NormalDirection);
         }
+
+        std::vector<double> getNumericValues(const gdcm::DataSet& dataSet, const gdcm::Tag& tag)
+        {
+                if (!dataSet.FindDataElement(tag))
+                {
+                        return {};
+                }
+                const gdcm::ByteValue* byteValue = dataSet.GetDataElement(tag).GetByteValue();
+                if (!byteValue)
+                {
+                        return {};
+                }
+                return parseNumericList(std::string(byteValue->GetPointer(), byteValue->GetLength()));
+        }
 }
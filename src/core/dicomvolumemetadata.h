@@ -15,6 +15,8 @@
 
 #include <gdcmFile.h>
 
+#include <vector>
+
 namespace isis::core::metadata
 {
         struct DicomVolumeMetadata
@@ -29,4 +31,10 @@ namespace isis::core::metadata
         void populatePixelInfo(const gdcm::File& file, DicomPixelInfo& info);
         void populateGeometry(const gdcm::File& file, DicomGeometry& geometry);
         void normalizeDirections(DicomGeometry& geometry);
+
+        /**
+         * @brief Numeric values of a decimal or integer string attribute of any dataset,
+         *        including items of functional group sequences
+         */
+        std::vector<double> getNumericValues(const gdcm::DataSet& dataSet, const gdcm::Tag& tag);
 }
@@ -0,0 +1,216 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: gzipinputstream.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the streaming gzip input stream
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "gzipinputstream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+
+#include <vtk_zlib.h>
+
+namespace
+{
+        // 15-bit window, +32 to accept gzip and zlib headers
+        constexpr int kWindowBits = 15 + 32;
+}
+
+class isis::core::GzipInputStream::Buffer : public std::streambuf
+{
+public:
+        Buffer(const std::string& t_path, std::size_t t_bufferBytes)
+                : m_input(std::max<std::size_t>(t_bufferBytes, 1024))
+                , m_output(std::max<std::size_t>(t_bufferBytes, 1024))
+        {
+                m_file.open(t_path, std::ios::binary);
+                m_initialized = m_file && inflateInit2(&m_stream, kWindowBits) == Z_OK;
+                setg(m_output.data(), m_output.data(), m_output.data());
+        }
+
+        ~Buffer() override
+        {
+                if (m_initialized)
+                {
+                        inflateEnd(&m_stream);
+                }
+        }
+
+        [[nodiscard]] bool isOpen() const { return m_initialized; }
+
+protected:
+        int_type underflow() override
+        {
+                if (gptr() < egptr())
+                {
+                        return traits_type::to_int_type(*gptr());
+                }
+                m_outputStart += static_cast<std::uint64_t>(egptr() - eback());
+                setg(m_output.data(), m_output.data(), m_output.data());
+                const std::size_t produced = inflateMore();
+                if (produced == 0)
+                {
+                        return traits_type::eof();
+                }
+                setg(m_output.data(), m_output.data(), m_output.data() + produced);
+                return traits_type::to_int_type(*gptr());
+        }
+
+        pos_type seekoff(off_type t_offset, std::ios_base::seekdir t_direction, std::ios_base::openmode t_mode) override
+        {
+                if (!(t_mode & std::ios_base::in) || !m_initialized)
+                {
+                        return pos_type(off_type(-1));
+                }
+                off_type target = t_offset;
+                if (t_direction == std::ios_base::cur)
+                {
+                        target += static_cast<off_type>(position());
+                }
+                else if (t_direction == std::ios_base::end)
+                {
+                        // The uncompressed size is only known once the whole file is inflated
+                        while (underflowPast() != traits_type::eof())
+                        {
+                        }
+                        target += static_cast<off_type>(m_outputStart + static_cast<std::uint64_t>(egptr() - eback()));
+                }
+                return seekpos(pos_type(target), t_mode);
+        }
+
+        pos_type seekpos(pos_type t_position, std::ios_base::openmode t_mode) override
+        {
+                const auto target = static_cast<off_type>(t_position);
+                if (!(t_mode & std::ios_base::in) || !m_initialized || target < 0)
+                {
+                        return pos_type(off_type(-1));
+                }
+                const auto wanted = static_cast<std::uint64_t>(target);
+                if (wanted < m_outputStart && !rewind())
+                {
+                        return pos_type(off_type(-1));
+                }
+                while (wanted > m_outputStart + static_cast<std::uint64_t>(egptr() - eback()))
+                {
+                        if (underflowPast() == traits_type::eof())
+                        {
+                                return pos_type(off_type(-1));
+                        }
+                }
+                setg(eback(), eback() + static_cast<std::ptrdiff_t>(wanted - m_outputStart), egptr());
+                return t_position;
+        }
+
+private:
+        std::ifstream m_file;
+        z_stream m_stream = {};
+        bool m_initialized = false;
+        bool m_finished = false;
+        std::vector<char> m_input;
+        std::vector<char> m_output;
+        std::uint64_t m_outputStart = 0;        // Uncompressed offset of the output buffer
+
+        [[nodiscard]] std::uint64_t position() const
+        {
+                return m_outputStart + static_cast<std::uint64_t>(gptr() - eback());
+        }
+
+        // Drops the current output buffer and inflates the next one
+        int_type underflowPast()
+        {
+                setg(eback(), egptr(), egptr());
+                return underflow();
+        }
+
+        std::size_t inflateMore()
+        {
+                if (!m_initialized || m_finished)
+                {
+                        return 0;
+                }
+                m_stream.next_out = reinterpret_cast<Bytef*>(m_output.data());
+                m_stream.avail_out = static_cast<uInt>(m_output.size());
+                while (m_stream.avail_out == m_output.size())
+                {
+                        if (m_stream.avail_in == 0)
+                        {
+                                m_file.read(m_input.data(), static_cast<std::streamsize>(m_input.size()));
+                                m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+                                m_stream.avail_in = static_cast<uInt>(m_file.gcount());
+                                if (m_stream.avail_in == 0)
+                                {
+                                        m_finished = true;
+                                        break;
+                                }
+                        }
+                        const int status = inflate(&m_stream, Z_NO_FLUSH);
+                        if (status == Z_STREAM_END)
+                        {
+                                // Concatenated members (as written by some archivers) continue the stream
+                                if (m_stream.avail_in == 0 && m_file.peek() == std::char_traits<char>::eof())
+                                {
+                                        m_finished = true;
+                                        break;
+                                }
+                                inflateReset(&m_stream);
+                        }
+                        else if (status != Z_OK && status != Z_BUF_ERROR)
+                        {
+                                m_finished = true;
+                                break;
+                        }
+                }
+                return m_output.size() - m_stream.avail_out;
+        }
+
+        bool rewind()
+        {
+                m_file.clear();
+                m_file.seekg(0);
+                if (!m_file || inflateReset(&m_stream) != Z_OK)
+                {
+                        return false;
+                }
+                m_stream.avail_in = 0;
+                m_finished = false;
+                m_outputStart = 0;
+                setg(m_output.data(), m_output.data(), m_output.data());
+                return true;
+        }
+};
+
+//-----------------------------------------------------------------------------
+isis::core::GzipInputStream::GzipInputStream(const std::string& t_path, const std::size_t t_bufferBytes)
+        : std::istream(nullptr)
+        , m_buffer(std::make_unique<Buffer>(t_path, t_bufferBytes))
+{
+        rdbuf(m_buffer.get());
+        if (!m_buffer->isOpen())
+        {
+                setstate(std::ios::failbit);
+        }
+}
+
+//-----------------------------------------------------------------------------
+isis::core::GzipInputStream::~GzipInputStream() = default;
+
+//-----------------------------------------------------------------------------
+bool isis::core::GzipInputStream::isGzipFile(const std::string& t_path)
+{
+        std::ifstream file(t_path, std::ios::binary);
+        unsigned char magic[2] = {0, 0};
+        return file.read(reinterpret_cast<char*>(magic), 2) && magic[0] == 0x1F && magic[1] == 0x8B;
+}
@@ -0,0 +1,55 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: gzipinputstream.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Input stream over a gzip-compressed file, inflated through two bounded
+ *      buffers as it is read, so GDCM can parse .dcm.gz files without a
+ *      temporary file or the whole file in memory.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+#include "utils.h"
+
+namespace isis::core
+{
+        class export GzipInputStream : public std::istream
+        {
+        public:
+                static constexpr std::size_t DefaultBufferBytes = 64 * 1024;
+
+                /**
+                 * @brief Open t_path; the stream is in a failed state when it cannot be read
+                 *
+                 * Seeking forward inflates and skips; seeking backward inflates again from the
+                 * start of the file, which parsers only do over the first bytes.
+                 */
+                explicit GzipInputStream(const std::string& t_path, std::size_t t_bufferBytes = DefaultBufferBytes);
+                ~GzipInputStream() override;
+
+                GzipInputStream(const GzipInputStream&) = delete;
+                GzipInputStream& operator=(const GzipInputStream&) = delete;
+
+                /**
+                 * @brief Whether the file starts with the gzip magic bytes
+                 */
+                [[nodiscard]] static bool isGzipFile(const std::string& t_path);
+
+        private:
+                class Buffer;
+                std::unique_ptr<Buffer> m_buffer;
+        };
+}
@@ -0,0 +1,303 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: importscheduler.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the bounded import queue
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "importscheduler.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+        // Paths are UTF-8 (from QString::toStdString); compare folders in one spelling
+        std::string folderOf(const std::string& t_path)
+        {
+                return std::filesystem::u8path(t_path).parent_path().lexically_normal().generic_u8string();
+        }
+
+        std::size_t laneIndex(isis::core::ImportScheduler::Priority t_priority)
+        {
+                return static_cast<std::size_t>(t_priority);
+        }
+}
+
+isis::core::ImportScheduler::ImportScheduler(const std::size_t t_capacity)
+        : m_capacity(std::max<std::size_t>(t_capacity, 1))
+{
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::push(const std::string& t_path, const Priority t_priority)
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        enqueue({t_path, {}, isPriorityFolder(t_path) ? Priority::Interactive : t_priority});
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::beginRoot(const std::string& t_root)
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RootState& state = m_roots[t_root];
+        state.Scanning = true;
+        state.Cancelled = false;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::endRoot(const std::string& t_root)
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto root = m_roots.find(t_root);
+        if (root != m_roots.end())
+        {
+                root->second.Scanning = false;
+                releaseRoot(t_root);
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::ImportScheduler::pushScanned(const std::string& t_root, const std::string& t_path)
+{
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto refused = [&]()
+        {
+                const auto root = m_roots.find(t_root);
+                return m_closed || root == m_roots.end() || root->second.Cancelled;
+        };
+        if (!refused() && m_queued >= m_capacity)
+        {
+                ++m_scanWaits;
+                m_roomCondition.wait(lock, [&]() { return refused() || m_queued < m_capacity; });
+        }
+        if (refused())
+        {
+                return false;
+        }
+        ++m_roots[t_root].Queued;
+        enqueue({t_path, t_root, isPriorityFolder(t_path) ? Priority::Interactive : Priority::Background});
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<isis::core::ImportScheduler::Item> isis::core::ImportScheduler::tryPop()
+{
+        std::optional<Item> item;
+        {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& lane : m_lanes)
+                {
+                        if (lane.empty())
+                        {
+                                continue;
+                        }
+                        item = std::move(lane.front());
+                        lane.pop_front();
+                        --m_queued;
+                        break;
+                }
+                if (item && !item->Root.empty())
+                {
+                        const auto root = m_roots.find(item->Root);
+                        if (root != m_roots.end() && root->second.Queued > 0)
+                        {
+                                --root->second.Queued;
+                                releaseRoot(item->Root);
+                        }
+                }
+        }
+        if (item)
+        {
+                m_roomCondition.notify_one();
+        }
+        return item;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::prioritizeFoldersOf(const std::vector<std::string>& t_paths)
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_priorityFolders.clear();
+        for (const auto& path : t_paths)
+        {
+                m_priorityFolders.insert(folderOf(path));
+        }
+        if (m_priorityFolders.empty())
+        {
+                return;
+        }
+
+        // Move the matching paths ahead, keeping the order they were queued in
+        auto& interactive = m_lanes[laneIndex(Priority::Interactive)];
+        for (const Priority priority : {Priority::Normal, Priority::Background})
+        {
+                auto& lane = m_lanes[laneIndex(priority)];
+                std::deque<Item> remaining;
+                for (auto& item : lane)
+                {
+                        if (isPriorityFolder(item.Path))
+                        {
+                                item.Lane = Priority::Interactive;
+                                interactive.push_back(std::move(item));
+                        }
+                        else
+                        {
+                                remaining.push_back(std::move(item));
+                        }
+                }
+                lane.swap(remaining);
+        }
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::core::ImportScheduler::cancelRoot(const std::string& t_root)
+{
+        std::size_t dropped = 0;
+        {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto root = m_roots.find(t_root);
+                if (root == m_roots.end())
+                {
+                        return 0;
+                }
+                root->second.Cancelled = true;
+                root->second.Queued = 0;
+                for (auto& lane : m_lanes)
+                {
+                        const auto removed = std::remove_if(lane.begin(), lane.end(),
+                                [&t_root](const Item& t_item) { return t_item.Root == t_root; });
+                        dropped += static_cast<std::size_t>(std::distance(removed, lane.end()));
+                        lane.erase(removed, lane.end());
+                }
+                m_queued -= dropped;
+                m_cancelled += dropped;
+                releaseRoot(t_root);
+        }
+        m_roomCondition.notify_all();
+        return dropped;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::close()
+{
+        {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+        }
+        m_roomCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::reset()
+{
+        {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& lane : m_lanes)
+                {
+                        lane.clear();
+                }
+                m_roots.clear();
+                m_priorityFolders.clear();
+                m_queued = 0;
+                m_closed = false;
+                m_imported = 0;
+                m_cancelled = 0;
+                m_scanWaits = 0;
+                m_windowImported = 0;
+                m_windowStart = std::chrono::steady_clock::now();
+                m_filesPerSecond = 0.0;
+        }
+        m_roomCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::markImported()
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_imported;
+        ++m_windowImported;
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> elapsed = now - m_windowStart;
+        if (elapsed.count() >= 1.0)
+        {
+                m_filesPerSecond = static_cast<double>(m_windowImported) / elapsed.count();
+                m_windowImported = 0;
+                m_windowStart = now;
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::ImportScheduler::isEmpty() const
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queued == 0;
+}
+
+//-----------------------------------------------------------------------------
+isis::core::ImportScheduler::Statistics isis::core::ImportScheduler::statistics() const
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Statistics statistics;
+        statistics.Queued = m_queued;
+        statistics.Capacity = m_capacity;
+        statistics.ScanningRoots = static_cast<std::size_t>(std::count_if(m_roots.begin(), m_roots.end(),
+                [](const auto& t_root) { return t_root.second.Scanning && !t_root.second.Cancelled; }));
+        statistics.Imported = m_imported;
+        statistics.Cancelled = m_cancelled;
+        statistics.ScanWaits = m_scanWaits;
+        statistics.FilesPerSecond = m_filesPerSecond;
+        // A window that has not closed for a while means imports slowed down or stopped
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_windowStart;
+        if (elapsed.count() >= 2.0)
+        {
+                statistics.FilesPerSecond = static_cast<double>(m_windowImported) / elapsed.count();
+        }
+        return statistics;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::string> isis::core::ImportScheduler::activeRoots() const
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> roots;
+        for (const auto& [root, state] : m_roots)
+        {
+                if (!state.Cancelled)
+                {
+                        roots.push_back(root);
+                }
+        }
+        return roots;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::enqueue(Item t_item)
+{
+        m_lanes[laneIndex(t_item.Lane)].push_back(std::move(t_item));
+        ++m_queued;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::ImportScheduler::releaseRoot(const std::string& t_root)
+{
+        const auto root = m_roots.find(t_root);
+        if (root != m_roots.end() && !root->second.Scanning && root->second.Queued == 0)
+        {
+                m_roots.erase(root);
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::ImportScheduler::isPriorityFolder(const std::string& t_path) const
+{
+        return !m_priorityFolders.empty() && m_priorityFolders.count(folderOf(t_path)) > 0;
+}
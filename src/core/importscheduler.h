@@ -0,0 +1,164 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: importscheduler.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Bounded, prioritized queue of files waiting to be imported. Folder scans
+ *      wait while it is full, the folders of the series the user opened are
+ *      served first, and every path found under a folder can be cancelled.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+namespace isis::core
+{
+        class export ImportScheduler
+        {
+        public:
+                static constexpr std::size_t DefaultCapacity = 4096;
+
+                /**
+                 * @brief Lanes of the queue; lower values are served first
+                 */
+                enum class Priority
+                {
+                        Interactive = 0,        // Folders of the series the user is looking at
+                        Normal = 1,             // Files picked one by one, received objects
+                        Background = 2          // Folder scans
+                };
+
+                struct Item
+                {
+                        std::string Path;
+                        std::string Root;                       // Folder the path was found under (empty for single files)
+                        Priority Lane = Priority::Normal;
+                };
+
+                struct Statistics
+                {
+                        std::size_t Queued = 0;
+                        std::size_t Capacity = 0;
+                        std::size_t ScanningRoots = 0;
+                        std::uint64_t Imported = 0;
+                        std::uint64_t Cancelled = 0;
+                        std::uint64_t ScanWaits = 0;            // Times a folder scan waited for room
+                        double FilesPerSecond = 0.0;            // Over the last completed second
+                };
+
+                explicit ImportScheduler(std::size_t t_capacity = DefaultCapacity);
+
+                ImportScheduler(const ImportScheduler&) = delete;
+                ImportScheduler& operator=(const ImportScheduler&) = delete;
+
+                /**
+                 * @brief Queue a file picked by the user; never waits, so the bound only
+                 *        applies to folder scans
+                 */
+                void push(const std::string& t_path, Priority t_priority = Priority::Normal);
+
+                /**
+                 * @brief Start scanning t_root, clearing an earlier cancellation of it
+                 */
+                void beginRoot(const std::string& t_root);
+
+                /**
+                 * @brief The scan of t_root found every file
+                 */
+                void endRoot(const std::string& t_root);
+
+                /**
+                 * @brief Queue a file found under t_root, waiting while the queue is full
+                 * @return false when t_root was cancelled or the scheduler closed; the scan stops
+                 */
+                bool pushScanned(const std::string& t_root, const std::string& t_path);
+
+                /**
+                 * @brief Next path, Interactive lane first, then in the order queued
+                 */
+                [[nodiscard]] std::optional<Item> tryPop();
+
+                /**
+                 * @brief Serve queued and future paths in the folders of t_paths first
+                 */
+                void prioritizeFoldersOf(const std::vector<std::string>& t_paths);
+
+                /**
+                 * @brief Drop the queued paths of t_root and stop its scan
+                 * @return Number of paths dropped
+                 */
+                std::size_t cancelRoot(const std::string& t_root);
+
+                /**
+                 * @brief Release waiting scans and refuse further scanned paths
+                 */
+                void close();
+
+                /**
+                 * @brief Empty the queue and accept paths again
+                 */
+                void reset();
+
+                /**
+                 * @brief The consumer finished one file
+                 */
+                void markImported();
+
+                [[nodiscard]] bool isEmpty() const;
+                [[nodiscard]] Statistics statistics() const;
+
+                /**
+                 * @brief Folders being scanned or with paths still queued
+                 */
+                [[nodiscard]] std::vector<std::string> activeRoots() const;
+
+        private:
+                struct RootState
+                {
+                        std::size_t Queued = 0;
+                        bool Scanning = false;
+                        bool Cancelled = false;
+                };
+
+                mutable std::mutex m_mutex;
+                std::condition_variable m_roomCondition;        // Signals scans that paths were taken or dropped
+                std::array<std::deque<Item>, 3> m_lanes = {};
+                std::map<std::string, RootState> m_roots = {};
+                std::set<std::string> m_priorityFolders = {};
+                std::size_t m_capacity = DefaultCapacity;
+                std::size_t m_queued = 0;
+                bool m_closed = false;
+                std::uint64_t m_imported = 0;
+                std::uint64_t m_cancelled = 0;
+                std::uint64_t m_scanWaits = 0;
+                std::uint64_t m_windowImported = 0;
+                std::chrono::steady_clock::time_point m_windowStart = std::chrono::steady_clock::now();
+                double m_filesPerSecond = 0.0;
+
+                // m_mutex held for the helpers below
+                void enqueue(Item t_item);
+                void releaseRoot(const std::string& t_root);
+                [[nodiscard]] bool isPriorityFolder(const std::string& t_path) const;
+        };
+}
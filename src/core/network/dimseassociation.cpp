@@ -18,6 +18,8 @@
 #include <dcmtk/dcmnet/cond.h>
 #include <dcmtk/dcmdata/dcuid.h>
 #include <QLoggingCategory>
+#include <algorithm>
+#include <iterator>
 
 Q_DECLARE_LOGGING_CATEGORY(lcDimse)
 
@@ -79,6 +81,19 @@ namespace isis::core::network
     DimseStatus DimseAssociation::connect(const DicomPeer& peer,
                                          const LocalAEConfig& localAE,
                                          const std::vector<std::string>& presentationContexts)
+    {
+        std::vector<PresentationContextProposal> proposals;
+        proposals.reserve(presentationContexts.size());
+        for (const std::string& abstractSyntax : presentationContexts)
+        {
+            proposals.emplace_back(abstractSyntax);
+        }
+        return connect(peer, localAE, proposals);
+    }
+
+    DimseStatus DimseAssociation::connect(const DicomPeer& peer,
+                                         const LocalAEConfig& localAE,
+                                         const std::vector<PresentationContextProposal>& proposals)
     {
         std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -100,7 +115,7 @@ namespace isis::core::network
         }
 
         // Create association parameters
-        status = createAssociationParameters(presentationContexts);
+        status = createAssociationParameters(proposals);
         if (status != DimseStatus::Success)
         {
             cleanup();
@@ -169,6 +184,12 @@ namespace isis::core::network
         return DimseStatus::Success;
     }
 
+    bool DimseAssociation::supportsEcho() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_assoc && ASC_findAcceptedPresentationContextID(m_assoc, UID_VerificationSOPClass) != 0;
+    }
+
     bool DimseAssociation::hasTimedOut(int timeoutSeconds) const
     {
         if (!isConnected())
@@ -191,7 +212,7 @@ namespace isis::core::network
         return DimseStatus::Success;
     }
 
-    DimseStatus DimseAssociation::createAssociationParameters(const std::vector<std::string>& presentationContexts)
+    DimseStatus DimseAssociation::createAssociationParameters(const std::vector<PresentationContextProposal>& proposals)
     {
         OFCondition cond = ASC_createAssociationParameters(&m_params, m_peer.maxPduSize);
         if (cond.bad())
@@ -209,25 +230,53 @@ namespace isis::core::network
         ASC_setPresentationAddresses(m_params, "localhost", peerAddress.c_str());
 
         // Add presentation contexts
-        std::vector<std::string> contexts = presentationContexts.empty() ?
-            getDefaultPresentationContexts() : presentationContexts;
+        std::vector<PresentationContextProposal> contexts = proposals;
+        if (contexts.empty())
+        {
+            for (const std::string& abstractSyntax : getDefaultPresentationContexts())
+            {
+                contexts.emplace_back(abstractSyntax);
+            }
+        }
 
-        const char* transferSyntaxes[] = {
+        const char* defaultTransferSyntaxes[] = {
             UID_LittleEndianImplicitTransferSyntax,
             UID_LittleEndianExplicitTransferSyntax,
             UID_BigEndianExplicitTransferSyntax
         };
-        int numTransferSyntaxes = 3;
 
         int presentationContextID = 1;
-        for (const std::string& abstractSyntax : contexts)
+        for (const PresentationContextProposal& proposal : contexts)
         {
+            // Presentation context IDs are odd numbers in [1, 255]
+            if (presentationContextID > 255)
+            {
+                qCWarning(lcDimse) << "Too many presentation contexts, ignoring"
+                                   << proposal.abstractSyntax.c_str();
+                break;
+            }
+
+            std::vector<const char*> transferSyntaxes;
+            if (proposal.transferSyntaxes.empty())
+            {
+                transferSyntaxes.assign(std::begin(defaultTransferSyntaxes), std::end(defaultTransferSyntaxes));
+            }
+            else
+            {
+                for (const std::string& transferSyntax : proposal.transferSyntaxes)
+                {
+                    transferSyntaxes.push_back(transferSyntax.c_str());
+                }
+            }
+
             cond = ASC_addPresentationContext(m_params, presentationContextID,
-                                             abstractSyntax.c_str(),
-                                             transferSyntaxes, numTransferSyntaxes);
+                                             proposal.abstractSyntax.c_str(),
+                                             transferSyntaxes.data(),
+                                             static_cast<int>(transferSyntaxes.size()),
+                                             proposal.role);
             if (cond.bad())
             {
-                qCWarning(lcDimse) << "Failed to add presentation context:" << abstractSyntax.c_str();
+                qCWarning(lcDimse) << "Failed to add presentation context:" << proposal.abstractSyntax.c_str();
             }
             presentationContextID += 2; // Must be odd numbers
         }
@@ -295,95 +344,255 @@ namespace isis::core::network
     // DimseConnectionPool implementation
 
     DimseConnectionPool::DimseConnectionPool(size_t maxPoolSize)
-        : m_maxPoolSize(maxPoolSize)
+        : m_maxPoolSize(std::max<size_t>(1, maxPoolSize))
     {
+        m_evictionThread = std::thread(&DimseConnectionPool::evictionLoop, this);
     }
 
     DimseConnectionPool::~DimseConnectionPool()
     {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            for (auto& pair : m_peers)
+            {
+                pair.second->slotAvailable.notify_all();
+            }
+        }
+        m_evictionCondition.notify_all();
+        if (m_evictionThread.joinable())
+        {
+            m_evictionThread.join();
+        }
+
         clear();
     }
 
     std::shared_ptr<DimseAssociation> DimseConnectionPool::acquire(const DicomPeer& peer,
                                                                     const LocalAEConfig& localAE)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        return acquireImpl(peer, localAE, {});
+    }
 
-        std::string key = getPeerKey(peer);
+    std::shared_ptr<DimseAssociation> DimseConnectionPool::acquire(const DicomPeer& peer,
+                                                                    const LocalAEConfig& localAE,
+                                                                    const std::vector<PresentationContextProposal>& proposals)
+    {
+        return acquireImpl(peer, localAE, proposals);
+    }
+
+    std::shared_ptr<DimseAssociation> DimseConnectionPool::acquireImpl(const DicomPeer& peer,
+                                                                        const LocalAEConfig& localAE,
+                                                                        const std::vector<PresentationContextProposal>& proposals)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const std::string peerKey = getPeerKey(peer);
+        const std::string signature = contextSignature(proposals);
 
-        // Clean up stale connections periodically
-        cleanupStaleConnections();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const std::chrono::milliseconds waitLimit = m_acquireTimeout.count() > 0 ?
+            m_acquireTimeout : std::chrono::milliseconds(std::max(1, peer.timeout) * 1000);
+        const auto deadline = start + waitLimit;
+        PeerPool& pool = peerPool(peerKey);
 
-        // Check if we have an available connection in the pool
-        if (m_pool.find(key) != m_pool.end() && !m_pool[key].empty())
+        while (!m_stopping)
         {
-            auto& queue = m_pool[key];
-            while (!queue.empty())
+            // 1. Reuse the most recently released association with the same contexts
+            auto idleIt = pool.idle.find(signature);
+            if (idleIt != pool.idle.end() && !idleIt->second.empty())
             {
-                PoolEntry entry = queue.front();
-                queue.pop();
+                PoolEntry entry = idleIt->second.back();
+                idleIt->second.pop_back();
+                pool.idleCount--;
+                pool.inUse++;
+
+                const bool needsProbe = std::chrono::steady_clock::now() - entry.lastUsed >= m_healthCheckThreshold;
+                lock.unlock();
+                bool healthy = entry.assoc->isConnected();
+                // Store and retrieve associations usually do not negotiate Verification;
+                // those are reused unprobed and a dead one fails on its first request
+                if (healthy && needsProbe && entry.assoc->supportsEcho())
+                {
+                    healthy = entry.assoc->sendEcho(peer.timeout) == DimseStatus::Success;
+                }
+                lock.lock();
 
-                if (entry.assoc->isConnected() && !entry.assoc->hasTimedOut(300))
+                if (healthy)
                 {
-                    entry.inUse = true;
-                    entry.lastUsed = std::chrono::system_clock::now();
-                    m_activeConnections++;
-                    qCInfo(lcDimse) << "Reusing pooled connection to" << peer.aeTitle.c_str();
+                    m_checkedOut[entry.assoc.get()] = {peerKey, signature};
+                    recordAcquireLocked(start, true);
+                    qCDebug(lcDimse) << "Reusing pooled connection to" << peer.aeTitle.c_str();
                     return entry.assoc;
                 }
+
+                pool.inUse--;
+                m_metrics.healthCheckFailures++;
+                pool.slotAvailable.notify_one();
+                lock.unlock();
+                qCInfo(lcDimse) << "Pooled connection to" << peer.aeTitle.c_str() << "failed health check";
+                entry.assoc->disconnect();
+                lock.lock();
+                continue;
+            }
+
+            // 2. Free slot: negotiate a new association without holding the pool lock
+            if (pool.inUse + pool.connecting + pool.idleCount < m_maxPoolSize)
+            {
+                pool.connecting++;
+                m_metrics.connectAttempts++;
+                lock.unlock();
+
+                auto assoc = std::make_shared<DimseAssociation>();
+                DimseStatus status = proposals.empty() ?
+                    assoc->connect(peer, localAE) :
+                    assoc->connect(peer, localAE, proposals);
+
+                lock.lock();
+                pool.connecting--;
+
+                if (status != DimseStatus::Success)
+                {
+                    m_metrics.connectFailures++;
+                    pool.slotAvailable.notify_one();
+                    qCWarning(lcDimse) << "Failed to create new connection:" << statusToString(status).c_str();
+                    return nullptr;
+                }
+
+                pool.inUse++;
+                m_checkedOut[assoc.get()] = {peerKey, signature};
+                recordAcquireLocked(start, false);
+                return assoc;
+            }
+
+            // 3. Slots are held by idle associations with other contexts: close the oldest
+            if (pool.idleCount > 0)
+            {
+                std::shared_ptr<DimseAssociation> victim;
+                for (auto& [otherSignature, entries] : pool.idle)
+                {
+                    if (!entries.empty())
+                    {
+                        victim = entries.front().assoc;
+                        entries.pop_front();
+                        break;
+                    }
+                }
+                pool.idleCount--;
+                m_metrics.evictions++;
+                lock.unlock();
+                if (victim)
+                {
+                    victim->disconnect();
+                }
+                lock.lock();
+                continue;
+            }
+
+            // 4. Saturated: wait for a release until the deadline
+            if (pool.slotAvailable.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                m_metrics.acquireTimeouts++;
+                qCWarning(lcDimse) << "Timed out waiting for a connection to" << peer.aeTitle.c_str()
+                                   << "(" << pool.inUse << "in use)";
+                return nullptr;
             }
         }
 
-        // Create new connection
-        auto assoc = std::make_shared<DimseAssociation>();
-        DimseStatus status = assoc->connect(peer, localAE);
+        return nullptr;
+    }
 
-        if (status != DimseStatus::Success)
+    void DimseConnectionPool::recordAcquireLocked(std::chrono::steady_clock::time_point start, bool reused)
+    {
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        m_metrics.acquisitions++;
+        if (reused)
         {
-            qCWarning(lcDimse) << "Failed to create new connection:" << statusToString(status).c_str();
-            return nullptr;
+            m_metrics.reuses++;
         }
-
-        m_activeConnections++;
-        return assoc;
+        m_totalAcquireMs += elapsedMs;
+        m_metrics.maxAcquireMs = std::max(m_metrics.maxAcquireMs, elapsedMs);
     }
 
     void DimseConnectionPool::release(std::shared_ptr<DimseAssociation> assoc)
+    {
+        returnToPool(std::move(assoc), true);
+    }
+
+    void DimseConnectionPool::discard(std::shared_ptr<DimseAssociation> assoc)
+    {
+        returnToPool(std::move(assoc), false);
+    }
+
+    void DimseConnectionPool::returnToPool(std::shared_ptr<DimseAssociation> assoc, bool keepOpen)
     {
         if (!assoc)
             return;
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_lock<std::mutex> lock(m_mutex);
 
-        std::string key = getPeerKey(assoc->getPeer());
+        auto it = m_checkedOut.find(assoc.get());
+        if (it == m_checkedOut.end())
+        {
+            // Not handed out by this pool (or released twice)
+            lock.unlock();
+            assoc->disconnect();
+            return;
+        }
 
-        // For now always drop the association to avoid reusing stale DIMSE connections
-        assoc->disconnect();
-        qCInfo(lcDimse) << "Released association (connection closed)";
+        const CheckedOut owner = it->second;
+        m_checkedOut.erase(it);
+
+        PeerPool& pool = peerPool(owner.peerKey);
+        if (pool.inUse > 0)
+            pool.inUse--;
+
+        if (keepOpen && !m_stopping && assoc->isConnected())
+        {
+            pool.idle[owner.signature].push_back({assoc, std::chrono::steady_clock::now()});
+            pool.idleCount++;
+            pool.slotAvailable.notify_one();
+            return;
+        }
 
-        if (m_activeConnections > 0)
-            m_activeConnections--;
+        pool.slotAvailable.notify_one();
+        lock.unlock();
+
+        assoc->disconnect();
+        qCDebug(lcDimse) << "Released association (connection closed)";
     }
 
     void DimseConnectionPool::clear()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        for (auto& pair : m_pool)
+        std::vector<std::shared_ptr<DimseAssociation>> toClose;
         {
-            while (!pair.second.empty())
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (auto& pair : m_peers)
             {
-                auto entry = pair.second.front();
-                pair.second.pop();
-                if (entry.assoc)
+                PeerPool& pool = *pair.second;
+                for (auto& [signature, entries] : pool.idle)
                 {
-                    entry.assoc->disconnect();
+                    for (PoolEntry& entry : entries)
+                    {
+                        toClose.push_back(std::move(entry.assoc));
+                    }
                 }
+                pool.idle.clear();
+                pool.idleCount = 0;
+                pool.slotAvailable.notify_all();
+            }
+        }
+
+        for (auto& assoc : toClose)
+        {
+            if (assoc)
+            {
+                assoc->disconnect();
             }
         }
 
-        m_pool.clear();
-        m_activeConnections = 0;
         qCInfo(lcDimse) << "Connection pool cleared";
     }
 
@@ -391,9 +600,9 @@ namespace isis::core::network
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         size_t total = 0;
-        for (const auto& pair : m_pool)
+        for (const auto& pair : m_peers)
         {
-            total += pair.second.size();
+            total += pair.second->idleCount;
         }
         return total;
     }
@@ -401,7 +610,52 @@ namespace isis::core::network
     size_t DimseConnectionPool::getActiveConnections() const
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        return m_activeConnections;
+        return m_checkedOut.size();
+    }
+
+    ConnectionPoolMetrics DimseConnectionPool::getMetrics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        ConnectionPoolMetrics metrics = m_metrics;
+        metrics.inFlight = m_checkedOut.size();
+        metrics.idle = 0;
+        metrics.connecting = 0;
+        for (const auto& pair : m_peers)
+        {
+            metrics.idle += pair.second->idleCount;
+            metrics.connecting += pair.second->connecting;
+        }
+        metrics.meanAcquireMs = m_metrics.acquisitions > 0 ?
+            m_totalAcquireMs / static_cast<double>(m_metrics.acquisitions) : 0.0;
+        return metrics;
+    }
+
+    void DimseConnectionPool::setAcquireTimeout(std::chrono::milliseconds timeout)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_acquireTimeout = timeout;
+    }
+
+    void DimseConnectionPool::setHealthCheckThreshold(std::chrono::milliseconds idleTime)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_healthCheckThreshold = idleTime;
+    }
+
+    void DimseConnectionPool::setMaxIdleTime(std::chrono::milliseconds idleTime)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxIdleTime = idleTime;
+    }
+
+    void DimseConnectionPool::setEvictionInterval(std::chrono::milliseconds interval)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_evictionInterval = std::max(std::chrono::milliseconds(10), interval);
+        }
+        m_evictionCondition.notify_all();
     }
 
     std::string DimseConnectionPool::getPeerKey(const DicomPeer& peer) const
@@ -409,33 +663,101 @@ namespace isis::core::network
         return peer.aeTitle + "@" + peer.hostname + ":" + std::to_string(peer.port);
     }
 
-    void DimseConnectionPool::cleanupStaleConnections()
+    std::string DimseConnectionPool::contextSignature(const std::vector<PresentationContextProposal>& proposals)
     {
-        auto now = std::chrono::system_clock::now();
+        std::string signature;
+        for (const PresentationContextProposal& proposal : proposals)
+        {
+            signature += proposal.abstractSyntax;
+            for (const std::string& transferSyntax : proposal.transferSyntaxes)
+            {
+                signature += ",";
+                signature += transferSyntax;
+            }
+            if (proposal.role != ASC_SC_ROLE_DEFAULT)
+            {
+                signature += "/" + std::to_string(static_cast<int>(proposal.role));
+            }
+            signature += ";";
+        }
+        return signature;
+    }
+
+    DimseConnectionPool::PeerPool& DimseConnectionPool::peerPool(const std::string& peerKey)
+    {
+        auto& pool = m_peers[peerKey];
+        if (!pool)
+        {
+            pool = std::make_unique<PeerPool>();
+        }
+        return *pool;
+    }
 
-        for (auto& pair : m_pool)
+    void DimseConnectionPool::evictionLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping)
         {
-            std::queue<PoolEntry> newQueue;
+            m_evictionCondition.wait_for(lock, m_evictionInterval);
+            if (m_stopping)
+                break;
 
-            while (!pair.second.empty())
-            {
-                PoolEntry entry = pair.second.front();
-                pair.second.pop();
+            lock.unlock();
+            cleanupStaleConnections();
+            lock.lock();
+        }
+    }
+
+    void DimseConnectionPool::cleanupStaleConnections()
+    {
+        std::vector<std::shared_ptr<DimseAssociation>> toClose;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto now = std::chrono::steady_clock::now();
 
-                // Keep connections that are still valid
-                auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - entry.lastUsed);
-                if (elapsed.count() < 300 && entry.assoc->isConnected())
+            for (auto& pair : m_peers)
+            {
+                PeerPool& pool = *pair.second;
+                for (auto& [signature, entries] : pool.idle)
                 {
-                    newQueue.push(entry);
+                    for (auto it = entries.begin(); it != entries.end();)
+                    {
+                        T_ASC_Association* association = it->assoc->getAssociation();
+
+                        // Idle associations receive nothing unless the peer released,
+                        // aborted or closed the connection
+                        const bool expired = now - it->lastUsed >= m_maxIdleTime;
+                        const bool dead = association == nullptr || ASC_dataWaiting(association, 0);
+
+                        if (expired || dead)
+                        {
+                            toClose.push_back(std::move(it->assoc));
+                            it = entries.erase(it);
+                            pool.idleCount--;
+                            m_metrics.evictions++;
+                        }
+                        else
+                        {
+                            ++it;
+                        }
+                    }
                 }
-                else
+
+                if (!toClose.empty())
                 {
-                    entry.assoc->disconnect();
-                    qCInfo(lcDimse) << "Cleaned up stale connection";
+                    pool.slotAvailable.notify_all();
                 }
             }
+        }
 
-            pair.second = newQueue;
+        for (auto& assoc : toClose)
+        {
+            assoc->disconnect();
+        }
+
+        if (!toClose.empty())
+        {
+            qCInfo(lcDimse) << "Evicted" << toClose.size() << "idle connection(s)";
         }
     }
 
@@ -21,9 +21,13 @@
 #include <string>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <chrono>
+#include <thread>
+#include <vector>
 #include "../utils.h"
 #include "dimseconfig.h"
 
@@ -56,6 +60,25 @@ namespace isis::core::network
      */
     std::string statusToString(DimseStatus status);
 
+    /**
+     * @brief Presentation context to propose: one abstract syntax and its transfer syntaxes
+     *
+     * An empty transfer syntax list proposes the uncompressed defaults
+     * (Implicit VR LE, Explicit VR LE, Explicit VR BE). Storage contexts used by
+     * C-GET sub-operations are proposed with the SCP role.
+     */
+    struct PresentationContextProposal
+    {
+        std::string abstractSyntax;
+        std::vector<std::string> transferSyntaxes;
+        T_ASC_SC_ROLE role = ASC_SC_ROLE_DEFAULT;
+
+        PresentationContextProposal() = default;
+        PresentationContextProposal(std::string abstract, std::vector<std::string> transfers = {},
+                                    T_ASC_SC_ROLE proposedRole = ASC_SC_ROLE_DEFAULT)
+            : abstractSyntax(std::move(abstract)), transferSyntaxes(std::move(transfers)), role(proposedRole) {}
+    };
+
     /**
      * @brief Wrapper around T_ASC_Association for DICOM network operations
      */
@@ -80,6 +103,17 @@ namespace isis::core::network
                            const LocalAEConfig& localAE,
                            const std::vector<std::string>& presentationContexts = {});
 
+        /**
+         * @brief Connect to a DICOM peer proposing explicit transfer syntaxes per context
+         * @param peer Peer configuration
+         * @param localAE Local AE configuration
+         * @param proposals Presentation contexts to propose (defaults when empty)
+         * @return Status of connection attempt
+         */
+        DimseStatus connect(const DicomPeer& peer,
+                           const LocalAEConfig& localAE,
+                           const std::vector<PresentationContextProposal>& proposals);
+
         /**
          * @brief Disconnect and release association
          */
@@ -106,6 +140,11 @@ namespace isis::core::network
          */
         DimseStatus sendEcho(int timeout = 30);
 
+        /**
+         * @brief True when the peer accepted the Verification SOP class, so C-ECHO can be sent
+         */
+        bool supportsEcho() const;
+
         /**
          * @brief Get last error message
          */
@@ -133,36 +172,83 @@ namespace isis::core::network
 
         // Helper methods
         DimseStatus initializeNetwork();
-        DimseStatus createAssociationParameters(const std::vector<std::string>& presentationContexts);
+        DimseStatus createAssociationParameters(const std::vector<PresentationContextProposal>& proposals);
         DimseStatus requestAssociation();
         void cleanup();
         std::vector<std::string> getDefaultPresentationContexts();
     };
 
+    /**
+     * @brief Connection pool counters
+     */
+    struct ConnectionPoolMetrics
+    {
+        std::uint64_t acquisitions = 0;         // Successful acquire() calls
+        std::uint64_t reuses = 0;               // Served from an idle association
+        std::uint64_t connectAttempts = 0;
+        std::uint64_t connectFailures = 0;
+        std::uint64_t healthCheckFailures = 0;  // Idle associations that failed the C-ECHO probe
+        std::uint64_t acquireTimeouts = 0;      // Waiters that gave up at their deadline
+        std::uint64_t evictions = 0;            // Idle associations closed by the pool
+        std::size_t inFlight = 0;               // Associations currently handed out
+        std::size_t connecting = 0;
+        std::size_t idle = 0;
+        double meanAcquireMs = 0.0;
+        double maxAcquireMs = 0.0;
+
+        double reuseRate() const
+        {
+            return acquisitions > 0 ? static_cast<double>(reuses) / static_cast<double>(acquisitions) : 0.0;
+        }
+    };
+
     /**
      * @brief Connection pool for managing multiple DIMSE associations
+     *
+     * Each peer has its own sub-pool bounded by maxPoolSize. Associations are
+     * negotiated outside the pool lock; callers that find the peer saturated wait
+     * for a release until their deadline. Idle associations are probed with
+     * C-ECHO before being handed out again, and a background thread closes
+     * associations that were idle for too long or were closed by the peer.
      */
     class export DimseConnectionPool
     {
     public:
-        DimseConnectionPool(size_t maxPoolSize = 5);
+        explicit DimseConnectionPool(size_t maxPoolSize = 5);
         ~DimseConnectionPool();
 
+        DimseConnectionPool(const DimseConnectionPool&) = delete;
+        DimseConnectionPool& operator=(const DimseConnectionPool&) = delete;
+
         /**
          * @brief Acquire an association from the pool or create new one
          * @param peer Peer to connect to
          * @param localAE Local AE configuration
-         * @return Shared pointer to association (nullptr on failure)
+         * @return Shared pointer to association (nullptr on failure or timeout)
          */
         std::shared_ptr<DimseAssociation> acquire(const DicomPeer& peer,
                                                    const LocalAEConfig& localAE);
 
+        /**
+         * @brief Acquire an association negotiating the given presentation contexts
+         *
+         * Idle associations are only reused when they were negotiated with the same proposals.
+         */
+        std::shared_ptr<DimseAssociation> acquire(const DicomPeer& peer,
+                                                   const LocalAEConfig& localAE,
+                                                   const std::vector<PresentationContextProposal>& proposals);
+
         /**
          * @brief Release association back to pool
-         * @param assoc Association to release
+         * @param assoc Association to release (kept open for reuse if still connected)
          */
         void release(std::shared_ptr<DimseAssociation> assoc);
 
+        /**
+         * @brief Close an association whose protocol state is unknown (e.g. after a failed operation)
+         */
+        void discard(std::shared_ptr<DimseAssociation> assoc);
+
         /**
          * @brief Clear all pooled connections
          */
@@ -173,22 +259,77 @@ namespace isis::core::network
          */
         size_t getPoolSize() const;
         size_t getActiveConnections() const;
+        size_t getMaxPoolSize() const { return m_maxPoolSize; }
+        ConnectionPoolMetrics getMetrics() const;
+
+        /**
+         * @brief Maximum time acquire() waits for a free slot (0 = the peer's timeout)
+         */
+        void setAcquireTimeout(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Idle associations older than this are probed with C-ECHO before reuse,
+         * when their contexts include Verification (default 30 s)
+         */
+        void setHealthCheckThreshold(std::chrono::milliseconds idleTime);
+
+        /**
+         * @brief Idle associations older than this are closed by the eviction thread
+         */
+        void setMaxIdleTime(std::chrono::milliseconds idleTime);
+
+        /**
+         * @brief Period of the background eviction pass
+         */
+        void setEvictionInterval(std::chrono::milliseconds interval);
 
     private:
         struct PoolEntry
         {
             std::shared_ptr<DimseAssociation> assoc;
-            std::chrono::system_clock::time_point lastUsed;
-            bool inUse = false;
+            std::chrono::steady_clock::time_point lastUsed;
+        };
+
+        struct PeerPool
+        {
+            std::map<std::string, std::deque<PoolEntry>> idle;  // Keyed by context signature
+            size_t idleCount = 0;
+            size_t inUse = 0;
+            size_t connecting = 0;
+            std::condition_variable slotAvailable;
+        };
+
+        struct CheckedOut
+        {
+            std::string peerKey;
+            std::string signature;
         };
 
-        std::map<std::string, std::queue<PoolEntry>> m_pool;
+        std::map<std::string, std::unique_ptr<PeerPool>> m_peers;  // Never erased while the pool lives
+        std::map<const DimseAssociation*, CheckedOut> m_checkedOut;
         size_t m_maxPoolSize;
-        size_t m_activeConnections = 0;
+        std::chrono::milliseconds m_acquireTimeout{0};
+        std::chrono::milliseconds m_healthCheckThreshold{30000};
+        std::chrono::milliseconds m_maxIdleTime{300000};
+        std::chrono::milliseconds m_evictionInterval{15000};
+        ConnectionPoolMetrics m_metrics;
+        double m_totalAcquireMs = 0.0;
+        bool m_stopping = false;
         mutable std::mutex m_mutex;
 
+        std::thread m_evictionThread;
+        std::condition_variable m_evictionCondition;
+
         // Helper methods
         std::string getPeerKey(const DicomPeer& peer) const;
+        static std::string contextSignature(const std::vector<PresentationContextProposal>& proposals);
+        PeerPool& peerPool(const std::string& peerKey);
+        std::shared_ptr<DimseAssociation> acquireImpl(const DicomPeer& peer,
+                                                      const LocalAEConfig& localAE,
+                                                      const std::vector<PresentationContextProposal>& proposals);
+        void recordAcquireLocked(std::chrono::steady_clock::time_point start, bool reused);
+        void returnToPool(std::shared_ptr<DimseAssociation> assoc, bool keepOpen);
+        void evictionLoop();
         void cleanupStaleConnections();
     };
 
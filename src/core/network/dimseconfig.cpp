@@ -151,6 +151,18 @@ namespace isis::core::network
                         << "port:" << config.storagePort;
     }
 
+    void DimseConfig::setPrefetchRules(const PrefetchRules& rules)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_prefetchRules = rules;
+    }
+
+    PrefetchRules DimseConfig::getPrefetchRules() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_prefetchRules;
+    }
+
     bool DimseConfig::loadFromFile(const std::string& filepath)
     {
         QFile file(QString::fromStdString(filepath));
@@ -180,11 +192,38 @@ namespace isis::core::network
             config.storagePort = localAE["storagePort"].toInt(11112);
             config.tempStoragePath = localAE["tempStoragePath"].toString().toStdString();
             config.maxConnections = localAE["maxConnections"].toInt(5);
+            config.maxAssociationsPerAE = localAE["maxAssociationsPerAE"].toInt(2);
             config.maxPduSize = localAE["maxPduSize"].toInt(16384);
             config.enableStorage = localAE["enableStorage"].toBool(true);
+            config.hierarchicalStorage = localAE["hierarchicalStorage"].toBool(true);
+            config.duplicatePolicy = localAE["duplicatePolicy"].toString("replace") == "keep"
+                ? DuplicateSopPolicy::KeepExisting
+                : DuplicateSopPolicy::Replace;
+            config.retentionDays = std::max(0, localAE["retentionDays"].toInt(0));
+            config.acceptCompressed = localAE["acceptCompressed"].toBool(true);
             setLocalAEConfig(config);
         }
 
+        // Load prior prefetch rules
+        if (root.contains("prefetch"))
+        {
+            QJsonObject prefetch = root["prefetch"].toObject();
+            PrefetchRules rules;
+            rules.enabled = prefetch["enabled"].toBool(false);
+            rules.peerId = prefetch["peerId"].toString().toStdString();
+            rules.sameModality = prefetch["sameModality"].toBool(true);
+            for (const QJsonValue& modality : prefetch["modalities"].toArray())
+            {
+                rules.modalities.push_back(modality.toString().toStdString());
+            }
+            rules.matchBodyPart = prefetch["matchBodyPart"].toBool(true);
+            rules.maxAgeDays = std::max(0, prefetch["maxAgeDays"].toInt(1825));
+            rules.maxPriors = std::max(0, prefetch["maxPriors"].toInt(3));
+            rules.bandwidthKBps = std::max(0, prefetch["bandwidthKBps"].toInt(0));
+            rules.diskQuotaMB = std::max(0, prefetch["diskQuotaMB"].toInt(0));
+            setPrefetchRules(rules);
+        }
+
         // Load peers
         if (root.contains("peers") && root["peers"].isArray())
         {
@@ -205,6 +244,8 @@ namespace isis::core::network
                 peer.timeout = peerObj["timeout"].toInt(30);
                 peer.maxPduSize = peerObj["maxPduSize"].toInt(16384);
                 peer.moveDestinationAE = peerObj["moveDestinationAE"].toString().toStdString();
+                peer.useCGet = peerObj["useCGet"].toBool(false);
+                peer.compressStore = peerObj["compressStore"].toBool(false);
 
                 if (peerObj.contains("sopClasses") && peerObj["sopClasses"].isArray())
                 {
@@ -245,10 +286,35 @@ namespace isis::core::network
         localAE["storagePort"] = m_localConfig.storagePort;
         localAE["tempStoragePath"] = QString::fromStdString(m_localConfig.tempStoragePath);
         localAE["maxConnections"] = m_localConfig.maxConnections;
+        localAE["maxAssociationsPerAE"] = m_localConfig.maxAssociationsPerAE;
         localAE["maxPduSize"] = m_localConfig.maxPduSize;
         localAE["enableStorage"] = m_localConfig.enableStorage;
+        localAE["hierarchicalStorage"] = m_localConfig.hierarchicalStorage;
+        localAE["duplicatePolicy"] = m_localConfig.duplicatePolicy == DuplicateSopPolicy::KeepExisting
+            ? "keep"
+            : "replace";
+        localAE["retentionDays"] = m_localConfig.retentionDays;
+        localAE["acceptCompressed"] = m_localConfig.acceptCompressed;
         root["localAE"] = localAE;
 
+        // Save prior prefetch rules
+        QJsonObject prefetch;
+        prefetch["enabled"] = m_prefetchRules.enabled;
+        prefetch["peerId"] = QString::fromStdString(m_prefetchRules.peerId);
+        prefetch["sameModality"] = m_prefetchRules.sameModality;
+        QJsonArray modalities;
+        for (const auto& modality : m_prefetchRules.modalities)
+        {
+            modalities.append(QString::fromStdString(modality));
+        }
+        prefetch["modalities"] = modalities;
+        prefetch["matchBodyPart"] = m_prefetchRules.matchBodyPart;
+        prefetch["maxAgeDays"] = m_prefetchRules.maxAgeDays;
+        prefetch["maxPriors"] = m_prefetchRules.maxPriors;
+        prefetch["bandwidthKBps"] = m_prefetchRules.bandwidthKBps;
+        prefetch["diskQuotaMB"] = m_prefetchRules.diskQuotaMB;
+        root["prefetch"] = prefetch;
+
         // Save peers
         QJsonArray peersArray;
         for (const auto& pair : m_peers)
@@ -264,6 +330,8 @@ namespace isis::core::network
             peerObj["timeout"] = peer.timeout;
             peerObj["maxPduSize"] = peer.maxPduSize;
             peerObj["moveDestinationAE"] = QString::fromStdString(peer.moveDestinationAE);
+            peerObj["useCGet"] = peer.useCGet;
+            peerObj["compressStore"] = peer.compressStore;
 
             QJsonArray sopArray;
             for (const std::string& sop : peer.sopClasses)
@@ -406,8 +474,14 @@ namespace isis::core::network
         m_localConfig.storagePort = 11112;
         m_localConfig.tempStoragePath = getDefaultTempStoragePath();
         m_localConfig.maxConnections = 5;
+        m_localConfig.maxAssociationsPerAE = 2;
         m_localConfig.maxPduSize = 16384;
         m_localConfig.enableStorage = true;
+        m_localConfig.hierarchicalStorage = true;
+        m_localConfig.duplicatePolicy = DuplicateSopPolicy::Replace;
+        m_localConfig.retentionDays = 0;
+        m_localConfig.acceptCompressed = true;
+        m_prefetchRules = PrefetchRules();
 
         // Create temp storage directory if it doesn't exist
         QDir dir(QString::fromStdString(m_localConfig.tempStoragePath));
@@ -43,6 +43,14 @@ namespace isis::core::network
         // Optional C-MOVE destination override
         std::string moveDestinationAE;
 
+        // Retrieve with C-GET over the outgoing association instead of C-MOVE
+        // (for sites whose firewall blocks the inbound connection to our Storage SCP)
+        bool useCGet = false;
+
+        // Offer lossless compressed transfer syntaxes for C-STORE and transcode
+        // uncompressed objects when the peer accepts one
+        bool compressStore = false;
+
         DicomPeer() = default;
 
         DicomPeer(const std::string& peerId, const std::string& peerName,
@@ -50,6 +58,15 @@ namespace isis::core::network
             : id(peerId), name(peerName), aeTitle(ae), hostname(host), port(p) {}
     };
 
+    /**
+     * @brief What the Storage SCP does with an instance it has already stored
+     */
+    enum class DuplicateSopPolicy
+    {
+        Replace,        // Store the new copy in place of the old one
+        KeepExisting    // Discard the new copy (reported as success to the sender)
+    };
+
     /**
      * @brief Local DICOM application entity configuration
      */
@@ -59,12 +76,35 @@ namespace isis::core::network
         int storagePort = 11112;              // Port for incoming C-STORE (C-MOVE)
         std::string tempStoragePath;          // Temporary storage for received files
         int maxConnections = 5;               // Max simultaneous connections
+        int maxAssociationsPerAE = 2;         // Max simultaneous SCP associations per calling AE (0 = no limit)
         int maxPduSize = 16384;               // Maximum PDU size
         bool enableStorage = true;            // Enable Storage SCP
+        bool hierarchicalStorage = true;      // Patient/Study/Series folders plus an arrival index
+        DuplicateSopPolicy duplicatePolicy = DuplicateSopPolicy::Replace;
+        int retentionDays = 0;                // Purge received objects older than this (0 = keep)
+        bool acceptCompressed = true;         // SCP prefers lossless compressed syntaxes when offered
 
         LocalAEConfig() = default;
     };
 
+    /**
+     * @brief Rules for retrieving relevant prior studies in the background
+     */
+    struct PrefetchRules
+    {
+        bool enabled = false;
+        std::string peerId;                   // Peer queried and retrieved from (empty = first enabled)
+        bool sameModality = true;             // Priors must share a modality with the current study
+        std::vector<std::string> modalities;  // Extra modalities always considered relevant
+        bool matchBodyPart = true;            // Only series of the current body part (when both are known)
+        int maxAgeDays = 1825;                // Ignore priors older than this (0 = no limit)
+        int maxPriors = 3;                    // Most recent relevant priors per study (0 = no limit)
+        int bandwidthKBps = 0;                // Background retrieve budget (0 = unlimited)
+        int diskQuotaMB = 0;                  // Least-recently-used studies are purged above this (0 = no quota)
+
+        PrefetchRules() = default;
+    };
+
     /**
      * @brief DIMSE configuration manager
      */
@@ -89,6 +129,10 @@ namespace isis::core::network
         const LocalAEConfig& getLocalAEConfig() const { return m_localConfig; }
         LocalAEConfig& getLocalAEConfig() { return m_localConfig; }
 
+        // Prior prefetch rules
+        void setPrefetchRules(const PrefetchRules& rules);
+        PrefetchRules getPrefetchRules() const;
+
         // Persistence
         bool loadFromFile(const std::string& filepath);
         bool saveToFile(const std::string& filepath) const;
@@ -108,6 +152,7 @@ namespace isis::core::network
     private:
         std::map<std::string, DicomPeer> m_peers;
         LocalAEConfig m_localConfig;
+        PrefetchRules m_prefetchRules;
         mutable std::mutex m_mutex;
 
         // Helper methods
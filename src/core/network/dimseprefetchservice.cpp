@@ -0,0 +1,463 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseprefetchservice.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the prior prefetch service.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dimseprefetchservice.h"
+#include <QDate>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cctype>
+#include <tuple>
+#include "../utils/structuredlog.h"
+
+Q_DECLARE_LOGGING_CATEGORY(lcDimse)
+
+namespace isis::core::network
+{
+    namespace
+    {
+        constexpr std::size_t MaxTrackedStudies = 4096;
+        constexpr int MaxLookupAttempts = 4;
+        constexpr std::chrono::seconds FirstRetryDelay{30};
+
+        bool equalsIgnoreCase(const std::string& a, const std::string& b)
+        {
+            return a.size() == b.size() &&
+                   std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+                       return std::toupper(x) == std::toupper(y);
+                   });
+        }
+
+        // ModalitiesInStudy is multi-valued ("CT\PT")
+        std::vector<std::string> splitValues(const std::string& value)
+        {
+            std::vector<std::string> values;
+            std::size_t start = 0;
+            while (start <= value.size())
+            {
+                const auto end = std::min(value.find('\\', start), value.size());
+                if (end > start)
+                {
+                    values.push_back(value.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+            return values;
+        }
+
+        std::vector<std::string> relevantModalities(const PrefetchRules& rules, const PrefetchStudy& current)
+        {
+            std::vector<std::string> modalities = rules.modalities;
+            if (rules.sameModality)
+            {
+                modalities.insert(modalities.end(), current.modalities.begin(), current.modalities.end());
+            }
+            return modalities;
+        }
+
+        // Unknown modalities are let through; the series level check gets another chance
+        bool matchesModality(const std::vector<std::string>& relevant, const std::string& modality)
+        {
+            if (relevant.empty() || modality.empty())
+            {
+                return true;
+            }
+            for (const auto& value : splitValues(modality))
+            {
+                const bool found = std::any_of(relevant.begin(), relevant.end(), [&value](const std::string& m) {
+                    return equalsIgnoreCase(m, value);
+                });
+                if (found)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        QDate parseDate(const std::string& value)
+        {
+            return QDate::fromString(QString::fromStdString(value.substr(0, 8)), "yyyyMMdd");
+        }
+    }
+
+    DimsePrefetchService::DimsePrefetchService(std::shared_ptr<DimseConnectionPool> pool,
+                                               std::shared_ptr<events::CallbackManager> eventManager,
+                                               std::shared_ptr<DimseRetrieveScheduler> scheduler)
+        : m_connectionPool(std::move(pool))
+        , m_eventManager(std::move(eventManager))
+        , m_scheduler(std::move(scheduler))
+    {
+    }
+
+    DimsePrefetchService::~DimsePrefetchService()
+    {
+        stop();
+    }
+
+    void DimsePrefetchService::configure(const PrefetchRules& rules, const DicomPeer& peer,
+                                         const LocalAEConfig& localAE)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rules = rules;
+            m_peer = peer;
+            m_localAE = localAE;
+        }
+
+        if (m_scheduler)
+        {
+            m_scheduler->setBackgroundBandwidthLimit(static_cast<std::uint64_t>(rules.bandwidthKBps) * 1024,
+                                                     RetrieveSchedulerOptions().backgroundBurstBytes);
+        }
+    }
+
+    void DimsePrefetchService::setStorageIndex(std::shared_ptr<DimseStorageIndex> index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_storageIndex = std::move(index);
+    }
+
+    void DimsePrefetchService::start()
+    {
+        if (m_running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = false;
+        }
+        m_running = true;
+        m_worker = std::thread(&DimsePrefetchService::workerLoop, this);
+    }
+
+    void DimsePrefetchService::stop()
+    {
+        if (!m_running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+            m_pending.clear();
+            if (m_activeQuery)
+                m_activeQuery->cancelQuery();
+        }
+        m_condition.notify_all();
+
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+        m_running = false;
+        m_idleCondition.notify_all();
+    }
+
+    bool DimsePrefetchService::onStudyAvailable(const PrefetchStudy& study)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_rules.enabled || study.patientID.empty() || study.studyInstanceUID.empty())
+            {
+                return false;
+            }
+            // Objects of a prior arriving must not start a lookup of their own priors
+            auto lookup = m_lookups.find(study.studyInstanceUID);
+            if (lookup == m_lookups.end())
+            {
+                lookup = trackLookup(study.studyInstanceUID);
+            }
+            else if (lookup->second.settled || std::chrono::steady_clock::now() < lookup->second.retryAfter)
+            {
+                return false;
+            }
+            lookup->second.retryAfter = std::chrono::steady_clock::time_point::max();
+            m_pending.push_back(study);
+        }
+        m_condition.notify_one();
+        return true;
+    }
+
+    void DimsePrefetchService::onStudyOpened(const PrefetchStudy& study)
+    {
+        if (study.studyInstanceUID.empty())
+        {
+            return;
+        }
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_openStudies.insert(study.studyInstanceUID);
+            index = m_storageIndex;
+        }
+        if (index)
+        {
+            index->touchStudy(study.studyInstanceUID);
+        }
+        onStudyAvailable(study);
+    }
+
+    void DimsePrefetchService::closeStudies()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_openStudies.clear();
+    }
+
+    bool DimsePrefetchService::waitForIdle(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_idleCondition.wait_for(lock, timeout, [this] {
+            return (m_pending.empty() && !m_busy) || m_stopRequested;
+        });
+    }
+
+    std::vector<RemoteStudyInfo> DimsePrefetchService::selectPriors(const PrefetchRules& rules,
+                                                                    const PrefetchStudy& current,
+                                                                    const std::vector<RemoteStudyInfo>& candidates,
+                                                                    const std::string& today)
+    {
+        QDate reference = parseDate(current.studyDate);
+        if (!reference.isValid())
+        {
+            reference = parseDate(today);
+        }
+        const auto relevant = relevantModalities(rules, current);
+
+        std::vector<RemoteStudyInfo> priors;
+        for (const auto& candidate : candidates)
+        {
+            if (candidate.studyInstanceUID.empty() || candidate.studyInstanceUID == current.studyInstanceUID)
+                continue;
+            if (!matchesModality(relevant, candidate.modality))
+                continue;
+
+            const QDate date = parseDate(candidate.studyDate);
+            if (date.isValid() && reference.isValid())
+            {
+                // Later studies are not priors
+                if (date > reference)
+                    continue;
+                if (rules.maxAgeDays > 0 && date.daysTo(reference) > rules.maxAgeDays)
+                    continue;
+            }
+            else if (rules.maxAgeDays > 0)
+            {
+                continue;
+            }
+            priors.push_back(candidate);
+        }
+
+        // Most recent first; YYYYMMDD strings sort like dates
+        std::stable_sort(priors.begin(), priors.end(), [](const RemoteStudyInfo& a, const RemoteStudyInfo& b) {
+            return std::tie(a.studyDate, a.studyTime) > std::tie(b.studyDate, b.studyTime);
+        });
+        if (rules.maxPriors > 0 && priors.size() > static_cast<std::size_t>(rules.maxPriors))
+        {
+            priors.resize(static_cast<std::size_t>(rules.maxPriors));
+        }
+        return priors;
+    }
+
+    bool DimsePrefetchService::isRelevantSeries(const PrefetchRules& rules,
+                                                const PrefetchStudy& current,
+                                                const RemoteSeriesInfo& series)
+    {
+        if (!matchesModality(relevantModalities(rules, current), series.modality))
+        {
+            return false;
+        }
+        if (rules.matchBodyPart && !current.bodyPartExamined.empty() && !series.bodyPartExamined.empty())
+        {
+            return equalsIgnoreCase(current.bodyPartExamined, series.bodyPartExamined);
+        }
+        return true;
+    }
+
+    void DimsePrefetchService::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopRequested)
+        {
+            if (m_pending.empty())
+            {
+                m_condition.wait(lock);
+                continue;
+            }
+
+            const PrefetchStudy study = std::move(m_pending.front());
+            m_pending.pop_front();
+            const PrefetchRules rules = m_rules;
+            const DicomPeer peer = m_peer;
+            const LocalAEConfig localAE = m_localAE;
+            m_busy = true;
+            lock.unlock();
+
+            const bool succeeded = prefetchPriors(study, rules, peer, localAE);
+
+            lock.lock();
+            finishLookup(study.studyInstanceUID, succeeded);
+            m_busy = false;
+            m_activeQuery.reset();
+            m_idleCondition.notify_all();
+        }
+    }
+
+    std::unordered_map<std::string, DimsePrefetchService::StudyLookup>::iterator
+    DimsePrefetchService::trackLookup(const std::string& studyInstanceUID)
+    {
+        const auto inserted = m_lookups.emplace(studyInstanceUID, StudyLookup());
+        if (inserted.second)
+        {
+            m_lookupOrder.push_back(studyInstanceUID);
+        }
+        while (m_lookupOrder.size() > MaxTrackedStudies)
+        {
+            m_lookups.erase(m_lookupOrder.front());
+            m_lookupOrder.pop_front();
+        }
+        return inserted.first;
+    }
+
+    void DimsePrefetchService::finishLookup(const std::string& studyInstanceUID, bool succeeded)
+    {
+        const auto lookup = m_lookups.find(studyInstanceUID);
+        if (lookup == m_lookups.end())
+            return;
+
+        StudyLookup& state = lookup->second;
+        if (succeeded || ++state.failures >= MaxLookupAttempts)
+        {
+            state.settled = true;
+            if (!succeeded)
+            {
+                qCWarning(lcDimse) << "Prefetch of priors for study" << studyInstanceUID.c_str()
+                                   << "given up after" << state.failures << "attempts";
+            }
+            return;
+        }
+        // 30 s, 1 min, 2 min, ... before the next arrival or open may retry
+        state.retryAfter = std::chrono::steady_clock::now() + FirstRetryDelay * (1 << (state.failures - 1));
+    }
+
+    bool DimsePrefetchService::prefetchPriors(const PrefetchStudy& study, const PrefetchRules& rules,
+                                              const DicomPeer& peer, const LocalAEConfig& localAE)
+    {
+        if (!m_scheduler || peer.id.empty())
+        {
+            qCWarning(lcDimse) << "Prefetch of priors skipped: no peer configured";
+            return false;
+        }
+
+        auto query = std::make_shared<DimseQueryService>(m_connectionPool, m_eventManager);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopRequested)
+                return false;
+            m_activeQuery = query;
+        }
+
+        QueryFilter filter;
+        filter.patientID = study.patientID;
+        filter.maxResults = 0;
+        std::vector<RemoteStudyInfo> candidates;
+        const DimseStatus status = query->queryStudies(peer, localAE, filter, candidates);
+        if (status != DimseStatus::Success)
+        {
+            qCWarning(lcDimse) << "Prefetch of priors: study query failed:" << query->getLastError().c_str();
+            return false;
+        }
+
+        const auto today = QDate::currentDate().toString("yyyyMMdd").toStdString();
+        const auto priors = selectPriors(rules, study, candidates, today);
+
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            index = m_storageIndex;
+            // Before submitting: objects of a prior must not start a lookup of their own
+            for (const auto& prior : priors)
+            {
+                trackLookup(prior.studyInstanceUID)->second.settled = true;
+            }
+        }
+
+        std::vector<std::string> usedStudies{study.studyInstanceUID};
+        std::size_t seriesQueued = 0;
+        for (const auto& prior : priors)
+        {
+            usedStudies.push_back(prior.studyInstanceUID);
+
+            std::vector<RemoteSeriesInfo> series;
+            if (query->querySeries(peer, localAE, prior.studyInstanceUID, series) != DimseStatus::Success)
+            {
+                qCWarning(lcDimse) << "Prefetch of priors: series query failed for" << prior.studyInstanceUID.c_str()
+                                   << ":" << query->getLastError().c_str();
+                continue;
+            }
+
+            for (const auto& entry : series)
+            {
+                if (!isRelevantSeries(rules, study, entry))
+                    continue;
+
+                // Series already complete on disk are not even queued
+                if (index && entry.numberOfInstances > 0 &&
+                    index->getSeriesRecords(entry.seriesInstanceUID).size() >=
+                        static_cast<std::size_t>(entry.numberOfInstances))
+                    continue;
+
+                RetrieveTarget target(prior.studyInstanceUID);
+                target.seriesInstanceUID = entry.seriesInstanceUID;
+                m_scheduler->submit(peer, localAE, target, RetrievePriority::Prefetch,
+                                    "Prior " + prior.studyDate + " " + entry.seriesDescription);
+                ++seriesQueued;
+            }
+        }
+
+        utils::telemetry().increment("dimse.prefetch.priors_queued", priors.size());
+        utils::telemetry().increment("dimse.prefetch.series_queued", seriesQueued);
+        qCInfo(lcDimse) << "Prefetch of priors for study" << study.studyInstanceUID.c_str() << ":"
+                        << priors.size() << "prior(s)," << seriesQueued << "series queued";
+
+        enforceDiskQuota(rules, usedStudies);
+        return true;
+    }
+
+    void DimsePrefetchService::enforceDiskQuota(const PrefetchRules& rules, const std::vector<std::string>& usedStudies)
+    {
+        std::shared_ptr<DimseStorageIndex> index;
+        std::set<std::string> keep(usedStudies.begin(), usedStudies.end());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            index = m_storageIndex;
+            keep.insert(m_openStudies.begin(), m_openStudies.end());
+        }
+        if (!index)
+            return;
+
+        for (const auto& studyUID : usedStudies)
+        {
+            index->touchStudy(studyUID);
+        }
+        if (rules.diskQuotaMB <= 0)
+            return;
+
+        const auto removed = index->purgeLeastRecentlyUsed(static_cast<std::uint64_t>(rules.diskQuotaMB) << 20, keep);
+        if (removed > 0)
+        {
+            qCInfo(lcDimse) << "Prefetch disk quota:" << removed << "object(s) of least recently used studies purged";
+        }
+    }
+
+} // namespace isis::core::network
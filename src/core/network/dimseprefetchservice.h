@@ -0,0 +1,174 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseprefetchservice.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Background retrieve of relevant prior studies. When a study becomes
+ *      available locally, the patient's earlier studies are queried, filtered by
+ *      modality, body part and age, and their series queued as Prefetch jobs.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../utils.h"
+#include "../events/callbackmanager.h"
+#include "dimseconfig.h"
+#include "dimseassociation.h"
+#include "dimseservices.h"
+#include "dimseretrievescheduler.h"
+#include "dimsestorageindex.h"
+
+namespace isis::core::network
+{
+    /**
+     * @brief Study that was received or opened, and whose priors may be needed
+     */
+    struct PrefetchStudy
+    {
+        std::string patientID;
+        std::string studyInstanceUID;
+        std::string studyDate;                  // YYYYMMDD (empty = today)
+        std::vector<std::string> modalities;
+        std::string bodyPartExamined;
+
+        PrefetchStudy() = default;
+    };
+
+    /**
+     * @brief Finds the relevant priors of a study and queues them on the retrieve scheduler
+     *
+     * Requests are handled one at a time on a worker thread, once per study: a
+     * STUDY level C-FIND by Patient ID lists the candidates, selectPriors() keeps
+     * the most recent relevant ones, and a SERIES level C-FIND per prior drops the
+     * series of other body parts. The remaining series are submitted with
+     * RetrievePriority::Prefetch, so they wait for the user's retrieves and share
+     * the scheduler's background bandwidth limit.
+     *
+     * When a storage index and a disk quota are set, the current study and its
+     * priors are marked as used and the least recently used studies are purged
+     * until the store fits again. Studies open in the viewer are never purged.
+     */
+    class export DimsePrefetchService
+    {
+    public:
+        DimsePrefetchService(std::shared_ptr<DimseConnectionPool> pool,
+                             std::shared_ptr<events::CallbackManager> eventManager,
+                             std::shared_ptr<DimseRetrieveScheduler> scheduler);
+        ~DimsePrefetchService();
+
+        DimsePrefetchService(const DimsePrefetchService&) = delete;
+        DimsePrefetchService& operator=(const DimsePrefetchService&) = delete;
+
+        /**
+         * @brief Set the rules, the peer priors are retrieved from and the local AE
+         *
+         * Also applies the rules' bandwidth limit to the scheduler.
+         */
+        void configure(const PrefetchRules& rules, const DicomPeer& peer, const LocalAEConfig& localAE);
+
+        /**
+         * @brief Index used for the disk quota (null = no quota)
+         */
+        void setStorageIndex(std::shared_ptr<DimseStorageIndex> index);
+
+        void start();
+        void stop();
+
+        /**
+         * @brief Queue the prior lookup of a study
+         *
+         * A failed lookup is queued again by a later call once its backoff has passed,
+         * up to a few attempts.
+         * @return false if prefetching is disabled, the study was already handled or
+         *         its failed lookup is still backing off
+         */
+        bool onStudyAvailable(const PrefetchStudy& study);
+
+        /**
+         * @brief A study was opened by the user: mark it as used, keep it out of the
+         *        disk quota purge until closeStudies(), and queue the lookup of its priors
+         */
+        void onStudyOpened(const PrefetchStudy& study);
+
+        /**
+         * @brief Every open study was closed; they may be purged again
+         */
+        void closeStudies();
+
+        /**
+         * @brief Block until every queued lookup has been handled (false on timeout)
+         */
+        bool waitForIdle(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Relevant priors among the candidates, most recent first
+         * @param today YYYYMMDD used when the current study has no date
+         */
+        static std::vector<RemoteStudyInfo> selectPriors(const PrefetchRules& rules,
+                                                         const PrefetchStudy& current,
+                                                         const std::vector<RemoteStudyInfo>& candidates,
+                                                         const std::string& today);
+
+        /**
+         * @brief Whether a series of a prior matches the current study's modality and body part
+         */
+        static bool isRelevantSeries(const PrefetchRules& rules,
+                                     const PrefetchStudy& current,
+                                     const RemoteSeriesInfo& series);
+
+    private:
+        std::shared_ptr<DimseConnectionPool> m_connectionPool;
+        std::shared_ptr<events::CallbackManager> m_eventManager;
+        std::shared_ptr<DimseRetrieveScheduler> m_scheduler;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::condition_variable m_idleCondition;
+        PrefetchRules m_rules;
+        DicomPeer m_peer;
+        LocalAEConfig m_localAE;
+        std::shared_ptr<DimseStorageIndex> m_storageIndex;
+        std::deque<PrefetchStudy> m_pending;
+        struct StudyLookup
+        {
+            bool settled = false;                               // Priors queued, a prior itself, or given up
+            int failures = 0;
+            std::chrono::steady_clock::time_point retryAfter;   // max() while queued or running
+        };
+        std::unordered_map<std::string, StudyLookup> m_lookups;    // By Study UID
+        std::deque<std::string> m_lookupOrder;                     // Oldest first, bounds m_lookups
+        std::set<std::string> m_openStudies;        // Study UIDs open in the viewer, never purged
+        std::shared_ptr<DimseQueryService> m_activeQuery;
+        bool m_busy = false;
+        bool m_stopRequested = false;
+        std::thread m_worker;
+        std::atomic<bool> m_running{false};
+
+        void workerLoop();
+        bool prefetchPriors(const PrefetchStudy& study, const PrefetchRules& rules,
+                            const DicomPeer& peer, const LocalAEConfig& localAE);
+        std::unordered_map<std::string, StudyLookup>::iterator trackLookup(const std::string& studyInstanceUID);
+        void finishLookup(const std::string& studyInstanceUID, bool succeeded);
+        void enforceDiskQuota(const PrefetchRules& rules, const std::vector<std::string>& usedStudies);
+    };
+
+} // namespace isis::core::network
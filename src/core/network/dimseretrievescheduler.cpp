@@ -0,0 +1,1123 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseretrievescheduler.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the prioritized retrieve scheduler.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dimseretrievescheduler.h"
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <set>
+#include <tuple>
+#include "../utils/structuredlog.h"
+
+Q_DECLARE_LOGGING_CATEGORY(lcDimse)
+
+namespace isis::core::network
+{
+    namespace
+    {
+        T_DIMSE_Priority toDimsePriority(RetrievePriority priority)
+        {
+            switch (priority)
+            {
+            case RetrievePriority::Interactive:
+                return DIMSE_PRIORITY_HIGH;
+            case RetrievePriority::Prefetch:
+                return DIMSE_PRIORITY_MEDIUM;
+            default:
+                return DIMSE_PRIORITY_LOW;
+            }
+        }
+
+        std::filesystem::path instancePath(const LocalAEConfig& localAE, const std::string& sopInstanceUID)
+        {
+            // Same name the Storage SCP and the C-GET receiver give to an object without a storage index
+            return std::filesystem::u8path(localAE.tempStoragePath) / (sopInstanceUID + ".dcm");
+        }
+
+        void updateThroughput(RetrieveJobStatus& status)
+        {
+            if (status.elapsedMs <= 0.0)
+            {
+                return;
+            }
+            const double seconds = status.elapsedMs / 1000.0;
+            status.instancesPerSecond = static_cast<double>(status.instancesReceived) / seconds;
+            status.megabytesPerSecond = static_cast<double>(status.bytesReceived) / (1024.0 * 1024.0) / seconds;
+        }
+    }
+
+    DimseRetrieveScheduler::DimseRetrieveScheduler(std::shared_ptr<DimseConnectionPool> pool,
+                                                   std::shared_ptr<events::CallbackManager> eventManager,
+                                                   RetrieveSchedulerOptions options)
+        : m_connectionPool(std::move(pool))
+        , m_eventManager(std::move(eventManager))
+        , m_options(options)
+    {
+        m_options.workerCount = std::max(1, m_options.workerCount);
+        m_options.maxConcurrentPerPeer = std::max(1, m_options.maxConcurrentPerPeer);
+        m_options.maxAttempts = std::max(1, m_options.maxAttempts);
+        m_backgroundTokens = static_cast<double>(m_options.backgroundBurstBytes);
+        m_tokensUpdatedAt = std::chrono::steady_clock::now();
+    }
+
+    DimseRetrieveScheduler::~DimseRetrieveScheduler()
+    {
+        stop();
+    }
+
+    void DimseRetrieveScheduler::start()
+    {
+        if (m_running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = false;
+        }
+        m_running = true;
+
+        m_workers.reserve(static_cast<std::size_t>(m_options.workerCount));
+        for (int i = 0; i < m_options.workerCount; ++i)
+        {
+            m_workers.emplace_back(&DimseRetrieveScheduler::workerLoop, this);
+        }
+
+        qCInfo(lcDimse) << "Retrieve scheduler started with" << m_options.workerCount << "workers,"
+                        << m_options.maxConcurrentPerPeer << "per peer";
+    }
+
+    void DimseRetrieveScheduler::stop()
+    {
+        if (!m_running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+
+            // Running retrieves return early; runRetrieve() puts them back in the queue
+            for (auto& [id, job] : m_jobs)
+            {
+                if (job.activeService)
+                    job.activeService->cancelRetrieve();
+                if (job.activeQuery)
+                    job.activeQuery->cancelQuery();
+            }
+        }
+        m_jobCondition.notify_all();
+
+        for (std::thread& worker : m_workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+        m_workers.clear();
+        m_running = false;
+
+        qCInfo(lcDimse) << "Retrieve scheduler stopped";
+    }
+
+    std::uint64_t DimseRetrieveScheduler::submit(const DicomPeer& peer,
+                                                 const LocalAEConfig& localAE,
+                                                 const RetrieveTarget& target,
+                                                 RetrievePriority priority,
+                                                 const std::string& label)
+    {
+        if (target.studyInstanceUID.empty())
+        {
+            qCWarning(lcDimse) << "Retrieve scheduler: ignoring job without Study Instance UID";
+            return 0;
+        }
+
+        Job job;
+        job.peer = peer;
+        job.localAE = localAE;
+        job.status.peerId = peer.id;
+        job.status.label = label.empty() ? std::string(target.level()) + " " +
+            (target.seriesInstanceUID.empty() ? target.studyInstanceUID : target.seriesInstanceUID) : label;
+        job.status.target = target;
+        job.status.priority = priority;
+        return enqueue(std::move(job));
+    }
+
+    std::uint64_t DimseRetrieveScheduler::submitStudy(const DicomPeer& peer,
+                                                      const LocalAEConfig& localAE,
+                                                      const std::string& studyInstanceUID,
+                                                      RetrievePriority priority,
+                                                      const std::string& label,
+                                                      const std::vector<std::string>& firstSeriesUIDs)
+    {
+        if (studyInstanceUID.empty())
+        {
+            return 0;
+        }
+
+        Job job;
+        job.peer = peer;
+        job.localAE = localAE;
+        job.firstSeriesUIDs = firstSeriesUIDs;
+        job.status.peerId = peer.id;
+        job.status.label = label.empty() ? "STUDY " + studyInstanceUID : label;
+        job.status.target = RetrieveTarget(studyInstanceUID);
+        job.status.priority = priority;
+        return enqueue(std::move(job));
+    }
+
+    std::uint64_t DimseRetrieveScheduler::enqueue(Job job)
+    {
+        RetrieveJobStatus snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.status.id = m_nextJobId++;
+            if (job.sequence == 0)
+            {
+                job.sequence = m_nextSequence++;
+            }
+            job.status.state = RetrieveJobState::Queued;
+            job.enqueuedAt = std::chrono::steady_clock::now();
+            job.notBefore = job.enqueuedAt;
+            snapshot = job.status;
+            m_jobs.emplace(snapshot.id, std::move(job));
+
+            if (snapshot.priority == RetrievePriority::Interactive && m_options.yieldToInteractive)
+            {
+                preemptBackgroundJobs(snapshot.peerId);
+            }
+        }
+        m_jobCondition.notify_one();
+        notify(snapshot);
+        return snapshot.id;
+    }
+
+    bool DimseRetrieveScheduler::setPriority(std::uint64_t jobId, RetrievePriority priority)
+    {
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::set<std::string> peers;
+            for (auto& [id, job] : m_jobs)
+            {
+                if ((id == jobId || job.status.parentId == jobId) &&
+                    job.status.state == RetrieveJobState::Queued)
+                {
+                    job.status.priority = priority;
+                    peers.insert(job.status.peerId);
+                    changed = true;
+                }
+            }
+            if (changed && priority == RetrievePriority::Interactive && m_options.yieldToInteractive)
+            {
+                for (const auto& peerId : peers)
+                {
+                    preemptBackgroundJobs(peerId);
+                }
+            }
+        }
+        if (changed)
+        {
+            m_jobCondition.notify_all();
+        }
+        return changed;
+    }
+
+    bool DimseRetrieveScheduler::cancel(std::uint64_t jobId)
+    {
+        std::vector<std::uint64_t> queued;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& [id, job] : m_jobs)
+            {
+                if (id != jobId && job.status.parentId != jobId)
+                    continue;
+
+                found = true;
+                job.cancelRequested = true;
+                if (job.status.state == RetrieveJobState::Queued)
+                {
+                    queued.push_back(id);
+                }
+                else
+                {
+                    if (job.activeService)
+                        job.activeService->cancelRetrieve();
+                    if (job.activeQuery)
+                        job.activeQuery->cancelQuery();
+                }
+            }
+        }
+
+        for (std::uint64_t id : queued)
+        {
+            finishJob(id, RetrieveJobState::Cancelled);
+        }
+        return found;
+    }
+
+    void DimseRetrieveScheduler::cancelAll()
+    {
+        std::vector<std::uint64_t> ids;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& [id, job] : m_jobs)
+            {
+                ids.push_back(id);
+            }
+        }
+        for (std::uint64_t id : ids)
+        {
+            cancel(id);
+        }
+    }
+
+    std::vector<RetrieveJobStatus> DimseRetrieveScheduler::getJobs() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<const Job*> active;
+        active.reserve(m_jobs.size());
+        for (const auto& [id, job] : m_jobs)
+        {
+            active.push_back(&job);
+        }
+        std::sort(active.begin(), active.end(), [](const Job* a, const Job* b) {
+            const bool aRunning = a->status.state == RetrieveJobState::Running;
+            const bool bRunning = b->status.state == RetrieveJobState::Running;
+            return std::make_tuple(!aRunning, a->status.priority, a->sequence, a->status.id) <
+                   std::make_tuple(!bRunning, b->status.priority, b->sequence, b->status.id);
+        });
+
+        std::vector<RetrieveJobStatus> jobs;
+        jobs.reserve(active.size() + m_finished.size());
+        for (const Job* job : active)
+        {
+            jobs.push_back(job->status);
+        }
+        jobs.insert(jobs.end(), m_finished.rbegin(), m_finished.rend());
+        return jobs;
+    }
+
+    bool DimseRetrieveScheduler::getJob(std::uint64_t jobId, RetrieveJobStatus& status) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(jobId);
+        if (it != m_jobs.end())
+        {
+            status = it->second.status;
+            return true;
+        }
+        auto finished = std::find_if(m_finished.begin(), m_finished.end(),
+                                     [jobId](const RetrieveJobStatus& s) { return s.id == jobId; });
+        if (finished != m_finished.end())
+        {
+            status = *finished;
+            return true;
+        }
+        return false;
+    }
+
+    std::size_t DimseRetrieveScheduler::getQueuedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<std::size_t>(std::count_if(m_jobs.begin(), m_jobs.end(), [](const auto& entry) {
+            return entry.second.status.state == RetrieveJobState::Queued;
+        }));
+    }
+
+    std::size_t DimseRetrieveScheduler::getRunningCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<std::size_t>(std::count_if(m_jobs.begin(), m_jobs.end(), [](const auto& entry) {
+            return entry.second.status.state == RetrieveJobState::Running;
+        }));
+    }
+
+    bool DimseRetrieveScheduler::waitForIdle(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_idleCondition.wait_for(lock, timeout, [this]() { return m_jobs.empty(); });
+    }
+
+    void DimseRetrieveScheduler::setJobCallback(RetrieveJobCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobCallback = std::move(callback);
+    }
+
+    void DimseRetrieveScheduler::setStorageReceivedCallback(StorageReceivedCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_storageCallback = std::move(callback);
+    }
+
+    void DimseRetrieveScheduler::setInstanceReceivedCallback(InstanceReceivedCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_instanceCallback = std::move(callback);
+    }
+
+    void DimseRetrieveScheduler::setLocalInstanceLookup(LocalInstanceLookup lookup)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_instanceLookup = std::move(lookup);
+    }
+
+    void DimseRetrieveScheduler::setStorageIndex(std::shared_ptr<DimseStorageIndex> index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_storageIndex = std::move(index);
+    }
+
+    void DimseRetrieveScheduler::setBackgroundBandwidthLimit(std::uint64_t bytesPerSecond, std::uint64_t burstBytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            refillBackgroundTokens(std::chrono::steady_clock::now());
+            m_options.backgroundBytesPerSecond = bytesPerSecond;
+            m_options.backgroundBurstBytes = burstBytes;
+            m_backgroundTokens = std::min(m_backgroundTokens, static_cast<double>(burstBytes));
+        }
+        m_jobCondition.notify_all();
+    }
+
+    void DimseRetrieveScheduler::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopRequested)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            auto nextWakeup = std::chrono::steady_clock::time_point::max();
+            Job* job = takeNextJob(now, nextWakeup);
+            if (!job)
+            {
+                if (nextWakeup == std::chrono::steady_clock::time_point::max())
+                    m_jobCondition.wait(lock);
+                else
+                    m_jobCondition.wait_until(lock, nextWakeup);
+                continue;
+            }
+
+            job->status.state = RetrieveJobState::Running;
+            job->status.attempts++;
+            m_runningPerPeer[job->peer.id]++;
+            utils::telemetry().recordDuration("dimse.scheduler.queue_wait",
+                std::chrono::duration_cast<std::chrono::microseconds>(now - job->enqueuedAt));
+
+            const bool split = m_options.splitStudies &&
+                               job->status.target.seriesInstanceUID.empty() &&
+                               job->status.target.sopInstanceUIDs.empty();
+            const RetrieveJobStatus snapshot = job->status;
+            lock.unlock();
+
+            notify(snapshot);
+            if (split)
+                splitStudy(*job);
+            else
+                runRetrieve(*job);
+
+            lock.lock();
+        }
+    }
+
+    DimseRetrieveScheduler::Job* DimseRetrieveScheduler::takeNextJob(
+        std::chrono::steady_clock::time_point now,
+        std::chrono::steady_clock::time_point& nextWakeup)
+    {
+        // Non-Interactive jobs wait for the user's retrieves from the same peer and for the
+        // bandwidth budget; finishJob() wakes the workers when an Interactive job leaves the queue
+        auto budgetAvailableAt = now;
+        if (m_options.backgroundBytesPerSecond > 0)
+        {
+            refillBackgroundTokens(now);
+            if (m_backgroundTokens < 0.0)
+            {
+                const double seconds = -m_backgroundTokens / static_cast<double>(m_options.backgroundBytesPerSecond);
+                budgetAvailableAt = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(seconds));
+            }
+        }
+
+        Job* best = nullptr;
+        for (auto& [id, job] : m_jobs)
+        {
+            if (job.status.state != RetrieveJobState::Queued || job.cancelRequested)
+                continue;
+
+            auto running = m_runningPerPeer.find(job.peer.id);
+            if (running != m_runningPerPeer.end() && running->second >= m_options.maxConcurrentPerPeer)
+                continue;
+
+            if (job.notBefore > now)
+            {
+                nextWakeup = std::min(nextWakeup, job.notBefore);
+                continue;
+            }
+
+            if (job.status.priority != RetrievePriority::Interactive)
+            {
+                if (m_options.yieldToInteractive && hasActiveInteractiveJob(job.peer.id))
+                    continue;
+                if (budgetAvailableAt > now)
+                {
+                    nextWakeup = std::min(nextWakeup, budgetAvailableAt);
+                    continue;
+                }
+            }
+
+            if (!best ||
+                std::make_tuple(job.status.priority, job.sequence, id) <
+                std::make_tuple(best->status.priority, best->sequence, best->status.id))
+            {
+                best = &job;
+            }
+        }
+        return best;
+    }
+
+    void DimseRetrieveScheduler::splitStudy(Job& job)
+    {
+        const std::string& studyUID = job.status.target.studyInstanceUID;
+
+        auto query = std::make_shared<DimseQueryService>(m_connectionPool, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.activeQuery = query;
+        }
+
+        std::vector<RemoteSeriesInfo> series;
+        const DimseStatus status = query->querySeries(job.peer, job.localAE, studyUID, series);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.activeQuery.reset();
+        }
+        if (isCancelled(job))
+        {
+            finishJob(job.status.id, RetrieveJobState::Cancelled);
+            return;
+        }
+        if (requeueIfInterrupted(job))
+        {
+            return;
+        }
+
+        if (status != DimseStatus::Success || series.empty())
+        {
+            // Peers without SERIES level C-FIND still get the study in one request
+            qCInfo(lcDimse) << "Retrieve scheduler: cannot list series of" << studyUID.c_str()
+                            << "(" << query->getLastError().c_str() << "), retrieving the study as a whole";
+            runRetrieve(job);
+            return;
+        }
+
+        // Requested series first (in the order given), the rest in series number order;
+        // series without a number keep the peer's order after the numbered ones
+        const auto rank = [&job](const RemoteSeriesInfo& info) {
+            const auto& first = job.firstSeriesUIDs;
+            return std::find(first.begin(), first.end(), info.seriesInstanceUID) - first.begin();
+        };
+        const auto number = [](const RemoteSeriesInfo& info) {
+            char* end = nullptr;
+            const long value = std::strtol(info.seriesNumber.c_str(), &end, 10);
+            return end != info.seriesNumber.c_str() ? value : std::numeric_limits<long>::max();
+        };
+        std::stable_sort(series.begin(), series.end(),
+                         [&rank, &number](const RemoteSeriesInfo& a, const RemoteSeriesInfo& b) {
+                             return std::make_tuple(rank(a), number(a)) < std::make_tuple(rank(b), number(b));
+                         });
+
+        std::vector<RetrieveJobStatus> created;
+        RetrieveJobStatus parentSnapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto now = std::chrono::steady_clock::now();
+            for (const auto& info : series)
+            {
+                Job child;
+                child.peer = job.peer;
+                child.localAE = job.localAE;
+                child.sequence = job.sequence;      // Keep the study's place in the queue
+                child.enqueuedAt = now;
+                child.notBefore = now;
+                child.status.id = m_nextJobId++;
+                child.status.parentId = job.status.id;
+                child.status.peerId = job.status.peerId;
+                child.status.priority = job.status.priority;
+                child.status.target = RetrieveTarget(studyUID);
+                child.status.target.seriesInstanceUID = info.seriesInstanceUID;
+                child.status.instancesExpected = info.numberOfInstances > 0
+                    ? static_cast<std::size_t>(info.numberOfInstances) : 0;
+
+                std::string description = info.modality;
+                if (!info.seriesDescription.empty())
+                    description += (description.empty() ? "" : " ") + info.seriesDescription;
+                child.status.label = job.status.label + " - series " + info.seriesNumber +
+                    (description.empty() ? "" : " (" + description + ")");
+
+                created.push_back(child.status);
+                m_jobs.emplace(child.status.id, std::move(child));
+            }
+
+            job.status.seriesJobs = series.size();
+            job.status.progress = 1.0;
+        }
+        m_jobCondition.notify_all();
+
+        qCInfo(lcDimse) << "Retrieve scheduler: study" << studyUID.c_str() << "split into"
+                        << series.size() << "series jobs";
+
+        for (const auto& status : created)
+        {
+            notify(status);
+        }
+        finishJob(job.status.id, RetrieveJobState::Completed);
+    }
+
+    void DimseRetrieveScheduler::runRetrieve(Job& job)
+    {
+        RetrieveTarget target = job.status.target;
+        const bool firstAttempt = job.status.attempts == 1;
+
+        // Narrow the request down to the instances that are not on disk yet
+        std::vector<std::string> requested;
+        bool instancesKnown = false;
+        if (m_options.skipExistingInstances)
+        {
+            std::vector<std::string> candidates;
+            if (!target.sopInstanceUIDs.empty())
+            {
+                candidates = target.sopInstanceUIDs;
+                instancesKnown = true;
+            }
+            else if (!target.seriesInstanceUID.empty())
+            {
+                auto query = std::make_shared<DimseQueryService>(m_connectionPool, nullptr);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    job.activeQuery = query;
+                }
+                std::vector<RemoteInstanceInfo> instances;
+                if (query->queryInstances(job.peer, job.localAE, target.studyInstanceUID,
+                                          target.seriesInstanceUID, instances) == DimseStatus::Success &&
+                    !instances.empty())
+                {
+                    for (const auto& instance : instances)
+                        candidates.push_back(instance.sopInstanceUID);
+                    instancesKnown = true;
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                job.activeQuery.reset();
+            }
+
+            std::vector<std::string> local;
+            for (const auto& uid : candidates)
+            {
+                if (instanceExists(job.localAE, uid))
+                    local.push_back(uid);
+                else
+                    requested.push_back(uid);
+            }
+            const std::size_t present = local.size();
+
+            // The store outlives the session: what is skipped here may not be loaded yet
+            if (firstAttempt && present > 0)
+            {
+                importLocalInstances(job.localAE, target, local);
+            }
+
+            if (instancesKnown)
+            {
+                RetrieveJobStatus snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (firstAttempt)
+                    {
+                        job.status.instancesExpected = candidates.size();
+                        job.status.instancesSkipped = present;
+                    }
+                    snapshot = job.status;
+                }
+                notify(snapshot);
+
+                if (requested.empty())
+                {
+                    utils::telemetry().increment("dimse.scheduler.instances_skipped", present);
+                    finishJob(job.status.id, firstAttempt ? RetrieveJobState::Skipped
+                                                          : RetrieveJobState::Completed);
+                    return;
+                }
+
+                if (present > 0)
+                {
+                    utils::telemetry().increment("dimse.scheduler.instances_skipped", present);
+                    // Large series stay at SERIES level rather than sending a huge UID list
+                    if (!target.sopInstanceUIDs.empty() || requested.size() <= MaxInstancesPerImageRequest)
+                    {
+                        target.sopInstanceUIDs = requested;
+                    }
+                }
+            }
+        }
+
+        if (isCancelled(job))
+        {
+            finishJob(job.status.id, RetrieveJobState::Cancelled);
+            return;
+        }
+        if (requeueIfInterrupted(job))
+        {
+            return;
+        }
+
+        auto service = std::make_shared<DimseRetrieveService>(m_connectionPool, m_eventManager);
+        service->setRequestPriority(toDimsePriority(job.status.priority));
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            service->setStorageReceivedCallback(m_storageCallback);
+            service->setInstanceReceivedCallback(m_instanceCallback);
+            service->setStorageIndex(m_storageIndex);
+            job.activeService = service;
+        }
+
+        // C-MOVE arrivals reach the Storage SCP, not the service: measure them in the index
+        std::size_t indexedBefore = 0;
+        std::uint64_t indexedBytesBefore = 0;
+        if (!instancesKnown)
+        {
+            indexedTotals(target, indexedBefore, indexedBytesBefore);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const double previousElapsedMs = job.status.elapsedMs;
+        const std::uint64_t jobId = job.status.id;
+
+        const DimseStatus status = service->retrieve(job.peer, job.localAE, target,
+            [this, &job, start, previousElapsedMs](double progress, const std::string&) {
+                RetrieveJobStatus snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    job.status.progress = progress;
+                    job.status.elapsedMs = previousElapsedMs + std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                    snapshot = job.status;
+                }
+                notify(snapshot);
+            });
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        // Count what arrived: requested instances now on disk, or the C-GET counter
+        std::size_t received = 0;
+        std::uint64_t bytes = 0;
+        if (instancesKnown)
+        {
+            for (const auto& uid : requested)
+            {
+                if (instanceExists(job.localAE, uid))
+                {
+                    ++received;
+                    bytes += instanceBytes(job.localAE, uid);
+                }
+            }
+        }
+        else
+        {
+            // C-GET counts what it stored itself; C-MOVE is what the index gained for the target
+            received = static_cast<std::size_t>(std::max(0, service->getReceivedCount()));
+            bytes = service->getReceivedBytes();
+            if (received == 0)
+            {
+                std::size_t indexedAfter = 0;
+                std::uint64_t indexedBytesAfter = 0;
+                indexedTotals(target, indexedAfter, indexedBytesAfter);
+                received = indexedAfter - std::min(indexedAfter, indexedBefore);
+                bytes = indexedBytesAfter - std::min(indexedBytesAfter, indexedBytesBefore);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.activeService.reset();
+            job.status.elapsedMs = previousElapsedMs + elapsedMs;
+            job.status.instancesReceived += received;
+            job.status.bytesReceived += bytes;
+            updateThroughput(job.status);
+
+            if (job.status.priority != RetrievePriority::Interactive && m_options.backgroundBytesPerSecond > 0)
+            {
+                refillBackgroundTokens(std::chrono::steady_clock::now());
+                m_backgroundTokens -= static_cast<double>(bytes);
+            }
+        }
+        utils::telemetry().increment("dimse.scheduler.instances_received", received);
+
+        if (status == DimseStatus::Success)
+        {
+            finishJob(jobId, RetrieveJobState::Completed);
+            return;
+        }
+
+        if (isCancelled(job))
+        {
+            finishJob(jobId, RetrieveJobState::Cancelled);
+            return;
+        }
+        if (requeueIfInterrupted(job))
+        {
+            return;
+        }
+
+        const bool retryable = status != DimseStatus::InvalidParameters &&
+                               status != DimseStatus::Cancelled;
+        requeueOrFail(jobId, service->getLastError(), retryable);
+    }
+
+    bool DimseRetrieveScheduler::isCancelled(const Job& job) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return job.cancelRequested;
+    }
+
+    bool DimseRetrieveScheduler::requeueIfInterrupted(Job& job)
+    {
+        RetrieveJobStatus snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_stopRequested && !job.preempted)
+            {
+                return false;
+            }
+
+            // Back to the queue without counting the attempt
+            job.preempted = false;
+            job.status.state = RetrieveJobState::Queued;
+            job.status.attempts = std::max(0, job.status.attempts - 1);
+            job.status.progress = 0.0;
+            m_runningPerPeer[job.peer.id]--;
+            if (m_stopRequested)
+            {
+                return true;
+            }
+            snapshot = job.status;
+        }
+
+        // The freed peer slot may be what the Interactive job is waiting for
+        utils::telemetry().increment("dimse.scheduler.preempted");
+        m_jobCondition.notify_all();
+        notify(snapshot);
+        return true;
+    }
+
+    bool DimseRetrieveScheduler::hasActiveInteractiveJob(const std::string& peerId) const
+    {
+        return std::any_of(m_jobs.begin(), m_jobs.end(), [&peerId](const auto& entry) {
+            const Job& job = entry.second;
+            return job.peer.id == peerId && job.status.priority == RetrievePriority::Interactive && !job.cancelRequested &&
+                   (job.status.state == RetrieveJobState::Queued || job.status.state == RetrieveJobState::Running);
+        });
+    }
+
+    void DimseRetrieveScheduler::preemptBackgroundJobs(const std::string& peerId)
+    {
+        // Only the peer the interactive job needs is contended; other peers keep their transfers
+        for (auto& [id, job] : m_jobs)
+        {
+            if (job.status.peerId != peerId || job.status.state != RetrieveJobState::Running ||
+                job.status.priority == RetrievePriority::Interactive || job.preempted)
+                continue;
+
+            job.preempted = true;
+            if (job.activeService)
+                job.activeService->cancelRetrieve();
+            if (job.activeQuery)
+                job.activeQuery->cancelQuery();
+            qCInfo(lcDimse) << "Retrieve job" << job.status.label.c_str() << "interrupted for an interactive retrieve";
+        }
+    }
+
+    void DimseRetrieveScheduler::refillBackgroundTokens(std::chrono::steady_clock::time_point now)
+    {
+        const double seconds = std::chrono::duration<double>(now - m_tokensUpdatedAt).count();
+        m_tokensUpdatedAt = now;
+        if (seconds > 0.0)
+        {
+            m_backgroundTokens = std::min(static_cast<double>(m_options.backgroundBurstBytes),
+                m_backgroundTokens + seconds * static_cast<double>(m_options.backgroundBytesPerSecond));
+        }
+    }
+
+    void DimseRetrieveScheduler::finishJob(std::uint64_t jobId, RetrieveJobState state)
+    {
+        RetrieveJobStatus snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end())
+                return;
+
+            Job& job = it->second;
+            if (job.status.state == RetrieveJobState::Running)
+            {
+                m_runningPerPeer[job.peer.id]--;
+            }
+            job.status.state = state;
+            if (state == RetrieveJobState::Completed || state == RetrieveJobState::Skipped)
+            {
+                job.status.progress = 1.0;
+            }
+            snapshot = job.status;
+
+            m_finished.push_back(snapshot);
+            if (m_finished.size() > MaxFinishedJobs)
+            {
+                m_finished.erase(m_finished.begin());
+            }
+            m_jobs.erase(it);
+        }
+
+        switch (state)
+        {
+        case RetrieveJobState::Completed:
+        case RetrieveJobState::Skipped:
+            utils::telemetry().increment("dimse.scheduler.jobs_completed");
+            break;
+        case RetrieveJobState::Failed:
+            utils::telemetry().increment("dimse.scheduler.jobs_failed");
+            qCWarning(lcDimse) << "Retrieve job" << snapshot.label.c_str() << "failed after"
+                               << snapshot.attempts << "attempt(s):" << snapshot.lastError.c_str();
+            break;
+        default:
+            break;
+        }
+
+        // Peer slot freed and the job left the queue
+        m_jobCondition.notify_all();
+        m_idleCondition.notify_all();
+        notify(snapshot);
+    }
+
+    void DimseRetrieveScheduler::requeueOrFail(std::uint64_t jobId, const std::string& error, bool retryable)
+    {
+        RetrieveJobStatus snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end())
+                return;
+
+            Job& job = it->second;
+            job.status.lastError = error;
+            if (!retryable || job.status.attempts >= m_options.maxAttempts || job.cancelRequested)
+            {
+                retryable = false;
+            }
+            else
+            {
+                // Exponential backoff: base, 2 * base, 4 * base ... capped
+                const int shift = std::min(job.status.attempts - 1, 16);
+                const std::chrono::milliseconds delay = std::min<std::chrono::milliseconds>(
+                    m_options.retryBaseDelay * (1 << shift), m_options.retryMaxDelay);
+                job.notBefore = std::chrono::steady_clock::now() + delay;
+                job.status.state = RetrieveJobState::Queued;
+                job.status.progress = 0.0;
+                m_runningPerPeer[job.peer.id]--;
+                snapshot = job.status;
+
+                qCInfo(lcDimse) << "Retrieve job" << job.status.label.c_str() << "failed (" << error.c_str()
+                                << "), retrying in" << delay.count() << "ms";
+            }
+        }
+
+        if (!retryable)
+        {
+            finishJob(jobId, RetrieveJobState::Failed);
+            return;
+        }
+
+        utils::telemetry().increment("dimse.scheduler.retries");
+        m_jobCondition.notify_all();
+        notify(snapshot);
+    }
+
+    void DimseRetrieveScheduler::notify(const RetrieveJobStatus& status)
+    {
+        RetrieveJobCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            callback = m_jobCallback;
+        }
+        if (callback)
+        {
+            callback(status);
+        }
+    }
+
+    bool DimseRetrieveScheduler::instanceExists(const LocalAEConfig& localAE,
+                                                const std::string& sopInstanceUID) const
+    {
+        LocalInstanceLookup lookup;
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            lookup = m_instanceLookup;
+            index = m_storageIndex;
+        }
+        if (lookup)
+        {
+            return lookup(sopInstanceUID);
+        }
+        if (index && index->contains(sopInstanceUID))
+        {
+            return true;
+        }
+
+        if (sopInstanceUID.empty() || localAE.tempStoragePath.empty())
+        {
+            return false;
+        }
+        std::error_code ec;
+        return std::filesystem::is_regular_file(instancePath(localAE, sopInstanceUID), ec);
+    }
+
+    std::uint64_t DimseRetrieveScheduler::instanceBytes(const LocalAEConfig& localAE,
+                                                        const std::string& sopInstanceUID) const
+    {
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            index = m_storageIndex;
+        }
+        StorageIndexRecord record;
+        if (index && index->find(sopInstanceUID, record))
+        {
+            return record.size;
+        }
+
+        if (sopInstanceUID.empty() || localAE.tempStoragePath.empty())
+        {
+            return 0;
+        }
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(instancePath(localAE, sopInstanceUID), ec);
+        return ec ? 0 : static_cast<std::uint64_t>(size);
+    }
+
+    void DimseRetrieveScheduler::indexedTotals(const RetrieveTarget& target,
+                                               std::size_t& instances, std::uint64_t& bytes) const
+    {
+        instances = 0;
+        bytes = 0;
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            index = m_storageIndex;
+        }
+        if (!index)
+        {
+            return;
+        }
+
+        std::vector<StorageIndexRecord> records;
+        if (!target.sopInstanceUIDs.empty())
+        {
+            for (const auto& uid : target.sopInstanceUIDs)
+            {
+                StorageIndexRecord record;
+                if (index->find(uid, record))
+                    records.push_back(record);
+            }
+        }
+        else if (!target.seriesInstanceUID.empty())
+        {
+            records = index->getSeriesRecords(target.seriesInstanceUID);
+        }
+        else
+        {
+            records = index->getStudyRecords(target.studyInstanceUID);
+        }
+
+        instances = records.size();
+        for (const auto& record : records)
+            bytes += record.size;
+    }
+
+    void DimseRetrieveScheduler::importLocalInstances(const LocalAEConfig& localAE,
+                                                      const RetrieveTarget& target,
+                                                      const std::vector<std::string>& sopInstanceUIDs) const
+    {
+        StorageReceivedCallback callback;
+        std::shared_ptr<DimseStorageIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            callback = m_storageCallback;
+            index = m_storageIndex;
+        }
+        if (!callback)
+        {
+            return;
+        }
+
+        std::vector<std::string> paths;
+        if (index)
+        {
+            // A whole series or study is opened by one lookup in the arrival index
+            std::vector<StorageIndexRecord> records;
+            if (target.sopInstanceUIDs.empty() && !target.seriesInstanceUID.empty())
+            {
+                records = index->getSeriesRecords(target.seriesInstanceUID);
+            }
+            else if (target.sopInstanceUIDs.empty())
+            {
+                records = index->getStudyRecords(target.studyInstanceUID);
+            }
+            else
+            {
+                for (const auto& uid : sopInstanceUIDs)
+                {
+                    StorageIndexRecord record;
+                    if (index->find(uid, record))
+                        records.push_back(std::move(record));
+                }
+            }
+            for (const auto& record : records)
+            {
+                paths.push_back(index->absolutePath(record));
+            }
+        }
+
+        std::error_code ec;
+        for (const auto& uid : sopInstanceUIDs)
+        {
+            if (index && index->contains(uid))
+                continue;
+            const auto path = instancePath(localAE, uid);
+            if (!localAE.tempStoragePath.empty() && std::filesystem::is_regular_file(path, ec))
+                paths.push_back(path.u8string());
+        }
+
+        qCInfo(lcDimse) << "Retrieve scheduler: importing" << paths.size() << "local instances of"
+                        << target.studyInstanceUID.c_str();
+        for (const auto& path : paths)
+        {
+            callback(path);
+        }
+    }
+
+} // namespace isis::core::network
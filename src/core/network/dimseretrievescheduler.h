@@ -0,0 +1,306 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseretrievescheduler.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Prioritized retrieve queue. Splits studies into series-level C-MOVE/C-GET
+ *      jobs, bounds the concurrent retrieves per peer, retries failures with
+ *      backoff and skips instances that are already on disk.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../utils.h"
+#include "../events/callbackmanager.h"
+#include "dimseconfig.h"
+#include "dimseassociation.h"
+#include "dimseservices.h"
+#include "dimsestorageindex.h"
+
+namespace isis::core::network
+{
+    /**
+     * @brief Scheduling class of a retrieve; lower values are served first
+     */
+    enum class RetrievePriority
+    {
+        Interactive = 0,    // The user is waiting for it
+        Prefetch = 1,       // Likely needed soon (priors, rest of an open study)
+        Background = 2      // Bulk transfers
+    };
+
+    enum class RetrieveJobState
+    {
+        Queued,             // Waiting for a worker (or for its retry delay)
+        Running,
+        Completed,
+        Skipped,            // Every instance was already on disk
+        Failed,
+        Cancelled
+    };
+
+    /**
+     * @brief Snapshot of one scheduled retrieve
+     */
+    struct RetrieveJobStatus
+    {
+        std::uint64_t id = 0;
+        std::uint64_t parentId = 0;         // Study request a series job was split from (0 = none)
+        std::string peerId;
+        std::string label;
+        RetrieveTarget target;
+        RetrievePriority priority = RetrievePriority::Background;
+        RetrieveJobState state = RetrieveJobState::Queued;
+        int attempts = 0;
+        double progress = 0.0;
+        std::size_t instancesExpected = 0;  // From the IMAGE level C-FIND (0 = unknown)
+        std::size_t instancesSkipped = 0;   // Already on disk, not requested again
+        std::size_t instancesReceived = 0;
+        std::size_t seriesJobs = 0;         // Series jobs a study request was split into
+        std::uint64_t bytesReceived = 0;
+        double elapsedMs = 0.0;             // Time spent running, all attempts
+        double instancesPerSecond = 0.0;
+        double megabytesPerSecond = 0.0;
+        std::string lastError;
+
+        [[nodiscard]] bool isFinished() const
+        {
+            return state != RetrieveJobState::Queued && state != RetrieveJobState::Running;
+        }
+    };
+
+    using RetrieveJobCallback = std::function<void(const RetrieveJobStatus& status)>;
+
+    /**
+     * @brief Answers whether an instance is already available locally
+     */
+    using LocalInstanceLookup = std::function<bool(const std::string& sopInstanceUID)>;
+
+    struct RetrieveSchedulerOptions
+    {
+        int workerCount = 4;                // Concurrent retrieves over all peers
+        int maxConcurrentPerPeer = 2;       // Concurrent retrieves against one peer
+        int maxAttempts = 3;                // Including the first one
+        std::chrono::milliseconds retryBaseDelay{2000};   // Doubled after every failed attempt
+        std::chrono::milliseconds retryMaxDelay{60000};
+        bool splitStudies = true;           // Query the series of a study and retrieve them one by one
+        bool skipExistingInstances = true;  // Query the instances of a series and request only missing ones
+        bool yieldToInteractive = true;     // Hold (and interrupt) other jobs while an Interactive one is active
+        std::uint64_t backgroundBytesPerSecond = 0;         // Token bucket for non-Interactive jobs (0 = no limit)
+        std::uint64_t backgroundBurstBytes = 64ull << 20;   // Bucket capacity
+    };
+
+    /**
+     * @brief Queue of C-MOVE/C-GET jobs served by a fixed set of worker threads
+     *
+     * Jobs are ordered by priority, then by submission order. A study request is
+     * turned into one job per series by a SERIES level C-FIND on a worker, so the
+     * series the user asked for first can be moved ahead of the rest and a large
+     * study no longer blocks everything queued behind it. Series jobs look up their
+     * instances first and skip those already on disk (by default a
+     * "<SOP Instance UID>.dcm" file in LocalAEConfig::tempStoragePath, or an entry
+     * of the storage index when one is set).
+     *
+     * Prefetch and Background jobs give way to the user: while an Interactive job is
+     * queued or running they are not started, and running ones are interrupted and
+     * put back in the queue (without counting an attempt). Their transfers can also
+     * be rate limited with a token bucket that is charged with the bytes each job
+     * received; while the bucket is in debt no further non-Interactive job starts.
+     *
+     * The job callback runs on worker threads.
+     */
+    class export DimseRetrieveScheduler
+    {
+    public:
+        DimseRetrieveScheduler(std::shared_ptr<DimseConnectionPool> pool,
+                               std::shared_ptr<events::CallbackManager> eventManager,
+                               RetrieveSchedulerOptions options = RetrieveSchedulerOptions());
+        ~DimseRetrieveScheduler();
+
+        DimseRetrieveScheduler(const DimseRetrieveScheduler&) = delete;
+        DimseRetrieveScheduler& operator=(const DimseRetrieveScheduler&) = delete;
+
+        /**
+         * @brief Start the worker threads (jobs may be submitted before)
+         */
+        void start();
+
+        /**
+         * @brief Cancel running jobs and join the workers; queued jobs are kept
+         */
+        void stop();
+
+        [[nodiscard]] bool isRunning() const { return m_running; }
+
+        /**
+         * @brief Queue a retrieve of any level; study targets are split into series jobs
+         * @return Job id
+         */
+        std::uint64_t submit(const DicomPeer& peer,
+                             const LocalAEConfig& localAE,
+                             const RetrieveTarget& target,
+                             RetrievePriority priority,
+                             const std::string& label = std::string());
+
+        /**
+         * @brief Queue a study, retrieving the given series before the others
+         * @return Job id of the study request (series jobs report it as parentId)
+         */
+        std::uint64_t submitStudy(const DicomPeer& peer,
+                                  const LocalAEConfig& localAE,
+                                  const std::string& studyInstanceUID,
+                                  RetrievePriority priority,
+                                  const std::string& label = std::string(),
+                                  const std::vector<std::string>& firstSeriesUIDs = {});
+
+        /**
+         * @brief Change the priority of a queued job and of the queued jobs split from it
+         */
+        bool setPriority(std::uint64_t jobId, RetrievePriority priority);
+
+        /**
+         * @brief Cancel a job (and the jobs split from it); running retrieves send C-CANCEL
+         */
+        bool cancel(std::uint64_t jobId);
+        void cancelAll();
+
+        /**
+         * @brief Active jobs in scheduling order, followed by recently finished ones
+         */
+        [[nodiscard]] std::vector<RetrieveJobStatus> getJobs() const;
+        [[nodiscard]] bool getJob(std::uint64_t jobId, RetrieveJobStatus& status) const;
+        [[nodiscard]] std::size_t getQueuedCount() const;
+        [[nodiscard]] std::size_t getRunningCount() const;
+
+        /**
+         * @brief Block until no job is queued or running (false on timeout)
+         */
+        bool waitForIdle(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Called on every state change and progress update of a job
+         */
+        void setJobCallback(RetrieveJobCallback callback);
+
+        /**
+         * @brief Forwarded to the retrieve service for objects received through C-GET
+         */
+        void setStorageReceivedCallback(StorageReceivedCallback callback);
+
+        /**
+         * @brief Forwarded to the retrieve service for C-GET objects whose header was parsed
+         */
+        void setInstanceReceivedCallback(InstanceReceivedCallback callback);
+
+        /**
+         * @brief Replace the on-disk check used to skip instances
+         */
+        void setLocalInstanceLookup(LocalInstanceLookup lookup);
+
+        /**
+         * @brief Also count instances filed in the Storage SCP's hierarchical store as local,
+         *        and file C-GET objects there
+         */
+        void setStorageIndex(std::shared_ptr<DimseStorageIndex> index);
+
+        /**
+         * @brief Change the token-bucket limit of Prefetch and Background jobs (0 = no limit)
+         */
+        void setBackgroundBandwidthLimit(std::uint64_t bytesPerSecond, std::uint64_t burstBytes);
+
+    private:
+        struct Job
+        {
+            RetrieveJobStatus status;
+            DicomPeer peer;
+            LocalAEConfig localAE;
+            std::vector<std::string> firstSeriesUIDs;
+            std::vector<std::string> expectedInstanceUIDs;
+            std::uint64_t sequence = 0;
+            std::chrono::steady_clock::time_point enqueuedAt;
+            std::chrono::steady_clock::time_point notBefore;
+            std::shared_ptr<DimseRetrieveService> activeService;
+            std::shared_ptr<DimseQueryService> activeQuery;
+            bool cancelRequested = false;
+            bool preempted = false;         // Interrupted for an Interactive job, to be requeued
+        };
+
+        std::shared_ptr<DimseConnectionPool> m_connectionPool;
+        std::shared_ptr<events::CallbackManager> m_eventManager;
+        RetrieveSchedulerOptions m_options;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_jobCondition;     // Signals workers that a job may be runnable
+        std::condition_variable m_idleCondition;    // Signals waitForIdle() that a job finished
+        std::map<std::uint64_t, Job> m_jobs;        // Queued and running
+        std::vector<RetrieveJobStatus> m_finished;  // Most recent last
+        std::map<std::string, int> m_runningPerPeer;
+        double m_backgroundTokens = 0.0;            // Bytes; negative while in debt
+        std::chrono::steady_clock::time_point m_tokensUpdatedAt;
+        std::uint64_t m_nextJobId = 1;
+        std::uint64_t m_nextSequence = 1;
+        std::vector<std::thread> m_workers;
+        std::atomic<bool> m_running{false};
+        bool m_stopRequested = false;
+
+        RetrieveJobCallback m_jobCallback;
+        StorageReceivedCallback m_storageCallback;
+        InstanceReceivedCallback m_instanceCallback;
+        LocalInstanceLookup m_instanceLookup;
+        std::shared_ptr<DimseStorageIndex> m_storageIndex;
+
+        static constexpr std::size_t MaxFinishedJobs = 256;
+        static constexpr std::size_t MaxInstancesPerImageRequest = 500;
+
+        void workerLoop();
+
+        // Highest priority runnable job whose peer has a free slot; m_mutex held
+        Job* takeNextJob(std::chrono::steady_clock::time_point now,
+                         std::chrono::steady_clock::time_point& nextWakeup);
+
+        // Worker side of a study request: replace it with series jobs
+        void splitStudy(Job& job);
+
+        // Worker side of a series/instance job: skip present instances, retrieve the rest
+        void runRetrieve(Job& job);
+
+        std::uint64_t enqueue(Job job);
+        bool isCancelled(const Job& job) const;
+
+        // Put a job interrupted by stop() or by an Interactive job back in the queue
+        bool requeueIfInterrupted(Job& job);
+
+        // m_mutex held for the helpers below
+        bool hasActiveInteractiveJob(const std::string& peerId) const;
+        void preemptBackgroundJobs(const std::string& peerId);
+        void refillBackgroundTokens(std::chrono::steady_clock::time_point now);
+
+        void finishJob(std::uint64_t jobId, RetrieveJobState state);
+        void requeueOrFail(std::uint64_t jobId, const std::string& error, bool retryable);
+        void notify(const RetrieveJobStatus& status);
+        bool instanceExists(const LocalAEConfig& localAE, const std::string& sopInstanceUID) const;
+        std::uint64_t instanceBytes(const LocalAEConfig& localAE, const std::string& sopInstanceUID) const;
+        void indexedTotals(const RetrieveTarget& target, std::size_t& instances, std::uint64_t& bytes) const;
+        void importLocalInstances(const LocalAEConfig& localAE, const RetrieveTarget& target,
+                                  const std::vector<std::string>& sopInstanceUIDs) const;
+    };
+
+} // namespace isis::core::network
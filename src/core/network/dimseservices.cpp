@@ -18,6 +18,8 @@
 #include <dcmtk/dcmdata/dcdeftag.h>
 #include <dcmtk/dcmnet/dimse.h>
 #include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcxfer.h>
+#include <dcmtk/dcmjpls/djencode.h>
 #include <dcmtk/ofstd/ofstd.h>
 #include <QLoggingCategory>
 #include <QtConcurrent>
@@ -25,13 +27,22 @@
 #include <QDirIterator>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <set>
+#include <thread>
+#include "../utils/structuredlog.h"
 
 Q_DECLARE_LOGGING_CATEGORY(lcDimse)
 
 namespace isis::core::network
 {
     void DimseQueryService::findResponseHandler(void* callbackData,
-                                                T_DIMSE_C_FindRQ* /*request*/,
+                                                T_DIMSE_C_FindRQ* request,
                                                 int /*responseCount*/,
                                                 T_DIMSE_C_FindRSP* response,
                                                 DcmDataset* responseIdentifiers)
@@ -43,12 +54,24 @@ namespace isis::core::network
         }
 
         auto* service = context->service;
-        if (service->m_cancelRequested.load())
-        {
-            if (response != nullptr)
+
+        // Ask the peer to stop matching; remaining pending responses are drained by DIMSE_findUser
+        auto sendCancel = [context, request]() {
+            if (!context->cancelSent && context->association != nullptr && request != nullptr)
             {
-                response->DimseStatus = STATUS_FIND_Cancel_MatchingTerminatedDueToCancelRequest;
+                OFCondition cond = DIMSE_sendCancelRequest(context->association, context->presID,
+                                                           request->MessageID);
+                if (cond.bad())
+                {
+                    qCWarning(lcDimse) << "Failed to send C-CANCEL:" << cond.text();
+                }
+                context->cancelSent = true;
             }
+        };
+
+        if (service->m_cancelRequested.load())
+        {
+            sendCancel();
             return;
         }
 
@@ -57,44 +80,34 @@ namespace isis::core::network
             return;
         }
 
-        if (response->DimseStatus != STATUS_Pending)
+        if (!DICOM_PENDING_STATUS(response->DimseStatus))
         {
             return;
         }
 
-        if (context->results != nullptr &&
-            context->maxResults > 0 &&
-            context->results->size() >= static_cast<size_t>(context->maxResults))
+        if (context->maxResults > 0 &&
+            context->matchCount >= static_cast<std::size_t>(context->maxResults))
         {
+            sendCancel();
             return;
         }
 
-        RemoteStudyInfo studyInfo = service->parseStudyResponse(responseIdentifiers);
-        if (context->results != nullptr)
+        ++context->matchCount;
+        if (context->onMatch)
         {
-            context->results->push_back(studyInfo);
-
-            if (service->m_eventManager && context->maxResults > 0)
-            {
-                const double progress = std::min(
-                    1.0,
-                    static_cast<double>(context->results->size()) /
-                        static_cast<double>(context->maxResults));
-                service->m_eventManager->dispatchProgress(
-                    events::ProcessingEventType::DimseQueryProgress,
-                    progress,
-                    "Found " + std::to_string(context->results->size()) + " studies");
-            }
+            context->onMatch(responseIdentifiers);
         }
 
-        if (context->callback)
+        // The result limit is reached: stop the peer instead of discarding the rest locally
+        if (context->maxResults > 0 &&
+            context->matchCount >= static_cast<std::size_t>(context->maxResults))
         {
-            context->callback(studyInfo);
+            sendCancel();
         }
     }
 
     void DimseRetrieveService::moveResponseHandler(void* callbackData,
-                                                   T_DIMSE_C_MoveRQ* /*request*/,
+                                                   T_DIMSE_C_MoveRQ* request,
                                                    int responseCount,
                                                    T_DIMSE_C_MoveRSP* response)
     {
@@ -104,6 +117,19 @@ namespace isis::core::network
             return;
         }
 
+        // The provider stops the sub-operations and answers with a Cancel status
+        if (context->service->m_cancelRequested.load() && !context->cancelSent &&
+            DICOM_PENDING_STATUS(response->DimseStatus) && request != nullptr)
+        {
+            OFCondition cond = DIMSE_sendCancelRequest(context->association, context->presID,
+                                                       request->MessageID);
+            if (cond.bad())
+            {
+                qCWarning(lcDimse) << "Failed to send C-CANCEL for C-MOVE:" << cond.text();
+            }
+            context->cancelSent = true;
+        }
+
         if (!context->progressCallback)
         {
             return;
@@ -178,7 +204,14 @@ namespace isis::core::network
         DimseStatus status = assoc->sendEcho(timeout);
         m_lastError = assoc->getLastError();
 
-        m_connectionPool->release(assoc);
+        if (status == DimseStatus::Success)
+        {
+            m_connectionPool->release(assoc);
+        }
+        else
+        {
+            m_connectionPool->discard(assoc);
+        }
 
         if (m_eventManager)
         {
@@ -229,15 +262,131 @@ namespace isis::core::network
                                          "Starting C-FIND query to " + peer.name);
         }
 
+        std::unique_ptr<DcmDataset> query(buildQueryDataset(filter));
+        const int maxResults = filter.maxResults;
+
+        DimseStatus status = executeFind(peer, localAE, query.get(), maxResults,
+            [this, &results, &callback, maxResults](DcmDataset* identifiers) {
+                RemoteStudyInfo studyInfo = parseStudyResponse(identifiers);
+                results.push_back(studyInfo);
+
+                if (m_eventManager && maxResults > 0)
+                {
+                    const double progress = std::min(
+                        1.0,
+                        static_cast<double>(results.size()) / static_cast<double>(maxResults));
+                    m_eventManager->dispatchProgress(
+                        events::ProcessingEventType::DimseQueryProgress,
+                        progress,
+                        "Found " + std::to_string(results.size()) + " studies");
+                }
+
+                if (callback)
+                {
+                    callback(studyInfo);
+                }
+            });
+
+        if (status == DimseStatus::Success)
+        {
+            qCInfo(lcDimse) << "C-FIND completed. Found" << results.size() << "studies";
+            if (m_eventManager)
+            {
+                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseQueryCompleted,
+                                             "Query completed: found " + std::to_string(results.size()) + " studies");
+            }
+        }
+        else if (status == DimseStatus::ConnectionFailed && m_eventManager)
+        {
+            m_eventManager->dispatchEvent(events::ProcessingEventType::DimseError, m_lastError);
+        }
+
+        return status;
+    }
+
+    DimseStatus DimseQueryService::querySeries(const DicomPeer& peer,
+                                              const LocalAEConfig& localAE,
+                                              const std::string& studyInstanceUID,
+                                              std::vector<RemoteSeriesInfo>& results)
+    {
+        m_cancelRequested = false;
+        results.clear();
+
+        if (studyInstanceUID.empty())
+        {
+            m_lastError = "Study Instance UID is required for a series query";
+            return DimseStatus::InvalidParameters;
+        }
+
+        std::unique_ptr<DcmDataset> query(buildSeriesQueryDataset(studyInstanceUID));
+        DimseStatus status = executeFind(peer, localAE, query.get(), 0,
+            [this, &results](DcmDataset* identifiers) {
+                results.push_back(parseSeriesResponse(identifiers));
+            });
+
+        if (status == DimseStatus::Success)
+        {
+            // Peers return series in matching order; present them in acquisition order
+            std::stable_sort(results.begin(), results.end(),
+                [](const RemoteSeriesInfo& lhs, const RemoteSeriesInfo& rhs) {
+                    return std::atoi(lhs.seriesNumber.c_str()) < std::atoi(rhs.seriesNumber.c_str());
+                });
+            qCInfo(lcDimse) << "Series C-FIND completed. Found" << results.size() << "series";
+        }
+
+        return status;
+    }
+
+    DimseStatus DimseQueryService::queryInstances(const DicomPeer& peer,
+                                                 const LocalAEConfig& localAE,
+                                                 const std::string& studyInstanceUID,
+                                                 const std::string& seriesInstanceUID,
+                                                 std::vector<RemoteInstanceInfo>& results)
+    {
+        m_cancelRequested = false;
+        results.clear();
+
+        if (studyInstanceUID.empty() || seriesInstanceUID.empty())
+        {
+            m_lastError = "Study and Series Instance UIDs are required for an instance query";
+            return DimseStatus::InvalidParameters;
+        }
+
+        std::unique_ptr<DcmDataset> query(buildInstanceQueryDataset(studyInstanceUID, seriesInstanceUID));
+        DimseStatus status = executeFind(peer, localAE, query.get(), 0,
+            [this, &results](DcmDataset* identifiers) {
+                results.push_back(parseInstanceResponse(identifiers));
+            });
+
+        if (status == DimseStatus::Success)
+        {
+            std::stable_sort(results.begin(), results.end(),
+                [](const RemoteInstanceInfo& lhs, const RemoteInstanceInfo& rhs) {
+                    return std::atoi(lhs.instanceNumber.c_str()) < std::atoi(rhs.instanceNumber.c_str());
+                });
+            qCInfo(lcDimse) << "Instance C-FIND completed. Found" << results.size() << "instances";
+        }
+
+        return status;
+    }
+
+    DimseStatus DimseQueryService::executeFind(const DicomPeer& peer,
+                                              const LocalAEConfig& localAE,
+                                              DcmDataset* query,
+                                              int maxResults,
+                                              const FindMatchHandler& onMatch)
+    {
+        if (!query)
+        {
+            m_lastError = "Failed to build query dataset";
+            return DimseStatus::InvalidParameters;
+        }
+
         auto assoc = m_connectionPool->acquire(peer, localAE);
         if (!assoc)
         {
             m_lastError = "Failed to acquire connection";
             qCWarning(lcDimse) << m_lastError.c_str();
-            if (m_eventManager)
-            {
-                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseError, m_lastError);
-            }
             return DimseStatus::ConnectionFailed;
         }
 
@@ -245,7 +394,7 @@ namespace isis::core::network
         if (!association)
         {
             m_lastError = "Invalid association";
-            m_connectionPool->release(assoc);
+            m_connectionPool->discard(assoc);
             return DimseStatus::ConnectionFailed;
         }
 
@@ -261,46 +410,41 @@ namespace isis::core::network
             return DimseStatus::Failure;
         }
 
-        // Build query dataset
-        DcmDataset* queryDataset = buildQueryDataset(filter);
-        if (!queryDataset)
-        {
-            m_lastError = "Failed to build query dataset";
-            m_connectionPool->release(assoc);
-            return DimseStatus::InvalidParameters;
-        }
-
         // Prepare DIMSE request
         T_DIMSE_C_FindRQ request;
         T_DIMSE_C_FindRSP response;
         DcmDataset* statusDetail = nullptr;
 
         memset(&request, 0, sizeof(request));
+        memset(&response, 0, sizeof(response));
         request.MessageID = association->nextMsgID++;
         strcpy(request.AffectedSOPClassUID, UID_FINDStudyRootQueryRetrieveInformationModel);
         request.Priority = DIMSE_PRIORITY_MEDIUM;
         request.DataSetType = DIMSE_DATASET_PRESENT;
 
-        qCInfo(lcDimse) << "Sending C-FIND request...";
+        OFString level;
+        query->findAndGetOFString(DCM_QueryRetrieveLevel, level);
+        qCInfo(lcDimse) << "Sending C-FIND request, level" << level.c_str();
 
-        OFCondition cond;
         int responseCount = 0;
-        FindCallbackContext context{this, callback, &results, filter.maxResults};
-
-        cond = DIMSE_findUser(association,
-                              presID,
-                              &request,
-                              queryDataset,
-                              responseCount,
-                              &DimseQueryService::findResponseHandler,
-                              &context,
-                              DIMSE_BLOCKING,
-                              0,
-                              &response,
-                              &statusDetail);
-
-        delete queryDataset;
-        queryDataset = nullptr;
+        FindCallbackContext context;
+        context.service = this;
+        context.onMatch = onMatch;
+        context.maxResults = maxResults;
+        context.association = association;
+        context.presID = presID;
+
+        OFCondition cond = DIMSE_findUser(association,
+                                          presID,
+                                          &request,
+                                          query,
+                                          responseCount,
+                                          &DimseQueryService::findResponseHandler,
+                                          &context,
+                                          DIMSE_BLOCKING,
+                                          0,
+                                          &response,
+                                          &statusDetail);
 
         if (statusDetail)
         {
@@ -308,31 +452,29 @@ namespace isis::core::network
             statusDetail = nullptr;
         }
 
-        m_connectionPool->release(assoc);
-
         if (cond.bad())
         {
+            m_connectionPool->discard(assoc);
             m_lastError = "C-FIND failed: " + std::string(cond.text());
             qCWarning(lcDimse) << m_lastError.c_str();
             return conditionToStatus(cond);
         }
 
-        if (m_cancelRequested.load() ||
-            response.DimseStatus == STATUS_FIND_Cancel_MatchingTerminatedDueToCancelRequest)
+        m_connectionPool->release(assoc);
+
+        if (m_cancelRequested.load())
         {
             m_lastError = "Query cancelled";
             qCInfo(lcDimse) << m_lastError.c_str();
             return DimseStatus::Cancelled;
         }
 
-        if (response.DimseStatus == STATUS_Success)
+        // A cancel sent because maxResults was reached still yields a complete result set
+        const bool truncated = context.cancelSent &&
+            response.DimseStatus == STATUS_FIND_Cancel_MatchingTerminatedDueToCancelRequest;
+
+        if (response.DimseStatus == STATUS_Success || truncated)
         {
-            qCInfo(lcDimse) << "C-FIND completed. Found" << results.size() << "studies";
-            if (m_eventManager)
-            {
-                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseQueryCompleted,
-                                             "Query completed: found " + std::to_string(results.size()) + " studies");
-            }
             return DimseStatus::Success;
         }
 
@@ -341,17 +483,6 @@ namespace isis::core::network
         return DimseStatus::Failure;
     }
 
-    DimseStatus DimseQueryService::querySeries(const DicomPeer& peer,
-                                              const LocalAEConfig& localAE,
-                                              const std::string& studyInstanceUID,
-                                              std::vector<RemoteSeriesInfo>& results)
-    {
-        // Similar implementation to queryStudies but at SERIES level
-        // Omitted for brevity - would query at series root level
-        qCInfo(lcDimse) << "Series query not yet implemented";
-        return DimseStatus::Success;
-    }
-
     QFuture<std::vector<RemoteStudyInfo>> DimseQueryService::queryStudiesAsync(
         const DicomPeer& peer,
         const LocalAEConfig& localAE,
@@ -445,6 +576,44 @@ namespace isis::core::network
         return dataset;
     }
 
+    DcmDataset* DimseQueryService::buildSeriesQueryDataset(const std::string& studyInstanceUID)
+    {
+        DcmDataset* dataset = new DcmDataset();
+
+        dataset->putAndInsertString(DCM_QueryRetrieveLevel, "SERIES");
+        dataset->putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID.c_str());
+
+        // Return attributes
+        dataset->putAndInsertString(DCM_SeriesInstanceUID, "");
+        dataset->putAndInsertString(DCM_SeriesNumber, "");
+        dataset->putAndInsertString(DCM_SeriesDescription, "");
+        dataset->putAndInsertString(DCM_Modality, "");
+        dataset->putAndInsertString(DCM_BodyPartExamined, "");
+        dataset->putAndInsertString(DCM_NumberOfSeriesRelatedInstances, "");
+
+        return dataset;
+    }
+
+    DcmDataset* DimseQueryService::buildInstanceQueryDataset(const std::string& studyInstanceUID,
+                                                             const std::string& seriesInstanceUID)
+    {
+        DcmDataset* dataset = new DcmDataset();
+
+        dataset->putAndInsertString(DCM_QueryRetrieveLevel, "IMAGE");
+        dataset->putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID.c_str());
+        dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesInstanceUID.c_str());
+
+        // Return attributes
+        dataset->putAndInsertString(DCM_SOPInstanceUID, "");
+        dataset->putAndInsertString(DCM_SOPClassUID, "");
+        dataset->putAndInsertString(DCM_InstanceNumber, "");
+        dataset->putAndInsertString(DCM_Rows, "");
+        dataset->putAndInsertString(DCM_Columns, "");
+        dataset->putAndInsertString(DCM_NumberOfFrames, "");
+
+        return dataset;
+    }
+
     RemoteStudyInfo DimseQueryService::parseStudyResponse(DcmDataset* dataset)
     {
         RemoteStudyInfo info;
@@ -518,6 +687,9 @@ namespace isis::core::network
         if (dataset->findAndGetOFString(DCM_Modality, value).good())
             info.modality = value.c_str();
 
+        if (dataset->findAndGetOFString(DCM_BodyPartExamined, value).good())
+            info.bodyPartExamined = value.c_str();
+
         Sint32 intValue;
         if (dataset->findAndGetSint32(DCM_NumberOfSeriesRelatedInstances, intValue).good())
             info.numberOfInstances = intValue;
@@ -525,6 +697,44 @@ namespace isis::core::network
         return info;
     }
 
+    RemoteInstanceInfo DimseQueryService::parseInstanceResponse(DcmDataset* dataset)
+    {
+        RemoteInstanceInfo info;
+
+        if (!dataset)
+            return info;
+
+        OFString value;
+
+        if (dataset->findAndGetOFString(DCM_SOPInstanceUID, value).good())
+            info.sopInstanceUID = value.c_str();
+
+        if (dataset->findAndGetOFString(DCM_SOPClassUID, value).good())
+            info.sopClassUID = value.c_str();
+
+        if (dataset->findAndGetOFString(DCM_SeriesInstanceUID, value).good())
+            info.seriesInstanceUID = value.c_str();
+
+        if (dataset->findAndGetOFString(DCM_StudyInstanceUID, value).good())
+            info.studyInstanceUID = value.c_str();
+
+        if (dataset->findAndGetOFString(DCM_InstanceNumber, value).good())
+            info.instanceNumber = value.c_str();
+
+        Uint16 shortValue;
+        if (dataset->findAndGetUint16(DCM_Rows, shortValue).good())
+            info.rows = shortValue;
+
+        if (dataset->findAndGetUint16(DCM_Columns, shortValue).good())
+            info.columns = shortValue;
+
+        Sint32 intValue;
+        if (dataset->findAndGetSint32(DCM_NumberOfFrames, intValue).good())
+            info.numberOfFrames = intValue;
+
+        return info;
+    }
+
     // DimseRetrieveService implementation
 
     DimseRetrieveService::DimseRetrieveService(std::shared_ptr<DimseConnectionPool> pool,
@@ -539,6 +749,15 @@ namespace isis::core::network
                                                        const std::string& studyInstanceUID,
                                                        const std::string& destinationAE,
                                                        DimseProgressCallback callback)
+    {
+        return retrieveMove(peer, localAE, RetrieveTarget(studyInstanceUID), destinationAE, callback);
+    }
+
+    DimseStatus DimseRetrieveService::retrieveMove(const DicomPeer& peer,
+                                                  const LocalAEConfig& localAE,
+                                                  const RetrieveTarget& target,
+                                                  const std::string& destinationAE,
+                                                  DimseProgressCallback callback)
     {
         m_cancelRequested = false;
         m_lastError.clear();
@@ -550,10 +769,15 @@ namespace isis::core::network
             return DimseStatus::InvalidParameters;
         }
 
+        if (!validateTarget(target, "C-MOVE"))
+        {
+            return DimseStatus::InvalidParameters;
+        }
+
         if (m_eventManager)
         {
             m_eventManager->dispatchEvent(events::ProcessingEventType::DimseRetrieveStarted,
-                                         "Starting C-MOVE for study " + studyInstanceUID);
+                                         "Starting C-MOVE for " + describeTarget(target));
         }
 
         auto assoc = m_connectionPool->acquire(peer, localAE);
@@ -584,7 +808,7 @@ namespace isis::core::network
             return DimseStatus::ConnectionFailed;
         }
 
-        std::unique_ptr<DcmDataset> dataset(buildRetrieveDataset(studyInstanceUID));
+        std::unique_ptr<DcmDataset> dataset(buildRetrieveDataset(target));
         if (!dataset)
         {
             m_lastError = "Failed to build retrieve dataset";
@@ -608,7 +832,7 @@ namespace isis::core::network
         OFStandard::strlcpy(request.AffectedSOPClassUID,
                             UID_MOVEStudyRootQueryRetrieveInformationModel,
                             sizeof(request.AffectedSOPClassUID));
-        request.Priority = DIMSE_PRIORITY_MEDIUM;
+        request.Priority = m_requestPriority;
         request.DataSetType = DIMSE_DATASET_PRESENT;
 
         std::string moveDestination = destinationAE.empty() ? localAE.aeTitle : destinationAE;
@@ -625,6 +849,8 @@ namespace isis::core::network
         MoveCallbackContext context;
         context.service = this;
         context.progressCallback = callback;
+        context.association = association;
+        context.presID = presID;
 
         T_DIMSE_C_MoveRSP response;
         memset(&response, 0, sizeof(response));
@@ -657,6 +883,11 @@ namespace isis::core::network
             responseIdentifiers = nullptr;
         }
 
+        if (cond.bad())
+        {
+            m_connectionPool->discard(assoc);
+            assoc.reset();
+        }
         releaseAssociation();
 
         if (cond.bad())
@@ -731,93 +962,46 @@ namespace isis::core::network
                                                       const std::string& studyInstanceUID,
                                                       DimseProgressCallback callback)
     {
-        // C-GET implementation would go here
-        qCInfo(lcDimse) << "C-GET not yet implemented";
-        return DimseStatus::Success;
-    }
-
-    DimseStatus DimseRetrieveService::retrieveStudy(const DicomPeer& peer,
-                                                   const LocalAEConfig& localAE,
-                                                   const std::string& studyInstanceUID,
-                                                   DimseProgressCallback callback)
-    {
-        // Try C-MOVE first, fallback to C-GET if needed
-        std::string destAE = peer.moveDestinationAE.empty() ? localAE.aeTitle : peer.moveDestinationAE;
-        return retrieveStudyMove(peer, localAE, studyInstanceUID, destAE, callback);
-    }
-
-    QFuture<DimseStatus> DimseRetrieveService::retrieveStudyAsync(
-        const DicomPeer& peer,
-        const LocalAEConfig& localAE,
-        const std::string& studyInstanceUID,
-        DimseProgressCallback callback)
-    {
-        return QtConcurrent::run([this, peer, localAE, studyInstanceUID, callback]() {
-            return retrieveStudy(peer, localAE, studyInstanceUID, callback);
-        });
-    }
-
-    void DimseRetrieveService::cancelRetrieve()
-    {
-        m_cancelRequested = true;
-        qCInfo(lcDimse) << "Retrieve cancellation requested";
-    }
-
-    DcmDataset* DimseRetrieveService::buildRetrieveDataset(const std::string& studyInstanceUID)
-    {
-        DcmDataset* dataset = new DcmDataset();
-
-        dataset->putAndInsertString(DCM_QueryRetrieveLevel, "STUDY");
-        dataset->putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID.c_str());
-
-        return dataset;
-    }
-
-    // DimseStoreService implementation
-
-    DimseStoreService::DimseStoreService(std::shared_ptr<DimseConnectionPool> pool,
-                                        std::shared_ptr<events::CallbackManager> eventManager)
-        : m_connectionPool(pool)
-        , m_eventManager(eventManager)
-    {
+        return retrieveGet(peer, localAE, RetrieveTarget(studyInstanceUID), callback);
     }
 
-    DimseStatus DimseStoreService::storeFile(const DicomPeer& peer,
-                                            const LocalAEConfig& localAE,
-                                            const std::string& filepath,
-                                            DimseProgressCallback callback)
+    DimseStatus DimseRetrieveService::retrieveGet(const DicomPeer& peer,
+                                                 const LocalAEConfig& localAE,
+                                                 const RetrieveTarget& target,
+                                                 DimseProgressCallback callback)
     {
-        std::vector<std::string> files = {filepath};
-        return storeFiles(peer, localAE, files, callback);
-    }
+        namespace fs = std::filesystem;
 
-    DimseStatus DimseStoreService::storeFiles(const DicomPeer& peer,
-                                             const LocalAEConfig& localAE,
-                                             const std::vector<std::string>& filepaths,
-                                             DimseProgressCallback callback)
-    {
         m_cancelRequested = false;
-        m_storedCount = 0;
-        m_failedCount = 0;
+        m_receivedCount = 0;
+        m_receivedBytes = 0;
+        m_lastError.clear();
 
-        if (filepaths.empty())
+        if (!validateTarget(target, "C-GET"))
         {
-            m_lastError = "No files specified";
             return DimseStatus::InvalidParameters;
         }
 
+        if (localAE.tempStoragePath.empty())
+        {
+            m_lastError = "No storage directory configured for C-GET";
+            qCWarning(lcDimse) << m_lastError.c_str();
+            return DimseStatus::InvalidParameters;
+        }
+
+        std::error_code ec;
+        fs::create_directories(fs::u8path(localAE.tempStoragePath), ec);
+
         if (m_eventManager)
         {
-            std::string msg = "Starting C-STORE: " + std::to_string(filepaths.size()) +
-                            " files to " + peer.name;
-            m_eventManager->dispatchEvent(events::ProcessingEventType::DimseConnectionStarted, msg);
+            m_eventManager->dispatchEvent(events::ProcessingEventType::DimseRetrieveStarted,
+                                         "Starting C-GET for " + describeTarget(target));
         }
 
-        // Acquire connection
-        auto assoc = m_connectionPool->acquire(peer, localAE);
+        auto assoc = m_connectionPool->acquire(peer, localAE, buildGetProposals());
         if (!assoc)
         {
-            m_lastError = "Failed to acquire connection";
+            m_lastError = "Failed to acquire connection for C-GET";
             qCWarning(lcDimse) << m_lastError.c_str();
             if (m_eventManager)
             {
@@ -829,49 +1013,858 @@ namespace isis::core::network
         T_ASC_Association* association = assoc->getAssociation();
         if (!association)
         {
-            m_lastError = "Invalid association";
-            m_connectionPool->release(assoc);
+            m_lastError = "Invalid association for C-GET";
+            m_connectionPool->discard(assoc);
             return DimseStatus::ConnectionFailed;
         }
 
-        DimseStatus overallStatus = DimseStatus::Success;
-
-        // Store each file
-        for (size_t i = 0; i < filepaths.size(); ++i)
-        {
-            if (m_cancelRequested)
+        T_ASC_PresentationContextID presID = ASC_findAcceptedPresentationContextID(
+            association, UID_GETStudyRootQueryRetrieveInformationModel);
+        if (presID == 0)
+        {
+            m_lastError = "No presentation context for C-GET Study Root";
+            qCWarning(lcDimse) << m_lastError.c_str();
+            m_connectionPool->release(assoc);
+            return DimseStatus::Failure;
+        }
+
+        std::unique_ptr<DcmDataset> dataset(buildRetrieveDataset(target));
+
+        T_DIMSE_Message request;
+        memset(&request, 0, sizeof(request));
+        request.CommandField = DIMSE_C_GET_RQ;
+        T_DIMSE_C_GetRQ& getRequest = request.msg.CGetRQ;
+        getRequest.MessageID = association->nextMsgID++;
+        OFStandard::strlcpy(getRequest.AffectedSOPClassUID,
+                            UID_GETStudyRootQueryRetrieveInformationModel,
+                            sizeof(getRequest.AffectedSOPClassUID));
+        getRequest.Priority = m_requestPriority;
+        getRequest.DataSetType = DIMSE_DATASET_PRESENT;
+
+        OFCondition cond = DIMSE_sendMessageUsingMemoryData(association, presID, &request,
+                                                           nullptr, dataset.get(), nullptr, nullptr);
+
+        // C-STORE sub-operations and C-GET responses are interleaved on this association;
+        // the loop ends with the final (non-pending) C-GET-RSP
+        const auto start = std::chrono::steady_clock::now();
+        const auto idleLimit = std::chrono::seconds(std::max(1, peer.timeout));
+        auto lastActivity = start;
+        std::uint64_t bytesReceived = 0;
+        int failedStores = 0;
+        bool cancelSent = false;
+        bool finished = false;
+        DIC_US finalStatus = STATUS_Success;
+        T_DIMSE_C_GetRSP finalResponse;
+        memset(&finalResponse, 0, sizeof(finalResponse));
+
+        while (cond.good() && !finished)
+        {
+            if (m_cancelRequested.load() && !cancelSent)
+            {
+                cond = DIMSE_sendCancelRequest(association, presID, getRequest.MessageID);
+                cancelSent = true;
+                if (cond.bad())
+                {
+                    break;
+                }
+            }
+
+            T_DIMSE_Message message;
+            T_ASC_PresentationContextID messagePresID = 0;
+            DcmDataset* statusDetail = nullptr;
+            cond = DIMSE_receiveCommand(association, DIMSE_NONBLOCKING, 1, &messagePresID,
+                                        &message, &statusDetail);
+            delete statusDetail;
+
+            if (cond == DIMSE_NODATAAVAILABLE)
+            {
+                if (std::chrono::steady_clock::now() - lastActivity > idleLimit)
+                {
+                    cond = DIMSE_NODATAAVAILABLE;
+                    break;
+                }
+                cond = EC_Normal;
+                continue;
+            }
+            if (cond.bad())
             {
-                qCInfo(lcDimse) << "C-STORE cancelled by user";
-                overallStatus = DimseStatus::Cancelled;
                 break;
             }
+            lastActivity = std::chrono::steady_clock::now();
 
-            DimseStatus status = storeSingleFile(association, filepaths[i],
-                                                static_cast<int>(i),
-                                                static_cast<int>(filepaths.size()),
-                                                callback);
+            if (message.CommandField == DIMSE_C_STORE_RQ)
+            {
+                T_DIMSE_C_StoreRQ& storeRequest = message.msg.CStoreRQ;
+                DIC_US storeStatus = STATUS_Success;
+                // Filed and indexed exactly like objects sent to the Storage SCP
+                const std::string storageDirectory = m_storageIndex ? m_storageIndex->getRootDirectory()
+                                                                    : localAE.tempStoragePath;
+                const ReceivedStoreObject object = receiveStoreDataSet(
+                    association, &storeRequest, messagePresID, storageDirectory, m_storageIndex.get(),
+                    peer.aeTitle, storeStatus);
+                const std::string& filepath = object.filepath;
+
+                T_DIMSE_C_StoreRSP storeResponse;
+                memset(&storeResponse, 0, sizeof(storeResponse));
+                storeResponse.MessageIDBeingRespondedTo = storeRequest.MessageID;
+                storeResponse.DimseStatus = storeStatus;
+                storeResponse.DataSetType = DIMSE_DATASET_NULL;
+                OFStandard::strlcpy(storeResponse.AffectedSOPClassUID, storeRequest.AffectedSOPClassUID,
+                                    sizeof(storeResponse.AffectedSOPClassUID));
+                OFStandard::strlcpy(storeResponse.AffectedSOPInstanceUID, storeRequest.AffectedSOPInstanceUID,
+                                    sizeof(storeResponse.AffectedSOPInstanceUID));
+                storeResponse.opts = O_STORE_AFFECTEDSOPCLASSUID | O_STORE_AFFECTEDSOPINSTANCEUID;
+
+                cond = DIMSE_sendStoreResponse(association, messagePresID, &storeRequest,
+                                               &storeResponse, nullptr);
+
+                if (filepath.empty())
+                {
+                    failedStores++;
+                    continue;
+                }
+
+                m_receivedCount++;
+                m_receivedBytes += object.bytes;
+                bytesReceived += object.bytes;
+
+                if (m_eventManager)
+                {
+                    m_eventManager->dispatchEvent(events::ProcessingEventType::DimseStorageReceived,
+                                                 "Received file: " + filepath);
+                }
+                if (m_instanceCallback && object.headerRead)
+                {
+                    m_instanceCallback(object.header);
+                }
+                else if (m_storageCallback)
+                {
+                    m_storageCallback(filepath);
+                }
+            }
+            else if (message.CommandField == DIMSE_C_GET_RSP)
+            {
+                const T_DIMSE_C_GetRSP& response = message.msg.CGetRSP;
+
+                // A final response may carry a Failed SOP Instance UID List
+                if (response.DataSetType != DIMSE_DATASET_NULL)
+                {
+                    DcmDataset* identifiers = nullptr;
+                    T_ASC_PresentationContextID dataPresID = messagePresID;
+                    cond = DIMSE_receiveDataSetInMemory(association, DIMSE_BLOCKING, 0, &dataPresID,
+                                                        &identifiers, nullptr, nullptr);
+                    delete identifiers;
+                }
+
+                const int remaining = (response.opts & O_GET_NUMBEROFREMAININGSUBOPERATIONS)
+                    ? response.NumberOfRemainingSubOperations : 0;
+                const int completed = response.NumberOfCompletedSubOperations;
+                const int failed = response.NumberOfFailedSubOperations;
+                const int warning = response.NumberOfWarningSubOperations;
+                const int total = remaining + completed + failed + warning;
+                const double progress = total > 0
+                    ? static_cast<double>(completed + failed + warning) / static_cast<double>(total)
+                    : 0.0;
+
+                if (DICOM_PENDING_STATUS(response.DimseStatus))
+                {
+                    const std::string progressMessage = "C-GET: " + std::to_string(completed) +
+                        " received, " + std::to_string(remaining) + " remaining";
+                    if (callback)
+                    {
+                        callback(progress, progressMessage);
+                    }
+                    if (m_eventManager)
+                    {
+                        m_eventManager->dispatchProgress(events::ProcessingEventType::DimseRetrieveProgress,
+                                                         progress, progressMessage);
+                    }
+                    continue;
+                }
+
+                finalStatus = response.DimseStatus;
+                finalResponse = response;
+                finished = true;
+            }
+            else
+            {
+                m_lastError = "Unexpected DIMSE command during C-GET: " +
+                    std::to_string(static_cast<int>(message.CommandField));
+                cond = DIMSE_BADCOMMANDTYPE;
+            }
+        }
 
-            if (status == DimseStatus::Success)
+        if (cond.bad() || !finished)
+        {
+            m_connectionPool->discard(assoc);
+        }
+        else
+        {
+            m_connectionPool->release(assoc);
+        }
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        utils::telemetry().increment("dimse.get.objects", static_cast<std::uint64_t>(m_receivedCount.load()));
+        utils::telemetry().increment("dimse.get.bytes", bytesReceived);
+        utils::telemetry().recordDuration("dimse.get.duration",
+            std::chrono::microseconds(static_cast<std::int64_t>(elapsedMs * 1000.0)));
+
+        if (cond.bad() || !finished)
+        {
+            if (m_lastError.empty())
             {
-                m_storedCount++;
+                m_lastError = "C-GET failed: " + std::string(cond.bad() ? cond.text() : "no final response");
+            }
+            qCWarning(lcDimse) << m_lastError.c_str();
+            if (m_eventManager)
+            {
+                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseError, m_lastError);
+            }
+            return cond == DIMSE_NODATAAVAILABLE ? DimseStatus::Timeout : conditionToStatus(cond);
+        }
+
+        DimseStatus status = DimseStatus::Failure;
+        std::ostringstream summary;
+        summary << "C-GET received " << m_receivedCount.load() << " object(s)";
+
+        if (finalStatus == STATUS_Success)
+        {
+            status = DimseStatus::Success;
+        }
+        else if (finalStatus == STATUS_GET_Cancel_SubOperationsTerminatedDueToCancelIndication)
+        {
+            status = DimseStatus::Cancelled;
+            summary << ", cancelled";
+        }
+        else if (finalStatus == STATUS_GET_Warning_SubOperationsCompleteOneOrMoreFailures &&
+                 finalResponse.NumberOfCompletedSubOperations > 0)
+        {
+            // Partial retrieve: what arrived is usable, report the failures
+            status = DimseStatus::Success;
+            summary << ", " << finalResponse.NumberOfFailedSubOperations << " failed";
+            m_lastError = summary.str();
+            qCWarning(lcDimse) << m_lastError.c_str();
+        }
+        else
+        {
+            summary << ", failed with status 0x" << std::hex << finalStatus;
+            m_lastError = summary.str();
+            qCWarning(lcDimse) << m_lastError.c_str();
+        }
+
+        if (failedStores > 0 && status == DimseStatus::Success)
+        {
+            m_lastError = summary.str() + " (" + std::to_string(failedStores) + " could not be written)";
+            qCWarning(lcDimse) << m_lastError.c_str();
+        }
+
+        qCInfo(lcDimse) << summary.str().c_str() << "in" << elapsedMs << "ms";
+
+        if (status == DimseStatus::Success && callback)
+        {
+            callback(1.0, "C-GET completed");
+        }
+
+        if (m_eventManager)
+        {
+            m_eventManager->dispatchEvent(status == DimseStatus::Success
+                                              ? events::ProcessingEventType::DimseRetrieveCompleted
+                                              : events::ProcessingEventType::DimseError,
+                                          summary.str());
+        }
+
+        return status;
+    }
+
+    DimseStatus DimseRetrieveService::retrieveStudy(const DicomPeer& peer,
+                                                   const LocalAEConfig& localAE,
+                                                   const std::string& studyInstanceUID,
+                                                   DimseProgressCallback callback)
+    {
+        return retrieve(peer, localAE, RetrieveTarget(studyInstanceUID), callback);
+    }
+
+    DimseStatus DimseRetrieveService::retrieveSeries(const DicomPeer& peer,
+                                                    const LocalAEConfig& localAE,
+                                                    const std::string& studyInstanceUID,
+                                                    const std::string& seriesInstanceUID,
+                                                    DimseProgressCallback callback)
+    {
+        RetrieveTarget target(studyInstanceUID);
+        target.seriesInstanceUID = seriesInstanceUID;
+        return retrieve(peer, localAE, target, callback);
+    }
+
+    DimseStatus DimseRetrieveService::retrieveInstances(const DicomPeer& peer,
+                                                       const LocalAEConfig& localAE,
+                                                       const std::string& studyInstanceUID,
+                                                       const std::string& seriesInstanceUID,
+                                                       const std::vector<std::string>& sopInstanceUIDs,
+                                                       DimseProgressCallback callback)
+    {
+        if (sopInstanceUIDs.empty())
+        {
+            m_lastError = "No instances selected";
+            return DimseStatus::InvalidParameters;
+        }
+
+        RetrieveTarget target(studyInstanceUID);
+        target.seriesInstanceUID = seriesInstanceUID;
+        target.sopInstanceUIDs = sopInstanceUIDs;
+        return retrieve(peer, localAE, target, callback);
+    }
+
+    DimseStatus DimseRetrieveService::retrieve(const DicomPeer& peer,
+                                              const LocalAEConfig& localAE,
+                                              const RetrieveTarget& target,
+                                              DimseProgressCallback callback)
+    {
+        if (peer.useCGet)
+        {
+            return retrieveGet(peer, localAE, target, callback);
+        }
+
+        std::string destAE = peer.moveDestinationAE.empty() ? localAE.aeTitle : peer.moveDestinationAE;
+        return retrieveMove(peer, localAE, target, destAE, callback);
+    }
+
+    QFuture<DimseStatus> DimseRetrieveService::retrieveStudyAsync(
+        const DicomPeer& peer,
+        const LocalAEConfig& localAE,
+        const std::string& studyInstanceUID,
+        DimseProgressCallback callback)
+    {
+        return QtConcurrent::run([this, peer, localAE, studyInstanceUID, callback]() {
+            return retrieveStudy(peer, localAE, studyInstanceUID, callback);
+        });
+    }
+
+    void DimseRetrieveService::cancelRetrieve()
+    {
+        m_cancelRequested = true;
+        qCInfo(lcDimse) << "Retrieve cancellation requested";
+    }
+
+    void DimseRetrieveService::setStorageReceivedCallback(StorageReceivedCallback callback)
+    {
+        m_storageCallback = std::move(callback);
+    }
+
+    void DimseRetrieveService::setInstanceReceivedCallback(InstanceReceivedCallback callback)
+    {
+        m_instanceCallback = std::move(callback);
+    }
+
+    void DimseRetrieveService::setStorageIndex(std::shared_ptr<DimseStorageIndex> index)
+    {
+        m_storageIndex = std::move(index);
+    }
+
+    void DimseRetrieveService::setRequestPriority(T_DIMSE_Priority priority)
+    {
+        m_requestPriority = priority;
+    }
+
+    bool DimseRetrieveService::validateTarget(const RetrieveTarget& target, const char* operation)
+    {
+        if (target.studyInstanceUID.empty())
+        {
+            m_lastError = std::string("Study Instance UID is required for ") + operation;
+            return false;
+        }
+
+        if (!target.sopInstanceUIDs.empty() && target.seriesInstanceUID.empty())
+        {
+            m_lastError = std::string("Series Instance UID is required for an IMAGE level ") + operation;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string DimseRetrieveService::describeTarget(const RetrieveTarget& target)
+    {
+        if (!target.sopInstanceUIDs.empty())
+        {
+            return std::to_string(target.sopInstanceUIDs.size()) +
+                " instance(s) of series " + target.seriesInstanceUID;
+        }
+        if (!target.seriesInstanceUID.empty())
+        {
+            return "series " + target.seriesInstanceUID;
+        }
+        return "study " + target.studyInstanceUID;
+    }
+
+    std::vector<PresentationContextProposal> DimseRetrieveService::buildGetProposals()
+    {
+        // Objects are stored bit-preserved, so common compressed syntaxes can be accepted as-is
+        const std::vector<std::string> storageTransferSyntaxes = {
+            UID_LittleEndianExplicitTransferSyntax,
+            UID_LittleEndianImplicitTransferSyntax,
+            UID_BigEndianExplicitTransferSyntax,
+            UID_JPEGProcess14SV1TransferSyntax,
+            UID_JPEGProcess1TransferSyntax,
+            UID_JPEGProcess2_4TransferSyntax,
+            UID_JPEG2000LosslessOnlyTransferSyntax,
+            UID_JPEG2000TransferSyntax,
+            UID_RLELosslessTransferSyntax,
+            UID_JPEGLSLosslessTransferSyntax,
+            UID_DeflatedExplicitVRLittleEndianTransferSyntax
+        };
+
+        std::vector<PresentationContextProposal> proposals;
+        proposals.emplace_back(UID_GETStudyRootQueryRetrieveInformationModel);
+
+        // Presentation context IDs limit an association to 128 contexts; the short
+        // SCU list covers the common image SOP classes within that limit
+        for (int i = 0; i < numberOfDcmShortSCUStorageSOPClassUIDs; ++i)
+        {
+            proposals.emplace_back(dcmShortSCUStorageSOPClassUIDs[i], storageTransferSyntaxes, ASC_SC_ROLE_SCP);
+        }
+
+        return proposals;
+    }
+
+    DcmDataset* DimseRetrieveService::buildRetrieveDataset(const RetrieveTarget& target)
+    {
+        DcmDataset* dataset = new DcmDataset();
+
+        // Study Root unique keys down to the requested level
+        dataset->putAndInsertString(DCM_QueryRetrieveLevel, target.level());
+        dataset->putAndInsertString(DCM_StudyInstanceUID, target.studyInstanceUID.c_str());
+
+        if (!target.seriesInstanceUID.empty())
+        {
+            dataset->putAndInsertString(DCM_SeriesInstanceUID, target.seriesInstanceUID.c_str());
+        }
+
+        if (!target.sopInstanceUIDs.empty())
+        {
+            // List of UID matching: one C-MOVE moves the whole selection
+            std::string uidList;
+            for (const auto& uid : target.sopInstanceUIDs)
+            {
+                if (!uidList.empty())
+                {
+                    uidList += '\\';
+                }
+                uidList += uid;
+            }
+            dataset->putAndInsertString(DCM_SOPInstanceUID, uidList.c_str());
+        }
+
+        return dataset;
+    }
+
+    // DimseStoreService implementation
+
+    namespace
+    {
+        // Lossless syntaxes offered for uncompressed objects, most preferred first.
+        // DCMTK has no JPEG 2000 encoder, so JPEG 2000 is only sent for objects
+        // already stored that way.
+        constexpr const char* compressedStoreSyntaxes[] = {
+            UID_JPEGLSLosslessTransferSyntax,
+            UID_DeflatedExplicitVRLittleEndianTransferSyntax
+        };
+
+        std::once_flag encoderRegistration;
+    }
+
+    struct DimseStoreService::PreparedStore
+    {
+        std::unique_ptr<DcmFileFormat> file;
+        std::string sopInstanceUID;
+        std::string transferSyntaxUID;      // Encoding the data set is sent in
+        std::string error;
+    };
+
+    DimseStoreService::DimseStoreService(std::shared_ptr<DimseConnectionPool> pool,
+                                        std::shared_ptr<events::CallbackManager> eventManager)
+        : m_connectionPool(pool)
+        , m_eventManager(eventManager)
+    {
+        // Registered once for the process; the codec list must not change while
+        // other threads are encoding
+        std::call_once(encoderRegistration, []() { DJLSEncoderRegistration::registerCodecs(); });
+    }
+
+    DimseStatus DimseStoreService::storeFile(const DicomPeer& peer,
+                                            const LocalAEConfig& localAE,
+                                            const std::string& filepath,
+                                            DimseProgressCallback callback)
+    {
+        std::vector<std::string> files = {filepath};
+        return storeFiles(peer, localAE, files, callback);
+    }
+
+    DimseStatus DimseStoreService::storeFiles(const DicomPeer& peer,
+                                             const LocalAEConfig& localAE,
+                                             const std::vector<std::string>& filepaths,
+                                             DimseProgressCallback callback)
+    {
+        m_cancelRequested = false;
+        m_storedCount = 0;
+        m_failedCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_associationStats.clear();
+        }
+
+        if (filepaths.empty())
+        {
+            m_lastError = "No files specified";
+            return DimseStatus::InvalidParameters;
+        }
+
+        // Read headers only, so every association can negotiate the batch's syntaxes up front
+        const size_t totalFiles = filepaths.size();
+        std::vector<StoreItem> items(totalFiles);
+        std::vector<DimseStatus> results(totalFiles, DimseStatus::Pending);
+        std::vector<std::string> errors(totalFiles);
+        std::vector<size_t> pending;
+        pending.reserve(totalFiles);
+
+        for (size_t i = 0; i < totalFiles; ++i)
+        {
+            if (readStoreHeader(filepaths[i], items[i], errors[i]))
+            {
+                pending.push_back(i);
             }
             else
             {
-                m_failedCount++;
-                overallStatus = DimseStatus::Failure;
+                results[i] = DimseStatus::Failure;
             }
+        }
 
-            // Report progress
-            if (callback && !m_cancelRequested)
+        if (pending.empty())
+        {
+            m_failedCount = static_cast<int>(totalFiles);
+            m_lastError = errors.front();
+            qCWarning(lcDimse) << "C-STORE aborted, no readable DICOM files:" << m_lastError.c_str();
+            if (m_eventManager)
             {
-                double progress = static_cast<double>(i + 1) / filepaths.size();
-                std::string msg = "Stored " + std::to_string(m_storedCount) + "/" +
-                                std::to_string(filepaths.size()) + " files";
-                callback(progress, msg);
+                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseError, m_lastError);
             }
+            return DimseStatus::Failure;
         }
 
-        m_connectionPool->release(assoc);
+        std::vector<StoreItem> readableItems;
+        readableItems.reserve(pending.size());
+        for (size_t index : pending)
+        {
+            readableItems.push_back(items[index]);
+        }
+        const bool compress = peer.compressStore;
+        const std::vector<PresentationContextProposal> proposals = buildStoreProposals(readableItems, compress);
+
+        const size_t poolLimit = std::max<size_t>(1, m_connectionPool->getMaxPoolSize());
+        const size_t workerCount = std::min({static_cast<size_t>(m_maxAssociations), poolLimit, pending.size()});
+
+        if (m_eventManager)
+        {
+            std::string msg = "Starting C-STORE: " + std::to_string(totalFiles) +
+                            " files to " + peer.name + " over " +
+                            std::to_string(workerCount) + " association(s)";
+            m_eventManager->dispatchEvent(events::ProcessingEventType::DimseConnectionStarted, msg);
+        }
+
+        // Shared work queue: files are handed out in order, files whose association
+        // could not be established are put back for the remaining associations.
+        std::mutex stateMutex;
+        std::condition_variable stateChanged;
+        size_t nextPending = 0;
+        std::deque<size_t> requeued;
+        size_t liveWorkers = workerCount;
+        std::vector<StoreAssociationStats> stats(workerCount);
+
+        auto takeNext = [&](size_t& index) -> bool {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!requeued.empty())
+            {
+                index = requeued.front();
+                requeued.pop_front();
+                return true;
+            }
+            if (nextPending < pending.size())
+            {
+                index = pending[nextPending++];
+                return true;
+            }
+            return false;
+        };
+
+        auto complete = [&](size_t index, DimseStatus status, std::string error) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            results[index] = status;
+            errors[index] = std::move(error);
+            stateChanged.notify_all();
+        };
+
+        auto worker = [&](size_t workerIndex) {
+            StoreAssociationStats& stat = stats[workerIndex];
+            stat.associationIndex = static_cast<int>(workerIndex);
+            const auto workerStart = std::chrono::steady_clock::now();
+            std::shared_ptr<DimseAssociation> assoc;
+            int connections = 0;
+            bool abandoned = false;
+            bool connectionDown = false;
+
+            // The next file is loaded (and transcoded) on a helper thread while the
+            // current one is on the wire
+            std::future<PreparedStore> ahead;
+            size_t aheadIndex = 0;
+
+            size_t index = 0;
+            while (!m_cancelRequested && !abandoned && !connectionDown)
+            {
+                std::future<PreparedStore> preparing;
+                if (ahead.valid())
+                {
+                    index = aheadIndex;
+                    preparing = std::move(ahead);
+                }
+                else if (!takeNext(index))
+                {
+                    break;
+                }
+
+                const StoreItem& item = items[index];
+                PreparedStore prepared;
+                bool havePrepared = false;
+                DimseStatus status = DimseStatus::Failure;
+                std::string error;
+
+                for (int attempt = 0; attempt <= m_maxRetries && !m_cancelRequested; ++attempt)
+                {
+                    if (!assoc)
+                    {
+                        assoc = m_connectionPool->acquire(peer, localAE, proposals);
+                        if (!assoc || !assoc->getAssociation())
+                        {
+                            assoc.reset();
+                            std::unique_lock<std::mutex> lock(stateMutex);
+                            if (liveWorkers > 1)
+                            {
+                                // Leave the file to an association that is still alive
+                                requeued.push_back(index);
+                                abandoned = true;
+                                break;
+                            }
+                            lock.unlock();
+                            status = DimseStatus::ConnectionFailed;
+                            error = "Failed to acquire connection";
+                            connectionDown = true;
+                            break;
+                        }
+                        connections++;
+                    }
+
+                    if (!havePrepared)
+                    {
+                        prepared = preparing.valid()
+                            ? preparing.get()
+                            : prepareStoreItem(item, chooseStoreSyntax(assoc->getAssociation(), item, compress));
+                        havePrepared = true;
+                    }
+
+                    if (!ahead.valid() && takeNext(aheadIndex))
+                    {
+                        const StoreItem& next = items[aheadIndex];
+                        const std::string target = chooseStoreSyntax(assoc->getAssociation(), next, compress);
+                        ahead = std::async(std::launch::async, [&next, target]() {
+                            return prepareStoreItem(next, target);
+                        });
+                    }
+
+                    if (attempt > 0)
+                    {
+                        stat.retries++;
+                    }
+
+                    bool associationLost = false;
+                    const auto sendStart = std::chrono::steady_clock::now();
+                    status = storeSingleFile(assoc->getAssociation(), item, prepared, error, associationLost);
+                    const auto latency = std::chrono::steady_clock::now() - sendStart;
+                    const double latencyMs = std::chrono::duration<double, std::milli>(latency).count();
+                    stat.totalLatencyMs += latencyMs;
+                    stat.maxLatencyMs = std::max(stat.maxLatencyMs, latencyMs);
+                    stat.latencies.add(latencyMs);
+                    utils::telemetry().recordDuration("dimse.store.object_latency",
+                        std::chrono::duration_cast<std::chrono::microseconds>(latency));
+
+                    if (!associationLost)
+                    {
+                        break;
+                    }
+
+                    // The association state is unknown after a failed send; start over on a new one
+                    m_connectionPool->discard(assoc);
+                    assoc.reset();
+                }
+
+                if (abandoned)
+                {
+                    break;
+                }
+
+                if (status == DimseStatus::Success)
+                {
+                    stat.filesStored++;
+                    stat.bytesSent += item.fileSize;
+                    utils::telemetry().increment("dimse.store.objects");
+                    utils::telemetry().increment("dimse.store.bytes", item.fileSize);
+                }
+                else
+                {
+                    stat.filesFailed++;
+                    utils::telemetry().increment("dimse.store.failed");
+                }
+                complete(index, status, std::move(error));
+            }
+
+            // A file prepared ahead but never sent goes back to the queue (or fails with the
+            // connection); after a cancellation it is simply left unattempted
+            if (ahead.valid())
+            {
+                ahead.wait();
+                if (abandoned)
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    requeued.push_back(aheadIndex);
+                }
+                else if (connectionDown)
+                {
+                    stat.filesFailed++;
+                    complete(aheadIndex, DimseStatus::ConnectionFailed, "Failed to acquire connection");
+                }
+            }
+
+            if (assoc)
+            {
+                m_connectionPool->release(assoc);
+            }
+
+            stat.reconnects = std::max(0, connections - 1);
+            stat.elapsedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - workerStart).count();
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            liveWorkers--;
+            if (liveWorkers == 0 && !m_cancelRequested)
+            {
+                // Nobody is left to send requeued or unclaimed files
+                while (nextPending < pending.size())
+                {
+                    requeued.push_back(pending[nextPending++]);
+                }
+                for (size_t orphan : requeued)
+                {
+                    results[orphan] = DimseStatus::ConnectionFailed;
+                    errors[orphan] = "Failed to acquire connection";
+                }
+                requeued.clear();
+            }
+            stateChanged.notify_all();
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            workers.emplace_back(worker, i);
+        }
+
+        // Report results in file order on the calling thread, so callbacks never run concurrently
+        size_t reported = 0;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            while (true)
+            {
+                stateChanged.wait_for(lock, std::chrono::milliseconds(200), [&]() {
+                    return liveWorkers == 0 ||
+                           (reported < totalFiles && results[reported] != DimseStatus::Pending);
+                });
+
+                bool advanced = false;
+                while (reported < totalFiles && results[reported] != DimseStatus::Pending)
+                {
+                    if (results[reported] == DimseStatus::Success)
+                    {
+                        m_storedCount++;
+                    }
+                    else
+                    {
+                        m_failedCount++;
+                        m_lastError = errors[reported];
+                    }
+                    ++reported;
+                    advanced = true;
+                }
+
+                if (advanced && callback && !m_cancelRequested)
+                {
+                    const double progress = static_cast<double>(reported) / totalFiles;
+                    const std::string msg = "Stored " + std::to_string(m_storedCount) + "/" +
+                                            std::to_string(totalFiles) + " files";
+                    lock.unlock();
+                    callback(progress, msg);
+                    lock.lock();
+                }
+
+                if (liveWorkers == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        for (std::thread& thread : workers)
+        {
+            thread.join();
+        }
+
+        // Files never attempted (cancellation) are neither stored nor failed
+        for (size_t i = reported; i < totalFiles; ++i)
+        {
+            if (results[i] == DimseStatus::Success)
+            {
+                m_storedCount++;
+            }
+            else if (results[i] != DimseStatus::Pending)
+            {
+                m_failedCount++;
+                m_lastError = errors[i];
+            }
+        }
+
+        for (const StoreAssociationStats& stat : stats)
+        {
+            qCInfo(lcDimse) << "C-STORE association" << stat.associationIndex
+                            << "stored" << stat.filesStored << "failed" << stat.filesFailed
+                            << "retries" << stat.retries
+                            << "MB/s" << stat.throughputMBps()
+                            << "mean latency ms" << stat.meanLatencyMs()
+                            << "max latency ms" << stat.maxLatencyMs;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_associationStats = std::move(stats);
+        }
+
+        DimseStatus overallStatus = DimseStatus::Success;
+        if (m_cancelRequested)
+        {
+            qCInfo(lcDimse) << "C-STORE cancelled by user";
+            overallStatus = DimseStatus::Cancelled;
+        }
+        else if (m_failedCount > 0)
+        {
+            overallStatus = DimseStatus::Failure;
+        }
 
         if (m_eventManager)
         {
@@ -883,6 +1876,12 @@ namespace isis::core::network
         return overallStatus;
     }
 
+    std::vector<StoreAssociationStats> DimseStoreService::getAssociationStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        return m_associationStats;
+    }
+
     DimseStatus DimseStoreService::storeDirectory(const DicomPeer& peer,
                                                  const LocalAEConfig& localAE,
                                                  const std::string& directory,
@@ -919,69 +1918,224 @@ namespace isis::core::network
         qCInfo(lcDimse) << "Store cancellation requested";
     }
 
-    DimseStatus DimseStoreService::storeSingleFile(T_ASC_Association* assoc,
-                                                  const std::string& filepath,
-                                                  int fileIndex,
-                                                  int totalFiles,
-                                                  DimseProgressCallback callback)
+    bool DimseStoreService::readStoreHeader(const std::string& filepath, StoreItem& item, std::string& error)
     {
-        // Load DICOM file
-        DcmFileFormat fileformat;
-        OFCondition cond = fileformat.loadFile(filepath.c_str());
+        item.filepath = filepath;
 
+        // Stop before Pixel Data: only the SOP Class and encoding are needed here
+        DcmFileFormat fileformat;
+        OFCondition cond = fileformat.loadFileUntilTag(filepath.c_str(), EXS_Unknown, EGL_noChange,
+                                                       DCM_MaxReadLength, ERM_autoDetect, DCM_PixelData);
         if (cond.bad())
         {
-            m_lastError = "Failed to load DICOM file: " + filepath + " - " +
-                         std::string(cond.text());
-            qCWarning(lcDimse) << m_lastError.c_str();
-            return DimseStatus::Failure;
+            error = "Failed to load DICOM file: " + filepath + " - " + std::string(cond.text());
+            qCWarning(lcDimse) << error.c_str();
+            return false;
         }
 
         DcmDataset* dataset = fileformat.getDataset();
-        if (!dataset)
+        OFString sopClassUID;
+        if (!dataset || dataset->findAndGetOFString(DCM_SOPClassUID, sopClassUID).bad())
         {
-            m_lastError = "No dataset in file: " + filepath;
-            qCWarning(lcDimse) << m_lastError.c_str();
-            return DimseStatus::Failure;
+            error = "Missing SOP Class UID in file: " + filepath;
+            qCWarning(lcDimse) << error.c_str();
+            return false;
         }
 
-        // Get SOP Class UID and SOP Instance UID
-        OFString sopClassUID;
-        OFString sopInstanceUID;
+        item.sopClassUID = sopClassUID.c_str();
+        item.transferSyntaxUID = DcmXfer(dataset->getOriginalXfer()).getXferID();
+        item.fileSize = OFStandard::getFileSize(filepath.c_str());
+        // Pixel Data itself was not read; the image pixel module tells whether it follows
+        item.hasPixelData = dataset->tagExists(DCM_Rows) && dataset->tagExists(DCM_BitsAllocated);
+        return true;
+    }
 
-        cond = dataset->findAndGetOFString(DCM_SOPClassUID, sopClassUID);
-        if (cond.bad())
+    std::vector<PresentationContextProposal> DimseStoreService::buildStoreProposals(const std::vector<StoreItem>& items,
+                                                                                    bool compress)
+    {
+        // One context per (SOP Class, stored encoding) so objects can be sent as-is,
+        // plus one context with the uncompressed defaults per SOP Class as a fallback.
+        // With compression, each lossless syntax the batch can be transcoded to gets its
+        // own context, so the sender picks by its own preference among those accepted.
+        std::map<std::string, std::set<std::string>> syntaxesByClass;
+        std::set<std::string> compressibleClasses;
+        std::set<std::string> imageClasses;
+        for (const StoreItem& item : items)
+        {
+            syntaxesByClass[item.sopClassUID].insert(item.transferSyntaxUID);
+            if (!DcmXfer(item.transferSyntaxUID.c_str()).isEncapsulated())
+            {
+                compressibleClasses.insert(item.sopClassUID);
+                if (item.hasPixelData)
+                {
+                    imageClasses.insert(item.sopClassUID);
+                }
+            }
+        }
+
+        std::vector<PresentationContextProposal> proposals;
+        for (const auto& [sopClassUID, transferSyntaxes] : syntaxesByClass)
         {
-            m_lastError = "Missing SOP Class UID in file: " + filepath;
-            qCWarning(lcDimse) << m_lastError.c_str();
-            return DimseStatus::Failure;
+            std::set<std::string> proposed;
+            for (const std::string& transferSyntax : transferSyntaxes)
+            {
+                if (DcmXfer(transferSyntax.c_str()).isEncapsulated() ||
+                    transferSyntax == UID_DeflatedExplicitVRLittleEndianTransferSyntax)
+                {
+                    proposals.emplace_back(sopClassUID, std::vector<std::string>{transferSyntax});
+                    proposed.insert(transferSyntax);
+                }
+            }
+            if (compress && compressibleClasses.count(sopClassUID) > 0)
+            {
+                for (const char* transferSyntax : compressedStoreSyntaxes)
+                {
+                    const bool imageOnly = DcmXfer(transferSyntax).isEncapsulated();
+                    if (proposed.count(transferSyntax) == 0 && (!imageOnly || imageClasses.count(sopClassUID) > 0))
+                    {
+                        proposals.emplace_back(sopClassUID, std::vector<std::string>{transferSyntax});
+                    }
+                }
+            }
+            proposals.emplace_back(sopClassUID);
+        }
+
+        if (proposals.size() > 128)
+        {
+            qCWarning(lcDimse) << "C-STORE batch needs" << proposals.size()
+                               << "presentation contexts, only 128 can be proposed";
         }
 
-        cond = dataset->findAndGetOFString(DCM_SOPInstanceUID, sopInstanceUID);
+        return proposals;
+    }
+
+    std::string DimseStoreService::chooseStoreSyntax(T_ASC_Association* assoc, const StoreItem& item, bool compress)
+    {
+        // Compressed objects are always sent as stored; they are never recompressed
+        if (!compress || DcmXfer(item.transferSyntaxUID.c_str()).isEncapsulated() ||
+            item.transferSyntaxUID == UID_DeflatedExplicitVRLittleEndianTransferSyntax)
+        {
+            return item.transferSyntaxUID;
+        }
+
+        for (const char* transferSyntax : compressedStoreSyntaxes)
+        {
+            if (DcmXfer(transferSyntax).isEncapsulated() && !item.hasPixelData)
+            {
+                continue;
+            }
+            if (ASC_findAcceptedPresentationContextID(assoc, item.sopClassUID.c_str(), transferSyntax) != 0)
+            {
+                return transferSyntax;
+            }
+        }
+        return item.transferSyntaxUID;
+    }
+
+    DimseStoreService::PreparedStore DimseStoreService::prepareStoreItem(const StoreItem& item,
+                                                                        const std::string& transferSyntaxUID)
+    {
+        PreparedStore prepared;
+        prepared.transferSyntaxUID = item.transferSyntaxUID;
+
+        auto fileformat = std::make_unique<DcmFileFormat>();
+        OFCondition cond = fileformat->loadFile(item.filepath.c_str());
         if (cond.bad())
         {
-            m_lastError = "Missing SOP Instance UID in file: " + filepath;
-            qCWarning(lcDimse) << m_lastError.c_str();
+            prepared.error = "Failed to load DICOM file: " + item.filepath + " - " +
+                             std::string(cond.text());
+            qCWarning(lcDimse) << prepared.error.c_str();
+            return prepared;
+        }
+
+        DcmDataset* dataset = fileformat->getDataset();
+        OFString sopInstanceUID;
+        if (!dataset || dataset->findAndGetOFString(DCM_SOPInstanceUID, sopInstanceUID).bad())
+        {
+            prepared.error = "Missing SOP Instance UID in file: " + item.filepath;
+            qCWarning(lcDimse) << prepared.error.c_str();
+            return prepared;
+        }
+        prepared.sopInstanceUID = sopInstanceUID.c_str();
+
+        if (transferSyntaxUID != item.transferSyntaxUID)
+        {
+            // Encoding keeps the original pixel representation alongside the compressed
+            // one, so the object can still go out uncompressed if the context is lost
+            const E_TransferSyntax target = DcmXfer(transferSyntaxUID.c_str()).getXfer();
+            const auto start = std::chrono::steady_clock::now();
+            cond = dataset->chooseRepresentation(target, nullptr);
+            if (cond.good() && dataset->canWriteXfer(target))
+            {
+                prepared.transferSyntaxUID = transferSyntaxUID;
+                utils::telemetry().increment("dimse.store.transcoded");
+                utils::telemetry().recordDuration("dimse.store.transcode",
+                    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+            }
+            else
+            {
+                qCInfo(lcDimse) << "Sending" << item.filepath.c_str() << "uncompressed, cannot encode it as"
+                                << transferSyntaxUID.c_str() << ":" << cond.text();
+            }
+        }
+
+        prepared.file = std::move(fileformat);
+        return prepared;
+    }
+
+    DimseStatus DimseStoreService::storeSingleFile(T_ASC_Association* assoc,
+                                                  const StoreItem& item,
+                                                  PreparedStore& prepared,
+                                                  std::string& error,
+                                                  bool& associationLost)
+    {
+        associationLost = false;
+        const std::string& filepath = item.filepath;
+
+        if (!prepared.file)
+        {
+            error = prepared.error;
             return DimseStatus::Failure;
         }
+        DcmDataset* dataset = prepared.file->getDataset();
 
-        // Find accepted presentation context
+        // Prefer the context matching the prepared encoding. Uncompressed data (including
+        // the original representation kept by a transcoded object) may fall back to any
+        // uncompressed context since DCMTK re-encodes it losslessly.
         T_ASC_PresentationContextID presID = ASC_findAcceptedPresentationContextID(
-            assoc, sopClassUID.c_str());
+            assoc, item.sopClassUID.c_str(), prepared.transferSyntaxUID.c_str());
+
+        if (presID == 0 && !DcmXfer(item.transferSyntaxUID.c_str()).isEncapsulated())
+        {
+            for (const char* transferSyntax : { UID_LittleEndianExplicitTransferSyntax,
+                                                UID_LittleEndianImplicitTransferSyntax,
+                                                UID_BigEndianExplicitTransferSyntax })
+            {
+                presID = ASC_findAcceptedPresentationContextID(assoc, item.sopClassUID.c_str(), transferSyntax);
+                if (presID != 0)
+                {
+                    break;
+                }
+            }
+        }
 
         if (presID == 0)
         {
-            m_lastError = "No presentation context for SOP Class: " + std::string(sopClassUID.c_str());
-            qCWarning(lcDimse) << m_lastError.c_str();
+            error = "No presentation context for SOP Class: " + item.sopClassUID +
+                    " with transfer syntax " + prepared.transferSyntaxUID;
+            qCWarning(lcDimse) << error.c_str();
             return DimseStatus::Failure;
         }
 
+        OFCondition cond;
+        const std::string& sopInstanceUID = prepared.sopInstanceUID;
+
         // Send C-STORE request
         T_DIMSE_C_StoreRQ req;
         memset(&req, 0, sizeof(req));
         req.MessageID = assoc->nextMsgID++;
-        strcpy(req.AffectedSOPClassUID, sopClassUID.c_str());
-        strcpy(req.AffectedSOPInstanceUID, sopInstanceUID.c_str());
+        OFStandard::strlcpy(req.AffectedSOPClassUID, item.sopClassUID.c_str(), sizeof(req.AffectedSOPClassUID));
+        OFStandard::strlcpy(req.AffectedSOPInstanceUID, sopInstanceUID.c_str(), sizeof(req.AffectedSOPInstanceUID));
         req.DataSetType = DIMSE_DATASET_PRESENT;
         req.Priority = DIMSE_PRIORITY_MEDIUM;
 
@@ -999,23 +2153,21 @@ namespace isis::core::network
 
         if (cond.bad())
         {
-            m_lastError = "C-STORE failed for file: " + filepath + " - " +
-                         std::string(cond.text());
-            qCWarning(lcDimse) << m_lastError.c_str();
-            return DimseStatus::Failure;
+            error = "C-STORE failed for file: " + filepath + " - " +
+                    std::string(cond.text());
+            qCWarning(lcDimse) << error.c_str();
+            associationLost = true;
+            return conditionToStatus(cond);
         }
 
         if (rsp.DimseStatus != STATUS_Success)
         {
-            m_lastError = "C-STORE returned non-success status: " +
-                         std::to_string(rsp.DimseStatus) + " for file: " + filepath;
-            qCWarning(lcDimse) << m_lastError.c_str();
+            error = "C-STORE returned non-success status: " +
+                    std::to_string(rsp.DimseStatus) + " for file: " + filepath;
+            qCWarning(lcDimse) << error.c_str();
             return DimseStatus::Failure;
         }
 
-        qCInfo(lcDimse) << "Successfully stored file" << (fileIndex + 1) << "of"
-                       << totalFiles << ":" << filepath.c_str();
-
         return DimseStatus::Success;
     }
 
@@ -21,6 +21,11 @@
 #include <functional>
 #include <future>
 #include <atomic>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
 #include <QFuture>
 #include <dcmtk/dcmdata/dcdatset.h>
 #include <dcmtk/dcmnet/dimse.h>
@@ -28,6 +33,7 @@
 #include "../events/callbackmanager.h"
 #include "dimseconfig.h"
 #include "dimseassociation.h"
+#include "dimsestoragescp.h"
 
 namespace isis::core::network
 {
@@ -81,18 +87,153 @@ namespace isis::core::network
         std::string seriesNumber;
         std::string seriesDescription;
         std::string modality;
+        std::string bodyPartExamined;       // Optional return key; empty if the SCP does not support it
         int numberOfInstances = 0;
 
         RemoteSeriesInfo() = default;
     };
 
+    /**
+     * @brief Instance information from an IMAGE level C-FIND response
+     */
+    struct RemoteInstanceInfo
+    {
+        std::string sopInstanceUID;
+        std::string sopClassUID;
+        std::string seriesInstanceUID;
+        std::string studyInstanceUID;
+        std::string instanceNumber;
+        int rows = 0;
+        int columns = 0;
+        int numberOfFrames = 0;
+
+        RemoteInstanceInfo() = default;
+    };
+
+    /**
+     * @brief Objects selected for a C-MOVE/C-GET
+     *
+     * The retrieve level follows from the fields set: STUDY when only the study
+     * UID is given, SERIES when a series UID is added, IMAGE when SOP instance
+     * UIDs are listed (all from the same series).
+     */
+    struct RetrieveTarget
+    {
+        std::string studyInstanceUID;
+        std::string seriesInstanceUID;
+        std::vector<std::string> sopInstanceUIDs;
+
+        RetrieveTarget() = default;
+        explicit RetrieveTarget(std::string studyUID)
+            : studyInstanceUID(std::move(studyUID)) {}
+
+        const char* level() const
+        {
+            if (!sopInstanceUIDs.empty()) return "IMAGE";
+            if (!seriesInstanceUID.empty()) return "SERIES";
+            return "STUDY";
+        }
+    };
+
+    /**
+     * @brief Fixed-size histogram of C-STORE round trips
+     *
+     * Bucket bounds grow by a quarter from 0.1 ms up to about two minutes, so a
+     * percentile is reported within 25% of the measured value however long the batch.
+     */
+    struct LatencyHistogram
+    {
+        static constexpr std::size_t BucketCount = 64;
+        static constexpr double FirstBoundMs = 0.1;
+        static constexpr double Growth = 1.25;
+
+        std::array<std::uint64_t, BucketCount> counts{};
+
+        static double upperBoundMs(std::size_t bucket)
+        {
+            return FirstBoundMs * std::pow(Growth, static_cast<double>(bucket));
+        }
+
+        void add(double latencyMs)
+        {
+            std::size_t bucket = 0;
+            if (latencyMs > FirstBoundMs)
+            {
+                const double steps = std::ceil(std::log(latencyMs / FirstBoundMs) / std::log(Growth));
+                bucket = static_cast<std::size_t>(std::min(steps, static_cast<double>(BucketCount - 1)));
+            }
+            counts[bucket]++;
+        }
+
+        void merge(const LatencyHistogram& other)
+        {
+            for (std::size_t i = 0; i < BucketCount; ++i)
+                counts[i] += other.counts[i];
+        }
+
+        std::uint64_t total() const
+        {
+            std::uint64_t sum = 0;
+            for (const auto count : counts)
+                sum += count;
+            return sum;
+        }
+
+        /**
+         * @brief Upper bound of the bucket holding the given fraction of samples, 0 when empty
+         */
+        double percentile(double fraction) const
+        {
+            const std::uint64_t samples = total();
+            if (samples == 0)
+                return 0.0;
+            const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(fraction * samples)));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < BucketCount; ++i)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                    return upperBoundMs(i);
+            }
+            return upperBoundMs(BucketCount - 1);
+        }
+    };
+
+    /**
+     * @brief Per-association statistics of a multi-association C-STORE batch
+     */
+    struct StoreAssociationStats
+    {
+        int associationIndex = 0;
+        int filesStored = 0;
+        int filesFailed = 0;
+        int retries = 0;                    // Files resent after the association was re-established
+        int reconnects = 0;
+        std::uint64_t bytesSent = 0;
+        double elapsedMs = 0.0;             // Wall time the association was busy
+        double totalLatencyMs = 0.0;        // Sum of per-object C-STORE round trips
+        double maxLatencyMs = 0.0;
+        LatencyHistogram latencies;         // Each C-STORE request to its response
+
+        double meanLatencyMs() const
+        {
+            const int count = filesStored + filesFailed;
+            return count > 0 ? totalLatencyMs / count : 0.0;
+        }
+
+        double throughputMBps() const
+        {
+            return elapsedMs > 0.0 ? (bytesSent / (1024.0 * 1024.0)) / (elapsedMs / 1000.0) : 0.0;
+        }
+    };
+
     /**
      * @brief Progress callback for DIMSE operations
      */
     using DimseProgressCallback = std::function<void(double progress, const std::string& message)>;
 
     /**
-     * @brief Query result callback
+     * @brief Query result callback, invoked on the query thread for every match as it arrives
      */
     using QueryResultCallback = std::function<void(const RemoteStudyInfo& study)>;
 
@@ -157,13 +298,22 @@ namespace isis::core::network
                                 QueryResultCallback callback = nullptr);
 
         /**
-         * @brief Query series for a study
+         * @brief Query series of a study (Study Root, SERIES level)
          */
         DimseStatus querySeries(const DicomPeer& peer,
                                const LocalAEConfig& localAE,
                                const std::string& studyInstanceUID,
                                std::vector<RemoteSeriesInfo>& results);
 
+        /**
+         * @brief Query instances of a series (Study Root, IMAGE level)
+         */
+        DimseStatus queryInstances(const DicomPeer& peer,
+                                  const LocalAEConfig& localAE,
+                                  const std::string& studyInstanceUID,
+                                  const std::string& seriesInstanceUID,
+                                  std::vector<RemoteInstanceInfo>& results);
+
         /**
          * @brief Perform asynchronous query
          */
@@ -174,7 +324,7 @@ namespace isis::core::network
             QueryResultCallback callback = nullptr);
 
         /**
-         * @brief Cancel ongoing query
+         * @brief Cancel ongoing query (a C-CANCEL is sent with the next pending response)
          */
         void cancelQuery();
 
@@ -189,17 +339,36 @@ namespace isis::core::network
         std::string m_lastError;
         std::atomic<bool> m_cancelRequested{false};
 
+        using FindMatchHandler = std::function<void(DcmDataset* identifiers)>;
+
         // Helper methods
         DcmDataset* buildQueryDataset(const QueryFilter& filter);
+        DcmDataset* buildSeriesQueryDataset(const std::string& studyInstanceUID);
+        DcmDataset* buildInstanceQueryDataset(const std::string& studyInstanceUID,
+                                              const std::string& seriesInstanceUID);
         RemoteStudyInfo parseStudyResponse(DcmDataset* dataset);
         RemoteSeriesInfo parseSeriesResponse(DcmDataset* dataset);
+        RemoteInstanceInfo parseInstanceResponse(DcmDataset* dataset);
+
+        /**
+         * @brief Run one Study Root C-FIND, handing every pending match to onMatch
+         * @param maxResults Matches after which a C-CANCEL is sent (0 = no limit)
+         */
+        DimseStatus executeFind(const DicomPeer& peer,
+                                const LocalAEConfig& localAE,
+                                DcmDataset* query,
+                                int maxResults,
+                                const FindMatchHandler& onMatch);
 
         struct FindCallbackContext
         {
             DimseQueryService* service = nullptr;
-            QueryResultCallback callback;
-            std::vector<RemoteStudyInfo>* results = nullptr;
+            FindMatchHandler onMatch;
+            std::size_t matchCount = 0;
             int maxResults = 0;
+            T_ASC_Association* association = nullptr;
+            T_ASC_PresentationContextID presID = 0;
+            bool cancelSent = false;
         };
 
         static void findResponseHandler(void* callbackData,
@@ -242,6 +411,54 @@ namespace isis::core::network
                                     const std::string& studyInstanceUID,
                                     DimseProgressCallback callback = nullptr);
 
+        /**
+         * @brief Retrieve a study, a single series or a set of instances using C-GET
+         *
+         * The C-STORE sub-operations arrive on the same association (storage contexts are
+         * proposed with the SCP role) and are streamed bit-preserved into
+         * localAE.tempStoragePath. No inbound connection to the Storage SCP is needed.
+         */
+        DimseStatus retrieveGet(const DicomPeer& peer,
+                               const LocalAEConfig& localAE,
+                               const RetrieveTarget& target,
+                               DimseProgressCallback callback = nullptr);
+
+        /**
+         * @brief Retrieve a study, a single series or a set of instances using C-MOVE
+         */
+        DimseStatus retrieveMove(const DicomPeer& peer,
+                                const LocalAEConfig& localAE,
+                                const RetrieveTarget& target,
+                                const std::string& destinationAE,
+                                DimseProgressCallback callback = nullptr);
+
+        /**
+         * @brief Retrieve a single series (auto-select C-MOVE or C-GET)
+         */
+        DimseStatus retrieveSeries(const DicomPeer& peer,
+                                  const LocalAEConfig& localAE,
+                                  const std::string& studyInstanceUID,
+                                  const std::string& seriesInstanceUID,
+                                  DimseProgressCallback callback = nullptr);
+
+        /**
+         * @brief Retrieve selected instances of one series (auto-select C-MOVE or C-GET)
+         */
+        DimseStatus retrieveInstances(const DicomPeer& peer,
+                                     const LocalAEConfig& localAE,
+                                     const std::string& studyInstanceUID,
+                                     const std::string& seriesInstanceUID,
+                                     const std::vector<std::string>& sopInstanceUIDs,
+                                     DimseProgressCallback callback = nullptr);
+
+        /**
+         * @brief Retrieve any target (auto-select C-MOVE or C-GET)
+         */
+        DimseStatus retrieve(const DicomPeer& peer,
+                            const LocalAEConfig& localAE,
+                            const RetrieveTarget& target,
+                            DimseProgressCallback callback = nullptr);
+
         /**
          * @brief Retrieve study (auto-select C-MOVE or C-GET)
          */
@@ -263,6 +480,37 @@ namespace isis::core::network
          */
         void cancelRetrieve();
 
+        /**
+         * @brief Callback for every object received through C-GET sub-operations
+         */
+        void setStorageReceivedCallback(StorageReceivedCallback callback);
+
+        /**
+         * @brief Callback for C-GET objects whose header was parsed, called instead of the
+         *        storage callback (which remains the fallback if parsing fails)
+         */
+        void setInstanceReceivedCallback(InstanceReceivedCallback callback);
+
+        /**
+         * @brief Commit C-GET objects to the Storage SCP's hierarchical store (null stores flat)
+         */
+        void setStorageIndex(std::shared_ptr<DimseStorageIndex> index);
+
+        /**
+         * @brief DIMSE priority carried by subsequent C-MOVE/C-GET requests (default MEDIUM)
+         */
+        void setRequestPriority(T_DIMSE_Priority priority);
+
+        /**
+         * @brief Number of objects stored by the last C-GET
+         */
+        int getReceivedCount() const { return m_receivedCount; }
+
+        /**
+         * @brief Bytes stored by the last C-GET
+         */
+        std::uint64_t getReceivedBytes() const { return m_receivedBytes; }
+
         /**
          * @brief Get last error message
          */
@@ -273,13 +521,25 @@ namespace isis::core::network
         std::shared_ptr<events::CallbackManager> m_eventManager;
         std::string m_lastError;
         std::atomic<bool> m_cancelRequested{false};
+        std::atomic<int> m_receivedCount{0};
+        std::atomic<std::uint64_t> m_receivedBytes{0};
+        StorageReceivedCallback m_storageCallback;
+        InstanceReceivedCallback m_instanceCallback;
+        std::shared_ptr<DimseStorageIndex> m_storageIndex;
+        T_DIMSE_Priority m_requestPriority = DIMSE_PRIORITY_MEDIUM;
 
         // Helper methods
-        DcmDataset* buildRetrieveDataset(const std::string& studyInstanceUID);
+        DcmDataset* buildRetrieveDataset(const RetrieveTarget& target);
+        bool validateTarget(const RetrieveTarget& target, const char* operation);
+        static std::string describeTarget(const RetrieveTarget& target);
+        static std::vector<PresentationContextProposal> buildGetProposals();
         struct MoveCallbackContext
         {
             DimseRetrieveService* service = nullptr;
             DimseProgressCallback progressCallback;
+            T_ASC_Association* association = nullptr;
+            T_ASC_PresentationContextID presID = 0;
+            bool cancelSent = false;
         };
         static void moveResponseHandler(void* callbackData,
                                         T_DIMSE_C_MoveRQ* request,
@@ -366,6 +626,23 @@ namespace isis::core::network
          */
         int getFailedCount() const { return m_failedCount; }
 
+        /**
+         * @brief Set the number of parallel associations used by storeFiles (clamped to the pool size)
+         */
+        void setMaxAssociations(int count) { m_maxAssociations = std::max(1, count); }
+        int getMaxAssociations() const { return m_maxAssociations; }
+
+        /**
+         * @brief Set how many times a file is resent after its association was lost
+         */
+        void setMaxRetries(int retries) { m_maxRetries = std::max(0, retries); }
+        int getMaxRetries() const { return m_maxRetries; }
+
+        /**
+         * @brief Per-association statistics of the last storeFiles call
+         */
+        std::vector<StoreAssociationStats> getAssociationStats() const;
+
     private:
         std::shared_ptr<DimseConnectionPool> m_connectionPool;
         std::shared_ptr<events::CallbackManager> m_eventManager;
@@ -373,13 +650,39 @@ namespace isis::core::network
         std::atomic<bool> m_cancelRequested{false};
         int m_storedCount{0};
         int m_failedCount{0};
+        int m_maxAssociations{4};
+        int m_maxRetries{1};
+        std::vector<StoreAssociationStats> m_associationStats;
+        mutable std::mutex m_statsMutex;
+
+        /**
+         * @brief Header fields needed to negotiate and send one file
+         */
+        struct StoreItem
+        {
+            std::string filepath;
+            std::string sopClassUID;
+            std::string transferSyntaxUID;
+            std::uint64_t fileSize = 0;
+            bool hasPixelData = false;
+        };
+
+        /**
+         * @brief A file loaded (and possibly transcoded) for sending
+         */
+        struct PreparedStore;
 
         // Helper methods
+        bool readStoreHeader(const std::string& filepath, StoreItem& item, std::string& error);
+        std::vector<PresentationContextProposal> buildStoreProposals(const std::vector<StoreItem>& items,
+                                                                     bool compress);
+        static std::string chooseStoreSyntax(T_ASC_Association* assoc, const StoreItem& item, bool compress);
+        static PreparedStore prepareStoreItem(const StoreItem& item, const std::string& transferSyntaxUID);
         DimseStatus storeSingleFile(T_ASC_Association* assoc,
-                                   const std::string& filepath,
-                                   int fileIndex,
-                                   int totalFiles,
-                                   DimseProgressCallback callback);
+                                   const StoreItem& item,
+                                   PreparedStore& prepared,
+                                   std::string& error,
+                                   bool& associationLost);
         std::vector<std::string> findDicomFiles(const std::string& directory, bool recursive);
         bool isDicomFile(const std::string& filepath);
     };
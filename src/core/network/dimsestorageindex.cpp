@@ -0,0 +1,649 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimsestorageindex.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the hierarchical SCP store and its arrival index.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dimsestorageindex.h"
+#include "../utils/structuredlog.h"
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+
+Q_DECLARE_LOGGING_CATEGORY(lcDimse)
+
+namespace isis::core::network
+{
+    namespace
+    {
+        namespace fs = std::filesystem;
+
+        constexpr const char* JournalFileName = "storage-index.tsv";
+        constexpr const char* JournalHeader = "# isis storage index v1";
+        constexpr std::size_t JournalFieldCount = 10;
+
+        // UIDs only contain digits and dots; anything else must not reach the file system
+        std::string pathComponent(const std::string& uid)
+        {
+            std::string safe = uid;
+            std::replace_if(safe.begin(), safe.end(),
+                            [](char c) { return !(std::isdigit(static_cast<unsigned char>(c)) || c == '.'); },
+                            '_');
+            return safe.empty() ? std::string("unknown") : safe;
+        }
+
+        // FNV-1a, so the folder of a patient does not depend on the platform's std::hash
+        std::string patientKeyFor(const std::string& patientID)
+        {
+            std::uint64_t hash = 0xcbf29ce484222325ULL;
+            for (const unsigned char c : patientID)
+            {
+                hash ^= c;
+                hash *= 0x100000001b3ULL;
+            }
+            char buffer[17];
+            std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+            return buffer;
+        }
+
+        // Tabs and line breaks would split a journal line
+        std::string journalField(const std::string& value)
+        {
+            std::string field = value;
+            std::replace_if(field.begin(), field.end(),
+                            [](char c) { return c == '\t' || c == '\n' || c == '\r'; },
+                            ' ');
+            return field;
+        }
+
+        std::string serialize(const StorageIndexRecord& record)
+        {
+            const auto arrivalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                record.arrival.time_since_epoch()).count();
+
+            std::string line;
+            line.reserve(256);
+            line += std::to_string(arrivalMs);
+            for (const std::string* field : {&record.sopInstanceUID, &record.sopClassUID,
+                                             &record.patientKey, &record.studyInstanceUID,
+                                             &record.seriesInstanceUID, &record.relativePath})
+            {
+                line += '\t';
+                line += journalField(*field);
+            }
+            line += '\t';
+            line += std::to_string(record.size);
+            line += '\t';
+            line += journalField(record.transferSyntaxUID);
+            line += '\t';
+            line += journalField(record.callingAE);
+            line += '\n';
+            return line;
+        }
+
+        bool parse(const std::string& line, StorageIndexRecord& record)
+        {
+            std::vector<std::string> fields;
+            std::size_t start = 0;
+            while (true)
+            {
+                const auto tab = line.find('\t', start);
+                fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+                if (tab == std::string::npos)
+                    break;
+                start = tab + 1;
+            }
+            if (fields.size() != JournalFieldCount || fields[1].empty() || fields[6].empty())
+                return false;
+
+            try
+            {
+                record.arrival = std::chrono::system_clock::time_point(
+                    std::chrono::milliseconds(std::stoll(fields[0])));
+                record.size = std::stoull(fields[7]);
+            }
+            catch (...)
+            {
+                return false;
+            }
+            record.sopInstanceUID = fields[1];
+            record.sopClassUID = fields[2];
+            record.patientKey = fields[3];
+            record.studyInstanceUID = fields[4];
+            record.seriesInstanceUID = fields[5];
+            record.relativePath = fields[6];
+            record.transferSyntaxUID = fields[8];
+            record.callingAE = fields[9];
+            return true;
+        }
+    }
+
+    DimseStorageIndex::DimseStorageIndex(std::string rootDirectory, DuplicateSopPolicy duplicatePolicy)
+        : m_rootDirectory(std::move(rootDirectory))
+        , m_journalPath((fs::u8path(m_rootDirectory) / JournalFileName).u8string())
+        , m_duplicatePolicy(duplicatePolicy)
+    {
+    }
+
+    DimseStorageIndex::~DimseStorageIndex()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_journal.is_open())
+        {
+            m_journal.close();
+        }
+    }
+
+    bool DimseStorageIndex::open()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::error_code ec;
+        fs::create_directories(fs::u8path(m_rootDirectory), ec);
+
+        m_records.clear();
+        m_studyInstances.clear();
+        m_seriesInstances.clear();
+        m_totalBytes = 0;
+        if (m_journal.is_open())
+        {
+            m_journal.close();
+        }
+
+        // Replay: a later line for the same instance supersedes the earlier one
+        std::size_t lines = 0;
+        bool torn = false;
+        {
+            std::ifstream input(fs::u8path(m_journalPath), std::ios::binary);
+            std::stringstream content;
+            content << input.rdbuf();
+            const std::string text = content.str();
+
+            std::size_t start = 0;
+            while (start < text.size())
+            {
+                const auto end = text.find('\n', start);
+                if (end == std::string::npos)
+                {
+                    // Last append was interrupted; the object it described is not indexed
+                    torn = true;
+                    break;
+                }
+                const std::string line = text.substr(start, end - start);
+                start = end + 1;
+
+                StorageIndexRecord record;
+                if (line.empty() || line.front() == '#' || !parse(line, record))
+                    continue;
+                eraseRecord(record.sopInstanceUID);
+                insertRecord(record);
+                ++lines;
+            }
+        }
+
+        // A torn line would otherwise be glued to the next append
+        if (torn || lines > 2 * m_records.size() + 1024)
+        {
+            if (!rewriteJournal())
+                return false;
+        }
+        else
+        {
+            const bool exists = fs::exists(fs::u8path(m_journalPath), ec);
+            m_journal.open(fs::u8path(m_journalPath), std::ios::binary | std::ios::app);
+            if (m_journal && !exists)
+            {
+                m_journal << JournalHeader << '\n';
+                m_journal.flush();
+            }
+        }
+
+        if (!m_journal)
+        {
+            qCWarning(lcDimse) << "Cannot open storage index:" << m_journalPath.c_str();
+            return false;
+        }
+
+        qCInfo(lcDimse) << "Storage index opened with" << m_records.size() << "instances";
+        return true;
+    }
+
+    std::string DimseStorageIndex::relativePathFor(const std::string& patientID,
+                                                   const std::string& studyInstanceUID,
+                                                   const std::string& seriesInstanceUID,
+                                                   const std::string& sopInstanceUID)
+    {
+        const std::string patientKey = patientKeyFor(patientID);
+        return patientKey.substr(0, 2) + "/" + patientKey + "/" +
+               pathComponent(studyInstanceUID) + "/" +
+               pathComponent(seriesInstanceUID) + "/" +
+               pathComponent(sopInstanceUID) + ".dcm";
+    }
+
+    StorageCommitResult DimseStorageIndex::commit(const std::string& receivedPath,
+                                                  const DicomInstanceHeader& header,
+                                                  const std::string& callingAE,
+                                                  StorageIndexRecord& record)
+    {
+        std::error_code ec;
+        const std::string sopInstanceUID = header.getValue(0x0008, 0x0018);
+        if (sopInstanceUID.empty())
+        {
+            fs::remove(fs::u8path(receivedPath), ec);
+            return StorageCommitResult::Failed;
+        }
+
+        const std::string patientID = header.getValue(0x0010, 0x0020);
+        StorageIndexRecord stored;
+        stored.sopInstanceUID = sopInstanceUID;
+        stored.sopClassUID = header.getValue(0x0008, 0x0016);
+        stored.patientKey = patientKeyFor(patientID);
+        stored.studyInstanceUID = header.getValue(0x0020, 0x000D);
+        stored.seriesInstanceUID = header.getValue(0x0020, 0x000E);
+        stored.relativePath = relativePathFor(patientID, stored.studyInstanceUID,
+                                              stored.seriesInstanceUID, sopInstanceUID);
+        stored.transferSyntaxUID = header.getValue(0x0002, 0x0010);
+        stored.callingAE = callingAE;
+
+        const fs::path finalPath = fs::u8path(m_rootDirectory) / fs::u8path(stored.relativePath);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto existing = m_records.find(sopInstanceUID);
+        const bool duplicate = existing != m_records.end() &&
+                               fs::is_regular_file(fs::u8path(absolutePath(existing->second)), ec);
+        if (duplicate && m_duplicatePolicy == DuplicateSopPolicy::KeepExisting)
+        {
+            fs::remove(fs::u8path(receivedPath), ec);
+            record = existing->second;
+            utils::telemetry().increment("dimse.scp.duplicates_discarded");
+            return StorageCommitResult::DuplicateDiscarded;
+        }
+
+        {
+            // A purge may still be deleting this path or its now empty folders
+            std::lock_guard<std::mutex> fileLock(m_fileMutex);
+            fs::create_directories(finalPath.parent_path(), ec);
+            fs::rename(fs::u8path(receivedPath), finalPath, ec);
+            if (ec)
+            {
+                qCWarning(lcDimse) << "Failed to file received object:" << ec.message().c_str();
+                fs::remove(fs::u8path(receivedPath), ec);
+                return StorageCommitResult::Failed;
+            }
+            m_pendingRemovals.erase(stored.relativePath);
+        }
+
+        // Same instance under another patient/study/series: drop the stale copy
+        if (existing != m_records.end() && existing->second.relativePath != stored.relativePath)
+        {
+            const std::string stalePath = existing->second.relativePath;
+            fs::remove(fs::u8path(absolutePath(existing->second)), ec);
+            removeEmptyParents(stalePath);
+        }
+
+        const auto size = fs::file_size(finalPath, ec);
+        stored.size = ec ? 0 : static_cast<std::uint64_t>(size);
+        stored.arrival = std::chrono::system_clock::now();
+
+        if (!appendToJournal(stored))
+        {
+            qCWarning(lcDimse) << "Failed to append to storage index:" << m_journalPath.c_str();
+        }
+        eraseRecord(sopInstanceUID);
+        insertRecord(stored);
+        record = stored;
+
+        if (duplicate)
+        {
+            utils::telemetry().increment("dimse.scp.duplicates_replaced");
+            return StorageCommitResult::Replaced;
+        }
+        return StorageCommitResult::Stored;
+    }
+
+    bool DimseStorageIndex::find(const std::string& sopInstanceUID, StorageIndexRecord& record) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_records.find(sopInstanceUID);
+        if (it == m_records.end())
+            return false;
+        record = it->second;
+        return true;
+    }
+
+    bool DimseStorageIndex::contains(const std::string& sopInstanceUID) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_records.count(sopInstanceUID) != 0;
+    }
+
+    std::vector<StorageIndexRecord> DimseStorageIndex::getStudyRecords(const std::string& studyInstanceUID) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_studyInstances.find(studyInstanceUID);
+        return it == m_studyInstances.end() ? std::vector<StorageIndexRecord>() : collect(it->second);
+    }
+
+    std::vector<StorageIndexRecord> DimseStorageIndex::getSeriesRecords(const std::string& seriesInstanceUID) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_seriesInstances.find(seriesInstanceUID);
+        return it == m_seriesInstances.end() ? std::vector<StorageIndexRecord>() : collect(it->second);
+    }
+
+    std::string DimseStorageIndex::absolutePath(const StorageIndexRecord& record) const
+    {
+        return (fs::u8path(m_rootDirectory) / fs::u8path(record.relativePath)).u8string();
+    }
+
+    std::size_t DimseStorageIndex::purgeOlderThan(std::chrono::system_clock::time_point cutoff)
+    {
+        std::lock_guard<std::mutex> purgeLock(m_purgeMutex);
+
+        std::vector<StorageIndexRecord> removed;
+        std::vector<StorageIndexRecord> remaining;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            std::vector<std::string> expired;
+            for (const auto& [uid, record] : m_records)
+            {
+                if (record.arrival < cutoff)
+                    expired.push_back(uid);
+            }
+            if (expired.empty())
+                return 0;
+
+            detachRecords(expired, removed, remaining);
+        }
+
+        finishPurge(removed, std::move(remaining));
+
+        utils::telemetry().increment("dimse.scp.objects_purged", removed.size());
+        qCInfo(lcDimse) << "Purged" << removed.size() << "received objects past retention";
+        return removed.size();
+    }
+
+    void DimseStorageIndex::touchStudy(const std::string& studyInstanceUID)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_studyLastUsed[studyInstanceUID] = std::chrono::system_clock::now();
+    }
+
+    std::size_t DimseStorageIndex::purgeLeastRecentlyUsed(std::uint64_t maxBytes,
+                                                          const std::set<std::string>& keepStudies)
+    {
+        std::lock_guard<std::mutex> purgeLock(m_purgeMutex);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_totalBytes <= maxBytes)
+            return 0;
+
+        // A study was last used when it was opened or when its latest object arrived
+        std::vector<std::pair<std::chrono::system_clock::time_point, std::string>> studies;
+        studies.reserve(m_studyInstances.size());
+        for (const auto& [studyUID, instances] : m_studyInstances)
+        {
+            if (keepStudies.count(studyUID) > 0)
+                continue;
+
+            auto lastUsed = std::chrono::system_clock::time_point::min();
+            for (const auto& uid : instances)
+                lastUsed = std::max(lastUsed, m_records[uid].arrival);
+            const auto touched = m_studyLastUsed.find(studyUID);
+            if (touched != m_studyLastUsed.end())
+                lastUsed = std::max(lastUsed, touched->second);
+            studies.emplace_back(lastUsed, studyUID);
+        }
+        std::sort(studies.begin(), studies.end());
+
+        std::vector<std::string> evicted;
+        std::uint64_t remaining = m_totalBytes;
+        std::size_t studiesEvicted = 0;
+        for (const auto& [lastUsed, studyUID] : studies)
+        {
+            if (remaining <= maxBytes)
+                break;
+            for (const auto& uid : m_studyInstances[studyUID])
+            {
+                evicted.push_back(uid);
+                remaining -= std::min(remaining, m_records[uid].size);
+            }
+            m_studyLastUsed.erase(studyUID);
+            ++studiesEvicted;
+        }
+        if (evicted.empty())
+            return 0;
+
+        std::vector<StorageIndexRecord> removed;
+        std::vector<StorageIndexRecord> kept;
+        detachRecords(evicted, removed, kept);
+        lock.unlock();
+
+        finishPurge(removed, std::move(kept));
+
+        utils::telemetry().increment("dimse.scp.objects_evicted", removed.size());
+        qCInfo(lcDimse) << "Evicted" << studiesEvicted << "least recently used studies ("
+                        << removed.size() << "objects ) to stay within" << maxBytes << "bytes";
+        return removed.size();
+    }
+
+    std::size_t DimseStorageIndex::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_records.size();
+    }
+
+    std::uint64_t DimseStorageIndex::totalBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_totalBytes;
+    }
+
+    void DimseStorageIndex::detachRecords(const std::vector<std::string>& sopInstanceUIDs,
+                                          std::vector<StorageIndexRecord>& removed,
+                                          std::vector<StorageIndexRecord>& remaining)
+    {
+        removed.reserve(sopInstanceUIDs.size());
+        {
+            std::lock_guard<std::mutex> fileLock(m_fileMutex);
+            for (const auto& uid : sopInstanceUIDs)
+            {
+                const auto it = m_records.find(uid);
+                if (it == m_records.end())
+                    continue;
+                removed.push_back(it->second);
+                m_pendingRemovals.insert(it->second.relativePath);
+                eraseRecord(uid);
+            }
+        }
+
+        remaining.reserve(m_records.size());
+        for (const auto& entry : m_records)
+            remaining.push_back(entry.second);
+
+        // Commits from here on are also kept for the compacted journal
+        m_compacting = true;
+        m_compactionBacklog.clear();
+    }
+
+    void DimseStorageIndex::finishPurge(const std::vector<StorageIndexRecord>& removed,
+                                        std::vector<StorageIndexRecord> remaining)
+    {
+        std::error_code ec;
+        for (const auto& record : removed)
+        {
+            // Skipped when a commit filed the same instance at this path in the meantime
+            std::lock_guard<std::mutex> fileLock(m_fileMutex);
+            if (m_pendingRemovals.erase(record.relativePath) == 0)
+                continue;
+            fs::remove(fs::u8path(absolutePath(record)), ec);
+            removeEmptyParents(record.relativePath);
+        }
+
+        const std::string temporaryPath = m_journalPath + ".tmp";
+        bool compacted = writeJournalFile(temporaryPath, std::move(remaining));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (compacted && !m_compactionBacklog.empty())
+        {
+            std::ofstream output(fs::u8path(temporaryPath), std::ios::binary | std::ios::app);
+            for (const auto& record : m_compactionBacklog)
+                output << serialize(record);
+            output.flush();
+            compacted = static_cast<bool>(output);
+        }
+        m_compacting = false;
+        m_compactionBacklog.clear();
+
+        if (!compacted || !installJournal(temporaryPath))
+        {
+            fs::remove(fs::u8path(temporaryPath), ec);
+            qCWarning(lcDimse) << "Failed to compact storage index after purge";
+        }
+    }
+
+    void DimseStorageIndex::insertRecord(const StorageIndexRecord& record)
+    {
+        const auto existing = m_records.find(record.sopInstanceUID);
+        if (existing != m_records.end())
+            m_totalBytes -= std::min(m_totalBytes, existing->second.size);
+        m_totalBytes += record.size;
+        m_records[record.sopInstanceUID] = record;
+        if (!record.studyInstanceUID.empty())
+            m_studyInstances[record.studyInstanceUID].insert(record.sopInstanceUID);
+        if (!record.seriesInstanceUID.empty())
+            m_seriesInstances[record.seriesInstanceUID].insert(record.sopInstanceUID);
+    }
+
+    void DimseStorageIndex::eraseRecord(const std::string& sopInstanceUID)
+    {
+        const auto it = m_records.find(sopInstanceUID);
+        if (it == m_records.end())
+            return;
+
+        const auto eraseFrom = [&sopInstanceUID](std::map<std::string, std::set<std::string>>& groups,
+                                                 const std::string& key) {
+            const auto group = groups.find(key);
+            if (group == groups.end())
+                return;
+            group->second.erase(sopInstanceUID);
+            if (group->second.empty())
+                groups.erase(group);
+        };
+        eraseFrom(m_studyInstances, it->second.studyInstanceUID);
+        eraseFrom(m_seriesInstances, it->second.seriesInstanceUID);
+        m_totalBytes -= std::min(m_totalBytes, it->second.size);
+        m_records.erase(it);
+    }
+
+    bool DimseStorageIndex::appendToJournal(const StorageIndexRecord& record)
+    {
+        if (m_compacting)
+            m_compactionBacklog.push_back(record);
+        if (!m_journal.is_open())
+            return false;
+
+        // One write per record, handed to the OS before the C-STORE response. It is not
+        // fsynced: a power loss can drop the last lines, and open() discards a torn one.
+        const std::string line = serialize(record);
+        m_journal.write(line.data(), static_cast<std::streamsize>(line.size()));
+        m_journal.flush();
+        return static_cast<bool>(m_journal);
+    }
+
+    bool DimseStorageIndex::rewriteJournal()
+    {
+        std::vector<StorageIndexRecord> records;
+        records.reserve(m_records.size());
+        for (const auto& entry : m_records)
+            records.push_back(entry.second);
+
+        const std::string temporaryPath = m_journalPath + ".tmp";
+        if (!writeJournalFile(temporaryPath, std::move(records)))
+        {
+            if (m_journal.is_open())
+            {
+                m_journal.close();
+            }
+            return false;
+        }
+        return installJournal(temporaryPath);
+    }
+
+    bool DimseStorageIndex::installJournal(const std::string& temporaryPath)
+    {
+        if (m_journal.is_open())
+        {
+            m_journal.close();
+        }
+
+        // Readers see either the old or the compacted journal, never a mix
+        const fs::path journalPath = fs::u8path(m_journalPath);
+        std::error_code ec;
+        fs::rename(fs::u8path(temporaryPath), journalPath, ec);
+        m_journal.open(journalPath, std::ios::binary | std::ios::app);
+        return !ec && static_cast<bool>(m_journal);
+    }
+
+    bool DimseStorageIndex::writeJournalFile(const std::string& path, std::vector<StorageIndexRecord> records) const
+    {
+        std::sort(records.begin(), records.end(),
+                  [](const StorageIndexRecord& lhs, const StorageIndexRecord& rhs) {
+                      return lhs.arrival < rhs.arrival;
+                  });
+
+        std::ofstream output(fs::u8path(path), std::ios::binary | std::ios::trunc);
+        output << JournalHeader << '\n';
+        for (const auto& record : records)
+        {
+            output << serialize(record);
+        }
+        output.flush();
+        return static_cast<bool>(output);
+    }
+
+    void DimseStorageIndex::removeEmptyParents(const std::string& relativePath) const
+    {
+        const fs::path root = fs::u8path(m_rootDirectory);
+        fs::path directory = (root / fs::u8path(relativePath)).parent_path();
+        std::error_code ec;
+        while (directory != root && directory.has_parent_path() && fs::is_empty(directory, ec) && !ec)
+        {
+            fs::remove(directory, ec);
+            if (ec)
+                break;
+            directory = directory.parent_path();
+        }
+    }
+
+    std::vector<StorageIndexRecord> DimseStorageIndex::collect(const std::set<std::string>& sopInstanceUIDs) const
+    {
+        std::vector<StorageIndexRecord> records;
+        records.reserve(sopInstanceUIDs.size());
+        for (const auto& uid : sopInstanceUIDs)
+        {
+            const auto it = m_records.find(uid);
+            if (it != m_records.end())
+                records.push_back(it->second);
+        }
+        std::stable_sort(records.begin(), records.end(),
+                         [](const StorageIndexRecord& lhs, const StorageIndexRecord& rhs) {
+                             return lhs.arrival < rhs.arrival;
+                         });
+        return records;
+    }
+
+} // namespace isis::core::network
@@ -0,0 +1,190 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimsestorageindex.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      On-disk layout and arrival index of the objects received by the Storage SCP.
+ *      Objects are filed under Patient/Study/Series folders with a hashed fan-out and
+ *      every arrival is appended to a journal that is replayed at startup.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../utils.h"
+#include "../dicominstanceheader.h"
+#include "dimseconfig.h"
+
+namespace isis::core::network
+{
+    /**
+     * @brief One received object as recorded in the arrival index
+     */
+    struct StorageIndexRecord
+    {
+        std::chrono::system_clock::time_point arrival;
+        std::string sopInstanceUID;
+        std::string sopClassUID;
+        std::string patientKey;             // Hash of the Patient ID (no PHI in paths or index)
+        std::string studyInstanceUID;
+        std::string seriesInstanceUID;
+        std::string relativePath;           // Relative to the storage root, '/' separated
+        std::uint64_t size = 0;
+        std::string transferSyntaxUID;
+        std::string callingAE;
+    };
+
+    enum class StorageCommitResult
+    {
+        Stored,
+        Replaced,               // An earlier copy of the instance was overwritten
+        DuplicateDiscarded,     // An earlier copy was kept (DuplicateSopPolicy::KeepExisting)
+        Failed
+    };
+
+    /**
+     * @brief Hierarchical store and arrival index rooted at the SCP storage directory
+     *
+     * Layout: <root>/<fan-out>/<patient key>/<Study UID>/<Series UID>/<SOP UID>.dcm, where
+     * the patient key is a hash of the Patient ID and the fan-out its first two digits.
+     * The index is an append-only text journal (<root>/storage-index.tsv); each arrival
+     * is written as one line with a single write, so a crash can at most leave a torn
+     * last line, which is dropped when the journal is reopened. Purging rewrites the
+     * journal into a temporary file and renames it over the old one.
+     *
+     * All methods are thread-safe.
+     */
+    class export DimseStorageIndex
+    {
+    public:
+        explicit DimseStorageIndex(std::string rootDirectory,
+                                   DuplicateSopPolicy duplicatePolicy = DuplicateSopPolicy::Replace);
+        ~DimseStorageIndex();
+
+        DimseStorageIndex(const DimseStorageIndex&) = delete;
+        DimseStorageIndex& operator=(const DimseStorageIndex&) = delete;
+
+        /**
+         * @brief Create the root and replay the journal
+         * @return false if the journal cannot be opened for appending
+         */
+        bool open();
+
+        [[nodiscard]] const std::string& getRootDirectory() const { return m_rootDirectory; }
+
+        /**
+         * @brief Move a completely received file into the hierarchy and record its arrival
+         * @param receivedPath File written by the SCP (removed unless it was stored)
+         * @param header Parsed header; the SOP/Study/Series UIDs and Patient ID place the file
+         * @param record Filled with the stored (or kept) record
+         */
+        StorageCommitResult commit(const std::string& receivedPath,
+                                   const DicomInstanceHeader& header,
+                                   const std::string& callingAE,
+                                   StorageIndexRecord& record);
+
+        /**
+         * @brief Look up an instance by SOP Instance UID
+         */
+        bool find(const std::string& sopInstanceUID, StorageIndexRecord& record) const;
+        [[nodiscard]] bool contains(const std::string& sopInstanceUID) const;
+
+        /**
+         * @brief Records of a study or series, ordered by arrival
+         */
+        [[nodiscard]] std::vector<StorageIndexRecord> getStudyRecords(const std::string& studyInstanceUID) const;
+        [[nodiscard]] std::vector<StorageIndexRecord> getSeriesRecords(const std::string& seriesInstanceUID) const;
+
+        /**
+         * @brief Absolute path of a record's file
+         */
+        [[nodiscard]] std::string absolutePath(const StorageIndexRecord& record) const;
+
+        /**
+         * @brief Delete objects that arrived before cutoff and compact the journal
+         * @return Number of objects removed
+         */
+        std::size_t purgeOlderThan(std::chrono::system_clock::time_point cutoff);
+
+        /**
+         * @brief Mark a study as used now, for the least-recently-used purge
+         *
+         * Use times are kept in memory; after a restart a study counts as last used
+         * when its latest object arrived.
+         */
+        void touchStudy(const std::string& studyInstanceUID);
+
+        /**
+         * @brief Delete whole studies, least recently used first, until the store fits in maxBytes
+         * @param keepStudies Studies that are never purged (open or being prefetched)
+         * @return Number of objects removed
+         */
+        std::size_t purgeLeastRecentlyUsed(std::uint64_t maxBytes,
+                                           const std::set<std::string>& keepStudies = {});
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::uint64_t totalBytes() const;
+
+        /**
+         * @brief Path of an instance under the hierarchy, relative to the root
+         */
+        static std::string relativePathFor(const std::string& patientID,
+                                           const std::string& studyInstanceUID,
+                                           const std::string& seriesInstanceUID,
+                                           const std::string& sopInstanceUID);
+
+    private:
+        std::string m_rootDirectory;
+        std::string m_journalPath;
+        DuplicateSopPolicy m_duplicatePolicy;
+
+        mutable std::mutex m_mutex;
+        std::ofstream m_journal;
+        std::unordered_map<std::string, StorageIndexRecord> m_records;     // By SOP Instance UID
+        std::map<std::string, std::set<std::string>> m_studyInstances;     // Study UID -> SOP UIDs
+        std::map<std::string, std::set<std::string>> m_seriesInstances;    // Series UID -> SOP UIDs
+        std::unordered_map<std::string, std::chrono::system_clock::time_point> m_studyLastUsed;
+        std::uint64_t m_totalBytes = 0;
+
+        // Purges run one at a time and do their disk work without m_mutex
+        std::mutex m_purgeMutex;
+        bool m_compacting = false;                                         // Guarded by m_mutex
+        std::vector<StorageIndexRecord> m_compactionBacklog;               // Appended while compacting
+        std::mutex m_fileMutex;                                            // Taken after m_mutex
+        std::unordered_set<std::string> m_pendingRemovals;                 // Relative paths, m_fileMutex
+
+        // m_mutex held for the helpers below
+        void insertRecord(const StorageIndexRecord& record);
+        void eraseRecord(const std::string& sopInstanceUID);
+        bool appendToJournal(const StorageIndexRecord& record);
+        bool rewriteJournal();
+        bool installJournal(const std::string& temporaryPath);
+        void detachRecords(const std::vector<std::string>& sopInstanceUIDs,
+                           std::vector<StorageIndexRecord>& removed,
+                           std::vector<StorageIndexRecord>& remaining);
+        std::vector<StorageIndexRecord> collect(const std::set<std::string>& sopInstanceUIDs) const;
+
+        // No lock held
+        bool writeJournalFile(const std::string& path, std::vector<StorageIndexRecord> records) const;
+        void removeEmptyParents(const std::string& relativePath) const;
+        void finishPurge(const std::vector<StorageIndexRecord>& removed,
+                         std::vector<StorageIndexRecord> remaining);
+    };
+
+} // namespace isis::core::network
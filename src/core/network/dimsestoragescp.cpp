@@ -16,15 +16,230 @@
 #include "dimsestoragescp.h"
 #include <dcmtk/dcmdata/dcuid.h>
 #include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcmetinf.h>
 #include <dcmtk/dcmdata/dcdeftag.h>
 #include <dcmtk/dcmnet/cond.h>
+#include <dcmtk/dcmdata/dcostrmf.h>
 #include <QDir>
 #include <QLoggingCategory>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
 
 Q_DECLARE_LOGGING_CATEGORY(lcDimse)
 
 namespace isis::core::network
 {
+    namespace
+    {
+        // Distinguishes partial files of concurrent transfers of the same instance
+        std::atomic<std::uint64_t> partialFileCounter{0};
+
+        std::string trimPadding(const OFString& value)
+        {
+            const auto isPadding = [](char c) {
+                return c == '\0' || std::isspace(static_cast<unsigned char>(c)) != 0;
+            };
+            std::size_t begin = 0;
+            std::size_t end = value.length();
+            while (begin < end && isPadding(value[begin]))
+                ++begin;
+            while (end > begin && isPadding(value[end - 1]))
+                --end;
+            return std::string(value.c_str() + begin, end - begin);
+        }
+    }
+
+    namespace
+    {
+        // UIDs only contain digits and dots; anything else must not reach the file system
+        std::string safeFileName(const char* sopInstanceUID)
+        {
+            std::string safeName = sopInstanceUID ? sopInstanceUID : "";
+            std::replace_if(safeName.begin(), safeName.end(),
+                            [](char c) { return !(std::isdigit(static_cast<unsigned char>(c)) || c == '.'); },
+                            '_');
+            return safeName.empty() ? std::string("unknown") : safeName;
+        }
+
+        /**
+         * @brief Stream the dataset of a C-STORE request into a new partial file in directory
+         * @return Path of the complete partial file, empty on failure (status is set)
+         */
+        std::filesystem::path receiveToPartialFile(T_ASC_Association* assoc,
+                                                   T_DIMSE_C_StoreRQ* request,
+                                                   T_ASC_PresentationContextID& presID,
+                                                   const std::filesystem::path& directory,
+                                                   DIC_US& status)
+        {
+            namespace fs = std::filesystem;
+
+            const fs::path partialPath = directory /
+                (safeFileName(request->AffectedSOPInstanceUID) + "." +
+                 std::to_string(partialFileCounter++) + ".part");
+
+            DcmOutputFileStream* filestream = nullptr;
+            OFCondition cond = DIMSE_createFilestream(partialPath.u8string().c_str(), request, assoc,
+                                                      presID, OFTrue, &filestream);
+            if (cond.bad() || !filestream)
+            {
+                qCWarning(lcDimse) << "Failed to create file for received object:" << cond.text();
+                delete filestream;
+
+                // Drain the incoming dataset so the association stays usable
+                DIC_UL bytesRead = 0;
+                DIC_UL pdvCount = 0;
+                DIMSE_ignoreDataSet(assoc, DIMSE_BLOCKING, 0, &bytesRead, &pdvCount);
+                status = STATUS_STORE_Refused_OutOfResources;
+                return {};
+            }
+
+            // P-DATA fragments are appended to the file in the negotiated transfer syntax,
+            // without being parsed or re-encoded
+            cond = DIMSE_receiveDataSetInFile(assoc, DIMSE_BLOCKING, 0, &presID, filestream, nullptr, nullptr);
+            delete filestream; // Closes the file
+
+            if (cond.bad())
+            {
+                qCWarning(lcDimse) << "Failed to receive dataset:" << cond.text();
+                std::error_code ec;
+                fs::remove(partialPath, ec);
+                status = STATUS_STORE_Error_CannotUnderstand;
+                return {};
+            }
+
+            status = STATUS_Success;
+            return partialPath;
+        }
+    }
+
+    std::string receiveStoreDataSetToFile(T_ASC_Association* assoc,
+                                          T_DIMSE_C_StoreRQ* request,
+                                          T_ASC_PresentationContextID& presID,
+                                          const std::string& directory,
+                                          DIC_US& status,
+                                          std::uint64_t& bytesWritten)
+    {
+        namespace fs = std::filesystem;
+
+        bytesWritten = 0;
+
+        // The partial file lives next to its final name so the rename stays on one volume
+        const fs::path storageDir = fs::u8path(directory);
+        const fs::path finalPath = storageDir / (safeFileName(request->AffectedSOPInstanceUID) + ".dcm");
+        const fs::path partialPath = receiveToPartialFile(assoc, request, presID, storageDir, status);
+        if (partialPath.empty())
+        {
+            return "";
+        }
+
+        // Publish the complete file atomically; readers never see a partial object
+        std::error_code ec;
+        fs::rename(partialPath, finalPath, ec);
+        if (ec)
+        {
+            qCWarning(lcDimse) << "Failed to move received object into place:" << ec.message().c_str();
+            fs::remove(partialPath, ec);
+            status = STATUS_STORE_Refused_OutOfResources;
+            return "";
+        }
+
+        const auto size = fs::file_size(finalPath, ec);
+        bytesWritten = ec ? 0 : static_cast<std::uint64_t>(size);
+        status = STATUS_Success;
+        return finalPath.u8string();
+    }
+
+    bool readReceivedInstanceHeader(const std::string& filepath, DicomInstanceHeader& header)
+    {
+        // Everything the repository reads precedes Pixel Data; don't load the pixels
+        DcmFileFormat fileFormat;
+        OFCondition cond = fileFormat.loadFileUntilTag(filepath.c_str(), EXS_Unknown, EGL_noChange,
+                                                       DCM_MaxReadLength, ERM_autoDetect,
+                                                       DCM_PixelData);
+        if (cond.bad())
+        {
+            qCWarning(lcDimse) << "Failed to parse header of" << filepath.c_str() << ":" << cond.text();
+            return false;
+        }
+
+        DcmDataset* dataset = fileFormat.getDataset();
+        header.filePath = filepath;
+        header.values.clear();
+
+        // Recorded in the storage index next to the UIDs
+        OFString transferSyntax;
+        if (fileFormat.getMetaInfo()->findAndGetOFString(DCM_TransferSyntaxUID, transferSyntax).good())
+        {
+            header.setValue(0x0002, 0x0010, trimPadding(transferSyntax));
+        }
+
+        for (const auto key : RepositoryHeaderTags)
+        {
+            OFString value;
+            const DcmTagKey tag(static_cast<Uint16>(key >> 16), static_cast<Uint16>(key & 0xFFFF));
+            if (dataset->findAndGetOFStringArray(tag, value).good())
+            {
+                auto trimmed = trimPadding(value);
+                if (!trimmed.empty())
+                    header.values.emplace(key, std::move(trimmed));
+            }
+        }
+
+        // Objects without identifying UIDs take the regular file import path
+        return !header.getValue(0x0008, 0x0018).empty() && !header.getValue(0x0020, 0x000E).empty();
+    }
+
+    ReceivedStoreObject receiveStoreDataSet(T_ASC_Association* assoc,
+                                            T_DIMSE_C_StoreRQ* request,
+                                            T_ASC_PresentationContextID& presID,
+                                            const std::string& directory,
+                                            DimseStorageIndex* index,
+                                            const std::string& callingAE,
+                                            DIC_US& status)
+    {
+        namespace fs = std::filesystem;
+
+        ReceivedStoreObject object;
+        if (!index)
+        {
+            object.filepath = receiveStoreDataSetToFile(assoc, request, presID, directory, status, object.bytes);
+            object.headerRead = !object.filepath.empty() &&
+                                readReceivedInstanceHeader(object.filepath, object.header);
+            return object;
+        }
+
+        // Received next to the hierarchy (same volume), then filed by the UIDs in its header
+        const fs::path incoming = fs::u8path(directory) / "incoming";
+        std::error_code ec;
+        fs::create_directories(incoming, ec);
+        const fs::path partialPath = receiveToPartialFile(assoc, request, presID, incoming, status);
+        if (partialPath.empty())
+        {
+            return object;
+        }
+
+        object.headerRead = readReceivedInstanceHeader(partialPath.u8string(), object.header);
+        if (object.header.getValue(0x0008, 0x0018).empty())
+        {
+            object.header.setValue(0x0008, 0x0016, request->AffectedSOPClassUID);
+            object.header.setValue(0x0008, 0x0018, request->AffectedSOPInstanceUID);
+        }
+
+        StorageIndexRecord record;
+        const auto result = index->commit(partialPath.u8string(), object.header, callingAE, record);
+        if (result == StorageCommitResult::Failed)
+        {
+            status = STATUS_STORE_Refused_OutOfResources;
+            return object;
+        }
+        object.filepath = index->absolutePath(record);
+        object.header.filePath = object.filepath;
+        object.bytes = record.size;
+        object.duplicateDiscarded = result == StorageCommitResult::DuplicateDiscarded;
+        return object;
+    }
+
     DimseStorageSCP::DimseStorageSCP(const LocalAEConfig& localAE,
                                     std::shared_ptr<events::CallbackManager> eventManager)
         : m_localConfig(localAE)
@@ -37,6 +252,7 @@ namespace isis::core::network
         {
             dir.mkpath(".");
         }
+        openStorageIndex();
     }
 
     DimseStorageSCP::~DimseStorageSCP()
@@ -64,8 +280,17 @@ namespace isis::core::network
             return false;
         }
 
+        purgeExpired();
+
         m_stopRequested = false;
         m_running = true;
+
+        const int workerCount = std::max(1, m_localConfig.maxConnections);
+        m_workers.reserve(static_cast<size_t>(workerCount));
+        for (int i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back(&DimseStorageSCP::workerLoop, this);
+        }
         m_serverThread = std::make_unique<std::thread>(&DimseStorageSCP::serverLoop, this);
 
         qCInfo(lcDimse) << "Storage SCP started on port" << m_localConfig.storagePort
@@ -87,14 +312,30 @@ namespace isis::core::network
 
         qCInfo(lcDimse) << "Stopping Storage SCP...";
 
-        m_stopRequested = true;
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stopRequested = true;
+        }
         m_running = false;
+        m_slotCondition.notify_all();
 
         if (m_serverThread && m_serverThread->joinable())
         {
             m_serverThread->join();
         }
 
+        // Workers finish their current association (handleAssociation checks the stop
+        // flag) and serve whatever was already acknowledged before exiting
+        m_queueCondition.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+        m_workers.clear();
+
         cleanupNetwork();
 
         qCInfo(lcDimse) << "Storage SCP stopped";
@@ -111,6 +352,11 @@ namespace isis::core::network
         m_storageCallback = callback;
     }
 
+    void DimseStorageSCP::setInstanceReceivedCallback(InstanceReceivedCallback callback)
+    {
+        m_instanceCallback = callback;
+    }
+
     void DimseStorageSCP::setStorageDirectory(const std::string& dir)
     {
         m_storageDirectory = dir;
@@ -119,6 +365,48 @@ namespace isis::core::network
         {
             qdir.mkpath(".");
         }
+        openStorageIndex();
+    }
+
+    void DimseStorageSCP::openStorageIndex()
+    {
+        m_storageIndex.reset();
+        if (!m_localConfig.hierarchicalStorage || m_storageDirectory.empty())
+        {
+            return;
+        }
+
+        // Partial files left behind by an interrupted transfer are never completed
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        for (fs::directory_iterator it(fs::u8path(m_storageDirectory) / "incoming", ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (it->path().extension() == ".part")
+            {
+                std::error_code removeError;
+                fs::remove(it->path(), removeError);
+            }
+        }
+
+        auto index = std::make_shared<DimseStorageIndex>(m_storageDirectory, m_localConfig.duplicatePolicy);
+        if (!index->open())
+        {
+            qCWarning(lcDimse) << "Storage index unavailable, received objects are stored flat";
+            return;
+        }
+        m_storageIndex = index;
+    }
+
+    size_t DimseStorageSCP::purgeExpired()
+    {
+        m_lastPurge = std::chrono::steady_clock::now();
+        if (!m_storageIndex || m_localConfig.retentionDays <= 0)
+        {
+            return 0;
+        }
+        const auto cutoff = std::chrono::system_clock::now() -
+                            std::chrono::hours(24) * m_localConfig.retentionDays;
+        return m_storageIndex->purgeOlderThan(cutoff);
     }
 
     bool DimseStorageSCP::initializeNetwork()
@@ -158,12 +446,32 @@ namespace isis::core::network
         };
         const int transferSyntaxCount = static_cast<int>(sizeof(transferSyntaxes) / sizeof(const char*));
 
+        // Received data sets are written to disk in the negotiated syntax without being
+        // decoded, so compressed objects cost nothing to accept. Lossless compression is
+        // preferred over uncompressed; lossy syntaxes come last so they are only chosen
+        // when the sender offers nothing else (it already holds the object that way).
+        const char* compressedFirst[] = {
+            UID_JPEGLSLosslessTransferSyntax,
+            UID_JPEG2000LosslessOnlyTransferSyntax,
+            UID_DeflatedExplicitVRLittleEndianTransferSyntax,
+            UID_LittleEndianExplicitTransferSyntax,
+            UID_BigEndianExplicitTransferSyntax,
+            UID_LittleEndianImplicitTransferSyntax,
+            UID_JPEGProcess14SV1TransferSyntax,
+            UID_RLELosslessTransferSyntax,
+            UID_JPEGProcess1TransferSyntax,
+            UID_JPEGProcess2_4TransferSyntax,
+            UID_JPEGLSLossyTransferSyntax,
+            UID_JPEG2000TransferSyntax
+        };
+        const int compressedFirstCount = static_cast<int>(sizeof(compressedFirst) / sizeof(const char*));
+
         ASC_acceptContextsWithPreferredTransferSyntaxes(
             assoc->params,
             dcmAllStorageSOPClassUIDs,
             numberOfDcmAllStorageSOPClassUIDs,
-            transferSyntaxes,
-            transferSyntaxCount);
+            m_localConfig.acceptCompressed ? compressedFirst : transferSyntaxes,
+            m_localConfig.acceptCompressed ? compressedFirstCount : transferSyntaxCount);
 
         const char* verificationClass[] = { UID_VerificationSOPClass };
         ASC_acceptContextsWithPreferredTransferSyntaxes(
@@ -174,12 +482,65 @@ namespace isis::core::network
             transferSyntaxCount);
     }
 
+    void DimseStorageSCP::rejectAssociation(T_ASC_Association* assoc, const char* reason)
+    {
+        T_ASC_RejectParameters rejection = {
+            ASC_RESULT_REJECTEDTRANSIENT,
+            ASC_SOURCE_SERVICEPROVIDER_PRESENTATION_RELATED,
+            ASC_REASON_SP_PRES_LOCALLIMITEXCEEDED
+        };
+
+        qCWarning(lcDimse) << "Rejecting association from"
+                           << assoc->params->DULparams.callingAPTitle << ":" << reason;
+
+        ASC_rejectAssociation(assoc, &rejection);
+        ASC_dropAssociation(assoc);
+        ASC_destroyAssociation(&assoc);
+        m_rejectedAssociations++;
+    }
+
+    void DimseStorageSCP::releaseSlot(const std::string& callingAE)
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_inFlightAssociations > 0)
+        {
+            m_inFlightAssociations--;
+        }
+
+        auto it = m_associationsPerAE.find(callingAE);
+        if (it != m_associationsPerAE.end() && --it->second <= 0)
+        {
+            m_associationsPerAE.erase(it);
+        }
+
+        m_slotCondition.notify_one();
+    }
+
     void DimseStorageSCP::serverLoop()
     {
         qCInfo(lcDimse) << "Storage SCP server loop started";
 
+        const size_t maxAssociations = static_cast<size_t>(std::max(1, m_localConfig.maxConnections));
+        const int maxPerAE = m_localConfig.maxAssociationsPerAE;
+
         while (!m_stopRequested)
         {
+            if (std::chrono::steady_clock::now() - m_lastPurge >= PurgeInterval)
+            {
+                purgeExpired();
+            }
+
+            // Backpressure: stop accepting while every worker is busy, so further
+            // peers wait in the TCP backlog instead of piling up in memory
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                if (m_inFlightAssociations >= maxAssociations)
+                {
+                    m_slotCondition.wait_for(lock, std::chrono::milliseconds(500));
+                    continue;
+                }
+            }
+
             T_ASC_Association* assoc = nullptr;
 
             // Wait for incoming association (with timeout to allow checking stop flag)
@@ -205,53 +566,201 @@ namespace isis::core::network
                 continue;
             }
 
-            if (assoc)
+            if (!assoc)
             {
-                qCInfo(lcDimse) << "Received association request from"
-                               << assoc->params->DULparams.callingAPTitle;
+                continue;
+            }
+
+            PendingAssociation pending;
+            pending.assoc = assoc;
+            pending.callingAE = assoc->params->DULparams.callingAPTitle;
 
-                configureAcceptedContexts(assoc);
+            qCInfo(lcDimse) << "Received association request from" << pending.callingAE.c_str();
 
-                // Acknowledge association
-                cond = ASC_acknowledgeAssociation(assoc);
-                if (cond.bad())
+            // Reserve a slot, honouring the per-calling-AE limit; the reject itself is
+            // network I/O and goes out after the lock is released
+            bool limitReached = false;
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                int& perAE = m_associationsPerAE[pending.callingAE];
+                if (maxPerAE > 0 && perAE >= maxPerAE)
                 {
-                    qCWarning(lcDimse) << "Failed to acknowledge association:" << cond.text();
-                    ASC_dropAssociation(assoc);
-                    ASC_destroyAssociation(&assoc);
-                    continue;
+                    limitReached = true;
                 }
-
-                // Handle the association
-                AssociationResult associationResult = handleAssociation(assoc);
-
-                switch (associationResult)
+                else
                 {
-                case AssociationResult::ReleaseByServer:
-                    ASC_releaseAssociation(assoc);
-                    break;
-                case AssociationResult::ReleaseByPeer:
-                    qCInfo(lcDimse) << "Peer requested association release; acknowledged.";
-                    break;
-                case AssociationResult::AbortOrError:
-                    ASC_abortAssociation(assoc);
-                    break;
+                    perAE++;
+                    m_inFlightAssociations++;
+                    pending.id = m_nextAssociationId++;
                 }
+            }
+            if (limitReached)
+            {
+                rejectAssociation(assoc, "per-AE association limit reached");
+                continue;
+            }
+
+            configureAcceptedContexts(assoc);
 
+            // Acknowledge association
+            cond = ASC_acknowledgeAssociation(assoc);
+            if (cond.bad())
+            {
+                qCWarning(lcDimse) << "Failed to acknowledge association:" << cond.text();
                 ASC_dropAssociation(assoc);
                 ASC_destroyAssociation(&assoc);
+                releaseSlot(pending.callingAE);
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> statsLock(m_statsMutex);
+                StorageAssociationStats stats;
+                stats.id = pending.id;
+                stats.callingAE = pending.callingAE;
+                stats.peerAddress = assoc->params->DULparams.callingPresentationAddress;
+                stats.startTime = std::chrono::system_clock::now();
+                m_activeStats[pending.id] = stats;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                m_pendingAssociations.push_back(std::move(pending));
             }
+            m_queueCondition.notify_one();
         }
 
         qCInfo(lcDimse) << "Storage SCP server loop ended";
     }
 
-    DimseStorageSCP::AssociationResult DimseStorageSCP::handleAssociation(T_ASC_Association* assoc)
+    void DimseStorageSCP::workerLoop()
+    {
+        while (true)
+        {
+            PendingAssociation pending;
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                m_queueCondition.wait(lock, [this]() {
+                    return m_stopRequested || !m_pendingAssociations.empty();
+                });
+
+                if (m_pendingAssociations.empty())
+                {
+                    return; // Stop requested and nothing left to serve
+                }
+
+                pending = std::move(m_pendingAssociations.front());
+                m_pendingAssociations.pop_front();
+            }
+
+            serveAssociation(std::move(pending));
+        }
+    }
+
+    void DimseStorageSCP::serveAssociation(PendingAssociation pending)
+    {
+        T_ASC_Association* assoc = pending.assoc;
+
+        // Handle the association
+        AssociationResult associationResult = handleAssociation(assoc, pending.id);
+
+        switch (associationResult)
+        {
+        case AssociationResult::ReleaseByServer:
+            ASC_releaseAssociation(assoc);
+            break;
+        case AssociationResult::ReleaseByPeer:
+            qCInfo(lcDimse) << "Peer requested association release; acknowledged.";
+            break;
+        case AssociationResult::AbortOrError:
+            ASC_abortAssociation(assoc);
+            break;
+        }
+
+        ASC_dropAssociation(assoc);
+        ASC_destroyAssociation(&assoc);
+
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            auto it = m_activeStats.find(pending.id);
+            if (it != m_activeStats.end())
+            {
+                StorageAssociationStats stats = it->second;
+                m_activeStats.erase(it);
+
+                stats.active = false;
+                stats.durationMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::system_clock::now() - stats.startTime).count();
+
+                qCInfo(lcDimse) << "Association" << stats.id << "from" << stats.callingAE.c_str()
+                                << "finished:" << stats.objectsReceived << "objects,"
+                                << stats.objectsFailed << "failed," << stats.bytesReceived << "bytes in"
+                                << stats.durationMs << "ms";
+
+                m_completedStats.push_back(std::move(stats));
+                while (m_completedStats.size() > MaxCompletedStats)
+                {
+                    m_completedStats.pop_front();
+                }
+            }
+        }
+
+        releaseSlot(pending.callingAE);
+    }
+
+    void DimseStorageSCP::recordObject(std::uint64_t associationId, std::uint64_t bytes, bool success)
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        auto it = m_activeStats.find(associationId);
+        if (it == m_activeStats.end())
+        {
+            return;
+        }
+
+        if (success)
+        {
+            it->second.objectsReceived++;
+            it->second.bytesReceived += bytes;
+        }
+        else
+        {
+            it->second.objectsFailed++;
+        }
+    }
+
+    std::vector<StorageAssociationStats> DimseStorageSCP::getAssociationStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+
+        std::vector<StorageAssociationStats> result;
+        result.reserve(m_activeStats.size() + m_completedStats.size());
+
+        const auto now = std::chrono::system_clock::now();
+        for (const auto& [id, stats] : m_activeStats)
+        {
+            StorageAssociationStats copy = stats;
+            copy.durationMs = std::chrono::duration<double, std::milli>(now - stats.startTime).count();
+            result.push_back(std::move(copy));
+        }
+
+        result.insert(result.end(), m_completedStats.rbegin(), m_completedStats.rend());
+        return result;
+    }
+
+    size_t DimseStorageSCP::getActiveAssociationCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        return m_inFlightAssociations;
+    }
+
+    DimseStorageSCP::AssociationResult DimseStorageSCP::handleAssociation(T_ASC_Association* assoc,
+                                                                           std::uint64_t associationId)
     {
         if (!assoc)
             return AssociationResult::AbortOrError;
 
         // Process incoming DIMSE commands
+        auto lastActivity = std::chrono::steady_clock::now();
         while (!m_stopRequested)
         {
             T_DIMSE_Message msg;
@@ -263,13 +772,14 @@ namespace isis::core::network
 
             if (cond == DIMSE_NODATAAVAILABLE || cond == DUL_READTIMEOUT)
             {
-                // No data available, check if association is still active
-                if (!ASC_dataWaiting(assoc, 0))
+                // Keep idle associations open for a while so pooled peers can reuse them
+                if (std::chrono::steady_clock::now() - lastActivity > AssociationIdleTimeout)
                 {
-                    break; // No more data, exit loop
+                    break;
                 }
                 continue;
             }
+            lastActivity = std::chrono::steady_clock::now();
 
             if (cond == DUL_PEERREQUESTEDRELEASE)
             {
@@ -294,7 +804,7 @@ namespace isis::core::network
             switch (msg.CommandField)
             {
             case DIMSE_C_STORE_RQ:
-                handleStoreRequest(assoc, &msg.msg.CStoreRQ, presID);
+                handleStoreRequest(assoc, &msg.msg.CStoreRQ, presID, associationId);
                 break;
 
             case DIMSE_C_ECHO_RQ:
@@ -322,7 +832,8 @@ namespace isis::core::network
 
     OFCondition DimseStorageSCP::handleStoreRequest(T_ASC_Association* assoc,
                                                     T_DIMSE_C_StoreRQ* request,
-                                                    T_ASC_PresentationContextID presID)
+                                                    T_ASC_PresentationContextID presID,
+                                                    std::uint64_t associationId)
     {
         if (!assoc || !request)
             return EC_IllegalParameter;
@@ -330,45 +841,44 @@ namespace isis::core::network
         qCInfo(lcDimse) << "Receiving C-STORE for SOP Instance:"
                        << request->AffectedSOPInstanceUID;
 
-        // Receive dataset
-        DcmDataset* dataset = nullptr;
-        OFCondition cond = DIMSE_receiveDataSetInMemory(assoc, DIMSE_BLOCKING, 0,
-                                                        &presID, &dataset, nullptr, nullptr);
-
+        // Stream the dataset to disk exactly as it arrives on the wire
         DIC_US status = STATUS_Success;
-        if (cond.bad() || !dataset)
+        ReceivedStoreObject object = receiveStoreDataSet(assoc, request, presID, m_storageDirectory,
+                                                         m_storageIndex.get(),
+                                                         assoc->params->DULparams.callingAPTitle, status);
+        const std::string& filepath = object.filepath;
+
+        if (filepath.empty())
         {
-            qCWarning(lcDimse) << "Failed to receive dataset:" << cond.text();
-            status = STATUS_STORE_Error_CannotUnderstand;
+            recordObject(associationId, 0, false);
         }
         else
         {
-            // Save the dataset
-            std::string filepath = saveReceivedObject(dataset, request->AffectedSOPInstanceUID);
+            qCInfo(lcDimse) << "Saved received object to:" << filepath.c_str();
+            m_receivedFiles++;
+            recordObject(associationId, object.bytes, true);
 
-            if (filepath.empty())
+            if (m_eventManager)
             {
-                qCWarning(lcDimse) << "Failed to save received object";
-                status = STATUS_STORE_Refused_OutOfResources;
+                m_eventManager->dispatchEvent(events::ProcessingEventType::DimseStorageReceived,
+                                             "Received file: " + filepath);
             }
-            else
-            {
-                qCInfo(lcDimse) << "Saved received object to:" << filepath.c_str();
-                m_receivedFiles++;
 
-                if (m_eventManager)
-                {
-                    m_eventManager->dispatchEvent(events::ProcessingEventType::DimseStorageReceived,
-                                                 "Received file: " + filepath);
-                }
-
-                if (m_storageCallback)
-                {
-                    m_storageCallback(filepath);
-                }
+            // A kept copy is published too: the store outlives the session, the repository
+            // does not, and the repository ignores instances it already holds
+            if (object.duplicateDiscarded)
+            {
+                qCInfo(lcDimse) << "Kept existing copy of" << request->AffectedSOPInstanceUID;
+            }
+            // Publish the header from this worker so the importer does not parse the file again
+            if (m_instanceCallback && object.headerRead)
+            {
+                m_instanceCallback(object.header);
+            }
+            else if (m_storageCallback)
+            {
+                m_storageCallback(filepath);
             }
-
-            delete dataset;
         }
 
         // Send C-STORE response
@@ -380,7 +890,7 @@ namespace isis::core::network
         strcpy(response.AffectedSOPClassUID, request->AffectedSOPClassUID);
         strcpy(response.AffectedSOPInstanceUID, request->AffectedSOPInstanceUID);
 
-        cond = DIMSE_sendStoreResponse(assoc, presID, request, &response, nullptr);
+        OFCondition cond = DIMSE_sendStoreResponse(assoc, presID, request, &response, nullptr);
 
         if (cond.bad())
         {
@@ -390,31 +900,4 @@ namespace isis::core::network
         return cond;
     }
 
-    std::string DimseStorageSCP::saveReceivedObject(DcmDataset* dataset,
-                                                    const std::string& sopInstanceUID)
-    {
-        if (!dataset)
-            return "";
-
-        // Create filename from SOP Instance UID
-        QString filename = QString::fromStdString(sopInstanceUID) + ".dcm";
-        QDir storageDir(QString::fromStdString(m_storageDirectory));
-        QString filepath = storageDir.filePath(filename);
-
-        // Create file format object
-        DcmFileFormat fileFormat(dataset);
-
-        // Save to file
-        OFCondition cond = fileFormat.saveFile(filepath.toStdString().c_str(),
-                                              EXS_LittleEndianExplicit);
-
-        if (cond.bad())
-        {
-            qCWarning(lcDimse) << "Failed to save file:" << cond.text();
-            return "";
-        }
-
-        return filepath.toStdString();
-    }
-
 } // namespace isis::core::network
@@ -19,12 +19,21 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
 #include <dcmtk/dcmnet/assoc.h>
 #include <dcmtk/dcmnet/dimse.h>
 #include "../utils.h"
+#include "../dicominstanceheader.h"
 #include "../events/callbackmanager.h"
 #include "dimseconfig.h"
+#include "dimsestorageindex.h"
 
 namespace isis::core::network
 {
@@ -33,6 +42,80 @@ namespace isis::core::network
      */
     using StorageReceivedCallback = std::function<void(const std::string& filepath)>;
 
+    /**
+     * @brief Callback for received objects whose header was parsed by the SCP
+     */
+    using InstanceReceivedCallback = std::function<void(const DicomInstanceHeader& header)>;
+
+    /**
+     * @brief Counters for one association handled by the Storage SCP
+     */
+    struct StorageAssociationStats
+    {
+        std::uint64_t id = 0;
+        std::string callingAE;
+        std::string peerAddress;
+        std::size_t objectsReceived = 0;
+        std::size_t objectsFailed = 0;
+        std::uint64_t bytesReceived = 0;
+        std::chrono::system_clock::time_point startTime;
+        double durationMs = 0.0;            // Elapsed so far while active
+        bool active = true;
+    };
+
+    /**
+     * @brief Stream the dataset of a C-STORE request to "<SOP Instance UID>.dcm" in directory
+     *
+     * The P-DATA fragments are written as received (bit-preserved) to a partial file that
+     * is renamed into place once complete. Shared by the Storage SCP and the C-GET SCU.
+     * @param presID Presentation context of the request, updated from the dataset PDVs
+     * @param status C-STORE response status to report to the sender
+     * @param bytesWritten Size of the stored file
+     * @return Final file path, empty on failure (the dataset is drained in that case)
+     */
+    export std::string receiveStoreDataSetToFile(T_ASC_Association* assoc,
+                                                 T_DIMSE_C_StoreRQ* request,
+                                                 T_ASC_PresentationContextID& presID,
+                                                 const std::string& directory,
+                                                 DIC_US& status,
+                                                 std::uint64_t& bytesWritten);
+
+    /**
+     * @brief Read the attributes the repository needs from a stored file, up to Pixel Data
+     * @return false if the file cannot be parsed
+     */
+    export bool readReceivedInstanceHeader(const std::string& filepath, DicomInstanceHeader& header);
+
+    /**
+     * @brief An object received through a C-STORE request and where it was stored
+     */
+    struct ReceivedStoreObject
+    {
+        std::string filepath;               // Empty on failure
+        DicomInstanceHeader header;
+        bool headerRead = false;
+        bool duplicateDiscarded = false;    // An earlier copy was kept; filepath names it
+        std::uint64_t bytes = 0;
+    };
+
+    /**
+     * @brief Receive the dataset of a C-STORE request and commit it to the storage index
+     *
+     * With an index the object is streamed into "<directory>/incoming" and filed by the
+     * UIDs in its header; without one it is stored flat as "<SOP Instance UID>.dcm".
+     * Shared by the Storage SCP and the C-GET SCU so both fill the same store.
+     * @param index Arrival index of the hierarchical store, null for flat storage
+     * @param callingAE AE title recorded with the arrival
+     * @param status C-STORE response status to report to the sender
+     */
+    export ReceivedStoreObject receiveStoreDataSet(T_ASC_Association* assoc,
+                                                   T_DIMSE_C_StoreRQ* request,
+                                                   T_ASC_PresentationContextID& presID,
+                                                   const std::string& directory,
+                                                   DimseStorageIndex* index,
+                                                   const std::string& callingAE,
+                                                   DIC_US& status);
+
     /**
      * @brief Simple Storage SCP for receiving C-STORE operations
      */
@@ -64,6 +147,12 @@ namespace isis::core::network
          */
         void setStorageReceivedCallback(StorageReceivedCallback callback);
 
+        /**
+         * @brief Set callback for received objects, called with the parsed header instead
+         *        of the storage callback (which remains the fallback if parsing fails)
+         */
+        void setInstanceReceivedCallback(InstanceReceivedCallback callback);
+
         /**
          * @brief Get storage directory
          */
@@ -74,6 +163,17 @@ namespace isis::core::network
          */
         void setStorageDirectory(const std::string& dir);
 
+        /**
+         * @brief Arrival index of the hierarchical store (null with flat storage)
+         */
+        std::shared_ptr<DimseStorageIndex> getStorageIndex() const { return m_storageIndex; }
+
+        /**
+         * @brief Delete received objects older than the configured retention
+         * @return Number of objects removed
+         */
+        size_t purgeExpired();
+
         /**
          * @brief Get number of received files
          */
@@ -84,6 +184,21 @@ namespace isis::core::network
          */
         void resetFileCount() { m_receivedFiles = 0; }
 
+        /**
+         * @brief Counters of active associations followed by the most recently completed ones
+         */
+        std::vector<StorageAssociationStats> getAssociationStats() const;
+
+        /**
+         * @brief Number of associations currently queued or being served
+         */
+        size_t getActiveAssociationCount() const;
+
+        /**
+         * @brief Number of associations rejected because a limit was reached
+         */
+        size_t getRejectedAssociationCount() const { return m_rejectedAssociations; }
+
     private:
         LocalAEConfig m_localConfig;
         std::shared_ptr<events::CallbackManager> m_eventManager;
@@ -91,9 +206,37 @@ namespace isis::core::network
         std::atomic<bool> m_running{false};
         std::atomic<bool> m_stopRequested{false};
         std::atomic<size_t> m_receivedFiles{0};
+        std::atomic<size_t> m_rejectedAssociations{0};
         std::unique_ptr<std::thread> m_serverThread;
         T_ASC_Network* m_network = nullptr;
         StorageReceivedCallback m_storageCallback;
+        InstanceReceivedCallback m_instanceCallback;
+        std::shared_ptr<DimseStorageIndex> m_storageIndex;
+        std::chrono::steady_clock::time_point m_lastPurge;
+        static constexpr std::chrono::hours PurgeInterval{1};
+
+        // Worker pool: the server thread accepts and negotiates, workers serve associations
+        struct PendingAssociation
+        {
+            T_ASC_Association* assoc = nullptr;
+            std::uint64_t id = 0;
+            std::string callingAE;
+        };
+
+        std::vector<std::thread> m_workers;
+        mutable std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;   // Signals workers that an association is queued
+        std::condition_variable m_slotCondition;    // Signals the server thread that a slot was freed
+        std::deque<PendingAssociation> m_pendingAssociations;
+        std::map<std::string, int> m_associationsPerAE;
+        size_t m_inFlightAssociations = 0;
+        std::uint64_t m_nextAssociationId = 1;
+
+        mutable std::mutex m_statsMutex;
+        std::map<std::uint64_t, StorageAssociationStats> m_activeStats;
+        std::deque<StorageAssociationStats> m_completedStats;
+        static constexpr size_t MaxCompletedStats = 64;
+        static constexpr std::chrono::seconds AssociationIdleTimeout{30};
 
         enum class AssociationResult
         {
@@ -105,22 +248,29 @@ namespace isis::core::network
         // Server thread function
         void serverLoop();
 
+        // Worker thread function
+        void workerLoop();
+
+        // Serve one accepted association and release its slot
+        void serveAssociation(PendingAssociation pending);
+
         // Handle incoming association
-        AssociationResult handleAssociation(T_ASC_Association* assoc);
+        AssociationResult handleAssociation(T_ASC_Association* assoc, std::uint64_t associationId);
 
         // Handle C-STORE request
         OFCondition handleStoreRequest(T_ASC_Association* assoc,
                                        T_DIMSE_C_StoreRQ* request,
-                                       T_ASC_PresentationContextID presID);
-
-        // Save received DICOM object
-        std::string saveReceivedObject(DcmDataset* dataset,
-                                      const std::string& sopInstanceUID);
+                                       T_ASC_PresentationContextID presID,
+                                       std::uint64_t associationId);
 
         // Helper methods
         bool initializeNetwork();
         void cleanupNetwork();
         void configureAcceptedContexts(T_ASC_Association* assoc);
+        void rejectAssociation(T_ASC_Association* assoc, const char* reason);
+        void releaseSlot(const std::string& callingAE);
+        void recordObject(std::uint64_t associationId, std::uint64_t bytes, bool success);
+        void openStorageIndex();
     };
 
 } // namespace isis::core::network
@@ -64,6 +64,7 @@ namespace isis::core
 		[[nodiscard]] export std::string getDescription() const { return m_desctiption; }
 		[[nodiscard]] export std::string getDate() const { return m_date; }
 		[[nodiscard]] export std::string getNumber() const { return m_number; }
+		[[nodiscard]] export std::string getBodyPartExamined() const { return m_bodyPartExamined; }
                 [[nodiscard]] export Image* getNextSingleFrameImage(Image* t_image);
                 [[nodiscard]] export Image* getPreviousSingleFrameImage(Image* t_image);
                 [[nodiscard]] export Image* getSingleFrameImageByIndex(const int& t_index);
@@ -83,6 +84,7 @@ namespace isis::core
 		export void setDescription(const std::string& t_description) { m_desctiption = t_description; }
 		export void setDate(const std::string& t_date) { m_date = t_date; }
 		export void setNumber(const std::string& t_number) { m_number = t_number; }
+		export void setBodyPartExamined(const std::string& t_bodyPart) { m_bodyPartExamined = t_bodyPart; }
 		export void setIndex(const int& t_index) { m_index = t_index; }
 		
 		[[nodiscard]] export Image* addSingleFrameImage(std::unique_ptr<Image> t_image, bool& t_newImage);
@@ -108,6 +110,7 @@ namespace isis::core
                 std::string m_desctiption = {};
                 std::string m_date = {};
                 std::string m_number = {};
+                std::string m_bodyPartExamined = {};
                 std::set<std::unique_ptr<Image>, Image::imageCompare> m_singleFrameImages = {};
                 std::set<std::unique_ptr<Image>, Image::imageCompare> m_multiFrameImages = {};
                 mutable std::shared_mutex m_imagesMutex = {};
@@ -0,0 +1,243 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: subvolumeextractor.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the sub-volume extraction used by the 3D crop
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "subvolumeextractor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <vtkFieldData.h>
+#include <vtkPointData.h>
+
+namespace
+{
+        // The output scalars view a reusable buffer; the image carries the buffer to keep it alive
+        constexpr const char* kBufferArrayName = "SubVolumeBuffer";
+
+        void runOnThreads(int t_threads, int t_count, const std::function<void(int)>& t_work)
+        {
+                const int threads = std::clamp(
+                        t_threads > 0 ? t_threads : static_cast<int>(std::thread::hardware_concurrency()), 1, std::max(1, t_count));
+                std::atomic<int> next{0};
+                const auto worker = [&]()
+                {
+                        for (int index = next++; index < t_count; index = next++)
+                        {
+                                t_work(index);
+                        }
+                };
+                std::vector<std::thread> workers;
+                workers.reserve(static_cast<std::size_t>(threads - 1));
+                for (int index = 1; index < threads; ++index)
+                {
+                        workers.emplace_back(worker);
+                }
+                worker();
+                for (std::thread& thread : workers)
+                {
+                        thread.join();
+                }
+        }
+
+        bool isInside(const int t_inner[6], const int t_outer[6])
+        {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        if (t_inner[2 * axis] > t_inner[2 * axis + 1]
+                                || t_inner[2 * axis] < t_outer[2 * axis]
+                                || t_inner[2 * axis + 1] > t_outer[2 * axis + 1])
+                        {
+                                return false;
+                        }
+                }
+                return true;
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::SubVolumeExtractor::extentFromBounds(vtkImageData* t_image, const double t_bounds[6], int t_extent[6])
+{
+        if (!t_image)
+        {
+                return false;
+        }
+        double low[3] = {};
+        double high[3] = {};
+        for (int corner = 0; corner < 8; ++corner)
+        {
+                const double point[3] = {
+                        t_bounds[(corner & 1) ? 1 : 0],
+                        t_bounds[(corner & 2) ? 3 : 2],
+                        t_bounds[(corner & 4) ? 5 : 4]};
+                double index[3] = {};
+                t_image->TransformPhysicalPointToContinuousIndex(point, index);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        low[axis] = corner == 0 ? index[axis] : std::min(low[axis], index[axis]);
+                        high[axis] = corner == 0 ? index[axis] : std::max(high[axis], index[axis]);
+                }
+        }
+
+        int imageExtent[6] = {};
+        t_image->GetExtent(imageExtent);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+                const double first = std::max(std::floor(low[axis]), static_cast<double>(imageExtent[2 * axis]));
+                const double last = std::min(std::ceil(high[axis]), static_cast<double>(imageExtent[2 * axis + 1]));
+                if (!(first <= last))
+                {
+                        return false;
+                }
+                t_extent[2 * axis] = static_cast<int>(first);
+                t_extent[2 * axis + 1] = static_cast<int>(last);
+        }
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::core::SubVolumeExtractor::canReuseLast(const int t_extent[6], const int t_stride) const
+{
+        if (!m_last || t_stride != m_lastStride || !isInside(t_extent, m_lastExtent))
+        {
+                return false;
+        }
+        // The new box has to start on a voxel the last result kept
+        for (int axis = 0; axis < 3; ++axis)
+        {
+                if ((t_extent[2 * axis] - m_lastExtent[2 * axis]) % t_stride != 0)
+                {
+                        return false;
+                }
+        }
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> isis::core::SubVolumeExtractor::extract(
+        vtkImageData* t_full,
+        const int t_extent[6],
+        int t_stride,
+        const int t_threads)
+{
+        t_stride = std::max(t_stride, 1);
+        const bool incremental = canReuseLast(t_extent, t_stride);
+        vtkImageData* const source = incremental ? m_last.GetPointer() : t_full;
+        vtkDataArray* const scalars = source && source->GetPointData() ? source->GetPointData()->GetScalars() : nullptr;
+        if (!scalars || !scalars->GetVoidPointer(0))
+        {
+                return nullptr;
+        }
+
+        int sourceExtent[6] = {};
+        source->GetExtent(sourceExtent);
+        if (!incremental && !isInside(t_extent, sourceExtent))
+        {
+                return nullptr;
+        }
+
+        // Where the box starts in the source, and how far apart the kept voxels are there
+        int begin[3] = {};
+        int dimensions[3] = {};
+        const int step = incremental ? 1 : t_stride;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+                begin[axis] = incremental
+                        ? sourceExtent[2 * axis] + (t_extent[2 * axis] - m_lastExtent[2 * axis]) / t_stride
+                        : t_extent[2 * axis];
+                dimensions[axis] = (t_extent[2 * axis + 1] - t_extent[2 * axis]) / t_stride + 1;
+        }
+
+        const int scalarType = scalars->GetDataType();
+        const int components = scalars->GetNumberOfComponents();
+        const vtkIdType tuples = static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2];
+        const int back = m_front < 0 ? 0 : 1 - m_front;
+        vtkSmartPointer<vtkDataArray>& buffer = m_buffers[back];
+        if (!buffer || buffer->GetDataType() != scalarType || buffer->GetNumberOfComponents() != components
+                || buffer->GetNumberOfTuples() < tuples)
+        {
+                buffer = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(scalarType));
+                buffer->SetName(kBufferArrayName);
+                buffer->SetNumberOfComponents(components);
+                buffer->SetNumberOfTuples(tuples);
+        }
+
+        const std::size_t voxelBytes = static_cast<std::size_t>(components) * static_cast<std::size_t>(scalars->GetDataTypeSize());
+        const std::size_t sourceRow = static_cast<std::size_t>(sourceExtent[1] - sourceExtent[0] + 1);
+        const std::size_t sourceSlice = sourceRow * static_cast<std::size_t>(sourceExtent[3] - sourceExtent[2] + 1);
+        const std::size_t rowBytes = static_cast<std::size_t>(dimensions[0]) * voxelBytes;
+        const auto* const input = static_cast<const unsigned char*>(scalars->GetVoidPointer(0));
+        auto* const output = static_cast<unsigned char*>(buffer->GetVoidPointer(0));
+        runOnThreads(t_threads, dimensions[2], [&](int t_slice)
+        {
+                const std::size_t z = static_cast<std::size_t>(begin[2] - sourceExtent[4] + t_slice * step);
+                for (int row = 0; row < dimensions[1]; ++row)
+                {
+                        const std::size_t y = static_cast<std::size_t>(begin[1] - sourceExtent[2] + row * step);
+                        const unsigned char* from = input
+                                + (z * sourceSlice + y * sourceRow + static_cast<std::size_t>(begin[0] - sourceExtent[0])) * voxelBytes;
+                        unsigned char* to = output
+                                + (static_cast<std::size_t>(t_slice) * static_cast<std::size_t>(dimensions[1])
+                                        + static_cast<std::size_t>(row)) * rowBytes;
+                        if (step == 1)
+                        {
+                                std::memcpy(to, from, rowBytes);
+                                continue;
+                        }
+                        for (int column = 0; column < dimensions[0]; ++column, to += voxelBytes, from += voxelBytes * step)
+                        {
+                                std::memcpy(to, from, voxelBytes);
+                        }
+                }
+        });
+
+        const int firstVoxel[3] = {begin[0], begin[1], begin[2]};
+        double origin[3] = {};
+        source->TransformIndexToPhysicalPoint(firstVoxel, origin);
+        const double* const sourceSpacing = source->GetSpacing();
+
+        auto image = vtkSmartPointer<vtkImageData>::New();
+        image->SetDimensions(dimensions);
+        image->SetOrigin(origin);
+        image->SetSpacing(sourceSpacing[0] * step, sourceSpacing[1] * step, sourceSpacing[2] * step);
+        image->SetDirectionMatrix(source->GetDirectionMatrix());
+        auto view = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(scalarType));
+        view->SetName(scalars->GetName());
+        view->SetNumberOfComponents(components);
+        view->SetVoidArray(buffer->GetVoidPointer(0), tuples * components, 1);
+        image->GetPointData()->SetScalars(view);
+        image->GetFieldData()->AddArray(buffer);
+
+        m_front = back;
+        m_last = image;
+        std::copy(t_extent, t_extent + 6, m_lastExtent);
+        m_lastStride = t_stride;
+        m_lastIncremental = incremental;
+        return image;
+}
+
+//-----------------------------------------------------------------------------
+void isis::core::SubVolumeExtractor::reset()
+{
+        m_buffers[0] = nullptr;
+        m_buffers[1] = nullptr;
+        m_front = -1;
+        m_last = nullptr;
+        m_lastIncremental = false;
+}
@@ -0,0 +1,70 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: subvolumeextractor.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Copies a voxel box out of a volume, optionally keeping every n-th voxel,
+ *      so the 3D view renders only the cropped region. A box inside the last
+ *      one is copied from the last result into a reused buffer.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include "utils.h"
+
+namespace isis::core
+{
+        class export SubVolumeExtractor
+        {
+        public:
+                /**
+                 * @brief Voxel extent of t_image covering t_bounds, given in the image's
+                 * physical coordinates (origin, spacing and direction applied)
+                 * @return false when the bounds miss the image
+                 */
+                static bool extentFromBounds(vtkImageData* t_image, const double t_bounds[6], int t_extent[6]);
+
+                /**
+                 * @brief True when t_extent at t_stride can be copied from the last result
+                 * without the full volume
+                 */
+                [[nodiscard]] bool canReuseLast(const int t_extent[6], int t_stride) const;
+
+                /**
+                 * @brief Copy t_extent (voxel indices of the full volume) keeping every
+                 * t_stride-th voxel, on t_threads threads (0 for one per core)
+                 *
+                 * t_full may be null when canReuseLast() holds. Results alternate between
+                 * two buffers, so the previous result stays valid while the next one is
+                 * built, and the one before it must no longer be in use.
+                 */
+                vtkSmartPointer<vtkImageData> extract(vtkImageData* t_full, const int t_extent[6],
+                        int t_stride = 1, int t_threads = 0);
+
+                /**
+                 * @brief Drop the last result and both buffers
+                 */
+                void reset();
+
+                [[nodiscard]] bool lastWasIncremental() const { return m_lastIncremental; }
+
+        private:
+                vtkSmartPointer<vtkDataArray> m_buffers[2] = {};
+                int m_front = -1;
+                vtkSmartPointer<vtkImageData> m_last = {};
+                int m_lastExtent[6] = {0, -1, 0, -1, 0, -1};
+                int m_lastStride = 1;
+                bool m_lastIncremental = false;
+        };
+}
@@ -0,0 +1,589 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: structuredlog.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the asynchronous structured logger, file sink and
+ *      telemetry counters.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "structuredlog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <QDateTime>
+#include <QFile>
+
+namespace isis::core::utils
+{
+    namespace
+    {
+        constexpr std::size_t kMaxBatchSize = 512;
+        constexpr qint64 kFileBufferBytes = 256 * 1024;
+
+        const char* levelToString(LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::Debug: return "DEBUG";
+            case LogLevel::Info: return "INFO";
+            case LogLevel::Warning: return "WARN";
+            case LogLevel::Critical: return "CRITICAL";
+            case LogLevel::Fatal: return "FATAL";
+            default: return "UNKNOWN";
+            }
+        }
+
+        LogLevel levelFromQt(QtMsgType type)
+        {
+            switch (type)
+            {
+            case QtDebugMsg: return LogLevel::Debug;
+            case QtInfoMsg: return LogLevel::Info;
+            case QtWarningMsg: return LogLevel::Warning;
+            case QtCriticalMsg: return LogLevel::Critical;
+            case QtFatalMsg: return LogLevel::Fatal;
+            default: return LogLevel::Info;
+            }
+        }
+
+        bool isCategoryEnabled(const QLoggingCategory& category, LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::Debug: return category.isDebugEnabled();
+            case LogLevel::Info: return category.isInfoEnabled();
+            case LogLevel::Warning: return category.isWarningEnabled();
+            default: return category.isCriticalEnabled();
+            }
+        }
+
+        struct FieldFormatter
+        {
+            QString& out;
+
+            void operator()(std::int64_t v) const { out += QString::number(v); }
+            void operator()(std::uint64_t v) const { out += QString::number(v); }
+            void operator()(double v) const { out += QString::number(v, 'g', 6); }
+            void operator()(bool v) const { out += v ? QStringLiteral("true") : QStringLiteral("false"); }
+            void operator()(const std::string& v) const { appendQuoted(QString::fromStdString(v)); }
+            void operator()(const QString& v) const { appendQuoted(v); }
+
+            void appendQuoted(const QString& v) const
+            {
+                if (v.contains(QLatin1Char(' ')))
+                {
+                    out += QLatin1Char('"');
+                    out += v;
+                    out += QLatin1Char('"');
+                }
+                else
+                {
+                    out += v.isEmpty() ? QStringLiteral("n/a") : v;
+                }
+            }
+        };
+    }
+
+    QString LogRecord::format() const
+    {
+        QString line;
+        line.reserve(128);
+        line += QDateTime::fromMSecsSinceEpoch(
+            std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count())
+            .toString(Qt::ISODateWithMs);
+        line += QStringLiteral(" [");
+        line += QLatin1String(levelToString(level));
+        line += QStringLiteral("] ");
+        if (category && *category && qstrcmp(category, "default") != 0)
+        {
+            line += QLatin1String(category);
+            line += QStringLiteral(" - ");
+        }
+        if (staticMessage)
+        {
+            line += QLatin1String(staticMessage);
+        }
+        else
+        {
+            line += message;
+        }
+        for (const auto& field : fields)
+        {
+            line += QLatin1Char(' ');
+            line += QLatin1String(field.key);
+            line += QLatin1Char('=');
+            std::visit(FieldFormatter{line}, field.value);
+        }
+        return line;
+    }
+
+    // FileLogSink implementation
+
+    struct FileLogSink::Impl
+    {
+        QFile file;
+        QByteArray buffer;
+    };
+
+    FileLogSink::FileLogSink(const QString& filePath)
+        : m_impl(std::make_unique<Impl>())
+    {
+        m_impl->file.setFileName(filePath);
+        if (!m_impl->file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        {
+            std::fprintf(stderr, "[Logging] Could not open log file at %s\n",
+                         filePath.toLocal8Bit().constData());
+        }
+        m_impl->buffer.reserve(kFileBufferBytes);
+    }
+
+    FileLogSink::~FileLogSink()
+    {
+        flush();
+    }
+
+    bool FileLogSink::isOpen() const
+    {
+        return m_impl->file.isOpen();
+    }
+
+    QString FileLogSink::fileName() const
+    {
+        return m_impl->file.fileName();
+    }
+
+    void FileLogSink::write(const std::vector<LogRecord>& batch)
+    {
+        if (!m_impl->file.isOpen())
+        {
+            return;
+        }
+
+        for (const auto& record : batch)
+        {
+            m_impl->buffer += record.format().toUtf8();
+            m_impl->buffer += '\n';
+            if (m_impl->buffer.size() >= kFileBufferBytes)
+            {
+                m_impl->file.write(m_impl->buffer);
+                m_impl->buffer.clear();
+            }
+        }
+    }
+
+    void FileLogSink::flush()
+    {
+        if (!m_impl->file.isOpen())
+        {
+            return;
+        }
+        if (!m_impl->buffer.isEmpty())
+        {
+            m_impl->file.write(m_impl->buffer);
+            m_impl->buffer.clear();
+        }
+        m_impl->file.flush();
+    }
+
+    // TelemetryCounters implementation
+
+    TelemetryCounters::Counter& TelemetryCounters::counterFor(const char* name, bool isDuration)
+    {
+        // Names are string literals and counters are never removed, so each thread
+        // remembers the counter behind a literal and only takes the lock the first time
+        struct CachedCounter
+        {
+            const TelemetryCounters* owner = nullptr;
+            Counter* counter = nullptr;
+        };
+        thread_local std::unordered_map<const char*, CachedCounter> cache;
+        auto& cached = cache[name];
+        if (cached.owner == this && cached.counter)
+        {
+            return *cached.counter;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& slot = m_counters[std::string_view(name)];
+        if (!slot)
+        {
+            slot = std::make_unique<Counter>();
+            slot->isDuration = isDuration;
+        }
+        cached = {this, slot.get()};
+        return *slot;
+    }
+
+    void TelemetryCounters::increment(const char* name, std::uint64_t delta)
+    {
+        counterFor(name, false).value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void TelemetryCounters::recordDuration(const char* name, std::chrono::microseconds duration)
+    {
+        auto& counter = counterFor(name, true);
+        counter.value.fetch_add(1, std::memory_order_relaxed);
+        counter.totalMicros.fetch_add(static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count())),
+                                      std::memory_order_relaxed);
+    }
+
+    std::map<std::string, std::uint64_t> TelemetryCounters::snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<std::string, std::uint64_t> result;
+        for (const auto& [name, counter] : m_counters)
+        {
+            result.emplace(std::string(name), counter->value.load(std::memory_order_relaxed));
+        }
+        return result;
+    }
+
+    std::vector<LogField> TelemetryCounters::takeDeltas()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LogField> fields;
+        for (auto& [name, counter] : m_counters)
+        {
+            const auto value = counter->value.load(std::memory_order_relaxed);
+            const auto delta = value - counter->lastReported;
+            if (delta == 0)
+            {
+                continue;
+            }
+
+            if (counter->isDuration)
+            {
+                const auto micros = counter->totalMicros.load(std::memory_order_relaxed);
+                const auto deltaMicros = micros - counter->lastReportedMicros;
+                counter->lastReportedMicros = micros;
+                fields.emplace_back(name.data(),
+                    QStringLiteral("%1x/avg%2us").arg(delta).arg(deltaMicros / delta));
+            }
+            else
+            {
+                fields.emplace_back(name.data(), static_cast<unsigned long long>(delta));
+            }
+            counter->lastReported = value;
+        }
+        std::sort(fields.begin(), fields.end(), [](const LogField& lhs, const LogField& rhs) {
+            return qstrcmp(lhs.key, rhs.key) < 0;
+        });
+        return fields;
+    }
+
+    // StructuredLogger implementation
+
+    StructuredLogger& StructuredLogger::instance()
+    {
+        static StructuredLogger logger;
+        return logger;
+    }
+
+    StructuredLogger::~StructuredLogger()
+    {
+        shutdown();
+    }
+
+    void StructuredLogger::setSink(std::unique_ptr<LogSink> sink)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCondition.wait(lock, [this]() { return !m_writing; });
+        if (m_sink)
+        {
+            m_sink->flush();
+        }
+        m_sink = std::move(sink);
+    }
+
+    void StructuredLogger::setCategoryPolicy(const std::string& category, const CategoryPolicy& policy)
+    {
+        std::lock_guard<std::mutex> lock(m_policyMutex);
+        auto& state = m_rateStates[category];
+        state.policy = policy;
+        state.policy.sampleEvery = std::max(1, policy.sampleEvery);
+        state.tokens = policy.burst;
+        state.lastRefill = std::chrono::steady_clock::now();
+    }
+
+    void StructuredLogger::setTelemetryInterval(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_telemetryInterval = std::max(interval, std::chrono::milliseconds(100));
+        m_wakeCondition.notify_all();
+    }
+
+    void StructuredLogger::setQueueCapacity(std::size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capacity = std::max<std::size_t>(capacity, 64);
+    }
+
+    bool StructuredLogger::shouldLog(const char* category)
+    {
+        std::lock_guard<std::mutex> lock(m_policyMutex);
+        if (m_rateStates.empty())
+        {
+            return true;
+        }
+
+        auto it = m_rateStates.find(category ? category : "default");
+        if (it == m_rateStates.end())
+        {
+            return true;
+        }
+
+        auto& state = it->second;
+        if ((state.seen++ % static_cast<std::uint64_t>(state.policy.sampleEvery)) != 0)
+        {
+            state.suppressed++;
+            return false;
+        }
+
+        if (state.policy.maxPerSecond > 0.0)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const double elapsed = std::chrono::duration<double>(now - state.lastRefill).count();
+            state.lastRefill = now;
+            state.tokens = std::min(state.policy.burst, state.tokens + elapsed * state.policy.maxPerSecond);
+            if (state.tokens < 1.0)
+            {
+                state.suppressed++;
+                return false;
+            }
+            state.tokens -= 1.0;
+        }
+
+        if (state.suppressed > 0)
+        {
+            m_telemetry.increment("log.suppressed", state.suppressed);
+            state.suppressed = 0;
+        }
+        return true;
+    }
+
+    void StructuredLogger::enqueue(LogRecord&& record)
+    {
+        const bool mustKeep = record.level >= LogLevel::Critical;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ensureStarted();
+            if (m_queue.size() >= m_capacity && !mustKeep)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_queue.push_back(std::move(record));
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    void StructuredLogger::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_started)
+        {
+            if (m_sink)
+            {
+                m_sink->flush();
+            }
+            return;
+        }
+        m_flushRequested = true;
+        m_wakeCondition.notify_one();
+        m_idleCondition.wait(lock, [this]() {
+            return (m_queue.empty() && !m_writing && !m_flushRequested) || !m_started;
+        });
+    }
+
+    void StructuredLogger::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_started)
+            {
+                return;
+            }
+            m_stopRequested = true;
+        }
+        m_wakeCondition.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started = false;
+        m_stopRequested = false;
+        if (m_sink)
+        {
+            m_sink->flush();
+        }
+        m_idleCondition.notify_all();
+    }
+
+    void StructuredLogger::ensureStarted()
+    {
+        if (m_started)
+        {
+            return;
+        }
+        m_started = true;
+        m_thread = std::thread(&StructuredLogger::run, this);
+    }
+
+    void StructuredLogger::emitTelemetryLocked(std::vector<LogRecord>& batch)
+    {
+        auto fields = m_telemetry.takeDeltas();
+        const auto dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            fields.emplace_back("log.dropped", static_cast<unsigned long long>(dropped));
+        }
+        if (fields.empty())
+        {
+            return;
+        }
+
+        LogRecord record;
+        record.timestamp = std::chrono::system_clock::now();
+        record.level = LogLevel::Info;
+        record.category = "isis.telemetry";
+        record.staticMessage = "[Telemetry] Counters";
+        record.fields = std::move(fields);
+        batch.push_back(std::move(record));
+    }
+
+    void StructuredLogger::run()
+    {
+        std::vector<LogRecord> batch;
+        batch.reserve(kMaxBatchSize);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto nextTelemetry = std::chrono::steady_clock::now() + m_telemetryInterval;
+        while (true)
+        {
+            m_wakeCondition.wait_until(lock, nextTelemetry, [this]() {
+                return !m_queue.empty() || m_stopRequested || m_flushRequested;
+            });
+
+            const auto now = std::chrono::steady_clock::now();
+            const bool telemetryDue = now >= nextTelemetry || m_stopRequested;
+            const bool flushRequested = m_flushRequested;
+
+            while (!m_queue.empty() && batch.size() < kMaxBatchSize)
+            {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+            if (telemetryDue)
+            {
+                emitTelemetryLocked(batch);
+                nextTelemetry = now + m_telemetryInterval;
+            }
+
+            const bool drained = m_queue.empty();
+            m_writing = true;
+            lock.unlock();
+
+            LogSink* sink = m_sink.get();
+            if (!batch.empty())
+            {
+                if (sink)
+                {
+                    sink->write(batch);
+                }
+                else
+                {
+                    for (const auto& record : batch)
+                    {
+                        std::fprintf(stderr, "%s\n", record.format().toLocal8Bit().constData());
+                    }
+                }
+                batch.clear();
+            }
+            if (sink && drained && (flushRequested || telemetryDue))
+            {
+                sink->flush();
+            }
+
+            lock.lock();
+            m_writing = false;
+            if (flushRequested && m_queue.empty())
+            {
+                m_flushRequested = false;
+            }
+            m_idleCondition.notify_all();
+
+            if (m_stopRequested && m_queue.empty())
+            {
+                break;
+            }
+        }
+    }
+
+    void StructuredLogger::installQtMessageHandler()
+    {
+        qInstallMessageHandler([](QtMsgType type, const QMessageLogContext& context, const QString& message) {
+            auto& logger = StructuredLogger::instance();
+            const LogLevel level = levelFromQt(type);
+            const char* const category = context.category ? context.category : "default";
+            // qCDebug/qCInfo go through the same category policies as logEvent
+            if (level < LogLevel::Warning && !logger.shouldLog(category))
+            {
+                return;
+            }
+
+            LogRecord record;
+            record.timestamp = std::chrono::system_clock::now();
+            record.level = level;
+            record.category = category;
+            record.message = message;
+            if (context.function && *context.function && record.level >= LogLevel::Warning)
+            {
+                record.fields.emplace_back("function", context.function);
+            }
+
+            logger.enqueue(std::move(record));
+            if (type == QtFatalMsg)
+            {
+                logger.flush();
+                abort();
+            }
+        });
+    }
+
+    void logEvent(const QLoggingCategory& category,
+                  LogLevel level,
+                  const char* message,
+                  std::initializer_list<LogField> fields)
+    {
+        if (!isCategoryEnabled(category, level))
+        {
+            return;
+        }
+
+        auto& logger = StructuredLogger::instance();
+        if (level < LogLevel::Warning && !logger.shouldLog(category.categoryName()))
+        {
+            return;
+        }
+
+        LogRecord record;
+        record.timestamp = std::chrono::system_clock::now();
+        record.level = level;
+        record.category = category.categoryName();
+        record.staticMessage = message;
+        record.fields.assign(fields.begin(), fields.end());
+        logger.enqueue(std::move(record));
+    }
+
+} // namespace isis::core::utils
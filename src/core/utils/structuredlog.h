@@ -0,0 +1,311 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: structuredlog.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Structured, asynchronous logging with per-category rate limiting and
+ *      aggregated telemetry counters for hot ingest and render paths.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <QLoggingCategory>
+#include <QString>
+
+#include "../utils.h"
+
+namespace isis::core::utils
+{
+    /**
+     * @brief Severity of a structured log record
+     */
+    enum class LogLevel
+    {
+        Debug,
+        Info,
+        Warning,
+        Critical,
+        Fatal
+    };
+
+    /**
+     * @brief Field value kept in its native type until the sink formats it
+     */
+    using LogValue = std::variant<std::int64_t, std::uint64_t, double, bool, std::string, QString>;
+
+    /**
+     * @brief Key/value pair attached to a structured log record
+     */
+    struct LogField
+    {
+        const char* key = "";               // Must point to a string literal
+        LogValue value;
+
+        LogField(const char* k, int v) : key(k), value(static_cast<std::int64_t>(v)) {}
+        LogField(const char* k, long v) : key(k), value(static_cast<std::int64_t>(v)) {}
+        LogField(const char* k, long long v) : key(k), value(static_cast<std::int64_t>(v)) {}
+        LogField(const char* k, unsigned int v) : key(k), value(static_cast<std::uint64_t>(v)) {}
+        LogField(const char* k, unsigned long v) : key(k), value(static_cast<std::uint64_t>(v)) {}
+        LogField(const char* k, unsigned long long v) : key(k), value(static_cast<std::uint64_t>(v)) {}
+        LogField(const char* k, double v) : key(k), value(v) {}
+        LogField(const char* k, bool v) : key(k), value(v) {}
+        LogField(const char* k, const char* v) : key(k), value(std::string(v ? v : "")) {}
+        LogField(const char* k, std::string v) : key(k), value(std::move(v)) {}
+        LogField(const char* k, QString v) : key(k), value(std::move(v)) {}
+    };
+
+    /**
+     * @brief A single log record; text is produced only on the sink thread
+     */
+    struct LogRecord
+    {
+        std::chrono::system_clock::time_point timestamp;
+        LogLevel level = LogLevel::Info;
+        const char* category = "default";  // QLoggingCategory names are static
+        const char* staticMessage = nullptr; // Preferred for hot paths (no copy)
+        QString message;                     // Used for Qt message handler output
+        std::vector<LogField> fields;
+
+        /**
+         * @brief Render the record as "<time> [LEVEL] category - message key=value ..."
+         */
+        [[nodiscard]] QString format() const;
+    };
+
+    /**
+     * @brief Destination for batches of formatted records
+     */
+    class export LogSink
+    {
+    public:
+        virtual ~LogSink() = default;
+
+        /**
+         * @brief Write a batch of records (called on the logger thread only)
+         */
+        virtual void write(const std::vector<LogRecord>& batch) = 0;
+
+        /**
+         * @brief Flush buffered output to the underlying device
+         */
+        virtual void flush() = 0;
+    };
+
+    /**
+     * @brief Appends records to a text file through a large write buffer
+     */
+    class export FileLogSink final : public LogSink
+    {
+    public:
+        explicit FileLogSink(const QString& filePath);
+        ~FileLogSink() override;
+
+        [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] QString fileName() const;
+
+        void write(const std::vector<LogRecord>& batch) override;
+        void flush() override;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    /**
+     * @brief Sampling and rate-limit policy for one logging category
+     */
+    struct CategoryPolicy
+    {
+        int sampleEvery = 1;                // Keep one record out of N (1 = keep all)
+        double maxPerSecond = 0.0;          // Token bucket refill rate (0 = unlimited)
+        double burst = 20.0;                // Token bucket capacity
+    };
+
+    /**
+     * @brief Named monotonically increasing counters, emitted periodically as one record
+     */
+    class export TelemetryCounters
+    {
+    public:
+        /**
+         * @brief Add delta to the named counter (name must be a string literal)
+         */
+        void increment(const char* name, std::uint64_t delta = 1);
+
+        /**
+         * @brief Record a duration sample (count and mean are reported)
+         */
+        void recordDuration(const char* name, std::chrono::microseconds duration);
+
+        /**
+         * @brief Current totals since process start
+         */
+        [[nodiscard]] std::map<std::string, std::uint64_t> snapshot() const;
+
+        /**
+         * @brief Counters that changed since the previous call, as log fields
+         */
+        [[nodiscard]] std::vector<LogField> takeDeltas();
+
+    private:
+        struct Counter
+        {
+            std::atomic<std::uint64_t> value{0};
+            std::atomic<std::uint64_t> totalMicros{0};
+            std::uint64_t lastReported = 0;
+            std::uint64_t lastReportedMicros = 0;
+            bool isDuration = false;
+        };
+
+        Counter& counterFor(const char* name, bool isDuration);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string_view, std::unique_ptr<Counter>> m_counters;
+    };
+
+    /**
+     * @brief Process-wide structured logger with an asynchronous, bounded queue
+     *
+     * Producers never touch the file: records are pushed into a bounded queue and
+     * a dedicated thread formats and writes them in batches. When the queue is full,
+     * non-critical records are dropped and counted instead of blocking the caller.
+     */
+    class export StructuredLogger
+    {
+    public:
+        static StructuredLogger& instance();
+
+        StructuredLogger(const StructuredLogger&) = delete;
+        StructuredLogger& operator=(const StructuredLogger&) = delete;
+
+        /**
+         * @brief Replace the active sink (takes effect for the next batch)
+         */
+        void setSink(std::unique_ptr<LogSink> sink);
+
+        /**
+         * @brief Configure sampling / rate limiting for a category name
+         */
+        void setCategoryPolicy(const std::string& category, const CategoryPolicy& policy);
+
+        /**
+         * @brief Interval between telemetry summary records
+         */
+        void setTelemetryInterval(std::chrono::milliseconds interval);
+
+        /**
+         * @brief Maximum number of queued records before dropping
+         */
+        void setQueueCapacity(std::size_t capacity);
+
+        /**
+         * @brief Apply the category policy; returns false if the record should be skipped
+         */
+        bool shouldLog(const char* category);
+
+        /**
+         * @brief Enqueue a record without blocking
+         */
+        void enqueue(LogRecord&& record);
+
+        /**
+         * @brief Block until all queued records have been written and flushed
+         */
+        void flush();
+
+        /**
+         * @brief Drain the queue and stop the logger thread
+         */
+        void shutdown();
+
+        /**
+         * @brief Aggregated hot-path counters
+         */
+        TelemetryCounters& telemetry() { return m_telemetry; }
+
+        [[nodiscard]] std::uint64_t droppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Route Qt's qDebug/qInfo/... output through this logger
+         */
+        static void installQtMessageHandler();
+
+    private:
+        StructuredLogger() = default;
+        ~StructuredLogger();
+
+        struct RateState
+        {
+            CategoryPolicy policy;
+            std::uint64_t seen = 0;
+            std::uint64_t suppressed = 0;
+            double tokens = 0.0;
+            std::chrono::steady_clock::time_point lastRefill;
+        };
+
+        void ensureStarted();
+        void run();
+        void emitTelemetryLocked(std::vector<LogRecord>& batch);
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition;
+        std::condition_variable m_idleCondition;
+        std::deque<LogRecord> m_queue;
+        std::unique_ptr<LogSink> m_sink;
+        std::thread m_thread;
+        bool m_started = false;
+        bool m_stopRequested = false;
+        bool m_flushRequested = false;
+        bool m_writing = false;
+        std::size_t m_capacity = 16384;
+        std::chrono::milliseconds m_telemetryInterval{10000};
+        std::atomic<std::uint64_t> m_dropped{0};
+
+        std::mutex m_policyMutex;
+        std::unordered_map<std::string, RateState> m_rateStates;
+
+        TelemetryCounters m_telemetry;
+    };
+
+    /**
+     * @brief Shorthand for StructuredLogger::instance().telemetry()
+     */
+    inline TelemetryCounters& telemetry()
+    {
+        return StructuredLogger::instance().telemetry();
+    }
+
+    /**
+     * @brief Log a structured event if the Qt category is enabled and the policy allows it
+     *
+     * Field values are captured as-is; no string formatting happens on the caller's thread.
+     */
+    export void logEvent(const QLoggingCategory& category,
+                         LogLevel level,
+                         const char* message,
+                         std::initializer_list<LogField> fields = {});
+
+} // namespace isis::core::utils
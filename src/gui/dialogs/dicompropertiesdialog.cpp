@@ -18,12 +18,21 @@
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QFile>
 #include <QTextStream>
+#include <QtConcurrent>
+#include "../../core/series.h"
 
 namespace isis::gui::dialogs
 {
+    namespace
+    {
+        // Typing pauses this long before the tree is searched
+        constexpr int SearchDelayMs = 250;
+    }
+
     DicomPropertiesDialog::DicomPropertiesDialog(QWidget* parent)
         : QDialog(parent)
     {
@@ -32,19 +41,81 @@ namespace isis::gui::dialogs
         resize(800, 600);
     }
 
+    DicomPropertiesDialog::~DicomPropertiesDialog()
+    {
+        cancelDiff();
+    }
+
     void DicomPropertiesDialog::setupUi()
     {
         auto* mainLayout = new QVBoxLayout(this);
 
-        // Tree widget for properties
-        m_propertiesTree = new QTreeWidget(this);
-        m_propertiesTree->setColumnCount(4);
-        m_propertiesTree->setHeaderLabels({"Group", "Element", "Name", "Value"});
+        // Instance and search
+        auto* toolLayout = new QHBoxLayout();
+        m_instanceCombo = new QComboBox(this);
+        m_instanceCombo->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+        m_searchEdit = new QLineEdit(this);
+        m_searchEdit->setPlaceholderText("Search tag, name or value");
+        m_searchEdit->setClearButtonEnabled(true);
+        m_findNextButton = new QPushButton("Find Next", this);
+        m_searchTimer = new QTimer(this);
+        m_searchTimer->setSingleShot(true);
+        m_searchTimer->setInterval(SearchDelayMs);
+
+        connect(m_instanceCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+                this, &DicomPropertiesDialog::onInstanceChanged);
+        connect(m_searchEdit, &QLineEdit::textEdited, m_searchTimer, qOverload<>(&QTimer::start));
+        connect(m_searchTimer, &QTimer::timeout, this, &DicomPropertiesDialog::onSearchTextEdited);
+        connect(m_searchEdit, &QLineEdit::returnPressed, this, &DicomPropertiesDialog::onFindNext);
+        connect(m_findNextButton, &QPushButton::clicked, this, &DicomPropertiesDialog::onFindNext);
+
+        toolLayout->addWidget(m_instanceCombo, 1);
+        toolLayout->addWidget(m_searchEdit, 2);
+        toolLayout->addWidget(m_findNextButton);
+
+        // Tag tree of the selected instance
+        m_tagModel = new DicomTagModel(this);
+        m_propertiesTree = new QTreeView(this);
+        m_propertiesTree->setModel(m_tagModel);
         m_propertiesTree->setAlternatingRowColors(true);
+        m_propertiesTree->setUniformRowHeights(true);
+        m_propertiesTree->setEditTriggers(QAbstractItemView::NoEditTriggers);
         m_propertiesTree->header()->setStretchLastSection(true);
+        m_propertiesTree->setColumnWidth(DicomTagModel::TagColumn, 140);
+        m_propertiesTree->setColumnWidth(DicomTagModel::NameColumn, 220);
+        m_propertiesTree->setColumnWidth(DicomTagModel::VRColumn, 40);
 
-        connect(m_propertiesTree, &QTreeWidget::itemDoubleClicked,
+        connect(m_propertiesTree, &QTreeView::doubleClicked,
                 this, &DicomPropertiesDialog::onItemDoubleClicked);
+        connect(m_tagModel, &DicomTagModel::modifiedTagsChanged, this, [this]() {
+            m_saveButton->setEnabled(!m_tagModel->modifiedTags().isEmpty());
+        });
+
+        // Attributes that differ across the series
+        auto* diffPage = new QWidget(this);
+        auto* diffLayout = new QVBoxLayout(diffPage);
+        m_diffStatus = new QLabel(diffPage);
+        m_diffModel = new SeriesTagDiffModel(this);
+        m_diffView = new QTableView(diffPage);
+        m_diffView->setModel(m_diffModel);
+        m_diffView->setAlternatingRowColors(true);
+        m_diffView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        m_diffView->verticalHeader()->setDefaultSectionSize(m_diffView->fontMetrics().height() + 6);
+        diffLayout->addWidget(m_diffStatus);
+        diffLayout->addWidget(m_diffView);
+
+        m_searchIndexWatcher = new QFutureWatcher<std::shared_ptr<const DicomTagSearchIndex>>(this);
+        connect(m_searchIndexWatcher, &QFutureWatcher<std::shared_ptr<const DicomTagSearchIndex>>::finished,
+                this, &DicomPropertiesDialog::onSearchIndexFinished);
+
+        m_diffWatcher = new QFutureWatcher<SeriesTagDiff>(this);
+        connect(m_diffWatcher, &QFutureWatcher<SeriesTagDiff>::finished,
+                this, &DicomPropertiesDialog::onDiffFinished);
+
+        m_tabs = new QTabWidget(this);
+        m_tabs->addTab(m_propertiesTree, "Tags");
+        m_tabs->addTab(diffPage, "Series Differences");
+        connect(m_tabs, &QTabWidget::currentChanged, this, &DicomPropertiesDialog::onTabChanged);
 
         // Buttons
         auto* buttonLayout = new QHBoxLayout();
@@ -67,7 +138,8 @@ namespace isis::gui::dialogs
         buttonLayout->addWidget(m_saveButton);
         buttonLayout->addWidget(m_closeButton);
 
-        mainLayout->addWidget(m_propertiesTree);
+        mainLayout->addLayout(toolLayout);
+        mainLayout->addWidget(m_tabs);
         mainLayout->addLayout(buttonLayout);
     }
 
@@ -79,75 +151,209 @@ namespace isis::gui::dialogs
 
     void DicomPropertiesDialog::refreshProperties()
     {
-        m_propertiesTree->clear();
-        m_modifiedTags.clear();
+        cancelDiff();
+        m_diffModel->clear();
+        m_diffComputed = false;
+        m_diffStatus->clear();
+        m_instancePaths.clear();
+
+        if (m_series)
+        {
+            m_instancePaths = m_series->snapshotSingleFramePaths();
+            for (const auto& image : m_series->getMultiFrameImages())
+            {
+                if (image && !image->getImagePath().empty())
+                {
+                    m_instancePaths.push_back(image->getImagePath());
+                }
+            }
+        }
 
-        if (!m_series)
         {
+            QSignalBlocker blocker(m_instanceCombo);
+            m_instanceCombo->clear();
+            for (const auto& path : m_instancePaths)
+            {
+                m_instanceCombo->addItem(QFileInfo(QString::fromStdString(path)).fileName());
+            }
+        }
+
+        if (m_instancePaths.empty())
+        {
+            m_tagModel->clear();
             return;
         }
 
-        populateTree();
+        m_instanceCombo->setCurrentIndex(0);
+        loadInstance(0);
+        if (m_tabs->currentIndex() == 1)
+        {
+            startDiff();
+        }
+    }
+
+    void DicomPropertiesDialog::loadInstance(int row)
+    {
+        if (row < 0 || row >= static_cast<int>(m_instancePaths.size()))
+        {
+            return;
+        }
+
+        // Only the headers are read; large values stay in the file
+        QString error;
+        const QString path = QString::fromStdString(m_instancePaths[static_cast<std::size_t>(row)]);
+        if (!m_tagModel->loadFile(path, error))
+        {
+            QMessageBox::warning(this, "DICOM Properties",
+                                 QString("Could not read %1:\n%2").arg(m_instanceCombo->itemText(row), error));
+            return;
+        }
+
+        // Searching walks every element, nested sequences included; index them off the GUI thread
+        m_searchIndexWatcher->setFuture(QtConcurrent::run([path]() {
+            return std::make_shared<const DicomTagSearchIndex>(buildTagSearchIndex(path));
+        }));
+    }
+
+    void DicomPropertiesDialog::onSearchIndexFinished()
+    {
+        m_tagModel->setSearchIndex(m_searchIndexWatcher->result());
+        if (m_searchPending && m_tagModel->hasSearchIndex())
+        {
+            m_searchPending = false;
+            findFrom(QModelIndex());
+        }
+    }
+
+    void DicomPropertiesDialog::onInstanceChanged(int row)
+    {
+        if (!m_tagModel->modifiedTags().isEmpty())
+        {
+            auto reply = QMessageBox::question(
+                this, "Unsaved Changes",
+                "You have unsaved changes. Do you want to save before switching instance?",
+                QMessageBox::Yes | QMessageBox::No);
+            if (reply == QMessageBox::Yes)
+            {
+                onSaveChanges();
+            }
+        }
+        loadInstance(row);
+        if (!m_searchEdit->text().isEmpty())
+        {
+            findFrom(QModelIndex());
+        }
     }
 
-    void DicomPropertiesDialog::populateTree()
+    void DicomPropertiesDialog::onSearchTextEdited()
     {
-        // Placeholder: In a real implementation, this would iterate through
-        // DICOM tags from the series and populate the tree
+        // Incremental: every edit searches again from the top
+        findFrom(QModelIndex());
+    }
 
-        // Example tags (would come from actual DICOM data)
-        addTagToTree("0010", "0010", "Patient Name", "DOE^JOHN");
-        addTagToTree("0010", "0020", "Patient ID", "12345");
-        addTagToTree("0010", "0030", "Patient Birth Date", "19800101");
-        addTagToTree("0020", "000D", "Study Instance UID", "1.2.3.4.5...");
-        addTagToTree("0020", "000E", "Series Instance UID", "1.2.3.4.6...");
-        addTagToTree("0028", "0010", "Rows", "512");
-        addTagToTree("0028", "0011", "Columns", "512");
+    void DicomPropertiesDialog::onFindNext()
+    {
+        m_searchTimer->stop();
+        findFrom(m_propertiesTree->currentIndex());
     }
 
-    void DicomPropertiesDialog::addTagToTree(const QString& group, const QString& element,
-                                             const QString& name, const QString& value)
+    void DicomPropertiesDialog::findFrom(const QModelIndex& from)
     {
-        auto* item = new QTreeWidgetItem(m_propertiesTree);
-        item->setText(0, group);
-        item->setText(1, element);
-        item->setText(2, name);
-        item->setText(3, value);
+        const QString text = m_searchEdit->text().trimmed();
+        if (text.isEmpty())
+        {
+            return;
+        }
+        if (!m_tagModel->hasSearchIndex())
+        {
+            // Runs again when the index of the loaded instance is ready
+            m_searchPending = true;
+            return;
+        }
 
-        // Mark editable tags
-        if (isEditableTag(group, element))
+        const QModelIndex match = m_tagModel->findNext(text, from.sibling(from.row(), 0));
+        if (!match.isValid())
         {
-            item->setFlags(item->flags() | Qt::ItemIsEditable);
+            m_searchEdit->setStyleSheet("QLineEdit { background: #ffd6d6; }");
+            return;
         }
+
+        m_searchEdit->setStyleSheet(QString());
+        m_tabs->setCurrentIndex(0);
+        m_propertiesTree->setCurrentIndex(match);
+        m_propertiesTree->scrollTo(match, QAbstractItemView::PositionAtCenter);
     }
 
-    bool DicomPropertiesDialog::isEditableTag(const QString& group, const QString& element)
+    void DicomPropertiesDialog::onTabChanged(int tab)
     {
-        // Only allow editing of non-critical tags
-        // Patient name, comments, etc. are editable
-        // UIDs, image data tags are not
-        if (group == "0010" && element == "0010") return true; // Patient Name
-        if (group == "0010" && element == "0020") return true; // Patient ID
-        if (group == "0020" && element == "4000") return true; // Image Comments
+        if (tab == 1 && !m_diffComputed)
+        {
+            startDiff();
+        }
+    }
 
-        return false;
+    void DicomPropertiesDialog::startDiff()
+    {
+        if (m_diffWatcher->isRunning() || m_instancePaths.empty())
+        {
+            return;
+        }
+
+        m_diffComputed = true;
+        m_diffCancel = std::make_shared<std::atomic<bool>>(false);
+        m_diffStatus->setText(QString("Comparing %1 instance(s)...").arg(m_instancePaths.size()));
+
+        // Every header of the series is parsed; keep it off the GUI thread
+        m_diffWatcher->setFuture(QtConcurrent::run([paths = m_instancePaths, cancel = m_diffCancel]() {
+            return computeSeriesTagDiff(paths, *cancel);
+        }));
+    }
+
+    void DicomPropertiesDialog::cancelDiff()
+    {
+        if (m_diffCancel)
+        {
+            *m_diffCancel = true;
+        }
+        if (m_diffWatcher && m_diffWatcher->isRunning())
+        {
+            m_diffWatcher->waitForFinished();
+        }
     }
 
-    void DicomPropertiesDialog::onItemDoubleClicked(QTreeWidgetItem* item, int column)
+    void DicomPropertiesDialog::onDiffFinished()
     {
-        if (column == 3 && isEditableTag(item->text(0), item->text(1)))
+        if (!m_diffCancel || *m_diffCancel)
+        {
+            return;
+        }
+
+        SeriesTagDiff diff = m_diffWatcher->result();
+        QString status = QString("%1 attribute(s) differ across %2 instance(s)")
+                             .arg(diff.attributes.size())
+                             .arg(diff.instances.size());
+        if (!diff.errors.isEmpty())
         {
-            m_propertiesTree->editItem(item, column);
-            m_saveButton->setEnabled(true);
+            status += QString("; %1 file(s) could not be read").arg(diff.errors.size());
+            m_diffStatus->setToolTip(diff.errors.join('\n'));
+        }
+        m_diffStatus->setText(status);
+        m_diffModel->setDiff(std::move(diff));
+    }
 
-            QString key = item->text(0) + "," + item->text(1);
-            m_modifiedTags[key] = item->text(3);
+    void DicomPropertiesDialog::onItemDoubleClicked(const QModelIndex& index)
+    {
+        if (index.column() == DicomTagModel::ValueColumn &&
+            (m_tagModel->flags(index) & Qt::ItemIsEditable))
+        {
+            m_propertiesTree->edit(index);
         }
     }
 
     void DicomPropertiesDialog::onSaveChanges()
     {
-        if (m_modifiedTags.isEmpty())
+        const auto& modifiedTags = m_tagModel->modifiedTags();
+        if (modifiedTags.isEmpty())
         {
             return;
         }
@@ -156,10 +362,9 @@ namespace isis::gui::dialogs
         QMessageBox::information(this, "Save Changes",
                                  QString("Would save %1 modified tag(s).\n"
                                         "(Not implemented in placeholder)")
-                                 .arg(m_modifiedTags.size()));
+                                 .arg(modifiedTags.size()));
 
-        m_modifiedTags.clear();
-        m_saveButton->setEnabled(false);
+        m_tagModel->clearModifiedTags();
     }
 
     void DicomPropertiesDialog::onExportClicked()
@@ -184,18 +389,21 @@ namespace isis::gui::dialogs
 
         QTextStream out(&file);
 
-        // Simple CSV export
+        // Simple CSV export of the top-level elements
         if (filename.endsWith(".csv", Qt::CaseInsensitive))
         {
             out << "Group,Element,Name,Value\n";
 
-            for (int i = 0; i < m_propertiesTree->topLevelItemCount(); ++i)
+            for (int row = 0; row < m_tagModel->rowCount(); ++row)
             {
-                auto* item = m_propertiesTree->topLevelItem(i);
-                out << item->text(0) << ","
-                    << item->text(1) << ","
-                    << "\"" << item->text(2) << "\","
-                    << "\"" << item->text(3) << "\"\n";
+                const QString tag = m_tagModel->index(row, DicomTagModel::TagColumn).data().toString();
+                const QString name = m_tagModel->index(row, DicomTagModel::NameColumn).data().toString();
+                QString value = m_tagModel->index(row, DicomTagModel::ValueColumn).data().toString();
+                value.replace('"', "\"\"");
+                out << tag.mid(1, 4) << ","
+                    << tag.mid(6, 4) << ","
+                    << "\"" << name << "\","
+                    << "\"" << value << "\"\n";
             }
         }
 
@@ -207,7 +415,7 @@ namespace isis::gui::dialogs
 
     void DicomPropertiesDialog::onClose()
     {
-        if (!m_modifiedTags.isEmpty())
+        if (!m_tagModel->modifiedTags().isEmpty())
         {
             auto reply = QMessageBox::question(
                 this, "Unsaved Changes",
@@ -224,6 +432,7 @@ namespace isis::gui::dialogs
             }
         }
 
+        cancelDiff();
         accept();
     }
 
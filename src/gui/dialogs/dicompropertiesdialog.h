@@ -17,10 +17,21 @@
 #pragma once
 
 #include <QDialog>
-#include <QTreeWidget>
+#include <QComboBox>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QString>
-#include <QMap>
+#include <QTabWidget>
+#include <QTableView>
+#include <QTimer>
+#include <QTreeView>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dicomtagmodel.h"
 
 namespace isis::core
 {
@@ -32,8 +43,10 @@ namespace isis::gui::dialogs
     /**
      * @brief Dialog for DICOM properties visualization and editing
      *
-     * Displays DICOM tags in a tree structure with support for
-     * viewing and editing non-critical metadata.
+     * Shows every element of one instance of the series in a lazily expanded
+     * tree (see DicomTagModel), with incremental search over an index built on a
+     * worker thread, and a table of the attributes that differ between the
+     * instances, computed on a worker thread the first time its tab is shown.
      */
     class DicomPropertiesDialog : public QDialog
     {
@@ -41,7 +54,7 @@ namespace isis::gui::dialogs
 
     public:
         explicit DicomPropertiesDialog(QWidget* parent = nullptr);
-        ~DicomPropertiesDialog() override = default;
+        ~DicomPropertiesDialog() override;
 
         /**
          * @brief Set the series to display properties for
@@ -63,24 +76,45 @@ namespace isis::gui::dialogs
 
     private slots:
         void onExportClicked();
-        void onItemDoubleClicked(QTreeWidgetItem* item, int column);
+        void onItemDoubleClicked(const QModelIndex& index);
+        void onInstanceChanged(int row);
+        void onSearchTextEdited();
+        void onFindNext();
+        void onTabChanged(int tab);
+        void onDiffFinished();
+        void onSearchIndexFinished();
         void onSaveChanges();
         void onClose();
 
     private:
         void setupUi();
-        void populateTree();
-        void addTagToTree(const QString& group, const QString& element,
-                         const QString& name, const QString& value);
-        bool isEditableTag(const QString& group, const QString& element);
+        void loadInstance(int row);
+        void findFrom(const QModelIndex& from);
+        void startDiff();
+        void cancelDiff();
 
-        QTreeWidget* m_propertiesTree = nullptr;
+        QComboBox* m_instanceCombo = nullptr;
+        QLineEdit* m_searchEdit = nullptr;
+        QPushButton* m_findNextButton = nullptr;
+        QTimer* m_searchTimer = nullptr;
+        QTabWidget* m_tabs = nullptr;
+        QTreeView* m_propertiesTree = nullptr;
+        QTableView* m_diffView = nullptr;
+        QLabel* m_diffStatus = nullptr;
         QPushButton* m_exportButton = nullptr;
         QPushButton* m_saveButton = nullptr;
         QPushButton* m_closeButton = nullptr;
 
+        DicomTagModel* m_tagModel = nullptr;
+        SeriesTagDiffModel* m_diffModel = nullptr;
+        QFutureWatcher<SeriesTagDiff>* m_diffWatcher = nullptr;
+        std::shared_ptr<std::atomic<bool>> m_diffCancel;
+        bool m_diffComputed = false;
+        QFutureWatcher<std::shared_ptr<const DicomTagSearchIndex>>* m_searchIndexWatcher = nullptr;
+        bool m_searchPending = false;           // A search waits for the index of the loaded instance
+
         core::Series* m_series = nullptr;
-        QMap<QString, QString> m_modifiedTags;
+        std::vector<std::string> m_instancePaths;
     };
 
 } // namespace isis::gui::dialogs
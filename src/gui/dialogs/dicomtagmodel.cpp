@@ -0,0 +1,728 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomtagmodel.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the lazily expanded DICOM tag tree and of the
+ *      series difference table.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "dicomtagmodel.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcitem.h>
+#include <dcmtk/dcmdata/dcmetinf.h>
+#include <dcmtk/dcmdata/dcsequen.h>
+#include <algorithm>
+#include <functional>
+
+namespace isis::gui::dialogs
+{
+    namespace
+    {
+        // Longer text values are cut in the tree; the full value stays in the file
+        constexpr int MaxDisplayedChars = 256;
+        constexpr Uint32 MaxDisplayedLength = 1024;
+        constexpr Uint32 UndefinedLength = 0xFFFFFFFFu;
+
+        QString tagText(const DcmTagKey& tag)
+        {
+            return QString("(%1,%2)")
+                .arg(tag.getGroup(), 4, 16, QChar('0'))
+                .arg(tag.getElement(), 4, 16, QChar('0'))
+                .toUpper();
+        }
+
+        QString tagName(DcmObject* object)
+        {
+            // Dictionary lookup; private tags without an entry get a generic name
+            DcmTag tag(object->getTag());
+            return QString::fromLatin1(tag.getTagName());
+        }
+
+        bool isBinaryVR(DcmEVR vr)
+        {
+            switch (vr)
+            {
+            case EVR_OB:
+            case EVR_OW:
+            case EVR_OF:
+            case EVR_OD:
+            case EVR_OL:
+            case EVR_OV:
+            case EVR_UN:
+            case EVR_ox:
+            case EVR_px:
+            case EVR_pixelItem:
+            case EVR_UNKNOWN:
+            case EVR_UNKNOWN2B:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool isItem(DcmObject* object)
+        {
+            return object->ident() == EVR_item;
+        }
+
+        bool isContainer(DcmObject* object)
+        {
+            return object && !object->isLeaf();
+        }
+
+        bool loadHeaders(const QString& filePath, DcmFileFormat& file, QString& error)
+        {
+            // Pixel data and other large values are left in the file and shown as sizes
+            const OFCondition cond = file.loadFile(QFile::encodeName(filePath).constData(), EXS_Unknown,
+                                                   EGL_noChange, DicomTagModel::LoadedValueLength, ERM_autoDetect);
+            if (cond.bad())
+            {
+                error = QString::fromLatin1(cond.text());
+                return false;
+            }
+            return true;
+        }
+
+        std::vector<DcmObject*> topLevelObjects(DcmFileFormat& file)
+        {
+            std::vector<DcmObject*> objects;
+            for (DcmItem* container : {static_cast<DcmItem*>(file.getMetaInfo()),
+                                       static_cast<DcmItem*>(file.getDataset())})
+            {
+                for (DcmObject* child = container->nextInContainer(nullptr); child;
+                     child = container->nextInContainer(child))
+                {
+                    objects.push_back(child);
+                }
+            }
+            return objects;
+        }
+    }
+
+    DicomTagSearchIndex buildTagSearchIndex(const QString& filePath)
+    {
+        DicomTagSearchIndex index;
+        index.filePath = filePath;
+        DcmFileFormat file;
+        QString error;
+        if (!loadHeaders(filePath, file, error))
+        {
+            return index;
+        }
+
+        std::vector<int> path;
+        std::function<void(DcmObject*)> visit = [&](DcmObject* object) {
+            DicomTagSearchIndex::Entry entry;
+            entry.path = path;
+            if (!isItem(object) && object->ident() != EVR_pixelItem)
+            {
+                entry.text = tagText(object->getTag()) + QChar('\n') + tagName(object);
+                if (object->isLeaf())
+                {
+                    entry.text += QChar('\n') + DicomTagModel::displayValue(object);
+                }
+                entry.text = entry.text.toCaseFolded();
+            }
+            index.entries.push_back(std::move(entry));
+
+            if (isContainer(object))
+            {
+                int row = 0;
+                for (DcmObject* child = object->nextInContainer(nullptr); child;
+                     child = object->nextInContainer(child), ++row)
+                {
+                    path.push_back(row);
+                    visit(child);
+                    path.pop_back();
+                }
+            }
+        };
+
+        const auto objects = topLevelObjects(file);
+        for (int row = 0; row < static_cast<int>(objects.size()); ++row)
+        {
+            path.push_back(row);
+            visit(objects[static_cast<std::size_t>(row)]);
+            path.pop_back();
+        }
+        return index;
+    }
+
+    DicomTagModel::DicomTagModel(QObject* parent)
+        : QAbstractItemModel(parent)
+    {
+    }
+
+    DicomTagModel::~DicomTagModel() = default;
+
+    bool DicomTagModel::loadFile(const QString& filePath, QString& error)
+    {
+        beginResetModel();
+        m_root.reset();
+        m_file.reset();
+        m_modifiedTags.clear();
+        m_searchIndex.reset();
+        m_filePath = filePath;
+
+        auto file = std::make_unique<DcmFileFormat>();
+        if (!loadHeaders(filePath, *file, error))
+        {
+            m_filePath.clear();
+            endResetModel();
+            return false;
+        }
+
+        m_file = std::move(file);
+        m_root = std::make_unique<Node>();
+        m_root->fetched = true;
+        m_root->childObjects = topLevelObjects(*m_file);
+        m_root->children.resize(m_root->childObjects.size());
+        endResetModel();
+
+        emit modifiedTagsChanged();
+        return true;
+    }
+
+    void DicomTagModel::clear()
+    {
+        beginResetModel();
+        m_root.reset();
+        m_file.reset();
+        m_filePath.clear();
+        m_modifiedTags.clear();
+        m_searchIndex.reset();
+        endResetModel();
+        emit modifiedTagsChanged();
+    }
+
+    void DicomTagModel::setSearchIndex(std::shared_ptr<const DicomTagSearchIndex> index)
+    {
+        if (index && m_root && index->filePath == m_filePath)
+        {
+            m_searchIndex = std::move(index);
+        }
+    }
+
+    DicomTagModel::Node* DicomTagModel::nodeOf(const QModelIndex& index) const
+    {
+        return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+    }
+
+    DicomTagModel::Node* DicomTagModel::childNode(Node* parent, int row) const
+    {
+        auto& child = parent->children[static_cast<std::size_t>(row)];
+        if (!child)
+        {
+            child = std::make_unique<Node>();
+            child->object = parent->childObjects[static_cast<std::size_t>(row)];
+            child->parent = parent;
+            child->row = row;
+        }
+        return child.get();
+    }
+
+    QModelIndex DicomTagModel::indexOf(Node* node, int column) const
+    {
+        if (!node || node == m_root.get())
+        {
+            return QModelIndex();
+        }
+        return createIndex(node->row, column, node);
+    }
+
+    void DicomTagModel::collectChildren(Node* node) const
+    {
+        for (DcmObject* child = node->object->nextInContainer(nullptr); child;
+             child = node->object->nextInContainer(child))
+        {
+            node->childObjects.push_back(child);
+        }
+        node->children.resize(node->childObjects.size());
+    }
+
+    QModelIndex DicomTagModel::index(int row, int column, const QModelIndex& parent) const
+    {
+        Node* parentNode = nodeOf(parent);
+        if (!parentNode || row < 0 || column < 0 || column >= ColumnCount ||
+            row >= static_cast<int>(parentNode->childObjects.size()))
+        {
+            return QModelIndex();
+        }
+        return createIndex(row, column, childNode(parentNode, row));
+    }
+
+    QModelIndex DicomTagModel::parent(const QModelIndex& index) const
+    {
+        if (!index.isValid())
+        {
+            return QModelIndex();
+        }
+        return indexOf(nodeOf(index)->parent);
+    }
+
+    int DicomTagModel::rowCount(const QModelIndex& parent) const
+    {
+        if (parent.isValid() && parent.column() != 0)
+        {
+            return 0;
+        }
+        const Node* node = nodeOf(parent);
+        return node && node->fetched ? static_cast<int>(node->childObjects.size()) : 0;
+    }
+
+    int DicomTagModel::columnCount(const QModelIndex& parent) const
+    {
+        Q_UNUSED(parent);
+        return ColumnCount;
+    }
+
+    bool DicomTagModel::hasChildren(const QModelIndex& parent) const
+    {
+        if (parent.isValid() && parent.column() != 0)
+        {
+            return false;
+        }
+
+        const Node* node = nodeOf(parent);
+        if (!node)
+        {
+            return false;
+        }
+        if (node->fetched)
+        {
+            return !node->childObjects.empty();
+        }
+        // Not expanded yet: only check that the first child exists
+        return isContainer(node->object) && node->object->nextInContainer(nullptr) != nullptr;
+    }
+
+    bool DicomTagModel::canFetchMore(const QModelIndex& parent) const
+    {
+        const Node* node = nodeOf(parent);
+        return node && !node->fetched && isContainer(node->object);
+    }
+
+    void DicomTagModel::fetchMore(const QModelIndex& parent)
+    {
+        Node* node = nodeOf(parent);
+        if (!node || node->fetched || !isContainer(node->object))
+        {
+            return;
+        }
+
+        Node pending;
+        pending.object = node->object;
+        collectChildren(&pending);
+        if (pending.childObjects.empty())
+        {
+            node->fetched = true;
+            return;
+        }
+
+        beginInsertRows(parent, 0, static_cast<int>(pending.childObjects.size()) - 1);
+        node->childObjects = std::move(pending.childObjects);
+        node->children = std::move(pending.children);
+        node->fetched = true;
+        endInsertRows();
+    }
+
+    QString DicomTagModel::displayValue(DcmObject* object)
+    {
+        if (!object)
+        {
+            return QString();
+        }
+
+        switch (object->ident())
+        {
+        case EVR_SQ:
+        case EVR_pixelSQ:
+            return tr("%n item(s)", nullptr, static_cast<int>(static_cast<DcmSequenceOfItems*>(object)->card()));
+        case EVR_item:
+            return tr("%n element(s)", nullptr, static_cast<int>(static_cast<DcmItem*>(object)->card()));
+        default:
+            break;
+        }
+
+        auto* element = dynamic_cast<DcmElement*>(object);
+        if (!element)
+        {
+            return QString();
+        }
+
+        // Never read a value that was left in the file, nor copy a large one
+        const Uint32 length = element->getLengthField();
+        if (!element->valueLoaded() || isBinaryVR(element->ident()) || length > MaxDisplayedLength ||
+            element->getTag() == DCM_PixelData)
+        {
+            return tr("<%1 bytes>").arg(length == UndefinedLength ? 0u : length);
+        }
+
+        OFString value;
+        if (element->getOFStringArray(value).bad())
+        {
+            return QString();
+        }
+        QString text = QString::fromStdString(std::string(value.c_str(), value.length()));
+        if (text.size() > MaxDisplayedChars)
+        {
+            text = text.left(MaxDisplayedChars) + QChar(0x2026);
+        }
+        return text;
+    }
+
+    QVariant DicomTagModel::data(const QModelIndex& index, int role) const
+    {
+        if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole && role != Qt::EditRole))
+        {
+            return QVariant();
+        }
+
+        const Node* node = nodeOf(index);
+        DcmObject* object = node->object;
+
+        if (isItem(object) || object->ident() == EVR_pixelItem)
+        {
+            switch (index.column())
+            {
+            case TagColumn:
+                if (object->ident() == EVR_pixelItem)
+                {
+                    return node->row == 0 ? tr("Offset table") : tr("Fragment %1").arg(node->row);
+                }
+                return tr("Item %1").arg(node->row + 1);
+            case LengthColumn:
+                return object->getLengthField() == UndefinedLength ? tr("undefined")
+                                                                   : QVariant(object->getLengthField());
+            case ValueColumn:
+                return displayValue(object);
+            default:
+                return QVariant();
+            }
+        }
+
+        const DcmTagKey tag = object->getTag();
+        switch (index.column())
+        {
+        case TagColumn:
+            return tagText(tag);
+        case NameColumn:
+            return tagName(object);
+        case VRColumn:
+            return QString::fromLatin1(DcmVR(object->getVR()).getVRName());
+        case LengthColumn:
+            return object->getLengthField() == UndefinedLength ? tr("undefined")
+                                                               : QVariant(object->getLengthField());
+        case ValueColumn:
+        {
+            if (node->parent == m_root.get())
+            {
+                const auto modified = m_modifiedTags.constFind(tagText(tag).mid(1, 9));
+                if (modified != m_modifiedTags.constEnd())
+                {
+                    return modified.value();
+                }
+            }
+            return displayValue(object);
+        }
+        default:
+            return QVariant();
+        }
+    }
+
+    bool DicomTagModel::setData(const QModelIndex& index, const QVariant& value, int role)
+    {
+        if (role != Qt::EditRole || !(flags(index) & Qt::ItemIsEditable))
+        {
+            return false;
+        }
+
+        const QString key = tagText(nodeOf(index)->object->getTag()).mid(1, 9);
+        m_modifiedTags[key] = value.toString();
+        emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+        emit modifiedTagsChanged();
+        return true;
+    }
+
+    Qt::ItemFlags DicomTagModel::flags(const QModelIndex& index) const
+    {
+        Qt::ItemFlags result = QAbstractItemModel::flags(index);
+        if (!index.isValid() || index.column() != ValueColumn)
+        {
+            return result;
+        }
+
+        // Only top-level elements of the dataset, never the meta header
+        const Node* node = nodeOf(index);
+        const DcmTagKey tag = node->object->getTag();
+        if (node->parent == m_root.get() && tag.getGroup() != 0x0002 &&
+            isEditableTag(tag.getGroup(), tag.getElement()))
+        {
+            result |= Qt::ItemIsEditable;
+        }
+        return result;
+    }
+
+    QVariant DicomTagModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        {
+            return QVariant();
+        }
+
+        switch (section)
+        {
+        case TagColumn: return tr("Tag");
+        case NameColumn: return tr("Name");
+        case VRColumn: return tr("VR");
+        case LengthColumn: return tr("Length");
+        case ValueColumn: return tr("Value");
+        default: return QVariant();
+        }
+    }
+
+    bool DicomTagModel::isEditableTag(unsigned short group, unsigned short element)
+    {
+        // Only allow editing of non-critical tags
+        // Patient name, comments, etc. are editable
+        // UIDs, image data tags are not
+        if (group == 0x0010 && element == 0x0010) return true; // Patient Name
+        if (group == 0x0010 && element == 0x0020) return true; // Patient ID
+        if (group == 0x0020 && element == 0x4000) return true; // Image Comments
+
+        return false;
+    }
+
+    void DicomTagModel::clearModifiedTags()
+    {
+        if (m_modifiedTags.isEmpty())
+        {
+            return;
+        }
+        m_modifiedTags.clear();
+        if (m_root && !m_root->childObjects.empty())
+        {
+            emit dataChanged(index(0, ValueColumn),
+                             index(static_cast<int>(m_root->childObjects.size()) - 1, ValueColumn));
+        }
+        emit modifiedTagsChanged();
+    }
+
+    QModelIndex DicomTagModel::findNext(const QString& text, const QModelIndex& from)
+    {
+        if (!m_root || !m_searchIndex || text.isEmpty())
+        {
+            return QModelIndex();
+        }
+
+        // Rows from the top down to the start
+        std::vector<int> startPath;
+        for (Node* node = from.isValid() ? nodeOf(from) : nullptr; node && node != m_root.get(); node = node->parent)
+        {
+            startPath.insert(startPath.begin(), node->row);
+        }
+
+        const auto& entries = m_searchIndex->entries;
+        const QString needle = text.toCaseFolded();
+        const auto matches = [&needle](const DicomTagSearchIndex::Entry& entry) {
+            return !entry.text.isEmpty() && entry.text.contains(needle);
+        };
+
+        // After the start, then from the top; the start itself only when nothing else matches
+        const auto start = startPath.empty()
+            ? entries.end()
+            : std::lower_bound(entries.begin(), entries.end(), startPath,
+                               [](const DicomTagSearchIndex::Entry& entry, const std::vector<int>& path) {
+                                   return entry.path < path;
+                               });
+        const bool startFound = start != entries.end() && start->path == startPath;
+        auto match = std::find_if(startFound ? start + 1 : start, entries.end(), matches);
+        if (match == entries.end())
+        {
+            match = std::find_if(entries.begin(), startFound ? start : entries.end(), matches);
+            if (match == (startFound ? start : entries.end()))
+            {
+                match = startFound && matches(*start) ? start : entries.end();
+            }
+        }
+        if (match == entries.end())
+        {
+            return QModelIndex();
+        }
+
+        // Fetch only the parents of the match
+        Node* node = m_root.get();
+        for (const int row : match->path)
+        {
+            if (!node->fetched)
+            {
+                fetchMore(indexOf(node));
+            }
+            if (row >= static_cast<int>(node->childObjects.size()))
+            {
+                return QModelIndex();
+            }
+            node = childNode(node, row);
+        }
+        return indexOf(node);
+    }
+
+    SeriesTagDiff computeSeriesTagDiff(const std::vector<std::string>& filePaths, const std::atomic<bool>& cancel)
+    {
+        SeriesTagDiff diff;
+        QHash<QString, std::size_t> attributeIndex;
+        const int instanceCount = static_cast<int>(filePaths.size());
+
+        std::function<void(DcmItem*, const QString&, int)> flatten = [&](DcmItem* item, const QString& prefix,
+                                                                         int instance) {
+            for (DcmObject* object = item->nextInContainer(nullptr); object; object = item->nextInContainer(object))
+            {
+                const DcmTagKey tag = object->getTag();
+                if (tag.getElement() == 0x0000)
+                {
+                    continue;   // Group lengths depend on the encoding, not on the content
+                }
+
+                const QString path = prefix + tagText(tag);
+                if (object->ident() == EVR_SQ)
+                {
+                    auto* sequence = static_cast<DcmSequenceOfItems*>(object);
+                    for (unsigned long i = 0; i < sequence->card(); ++i)
+                    {
+                        flatten(sequence->getItem(i), path + QString("[%1].").arg(i + 1), instance);
+                    }
+                    continue;
+                }
+
+                auto inserted = attributeIndex.find(path);
+                if (inserted == attributeIndex.end())
+                {
+                    SeriesTagDiff::Attribute attribute;
+                    attribute.path = path;
+                    attribute.name = tagName(object);
+                    for (int i = 0; i < instanceCount; ++i)
+                    {
+                        attribute.values.append(QString());
+                    }
+                    inserted = attributeIndex.insert(path, diff.attributes.size());
+                    diff.attributes.push_back(std::move(attribute));
+                }
+                diff.attributes[inserted.value()].values[instance] = DicomTagModel::displayValue(object);
+            }
+        };
+
+        int parsed = 0;
+        for (int i = 0; i < instanceCount && !cancel; ++i)
+        {
+            const QString path = QString::fromStdString(filePaths[static_cast<std::size_t>(i)]);
+            diff.instances.append(QFileInfo(path).fileName());
+
+            // Headers only: everything after Pixel Data is left out
+            DcmFileFormat file;
+            const OFCondition cond = file.loadFileUntilTag(QFile::encodeName(path).constData(), EXS_Unknown,
+                                                           EGL_noChange, DicomTagModel::LoadedValueLength,
+                                                           ERM_autoDetect, DCM_PixelData);
+            if (cond.bad())
+            {
+                diff.errors.append(QString("%1: %2").arg(path, QString::fromLatin1(cond.text())));
+            }
+            else
+            {
+                flatten(file.getDataset(), QString(), i);
+            }
+            ++parsed;
+        }
+
+        // A cancelled run keeps the instances it got to
+        std::vector<SeriesTagDiff::Attribute> differing;
+        for (auto& attribute : diff.attributes)
+        {
+            attribute.values = attribute.values.mid(0, parsed);
+            if (attribute.values.count(attribute.values.value(0)) != attribute.values.size())
+            {
+                differing.push_back(std::move(attribute));
+            }
+        }
+        diff.attributes = std::move(differing);
+        return diff;
+    }
+
+    SeriesTagDiffModel::SeriesTagDiffModel(QObject* parent)
+        : QAbstractTableModel(parent)
+    {
+    }
+
+    void SeriesTagDiffModel::setDiff(SeriesTagDiff diff)
+    {
+        beginResetModel();
+        m_diff = std::move(diff);
+        endResetModel();
+    }
+
+    void SeriesTagDiffModel::clear()
+    {
+        setDiff(SeriesTagDiff());
+    }
+
+    int SeriesTagDiffModel::rowCount(const QModelIndex& parent) const
+    {
+        return parent.isValid() ? 0 : static_cast<int>(m_diff.instances.size());
+    }
+
+    int SeriesTagDiffModel::columnCount(const QModelIndex& parent) const
+    {
+        // First column: the instance
+        return parent.isValid() ? 0 : static_cast<int>(m_diff.attributes.size()) + 1;
+    }
+
+    QVariant SeriesTagDiffModel::data(const QModelIndex& index, int role) const
+    {
+        if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole))
+        {
+            return QVariant();
+        }
+
+        if (index.column() == 0)
+        {
+            return m_diff.instances.value(index.row());
+        }
+        return m_diff.attributes[static_cast<std::size_t>(index.column() - 1)].values.value(index.row());
+    }
+
+    QVariant SeriesTagDiffModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if (orientation == Qt::Vertical)
+        {
+            return role == Qt::DisplayRole ? QVariant(section + 1) : QVariant();
+        }
+        if (section == 0)
+        {
+            return role == Qt::DisplayRole ? QVariant(tr("Instance")) : QVariant();
+        }
+
+        const auto& attribute = m_diff.attributes[static_cast<std::size_t>(section - 1)];
+        if (role == Qt::DisplayRole)
+        {
+            return attribute.name.isEmpty() ? attribute.path : attribute.name;
+        }
+        if (role == Qt::ToolTipRole)
+        {
+            return attribute.path;
+        }
+        return QVariant();
+    }
+
+} // namespace isis::gui::dialogs
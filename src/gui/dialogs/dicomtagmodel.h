@@ -0,0 +1,228 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomtagmodel.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Item models of the DICOM properties dialog: a lazily expanded tree over
+ *      the parsed dataset of one instance, and a table of the attributes that
+ *      differ between the instances of a series.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QAbstractTableModel>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class DcmFileFormat;
+class DcmObject;
+
+namespace isis::gui::dialogs
+{
+    /**
+     * @brief Searchable text of every element of one file, in document order
+     *
+     * Built on a worker thread from a separate parse of the file, so a search
+     * never walks the dataset on the GUI thread.
+     */
+    struct DicomTagSearchIndex
+    {
+        struct Entry
+        {
+            std::vector<int> path;              // Row at each level, from the top
+            QString text;                       // Tag, name and value, case-folded; empty for items
+        };
+
+        QString filePath;
+        std::vector<Entry> entries;             // Document order, which is also the order of the paths
+    };
+
+    /**
+     * @brief Parse the file as DicomTagModel does and collect the text search matches against
+     */
+    DicomTagSearchIndex buildTagSearchIndex(const QString& filePath);
+
+    /**
+     * @brief Tree of the elements of one DICOM file, expanded on demand
+     *
+     * The file is parsed with values longer than LoadedValueLength left on disk,
+     * so opening a multi-frame object of any size only reads its headers. Rows
+     * wrap the DCMTK objects directly: expanding a sequence or item collects the
+     * pointers of its children in fetchMore(), and the row objects themselves are
+     * only created for the rows a view asks for. Binary and large values are shown
+     * as their size and are never read.
+     *
+     * findNext() searches tag, name and value over the whole dataset, including
+     * the sequences that were never expanded, and fetches only the path to the match.
+     * It uses the search index built for the file (see buildTagSearchIndex()).
+     */
+    class DicomTagModel : public QAbstractItemModel
+    {
+        Q_OBJECT
+
+    public:
+        enum Column
+        {
+            TagColumn,
+            NameColumn,
+            VRColumn,
+            LengthColumn,
+            ValueColumn,
+            ColumnCount
+        };
+
+        // Values up to this size are read with the headers
+        static constexpr unsigned int LoadedValueLength = 4096;
+
+        explicit DicomTagModel(QObject* parent = nullptr);
+        ~DicomTagModel() override;
+
+        /**
+         * @brief Parse a file, replacing the current one
+         * @return false (with the model empty) if the file cannot be parsed
+         */
+        bool loadFile(const QString& filePath, QString& error);
+
+        /**
+         * @brief Drop the parsed file
+         */
+        void clear();
+
+        [[nodiscard]] const QString& filePath() const { return m_filePath; }
+
+        // QAbstractItemModel interface
+        [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+        [[nodiscard]] bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+        [[nodiscard]] Qt::ItemFlags flags(const QModelIndex& index) const override;
+        [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation,
+                                          int role = Qt::DisplayRole) const override;
+        [[nodiscard]] QModelIndex index(int row, int column,
+                                        const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] QModelIndex parent(const QModelIndex& index) const override;
+        [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] bool canFetchMore(const QModelIndex& parent) const override;
+        void fetchMore(const QModelIndex& parent) override;
+
+        /**
+         * @brief Use the search index of the loaded file (an index of another file is ignored)
+         */
+        void setSearchIndex(std::shared_ptr<const DicomTagSearchIndex> index);
+        [[nodiscard]] bool hasSearchIndex() const { return m_searchIndex != nullptr; }
+
+        /**
+         * @brief Next element after 'from' (document order, wrapping) whose tag, name or value contains text
+         * @return Index of the match, its parents fetched; invalid if nothing matches or
+         *         the search index is not set yet
+         */
+        QModelIndex findNext(const QString& text, const QModelIndex& from = QModelIndex());
+
+        /**
+         * @brief Edited values of the editable top-level tags, keyed "gggg,eeee"
+         */
+        [[nodiscard]] const QMap<QString, QString>& modifiedTags() const { return m_modifiedTags; }
+        void clearModifiedTags();
+
+        /**
+         * @brief Tags the dialog allows editing (non-critical patient and image attributes)
+         */
+        static bool isEditableTag(unsigned short group, unsigned short element);
+
+        /**
+         * @brief Display text of a value; binary, large or unloaded values become their size
+         */
+        static QString displayValue(DcmObject* object);
+
+    signals:
+        void modifiedTagsChanged();
+
+    private:
+        struct Node
+        {
+            DcmObject* object = nullptr;        // Element, sequence item or pixel fragment
+            Node* parent = nullptr;
+            int row = 0;
+            bool fetched = false;
+            std::vector<DcmObject*> childObjects;
+            std::vector<std::unique_ptr<Node>> children;    // Created on first index()
+        };
+
+        [[nodiscard]] Node* nodeOf(const QModelIndex& index) const;
+        [[nodiscard]] Node* childNode(Node* parent, int row) const;
+        [[nodiscard]] QModelIndex indexOf(Node* node, int column = 0) const;
+        void collectChildren(Node* node) const;
+
+        std::unique_ptr<DcmFileFormat> m_file;
+        std::unique_ptr<Node> m_root;           // Meta header elements followed by the dataset's
+        QString m_filePath;
+        QMap<QString, QString> m_modifiedTags;
+        std::shared_ptr<const DicomTagSearchIndex> m_searchIndex;
+    };
+
+    /**
+     * @brief Attributes whose value differs between the instances of a series
+     */
+    struct SeriesTagDiff
+    {
+        struct Attribute
+        {
+            QString path;                       // "(gggg,eeee)", nested as "(gggg,eeee)[item].(gggg,eeee)"
+            QString name;
+            QStringList values;                 // One per instance; missing attributes are empty
+        };
+
+        QStringList instances;                  // Label of each instance (file name)
+        std::vector<Attribute> attributes;
+        QStringList errors;                     // Files that could not be parsed
+    };
+
+    /**
+     * @brief Parse the headers of the files and keep the attributes that are not identical in all
+     *
+     * Runs on a worker thread; stops early (returning a partial result) when cancel is set.
+     */
+    SeriesTagDiff computeSeriesTagDiff(const std::vector<std::string>& filePaths,
+                                       const std::atomic<bool>& cancel);
+
+    /**
+     * @brief One row per instance, one column per differing attribute
+     */
+    class SeriesTagDiffModel : public QAbstractTableModel
+    {
+        Q_OBJECT
+
+    public:
+        explicit SeriesTagDiffModel(QObject* parent = nullptr);
+        ~SeriesTagDiffModel() override = default;
+
+        void setDiff(SeriesTagDiff diff);
+        void clear();
+
+        [[nodiscard]] const SeriesTagDiff& diff() const { return m_diff; }
+
+        // QAbstractTableModel interface
+        [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+        [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation,
+                                          int role = Qt::DisplayRole) const override;
+        [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    private:
+        SeriesTagDiff m_diff;
+    };
+
+} // namespace isis::gui::dialogs
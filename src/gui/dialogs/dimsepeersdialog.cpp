@@ -91,6 +91,18 @@ namespace isis::gui::dialogs
         m_timeoutSpin->setSuffix(" sec");
         formLayout->addRow("Timeout:", m_timeoutSpin);
 
+        m_retrieveMethodCombo = new QComboBox(this);
+        m_retrieveMethodCombo->addItem("C-MOVE", false);
+        m_retrieveMethodCombo->addItem("C-GET", true);
+        m_retrieveMethodCombo->setToolTip("C-GET receives images on the outgoing connection; "
+                                          "use it when the PACS cannot connect back to this viewer");
+        formLayout->addRow("Retrieve Method:", m_retrieveMethodCombo);
+
+        m_compressStoreCheck = new QCheckBox("Compress when sending", this);
+        m_compressStoreCheck->setToolTip("Offer JPEG-LS lossless and Deflate when sending images; "
+                                         "reduces transfer time on slow links");
+        formLayout->addRow("Transfer:", m_compressStoreCheck);
+
         m_enabledCheck = new QCheckBox("Enabled", this);
         m_enabledCheck->setChecked(true);
         formLayout->addRow("Status:", m_enabledCheck);
@@ -437,6 +449,8 @@ namespace isis::gui::dialogs
         m_hostnameEdit->clear();
         m_portSpin->setValue(104);
         m_timeoutSpin->setValue(30);
+        m_retrieveMethodCombo->setCurrentIndex(0);
+        m_compressStoreCheck->setChecked(false);
         m_enabledCheck->setChecked(true);
         m_editingPeerId.clear();
     }
@@ -448,6 +462,8 @@ namespace isis::gui::dialogs
         m_hostnameEdit->setText(QString::fromStdString(peer.hostname));
         m_portSpin->setValue(peer.port);
         m_timeoutSpin->setValue(peer.timeout);
+        m_retrieveMethodCombo->setCurrentIndex(peer.useCGet ? 1 : 0);
+        m_compressStoreCheck->setChecked(peer.compressStore);
         m_enabledCheck->setChecked(peer.enabled);
     }
 
@@ -460,6 +476,8 @@ namespace isis::gui::dialogs
         peer.hostname = m_hostnameEdit->text().trimmed().toStdString();
         peer.port = m_portSpin->value();
         peer.timeout = m_timeoutSpin->value();
+        peer.useCGet = m_retrieveMethodCombo->currentData().toBool();
+        peer.compressStore = m_compressStoreCheck->isChecked();
         peer.enabled = m_enabledCheck->isChecked();
 
         // Generate ID if not editing
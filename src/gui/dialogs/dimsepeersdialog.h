@@ -22,6 +22,7 @@
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QComboBox>
 #include <memory>
 #include "../../core/network/dimseconfig.h"
 #include "../../core/network/dimseservices.h"
@@ -87,6 +88,8 @@ namespace isis::gui::dialogs
         QLineEdit* m_hostnameEdit = nullptr;
         QSpinBox* m_portSpin = nullptr;
         QSpinBox* m_timeoutSpin = nullptr;
+        QComboBox* m_retrieveMethodCombo = nullptr;
+        QCheckBox* m_compressStoreCheck = nullptr;
         QCheckBox* m_enabledCheck = nullptr;
 
         // Data
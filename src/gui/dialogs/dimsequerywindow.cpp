@@ -23,11 +23,51 @@
 #include <QDate>
 #include <QApplication>
 #include <QtConcurrent>
-#include <QPointer>
+#include <set>
 #include "dimsepeersdialog.h"
 
 namespace isis::gui::dialogs
 {
+    namespace
+    {
+        /**
+         * @brief Outcome of a series/instance C-FIND run for the results tree
+         */
+        template <typename T>
+        struct BrowseResult
+        {
+            core::network::DimseStatus status = core::network::DimseStatus::Failure;
+            std::string error;
+            std::vector<T> items;
+        };
+
+        QString priorityText(core::network::RetrievePriority priority)
+        {
+            switch (priority)
+            {
+            case core::network::RetrievePriority::Interactive: return "Interactive";
+            case core::network::RetrievePriority::Prefetch: return "Prefetch";
+            default: return "Background";
+            }
+        }
+
+        QString stateText(const core::network::RetrieveJobStatus& job)
+        {
+            using State = core::network::RetrieveJobState;
+            switch (job.state)
+            {
+            case State::Queued:
+                return job.attempts > 0 ? QString("Retrying (%1)").arg(job.attempts + 1) : QString("Queued");
+            case State::Running: return "Running";
+            case State::Completed:
+                return job.seriesJobs > 0 ? QString("Split into %1 series").arg(job.seriesJobs) : QString("Completed");
+            case State::Skipped: return "Already local";
+            case State::Failed: return "Failed";
+            default: return "Cancelled";
+            }
+        }
+    }
+
     DimseQueryWindow::DimseQueryWindow(QWidget* parent)
         : QDialog(parent)
     {
@@ -37,6 +77,33 @@ namespace isis::gui::dialogs
 
         // Create event manager
         m_eventManager = std::make_shared<core::events::CallbackManager>();
+
+        m_queryWatcher = new QFutureWatcher<core::network::DimseStatus>(this);
+        connect(m_queryWatcher, &QFutureWatcher<core::network::DimseStatus>::finished,
+                this, &DimseQueryWindow::onQueryFinished);
+
+        m_resultFlushTimer = new QTimer(this);
+        m_resultFlushTimer->setInterval(100);
+        connect(m_resultFlushTimer, &QTimer::timeout, this, &DimseQueryWindow::flushPendingResults);
+
+        // The queue is polled: jobs progress on scheduler threads that may outlive this window
+        m_transfersTimer = new QTimer(this);
+        m_transfersTimer->setInterval(500);
+        connect(m_transfersTimer, &QTimer::timeout, this, &DimseQueryWindow::refreshTransfers);
+        m_transfersTimer->start();
+    }
+
+    DimseQueryWindow::~DimseQueryWindow()
+    {
+        // The query thread appends to members of this window; stop it before they go away
+        if (m_queryWatcher && m_queryWatcher->isRunning())
+        {
+            if (m_queryService)
+            {
+                m_queryService->cancelQuery();
+            }
+            m_queryWatcher->waitForFinished();
+        }
     }
 
     void DimseQueryWindow::setDimseConfig(std::shared_ptr<core::network::DimseConfig> config)
@@ -54,11 +121,22 @@ namespace isis::gui::dialogs
         {
             m_queryService = std::make_shared<core::network::DimseQueryService>(
                 m_connectionPool, m_eventManager);
-            m_retrieveService = std::make_shared<core::network::DimseRetrieveService>(
-                m_connectionPool, m_eventManager);
+            if (!m_retrieveScheduler)
+            {
+                // Standalone use: the queue lives (and is cancelled) with this window
+                m_retrieveScheduler = std::make_shared<core::network::DimseRetrieveScheduler>(
+                    m_connectionPool, m_eventManager);
+                m_retrieveScheduler->start();
+            }
         }
     }
 
+    void DimseQueryWindow::setRetrieveScheduler(std::shared_ptr<core::network::DimseRetrieveScheduler> scheduler)
+    {
+        m_retrieveScheduler = scheduler;
+        refreshTransfers();
+    }
+
     void DimseQueryWindow::setRetrieveCallback(std::function<void(const std::string&)> callback)
     {
         m_retrieveCallback = callback;
@@ -140,6 +218,11 @@ namespace isis::gui::dialogs
         connect(m_queryButton, &QPushButton::clicked, this, &DimseQueryWindow::onQuery);
         queryButtonLayout->addWidget(m_queryButton);
 
+        m_stopQueryButton = new QPushButton("Stop", this);
+        m_stopQueryButton->setEnabled(false);
+        connect(m_stopQueryButton, &QPushButton::clicked, this, &DimseQueryWindow::onStopQuery);
+        queryButtonLayout->addWidget(m_stopQueryButton);
+
         m_clearButton = new QPushButton("Clear Filters", this);
         connect(m_clearButton, &QPushButton::clicked, this, &DimseQueryWindow::onClearFilters);
         queryButtonLayout->addWidget(m_clearButton);
@@ -151,22 +234,44 @@ namespace isis::gui::dialogs
         auto* resultsGroup = new QGroupBox("Search Results", this);
         auto* resultsLayout = new QVBoxLayout();
 
-        m_resultsTable = new QTableWidget(this);
-        m_resultsTable->setColumnCount(8);
-        m_resultsTable->setHorizontalHeaderLabels({
-            "Patient Name", "Patient ID", "Study Date", "Study Description",
-            "Accession #", "Modality", "# Series", "# Images"
-        });
-        m_resultsTable->horizontalHeader()->setStretchLastSection(true);
-        m_resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-        m_resultsTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
-        m_resultsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
-        connect(m_resultsTable, &QTableWidget::cellDoubleClicked,
+        // Quick filter over the results already received (also applies to rows still arriving)
+        m_resultsFilterEdit = new QLineEdit(this);
+        m_resultsFilterEdit->setPlaceholderText("Filter results...");
+        m_resultsFilterEdit->setClearButtonEnabled(true);
+        resultsLayout->addWidget(m_resultsFilterEdit);
+
+        m_resultsModel = new RemoteStudyModel(this);
+        connect(m_resultsModel, &RemoteStudyModel::seriesRequested,
+                this, &DimseQueryWindow::onSeriesRequested);
+        connect(m_resultsModel, &RemoteStudyModel::instancesRequested,
+                this, &DimseQueryWindow::onInstancesRequested);
+
+        m_resultsProxy = new RemoteStudyFilterProxy(this);
+        m_resultsProxy->setSourceModel(m_resultsModel);
+        m_resultsProxy->setFilterKeyColumn(-1);
+        m_resultsProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+        m_resultsProxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+        m_resultsProxy->setDynamicSortFilter(true);
+        connect(m_resultsFilterEdit, &QLineEdit::textChanged,
+                m_resultsProxy, &QSortFilterProxyModel::setFilterFixedString);
+
+        // Expanding a study/series issues the next-level C-FIND on demand
+        m_resultsView = new QTreeView(this);
+        m_resultsView->setModel(m_resultsProxy);
+        m_resultsView->setUniformRowHeights(true);
+        m_resultsView->setExpandsOnDoubleClick(false);
+        m_resultsView->setSortingEnabled(true);
+        m_resultsView->sortByColumn(RemoteStudyModel::StudyDateColumn, Qt::DescendingOrder);
+        m_resultsView->header()->setStretchLastSection(true);
+        m_resultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+        m_resultsView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        m_resultsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        connect(m_resultsView, &QTreeView::doubleClicked,
                 this, &DimseQueryWindow::onResultDoubleClicked);
-        connect(m_resultsTable, &QTableWidget::itemSelectionChanged,
+        connect(m_resultsView->selectionModel(), &QItemSelectionModel::selectionChanged,
                 this, &DimseQueryWindow::onResultSelectionChanged);
 
-        resultsLayout->addWidget(m_resultsTable);
+        resultsLayout->addWidget(m_resultsView);
 
         // Status bar
         auto* statusLayout = new QHBoxLayout();
@@ -180,6 +285,42 @@ namespace isis::gui::dialogs
         resultsGroup->setLayout(resultsLayout);
         mainLayout->addWidget(resultsGroup, 1);
 
+        // Retrieve queue: interactive requests run first, at most a few per peer
+        auto* transfersGroup = new QGroupBox("Retrieve Queue", this);
+        auto* transfersLayout = new QVBoxLayout();
+
+        m_transfersView = new QTreeWidget(this);
+        m_transfersView->setColumnCount(5);
+        m_transfersView->setHeaderLabels({"Item", "Priority", "State", "Progress", "Throughput"});
+        m_transfersView->setRootIsDecorated(false);
+        m_transfersView->setUniformRowHeights(true);
+        m_transfersView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        m_transfersView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+        m_transfersView->header()->setStretchLastSection(false);
+        m_transfersView->setMaximumHeight(160);
+        transfersLayout->addWidget(m_transfersView);
+
+        auto* transferButtonLayout = new QHBoxLayout();
+        transferButtonLayout->addStretch();
+        m_prioritizeTransferButton = new QPushButton("Move to Front", this);
+        m_prioritizeTransferButton->setEnabled(false);
+        connect(m_prioritizeTransferButton, &QPushButton::clicked, this, &DimseQueryWindow::onPrioritizeTransfer);
+        transferButtonLayout->addWidget(m_prioritizeTransferButton);
+        m_cancelTransferButton = new QPushButton("Cancel Transfer", this);
+        m_cancelTransferButton->setEnabled(false);
+        connect(m_cancelTransferButton, &QPushButton::clicked, this, &DimseQueryWindow::onCancelTransfer);
+        transferButtonLayout->addWidget(m_cancelTransferButton);
+        transfersLayout->addLayout(transferButtonLayout);
+
+        connect(m_transfersView, &QTreeWidget::itemSelectionChanged, this, [this]() {
+            const bool hasSelection = !m_transfersView->selectedItems().isEmpty();
+            m_prioritizeTransferButton->setEnabled(hasSelection);
+            m_cancelTransferButton->setEnabled(hasSelection);
+        });
+
+        transfersGroup->setLayout(transfersLayout);
+        mainLayout->addWidget(transfersGroup);
+
         // Action buttons
         auto* actionButtonLayout = new QHBoxLayout();
 
@@ -270,34 +411,79 @@ namespace isis::gui::dialogs
         clearResults();
         m_queryInProgress = true;
         setQueryEnabled(false);
+        m_stopQueryButton->setEnabled(true);
         updateProgressStatus("Searching...");
         m_progressBar->setVisible(true);
         m_progressBar->setRange(0, 0); // Indeterminate
 
-        // Perform query asynchronously
-        auto future = QtConcurrent::run([this, peer, filter]() {
+        // Copy everything the query thread needs; matches are handed over through m_pendingResults
+        auto queryService = m_queryService;
+        auto localAE = m_config->getLocalAEConfig();
+        auto peerCopy = *peer;
+
+        m_queryWatcher->setFuture(QtConcurrent::run([this, queryService, localAE, peerCopy, filter]() {
             std::vector<core::network::RemoteStudyInfo> results;
-            auto status = m_queryService->queryStudies(*peer, m_config->getLocalAEConfig(),
-                                                       filter, results);
-            return std::make_pair(status, results);
-        });
+            return queryService->queryStudies(
+                peerCopy, localAE, filter, results,
+                [this](const core::network::RemoteStudyInfo& study) {
+                    std::lock_guard<std::mutex> lock(m_pendingMutex);
+                    m_pendingResults.push_back(study);
+                });
+        }));
+
+        m_resultFlushTimer->start();
+    }
+
+    void DimseQueryWindow::onStopQuery()
+    {
+        if (!m_queryInProgress || !m_queryService)
+            return;
+
+        m_queryService->cancelQuery();
+        m_stopQueryButton->setEnabled(false);
+        updateProgressStatus("Cancelling...");
+    }
+
+    void DimseQueryWindow::flushPendingResults()
+    {
+        std::vector<core::network::RemoteStudyInfo> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            batch.swap(m_pendingResults);
+        }
+
+        if (batch.empty())
+            return;
 
-        // Wait for completion with event processing
-        while (!future.isFinished())
+        m_resultsModel->appendStudies(std::move(batch));
+        m_retrieveAllButton->setEnabled(m_resultsModel->studyCount() > 0);
+
+        if (m_queryInProgress)
         {
-            QApplication::processEvents();
+            updateProgressStatus(QString("Searching... %1 studies received").arg(m_resultsModel->studyCount()));
         }
+    }
 
-        auto [status, results] = future.result();
+    void DimseQueryWindow::onQueryFinished()
+    {
+        m_resultFlushTimer->stop();
+        flushPendingResults();
 
         m_queryInProgress = false;
         setQueryEnabled(true);
+        m_stopQueryButton->setEnabled(false);
         m_progressBar->setVisible(false);
 
+        const auto status = m_queryWatcher->result();
+        const int found = m_resultsModel->studyCount();
+
         if (status == core::network::DimseStatus::Success)
         {
-            populateResults(results);
-            updateProgressStatus(QString("Found %1 studies").arg(results.size()));
+            updateProgressStatus(QString("Found %1 studies").arg(found));
+        }
+        else if (status == core::network::DimseStatus::Cancelled)
+        {
+            updateProgressStatus(QString("Query cancelled (%1 studies received)").arg(found));
         }
         else
         {
@@ -326,34 +512,44 @@ namespace isis::gui::dialogs
 
     void DimseQueryWindow::onRetrieve()
     {
-        auto selectedRows = getSelectedStudyRows();
-        if (selectedRows.empty())
+        const auto requests = getSelectedRetrieveRequests();
+        if (requests.empty())
             return;
 
-        for (int row : selectedRows)
+        for (const auto& request : requests)
         {
-            if (row >= 0 && row < static_cast<int>(m_queryResults.size()))
-            {
-                retrieveStudy(m_queryResults[row]);
-            }
+            startRetrieve(request, core::network::RetrievePriority::Interactive);
         }
+
+        const QString what = requests.size() == 1
+            ? requests.front().label
+            : QString("%1 selections").arg(requests.size());
+        updateProgressStatus(QString("Queued %1; files are imported automatically when received").arg(what));
     }
 
     void DimseQueryWindow::onRetrieveAll()
     {
-        if (m_queryResults.empty())
+        if (m_resultsModel->studyCount() == 0)
             return;
 
+        // Snapshot: more results may still arrive while the confirmation is shown
+        const std::vector<core::network::RemoteStudyInfo> studies = m_resultsModel->studies();
+
         auto reply = QMessageBox::question(this, "Confirm Retrieve All",
-            QString("Are you sure you want to retrieve all %1 studies?").arg(m_queryResults.size()),
+            QString("Are you sure you want to retrieve all %1 studies?").arg(studies.size()),
             QMessageBox::Yes | QMessageBox::No);
 
         if (reply == QMessageBox::Yes)
         {
-            for (const auto& study : m_queryResults)
+            // Bulk transfers yield to anything the user asks for afterwards
+            for (const auto& study : studies)
             {
-                retrieveStudy(study);
+                RetrieveRequest request;
+                request.target = core::network::RetrieveTarget(study.studyInstanceUID);
+                request.label = QString("study for %1").arg(QString::fromStdString(study.patientName));
+                startRetrieve(request, core::network::RetrievePriority::Background);
             }
+            updateProgressStatus(QString("Queued %1 studies").arg(studies.size()));
         }
     }
 
@@ -364,18 +560,141 @@ namespace isis::gui::dialogs
 
     void DimseQueryWindow::onResultSelectionChanged()
     {
-        bool hasSelection = !m_resultsTable->selectedItems().isEmpty();
+        bool hasSelection = m_resultsView->selectionModel()->hasSelection();
         m_retrieveButton->setEnabled(hasSelection);
-        m_retrieveAllButton->setEnabled(!m_queryResults.empty());
+        m_retrieveAllButton->setEnabled(m_resultsModel->studyCount() > 0);
+    }
+
+    void DimseQueryWindow::onResultDoubleClicked(const QModelIndex& index)
+    {
+        const QModelIndex sourceIndex = m_resultsProxy->mapToSource(index);
+        if (!sourceIndex.isValid())
+            return;
+
+        const RetrieveRequest request = retrieveRequestFor(sourceIndex);
+        if (request.target.studyInstanceUID.empty())
+            return;
+
+        startRetrieve(request, core::network::RetrievePriority::Interactive);
+        updateProgressStatus(QString("Queued %1; files are imported automatically when received")
+                                 .arg(request.label));
     }
 
-    void DimseQueryWindow::onResultDoubleClicked(int row, int column)
+    void DimseQueryWindow::onSeriesRequested(const QString& studyInstanceUID)
     {
-        Q_UNUSED(column);
-        if (row >= 0 && row < static_cast<int>(m_queryResults.size()))
+        const std::string studyUID = studyInstanceUID.toStdString();
+        const QString peerId = m_peerCombo->currentData().toString();
+        const std::string cacheKey = peerId.toStdString() + "|" + studyUID;
+
+        auto cached = m_seriesCache.find(cacheKey);
+        if (cached != m_seriesCache.end())
         {
-            retrieveStudy(m_queryResults[row]);
+            m_resultsModel->setSeries(studyUID, cached->second);
+            return;
         }
+
+        const auto* peer = m_config ? m_config->getPeer(peerId.toStdString()) : nullptr;
+        if (!peer || !m_connectionPool)
+        {
+            m_resultsModel->setChildrenFailed(studyUID);
+            return;
+        }
+
+        // One service per request: expansions may overlap each other and the study search
+        auto service = std::make_shared<core::network::DimseQueryService>(m_connectionPool, m_eventManager);
+        auto localAE = m_config->getLocalAEConfig();
+        auto peerCopy = *peer;
+
+        using Result = BrowseResult<core::network::RemoteSeriesInfo>;
+        auto* watcher = new QFutureWatcher<Result>(this);
+        connect(watcher, &QFutureWatcher<Result>::finished, this,
+                [this, watcher, peerId, studyUID, cacheKey]() {
+            Result result = watcher->result();
+            watcher->deleteLater();
+
+            if (result.status != core::network::DimseStatus::Success)
+            {
+                m_resultsModel->setChildrenFailed(studyUID);
+                updateProgressStatus("Series query failed: " + QString::fromStdString(result.error));
+                return;
+            }
+
+            m_seriesCache[cacheKey] = result.items;
+            if (m_peerCombo->currentData().toString() != peerId)
+                return;
+
+            const int count = static_cast<int>(result.items.size());
+            m_resultsModel->setSeries(studyUID, std::move(result.items));
+            updateProgressStatus(QString("Loaded %1 series").arg(count));
+        });
+
+        watcher->setFuture(QtConcurrent::run([service, peerCopy, localAE, studyUID]() {
+            Result result;
+            result.status = service->querySeries(peerCopy, localAE, studyUID, result.items);
+            result.error = service->getLastError();
+            return result;
+        }));
+
+        updateProgressStatus("Loading series...");
+    }
+
+    void DimseQueryWindow::onInstancesRequested(const QString& studyInstanceUID,
+                                                const QString& seriesInstanceUID)
+    {
+        const std::string studyUID = studyInstanceUID.toStdString();
+        const std::string seriesUID = seriesInstanceUID.toStdString();
+        const QString peerId = m_peerCombo->currentData().toString();
+        const std::string cacheKey = peerId.toStdString() + "|" + seriesUID;
+
+        auto cached = m_instanceCache.find(cacheKey);
+        if (cached != m_instanceCache.end())
+        {
+            m_resultsModel->setInstances(studyUID, seriesUID, cached->second);
+            return;
+        }
+
+        const auto* peer = m_config ? m_config->getPeer(peerId.toStdString()) : nullptr;
+        if (!peer || !m_connectionPool)
+        {
+            m_resultsModel->setChildrenFailed(studyUID, seriesUID);
+            return;
+        }
+
+        auto service = std::make_shared<core::network::DimseQueryService>(m_connectionPool, m_eventManager);
+        auto localAE = m_config->getLocalAEConfig();
+        auto peerCopy = *peer;
+
+        using Result = BrowseResult<core::network::RemoteInstanceInfo>;
+        auto* watcher = new QFutureWatcher<Result>(this);
+        connect(watcher, &QFutureWatcher<Result>::finished, this,
+                [this, watcher, peerId, studyUID, seriesUID, cacheKey]() {
+            Result result = watcher->result();
+            watcher->deleteLater();
+
+            if (result.status != core::network::DimseStatus::Success)
+            {
+                m_resultsModel->setChildrenFailed(studyUID, seriesUID);
+                updateProgressStatus("Instance query failed: " + QString::fromStdString(result.error));
+                return;
+            }
+
+            m_instanceCache[cacheKey] = result.items;
+            if (m_peerCombo->currentData().toString() != peerId)
+                return;
+
+            const int count = static_cast<int>(result.items.size());
+            m_resultsModel->setInstances(studyUID, seriesUID, std::move(result.items));
+            updateProgressStatus(QString("Loaded %1 instances").arg(count));
+        });
+
+        watcher->setFuture(QtConcurrent::run([service, peerCopy, localAE, studyUID, seriesUID]() {
+            Result result;
+            result.status = service->queryInstances(peerCopy, localAE, studyUID, seriesUID, result.items);
+            result.error = service->getLastError();
+            return result;
+        }));
+
+        updateProgressStatus("Loading instances...");
     }
 
     void DimseQueryWindow::onManagePeers()
@@ -401,33 +720,13 @@ namespace isis::gui::dialogs
         refreshPeerList(currentPeerId);
     }
 
-    void DimseQueryWindow::populateResults(const std::vector<core::network::RemoteStudyInfo>& studies)
+    void DimseQueryWindow::clearResults()
     {
-        m_queryResults = studies;
-        m_resultsTable->setRowCount(0);
-
-        for (const auto& study : studies)
         {
-            int row = m_resultsTable->rowCount();
-            m_resultsTable->insertRow(row);
-
-            m_resultsTable->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(study.patientName)));
-            m_resultsTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(study.patientID)));
-            m_resultsTable->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(study.studyDate)));
-            m_resultsTable->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(study.studyDescription)));
-            m_resultsTable->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(study.accessionNumber)));
-            m_resultsTable->setItem(row, 5, new QTableWidgetItem(QString::fromStdString(study.modality)));
-            m_resultsTable->setItem(row, 6, new QTableWidgetItem(QString::number(study.numberOfSeries)));
-            m_resultsTable->setItem(row, 7, new QTableWidgetItem(QString::number(study.numberOfInstances)));
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            m_pendingResults.clear();
         }
-
-        m_resultsTable->resizeColumnsToContents();
-    }
-
-    void DimseQueryWindow::clearResults()
-    {
-        m_queryResults.clear();
-        m_resultsTable->setRowCount(0);
+        m_resultsModel->clear();
         m_retrieveButton->setEnabled(false);
         m_retrieveAllButton->setEnabled(false);
         updateProgressStatus("Ready");
@@ -459,81 +758,262 @@ namespace isis::gui::dialogs
         return filter;
     }
 
-    std::vector<int> DimseQueryWindow::getSelectedStudyRows()
+    DimseQueryWindow::RetrieveRequest DimseQueryWindow::retrieveRequestFor(const QModelIndex& sourceIndex) const
     {
-        std::vector<int> rows;
-        auto selectedItems = m_resultsTable->selectedItems();
+        RetrieveRequest request;
+        const auto* study = m_resultsModel->studyAt(sourceIndex);
+        if (!study)
+            return request;
+
+        auto& target = request.target;
+        target.studyInstanceUID = study->studyInstanceUID;
+        request.label = QString("study for %1").arg(QString::fromStdString(study->patientName));
 
-        QSet<int> uniqueRows;
-        for (auto* item : selectedItems)
+        if (const auto* series = m_resultsModel->seriesAt(sourceIndex))
         {
-            uniqueRows.insert(item->row());
+            target.seriesInstanceUID = series->seriesInstanceUID;
+            request.label = QString("series %1 for %2")
+                                .arg(QString::fromStdString(series->seriesNumber))
+                                .arg(QString::fromStdString(study->patientName));
         }
 
-        rows.reserve(uniqueRows.size());
-        for (int row : uniqueRows)
+        if (const auto* instance = m_resultsModel->instanceAt(sourceIndex))
         {
-            rows.push_back(row);
+            target.sopInstanceUIDs.push_back(instance->sopInstanceUID);
+            request.label = QString("image %1 of %2")
+                                .arg(QString::fromStdString(instance->instanceNumber))
+                                .arg(request.label);
         }
 
-        return rows;
+        return request;
     }
 
-    void DimseQueryWindow::retrieveStudy(const core::network::RemoteStudyInfo& study)
+    std::vector<DimseQueryWindow::RetrieveRequest> DimseQueryWindow::getSelectedRetrieveRequests()
     {
-        if (!m_config || !m_retrieveService)
+        using Level = RemoteStudyModel::Level;
+
+        std::vector<QModelIndex> selected;
+        for (const QModelIndex& index : m_resultsView->selectionModel()->selectedRows())
+        {
+            // Map view rows (sorted/filtered) back to model rows
+            const QModelIndex sourceIndex = m_resultsProxy->mapToSource(index);
+            if (sourceIndex.isValid())
+            {
+                selected.push_back(sourceIndex);
+            }
+        }
+
+        // A selected study covers its series, a selected series covers its instances
+        std::set<std::string> coveredStudies;
+        std::set<std::string> coveredSeries;
+        for (const auto& index : selected)
+        {
+            if (m_resultsModel->levelOf(index) == Level::Study)
+                coveredStudies.insert(m_resultsModel->studyAt(index)->studyInstanceUID);
+        }
+        for (const auto& index : selected)
+        {
+            if (m_resultsModel->levelOf(index) == Level::Series &&
+                coveredStudies.count(m_resultsModel->studyAt(index)->studyInstanceUID) == 0)
+                coveredSeries.insert(m_resultsModel->seriesAt(index)->seriesInstanceUID);
+        }
+
+        std::vector<RetrieveRequest> requests;
+        std::map<std::string, std::size_t> studyRequestByUID;
+        std::map<std::string, std::size_t> instanceRequestBySeries;
+
+        for (const auto& index : selected)
+        {
+            if (m_resultsModel->levelOf(index) == Level::Study)
+            {
+                RetrieveRequest request = retrieveRequestFor(index);
+                studyRequestByUID.emplace(request.target.studyInstanceUID, requests.size());
+                requests.push_back(std::move(request));
+            }
+        }
+
+        for (const auto& index : selected)
+        {
+            RetrieveRequest request = retrieveRequestFor(index);
+            const auto& target = request.target;
+
+            switch (m_resultsModel->levelOf(index))
+            {
+            case Level::Series:
+            {
+                // Series selected together with their study are moved ahead of its other series
+                auto study = studyRequestByUID.find(target.studyInstanceUID);
+                if (study != studyRequestByUID.end())
+                    requests[study->second].firstSeriesUIDs.push_back(target.seriesInstanceUID);
+                else
+                    requests.push_back(std::move(request));
+                break;
+            }
+            case Level::Instance:
+            {
+                if (coveredStudies.count(target.studyInstanceUID) != 0 ||
+                    coveredSeries.count(target.seriesInstanceUID) != 0)
+                    break;
+
+                // Instances of the same series are moved with one IMAGE level request
+                auto it = instanceRequestBySeries.find(target.seriesInstanceUID);
+                if (it == instanceRequestBySeries.end())
+                {
+                    instanceRequestBySeries.emplace(target.seriesInstanceUID, requests.size());
+                    requests.push_back(std::move(request));
+                }
+                else
+                {
+                    auto& grouped = requests[it->second];
+                    grouped.target.sopInstanceUIDs.push_back(target.sopInstanceUIDs.front());
+                    const auto* series = m_resultsModel->seriesAt(index);
+                    grouped.label = QString("%1 images of series %2")
+                                        .arg(grouped.target.sopInstanceUIDs.size())
+                                        .arg(QString::fromStdString(series->seriesNumber));
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        return requests;
+    }
+
+    void DimseQueryWindow::startRetrieve(const RetrieveRequest& request, core::network::RetrievePriority priority)
+    {
+        if (!m_config || !m_retrieveScheduler)
             return;
 
         if (m_peerCombo->currentIndex() < 0)
             return;
 
-        QString peerId = m_peerCombo->currentData().toString();
+        const QString peerId = m_peerCombo->currentData().toString();
         const auto* peer = m_config->getPeer(peerId.toStdString());
         if (!peer)
             return;
 
-        updateProgressStatus(QString("Retrieving study for %1...")
-            .arg(QString::fromStdString(study.patientName)));
+        const auto& localAE = m_config->getLocalAEConfig();
+        const std::string label = request.label.toStdString();
+        if (request.target.seriesInstanceUID.empty() && request.target.sopInstanceUIDs.empty())
+        {
+            m_retrieveScheduler->submitStudy(*peer, localAE, request.target.studyInstanceUID,
+                                             priority, label, request.firstSeriesUIDs);
+        }
+        else
+        {
+            m_retrieveScheduler->submit(*peer, localAE, request.target, priority, label);
+        }
 
-        // Copy data needed on the worker thread so we don't touch `this` after destruction.
-        auto retrieveService = m_retrieveService;
-        auto localAE = m_config->getLocalAEConfig();
-        auto peerCopy = *peer;
+        refreshTransfers();
+    }
 
-        // Start retrieve asynchronously
-        QPointer<DimseQueryWindow> self(this);
-        QtConcurrent::run([self, retrieveService, localAE, peerCopy, study]() {
-            if (!retrieveService)
+    void DimseQueryWindow::refreshTransfers()
+    {
+        if (!m_retrieveScheduler || !isVisible())
+            return;
+
+        const auto jobs = m_retrieveScheduler->getJobs();
+
+        // Update rows in place so the selection survives the refresh
+        std::map<std::uint64_t, QTreeWidgetItem*> rows;
+        for (int i = 0; i < m_transfersView->topLevelItemCount(); ++i)
+        {
+            QTreeWidgetItem* item = m_transfersView->topLevelItem(i);
+            rows.emplace(item->data(0, Qt::UserRole).toULongLong(), item);
+        }
+
+        int activeJobs = 0;
+        for (std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            const auto& job = jobs[i];
+            activeJobs += job.isFinished() ? 0 : 1;
+
+            QTreeWidgetItem* item = nullptr;
+            auto it = rows.find(job.id);
+            if (it != rows.end())
             {
-                return core::network::DimseStatus::Failure;
+                item = it->second;
+                rows.erase(it);
+                const int current = m_transfersView->indexOfTopLevelItem(item);
+                if (current != static_cast<int>(i))
+                {
+                    const bool wasSelected = item->isSelected();
+                    m_transfersView->takeTopLevelItem(current);
+                    m_transfersView->insertTopLevelItem(static_cast<int>(i), item);
+                    item->setSelected(wasSelected);
+                }
             }
-            return retrieveService->retrieveStudy(
-                peerCopy,
-                localAE,
-                study.studyInstanceUID,
-                [self, study](double progress, const std::string& msg) {
-                    Q_UNUSED(msg);
-                    if (!self)
-                    {
-                        return;
-                    }
-                    const QString statusMsg = QString("Retrieving %1 - %2%")
-                                                  .arg(QString::fromStdString(study.patientName))
-                                                  .arg(static_cast<int>(progress * 100));
-                    QMetaObject::invokeMethod(
-                        self.data(),
-                        "updateProgressStatus",
-                        Qt::QueuedConnection,
-                        Q_ARG(QString, statusMsg));
-                });
-        });
+            else
+            {
+                item = new QTreeWidgetItem();
+                item->setData(0, Qt::UserRole, QVariant::fromValue<qulonglong>(job.id));
+                m_transfersView->insertTopLevelItem(static_cast<int>(i), item);
+            }
+
+            item->setText(0, QString::fromStdString(job.label));
+            item->setText(1, priorityText(job.priority));
+            item->setText(2, stateText(job));
+            item->setToolTip(2, QString::fromStdString(job.lastError));
+
+            QString progress = QString("%1%").arg(static_cast<int>(job.progress * 100.0));
+            if (job.instancesExpected > 0)
+            {
+                progress += QString(" (%1/%2")
+                                .arg(job.instancesReceived + job.instancesSkipped)
+                                .arg(job.instancesExpected);
+                progress += job.instancesSkipped > 0
+                    ? QString(", %1 local)").arg(job.instancesSkipped)
+                    : QString(")");
+            }
+            item->setText(3, progress);
+
+            QString throughput;
+            if (job.megabytesPerSecond > 0.0)
+                throughput = QString("%1 MB/s, %2 img/s")
+                                 .arg(job.megabytesPerSecond, 0, 'f', 1)
+                                 .arg(job.instancesPerSecond, 0, 'f', 1);
+            else if (job.instancesPerSecond > 0.0)
+                throughput = QString("%1 img/s").arg(job.instancesPerSecond, 0, 'f', 1);
+            item->setText(4, throughput);
+        }
+
+        // Finished jobs that dropped out of the scheduler's history
+        for (auto& [id, item] : rows)
+        {
+            delete item;
+        }
+
+        if (activeJobs > 0 && !m_queryInProgress)
+        {
+            updateProgressStatus(QString("%1 retrieve job(s) pending").arg(activeJobs));
+        }
+    }
+
+    void DimseQueryWindow::onCancelTransfer()
+    {
+        if (!m_retrieveScheduler)
+            return;
+
+        for (QTreeWidgetItem* item : m_transfersView->selectedItems())
+        {
+            m_retrieveScheduler->cancel(item->data(0, Qt::UserRole).toULongLong());
+        }
+        refreshTransfers();
+    }
 
-        // Note: In a real implementation, you'd want to track this future
-        // and handle the result properly, possibly with a progress dialog
+    void DimseQueryWindow::onPrioritizeTransfer()
+    {
+        if (!m_retrieveScheduler)
+            return;
 
-        QMessageBox::information(this, "Retrieve Started",
-            QString("Started retrieving study for %1\nFiles will be imported automatically when received.")
-                .arg(QString::fromStdString(study.patientName)));
+        for (QTreeWidgetItem* item : m_transfersView->selectedItems())
+        {
+            m_retrieveScheduler->setPriority(item->data(0, Qt::UserRole).toULongLong(),
+                                             core::network::RetrievePriority::Interactive);
+        }
+        refreshTransfers();
     }
 
     void DimseQueryWindow::updateProgressStatus(const QString& message)
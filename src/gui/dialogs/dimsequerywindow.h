@@ -7,7 +7,8 @@
  *
  *  Description:
  *      Window for querying and retrieving DICOM studies from PACS servers.
- *      Provides search filters, results display, and retrieve functionality.
+ *      Provides search filters, a lazily expanded study/series/instance
+ *      results tree, and retrieve functionality at any of these levels.
  *
  *  License:
  *      Apache License 2.0
@@ -21,16 +22,25 @@
 #include <QLineEdit>
 #include <QDateEdit>
 #include <QSpinBox>
-#include <QTableWidget>
+#include <QTreeView>
+#include <QSortFilterProxyModel>
+#include <QFutureWatcher>
+#include <QTimer>
 #include <QPushButton>
 #include <QCheckBox>
 #include <QProgressBar>
 #include <QLabel>
+#include <QTreeWidget>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include "../../core/network/dimseconfig.h"
 #include "../../core/network/dimseservices.h"
 #include "../../core/network/dimseassociation.h"
+#include "../../core/network/dimseretrievescheduler.h"
+#include "remotestudymodel.h"
 
 namespace isis::gui::dialogs
 {
@@ -43,7 +53,7 @@ namespace isis::gui::dialogs
 
     public:
         explicit DimseQueryWindow(QWidget* parent = nullptr);
-        ~DimseQueryWindow() override = default;
+        ~DimseQueryWindow() override;
 
         /**
          * @brief Set DIMSE configuration
@@ -55,6 +65,11 @@ namespace isis::gui::dialogs
          */
         void setConnectionPool(std::shared_ptr<core::network::DimseConnectionPool> pool);
 
+        /**
+         * @brief Queue retrieves on a shared scheduler (objects it receives via C-GET are imported)
+         */
+        void setRetrieveScheduler(std::shared_ptr<core::network::DimseRetrieveScheduler> scheduler);
+
         /**
          * @brief Set callback for retrieved studies
          */
@@ -66,23 +81,38 @@ namespace isis::gui::dialogs
     private slots:
         void onPeerChanged(int index);
         void onQuery();
+        void onStopQuery();
+        void onQueryFinished();
+        void flushPendingResults();
         void onClearFilters();
         void onRetrieve();
         void onRetrieveAll();
         void onCancel();
         void onResultSelectionChanged();
-        void onResultDoubleClicked(int row, int column);
+        void onResultDoubleClicked(const QModelIndex& index);
         void onManagePeers();
+        void onSeriesRequested(const QString& studyInstanceUID);
+        void onInstancesRequested(const QString& studyInstanceUID, const QString& seriesInstanceUID);
+        void refreshTransfers();
+        void onCancelTransfer();
+        void onPrioritizeTransfer();
         void updateProgressStatus(const QString& message);
 
     private:
+        struct RetrieveRequest
+        {
+            core::network::RetrieveTarget target;
+            QString label;
+            std::vector<std::string> firstSeriesUIDs;   // Study requests: series to move first
+        };
+
         void setupUi();
         void refreshPeerList(const QString& preferredPeerId = QString());
-        void populateResults(const std::vector<core::network::RemoteStudyInfo>& studies);
         void clearResults();
         core::network::QueryFilter getQueryFilter();
-        std::vector<int> getSelectedStudyRows();
-        void retrieveStudy(const core::network::RemoteStudyInfo& study);
+        std::vector<RetrieveRequest> getSelectedRetrieveRequests();
+        RetrieveRequest retrieveRequestFor(const QModelIndex& sourceIndex) const;
+        void startRetrieve(const RetrieveRequest& request, core::network::RetrievePriority priority);
         void setQueryEnabled(bool enabled);
 
         // UI Components - Filters
@@ -101,12 +131,22 @@ namespace isis::gui::dialogs
         QSpinBox* m_maxResultsSpin = nullptr;
 
         // UI Components - Results
-        QTableWidget* m_resultsTable = nullptr;
+        QTreeView* m_resultsView = nullptr;
+        RemoteStudyModel* m_resultsModel = nullptr;
+        RemoteStudyFilterProxy* m_resultsProxy = nullptr;
+        QLineEdit* m_resultsFilterEdit = nullptr;
         QLabel* m_statusLabel = nullptr;
         QProgressBar* m_progressBar = nullptr;
 
+        // UI Components - Retrieve queue
+        QTreeWidget* m_transfersView = nullptr;
+        QTimer* m_transfersTimer = nullptr;
+        QPushButton* m_cancelTransferButton = nullptr;
+        QPushButton* m_prioritizeTransferButton = nullptr;
+
         // UI Components - Buttons
         QPushButton* m_queryButton = nullptr;
+        QPushButton* m_stopQueryButton = nullptr;
         QPushButton* m_clearButton = nullptr;
         QPushButton* m_retrieveButton = nullptr;
         QPushButton* m_retrieveAllButton = nullptr;
@@ -118,10 +158,21 @@ namespace isis::gui::dialogs
         std::shared_ptr<core::network::DimseConnectionPool> m_connectionPool;
         std::shared_ptr<core::events::CallbackManager> m_eventManager;
         std::shared_ptr<core::network::DimseQueryService> m_queryService;
-        std::shared_ptr<core::network::DimseRetrieveService> m_retrieveService;
-        std::vector<core::network::RemoteStudyInfo> m_queryResults;
+        std::shared_ptr<core::network::DimseRetrieveScheduler> m_retrieveScheduler;
         std::function<void(const std::string&)> m_retrieveCallback;
         bool m_queryInProgress = false;
+
+        // Streaming query: matches are buffered by the query thread and
+        // appended to the model in batches by m_resultFlushTimer
+        QFutureWatcher<core::network::DimseStatus>* m_queryWatcher = nullptr;
+        QTimer* m_resultFlushTimer = nullptr;
+        std::mutex m_pendingMutex;
+        std::vector<core::network::RemoteStudyInfo> m_pendingResults;
+
+        // Series/instance C-FIND results per peer, reused when the same study is
+        // expanded again after a new search. Keys are "<peer id>|<study or series UID>".
+        std::map<std::string, std::vector<core::network::RemoteSeriesInfo>> m_seriesCache;
+        std::map<std::string, std::vector<core::network::RemoteInstanceInfo>> m_instanceCache;
     };
 
 } // namespace isis::gui::dialogs
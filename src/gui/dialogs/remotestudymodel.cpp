@@ -0,0 +1,487 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: remotestudymodel.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the lazily expanded C-FIND results tree.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "remotestudymodel.h"
+#include <iterator>
+
+namespace isis::gui::dialogs
+{
+    namespace
+    {
+        constexpr int InternalIdShift = 32;
+        constexpr quintptr InternalIdMask = 0xffffffffu;
+    }
+
+    RemoteStudyModel::RemoteStudyModel(QObject* parent)
+        : QAbstractItemModel(parent)
+    {
+    }
+
+    RemoteStudyModel::NodePath RemoteStudyModel::pathOf(const QModelIndex& index) const
+    {
+        NodePath path;
+        if (!index.isValid())
+        {
+            return path;
+        }
+
+        const quintptr id = index.internalId();
+        if (id == 0)
+        {
+            path.level = Level::Study;
+            path.study = index.row();
+        }
+        else if ((id >> InternalIdShift) == 0)
+        {
+            path.level = Level::Series;
+            path.study = static_cast<int>(id) - 1;
+            path.series = index.row();
+        }
+        else
+        {
+            path.level = Level::Instance;
+            path.study = static_cast<int>(id >> InternalIdShift) - 1;
+            path.series = static_cast<int>(id & InternalIdMask) - 1;
+            path.instance = index.row();
+        }
+
+        return path;
+    }
+
+    QModelIndex RemoteStudyModel::index(int row, int column, const QModelIndex& parent) const
+    {
+        if (!hasIndex(row, column, parent))
+        {
+            return QModelIndex();
+        }
+
+        const NodePath parentPath = pathOf(parent);
+        switch (parentPath.level)
+        {
+        case Level::Invalid:
+            return createIndex(row, column, quintptr(0));
+        case Level::Study:
+            return createIndex(row, column, static_cast<quintptr>(parentPath.study + 1));
+        case Level::Series:
+            return createIndex(row, column,
+                               (static_cast<quintptr>(parentPath.study + 1) << InternalIdShift) |
+                                   static_cast<quintptr>(parentPath.series + 1));
+        default:
+            return QModelIndex();
+        }
+    }
+
+    QModelIndex RemoteStudyModel::parent(const QModelIndex& index) const
+    {
+        const NodePath path = pathOf(index);
+        switch (path.level)
+        {
+        case Level::Series:
+            return createIndex(path.study, 0, quintptr(0));
+        case Level::Instance:
+            return createIndex(path.series, 0, static_cast<quintptr>(path.study + 1));
+        default:
+            return QModelIndex();
+        }
+    }
+
+    int RemoteStudyModel::rowCount(const QModelIndex& parent) const
+    {
+        if (parent.isValid() && parent.column() != 0)
+        {
+            return 0;
+        }
+
+        const NodePath path = pathOf(parent);
+        switch (path.level)
+        {
+        case Level::Invalid:
+            return static_cast<int>(m_studies.size());
+        case Level::Study:
+            return static_cast<int>(m_studies[path.study].series.size());
+        case Level::Series:
+            return static_cast<int>(m_studies[path.study].series[path.series].instances.size());
+        default:
+            return 0;
+        }
+    }
+
+    int RemoteStudyModel::columnCount(const QModelIndex& parent) const
+    {
+        Q_UNUSED(parent);
+        return ColumnCount;
+    }
+
+    bool RemoteStudyModel::hasChildren(const QModelIndex& parent) const
+    {
+        if (parent.isValid() && parent.column() != 0)
+        {
+            return false;
+        }
+
+        // Unloaded nodes report children so the view draws an expander
+        const NodePath path = pathOf(parent);
+        switch (path.level)
+        {
+        case Level::Invalid:
+            return !m_studies.empty();
+        case Level::Study:
+        {
+            const auto& node = m_studies[path.study];
+            return node.state != LoadState::Loaded || !node.series.empty();
+        }
+        case Level::Series:
+        {
+            const auto& node = m_studies[path.study].series[path.series];
+            return node.state != LoadState::Loaded || !node.instances.empty();
+        }
+        default:
+            return false;
+        }
+    }
+
+    bool RemoteStudyModel::canFetchMore(const QModelIndex& parent) const
+    {
+        const NodePath path = pathOf(parent);
+        switch (path.level)
+        {
+        case Level::Study:
+            return m_studies[path.study].state == LoadState::NotLoaded;
+        case Level::Series:
+            return m_studies[path.study].series[path.series].state == LoadState::NotLoaded;
+        default:
+            return false;
+        }
+    }
+
+    void RemoteStudyModel::fetchMore(const QModelIndex& parent)
+    {
+        const NodePath path = pathOf(parent);
+        if (path.level == Level::Study)
+        {
+            auto& node = m_studies[path.study];
+            if (node.state == LoadState::NotLoaded)
+            {
+                node.state = LoadState::Loading;
+                emit seriesRequested(QString::fromStdString(node.info.studyInstanceUID));
+            }
+        }
+        else if (path.level == Level::Series)
+        {
+            const auto& study = m_studies[path.study];
+            auto& node = m_studies[path.study].series[path.series];
+            if (node.state == LoadState::NotLoaded)
+            {
+                node.state = LoadState::Loading;
+                emit instancesRequested(QString::fromStdString(study.info.studyInstanceUID),
+                                        QString::fromStdString(node.info.seriesInstanceUID));
+            }
+        }
+    }
+
+    QVariant RemoteStudyModel::data(const QModelIndex& index, int role) const
+    {
+        if (role != Qt::DisplayRole && role != Qt::ToolTipRole)
+        {
+            return QVariant();
+        }
+
+        const NodePath path = pathOf(index);
+        if (path.level == Level::Study)
+        {
+            const auto& study = m_studies[path.study].info;
+            switch (index.column())
+            {
+            case PatientNameColumn: return QString::fromStdString(study.patientName);
+            case PatientIdColumn: return QString::fromStdString(study.patientID);
+            case StudyDateColumn: return QString::fromStdString(study.studyDate);
+            case StudyDescriptionColumn: return QString::fromStdString(study.studyDescription);
+            case AccessionColumn: return QString::fromStdString(study.accessionNumber);
+            case ModalityColumn: return QString::fromStdString(study.modality);
+            case SeriesCountColumn: return study.numberOfSeries;
+            case InstanceCountColumn: return study.numberOfInstances;
+            default: return QVariant();
+            }
+        }
+
+        if (path.level == Level::Series)
+        {
+            const auto& series = m_studies[path.study].series[path.series].info;
+            switch (index.column())
+            {
+            case PatientNameColumn:
+                return tr("Series %1").arg(QString::fromStdString(series.seriesNumber));
+            case StudyDescriptionColumn: return QString::fromStdString(series.seriesDescription);
+            case ModalityColumn: return QString::fromStdString(series.modality);
+            case InstanceCountColumn: return series.numberOfInstances;
+            default: return QVariant();
+            }
+        }
+
+        if (path.level == Level::Instance)
+        {
+            const auto& instance = m_studies[path.study].series[path.series].instances[path.instance];
+            switch (index.column())
+            {
+            case PatientNameColumn:
+                return tr("Image %1").arg(QString::fromStdString(instance.instanceNumber));
+            case StudyDescriptionColumn:
+                if (instance.rows > 0 && instance.columns > 0)
+                {
+                    return QString("%1 x %2").arg(instance.columns).arg(instance.rows);
+                }
+                return QVariant();
+            case InstanceCountColumn:
+                return instance.numberOfFrames > 1 ? QVariant(instance.numberOfFrames) : QVariant();
+            default: return QVariant();
+            }
+        }
+
+        return QVariant();
+    }
+
+    QVariant RemoteStudyModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        {
+            return QVariant();
+        }
+
+        switch (section)
+        {
+        case PatientNameColumn: return tr("Patient Name");
+        case PatientIdColumn: return tr("Patient ID");
+        case StudyDateColumn: return tr("Study Date");
+        case StudyDescriptionColumn: return tr("Description");
+        case AccessionColumn: return tr("Accession #");
+        case ModalityColumn: return tr("Modality");
+        case SeriesCountColumn: return tr("# Series");
+        case InstanceCountColumn: return tr("# Images");
+        default: return QVariant();
+        }
+    }
+
+    void RemoteStudyModel::appendStudies(std::vector<core::network::RemoteStudyInfo> studies)
+    {
+        if (studies.empty())
+        {
+            return;
+        }
+
+        const int first = static_cast<int>(m_studies.size());
+        const int last = first + static_cast<int>(studies.size()) - 1;
+
+        beginInsertRows(QModelIndex(), first, last);
+        m_studies.reserve(m_studies.size() + studies.size());
+        for (auto& study : studies)
+        {
+            m_studyRows.emplace(study.studyInstanceUID, static_cast<int>(m_studies.size()));
+            StudyNode node;
+            node.info = std::move(study);
+            m_studies.push_back(std::move(node));
+        }
+        endInsertRows();
+    }
+
+    void RemoteStudyModel::setSeries(const std::string& studyInstanceUID,
+                                     std::vector<core::network::RemoteSeriesInfo> series)
+    {
+        const int studyRow = findStudyRow(studyInstanceUID);
+        if (studyRow < 0)
+        {
+            return;
+        }
+
+        auto& node = m_studies[studyRow];
+        if (node.state == LoadState::Loaded)
+        {
+            return;
+        }
+
+        const QModelIndex parentIndex = index(studyRow, 0);
+        if (!series.empty())
+        {
+            beginInsertRows(parentIndex, 0, static_cast<int>(series.size()) - 1);
+            node.series.reserve(series.size());
+            for (auto& info : series)
+            {
+                SeriesNode child;
+                child.info = std::move(info);
+                node.series.push_back(std::move(child));
+            }
+            node.state = LoadState::Loaded;
+            endInsertRows();
+        }
+        else
+        {
+            node.state = LoadState::Loaded;
+        }
+
+        // Series count comes from the peer only if it supports the optional key
+        if (node.info.numberOfSeries == 0)
+        {
+            node.info.numberOfSeries = static_cast<int>(node.series.size());
+            const QModelIndex countIndex = index(studyRow, SeriesCountColumn);
+            emit dataChanged(countIndex, countIndex);
+        }
+    }
+
+    void RemoteStudyModel::setInstances(const std::string& studyInstanceUID,
+                                        const std::string& seriesInstanceUID,
+                                        std::vector<core::network::RemoteInstanceInfo> instances)
+    {
+        const int studyRow = findStudyRow(studyInstanceUID);
+        const int seriesRow = findSeriesRow(studyRow, seriesInstanceUID);
+        if (seriesRow < 0)
+        {
+            return;
+        }
+
+        auto& node = m_studies[studyRow].series[seriesRow];
+        if (node.state == LoadState::Loaded)
+        {
+            return;
+        }
+
+        const QModelIndex parentIndex = index(seriesRow, 0, index(studyRow, 0));
+        if (!instances.empty())
+        {
+            beginInsertRows(parentIndex, 0, static_cast<int>(instances.size()) - 1);
+            node.instances = std::move(instances);
+            node.state = LoadState::Loaded;
+            endInsertRows();
+        }
+        else
+        {
+            node.state = LoadState::Loaded;
+        }
+
+        if (node.info.numberOfInstances == 0)
+        {
+            node.info.numberOfInstances = static_cast<int>(node.instances.size());
+            const QModelIndex countIndex = index(seriesRow, InstanceCountColumn, index(studyRow, 0));
+            emit dataChanged(countIndex, countIndex);
+        }
+    }
+
+    void RemoteStudyModel::setChildrenFailed(const std::string& studyInstanceUID,
+                                             const std::string& seriesInstanceUID)
+    {
+        const int studyRow = findStudyRow(studyInstanceUID);
+        if (studyRow < 0)
+        {
+            return;
+        }
+
+        if (seriesInstanceUID.empty())
+        {
+            if (m_studies[studyRow].state == LoadState::Loading)
+            {
+                m_studies[studyRow].state = LoadState::NotLoaded;
+            }
+            return;
+        }
+
+        const int seriesRow = findSeriesRow(studyRow, seriesInstanceUID);
+        if (seriesRow >= 0 && m_studies[studyRow].series[seriesRow].state == LoadState::Loading)
+        {
+            m_studies[studyRow].series[seriesRow].state = LoadState::NotLoaded;
+        }
+    }
+
+    void RemoteStudyModel::clear()
+    {
+        beginResetModel();
+        m_studies.clear();
+        m_studyRows.clear();
+        endResetModel();
+    }
+
+    std::vector<core::network::RemoteStudyInfo> RemoteStudyModel::studies() const
+    {
+        std::vector<core::network::RemoteStudyInfo> result;
+        result.reserve(m_studies.size());
+        for (const auto& node : m_studies)
+        {
+            result.push_back(node.info);
+        }
+        return result;
+    }
+
+    RemoteStudyModel::Level RemoteStudyModel::levelOf(const QModelIndex& index) const
+    {
+        return pathOf(index).level;
+    }
+
+    const core::network::RemoteStudyInfo* RemoteStudyModel::studyAt(const QModelIndex& index) const
+    {
+        const NodePath path = pathOf(index);
+        return path.level == Level::Invalid ? nullptr : &m_studies[path.study].info;
+    }
+
+    const core::network::RemoteSeriesInfo* RemoteStudyModel::seriesAt(const QModelIndex& index) const
+    {
+        const NodePath path = pathOf(index);
+        if (path.level != Level::Series && path.level != Level::Instance)
+        {
+            return nullptr;
+        }
+        return &m_studies[path.study].series[path.series].info;
+    }
+
+    const core::network::RemoteInstanceInfo* RemoteStudyModel::instanceAt(const QModelIndex& index) const
+    {
+        const NodePath path = pathOf(index);
+        if (path.level != Level::Instance)
+        {
+            return nullptr;
+        }
+        return &m_studies[path.study].series[path.series].instances[path.instance];
+    }
+
+    int RemoteStudyModel::findStudyRow(const std::string& studyInstanceUID) const
+    {
+        auto it = m_studyRows.find(studyInstanceUID);
+        return it != m_studyRows.end() ? it->second : -1;
+    }
+
+    int RemoteStudyModel::findSeriesRow(int studyRow, const std::string& seriesInstanceUID) const
+    {
+        if (studyRow < 0)
+        {
+            return -1;
+        }
+
+        const auto& series = m_studies[studyRow].series;
+        for (int row = 0; row < static_cast<int>(series.size()); ++row)
+        {
+            if (series[row].info.seriesInstanceUID == seriesInstanceUID)
+            {
+                return row;
+            }
+        }
+        return -1;
+    }
+
+    bool RemoteStudyFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+    {
+        if (sourceParent.isValid())
+        {
+            return true;
+        }
+        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+    }
+
+} // namespace isis::gui::dialogs
@@ -0,0 +1,177 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: remotestudymodel.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Item model holding C-FIND results as a lazily expanded
+ *      study -> series -> instance tree.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QSortFilterProxyModel>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../core/network/dimseservices.h"
+
+namespace isis::gui::dialogs
+{
+    /**
+     * @brief Tree of remote studies; studies are appended in batches while a query runs
+     *
+     * Series and instances are not queried up front. Expanding a node calls fetchMore(),
+     * which emits seriesRequested()/instancesRequested(); the owner runs the C-FIND and
+     * hands the result back with setSeries()/setInstances(). Numeric columns expose
+     * numbers in the display role so a QSortFilterProxyModel sorts them numerically.
+     */
+    class RemoteStudyModel : public QAbstractItemModel
+    {
+        Q_OBJECT
+
+    public:
+        enum Column
+        {
+            PatientNameColumn,
+            PatientIdColumn,
+            StudyDateColumn,
+            StudyDescriptionColumn,
+            AccessionColumn,
+            ModalityColumn,
+            SeriesCountColumn,
+            InstanceCountColumn,
+            ColumnCount
+        };
+
+        enum class Level
+        {
+            Invalid,
+            Study,
+            Series,
+            Instance
+        };
+
+        explicit RemoteStudyModel(QObject* parent = nullptr);
+        ~RemoteStudyModel() override = default;
+
+        // QAbstractItemModel interface
+        [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+        [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation,
+                                          int role = Qt::DisplayRole) const override;
+        [[nodiscard]] QModelIndex index(int row, int column,
+                                        const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] QModelIndex parent(const QModelIndex& index) const override;
+        [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+        [[nodiscard]] bool canFetchMore(const QModelIndex& parent) const override;
+        void fetchMore(const QModelIndex& parent) override;
+
+        /**
+         * @brief Append a batch of studies with a single row insertion
+         */
+        void appendStudies(std::vector<core::network::RemoteStudyInfo> studies);
+
+        /**
+         * @brief Insert the series of a study requested through seriesRequested()
+         */
+        void setSeries(const std::string& studyInstanceUID,
+                       std::vector<core::network::RemoteSeriesInfo> series);
+
+        /**
+         * @brief Insert the instances of a series requested through instancesRequested()
+         */
+        void setInstances(const std::string& studyInstanceUID,
+                          const std::string& seriesInstanceUID,
+                          std::vector<core::network::RemoteInstanceInfo> instances);
+
+        /**
+         * @brief Mark a pending child query as failed so the node can be expanded again
+         */
+        void setChildrenFailed(const std::string& studyInstanceUID,
+                               const std::string& seriesInstanceUID = std::string());
+
+        /**
+         * @brief Remove all studies
+         */
+        void clear();
+
+        [[nodiscard]] int studyCount() const { return static_cast<int>(m_studies.size()); }
+        [[nodiscard]] const core::network::RemoteStudyInfo& study(int row) const { return m_studies.at(row).info; }
+        [[nodiscard]] std::vector<core::network::RemoteStudyInfo> studies() const;
+
+        /**
+         * @brief Accessors for any node of the tree
+         */
+        [[nodiscard]] Level levelOf(const QModelIndex& index) const;
+        [[nodiscard]] const core::network::RemoteStudyInfo* studyAt(const QModelIndex& index) const;
+        [[nodiscard]] const core::network::RemoteSeriesInfo* seriesAt(const QModelIndex& index) const;
+        [[nodiscard]] const core::network::RemoteInstanceInfo* instanceAt(const QModelIndex& index) const;
+
+    signals:
+        void seriesRequested(const QString& studyInstanceUID);
+        void instancesRequested(const QString& studyInstanceUID, const QString& seriesInstanceUID);
+
+    private:
+        enum class LoadState
+        {
+            NotLoaded,
+            Loading,
+            Loaded
+        };
+
+        struct SeriesNode
+        {
+            core::network::RemoteSeriesInfo info;
+            std::vector<core::network::RemoteInstanceInfo> instances;
+            LoadState state = LoadState::NotLoaded;
+        };
+
+        struct StudyNode
+        {
+            core::network::RemoteStudyInfo info;
+            std::vector<SeriesNode> series;
+            LoadState state = LoadState::NotLoaded;
+        };
+
+        // Internal id layout: 0 for studies, (study + 1) for series,
+        // ((study + 1) << 32) | (series + 1) for instances
+        struct NodePath
+        {
+            Level level = Level::Invalid;
+            int study = -1;
+            int series = -1;
+            int instance = -1;
+        };
+
+        [[nodiscard]] NodePath pathOf(const QModelIndex& index) const;
+        [[nodiscard]] int findStudyRow(const std::string& studyInstanceUID) const;
+        [[nodiscard]] int findSeriesRow(int studyRow, const std::string& seriesInstanceUID) const;
+
+        std::vector<StudyNode> m_studies;
+        std::unordered_map<std::string, int> m_studyRows;
+    };
+
+    /**
+     * @brief Proxy that filters studies only; series and instances of a visible study are kept
+     */
+    class RemoteStudyFilterProxy : public QSortFilterProxyModel
+    {
+        Q_OBJECT
+
+    public:
+        using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    protected:
+        [[nodiscard]] bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    };
+
+} // namespace isis::gui::dialogs
@@ -15,8 +15,13 @@
 
 #include "dimsenetworkmanager.h"
 #include "filesimporter.h"
+#include "../core/image.h"
+#include "../core/patient.h"
+#include "../core/series.h"
+#include "../core/study.h"
 #include <QLoggingCategory>
 #include <QFileInfo>
+#include <algorithm>
 
 Q_LOGGING_CATEGORY(lcDimseGui, "isis.gui.dimse")
 
@@ -68,6 +73,32 @@ namespace isis::gui
         m_retrieveService = std::make_shared<core::network::DimseRetrieveService>(
             m_connectionPool, m_eventManager);
 
+        // Objects received through C-GET are imported like those sent to the Storage SCP
+        m_retrieveService->setStorageReceivedCallback(
+            [this](const std::string& filepath) {
+                onStorageReceived(filepath);
+            });
+        m_retrieveService->setInstanceReceivedCallback(
+            [this](const core::DicomInstanceHeader& header) {
+                onInstanceReceived(header);
+            });
+
+        // Retrieves from the query window are queued here; bounded per peer so a bulk
+        // transfer cannot take every association of the pool
+        core::network::RetrieveSchedulerOptions schedulerOptions;
+        schedulerOptions.workerCount = std::max(1, m_config->getLocalAEConfig().maxConnections - 1);
+        m_retrieveScheduler = std::make_shared<core::network::DimseRetrieveScheduler>(
+            m_connectionPool, m_eventManager, schedulerOptions);
+        m_retrieveScheduler->setStorageReceivedCallback(
+            [this](const std::string& filepath) {
+                onStorageReceived(filepath);
+            });
+        m_retrieveScheduler->setInstanceReceivedCallback(
+            [this](const core::DicomInstanceHeader& header) {
+                onInstanceReceived(header);
+            });
+        m_retrieveScheduler->start();
+
         m_storeService = std::make_shared<core::network::DimseStoreService>(
             m_connectionPool, m_eventManager);
 
@@ -80,6 +111,21 @@ namespace isis::gui
             [this](const std::string& filepath) {
                 onStorageReceived(filepath);
             });
+        m_storageScp->setInstanceReceivedCallback(
+            [this](const core::DicomInstanceHeader& header) {
+                onInstanceReceived(header);
+            });
+
+        // Objects moved or sent to us through C-GET land in the SCP's hierarchical store
+        m_retrieveService->setStorageIndex(m_storageScp->getStorageIndex());
+        m_retrieveScheduler->setStorageIndex(m_storageScp->getStorageIndex());
+
+        // Priors of received studies are queued behind the user's retrieves
+        m_prefetchService = std::make_shared<core::network::DimsePrefetchService>(
+            m_connectionPool, m_eventManager, m_retrieveScheduler);
+        m_prefetchService->setStorageIndex(m_storageScp->getStorageIndex());
+        applyPrefetchRules();
+        m_prefetchService->start();
 
         // Auto-start Storage SCP if enabled
         if (m_config->getLocalAEConfig().enableStorage)
@@ -109,6 +155,18 @@ namespace isis::gui
 
         qCInfo(lcDimseGui) << "Shutting down DIMSE Network Manager...";
 
+        // No new prior lookups once the scheduler is stopping
+        if (m_prefetchService)
+        {
+            m_prefetchService->stop();
+        }
+
+        // Running retrieves are cancelled before the pool goes away
+        if (m_retrieveScheduler)
+        {
+            m_retrieveScheduler->stop();
+        }
+
         // Stop Storage SCP
         stopStorageScp();
 
@@ -122,6 +180,8 @@ namespace isis::gui
         m_echoService.reset();
         m_queryService.reset();
         m_retrieveService.reset();
+        m_prefetchService.reset();
+        m_retrieveScheduler.reset();
         m_storageScp.reset();
         m_connectionPool.reset();
         m_eventManager.reset();
@@ -132,6 +192,71 @@ namespace isis::gui
         qCInfo(lcDimseGui) << "DIMSE Network Manager shut down";
     }
 
+    void DimseNetworkManager::applyPrefetchRules()
+    {
+        if (!m_config || !m_prefetchService)
+            return;
+
+        const auto rules = m_config->getPrefetchRules();
+        core::network::DicomPeer peer;
+        if (const auto* configured = m_config->getPeer(rules.peerId))
+        {
+            peer = *configured;
+        }
+        else
+        {
+            const auto peers = m_config->getEnabledPeers();
+            if (!peers.empty())
+            {
+                peer = peers.front();
+            }
+        }
+
+        m_prefetchService->configure(rules, peer, m_config->getLocalAEConfig());
+        if (rules.enabled)
+        {
+            qCInfo(lcDimseGui) << "Prior prefetch enabled from peer" << peer.aeTitle.c_str();
+        }
+    }
+
+    void DimseNetworkManager::prefetchPriors(const core::network::PrefetchStudy& study)
+    {
+        if (m_prefetchService)
+        {
+            m_prefetchService->onStudyAvailable(study);
+        }
+    }
+
+    void DimseNetworkManager::studyOpened(const core::Patient* patient, const core::Study* study,
+                                          const core::Series* series, const core::Image* image)
+    {
+        if (!m_prefetchService || !patient || !study)
+        {
+            return;
+        }
+        core::network::PrefetchStudy opened;
+        opened.patientID = patient->getID();
+        opened.studyInstanceUID = study->getUID();
+        opened.studyDate = study->getDate();
+        if (series)
+        {
+            opened.bodyPartExamined = series->getBodyPartExamined();
+        }
+        if (image && !image->getModality().empty())
+        {
+            opened.modalities.push_back(image->getModality());
+        }
+        m_prefetchService->onStudyOpened(opened);
+    }
+
+    void DimseNetworkManager::studiesClosed()
+    {
+        if (m_prefetchService)
+        {
+            m_prefetchService->closeStudies();
+        }
+    }
+
     bool DimseNetworkManager::isStorageScpRunning() const
     {
         return m_storageScp && m_storageScp->isRunning();
@@ -179,6 +304,14 @@ namespace isis::gui
         }
     }
 
+    std::vector<core::network::StorageAssociationStats> DimseNetworkManager::getStorageAssociationStats() const
+    {
+        if (!m_storageScp)
+            return {};
+
+        return m_storageScp->getAssociationStats();
+    }
+
     void DimseNetworkManager::setupEventCallbacks()
     {
         if (!m_eventManager)
@@ -269,6 +402,37 @@ namespace isis::gui
         }
     }
 
+    void DimseNetworkManager::onInstanceReceived(const core::DicomInstanceHeader& header)
+    {
+        const QString qFilepath = QString::fromStdString(header.filePath);
+
+        qCInfo(lcDimseGui) << "Received DICOM instance via C-STORE:" << qFilepath;
+
+        emit fileReceived(qFilepath);
+
+        // The first object of a study starts the lookup of its priors (later ones are deduplicated)
+        core::network::PrefetchStudy study;
+        study.patientID = header.getValue(0x0010, 0x0020);
+        study.studyInstanceUID = header.getValue(0x0020, 0x000D);
+        study.studyDate = header.getValue(0x0008, 0x0020);
+        study.bodyPartExamined = header.getValue(0x0018, 0x0015);
+        if (const auto modality = header.getValue(0x0008, 0x0060); !modality.empty())
+        {
+            study.modalities.push_back(modality);
+        }
+        prefetchPriors(study);
+
+        if (m_filesImporter)
+        {
+            // The SCP already parsed the header; the importer inserts it without reading the file
+            m_filesImporter->addParsedInstance(header);
+        }
+        else
+        {
+            qCWarning(lcDimseGui) << "FilesImporter not available, file not imported:" << qFilepath;
+        }
+    }
+
     void DimseNetworkManager::onFileReceived(const QString& filepath)
     {
         // This slot can be connected to UI elements if needed
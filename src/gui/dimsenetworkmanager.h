@@ -21,9 +21,19 @@
 #include "../core/network/dimseconfig.h"
 #include "../core/network/dimseassociation.h"
 #include "../core/network/dimseservices.h"
+#include "../core/network/dimseretrievescheduler.h"
+#include "../core/network/dimseprefetchservice.h"
 #include "../core/network/dimsestoragescp.h"
 #include "../core/events/callbackmanager.h"
 
+namespace isis::core
+{
+    class Image;
+    class Patient;
+    class Series;
+    class Study;
+}
+
 namespace isis::gui
 {
     class FilesImporter;
@@ -80,6 +90,46 @@ namespace isis::gui
          */
         std::shared_ptr<core::network::DimseRetrieveService> getRetrieveService() const { return m_retrieveService; }
 
+        /**
+         * @brief Get the prioritized retrieve queue shared by all windows
+         */
+        std::shared_ptr<core::network::DimseRetrieveScheduler> getRetrieveScheduler() const { return m_retrieveScheduler; }
+
+        /**
+         * @brief Get the background retrieve of relevant priors
+         */
+        std::shared_ptr<core::network::DimsePrefetchService> getPrefetchService() const { return m_prefetchService; }
+
+        /**
+         * @brief Re-read the prefetch rules and their peer from the configuration
+         */
+        void applyPrefetchRules();
+
+        /**
+         * @brief Look up and queue the relevant priors of a received study
+         */
+        void prefetchPriors(const core::network::PrefetchStudy& study);
+
+        /**
+         * @brief The user opened a series: its study is marked as used, kept from the
+         *        disk quota purge and its priors are looked up
+         */
+        void studyOpened(const core::Patient* patient, const core::Study* study,
+                         const core::Series* series, const core::Image* image);
+
+        /**
+         * @brief Every study was closed
+         */
+        void studiesClosed();
+
+        /**
+         * @brief Arrival index of objects received by the Storage SCP (null with flat storage)
+         */
+        std::shared_ptr<core::network::DimseStorageIndex> getStorageIndex() const
+        {
+            return m_storageScp ? m_storageScp->getStorageIndex() : nullptr;
+        }
+
         /**
          * @brief Get store service (C-STORE SCU)
          */
@@ -101,6 +151,11 @@ namespace isis::gui
          */
         void stopStorageScp();
 
+        /**
+         * @brief Per-association counters of the Storage SCP (active first, then recent)
+         */
+        std::vector<core::network::StorageAssociationStats> getStorageAssociationStats() const;
+
     signals:
         /**
          * @brief Emitted when a file is received via Storage SCP
@@ -125,6 +180,8 @@ namespace isis::gui
         std::shared_ptr<core::network::DimseEchoService> m_echoService;
         std::shared_ptr<core::network::DimseQueryService> m_queryService;
         std::shared_ptr<core::network::DimseRetrieveService> m_retrieveService;
+        std::shared_ptr<core::network::DimseRetrieveScheduler> m_retrieveScheduler;
+        std::shared_ptr<core::network::DimsePrefetchService> m_prefetchService;
         std::shared_ptr<core::network::DimseStoreService> m_storeService;
         std::shared_ptr<core::network::DimseStorageSCP> m_storageScp;
 
@@ -135,6 +192,7 @@ namespace isis::gui
         // Helper methods
         void setupEventCallbacks();
         void onStorageReceived(const std::string& filepath);
+        void onInstanceReceived(const core::DicomInstanceHeader& header);
     };
 
 } // namespace isis::gui
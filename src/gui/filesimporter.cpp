@@ -37,15 +37,24 @@
  */
 
 #include "filesimporter.h"
+#include <chrono>
+#include <optional>
 #include <QApplication>
 #include <QDebug>
 #include <QtConcurrent/QtConcurrent>
 #include <QFileInfo>
+#include <QLoggingCategory>
 #include <QMutexLocker>
 #include <QStringList>
+#include "series.h"
+#include "utils/structuredlog.h"
+
+Q_LOGGING_CATEGORY(lcFilesImporter, "isis.gui.filesimporter")
 
 namespace
 {
+	constexpr std::chrono::milliseconds statisticsInterval(500);
+
 	bool isLikelyDicomPath(const QString& path)
 	{
 		const QFileInfo info(path);
@@ -99,6 +108,13 @@ void isis::gui::FilesImporter::stopImporter(const QString& reason)
 		? QStringLiteral("generic request")
 		: reason;
 	qInfo() << "[FilesImporter] Stop requested (" << context << ")";
+	// Folders not started yet are dropped before waiting, so the scan ends after the current one
+	{
+		QMutexLocker foldersLocker(&m_foldersMutex);
+		m_foldersPaths.clear();
+	}
+	// Releases scans waiting for room so they can see the stop
+	m_importQueue.close();
 	m_futureFolders.waitForFinished();
 	{
 		QMutexLocker locker(&m_filesMutex);
@@ -108,11 +124,10 @@ void isis::gui::FilesImporter::stopImporter(const QString& reason)
 	wait();
 	{
 		QMutexLocker filesLocker(&m_filesMutex);
-		m_filesPaths.clear();
-	}
-	{
-		QMutexLocker foldersLocker(&m_foldersMutex);
-		m_foldersPaths.clear();
+		m_importQueue.reset();
+		m_parsedInstances.clear();
+		m_importing = false;
+		m_drainReported = false;
 	}
 	qInfo() << "[FilesImporter] Importer stopped. Queues cleared.";
 }
@@ -121,23 +136,36 @@ void isis::gui::FilesImporter::stopImporter(const QString& reason)
 void isis::gui::FilesImporter::addFiles(const QStringList& t_paths)
 {
 	QApplication::setOverrideCursor(Qt::WaitCursor);
+	int queued = 0;
+	for (const auto& path : t_paths)
 	{
-		QMutexLocker locker(&m_filesMutex);
-		for (const auto& path : t_paths)
+		if (!isLikelyDicomPath(path))
 		{
-			if (!isLikelyDicomPath(path))
-			{
-				qDebug() << "[FilesImporter] Skipping non-DICOM candidate" << path;
-				continue;
-			}
-			qInfo() << "[FilesImporter] Queueing file" << path;
-			m_filesPaths.push_back(path);
+			core::utils::telemetry().increment("import.files_skipped");
+			continue;
 		}
+		m_importQueue.push(path.toStdString());
+		++queued;
 	}
-	m_filesCondition.wakeAll();
+	core::utils::telemetry().increment("import.files_queued", static_cast<std::uint64_t>(queued));
+	core::utils::logEvent(lcFilesImporter(), core::utils::LogLevel::Debug,
+		"[FilesImporter] Queued files",
+		{{"queued", queued}, {"requested", static_cast<int>(t_paths.size())}});
+	wakeImporter();
 	QApplication::restoreOverrideCursor();
 }
 
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::addParsedInstance(const core::DicomInstanceHeader& t_header)
+{
+	{
+		QMutexLocker locker(&m_filesMutex);
+		m_parsedInstances.push_back(t_header);
+	}
+	core::utils::telemetry().increment("import.headers_queued");
+	m_filesCondition.wakeAll();
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::FilesImporter::addFolders(const QStringList& t_paths)
 {
@@ -158,6 +186,7 @@ void isis::gui::FilesImporter::addFolders(const QStringList& t_paths)
 void isis::gui::FilesImporter::parseFolders(FilesImporter* t_self)
 {
 	constexpr int batchSize = 32;
+	auto& queue = t_self->m_importQueue;
 	while (true)
 	{
 		QString folderPath;
@@ -169,48 +198,158 @@ void isis::gui::FilesImporter::parseFolders(FilesImporter* t_self)
 			}
 			folderPath = t_self->m_foldersPaths.front();
 			t_self->m_foldersPaths.pop_front();
+			// Registered while m_foldersMutex is held so cancelFolder() always finds the folder
+			queue.beginRoot(folderPath.toStdString());
 		}
 
 		qInfo() << "[FilesImporter] Parsing folder" << folderPath;
-		QStringList discoveredFiles;
-		const auto flushDiscovered = [&](QStringList& batch)
-		{
-			if (batch.isEmpty())
-			{
-				return;
-			}
-			{
-				QMutexLocker filesLocker(&t_self->m_filesMutex);
-				for (const auto& filePath : batch)
-				{
-					t_self->m_filesPaths.push_back(filePath);
-				}
-			}
-			t_self->m_filesCondition.wakeAll();
-			qInfo() << "[FilesImporter] Enqueued batch of" << batch.size()
-				<< "files from" << folderPath;
-			batch.clear();
-		};
-
+		const std::string root = folderPath.toStdString();
+		int discovered = 0;
+		bool cancelled = false;
 		for (QDirIterator it(folderPath, QDir::Files, QDirIterator::Subdirectories);
 			it.hasNext();)
 		{
 			const QString nextPath = it.next();
 			if (!isLikelyDicomPath(nextPath))
 			{
-				qDebug() << "[FilesImporter] Skipping non-DICOM candidate" << nextPath;
+				core::utils::telemetry().increment("import.files_skipped");
 				continue;
 			}
-			discoveredFiles.push_back(nextPath);
-			if (discoveredFiles.size() >= batchSize)
+			// Waits while the queue is full, so a huge share is never listed ahead of the import
+			if (!queue.pushScanned(root, nextPath.toStdString()))
 			{
-				flushDiscovered(discoveredFiles);
+				cancelled = true;
+				break;
+			}
+			t_self->wakeImporter();
+			if (++discovered % batchSize == 0)
+			{
+				core::utils::telemetry().increment("import.files_discovered", batchSize);
 			}
 		}
+		core::utils::telemetry().increment("import.files_discovered",
+			static_cast<std::uint64_t>(discovered % batchSize));
+		queue.endRoot(root);
+		t_self->wakeImporter();
+		// The import may have caught up before the last folder finished; cancels and stops report their own
+		if (!cancelled && t_self->takeDrained())
+		{
+			t_self->publishStatistics(true);
+			emit t_self->importQueueDrained();
+		}
+		qInfo() << (cancelled ? "[FilesImporter] Cancelled folder" : "[FilesImporter] Finished folder")
+			<< folderPath << "files" << discovered;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::prioritizeSeries(core::Series* t_series)
+{
+	if (!t_series)
+	{
+		return;
+	}
+	// Slices of a series usually share a folder: the rest of it is imported next
+	m_importQueue.prioritizeFoldersOf(t_series->snapshotSingleFramePaths());
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::gui::FilesImporter::cancelFolder(const QString& t_root)
+{
+	bool wasPending = false;
+	{
+		QMutexLocker foldersLocker(&m_foldersMutex);
+		wasPending = m_foldersPaths.removeAll(t_root) > 0;
+	}
+	const std::size_t dropped = m_importQueue.cancelRoot(t_root.toStdString());
+	core::utils::telemetry().increment("import.files_cancelled", static_cast<std::uint64_t>(dropped));
+	qInfo() << "[FilesImporter] Cancelled folder" << t_root
+		<< "queued files dropped" << dropped << (wasPending ? "(not scanned yet)" : "");
+	if (takeDrained())
+	{
+		publishStatistics(true);
+		emit importQueueDrained();
+	}
+	else
+	{
+		emit importStatisticsChanged(m_importQueue.statistics());
+	}
+	return dropped;
+}
+
+//-----------------------------------------------------------------------------
+QStringList isis::gui::FilesImporter::activeFolders() const
+{
+	QStringList folders;
+	for (const auto& root : m_importQueue.activeRoots())
+	{
+		folders.push_back(QString::fromStdString(root));
+	}
+	QMutexLocker foldersLocker(&m_foldersMutex);
+	for (const auto& pending : m_foldersPaths)
+	{
+		if (!folders.contains(pending))
+		{
+			folders.push_back(pending);
+		}
+	}
+	return folders;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::wakeImporter()
+{
+	// Taking the lock orders this wake after a check of the queue in run()
+	{
+		QMutexLocker locker(&m_filesMutex);
+	}
+	m_filesCondition.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::publishStatistics(const bool t_force)
+{
+	const auto now = std::chrono::steady_clock::now();
+	{
+		// Published from the import thread and the folder scan
+		QMutexLocker locker(&m_statisticsMutex);
+		if (!t_force && now - m_lastStatisticsAt < statisticsInterval)
+		{
+			return;
+		}
+		m_lastStatisticsAt = now;
+	}
+	const auto statistics = m_importQueue.statistics();
+	emit importStatisticsChanged(statistics);
+	if (t_force)
+	{
+		core::utils::logEvent(lcFilesImporter(), core::utils::LogLevel::Info,
+			"[FilesImporter] Import queue drained",
+			{{"imported", statistics.Imported},
+			 {"cancelled", statistics.Cancelled},
+			 {"scanWaits", statistics.ScanWaits},
+			 {"filesPerSecond", statistics.FilesPerSecond}});
+	}
+}
 
-		flushDiscovered(discoveredFiles);
-		qInfo() << "[FilesImporter] Finished folder" << folderPath;
+//-----------------------------------------------------------------------------
+bool isis::gui::FilesImporter::takeDrained()
+{
+	// Drained once nothing is queued, being imported or left to scan, reported once per drain
+	{
+		QMutexLocker foldersLocker(&m_foldersMutex);
+		if (!m_foldersPaths.isEmpty() || m_importQueue.statistics().ScanningRoots > 0)
+		{
+			return false;
+		}
 	}
+	QMutexLocker locker(&m_filesMutex);
+	if (m_importing || m_drainReported || !m_importQueue.isEmpty() || !m_parsedInstances.empty())
+	{
+		return false;
+	}
+	m_drainReported = true;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -220,11 +359,7 @@ bool isis::gui::FilesImporter::newSeries() const
 	const auto imageAdded = m_coreController->newImageAdded();
 	const auto lastImage = m_coreController->getLastImage();
 	const auto isMultiFrame = lastImage && lastImage->getIsMultiFrame();
-	const auto result = seriesAdded || (imageAdded && isMultiFrame);
-	qInfo() << "[FilesImporter] newSeries check -> seriesAdded:" << seriesAdded
-		<< "imageAdded:" << imageAdded << "multiFrame:" << isMultiFrame
-		<< "result:" << result;
-	return result;
+	return seriesAdded || (imageAdded && isMultiFrame);
 }
 
 //-----------------------------------------------------------------------------
@@ -233,9 +368,10 @@ void isis::gui::FilesImporter::run()
 	while (true)
 	{
 		QString nextFile;
+		std::optional<core::DicomInstanceHeader> nextHeader;
 		{
 			QMutexLocker locker(&m_filesMutex);
-			while (m_filesPaths.empty() && m_isWorking)
+			while (m_importQueue.isEmpty() && m_parsedInstances.empty() && m_isWorking)
 			{
 				m_filesCondition.wait(&m_filesMutex);
 			}
@@ -243,10 +379,52 @@ void isis::gui::FilesImporter::run()
 			{
 				return;
 			}
-			nextFile = m_filesPaths.front();
-			m_filesPaths.pop_front();
+			// Received objects and files take turns, so a steady push does not starve file imports
+			const bool takeParsed = !m_parsedInstances.empty() && (!m_filesTurn || m_importQueue.isEmpty());
+			if (takeParsed)
+			{
+				nextHeader = std::move(m_parsedInstances.front());
+				m_parsedInstances.pop_front();
+			}
+			else if (const auto item = m_importQueue.tryPop())
+			{
+				nextFile = QString::fromStdString(item->Path);
+			}
+			else if (!m_parsedInstances.empty())
+			{
+				// The file was cancelled between the check and the pop
+				nextHeader = std::move(m_parsedInstances.front());
+				m_parsedInstances.pop_front();
+			}
+			else
+			{
+				// Cancelled between the wait and the pop
+				continue;
+			}
+			m_filesTurn = nextHeader.has_value();
+			m_importing = true;
+			m_drainReported = false;
+		}
+		if (nextHeader)
+		{
+			importParsedInstance(*nextHeader);
+		}
+		else
+		{
+			importFile(nextFile);
+		}
+		m_importQueue.markImported();
+		{
+			QMutexLocker locker(&m_filesMutex);
+			m_importing = false;
+		}
+		// A folder still being listed is not drained, however far the import has caught up
+		const bool drained = takeDrained();
+		publishStatistics(drained);
+		if (drained)
+		{
+			emit importQueueDrained();
 		}
-		importFile(nextFile);
 	}
 }
 
@@ -266,13 +444,51 @@ void isis::gui::FilesImporter::importFile(const QString& t_path)
 		qWarning() << "[FilesImporter] Ignoring non-DICOM path" << t_path;
 		return;
 	}
+	const auto started = std::chrono::steady_clock::now();
 	m_coreController->readData(t_path.toStdString());
-	qInfo() << "[FilesImporter] Processed file" << t_path;
-        const bool createdNewSeries = newSeries();
-        if (createdNewSeries)
-        {
-                qInfo() << "[FilesImporter] Emitting populate signals "
-                        << "Patient index:" << m_coreController->getLastPatientIndex()
+	core::utils::telemetry().recordDuration("import.file_read",
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+	if (m_coreController->lastReadIsStructuredReport())
+	{
+		emit structuredReportFound(t_path);
+		return;
+	}
+	publishLastImage();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::importParsedInstance(const core::DicomInstanceHeader& t_header)
+{
+	const auto started = std::chrono::steady_clock::now();
+	try
+	{
+		m_coreController->readParsedData(t_header);
+	}
+	catch (const std::exception& ex)
+	{
+		qWarning() << "[FilesImporter] Parsed header rejected, importing file instead:" << ex.what();
+		importFile(QString::fromStdString(t_header.filePath));
+		return;
+	}
+	core::utils::telemetry().recordDuration("import.header_insert",
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+	if (m_coreController->lastReadIsStructuredReport())
+	{
+		emit structuredReportFound(QString::fromStdString(t_header.filePath));
+		return;
+	}
+	publishLastImage();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::FilesImporter::publishLastImage()
+{
+	const bool createdNewSeries = newSeries();
+	if (createdNewSeries)
+	{
+		core::utils::telemetry().increment("import.series_created");
+		qInfo() << "[FilesImporter] Emitting populate signals "
+			<< "Patient index:" << m_coreController->getLastPatientIndex()
 			<< "Study index:" << m_coreController->getLastStudyIndex()
 			<< "Series index:" << m_coreController->getLastSeriesIndex()
 			<< "Image index:" << m_coreController->getLastImageIndex();
@@ -282,15 +498,15 @@ void isis::gui::FilesImporter::importFile(const QString& t_path)
 			m_coreController->getLastImage());
 		emit populateWidget(m_coreController->getLastSeries(),
 			m_coreController->getLastImage());
-        }
-        const bool hasDisplayableSeries = m_coreController->getLastSeries() != nullptr;
-        if (hasDisplayableSeries)
-        {
-                emit showThumbnailsWidget(true);
-        }
-        auto* const lastImage = m_coreController->getLastImage();
-        if(lastImage && !lastImage->getIsMultiFrame())
-        {
+	}
+	const bool hasDisplayableSeries = m_coreController->getLastSeries() != nullptr;
+	if (hasDisplayableSeries)
+	{
+		emit showThumbnailsWidget(true);
+	}
+	auto* const lastImage = m_coreController->getLastImage();
+	if(lastImage && !lastImage->getIsMultiFrame())
+	{
 		emit refreshScrollValues(m_coreController->getLastSeries(),
 			m_coreController->getLastImage());
 	}
@@ -38,6 +38,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <qfuture.h>
 #include <qfuturewatcher.h>
@@ -45,6 +46,7 @@
 #include <QThread>
 #include <QWaitCondition>
 #include "corecontroller.h"
+#include "importscheduler.h"
 
 namespace isis::gui
 {
@@ -61,6 +63,10 @@ namespace isis::gui
 		void stopImporter(const QString& reason = {});
 		void addFiles(const QStringList& t_paths);
 		void addFolders(const QStringList& t_paths);
+		void addParsedInstance(const core::DicomInstanceHeader& t_header);
+		void prioritizeSeries(core::Series* t_series);
+		std::size_t cancelFolder(const QString& t_root);
+		[[nodiscard]] QStringList activeFolders() const;
 		core::CoreController* getCoreController() const { return m_coreController.get(); }
 
 	signals:
@@ -69,6 +75,9 @@ namespace isis::gui
 		void populateWidget(core::Series* t_series, core::Image* t_image);
 		void refreshScrollValues(core::Series* t_series, core::Image* t_image);
 		void showThumbnailsWidget(const bool& t_flag);
+		void structuredReportFound(const QString& t_path);
+		void importQueueDrained();
+		void importStatisticsChanged(const isis::core::ImportScheduler::Statistics& t_statistics);
 
 	protected:
 		void run() override;
@@ -78,16 +87,27 @@ namespace isis::gui
 
 	private:
 		QMutex m_filesMutex;
-		QMutex m_foldersMutex;
+		QMutex m_statisticsMutex;
+		mutable QMutex m_foldersMutex;
 		QWaitCondition m_filesCondition;
 		QFuture<void> m_futureFolders;
 		QFutureWatcher<void> m_futureWatcherFolders;
 		std::unique_ptr<core::CoreController> m_coreController = {};
-		std::deque<QString> m_filesPaths;
+		core::ImportScheduler m_importQueue;
+		std::deque<core::DicomInstanceHeader> m_parsedInstances;
 		QStringList m_foldersPaths;
 		bool m_isWorking = false;
+		bool m_filesTurn = false;
+		bool m_importing = false;
+		bool m_drainReported = false;
+		std::chrono::steady_clock::time_point m_lastStatisticsAt = {};
 
+		void wakeImporter();
+		void publishStatistics(bool t_force);
+		[[nodiscard]] bool takeDrained();
 		void importFile(const QString& t_path);
+		void importParsedInstance(const core::DicomInstanceHeader& t_header);
+		void publishLastImage();
 		static void parseFolders(FilesImporter* t_self);
 		[[nodiscard]] bool newSeries() const;
 	};
@@ -43,6 +43,7 @@
 #include <QDateTime>
 #include <QFile>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QIODevice>
 #include <QLabel>
 #include <QKeySequence>
@@ -50,6 +51,7 @@
 #include <QMetaType>
 #include <QPixmap>
 #include <QSignalBlocker>
+#include <QStatusBar>
 #include <QVBoxLayout>
 #include <QLocale>
 #include <QStringList>
@@ -75,6 +77,7 @@ void registerFilesImporterMetaTypes()
         qRegisterMetaType<isis::core::Study*>("isis::core::Study*");
         qRegisterMetaType<isis::core::Series*>("isis::core::Series*");
         qRegisterMetaType<isis::core::Image*>("isis::core::Image*");
+        qRegisterMetaType<isis::core::ImportScheduler::Statistics>("isis::core::ImportScheduler::Statistics");
 }
 
 QString loadStylesheetResource(const QString& resourcePath)
@@ -103,6 +106,7 @@ isis::gui::GUI::~GUI()
 	{
 		m_filesImporter->stopImporter(QStringLiteral("application shutdown"));
 	}
+	m_widgetsController->exportMeasurements();
 	m_widgetsController->waitForRenderingThreads();
 }
 
@@ -111,6 +115,9 @@ void isis::gui::GUI::initView()
 {
 	m_ui.setupUi(this);
         initLayoutShortcuts();
+        initViewportLinkAction();
+        initHangingProtocolAction();
+        initCancelImportAction();
 }
 
 //-----------------------------------------------------------------------------
@@ -154,6 +161,65 @@ void isis::gui::GUI::initLayoutShortcuts()
         }
 }
 
+//-----------------------------------------------------------------------------
+void isis::gui::GUI::initViewportLinkAction()
+{
+        m_linkViewportsAction = new QAction(tr("Link viewports"), this);
+        m_linkViewportsAction->setCheckable(true);
+        m_linkViewportsAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_L));
+        m_linkViewportsAction->setShortcutContext(Qt::ApplicationShortcut);
+        connect(m_linkViewportsAction, &QAction::toggled, this,
+                [this](const bool checked)
+                {
+                        m_widgetsController->setViewportLinking(checked);
+                });
+        addAction(m_linkViewportsAction);
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::GUI::initHangingProtocolAction()
+{
+        m_hangingProtocolAction = new QAction(tr("Apply hanging protocol"), this);
+        m_hangingProtocolAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_H));
+        m_hangingProtocolAction->setShortcutContext(Qt::ApplicationShortcut);
+        connect(m_hangingProtocolAction, &QAction::triggered, this,
+                [this]()
+                {
+                        m_widgetsController->applyHangingProtocol();
+                });
+        addAction(m_hangingProtocolAction);
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::GUI::initCancelImportAction()
+{
+        m_cancelImportAction = new QAction(tr("Cancel folder import"), this);
+        m_cancelImportAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Escape));
+        m_cancelImportAction->setShortcutContext(Qt::ApplicationShortcut);
+        connect(m_cancelImportAction, &QAction::triggered, this,
+                [this]()
+                {
+                        const QStringList folders = m_filesImporter->activeFolders();
+                        if (folders.isEmpty())
+                        {
+                                return;
+                        }
+                        QString folder = folders.front();
+                        if (folders.size() > 1)
+                        {
+                                bool accepted = false;
+                                folder = QInputDialog::getItem(this, tr("Cancel folder import"),
+                                        tr("Folder:"), folders, 0, false, &accepted);
+                                if (!accepted)
+                                {
+                                        return;
+                                }
+                        }
+                        m_filesImporter->cancelFolder(folder);
+                });
+        addAction(m_cancelImportAction);
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::GUI::applyDarkTheme()
 {
@@ -305,6 +371,21 @@ void isis::gui::GUI::connectFilesImporter() const
                 this,
                 &GUI::onShowThumbnailsWidget,
                 connectionType));
+        Q_UNUSED(connect(m_filesImporter.get(),
+                &FilesImporter::structuredReportFound,
+                m_widgetsController.get(),
+                &WidgetsController::importMeasurementReport,
+                connectionType));
+        Q_UNUSED(connect(m_filesImporter.get(),
+                &FilesImporter::importQueueDrained,
+                m_widgetsController.get(),
+                &WidgetsController::onImportQueueDrained,
+                connectionType));
+        Q_UNUSED(connect(m_filesImporter.get(),
+                &FilesImporter::importStatisticsChanged,
+                this,
+                &GUI::onImportStatisticsChanged,
+                connectionType));
 }
 
 //-----------------------------------------------------------------------------
@@ -321,6 +402,17 @@ void isis::gui::GUI::disconnectFilesImporter() const
 	disconnect(m_filesImporter.get(),
 	           &FilesImporter::showThumbnailsWidget,
 	           this, &GUI::onShowThumbnailsWidget);
+	disconnect(m_filesImporter.get(),
+	           &FilesImporter::structuredReportFound,
+	           m_widgetsController.get(),
+	           &WidgetsController::importMeasurementReport);
+	disconnect(m_filesImporter.get(),
+	           &FilesImporter::importQueueDrained,
+	           m_widgetsController.get(),
+	           &WidgetsController::onImportQueueDrained);
+	disconnect(m_filesImporter.get(),
+	           &FilesImporter::importStatisticsChanged,
+	           this, &GUI::onImportStatisticsChanged);
 }
 
 //-----------------------------------------------------------------------------
@@ -431,6 +523,9 @@ void isis::gui::GUI::showManagePeersDialog(QWidget* parent) const
         dialog.setDimseConfig(config);
         dialog.setConnectionPool(pool);
         dialog.exec();
+
+        // The prefetch peer may have been edited or removed
+        m_dimseNetworkManager->applyPrefetchRules();
 }
 
 //-----------------------------------------------------------------------------
@@ -456,6 +551,7 @@ void isis::gui::GUI::showQueryRetrieveDialog(QWidget* parent) const
 
         dialogs::DimseQueryWindow dialog(dialogParent);
         dialog.setDimseConfig(config);
+        dialog.setRetrieveScheduler(m_dimseNetworkManager->getRetrieveScheduler());
         dialog.setConnectionPool(pool);
         dialog.exec();
 }
@@ -552,9 +648,14 @@ void isis::gui::GUI::onCloseAllPatients()
         disconnectFilesImporter();
         onShowThumbnailsWidget(false);
         m_filesImporter->stopImporter(QStringLiteral("close all patients"));
+        m_widgetsController->exportMeasurements();
         m_widgetsController->resetData();
         m_thumbnailsWidget->resetData();
 	m_filesImporter->getCoreController()->resetData();
+        if (m_dimseNetworkManager)
+        {
+                m_dimseNetworkManager->studiesClosed();
+        }
 	connectFilesImporter();
 	m_filesImporter->startImporter();
         m_currentPatient = nullptr;
@@ -586,10 +687,43 @@ void isis::gui::GUI::onSeriesActivated(core::Patient* patient, core::Study* stud
         {
                 m_thumbnailsWidget->updateSeriesProgress(series, 0, 0);
         }
+        if (m_filesImporter && series)
+        {
+                m_filesImporter->prioritizeSeries(series);
+        }
+        if (m_dimseNetworkManager)
+        {
+                m_dimseNetworkManager->studyOpened(patient, study, series, image);
+        }
         updateStudySummary();
         updateWindowTitle();
 }
 
+//-----------------------------------------------------------------------------
+void isis::gui::GUI::onImportStatisticsChanged(const core::ImportScheduler::Statistics& statistics)
+{
+        const QLocale locale;
+        if (statistics.Queued == 0 && statistics.ScanningRoots == 0)
+        {
+                statusBar()->showMessage(tr("Imported %1 files").arg(locale.toString(
+                        static_cast<qulonglong>(statistics.Imported))), 5000);
+                return;
+        }
+        QString message = tr("Importing: %1 files done, %2 queued, %3 files/s")
+                .arg(locale.toString(static_cast<qulonglong>(statistics.Imported)))
+                .arg(locale.toString(static_cast<qulonglong>(statistics.Queued)))
+                .arg(locale.toString(statistics.FilesPerSecond, 'f', 0));
+        if (statistics.ScanningRoots > 0)
+        {
+                message += tr(", scanning %n folder(s)", nullptr, static_cast<int>(statistics.ScanningRoots));
+        }
+        if (statistics.Cancelled > 0)
+        {
+                message += tr(", %1 cancelled").arg(locale.toString(static_cast<qulonglong>(statistics.Cancelled)));
+        }
+        statusBar()->showMessage(message);
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::GUI::onActiveToolChanged(InteractionTool tool)
 {
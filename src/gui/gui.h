@@ -91,6 +91,7 @@ public:
                 void onActiveToolChanged(InteractionTool tool);
 		void onFrameMetricsChanged(const Widget2D::FrameMetrics& metrics);
 		void onCursorInfoChanged(const Widget2D::CursorInfo& info);
+		void onImportStatisticsChanged(const core::ImportScheduler::Statistics& statistics);
 	
 	private:
 		Ui::guiClass m_ui = {};
@@ -115,6 +116,9 @@ public:
 		bool m_hasCursorInfo = false;
                 InteractionTool m_activeTool = InteractionTool::scroll;
                 std::array<QAction*, 5> m_layoutShortcutActions = {};
+                QAction* m_linkViewportsAction = {};
+                QAction* m_hangingProtocolAction = {};
+                QAction* m_cancelImportAction = {};
 
 		void initView();
 		void initData();
@@ -123,6 +127,9 @@ public:
 		void disconnectFilesImporter() const;
 		void connectFunctions() const;
                 void initLayoutShortcuts();
+                void initViewportLinkAction();
+                void initHangingProtocolAction();
+                void initCancelImportAction();
                 void applyDarkTheme();
                 void updateStudySummary();
                 void updateWindowTitle();
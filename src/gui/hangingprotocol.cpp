@@ -0,0 +1,428 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: hangingprotocol.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of hanging protocol matching and persistence
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "hangingprotocol.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+        // Required criteria outweigh any number of filled viewports
+        constexpr int RequiredCriterionScore = 10;
+        constexpr int KeywordScore = 2;
+
+        bool equalsIgnoreCase(const std::string& a, const std::string& b)
+        {
+                return a.size() == b.size()
+                        && std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y)
+                        {
+                                return std::toupper(x) == std::toupper(y);
+                        });
+        }
+
+        bool containsIgnoreCase(const std::string& text, const std::string& keyword)
+        {
+                if (keyword.empty())
+                {
+                        return false;
+                }
+                const auto it = std::search(text.begin(), text.end(), keyword.begin(), keyword.end(),
+                        [](unsigned char x, unsigned char y)
+                        {
+                                return std::toupper(x) == std::toupper(y);
+                        });
+                return it != text.end();
+        }
+
+        bool matchesAny(const std::vector<std::string>& values, const std::string& value)
+        {
+                return std::any_of(values.begin(), values.end(),
+                        [&value](const std::string& candidate) { return equalsIgnoreCase(candidate, value); });
+        }
+
+        bool containsAny(const std::vector<std::string>& keywords, const std::string& text)
+        {
+                return std::any_of(keywords.begin(), keywords.end(),
+                        [&text](const std::string& keyword) { return containsIgnoreCase(text, keyword); });
+        }
+
+        bool matchesBodyPart(const std::vector<std::string>& bodyParts, const isis::gui::HangingSeries& series)
+        {
+                // Body Part Examined is often missing; the descriptions usually name it
+                return matchesAny(bodyParts, series.bodyPart)
+                        || containsAny(bodyParts, series.description)
+                        || containsAny(bodyParts, series.studyDescription);
+        }
+
+        bool matchesModality(const std::vector<std::string>& modalities, const isis::gui::HangingSeries& series)
+        {
+                return modalities.empty() || matchesAny(modalities, series.modality);
+        }
+
+        std::vector<int> assignViewports(const isis::gui::HangingProtocol& protocol,
+                                         const std::vector<isis::gui::HangingSeries>& series)
+        {
+                std::vector<int> assigned(protocol.viewports.size(), -1);
+                std::vector<bool> used(series.size(), false);
+                for (std::size_t i = 0; i < protocol.viewports.size(); ++i)
+                {
+                        const auto& rule = protocol.viewports[i];
+                        if (rule.sameAs >= 0 && static_cast<std::size_t>(rule.sameAs) < i)
+                        {
+                                assigned[i] = assigned[static_cast<std::size_t>(rule.sameAs)];
+                                continue;
+                        }
+
+                        std::string preferredDescription;
+                        if (rule.matchDescriptionOf >= 0 && static_cast<std::size_t>(rule.matchDescriptionOf) < i
+                                && assigned[static_cast<std::size_t>(rule.matchDescriptionOf)] >= 0)
+                        {
+                                preferredDescription = series[static_cast<std::size_t>(
+                                        assigned[static_cast<std::size_t>(rule.matchDescriptionOf)])].description;
+                        }
+
+                        const auto& modalities = rule.modalities.empty() ? protocol.modalities : rule.modalities;
+                        int best = -1;
+                        bool bestPreferred = false;
+                        for (std::size_t j = 0; j < series.size(); ++j)
+                        {
+                                const auto& candidate = series[j];
+                                if (used[j] || candidate.prior != rule.prior || !matchesModality(modalities, candidate)
+                                        || (!rule.descriptionKeywords.empty()
+                                                && !containsAny(rule.descriptionKeywords, candidate.description)))
+                                {
+                                        continue;
+                                }
+                                const bool preferred = !preferredDescription.empty()
+                                        && equalsIgnoreCase(candidate.description, preferredDescription);
+                                if (best < 0 || (preferred && !bestPreferred))
+                                {
+                                        best = static_cast<int>(j);
+                                        bestPreferred = preferred;
+                                }
+                        }
+                        if (best >= 0)
+                        {
+                                used[static_cast<std::size_t>(best)] = true;
+                                assigned[i] = best;
+                        }
+                }
+                return assigned;
+        }
+
+        std::vector<std::string> stringList(const QJsonValue& value)
+        {
+                std::vector<std::string> values;
+                for (const QJsonValue& entry : value.toArray())
+                {
+                        const QString text = entry.toString().trimmed();
+                        if (!text.isEmpty())
+                        {
+                                values.push_back(text.toStdString());
+                        }
+                }
+                return values;
+        }
+
+        QJsonArray jsonList(const std::vector<std::string>& values)
+        {
+                QJsonArray array;
+                for (const auto& value : values)
+                {
+                        array.append(QString::fromStdString(value));
+                }
+                return array;
+        }
+
+        isis::gui::HangingViewportRule viewport(int prior = 0, std::vector<std::string> keywords = {})
+        {
+                isis::gui::HangingViewportRule rule;
+                rule.prior = prior;
+                rule.descriptionKeywords = std::move(keywords);
+                return rule;
+        }
+
+        isis::gui::HangingViewportRule windowed(double center, double width)
+        {
+                isis::gui::HangingViewportRule rule;
+                rule.windowCenter = center;
+                rule.windowWidth = width;
+                return rule;
+        }
+}
+
+int isis::gui::HangingPlan::filledViewports() const
+{
+        return static_cast<int>(std::count_if(viewportSeries.begin(), viewportSeries.end(),
+                [](int index) { return index >= 0; }));
+}
+
+//-----------------------------------------------------------------------------
+isis::gui::HangingProtocolEngine::HangingProtocolEngine()
+        : m_protocols(defaultProtocols())
+{
+}
+
+//-----------------------------------------------------------------------------
+std::optional<isis::gui::HangingPlan> isis::gui::HangingProtocolEngine::match(
+        const std::vector<HangingSeries>& t_series) const
+{
+        std::optional<HangingPlan> best;
+        for (const auto& protocol : m_protocols)
+        {
+                if (protocol.viewports.empty())
+                {
+                        continue;
+                }
+
+                int score = 0;
+                const auto inCurrentStudy = [&t_series](const auto& predicate)
+                {
+                        return std::any_of(t_series.begin(), t_series.end(), [&predicate](const HangingSeries& series)
+                        {
+                                return series.prior == 0 && predicate(series);
+                        });
+                };
+                if (!protocol.modalities.empty())
+                {
+                        if (!inCurrentStudy([&protocol](const HangingSeries& series)
+                                { return matchesAny(protocol.modalities, series.modality); }))
+                        {
+                                continue;
+                        }
+                        score += RequiredCriterionScore;
+                }
+                if (!protocol.bodyParts.empty())
+                {
+                        if (!inCurrentStudy([&protocol](const HangingSeries& series)
+                                { return matchesBodyPart(protocol.bodyParts, series); }))
+                        {
+                                continue;
+                        }
+                        score += RequiredCriterionScore;
+                }
+                if (protocol.requiredPriors > 0)
+                {
+                        bool priorsAvailable = true;
+                        for (int prior = 1; prior <= protocol.requiredPriors && priorsAvailable; ++prior)
+                        {
+                                priorsAvailable = std::any_of(t_series.begin(), t_series.end(),
+                                        [&protocol, prior](const HangingSeries& series)
+                                        {
+                                                return series.prior == prior && matchesModality(protocol.modalities, series);
+                                        });
+                        }
+                        if (!priorsAvailable)
+                        {
+                                continue;
+                        }
+                        score += RequiredCriterionScore;
+                }
+                if (!protocol.descriptionKeywords.empty()
+                        && inCurrentStudy([&protocol](const HangingSeries& series)
+                        {
+                                return containsAny(protocol.descriptionKeywords, series.description)
+                                        || containsAny(protocol.descriptionKeywords, series.studyDescription);
+                        }))
+                {
+                        score += KeywordScore;
+                }
+
+                HangingPlan plan;
+                plan.protocol = &protocol;
+                plan.viewportSeries = assignViewports(protocol, t_series);
+                if (plan.viewportSeries.front() < 0)
+                {
+                        continue;
+                }
+                plan.score = score + plan.filledViewports();
+                if (!best || plan.score > best->score)
+                {
+                        best = std::move(plan);
+                }
+        }
+        return best;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::HangingProtocolEngine::loadFromFile(const QString& t_path, QString& t_error)
+{
+        QFile file(t_path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+                t_error = file.errorString();
+                return false;
+        }
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.isObject())
+        {
+                t_error = parseError.errorString();
+                return false;
+        }
+
+        std::vector<HangingProtocol> protocols;
+        for (const QJsonValue& value : document.object()["protocols"].toArray())
+        {
+                auto protocol = protocolFromJson(value.toObject());
+                if (!protocol.viewports.empty())
+                {
+                        protocols.push_back(std::move(protocol));
+                }
+        }
+        if (protocols.empty())
+        {
+                t_error = QStringLiteral("No hanging protocol with viewports in %1").arg(t_path);
+                return false;
+        }
+        m_protocols = std::move(protocols);
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::HangingProtocolEngine::saveToFile(const QString& t_path, QString& t_error) const
+{
+        QJsonArray protocols;
+        for (const auto& protocol : m_protocols)
+        {
+                protocols.append(protocolToJson(protocol));
+        }
+        QJsonObject root;
+        root["protocols"] = protocols;
+
+        QFile file(t_path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+                t_error = file.errorString();
+                return false;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+isis::gui::HangingProtocol isis::gui::HangingProtocolEngine::protocolFromJson(const QJsonObject& t_object)
+{
+        HangingProtocol protocol;
+        protocol.name = t_object["name"].toString().toStdString();
+        protocol.layout = t_object["layout"].toString("one").toStdString();
+        protocol.modalities = stringList(t_object["modalities"]);
+        protocol.bodyParts = stringList(t_object["bodyParts"]);
+        protocol.descriptionKeywords = stringList(t_object["descriptionKeywords"]);
+        protocol.requiredPriors = std::max(0, t_object["requiredPriors"].toInt(0));
+        for (const QJsonValue& value : t_object["viewports"].toArray())
+        {
+                const QJsonObject object = value.toObject();
+                HangingViewportRule rule;
+                rule.modalities = stringList(object["modalities"]);
+                rule.descriptionKeywords = stringList(object["descriptionKeywords"]);
+                rule.prior = std::max(0, object["prior"].toInt(0));
+                rule.sameAs = object["sameAs"].toInt(-1);
+                rule.matchDescriptionOf = object["matchDescriptionOf"].toInt(-1);
+                rule.windowCenter = object["windowCenter"].toDouble(0.0);
+                rule.windowWidth = std::max(0.0, object["windowWidth"].toDouble(0.0));
+                rule.rotationSteps = ((object["rotationSteps"].toInt(0) % 4) + 4) % 4;
+                rule.flipHorizontal = object["flipHorizontal"].toBool(false);
+                rule.flipVertical = object["flipVertical"].toBool(false);
+                rule.invert = object["invert"].toBool(false);
+                protocol.viewports.push_back(std::move(rule));
+        }
+        return protocol;
+}
+
+//-----------------------------------------------------------------------------
+QJsonObject isis::gui::HangingProtocolEngine::protocolToJson(const HangingProtocol& t_protocol)
+{
+        QJsonObject object;
+        object["name"] = QString::fromStdString(t_protocol.name);
+        object["layout"] = QString::fromStdString(t_protocol.layout);
+        object["modalities"] = jsonList(t_protocol.modalities);
+        object["bodyParts"] = jsonList(t_protocol.bodyParts);
+        object["descriptionKeywords"] = jsonList(t_protocol.descriptionKeywords);
+        object["requiredPriors"] = t_protocol.requiredPriors;
+
+        QJsonArray viewports;
+        for (const auto& rule : t_protocol.viewports)
+        {
+                QJsonObject viewport;
+                viewport["modalities"] = jsonList(rule.modalities);
+                viewport["descriptionKeywords"] = jsonList(rule.descriptionKeywords);
+                viewport["prior"] = rule.prior;
+                viewport["sameAs"] = rule.sameAs;
+                viewport["matchDescriptionOf"] = rule.matchDescriptionOf;
+                viewport["windowCenter"] = rule.windowCenter;
+                viewport["windowWidth"] = rule.windowWidth;
+                viewport["rotationSteps"] = rule.rotationSteps;
+                viewport["flipHorizontal"] = rule.flipHorizontal;
+                viewport["flipVertical"] = rule.flipVertical;
+                viewport["invert"] = rule.invert;
+                viewports.append(viewport);
+        }
+        object["viewports"] = viewports;
+        return object;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<isis::gui::HangingProtocol> isis::gui::HangingProtocolEngine::defaultProtocols()
+{
+        std::vector<HangingProtocol> protocols;
+
+        // Same series twice: lung and mediastinal windows
+        HangingProtocol chest;
+        chest.name = "CT Chest";
+        chest.layout = "twoColumnOneRight";
+        chest.modalities = {"CT"};
+        chest.bodyParts = {"CHEST", "THORAX", "LUNG"};
+        chest.viewports = {windowed(-600.0, 1500.0), windowed(40.0, 400.0)};
+        chest.viewports[1].sameAs = 0;
+        protocols.push_back(chest);
+
+        HangingProtocol brain;
+        brain.name = "MR Brain";
+        brain.layout = "threeColumnOneRight";
+        brain.modalities = {"MR"};
+        brain.bodyParts = {"HEAD", "BRAIN"};
+        brain.viewports = {viewport(0, {"T1"}), viewport(0, {"FLAIR"}), viewport(0, {"T2"})};
+        protocols.push_back(brain);
+
+        // Current study next to the most recent prior of the same modality
+        for (const char* modality : {"CT", "MR", "CR", "DX", "MG"})
+        {
+                HangingProtocol comparison;
+                comparison.name = std::string(modality) + " with prior";
+                comparison.layout = "twoColumnOneRight";
+                comparison.modalities = {modality};
+                comparison.requiredPriors = 1;
+                comparison.viewports = {viewport(0), viewport(1)};
+                comparison.viewports[1].matchDescriptionOf = 0;
+                protocols.push_back(comparison);
+        }
+        return protocols;
+}
+
+//-----------------------------------------------------------------------------
+QString isis::gui::HangingProtocolEngine::defaultPath()
+{
+        const QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        return dir.filePath(QStringLiteral("hanging_protocols.json"));
+}
@@ -0,0 +1,118 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: hangingprotocol.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Rule-based hanging protocols: a protocol is matched on the modality,
+ *      body part and descriptions of a study and the priors available for the
+ *      patient, and chooses a layout and the series, window and orientation
+ *      shown in each viewport. Protocols are read from a JSON file in the
+ *      application data folder, falling back to built-in defaults.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace isis::gui
+{
+        /**
+         * @brief Series offered to the protocol engine
+         */
+        struct HangingSeries
+        {
+                std::string modality;
+                std::string bodyPart;
+                std::string description;
+                std::string studyDescription;
+                int prior = 0;                          // 0 current study, 1 most recent prior, ...
+        };
+
+        /**
+         * @brief What one viewport of a protocol shows
+         */
+        struct HangingViewportRule
+        {
+                std::vector<std::string> modalities;            // Empty: those of the protocol
+                std::vector<std::string> descriptionKeywords;   // Any of them, case-insensitive; empty: any series
+                int prior = 0;
+                int sameAs = -1;                        // Show the series of another viewport
+                int matchDescriptionOf = -1;            // Prefer the description shown in another viewport
+                double windowCenter = 0.0;
+                double windowWidth = 0.0;               // 0 keeps the window of the series
+                int rotationSteps = 0;                  // Quarter turns clockwise
+                bool flipHorizontal = false;
+                bool flipVertical = false;
+                bool invert = false;
+        };
+
+        struct HangingProtocol
+        {
+                std::string name;
+                std::string layout;                     // WidgetsController layout name ("one", "twoColumnOneRight", ...)
+                std::vector<std::string> modalities;    // Required when not empty
+                std::vector<std::string> bodyParts;     // Required when not empty (Body Part Examined or descriptions)
+                std::vector<std::string> descriptionKeywords;   // Only raise the score
+                int requiredPriors = 0;
+                std::vector<HangingViewportRule> viewports;
+        };
+
+        /**
+         * @brief Protocol chosen for a study and the series of each viewport
+         */
+        struct HangingPlan
+        {
+                const HangingProtocol* protocol = nullptr;
+                int score = 0;
+                std::vector<int> viewportSeries;        // Index into the offered series, -1 when empty
+
+                [[nodiscard]] int filledViewports() const;
+        };
+
+        class HangingProtocolEngine
+        {
+        public:
+                HangingProtocolEngine();
+
+                void setProtocols(std::vector<HangingProtocol> t_protocols) { m_protocols = std::move(t_protocols); }
+                [[nodiscard]] const std::vector<HangingProtocol>& protocols() const { return m_protocols; }
+
+                /**
+                 * @brief Best matching protocol for the series of a patient
+                 *
+                 * A protocol matches when its modality, body part and prior
+                 * requirements are met by the current study and its first
+                 * viewport can be filled. More specific protocols and protocols
+                 * filling more viewports score higher; ties keep the earlier one.
+                 */
+                [[nodiscard]] std::optional<HangingPlan> match(const std::vector<HangingSeries>& t_series) const;
+
+                /**
+                 * @brief Replace the protocols with those of a JSON file
+                 * @return false with a message in t_error if the file could not be read
+                 */
+                bool loadFromFile(const QString& t_path, QString& t_error);
+                bool saveToFile(const QString& t_path, QString& t_error) const;
+
+                [[nodiscard]] static std::vector<HangingProtocol> defaultProtocols();
+                [[nodiscard]] static QString defaultPath();
+
+                [[nodiscard]] static HangingProtocol protocolFromJson(const QJsonObject& t_object);
+                [[nodiscard]] static QJsonObject protocolToJson(const HangingProtocol& t_protocol);
+
+        private:
+                std::vector<HangingProtocol> m_protocols;
+        };
+}
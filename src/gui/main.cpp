@@ -53,8 +53,6 @@
 #include <QSurfaceFormat>
 #include <QVTKOpenGLNativeWidget.h>
 #include <QStandardPaths>
-#include <QMutex>
-#include <QMutexLocker>
 #include <QTextStream>
 #include <QString>
 
@@ -74,6 +72,7 @@
 #include "dicomvolume.h"
 #include "image.h"
 #include "vtkwidgetdicom.h"
+#include "utils/structuredlog.h"
 
 VTK_MODULE_INIT(vtkRenderingOpenGL2);
 VTK_MODULE_INIT(vtkInteractionStyle);
@@ -82,49 +81,6 @@ VTK_MODULE_INIT(vtkRenderingVolumeOpenGL2);
 
 namespace
 {
-QFile g_logFile;
-QMutex g_logMutex;
-
-QString logTypeToString(QtMsgType type)
-{
-	switch (type)
-	{
-	case QtDebugMsg: return "DEBUG";
-	case QtInfoMsg: return "INFO";
-	case QtWarningMsg: return "WARN";
-	case QtCriticalMsg: return "CRITICAL";
-	case QtFatalMsg: return "FATAL";
-	default: return "UNKNOWN";
-	}
-}
-
-void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
-{
-	QMutexLocker locker(&g_logMutex);
-
-	if (!g_logFile.isOpen())
-	{
-		return;
-	}
-
-	QTextStream stream(&g_logFile);
-	stream << QDateTime::currentDateTime().toString(Qt::ISODateWithMs) << " ["
-	       << logTypeToString(type) << "] ";
-
-	if (context.function && *context.function)
-	{
-		stream << context.function << " - ";
-	}
-
-	stream << message << '\n';
-	stream.flush();
-
-	if (type == QtFatalMsg)
-	{
-		abort();
-	}
-}
-
 void setupLogging()
 {
 	const auto logDirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -142,15 +98,23 @@ void setupLogging()
 		return;
 	}
 
-	g_logFile.setFileName(logDir.filePath("viewer.log"));
-	if (!g_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+	auto sink = std::make_unique<isis::core::utils::FileLogSink>(logDir.filePath("viewer.log"));
+	if (!sink->isOpen())
 	{
-		qWarning() << "[Logging] Could not open log file at" << g_logFile.fileName();
+		qWarning() << "[Logging] Could not open log file at" << sink->fileName();
 		return;
 	}
-
-	qInstallMessageHandler(messageHandler);
-	qInfo() << "[Logging] Initialized. File:" << g_logFile.fileName();
+	const QString logFileName = sink->fileName();
+
+	// Records are formatted and written on the logger thread; hot categories are
+	// sampled so interactive paths (W/L drags, slice scrolling) cannot flood the file.
+	auto& logger = isis::core::utils::StructuredLogger::instance();
+	logger.setSink(std::move(sink));
+	logger.setCategoryPolicy("isis.gui.windowlevelfilter", {1, 5.0, 10.0});
+	logger.setCategoryPolicy("isis.gui.widget2d", {1, 50.0, 100.0});
+	logger.setCategoryPolicy("isis.core.dicom", {1, 50.0, 200.0});
+	isis::core::utils::StructuredLogger::installQtMessageHandler();
+	qInfo() << "[Logging] Initialized. File:" << logFileName;
 }
 } // namespace
 
@@ -359,6 +323,8 @@ void setupLogging()
 	isis::gui::GUI gui;
 	guiFrame.setContent(&gui);
 	guiFrame.showMaximized();
-	return application.exec();
+	const int exitCode = application.exec();
+	isis::core::utils::StructuredLogger::instance().shutdown();
+	return exitCode;
 }
 
@@ -84,4 +84,30 @@ namespace isis::gui::measures
         return 0.0;
     }
 
+    bool AngleMeasureTool::isPlaced() const
+    {
+        return m_angleWidget && m_angleWidget->GetWidgetState() == vtkAngleWidget::Manipulate;
+    }
+
+    std::vector<std::array<double, 3>> AngleMeasureTool::getWorldPoints() const
+    {
+        std::vector<std::array<double, 3>> points;
+        if (!m_angleWidget)
+        {
+            return points;
+        }
+
+        auto* representation = static_cast<vtkAngleRepresentation*>(
+            m_angleWidget->GetRepresentation());
+
+        if (representation)
+        {
+            representation->GetPoint1WorldPosition(points.emplace_back().data());
+            representation->GetCenterWorldPosition(points.emplace_back().data());
+            representation->GetPoint2WorldPosition(points.emplace_back().data());
+        }
+
+        return points;
+    }
+
 } // namespace isis::gui::measures
@@ -20,6 +20,8 @@
 #include <vtkAngleWidget.h>
 #include <vtkAngleRepresentation.h>
 #include <vtkRenderWindowInteractor.h>
+#include <array>
+#include <vector>
 
 namespace isis::gui::measures
 {
@@ -68,6 +70,18 @@ namespace isis::gui::measures
          */
         [[nodiscard]] double getAngle() const;
 
+        /**
+         * @brief Check if a measurement has been completely placed
+         * @return true once every handle is set, false while still defining
+         */
+        [[nodiscard]] bool isPlaced() const;
+
+        /**
+         * @brief Get the world positions of the measurement handles
+         * @return First arm end, vertex, second arm end
+         */
+        [[nodiscard]] std::vector<std::array<double, 3>> getWorldPoints() const;
+
         /**
          * @brief Get the underlying VTK widget
          * @return Pointer to the vtkAngleWidget
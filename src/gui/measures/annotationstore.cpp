@@ -0,0 +1,620 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: annotationstore.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the annotation store and its per-series R-tree
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "annotationstore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+namespace isis::gui::measures
+{
+    namespace
+    {
+        double dot(const Point3& a, const Point3& b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        Point3 cross(const Point3& a, const Point3& b)
+        {
+            return {a[1] * b[2] - a[2] * b[1],
+                    a[2] * b[0] - a[0] * b[2],
+                    a[0] * b[1] - a[1] * b[0]};
+        }
+
+        Point3 normalized(const Point3& v)
+        {
+            const double length = std::sqrt(dot(v, v));
+            if (length <= 0.0 || !std::isfinite(length))
+            {
+                return v;
+            }
+            return {v[0] / length, v[1] / length, v[2] / length};
+        }
+
+        double center(const AnnotationSpatialIndex::Box& box, int axis)
+        {
+            return 0.5 * (box.min[axis] + box.max[axis]);
+        }
+
+        // Distance from p to segment ab, in the row/column plane
+        double segmentDistance(const Point3& p, const Point3& a, const Point3& b)
+        {
+            const double dx = b[1] - a[1];
+            const double dy = b[2] - a[2];
+            const double lengthSquared = dx * dx + dy * dy;
+            double t = 0.0;
+            if (lengthSquared > 0.0)
+            {
+                t = std::clamp(((p[1] - a[1]) * dx + (p[2] - a[2]) * dy) / lengthSquared, 0.0, 1.0);
+            }
+            const double x = a[1] + t * dx - p[1];
+            const double y = a[2] + t * dy - p[2];
+            return std::sqrt(x * x + y * y);
+        }
+
+        // Another frame of the displayed multi-frame instance: a different slice even
+        // when the instance carries a single position for all of its frames
+        bool isOnOtherFrame(const Annotation& annotation, const SlicePlane& plane)
+        {
+            return !plane.sopInstanceUID.empty() && annotation.sopInstanceUID == plane.sopInstanceUID
+                && annotation.frameNumber != plane.frameNumber;
+        }
+
+        // Nodes per slab along the slice axis; kept small because the displayed-slice
+        // query is unbounded in-plane and visits every node of the slabs it reaches
+        constexpr std::size_t SlabNodes = 4;
+
+        /**
+         * Sort-Tile-Recursive ordering: thin slabs along the slice axis, then tiles
+         * along the row axis, then runs along the column axis, so that consecutive
+         * groups of NodeCapacity items are spatially compact. Inner levels are only
+         * ordered by slice: their boxes already span whole slabs in-plane, and
+         * mixing slices there would widen every parent across many slices.
+         */
+        template <typename T, typename BoxOf>
+        void strSort(std::vector<T>& items, BoxOf boxOf, bool tileInPlane)
+        {
+            const std::size_t capacity = AnnotationSpatialIndex::NodeCapacity;
+            const std::size_t groups = (items.size() + capacity - 1) / capacity;
+            if (groups <= 1)
+            {
+                return;
+            }
+
+            const auto byAxis = [&boxOf](int axis)
+            {
+                return [&boxOf, axis](const T& a, const T& b)
+                {
+                    return center(boxOf(a), axis) < center(boxOf(b), axis);
+                };
+            };
+
+            std::sort(items.begin(), items.end(), byAxis(0));
+            if (!tileInPlane)
+            {
+                return;
+            }
+
+            const std::size_t slabSize = capacity * SlabNodes;
+
+            for (std::size_t slabStart = 0; slabStart < items.size(); slabStart += slabSize)
+            {
+                const auto slabBegin = items.begin() + static_cast<std::ptrdiff_t>(slabStart);
+                const auto slabEnd = items.begin() + static_cast<std::ptrdiff_t>(std::min(slabStart + slabSize, items.size()));
+                std::sort(slabBegin, slabEnd, byAxis(1));
+
+                const auto slabCount = static_cast<std::size_t>(slabEnd - slabBegin);
+                const std::size_t slabGroups = (slabCount + capacity - 1) / capacity;
+                const auto tiles = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(slabGroups))));
+                const std::size_t tileSize = capacity * static_cast<std::size_t>(
+                    std::ceil(static_cast<double>(slabGroups) / static_cast<double>(tiles)));
+
+                for (std::size_t tileStart = 0; tileStart < slabCount; tileStart += tileSize)
+                {
+                    const auto tileBegin = slabBegin + static_cast<std::ptrdiff_t>(tileStart);
+                    const auto tileEnd = slabBegin + static_cast<std::ptrdiff_t>(std::min(tileStart + tileSize, slabCount));
+                    std::sort(tileBegin, tileEnd, byAxis(2));
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+    Point3 SlicePlane::normal() const
+    {
+        return normalized(cross(row, column));
+    }
+
+    double SlicePlane::position() const
+    {
+        return dot(origin, normal());
+    }
+
+    Point3 SlicePlane::toPatient(double x, double y) const
+    {
+        return {origin[0] + x * row[0] + y * column[0],
+                origin[1] + x * row[1] + y * column[1],
+                origin[2] + x * row[2] + y * column[2]};
+    }
+
+    Point3 SlicePlane::toPlane(const Point3& patient) const
+    {
+        const Point3 offset = {patient[0] - origin[0], patient[1] - origin[1], patient[2] - origin[2]};
+        return {dot(offset, row), dot(offset, column), dot(offset, normal())};
+    }
+
+    //-----------------------------------------------------------------------------
+    std::vector<std::pair<std::size_t, std::size_t>> Annotation::segments() const
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> result;
+        switch (type)
+        {
+        case AnnotationType::Distance:
+            if (points.size() >= 2)
+            {
+                result.emplace_back(0, 1);
+            }
+            break;
+
+        case AnnotationType::Angle:
+            if (points.size() >= 3)
+            {
+                result.emplace_back(0, 1);
+                result.emplace_back(1, 2);
+            }
+            break;
+
+        case AnnotationType::BiDimensional:
+            if (points.size() >= 4)
+            {
+                result.emplace_back(0, 1);
+                result.emplace_back(2, 3);
+            }
+            break;
+
+        case AnnotationType::Contour:
+            for (std::size_t i = 1; i < points.size(); ++i)
+            {
+                result.emplace_back(i - 1, i);
+            }
+            if (closed && points.size() > 2)
+            {
+                result.emplace_back(points.size() - 1, 0);
+            }
+            break;
+        }
+        return result;
+    }
+
+    //-----------------------------------------------------------------------------
+    bool AnnotationSpatialIndex::Box::intersects(const Box& other) const
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (max[axis] < other.min[axis] || other.max[axis] < min[axis])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void AnnotationSpatialIndex::Box::expand(const Box& other)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], other.min[axis]);
+            max[axis] = std::max(max[axis], other.max[axis]);
+        }
+    }
+
+    void AnnotationSpatialIndex::setOrientation(const Point3& row, const Point3& column)
+    {
+        m_row = normalized(row);
+        m_column = normalized(column);
+        m_normal = normalized(cross(m_row, m_column));
+        m_hasOrientation = true;
+
+        for (auto& [id, entry] : m_entries)
+        {
+            Annotation projected;
+            projected.points = entry.points;
+            entry.box = bounds(projected);
+        }
+        m_dirty = true;
+    }
+
+    Point3 AnnotationSpatialIndex::project(const Point3& patient) const
+    {
+        return {dot(patient, m_normal), dot(patient, m_row), dot(patient, m_column)};
+    }
+
+    AnnotationSpatialIndex::Box AnnotationSpatialIndex::bounds(const Annotation& annotation) const
+    {
+        Box box;
+        if (annotation.points.empty())
+        {
+            return box;
+        }
+
+        box.min = box.max = project(annotation.points.front());
+        for (const auto& point : annotation.points)
+        {
+            const Point3 projected = project(point);
+            box.expand(Box{projected, projected});
+        }
+        return box;
+    }
+
+    void AnnotationSpatialIndex::insert(const Annotation& annotation)
+    {
+        Entry& entry = m_entries[annotation.id];
+        entry.id = annotation.id;
+        entry.box = bounds(annotation);
+        entry.points = annotation.points;
+        m_dirty = true;
+    }
+
+    void AnnotationSpatialIndex::erase(AnnotationId id)
+    {
+        if (m_entries.erase(id) > 0)
+        {
+            m_dirty = true;
+        }
+    }
+
+    void AnnotationSpatialIndex::clear()
+    {
+        m_entries.clear();
+        m_order.clear();
+        m_nodes.clear();
+        m_dirty = false;
+    }
+
+    void AnnotationSpatialIndex::rebuild() const
+    {
+        m_dirty = false;
+        m_order.clear();
+        m_nodes.clear();
+        if (m_entries.empty())
+        {
+            return;
+        }
+
+        m_order.reserve(m_entries.size());
+        for (const auto& [id, entry] : m_entries)
+        {
+            m_order.push_back(&entry);
+        }
+        strSort(m_order, [](const Entry* entry) -> const Box& { return entry->box; }, true);
+
+        // Leaves over consecutive runs of the ordered entries
+        std::vector<Node> level;
+        level.reserve(m_order.size() / NodeCapacity + 1);
+        for (std::size_t first = 0; first < m_order.size(); first += NodeCapacity)
+        {
+            Node leaf;
+            leaf.first = static_cast<std::uint32_t>(first);
+            leaf.count = static_cast<std::uint32_t>(std::min(NodeCapacity, m_order.size() - first));
+            leaf.box = m_order[first]->box;
+            for (std::uint32_t i = 1; i < leaf.count; ++i)
+            {
+                leaf.box.expand(m_order[first + i]->box);
+            }
+            level.push_back(leaf);
+        }
+
+        // Pack each level the same way until a single root remains
+        while (true)
+        {
+            strSort(level, [](const Node& node) -> const Box& { return node.box; }, false);
+            const auto levelStart = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.insert(m_nodes.end(), level.begin(), level.end());
+            if (level.size() == 1)
+            {
+                break;
+            }
+
+            std::vector<Node> parents;
+            parents.reserve(level.size() / NodeCapacity + 1);
+            for (std::size_t first = 0; first < level.size(); first += NodeCapacity)
+            {
+                Node parent;
+                parent.leaf = false;
+                parent.first = levelStart + static_cast<std::uint32_t>(first);
+                parent.count = static_cast<std::uint32_t>(std::min(NodeCapacity, level.size() - first));
+                parent.box = level[first].box;
+                for (std::uint32_t i = 1; i < parent.count; ++i)
+                {
+                    parent.box.expand(level[first + i].box);
+                }
+                parents.push_back(parent);
+            }
+            level = std::move(parents);
+        }
+    }
+
+    std::vector<AnnotationId> AnnotationSpatialIndex::query(const Box& box) const
+    {
+        if (m_dirty)
+        {
+            rebuild();
+        }
+
+        std::vector<AnnotationId> result;
+        m_lastVisitedNodes = 0;
+        if (m_nodes.empty())
+        {
+            return result;
+        }
+
+        std::vector<std::uint32_t> stack = {static_cast<std::uint32_t>(m_nodes.size() - 1)};
+        while (!stack.empty())
+        {
+            const Node& node = m_nodes[stack.back()];
+            stack.pop_back();
+            ++m_lastVisitedNodes;
+            if (!node.box.intersects(box))
+            {
+                continue;
+            }
+
+            for (std::uint32_t i = 0; i < node.count; ++i)
+            {
+                if (node.leaf)
+                {
+                    const Entry* entry = m_order[node.first + i];
+                    if (entry->box.intersects(box))
+                    {
+                        result.push_back(entry->id);
+                    }
+                }
+                else
+                {
+                    stack.push_back(node.first + i);
+                }
+            }
+        }
+        return result;
+    }
+
+    //-----------------------------------------------------------------------------
+    AnnotationId AnnotationStore::add(Annotation annotation)
+    {
+        annotation.id = m_nextId++;
+        const AnnotationId id = annotation.id;
+        m_indexes[annotation.seriesInstanceUID].insert(annotation);
+        m_annotations.emplace(id, std::move(annotation));
+        return id;
+    }
+
+    std::size_t AnnotationStore::merge(const std::vector<Annotation>& annotations)
+    {
+        // Reports read again (the same folder imported twice) do not duplicate their measurements
+        std::unordered_map<std::string, std::unordered_set<std::string>> known;
+        std::size_t added = 0;
+        for (const Annotation& annotation : annotations)
+        {
+            if (annotation.points.empty())
+            {
+                continue;
+            }
+            if (!annotation.trackingUID.empty())
+            {
+                auto [tracked, inserted] = known.try_emplace(annotation.seriesInstanceUID);
+                if (inserted)
+                {
+                    for (const Annotation* existing : this->annotations(annotation.seriesInstanceUID))
+                    {
+                        tracked->second.insert(existing->trackingUID);
+                    }
+                }
+                if (!tracked->second.insert(annotation.trackingUID).second)
+                {
+                    continue;
+                }
+            }
+            add(annotation);
+            ++added;
+        }
+        return added;
+    }
+
+    bool AnnotationStore::update(AnnotationId id, const std::vector<Point3>& points)
+    {
+        const auto it = m_annotations.find(id);
+        if (it == m_annotations.end())
+        {
+            return false;
+        }
+
+        it->second.points = points;
+        m_indexes[it->second.seriesInstanceUID].insert(it->second);
+        return true;
+    }
+
+    bool AnnotationStore::remove(AnnotationId id)
+    {
+        const auto it = m_annotations.find(id);
+        if (it == m_annotations.end())
+        {
+            return false;
+        }
+
+        const auto index = m_indexes.find(it->second.seriesInstanceUID);
+        if (index != m_indexes.end())
+        {
+            index->second.erase(id);
+            if (index->second.size() == 0)
+            {
+                m_indexes.erase(index);
+            }
+        }
+        m_annotations.erase(it);
+        return true;
+    }
+
+    void AnnotationStore::clear()
+    {
+        m_annotations.clear();
+        m_indexes.clear();
+    }
+
+    void AnnotationStore::clearSeries(const std::string& seriesInstanceUID)
+    {
+        for (auto it = m_annotations.begin(); it != m_annotations.end();)
+        {
+            it = it->second.seriesInstanceUID == seriesInstanceUID ? m_annotations.erase(it) : std::next(it);
+        }
+        m_indexes.erase(seriesInstanceUID);
+    }
+
+    const Annotation* AnnotationStore::find(AnnotationId id) const
+    {
+        const auto it = m_annotations.find(id);
+        return it != m_annotations.end() ? &it->second : nullptr;
+    }
+
+    std::size_t AnnotationStore::count(const std::string& seriesInstanceUID) const
+    {
+        const auto it = m_indexes.find(seriesInstanceUID);
+        return it != m_indexes.end() ? it->second.size() : 0;
+    }
+
+    std::vector<const Annotation*> AnnotationStore::annotations(const std::string& seriesInstanceUID) const
+    {
+        std::vector<const Annotation*> result;
+        for (const auto& [id, annotation] : m_annotations)
+        {
+            if (annotation.seriesInstanceUID == seriesInstanceUID)
+            {
+                result.push_back(&annotation);
+            }
+        }
+        std::sort(result.begin(), result.end(),
+                  [](const Annotation* a, const Annotation* b) { return a->id < b->id; });
+        return result;
+    }
+
+    const AnnotationSpatialIndex* AnnotationStore::index(const std::string& seriesInstanceUID) const
+    {
+        const auto it = m_indexes.find(seriesInstanceUID);
+        return it != m_indexes.end() ? &it->second : nullptr;
+    }
+
+    AnnotationSpatialIndex* AnnotationStore::indexFor(const std::string& seriesInstanceUID,
+                                                      const SlicePlane& plane) const
+    {
+        const auto it = m_indexes.find(seriesInstanceUID);
+        if (it == m_indexes.end())
+        {
+            return nullptr;
+        }
+
+        AnnotationSpatialIndex& index = it->second;
+        if (!index.hasOrientation())
+        {
+            index.setOrientation(plane.row, plane.column);
+        }
+        return &index;
+    }
+
+    std::vector<AnnotationId> AnnotationStore::visibleOn(const std::string& seriesInstanceUID,
+                                                         const SlicePlane& plane,
+                                                         double sliceTolerance) const
+    {
+        const AnnotationSpatialIndex* index = indexFor(seriesInstanceUID, plane);
+        if (!index)
+        {
+            return {};
+        }
+
+        constexpr double unbounded = std::numeric_limits<double>::max();
+        const double slice = index->project(plane.origin)[0];
+        AnnotationSpatialIndex::Box box;
+        box.min = {slice - sliceTolerance, -unbounded, -unbounded};
+        box.max = {slice + sliceTolerance, unbounded, unbounded};
+
+        std::vector<AnnotationId> result = index->query(box);
+        result.erase(std::remove_if(result.begin(), result.end(),
+                                    [this, &plane](AnnotationId id)
+                                    { return isOnOtherFrame(m_annotations.at(id), plane); }),
+                     result.end());
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::optional<AnnotationId> AnnotationStore::hitTest(const std::string& seriesInstanceUID,
+                                                         const SlicePlane& plane, const Point3& patient,
+                                                         double tolerance, double sliceTolerance) const
+    {
+        const AnnotationSpatialIndex* index = indexFor(seriesInstanceUID, plane);
+        if (!index)
+        {
+            return std::nullopt;
+        }
+
+        // The cursor is taken on the displayed slice whatever its depth
+        Point3 point = index->project(patient);
+        point[0] = index->project(plane.origin)[0];
+
+        AnnotationSpatialIndex::Box box;
+        box.min = {point[0] - sliceTolerance, point[1] - tolerance, point[2] - tolerance};
+        box.max = {point[0] + sliceTolerance, point[1] + tolerance, point[2] + tolerance};
+
+        std::optional<AnnotationId> nearest;
+        double nearestDistance = tolerance;
+        for (const AnnotationId id : index->query(box))
+        {
+            const Annotation& annotation = m_annotations.at(id);
+            if (isOnOtherFrame(annotation, plane))
+            {
+                continue;
+            }
+
+            std::vector<Point3> projected;
+            projected.reserve(annotation.points.size());
+            for (const auto& p : annotation.points)
+            {
+                projected.push_back(index->project(p));
+            }
+
+            const auto segments = annotation.segments();
+            double distance = std::numeric_limits<double>::max();
+            if (segments.empty())
+            {
+                for (const auto& p : projected)
+                {
+                    distance = std::min(distance, segmentDistance(point, p, p));
+                }
+            }
+            for (const auto& [a, b] : segments)
+            {
+                distance = std::min(distance, segmentDistance(point, projected[a], projected[b]));
+            }
+
+            if (distance <= nearestDistance && (!nearest || distance < nearestDistance || id < *nearest))
+            {
+                nearest = id;
+                nearestDistance = distance;
+            }
+        }
+        return nearest;
+    }
+
+} // namespace isis::gui::measures
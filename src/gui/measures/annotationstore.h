@@ -0,0 +1,243 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: annotationstore.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Store of the measurements placed on a series, kept in patient coordinates
+ *      and indexed per series by an R-tree over slice position and in-plane extent,
+ *      so the annotations of the displayed slice and the one under the cursor are
+ *      found without scanning the whole set.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace isis::gui::measures
+{
+    using Point3 = std::array<double, 3>;
+    using AnnotationId = std::uint64_t;
+
+    /**
+     * @brief Kind of measurement an annotation holds
+     */
+    enum class AnnotationType
+    {
+        Distance,           // Two points
+        Angle,              // First arm end, vertex, second arm end
+        BiDimensional,      // Long axis ends followed by short axis ends
+        Contour             // Polyline, closed or open
+    };
+
+    /**
+     * @brief Geometry and identity of a displayed slice
+     *
+     * Plane coordinates are millimetres from the slice origin along the row and
+     * column directions, which is how the 2D view lays out its world coordinates.
+     */
+    struct SlicePlane
+    {
+        Point3 origin = {0.0, 0.0, 0.0};        // Image Position (Patient)
+        Point3 row = {1.0, 0.0, 0.0};           // Image Orientation (Patient), row direction
+        Point3 column = {0.0, 1.0, 0.0};        // Image Orientation (Patient), column direction
+        std::string sopInstanceUID;
+        std::string sopClassUID;
+        std::string frameOfReferenceUID;
+        int frameNumber = 1;                    // 1-based frame within a multi-frame instance
+
+        [[nodiscard]] Point3 normal() const;
+        [[nodiscard]] double position() const;  // Distance of the plane from the patient origin along normal()
+        [[nodiscard]] Point3 toPatient(double x, double y) const;
+        [[nodiscard]] Point3 toPlane(const Point3& patient) const;  // {x, y, distance from the plane}
+    };
+
+    /**
+     * @brief One measurement in patient coordinates (mm)
+     */
+    struct Annotation
+    {
+        AnnotationId id = 0;
+        AnnotationType type = AnnotationType::Distance;
+        std::vector<Point3> points;
+        bool closed = false;                    // Contours only
+        std::string label;
+        std::string trackingUID;                // Tracking Unique Identifier in measurement reports
+
+        // Slice the annotation was placed on
+        std::string seriesInstanceUID;
+        std::string sopInstanceUID;
+        std::string sopClassUID;
+        std::string frameOfReferenceUID;
+        int frameNumber = 1;
+
+        /**
+         * @brief Point index pairs drawn as segments, used for hit-testing
+         */
+        [[nodiscard]] std::vector<std::pair<std::size_t, std::size_t>> segments() const;
+    };
+
+    /**
+     * @brief R-tree over the annotations of one series
+     *
+     * Boxes are taken in the series' slice basis: slice position along the normal
+     * and the in-plane extent along the row and column directions. The tree is
+     * packed with Sort-Tile-Recursive and rebuilt on the first query after a
+     * change, so edits cost nothing while a measurement is being placed and
+     * scrolling only walks the branches that reach the displayed slice.
+     */
+    class AnnotationSpatialIndex
+    {
+    public:
+        static constexpr std::size_t NodeCapacity = 16;
+
+        struct Box
+        {
+            Point3 min = {0.0, 0.0, 0.0};       // {slice, row, column}
+            Point3 max = {0.0, 0.0, 0.0};
+
+            [[nodiscard]] bool intersects(const Box& other) const;
+            void expand(const Box& other);
+        };
+
+        /**
+         * @brief Set the slice basis; existing entries are re-projected on the next query
+         */
+        void setOrientation(const Point3& row, const Point3& column);
+        [[nodiscard]] const Point3& row() const { return m_row; }
+        [[nodiscard]] const Point3& column() const { return m_column; }
+        [[nodiscard]] bool hasOrientation() const { return m_hasOrientation; }
+
+        void insert(const Annotation& annotation);
+        void erase(AnnotationId id);
+        void clear();
+        [[nodiscard]] std::size_t size() const { return m_entries.size(); }
+
+        [[nodiscard]] Point3 project(const Point3& patient) const;     // {slice, row, column}
+        [[nodiscard]] Box bounds(const Annotation& annotation) const;
+
+        /**
+         * @brief Entries whose box intersects the query box
+         */
+        [[nodiscard]] std::vector<AnnotationId> query(const Box& box) const;
+
+        /**
+         * @brief Tree nodes visited by the last query (for diagnostics and tests)
+         */
+        [[nodiscard]] std::size_t lastVisitedNodes() const { return m_lastVisitedNodes; }
+
+    private:
+        struct Entry
+        {
+            AnnotationId id = 0;
+            Box box;
+            std::vector<Point3> points;         // Kept to re-project on an orientation change
+        };
+
+        struct Node
+        {
+            Box box;
+            std::uint32_t first = 0;            // Into m_order (leaf) or m_nodes (inner)
+            std::uint32_t count = 0;
+            bool leaf = true;
+        };
+
+        void rebuild() const;
+
+        Point3 m_row = {1.0, 0.0, 0.0};
+        Point3 m_column = {0.0, 1.0, 0.0};
+        Point3 m_normal = {0.0, 0.0, 1.0};
+        bool m_hasOrientation = false;
+
+        std::unordered_map<AnnotationId, Entry> m_entries;
+
+        // Packed tree, rebuilt lazily
+        mutable bool m_dirty = false;
+        mutable std::vector<const Entry*> m_order;
+        mutable std::vector<Node> m_nodes;      // Root is the last node
+        mutable std::size_t m_lastVisitedNodes = 0;
+    };
+
+    /**
+     * @brief All annotations of the open series
+     *
+     * Owned by the GUI thread. Annotations are grouped per series; the index of a
+     * series takes its orientation from the first slice it is queried with.
+     */
+    class AnnotationStore
+    {
+    public:
+        // Annotations drawn on a slice lie in its plane; this only absorbs rounding
+        static constexpr double DefaultSliceTolerance = 0.5;
+
+        /**
+         * @brief Add an annotation, assigning it a new id
+         * @return The id of the stored annotation
+         */
+        AnnotationId add(Annotation annotation);
+
+        /**
+         * @brief Add annotations read from measurement reports
+         *
+         * Annotations whose tracking UID is already stored for their series are skipped.
+         * @return Number of annotations added
+         */
+        std::size_t merge(const std::vector<Annotation>& annotations);
+
+        /**
+         * @brief Replace the points of an annotation (after it was edited)
+         */
+        bool update(AnnotationId id, const std::vector<Point3>& points);
+
+        bool remove(AnnotationId id);
+        void clear();
+        void clearSeries(const std::string& seriesInstanceUID);
+
+        [[nodiscard]] const Annotation* find(AnnotationId id) const;
+        [[nodiscard]] std::size_t count() const { return m_annotations.size(); }
+        [[nodiscard]] std::size_t count(const std::string& seriesInstanceUID) const;
+        [[nodiscard]] std::vector<const Annotation*> annotations(const std::string& seriesInstanceUID) const;
+
+        /**
+         * @brief Annotations that intersect the given slice, in id order
+         *
+         * Annotations placed on another frame of the plane's instance are left
+         * out, which keeps multi-frame objects without per-frame positions apart.
+         */
+        [[nodiscard]] std::vector<AnnotationId> visibleOn(const std::string& seriesInstanceUID,
+                                                          const SlicePlane& plane,
+                                                          double sliceTolerance = DefaultSliceTolerance) const;
+
+        /**
+         * @brief Annotation of the slice nearest to a point, within tolerance (mm) of one of its segments
+         */
+        [[nodiscard]] std::optional<AnnotationId> hitTest(const std::string& seriesInstanceUID,
+                                                          const SlicePlane& plane, const Point3& patient,
+                                                          double tolerance,
+                                                          double sliceTolerance = DefaultSliceTolerance) const;
+
+        /**
+         * @brief Index of a series (nullptr if it has no annotations)
+         */
+        [[nodiscard]] const AnnotationSpatialIndex* index(const std::string& seriesInstanceUID) const;
+
+    private:
+        AnnotationSpatialIndex* indexFor(const std::string& seriesInstanceUID, const SlicePlane& plane) const;
+
+        std::unordered_map<AnnotationId, Annotation> m_annotations;
+        mutable std::unordered_map<std::string, AnnotationSpatialIndex> m_indexes;
+        AnnotationId m_nextId = 1;
+    };
+
+} // namespace isis::gui::measures
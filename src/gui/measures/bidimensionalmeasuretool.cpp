@@ -163,4 +163,31 @@ namespace isis::gui::measures
         return 0.0;
     }
 
+    bool BiDimensionalMeasureTool::isPlaced() const
+    {
+        return m_biDimensionalWidget && m_biDimensionalWidget->GetWidgetState() == vtkBiDimensionalWidget::Manipulate;
+    }
+
+    std::vector<std::array<double, 3>> BiDimensionalMeasureTool::getWorldPoints() const
+    {
+        std::vector<std::array<double, 3>> points;
+        if (!m_biDimensionalWidget)
+        {
+            return points;
+        }
+
+        auto* representation = static_cast<vtkBiDimensionalRepresentation2D*>(
+            m_biDimensionalWidget->GetRepresentation());
+
+        if (representation)
+        {
+            representation->GetPoint1WorldPosition(points.emplace_back().data());
+            representation->GetPoint2WorldPosition(points.emplace_back().data());
+            representation->GetPoint3WorldPosition(points.emplace_back().data());
+            representation->GetPoint4WorldPosition(points.emplace_back().data());
+        }
+
+        return points;
+    }
+
 } // namespace isis::gui::measures
@@ -20,6 +20,8 @@
 #include <vtkBiDimensionalWidget.h>
 #include <vtkBiDimensionalRepresentation2D.h>
 #include <vtkRenderWindowInteractor.h>
+#include <array>
+#include <vector>
 #include <vtkCommand.h>
 
 namespace isis::gui::measures
@@ -95,6 +97,18 @@ namespace isis::gui::measures
          */
         [[nodiscard]] double getArea() const;
 
+        /**
+         * @brief Check if a measurement has been completely placed
+         * @return true once every handle is set, false while still defining
+         */
+        [[nodiscard]] bool isPlaced() const;
+
+        /**
+         * @brief Get the world positions of the measurement handles
+         * @return Long axis end points followed by short axis end points
+         */
+        [[nodiscard]] std::vector<std::array<double, 3>> getWorldPoints() const;
+
         /**
          * @brief Get the underlying VTK widget
          * @return Pointer to the vtkBiDimensionalWidget
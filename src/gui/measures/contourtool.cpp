@@ -206,4 +206,38 @@ namespace isis::gui::measures
         }
     }
 
+    bool ContourTool::isPlaced() const
+    {
+        if (!m_contourWidget)
+        {
+            return false;
+        }
+
+        auto* representation = m_contourWidget->GetContourRepresentation();
+        return representation && representation->GetClosedLoop() && representation->GetNumberOfNodes() > 2;
+    }
+
+    std::vector<std::array<double, 3>> ContourTool::getWorldPoints() const
+    {
+        std::vector<std::array<double, 3>> points;
+        if (!m_contourWidget)
+        {
+            return points;
+        }
+
+        auto* representation = m_contourWidget->GetContourRepresentation();
+        if (!representation)
+        {
+            return points;
+        }
+
+        const int numNodes = representation->GetNumberOfNodes();
+        for (int i = 0; i < numNodes; ++i)
+        {
+            representation->GetNthNodeWorldPosition(i, points.emplace_back().data());
+        }
+
+        return points;
+    }
+
 } // namespace isis::gui::measures
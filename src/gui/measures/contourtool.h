@@ -20,6 +20,8 @@
 #include <vtkContourWidget.h>
 #include <vtkOrientedGlyphContourRepresentation.h>
 #include <vtkRenderWindowInteractor.h>
+#include <array>
+#include <vector>
 
 namespace isis::gui::measures
 {
@@ -91,6 +93,18 @@ namespace isis::gui::measures
          */
         [[nodiscard]] double getArea() const;
 
+        /**
+         * @brief Check if the contour has been completed
+         * @return true once the contour is closed, false while still drawing
+         */
+        [[nodiscard]] bool isPlaced() const;
+
+        /**
+         * @brief Get the world positions of the contour nodes
+         * @return Nodes in drawing order
+         */
+        [[nodiscard]] std::vector<std::array<double, 3>> getWorldPoints() const;
+
         /**
          * @brief Set the contour line color
          * @param r Red component (0.0-1.0)
@@ -109,4 +109,29 @@ namespace isis::gui::measures
         }
     }
 
+    bool DistanceMeasureTool::isPlaced() const
+    {
+        return m_distanceWidget && m_distanceWidget->GetWidgetState() == vtkDistanceWidget::Manipulate;
+    }
+
+    std::vector<std::array<double, 3>> DistanceMeasureTool::getWorldPoints() const
+    {
+        std::vector<std::array<double, 3>> points;
+        if (!m_distanceWidget)
+        {
+            return points;
+        }
+
+        auto* representation = static_cast<vtkDistanceRepresentation*>(
+            m_distanceWidget->GetRepresentation());
+
+        if (representation)
+        {
+            representation->GetPoint1WorldPosition(points.emplace_back().data());
+            representation->GetPoint2WorldPosition(points.emplace_back().data());
+        }
+
+        return points;
+    }
+
 } // namespace isis::gui::measures
@@ -20,6 +20,7 @@
 #include <vtkDistanceWidget.h>
 #include <vtkDistanceRepresentation.h>
 #include <vtkRenderWindowInteractor.h>
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -76,6 +77,18 @@ namespace isis::gui::measures
          */
         void setLabelFormat(const char* format);
 
+        /**
+         * @brief Check if a measurement has been completely placed
+         * @return true once every handle is set, false while still defining
+         */
+        [[nodiscard]] bool isPlaced() const;
+
+        /**
+         * @brief Get the world positions of the measurement handles
+         * @return The two end points
+         */
+        [[nodiscard]] std::vector<std::array<double, 3>> getWorldPoints() const;
+
         /**
          * @brief Get the underlying VTK widget
          * @return Pointer to the vtkDistanceWidget
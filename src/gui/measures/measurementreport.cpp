@@ -0,0 +1,621 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: measurementreport.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the DICOM SR measurement report writer and reader
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "measurementreport.h"
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+#include <dcmtk/dcmsr/dsrdoc.h>
+#include <dcmtk/dcmsr/dsrimgvl.h>
+#include <dcmtk/dcmsr/dsrnumvl.h>
+#include <dcmtk/dcmsr/dsrsc3vl.h>
+#include <dcmtk/ofstd/ofstd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+
+namespace isis::gui::measures
+{
+    namespace
+    {
+        constexpr double Pi = 3.14159265358979323846;
+
+        struct Code
+        {
+            const char* value;
+            const char* scheme;
+            const char* meaning;
+
+            [[nodiscard]] DSRCodedEntryValue entry() const { return DSRCodedEntryValue(value, scheme, meaning); }
+            [[nodiscard]] bool matches(const DSRCodedEntryValue& code) const
+            {
+                return code.getCodeValue() == value && code.getCodingSchemeDesignator() == scheme;
+            }
+        };
+
+        // TID 1500 structure
+        const Code ImagingMeasurementReport{"126000", "DCM", "Imaging Measurement Report"};
+        const Code LanguageOfContent{"121049", "DCM", "Language of Content Item and Descendants"};
+        const Code English{"en", "RFC5646", "English"};
+        const Code ProcedureReported{"121058", "DCM", "Procedure reported"};
+        const Code ImagingProcedure{"363679005", "SCT", "Imaging procedure"};
+        const Code ImageLibrary{"111028", "DCM", "Image Library"};
+        const Code ImagingMeasurements{"126010", "DCM", "Imaging Measurements"};
+        const Code MeasurementGroup{"125007", "DCM", "Measurement Group"};
+        const Code TrackingIdentifier{"112039", "DCM", "Tracking Identifier"};
+        const Code TrackingUniqueIdentifier{"112040", "DCM", "Tracking Unique Identifier"};
+        const Code ImageRegion{"111030", "DCM", "Image Region"};
+        const Code SourceOfMeasurement{"121112", "DCM", "Source of Measurement"};
+
+        // Measured quantities
+        const Code Length{"410668003", "SCT", "Length"};
+        const Code Angle{"1483009", "SCT", "Angle"};
+        const Code LongAxis{"103339001", "SCT", "Long Axis"};
+        const Code ShortAxis{"103340004", "SCT", "Short Axis"};
+        const Code Area{"42798000", "SCT", "Area"};
+        const Code Perimeter{"131191004", "SCT", "Perimeter"};
+
+        double distance(const Point3& a, const Point3& b)
+        {
+            const double dx = b[0] - a[0];
+            const double dy = b[1] - a[1];
+            const double dz = b[2] - a[2];
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+        MeasurementValue value(const Code& code, const char* unit, double measured)
+        {
+            return {code.value, code.scheme, code.meaning, unit, measured};
+        }
+
+        // Decimal String holds at most 16 characters
+        std::string decimalString(double value)
+        {
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.6f", value);
+            if (std::string(buffer).size() > 16)
+            {
+                std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+            }
+            return buffer;
+        }
+
+        std::string generateUID()
+        {
+            char uid[100];
+            dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT);
+            return uid;
+        }
+
+        std::string conditionText(const char* what, const OFCondition& condition)
+        {
+            return std::string(what) + ": " + condition.text();
+        }
+
+        // Adds a child to the current item and leaves the cursor on it
+        bool addChild(DSRDocumentTree& tree, DSRTypes::E_RelationshipType relationship,
+                      DSRTypes::E_ValueType valueType, const Code& concept, std::string& error)
+        {
+            const OFCondition condition = tree.addChildContentItem(relationship, valueType, concept.entry());
+            if (condition.bad())
+            {
+                error = conditionText(concept.meaning, condition);
+                return false;
+            }
+            return true;
+        }
+
+        DSRTypes::E_GraphicType3D graphicType(const Annotation& annotation)
+        {
+            switch (annotation.type)
+            {
+            case AnnotationType::BiDimensional:
+                return DSRTypes::GT3_Multipoint;
+            case AnnotationType::Contour:
+                return annotation.closed ? DSRTypes::GT3_Polygon : DSRTypes::GT3_Polyline;
+            case AnnotationType::Distance:
+            case AnnotationType::Angle:
+            default:
+                return DSRTypes::GT3_Polyline;
+            }
+        }
+
+        bool writeGroup(DSRDocumentTree& tree, const Annotation& annotation, std::size_t index,
+                        const std::string& frameOfReferenceUID, std::string& error)
+        {
+            if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_Container, MeasurementGroup, error))
+            {
+                return false;
+            }
+
+            const std::string label = annotation.label.empty()
+                ? "Measurement " + std::to_string(index + 1)
+                : annotation.label;
+            if (!addChild(tree, DSRTypes::RT_hasObsContext, DSRTypes::VT_Text, TrackingIdentifier, error))
+            {
+                return false;
+            }
+            tree.getCurrentContentItem().setStringValue(label.c_str(), OFFalse);
+            tree.goUp();
+
+            const std::string trackingUID = annotation.trackingUID.empty() ? generateUID() : annotation.trackingUID;
+            if (!addChild(tree, DSRTypes::RT_hasObsContext, DSRTypes::VT_UIDRef, TrackingUniqueIdentifier, error))
+            {
+                return false;
+            }
+            tree.getCurrentContentItem().setStringValue(trackingUID.c_str());
+            tree.goUp();
+
+            // Patient coordinates of the points; a closed polygon repeats its first point
+            if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_SCoord3D, ImageRegion, error))
+            {
+                return false;
+            }
+            DSRSpatialCoordinates3DValue* coordinates = tree.getCurrentContentItem().getSpatialCoordinates3DPtr();
+            const DSRTypes::E_GraphicType3D type = graphicType(annotation);
+            coordinates->setGraphicType(type);
+            coordinates->setFrameOfReferenceUID(frameOfReferenceUID.c_str());
+            for (const Point3& point : annotation.points)
+            {
+                coordinates->getGraphicDataList().addItem(static_cast<Float32>(point[0]),
+                                                          static_cast<Float32>(point[1]),
+                                                          static_cast<Float32>(point[2]));
+            }
+            if (type == DSRTypes::GT3_Polygon && !annotation.points.empty())
+            {
+                const Point3& first = annotation.points.front();
+                coordinates->getGraphicDataList().addItem(static_cast<Float32>(first[0]),
+                                                          static_cast<Float32>(first[1]),
+                                                          static_cast<Float32>(first[2]));
+            }
+            tree.goUp();
+
+            if (!annotation.sopClassUID.empty() && !annotation.sopInstanceUID.empty())
+            {
+                if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_Image, SourceOfMeasurement, error))
+                {
+                    return false;
+                }
+                DSRImageReferenceValue reference(annotation.sopClassUID.c_str(), annotation.sopInstanceUID.c_str());
+                if (annotation.frameNumber > 1)
+                {
+                    reference.getFrameList().addItem(annotation.frameNumber);
+                }
+                const OFCondition condition = tree.getCurrentContentItem().setImageReference(reference);
+                if (condition.bad())
+                {
+                    error = conditionText("Source of Measurement", condition);
+                    return false;
+                }
+                tree.goUp();
+            }
+
+            for (const MeasurementValue& measured : measurementValues(annotation))
+            {
+                const Code concept{measured.code.c_str(), measured.scheme.c_str(), measured.meaning.c_str()};
+                if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_Num, concept, error))
+                {
+                    return false;
+                }
+                const OFCondition condition = tree.getCurrentContentItem().setNumericValue(
+                    DSRNumericMeasurementValue(decimalString(measured.value).c_str(),
+                                               DSRCodedEntryValue(measured.unit.c_str(), "UCUM", measured.unit.c_str())));
+                if (condition.bad())
+                {
+                    error = conditionText(concept.meaning, condition);
+                    return false;
+                }
+                tree.goUp();
+            }
+
+            tree.goUp();
+            return true;
+        }
+
+        bool readGroup(DSRDocumentTree& tree, Annotation& annotation, std::vector<MeasurementValue>& values)
+        {
+            bool hasCoordinates = false;
+            bool hasAngle = false;
+            DSRTypes::E_GraphicType3D type = DSRTypes::GT3_invalid;
+
+            if (tree.goDown() == 0)
+            {
+                return false;
+            }
+            do
+            {
+                DSRContentItem& item = tree.getCurrentContentItem();
+                const DSRCodedEntryValue& concept = item.getConceptName();
+                switch (item.getValueType())
+                {
+                case DSRTypes::VT_Text:
+                    if (TrackingIdentifier.matches(concept))
+                    {
+                        annotation.label = item.getStringValue().c_str();
+                    }
+                    break;
+
+                case DSRTypes::VT_UIDRef:
+                    if (TrackingUniqueIdentifier.matches(concept))
+                    {
+                        annotation.trackingUID = item.getStringValue().c_str();
+                    }
+                    break;
+
+                case DSRTypes::VT_SCoord3D:
+                    if (DSRSpatialCoordinates3DValue* coordinates = item.getSpatialCoordinates3DPtr())
+                    {
+                        type = coordinates->getGraphicType();
+                        annotation.frameOfReferenceUID = coordinates->getFrameOfReferenceUID().c_str();
+                        const DSRGraphicData3DList& data = coordinates->getGraphicDataList();
+                        for (std::size_t i = 1; i <= data.getNumberOfItems(); ++i)
+                        {
+                            const DSRGraphicData3DItem& point = data.getItem(i);
+                            annotation.points.push_back({point.XCoord, point.YCoord, point.ZCoord});
+                        }
+                        hasCoordinates = !annotation.points.empty();
+                    }
+                    break;
+
+                case DSRTypes::VT_Image:
+                    if (const DSRImageReferenceValue* reference = item.getImageReferencePtr())
+                    {
+                        annotation.sopClassUID = reference->getSOPClassUID().c_str();
+                        annotation.sopInstanceUID = reference->getSOPInstanceUID().c_str();
+                        if (!reference->getFrameList().isEmpty())
+                        {
+                            annotation.frameNumber = reference->getFrameList().getItem(1);
+                        }
+                    }
+                    break;
+
+                case DSRTypes::VT_Num:
+                    if (const DSRNumericMeasurementValue* numeric = item.getNumericValuePtr())
+                    {
+                        MeasurementValue measured;
+                        measured.code = concept.getCodeValue().c_str();
+                        measured.scheme = concept.getCodingSchemeDesignator().c_str();
+                        measured.meaning = concept.getCodeMeaning().c_str();
+                        measured.unit = numeric->getMeasurementUnit().getCodeValue().c_str();
+                        OFBool parsed = OFFalse;
+                        measured.value = OFStandard::atof(numeric->getNumericValue().c_str(), &parsed);
+                        if (parsed)
+                        {
+                            hasAngle = hasAngle || Angle.matches(concept);
+                            values.push_back(measured);
+                        }
+                    }
+                    break;
+
+                default:
+                    break;
+                }
+            } while (tree.gotoNext() != 0);
+            tree.goUp();
+
+            if (!hasCoordinates)
+            {
+                return false;
+            }
+
+            // The graphic type and the measured quantities tell the tools apart
+            if (type == DSRTypes::GT3_Polygon)
+            {
+                annotation.type = AnnotationType::Contour;
+                annotation.closed = true;
+                if (annotation.points.size() > 1 && annotation.points.front() == annotation.points.back())
+                {
+                    annotation.points.pop_back();
+                }
+            }
+            else if (type == DSRTypes::GT3_Multipoint && annotation.points.size() == 4)
+            {
+                annotation.type = AnnotationType::BiDimensional;
+            }
+            else if (hasAngle && annotation.points.size() == 3)
+            {
+                annotation.type = AnnotationType::Angle;
+            }
+            else if (annotation.points.size() == 2)
+            {
+                annotation.type = AnnotationType::Distance;
+            }
+            else
+            {
+                annotation.type = AnnotationType::Contour;
+                annotation.closed = false;
+            }
+            return true;
+        }
+    }
+
+    std::string generateTrackingUID()
+    {
+        return generateUID();
+    }
+
+    std::vector<MeasurementValue> measurementValues(const Annotation& annotation)
+    {
+        const auto& p = annotation.points;
+        switch (annotation.type)
+        {
+        case AnnotationType::Distance:
+            if (p.size() >= 2)
+            {
+                return {value(Length, "mm", distance(p[0], p[1]))};
+            }
+            break;
+
+        case AnnotationType::Angle:
+            if (p.size() >= 3)
+            {
+                const Point3 a = {p[0][0] - p[1][0], p[0][1] - p[1][1], p[0][2] - p[1][2]};
+                const Point3 b = {p[2][0] - p[1][0], p[2][1] - p[1][1], p[2][2] - p[1][2]};
+                const double lengths = distance(p[0], p[1]) * distance(p[2], p[1]);
+                if (lengths > 0.0)
+                {
+                    const double cosine = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / lengths;
+                    return {value(Angle, "deg", std::acos(std::clamp(cosine, -1.0, 1.0)) * 180.0 / Pi)};
+                }
+            }
+            break;
+
+        case AnnotationType::BiDimensional:
+            if (p.size() >= 4)
+            {
+                return {value(LongAxis, "mm", distance(p[0], p[1])),
+                        value(ShortAxis, "mm", distance(p[2], p[3]))};
+            }
+            break;
+
+        case AnnotationType::Contour:
+            if (p.size() >= 2)
+            {
+                double perimeter = 0.0;
+                for (std::size_t i = 1; i < p.size(); ++i)
+                {
+                    perimeter += distance(p[i - 1], p[i]);
+                }
+                if (!annotation.closed)
+                {
+                    return {value(Length, "mm", perimeter)};
+                }
+                perimeter += distance(p.back(), p.front());
+
+                // Vector area of the planar polygon
+                Point3 sum = {0.0, 0.0, 0.0};
+                for (std::size_t i = 0; i < p.size(); ++i)
+                {
+                    const Point3& a = p[i];
+                    const Point3& b = p[(i + 1) % p.size()];
+                    sum[0] += a[1] * b[2] - a[2] * b[1];
+                    sum[1] += a[2] * b[0] - a[0] * b[2];
+                    sum[2] += a[0] * b[1] - a[1] * b[0];
+                }
+                const double area = 0.5 * std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                return {value(Area, "mm2", area), value(Perimeter, "mm", perimeter)};
+            }
+            break;
+        }
+        return {};
+    }
+
+    bool writeMeasurementReport(const MeasurementReportContext& context,
+                                const std::vector<const Annotation*>& annotations,
+                                const std::string& filePath, std::string& error)
+    {
+        DSRDocument document(DSRTypes::DT_Comprehensive3DSR);
+        if (!context.studyInstanceUID.empty())
+        {
+            const OFCondition condition = document.createNewSeriesInStudy(context.studyInstanceUID.c_str());
+            if (condition.bad())
+            {
+                error = conditionText("Study Instance UID", condition);
+                return false;
+            }
+        }
+
+        // Optional patient and study attributes; values the checker rejects are left out
+        document.setSpecificCharacterSetType(DSRTypes::CS_UTF8);
+        document.setPatientName(context.patientName.c_str());
+        document.setPatientID(context.patientID.c_str());
+        document.setPatientBirthDate(context.patientBirthDate.c_str());
+        document.setStudyID(context.studyID.c_str());
+        document.setStudyDate(context.studyDate.c_str());
+        document.setStudyDescription(context.studyDescription.c_str());
+        document.setSeriesDescription("Measurements");
+        document.setManufacturer("Isis DICOM Viewer");
+
+        DSRDocumentTree& tree = document.getTree();
+        if (tree.addContentItem(DSRTypes::RT_isRoot, DSRTypes::VT_Container) == 0)
+        {
+            error = "Could not create the report root.";
+            return false;
+        }
+        tree.getCurrentContentItem().setConceptName(ImagingMeasurementReport.entry());
+
+        if (!addChild(tree, DSRTypes::RT_hasConceptMod, DSRTypes::VT_Code, LanguageOfContent, error))
+        {
+            return false;
+        }
+        tree.getCurrentContentItem().setCodeValue(English.entry());
+        tree.goUp();
+
+        if (!addChild(tree, DSRTypes::RT_hasConceptMod, DSRTypes::VT_Code, ProcedureReported, error))
+        {
+            return false;
+        }
+        tree.getCurrentContentItem().setCodeValue(ImagingProcedure.entry());
+        tree.goUp();
+
+        // Image library and evidence list every referenced instance once
+        if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_Container, ImageLibrary, error))
+        {
+            return false;
+        }
+        OFString studyInstanceUID;
+        document.getStudyInstanceUID(studyInstanceUID);
+        std::set<std::string> referenced;
+        for (const Annotation* annotation : annotations)
+        {
+            if (annotation->sopClassUID.empty() || annotation->sopInstanceUID.empty()
+                || !referenced.insert(annotation->sopInstanceUID).second)
+            {
+                continue;
+            }
+            if (tree.addContentItem(DSRTypes::RT_contains, DSRTypes::VT_Image, DSRTypes::AM_belowCurrent) == 0)
+            {
+                error = "Could not add an image to the Image Library.";
+                return false;
+            }
+            tree.getCurrentContentItem().setImageReference(
+                DSRImageReferenceValue(annotation->sopClassUID.c_str(), annotation->sopInstanceUID.c_str()));
+            tree.goUp();
+
+            const std::string seriesUID = annotation->seriesInstanceUID.empty()
+                ? context.seriesInstanceUID
+                : annotation->seriesInstanceUID;
+            document.getCurrentRequestedProcedureEvidence().addItem(
+                studyInstanceUID, seriesUID.c_str(),
+                annotation->sopClassUID.c_str(), annotation->sopInstanceUID.c_str());
+        }
+        tree.goUp();
+
+        if (!addChild(tree, DSRTypes::RT_contains, DSRTypes::VT_Container, ImagingMeasurements, error))
+        {
+            return false;
+        }
+
+        // SCOORD3D needs a frame of reference; annotations of images without one share a new one
+        std::string fallbackFrameOfReference;
+        for (std::size_t i = 0; i < annotations.size(); ++i)
+        {
+            const Annotation& annotation = *annotations[i];
+            std::string frameOfReferenceUID = annotation.frameOfReferenceUID;
+            if (frameOfReferenceUID.empty())
+            {
+                if (fallbackFrameOfReference.empty())
+                {
+                    fallbackFrameOfReference = generateUID();
+                }
+                frameOfReferenceUID = fallbackFrameOfReference;
+            }
+            if (!writeGroup(tree, annotation, i, frameOfReferenceUID, error))
+            {
+                return false;
+            }
+        }
+
+        DcmFileFormat fileFormat;
+        OFCondition condition = document.write(*fileFormat.getDataset());
+        if (condition.bad())
+        {
+            error = conditionText("Writing the report", condition);
+            return false;
+        }
+        condition = fileFormat.saveFile(filePath.c_str(), EXS_LittleEndianExplicit);
+        if (condition.bad())
+        {
+            error = conditionText("Saving the report", condition);
+            return false;
+        }
+        return true;
+    }
+
+    bool readMeasurementReport(const std::string& filePath, MeasurementReport& report, std::string& error)
+    {
+        DcmFileFormat fileFormat;
+        OFCondition condition = fileFormat.loadFile(filePath.c_str());
+        if (condition.bad())
+        {
+            error = conditionText("Loading the report", condition);
+            return false;
+        }
+
+        DSRDocument document;
+        condition = document.read(*fileFormat.getDataset(), DSRTypes::RF_ignoreContentItemErrors);
+        if (condition.bad())
+        {
+            error = conditionText("Reading the report", condition);
+            return false;
+        }
+
+        OFString text;
+        report = {};
+        report.sopInstanceUID = document.getSOPInstanceUID(text).good() ? text.c_str() : "";
+        report.context.patientName = document.getPatientName(text).good() ? text.c_str() : "";
+        report.context.patientID = document.getPatientID(text).good() ? text.c_str() : "";
+        report.context.studyInstanceUID = document.getStudyInstanceUID(text).good() ? text.c_str() : "";
+
+        // Source series of each referenced instance
+        std::map<std::string, std::string> seriesOfInstance;
+        DSRSOPInstanceReferenceList& evidence = document.getCurrentRequestedProcedureEvidence();
+        if (evidence.gotoFirstItem().good())
+        {
+            do
+            {
+                OFString series;
+                OFString instance;
+                evidence.getSeriesInstanceUID(series);
+                evidence.getSOPInstanceUID(instance);
+                seriesOfInstance[instance.c_str()] = series.c_str();
+                if (report.context.seriesInstanceUID.empty())
+                {
+                    report.context.seriesInstanceUID = series.c_str();
+                }
+            } while (evidence.gotoNextItem().good());
+        }
+
+        DSRDocumentTree& tree = document.getTree();
+        if (tree.gotoNamedNode(ImagingMeasurements.entry()) == 0)
+        {
+            error = "The report has no Imaging Measurements container.";
+            return false;
+        }
+        if (tree.goDown() == 0)
+        {
+            return true;
+        }
+        do
+        {
+            DSRContentItem& item = tree.getCurrentContentItem();
+            if (item.getValueType() != DSRTypes::VT_Container || !MeasurementGroup.matches(item.getConceptName()))
+            {
+                continue;
+            }
+
+            Annotation annotation;
+            std::vector<MeasurementValue> values;
+            if (!readGroup(tree, annotation, values))
+            {
+                continue;
+            }
+            const auto series = seriesOfInstance.find(annotation.sopInstanceUID);
+            annotation.seriesInstanceUID = series != seriesOfInstance.end()
+                ? series->second
+                : report.context.seriesInstanceUID;
+            report.annotations.push_back(std::move(annotation));
+            report.values.push_back(std::move(values));
+        } while (tree.gotoNext() != 0);
+
+        return true;
+    }
+
+} // namespace isis::gui::measures
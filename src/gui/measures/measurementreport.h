@@ -0,0 +1,96 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: measurementreport.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Serialization of stored annotations as a DICOM SR measurement report
+ *      (TID 1500) with 3D spatial coordinates and references to the source
+ *      SOP instances, and the reverse conversion for reports found on import.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "annotationstore.h"
+
+#include <string>
+#include <vector>
+
+namespace isis::gui::measures
+{
+    /**
+     * @brief Patient, study and series the report belongs to
+     */
+    struct MeasurementReportContext
+    {
+        std::string patientName;
+        std::string patientID;
+        std::string patientBirthDate;
+        std::string studyInstanceUID;
+        std::string studyID;
+        std::string studyDate;
+        std::string studyDescription;
+        std::string seriesInstanceUID;          // Series the annotations were placed on
+    };
+
+    /**
+     * @brief One numeric result of a measurement, coded as in the report
+     */
+    struct MeasurementValue
+    {
+        std::string code;                       // Concept name
+        std::string scheme;
+        std::string meaning;
+        std::string unit;                       // UCUM
+        double value = 0.0;
+    };
+
+    /**
+     * @brief Contents of a measurement report read back from disk
+     */
+    struct MeasurementReport
+    {
+        MeasurementReportContext context;
+        std::string sopInstanceUID;             // Of the SR object itself
+        std::vector<Annotation> annotations;    // Without ids; the store assigns them
+        std::vector<std::vector<MeasurementValue>> values;  // Per annotation, as stored in the report
+    };
+
+    /**
+     * @brief Values derived from the geometry of an annotation (lengths in mm, angles in degrees)
+     */
+    [[nodiscard]] std::vector<MeasurementValue> measurementValues(const Annotation& annotation);
+
+    /**
+     * @brief New Tracking Unique Identifier for an annotation
+     */
+    [[nodiscard]] std::string generateTrackingUID();
+
+    /**
+     * @brief Write the annotations as a Comprehensive 3D SR measurement report
+     *
+     * Each annotation becomes a measurement group holding its tracking identifiers,
+     * an SCOORD3D image region in the frame of reference of the source slice, an
+     * IMAGE reference to the source SOP instance and frame, and its measured values.
+     * @return false with a message in error if the file could not be written
+     */
+    bool writeMeasurementReport(const MeasurementReportContext& context,
+                                const std::vector<const Annotation*>& annotations,
+                                const std::string& filePath, std::string& error);
+
+    /**
+     * @brief Read the measurement groups of a report written by writeMeasurementReport()
+     *
+     * Groups without 3D coordinates are skipped. The series of each annotation is
+     * taken from the evidence list, falling back to the series of the report context.
+     * @return false with a message in error if the file is not a readable measurement report
+     */
+    bool readMeasurementReport(const std::string& filePath, MeasurementReport& report, std::string& error);
+
+} // namespace isis::gui::measures
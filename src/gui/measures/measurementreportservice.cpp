@@ -0,0 +1,161 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: measurementreportservice.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the background measurement report writer and reader
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "measurementreportservice.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+
+Q_LOGGING_CATEGORY(lcMeasurementReports, "isis.gui.measures.reports")
+
+namespace isis::gui::measures
+{
+    MeasurementReportService::MeasurementReportService(QObject* parent)
+        : QObject(parent)
+    {
+    }
+
+    MeasurementReportService::~MeasurementReportService()
+    {
+        // Reports queued while closing are still written
+        waitForDone();
+    }
+
+    void MeasurementReportService::exportReport(const MeasurementReportContext& context,
+                                                std::vector<Annotation> annotations, const QString& filePath)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_pendingExports[filePath] = PendingExport{context, std::move(annotations)};
+        }
+        schedule();
+    }
+
+    void MeasurementReportService::importReport(const QString& filePath)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_pendingImports.contains(filePath))
+            {
+                m_pendingImports.append(filePath);
+            }
+        }
+        schedule();
+    }
+
+    void MeasurementReportService::waitForDone()
+    {
+        // A drain started while waiting is picked up by the next iteration
+        while (true)
+        {
+            QFuture<void> future;
+            {
+                QMutexLocker locker(&m_mutex);
+                if (!m_draining)
+                {
+                    return;
+                }
+                future = m_future;
+            }
+            future.waitForFinished();
+        }
+    }
+
+    void MeasurementReportService::schedule()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_draining)
+        {
+            return;
+        }
+        m_draining = true;
+        m_future = QtConcurrent::run([this]() { drain(); });
+    }
+
+    void MeasurementReportService::drain()
+    {
+        while (true)
+        {
+            std::map<QString, PendingExport> exports;
+            QStringList imports;
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_pendingExports.empty() && m_pendingImports.isEmpty())
+                {
+                    m_draining = false;
+                    return;
+                }
+                exports.swap(m_pendingExports);
+                imports.swap(m_pendingImports);
+            }
+
+            for (const auto& [filePath, pending] : exports)
+            {
+                QDir().mkpath(QFileInfo(filePath).absolutePath());
+                std::vector<const Annotation*> annotations;
+                annotations.reserve(pending.annotations.size());
+                for (const Annotation& annotation : pending.annotations)
+                {
+                    annotations.push_back(&annotation);
+                }
+
+                std::string error;
+                if (writeMeasurementReport(pending.context, annotations, filePath.toStdString(), error))
+                {
+                    qCInfo(lcMeasurementReports) << "Saved" << annotations.size() << "measurements to" << filePath;
+                    QMetaObject::invokeMethod(this, [this, filePath]() { emit reportExported(filePath); },
+                                              Qt::QueuedConnection);
+                }
+                else
+                {
+                    qCWarning(lcMeasurementReports) << "Could not save measurements to" << filePath << ":"
+                                                    << QString::fromStdString(error);
+                    const QString message = QString::fromStdString(error);
+                    QMetaObject::invokeMethod(this, [this, filePath, message]() { emit reportFailed(filePath, message); },
+                                              Qt::QueuedConnection);
+                }
+            }
+
+            // Reports of one batch reach the store together
+            std::vector<Annotation> imported;
+            for (const QString& filePath : imports)
+            {
+                MeasurementReport report;
+                std::string error;
+                if (!readMeasurementReport(filePath.toStdString(), report, error))
+                {
+                    qCDebug(lcMeasurementReports) << "Skipping" << filePath << ":" << QString::fromStdString(error);
+                    continue;
+                }
+                imported.insert(imported.end(), std::make_move_iterator(report.annotations.begin()),
+                                std::make_move_iterator(report.annotations.end()));
+            }
+            if (!imported.empty())
+            {
+                qCInfo(lcMeasurementReports) << "Read" << imported.size() << "measurements from"
+                                             << imports.size() << "reports";
+                QMetaObject::invokeMethod(this, [this, annotations = std::move(imported)]()
+                {
+                    emit annotationsImported(annotations);
+                }, Qt::QueuedConnection);
+            }
+        }
+    }
+
+} // namespace isis::gui::measures
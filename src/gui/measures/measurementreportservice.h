@@ -0,0 +1,87 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: measurementreportservice.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Background writer and reader of measurement reports. Requests are queued
+ *      from the GUI thread and drained in batches by one worker, so saving the
+ *      measurements of a study or reading the reports found during an import
+ *      never blocks the views.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "measurementreport.h"
+
+#include <QFuture>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <vector>
+
+namespace isis::gui::measures
+{
+    class MeasurementReportService final : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit MeasurementReportService(QObject* parent = nullptr);
+        ~MeasurementReportService() override;
+
+        /**
+         * @brief Queue writing the annotations of one series to a report file
+         *
+         * A request for a file that is still queued replaces the earlier one, so
+         * repeated saves of the same series only write the latest annotations.
+         */
+        void exportReport(const MeasurementReportContext& context, std::vector<Annotation> annotations,
+                          const QString& filePath);
+
+        /**
+         * @brief Queue reading a report found during an import
+         */
+        void importReport(const QString& filePath);
+
+        /**
+         * @brief Block until every queued request was handled
+         */
+        void waitForDone();
+
+    signals:
+        void reportExported(const QString& filePath);
+        void reportFailed(const QString& filePath, const QString& error);
+
+        /**
+         * @brief Annotations read from one batch of reports, emitted on the service's thread
+         */
+        void annotationsImported(const std::vector<isis::gui::measures::Annotation>& annotations);
+
+    private:
+        struct PendingExport
+        {
+            MeasurementReportContext context;
+            std::vector<Annotation> annotations;
+        };
+
+        void schedule();
+        void drain();
+
+        QMutex m_mutex;
+        std::map<QString, PendingExport> m_pendingExports;
+        QStringList m_pendingImports;
+        bool m_draining = false;
+        QFuture<void> m_future;
+    };
+
+} // namespace isis::gui::measures
@@ -14,23 +14,59 @@
  */
 
 #include "measuresmanager.h"
+#include "measurementreport.h"
+#include "slicegeometry.h"
+
+#include <vtkAngleRepresentation2D.h>
+#include <vtkBiDimensionalRepresentation2D.h>
+#include <vtkCellArray.h>
+#include <vtkDistanceRepresentation2D.h>
+#include <vtkLeaderActor2D.h>
+#include <vtkOrientedGlyphContourRepresentation.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkProperty.h>
+#include <vtkProperty2D.h>
+#include <vtkRenderer.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace isis::gui::measures
 {
-    MeasuresManager::MeasuresManager()
+    namespace
+    {
+        // Distance from the cursor (mm) at which an annotation is hovered or selected
+        constexpr double PickTolerance = 3.0;
+
+        constexpr double AnnotationColor[3] = {1.0, 0.0, 0.0};
+        constexpr double HighlightColor[3] = {1.0, 0.85, 0.0};
+
+        std::size_t typeIndex(AnnotationType type)
+        {
+            return static_cast<std::size_t>(type);
+        }
+    }
+
+    MeasuresManager::MeasuresManager(std::shared_ptr<AnnotationStore> store)
         : m_distanceTool(std::make_unique<DistanceMeasureTool>())
         , m_angleTool(std::make_unique<AngleMeasureTool>())
         , m_biDimensionalTool(std::make_unique<BiDimensionalMeasureTool>())
         , m_contourTool(std::make_unique<ContourTool>())
+        , m_store(std::move(store))
     {
     }
 
     void MeasuresManager::initialize(vtkRenderWindowInteractor* interactor)
     {
-        if (!interactor || m_initialized)
+        if (!interactor || (m_initialized && interactor == m_interactor))
         {
             return;
         }
+        if (m_initialized)
+        {
+            detach();
+        }
 
         // Initialize all tools with the interactor
         m_distanceTool->initialize(interactor);
@@ -38,7 +74,71 @@ namespace isis::gui::measures
         m_biDimensionalTool->initialize(interactor);
         m_contourTool->initialize(interactor);
 
+        // Completed measurements are moved into the store
+        m_toolCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+        m_toolCallback->SetCallback(&MeasuresManager::onToolEvent);
+        m_toolCallback->SetClientData(this);
+        m_distanceTool->getWidget()->AddObserver(vtkCommand::EndInteractionEvent, m_toolCallback);
+        m_angleTool->getWidget()->AddObserver(vtkCommand::EndInteractionEvent, m_toolCallback);
+        m_biDimensionalTool->getWidget()->AddObserver(vtkCommand::EndInteractionEvent, m_toolCallback);
+        m_contourTool->getWidget()->AddObserver(vtkCommand::EndInteractionEvent, m_toolCallback);
+
+        // Hover, selection and deletion of stored annotations
+        m_interactor = interactor;
+        m_interactorCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+        m_interactorCallback->SetCallback(&MeasuresManager::onInteractorEvent);
+        m_interactorCallback->SetClientData(this);
+        interactor->AddObserver(vtkCommand::MouseMoveEvent, m_interactorCallback);
+        interactor->AddObserver(vtkCommand::LeftButtonPressEvent, m_interactorCallback);
+        interactor->AddObserver(vtkCommand::KeyPressEvent, m_interactorCallback);
+
         m_initialized = true;
+        refreshDisplayedAnnotations();
+    }
+
+    MeasuresManager::~MeasuresManager()
+    {
+        if (m_interactor && m_interactorCallback)
+        {
+            m_interactor->RemoveObserver(m_interactorCallback);
+        }
+    }
+
+    void MeasuresManager::detach()
+    {
+        // Widgets only touch their interactor while it is alive
+        if (m_interactor)
+        {
+            deactivateAllTools();
+            for (auto& pool : m_displays)
+            {
+                for (AnnotationDisplay& display : pool)
+                {
+                    display.widget->EnabledOff();
+                }
+            }
+            if (m_interactorCallback)
+            {
+                m_interactor->RemoveObserver(m_interactorCallback);
+            }
+        }
+        m_currentTool = MeasureToolType::None;
+
+        m_distanceTool->getWidget()->RemoveObserver(m_toolCallback);
+        m_angleTool->getWidget()->RemoveObserver(m_toolCallback);
+        m_biDimensionalTool->getWidget()->RemoveObserver(m_toolCallback);
+        m_contourTool->getWidget()->RemoveObserver(m_toolCallback);
+
+        // Display widgets are bound to the old interactor; the pools refill on the new one
+        for (auto& pool : m_displays)
+        {
+            pool.clear();
+        }
+        m_visibleAnnotations.clear();
+        m_selectedAnnotation.reset();
+        m_hoveredAnnotation.reset();
+        m_interactor = nullptr;
+        m_initialized = false;
     }
 
     void MeasuresManager::activateTool(MeasureToolType toolType)
@@ -130,4 +230,505 @@ namespace isis::gui::measures
         m_currentTool = MeasureToolType::None;
     }
 
+    void MeasuresManager::setDisplayedSlice(const std::string& seriesInstanceUID, const SlicePlane& plane,
+                                            vtkImageData* image, int slice)
+    {
+        // Frame metrics are republished on zoom and window changes; only a new slice matters
+        if (m_hasSlice && m_seriesInstanceUID == seriesInstanceUID
+            && m_plane.sopInstanceUID == plane.sopInstanceUID && m_plane.frameNumber == plane.frameNumber
+            && m_plane.origin == plane.origin && m_plane.row == plane.row && m_plane.column == plane.column
+            && m_image == image && m_imageSlice == slice)
+        {
+            return;
+        }
+
+        m_seriesInstanceUID = seriesInstanceUID;
+        m_plane = plane;
+        m_image = image;
+        m_imageSlice = slice;
+        m_hasSlice = true;
+        refreshDisplayedAnnotations();
+    }
+
+    std::optional<AnnotationId> MeasuresManager::commitActiveMeasurement()
+    {
+        if (!m_initialized || !m_hasSlice)
+        {
+            return std::nullopt;
+        }
+
+        Annotation annotation;
+        std::vector<std::array<double, 3>> worldPoints;
+        switch (m_currentTool)
+        {
+        case MeasureToolType::Distance:
+            if (!m_distanceTool->isPlaced())
+            {
+                return std::nullopt;
+            }
+            annotation.type = AnnotationType::Distance;
+            worldPoints = m_distanceTool->getWorldPoints();
+            m_distanceTool->reset();
+            break;
+
+        case MeasureToolType::Angle:
+            if (!m_angleTool->isPlaced())
+            {
+                return std::nullopt;
+            }
+            annotation.type = AnnotationType::Angle;
+            worldPoints = m_angleTool->getWorldPoints();
+            m_angleTool->reset();
+            break;
+
+        case MeasureToolType::BiDimensional:
+            if (!m_biDimensionalTool->isPlaced())
+            {
+                return std::nullopt;
+            }
+            annotation.type = AnnotationType::BiDimensional;
+            worldPoints = m_biDimensionalTool->getWorldPoints();
+            m_biDimensionalTool->reset();
+            break;
+
+        case MeasureToolType::Contour:
+            if (!m_contourTool->isPlaced())
+            {
+                return std::nullopt;
+            }
+            annotation.type = AnnotationType::Contour;
+            annotation.closed = true;
+            worldPoints = m_contourTool->getWorldPoints();
+            m_contourTool->reset();
+            break;
+
+        case MeasureToolType::None:
+        default:
+            return std::nullopt;
+        }
+
+        for (const auto& point : worldPoints)
+        {
+            annotation.points.push_back(worldToPatient(m_plane, m_image, point));
+        }
+        annotation.seriesInstanceUID = m_seriesInstanceUID;
+        annotation.sopInstanceUID = m_plane.sopInstanceUID;
+        annotation.sopClassUID = m_plane.sopClassUID;
+        annotation.frameOfReferenceUID = m_plane.frameOfReferenceUID;
+        annotation.frameNumber = m_plane.frameNumber;
+        annotation.trackingUID = generateTrackingUID();
+
+        const AnnotationId id = m_store->add(std::move(annotation));
+        refreshDisplayedAnnotations();
+        storeChanged(m_seriesInstanceUID);
+        return id;
+    }
+
+    std::vector<std::string> MeasuresManager::takeModifiedSeries()
+    {
+        std::vector<std::string> series(m_modifiedSeries.begin(), m_modifiedSeries.end());
+        m_modifiedSeries.clear();
+        return series;
+    }
+
+    std::optional<AnnotationId> MeasuresManager::selectAt(const std::array<double, 3>& world, double tolerance)
+    {
+        if (!m_hasSlice)
+        {
+            return std::nullopt;
+        }
+
+        m_selectedAnnotation = m_store->hitTest(m_seriesInstanceUID, m_plane,
+                                                worldToPatient(m_plane, m_image, world), tolerance);
+        updateHighlights();
+        render();
+        return m_selectedAnnotation;
+    }
+
+    bool MeasuresManager::removeSelectedAnnotation()
+    {
+        if (!m_selectedAnnotation)
+        {
+            return false;
+        }
+
+        const Annotation* selected = m_store->find(*m_selectedAnnotation);
+        const std::string seriesInstanceUID = selected ? selected->seriesInstanceUID : std::string();
+        const bool removed = m_store->remove(*m_selectedAnnotation);
+        m_selectedAnnotation.reset();
+        m_hoveredAnnotation.reset();
+        refreshDisplayedAnnotations();
+        if (removed)
+        {
+            storeChanged(seriesInstanceUID);
+        }
+        return removed;
+    }
+
+    void MeasuresManager::clearAnnotations(const std::string& seriesInstanceUID)
+    {
+        m_store->clearSeries(seriesInstanceUID);
+        m_selectedAnnotation.reset();
+        m_hoveredAnnotation.reset();
+        refreshDisplayedAnnotations();
+        if (m_storeChanged)
+        {
+            m_storeChanged();
+        }
+    }
+
+    void MeasuresManager::clearAllAnnotations()
+    {
+        m_store->clear();
+        m_modifiedSeries.clear();
+        m_selectedAnnotation.reset();
+        m_hoveredAnnotation.reset();
+        m_hasSlice = false;
+        refreshDisplayedAnnotations();
+    }
+
+    void MeasuresManager::storeChanged(const std::string& seriesInstanceUID)
+    {
+        m_modifiedSeries.insert(seriesInstanceUID);
+        if (m_storeChanged)
+        {
+            m_storeChanged();
+        }
+    }
+
+    void MeasuresManager::onToolEvent(vtkObject* /*caller*/, unsigned long eventId, void* clientData, void* /*callData*/)
+    {
+        auto* manager = static_cast<MeasuresManager*>(clientData);
+        if (manager && eventId == vtkCommand::EndInteractionEvent)
+        {
+            manager->commitActiveMeasurement();
+        }
+    }
+
+    void MeasuresManager::onInteractorEvent(vtkObject* /*caller*/, unsigned long eventId, void* clientData, void* /*callData*/)
+    {
+        auto* manager = static_cast<MeasuresManager*>(clientData);
+        if (!manager || !manager->m_hasSlice || manager->m_visibleAnnotations.empty())
+        {
+            return;
+        }
+
+        // While a tool is placing a measurement the events belong to it
+        if (manager->m_currentTool != MeasureToolType::None)
+        {
+            return;
+        }
+
+        if (eventId == vtkCommand::KeyPressEvent)
+        {
+            const char* key = manager->m_interactor->GetKeySym();
+            if (key && (std::strcmp(key, "Delete") == 0 || std::strcmp(key, "BackSpace") == 0))
+            {
+                manager->removeSelectedAnnotation();
+            }
+            return;
+        }
+
+        const auto world = manager->eventWorldPosition();
+        if (!world)
+        {
+            return;
+        }
+
+        if (eventId == vtkCommand::LeftButtonPressEvent)
+        {
+            manager->selectAt(*world, PickTolerance);
+        }
+        else if (eventId == vtkCommand::MouseMoveEvent)
+        {
+            const auto hovered = manager->m_store->hitTest(manager->m_seriesInstanceUID, manager->m_plane,
+                worldToPatient(manager->m_plane, manager->m_image, *world), PickTolerance);
+            if (hovered != manager->m_hoveredAnnotation)
+            {
+                manager->m_hoveredAnnotation = hovered;
+                manager->updateHighlights();
+                manager->render();
+            }
+        }
+    }
+
+    void MeasuresManager::refreshDisplayedAnnotations()
+    {
+        if (!m_initialized)
+        {
+            return;
+        }
+
+        m_visibleAnnotations.clear();
+        if (m_hasSlice)
+        {
+            m_visibleAnnotations = m_store->visibleOn(m_seriesInstanceUID, m_plane);
+        }
+
+        const auto isVisible = [this](const std::optional<AnnotationId>& id)
+        {
+            return id && std::binary_search(m_visibleAnnotations.begin(), m_visibleAnnotations.end(), *id);
+        };
+        if (!isVisible(m_selectedAnnotation))
+        {
+            m_selectedAnnotation.reset();
+        }
+        if (!isVisible(m_hoveredAnnotation))
+        {
+            m_hoveredAnnotation.reset();
+        }
+
+        // Assign pooled widgets to the visible annotations, creating them only when a slice needs more
+        std::array<std::size_t, 4> used = {};
+        for (const AnnotationId id : m_visibleAnnotations)
+        {
+            const Annotation* annotation = m_store->find(id);
+            if (!annotation)
+            {
+                continue;
+            }
+
+            auto& pool = m_displays[typeIndex(annotation->type)];
+            std::size_t& slot = used[typeIndex(annotation->type)];
+            if (slot == pool.size())
+            {
+                pool.push_back({createDisplayWidget(annotation->type), 0});
+            }
+            showAnnotation(pool[slot++], *annotation);
+        }
+
+        // Hide the widgets this slice does not need
+        for (std::size_t type = 0; type < m_displays.size(); ++type)
+        {
+            for (std::size_t i = used[type]; i < m_displays[type].size(); ++i)
+            {
+                AnnotationDisplay& display = m_displays[type][i];
+                if (display.annotation != 0)
+                {
+                    display.widget->EnabledOff();
+                    display.annotation = 0;
+                }
+            }
+        }
+
+        updateHighlights();
+        render();
+    }
+
+    vtkSmartPointer<vtkAbstractWidget> MeasuresManager::createDisplayWidget(AnnotationType type) const
+    {
+        vtkSmartPointer<vtkAbstractWidget> widget;
+        switch (type)
+        {
+        case AnnotationType::Distance:
+        {
+            auto distance = vtkSmartPointer<vtkDistanceWidget>::New();
+            distance->SetInteractor(m_interactor);
+            distance->CreateDefaultRepresentation();
+            auto* representation = static_cast<vtkDistanceRepresentation*>(distance->GetRepresentation());
+            representation->InstantiateHandleRepresentation();
+            representation->SetLabelFormat("%-#6.3g mm");
+            widget = distance;
+            break;
+        }
+
+        case AnnotationType::Angle:
+        {
+            auto angle = vtkSmartPointer<vtkAngleWidget>::New();
+            angle->SetInteractor(m_interactor);
+            angle->CreateDefaultRepresentation();
+            static_cast<vtkAngleRepresentation*>(angle->GetRepresentation())->InstantiateHandleRepresentation();
+            widget = angle;
+            break;
+        }
+
+        case AnnotationType::BiDimensional:
+        {
+            auto biDimensional = vtkSmartPointer<vtkBiDimensionalWidget>::New();
+            biDimensional->SetInteractor(m_interactor);
+            biDimensional->CreateDefaultRepresentation();
+            static_cast<vtkBiDimensionalRepresentation*>(biDimensional->GetRepresentation())
+                ->InstantiateHandleRepresentation();
+            widget = biDimensional;
+            break;
+        }
+
+        case AnnotationType::Contour:
+        {
+            auto contour = vtkSmartPointer<vtkContourWidget>::New();
+            contour->SetInteractor(m_interactor);
+            auto representation = vtkSmartPointer<vtkOrientedGlyphContourRepresentation>::New();
+            representation->GetLinesProperty()->SetLineWidth(2.0);
+            contour->SetRepresentation(representation);
+            widget = contour;
+            break;
+        }
+        }
+
+        // Display only: the active tool and the interactor style keep the events
+        widget->ProcessEventsOff();
+        return widget;
+    }
+
+    void MeasuresManager::showAnnotation(AnnotationDisplay& display, const Annotation& annotation) const
+    {
+        std::vector<std::array<double, 3>> world;
+        world.reserve(annotation.points.size());
+        for (const auto& point : annotation.points)
+        {
+            world.push_back(patientToWorld(m_plane, m_image, m_imageSlice, point));
+        }
+
+        display.annotation = annotation.id;
+        switch (annotation.type)
+        {
+        case AnnotationType::Distance:
+        {
+            auto* widget = static_cast<vtkDistanceWidget*>(display.widget.Get());
+            auto* representation = static_cast<vtkDistanceRepresentation*>(widget->GetRepresentation());
+            if (world.size() >= 2)
+            {
+                representation->SetPoint1WorldPosition(world[0].data());
+                representation->SetPoint2WorldPosition(world[1].data());
+            }
+            widget->EnabledOn();
+            widget->SetWidgetStateToManipulate();
+            break;
+        }
+
+        case AnnotationType::Angle:
+        {
+            auto* widget = static_cast<vtkAngleWidget*>(display.widget.Get());
+            auto* representation = static_cast<vtkAngleRepresentation2D*>(widget->GetRepresentation());
+            if (world.size() >= 3)
+            {
+                representation->SetPoint1WorldPosition(world[0].data());
+                representation->SetCenterWorldPosition(world[1].data());
+                representation->SetPoint2WorldPosition(world[2].data());
+            }
+            widget->EnabledOn();
+            widget->SetWidgetStateToManipulate();
+            break;
+        }
+
+        case AnnotationType::BiDimensional:
+        {
+            auto* widget = static_cast<vtkBiDimensionalWidget*>(display.widget.Get());
+            auto* representation = static_cast<vtkBiDimensionalRepresentation*>(widget->GetRepresentation());
+            if (world.size() >= 4)
+            {
+                representation->SetPoint1WorldPosition(world[0].data());
+                representation->SetPoint2WorldPosition(world[1].data());
+                representation->SetPoint3WorldPosition(world[2].data());
+                representation->SetPoint4WorldPosition(world[3].data());
+            }
+            widget->EnabledOn();
+            widget->SetWidgetStateToManipulate();
+            break;
+        }
+
+        case AnnotationType::Contour:
+        {
+            auto* widget = static_cast<vtkContourWidget*>(display.widget.Get());
+            auto points = vtkSmartPointer<vtkPoints>::New();
+            auto lines = vtkSmartPointer<vtkCellArray>::New();
+            lines->InsertNextCell(static_cast<int>(world.size()));
+            for (const auto& point : world)
+            {
+                lines->InsertCellPoint(points->InsertNextPoint(point.data()));
+            }
+            auto polyData = vtkSmartPointer<vtkPolyData>::New();
+            polyData->SetPoints(points);
+            polyData->SetLines(lines);
+
+            // The contour widget must be enabled before it accepts nodes
+            widget->EnabledOn();
+            widget->Initialize(polyData);
+            widget->GetContourRepresentation()->SetClosedLoop(annotation.closed ? 1 : 0);
+            break;
+        }
+        }
+    }
+
+    void MeasuresManager::updateHighlights()
+    {
+        for (std::size_t type = 0; type < m_displays.size(); ++type)
+        {
+            for (AnnotationDisplay& display : m_displays[type])
+            {
+                if (display.annotation == 0)
+                {
+                    continue;
+                }
+
+                const bool highlighted = display.annotation == m_selectedAnnotation
+                    || display.annotation == m_hoveredAnnotation;
+                highlight(display, static_cast<AnnotationType>(type), highlighted);
+            }
+        }
+    }
+
+    void MeasuresManager::highlight(AnnotationDisplay& display, AnnotationType type, bool selected) const
+    {
+        const double* color = selected ? HighlightColor : AnnotationColor;
+        switch (type)
+        {
+        case AnnotationType::Distance:
+            static_cast<vtkDistanceRepresentation2D*>(display.widget->GetRepresentation())
+                ->GetAxisProperty()->SetColor(color[0], color[1], color[2]);
+            break;
+
+        case AnnotationType::Angle:
+        {
+            auto* representation = static_cast<vtkAngleRepresentation2D*>(display.widget->GetRepresentation());
+            representation->GetRay1()->GetProperty()->SetColor(color[0], color[1], color[2]);
+            representation->GetRay2()->GetProperty()->SetColor(color[0], color[1], color[2]);
+            representation->GetArc()->GetProperty()->SetColor(color[0], color[1], color[2]);
+            break;
+        }
+
+        case AnnotationType::BiDimensional:
+            static_cast<vtkBiDimensionalRepresentation2D*>(display.widget->GetRepresentation())
+                ->GetLineProperty()->SetColor(color[0], color[1], color[2]);
+            break;
+
+        case AnnotationType::Contour:
+            static_cast<vtkOrientedGlyphContourRepresentation*>(display.widget->GetRepresentation())
+                ->GetLinesProperty()->SetColor(color[0], color[1], color[2]);
+            break;
+        }
+    }
+
+    std::optional<std::array<double, 3>> MeasuresManager::eventWorldPosition() const
+    {
+        if (!m_interactor)
+        {
+            return std::nullopt;
+        }
+
+        const int* position = m_interactor->GetEventPosition();
+        vtkRenderer* renderer = m_interactor->FindPokedRenderer(position[0], position[1]);
+        if (!renderer)
+        {
+            return std::nullopt;
+        }
+
+        renderer->SetDisplayPoint(position[0], position[1], 0.0);
+        renderer->DisplayToWorld();
+        const double* world = renderer->GetWorldPoint();
+        if (world[3] == 0.0)
+        {
+            return std::nullopt;
+        }
+        return std::array<double, 3>{world[0] / world[3], world[1] / world[3], world[2] / world[3]};
+    }
+
+    void MeasuresManager::render() const
+    {
+        if (m_interactor)
+        {
+            m_interactor->Render();
+        }
+    }
+
 } // namespace isis::gui::measures
@@ -8,6 +8,8 @@
  *  Description:
  *      Central manager for all measurement tools (distance, angle, bidimensional, contour)
  *      Provides unified interface for tool activation and measurement persistence.
+ *      Placed measurements are kept in an AnnotationStore and redrawn on the slices
+ *      they intersect.
  *
  *  License:
  *      Apache License 2.0
@@ -20,9 +22,19 @@
 #include "anglemeasuretool.h"
 #include "bidimensionalmeasuretool.h"
 #include "contourtool.h"
+#include "annotationstore.h"
+#include <array>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
 #include <vector>
+#include <vtkAbstractWidget.h>
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
 #include <vtkRenderWindowInteractor.h>
+#include <vtkWeakPointer.h>
 
 namespace isis::gui::measures
 {
@@ -43,15 +55,26 @@ namespace isis::gui::measures
      *
      * This class provides a centralized interface for managing multiple
      * measurement tools, ensuring only one tool is active at a time.
+     *
+     * A tool only draws the measurement being placed. Once it is complete the
+     * measurement is converted to patient coordinates, added to the annotation
+     * store and the tool is reset for the next one. Stored annotations of the
+     * displayed slice are drawn by passive widgets taken from a per-type pool,
+     * so scrolling reuses the widgets instead of creating one per annotation.
+     *
+     * Each 2D view has its own manager; the views share one annotation store.
      */
     class MeasuresManager
     {
     public:
-        MeasuresManager();
-        ~MeasuresManager() = default;
+        explicit MeasuresManager(std::shared_ptr<AnnotationStore> store = std::make_shared<AnnotationStore>());
+        ~MeasuresManager();
 
         /**
          * @brief Initialize all measurement tools with a render window interactor
+         *
+         * Called again with another interactor (the view's render window was
+         * recreated), the tools and stored annotations move to the new one.
          * @param interactor The VTK render window interactor
          */
         void initialize(vtkRenderWindowInteractor* interactor);
@@ -84,6 +107,68 @@ namespace isis::gui::measures
          */
         [[nodiscard]] bool isAnyToolActive() const { return m_currentTool != MeasureToolType::None; }
 
+        /**
+         * @brief Set the slice shown by the view and draw the annotations that intersect it
+         * @param seriesInstanceUID Series of the displayed image
+         * @param plane Geometry and identity of the displayed slice
+         * @param image Image drawn by the view; its origin, spacing and direction place
+         *        the pixels in world space. Without it, world X/Y are taken as millimetres
+         *        from the first pixel of the slice
+         * @param slice Index of the displayed slice in the image
+         */
+        void setDisplayedSlice(const std::string& seriesInstanceUID, const SlicePlane& plane,
+                               vtkImageData* image = nullptr, int slice = 0);
+
+        /**
+         * @brief Redraw the annotations of the displayed slice (after another view changed the store)
+         */
+        void refreshDisplayedAnnotations();
+
+        /**
+         * @brief Called after this manager placed or deleted an annotation
+         */
+        void setStoreChangedCallback(std::function<void()> callback) { m_storeChanged = std::move(callback); }
+
+        /**
+         * @brief Store the measurement of the active tool if it is complete
+         * @return Id of the new annotation, or nothing if no measurement was complete
+         */
+        std::optional<AnnotationId> commitActiveMeasurement();
+
+        /**
+         * @brief Select the annotation of the displayed slice under a world position
+         * @param world World position in the 2D view
+         * @param tolerance Maximum distance to the annotation in mm
+         * @return Id of the selected annotation, or nothing if none was hit
+         */
+        std::optional<AnnotationId> selectAt(const std::array<double, 3>& world, double tolerance);
+
+        /**
+         * @brief Delete the selected annotation
+         * @return true if an annotation was removed
+         */
+        bool removeSelectedAnnotation();
+
+        /**
+         * @brief Series whose annotations were placed or deleted since the last call
+         */
+        [[nodiscard]] std::vector<std::string> takeModifiedSeries();
+
+        /**
+         * @brief Drop the annotations of a series (when it is closed)
+         */
+        void clearAnnotations(const std::string& seriesInstanceUID);
+
+        /**
+         * @brief Drop every annotation and forget the displayed slice (when all patients are closed)
+         */
+        void clearAllAnnotations();
+
+        [[nodiscard]] AnnotationStore& getAnnotationStore() { return *m_store; }
+        [[nodiscard]] const AnnotationStore& getAnnotationStore() const { return *m_store; }
+        [[nodiscard]] const std::vector<AnnotationId>& getVisibleAnnotations() const { return m_visibleAnnotations; }
+        [[nodiscard]] std::optional<AnnotationId> getSelectedAnnotation() const { return m_selectedAnnotation; }
+
         // Tool accessors
         [[nodiscard]] DistanceMeasureTool* getDistanceTool() { return m_distanceTool.get(); }
         [[nodiscard]] AngleMeasureTool* getAngleTool() { return m_angleTool.get(); }
@@ -97,6 +182,27 @@ namespace isis::gui::measures
         [[nodiscard]] const ContourTool* getContourTool() const { return m_contourTool.get(); }
 
     private:
+        /**
+         * @brief Passive widget drawing one stored annotation
+         */
+        struct AnnotationDisplay
+        {
+            vtkSmartPointer<vtkAbstractWidget> widget;
+            AnnotationId annotation = 0;
+        };
+
+        static void onToolEvent(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+        static void onInteractorEvent(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+
+        void detach();
+        void storeChanged(const std::string& seriesInstanceUID);
+        vtkSmartPointer<vtkAbstractWidget> createDisplayWidget(AnnotationType type) const;
+        void showAnnotation(AnnotationDisplay& display, const Annotation& annotation) const;
+        void updateHighlights();
+        void highlight(AnnotationDisplay& display, AnnotationType type, bool selected) const;
+        [[nodiscard]] std::optional<std::array<double, 3>> eventWorldPosition() const;
+        void render() const;
+
         std::unique_ptr<DistanceMeasureTool> m_distanceTool;
         std::unique_ptr<AngleMeasureTool> m_angleTool;
         std::unique_ptr<BiDimensionalMeasureTool> m_biDimensionalTool;
@@ -104,6 +210,25 @@ namespace isis::gui::measures
 
         MeasureToolType m_currentTool = MeasureToolType::None;
         bool m_initialized = false;
+
+        vtkWeakPointer<vtkRenderWindowInteractor> m_interactor;
+        vtkSmartPointer<vtkCallbackCommand> m_toolCallback;
+        vtkSmartPointer<vtkCallbackCommand> m_interactorCallback;
+
+        std::shared_ptr<AnnotationStore> m_store;
+        std::function<void()> m_storeChanged;
+        std::string m_seriesInstanceUID;
+        SlicePlane m_plane;
+        vtkWeakPointer<vtkImageData> m_image;
+        int m_imageSlice = 0;
+        bool m_hasSlice = false;
+        std::vector<AnnotationId> m_visibleAnnotations;
+        std::optional<AnnotationId> m_selectedAnnotation;
+        std::optional<AnnotationId> m_hoveredAnnotation;
+        std::unordered_set<std::string> m_modifiedSeries;
+
+        // Display widgets per AnnotationType, grown to the most annotations seen on one slice
+        std::array<std::vector<AnnotationDisplay>, 4> m_displays;
     };
 
 } // namespace isis::gui::measures
@@ -0,0 +1,65 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: slicegeometry.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the 2D view to patient coordinate conversion
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "slicegeometry.h"
+
+#include <vtkImageData.h>
+
+namespace isis::gui::measures
+{
+    namespace
+    {
+        bool hasGeometry(vtkImageData* image)
+        {
+            const double* spacing = image ? image->GetSpacing() : nullptr;
+            return spacing && spacing[0] > 0.0 && spacing[1] > 0.0;
+        }
+    }
+
+    Point3 worldToPatient(const SlicePlane& plane, vtkImageData* image, const std::array<double, 3>& world)
+    {
+        if (!hasGeometry(image))
+        {
+            return plane.toPatient(world[0], world[1]);
+        }
+
+        int extent[6] = {};
+        double index[3] = {};
+        image->GetExtent(extent);
+        image->TransformPhysicalPointToContinuousIndex(world.data(), index);
+        const double* spacing = image->GetSpacing();
+        return plane.toPatient((index[0] - extent[0]) * spacing[0], (index[1] - extent[2]) * spacing[1]);
+    }
+
+    std::array<double, 3> patientToWorld(const SlicePlane& plane, vtkImageData* image, int slice,
+                                         const Point3& patient)
+    {
+        const Point3 local = plane.toPlane(patient);
+        if (!hasGeometry(image))
+        {
+            return {local[0], local[1], 0.0};
+        }
+
+        int extent[6] = {};
+        image->GetExtent(extent);
+        const double* spacing = image->GetSpacing();
+        const double index[3] = {extent[0] + local[0] / spacing[0], extent[2] + local[1] / spacing[1],
+                                 static_cast<double>(slice)};
+        std::array<double, 3> world = {};
+        image->TransformContinuousIndexToPhysicalPoint(index, world.data());
+        return world;
+    }
+
+} // namespace isis::gui::measures
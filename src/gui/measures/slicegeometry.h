@@ -0,0 +1,44 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: slicegeometry.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Conversion between the world positions of a 2D view and the patient
+ *      coordinates the measurements are stored in.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "annotationstore.h"
+
+#include <array>
+
+class vtkImageData;
+
+namespace isis::gui::measures
+{
+    /**
+     * @brief Patient position of a world position reported by a 2D view
+     *
+     * World positions already hold the image origin (Image Position), so the
+     * position is taken back to a pixel index of the image and scaled by the
+     * spacing before it is placed on the plane. Without an image, world X/Y are
+     * taken as millimetres from the first pixel of the slice.
+     */
+    [[nodiscard]] Point3 worldToPatient(const SlicePlane& plane, vtkImageData* image,
+                                        const std::array<double, 3>& world);
+
+    /**
+     * @brief World position of a patient position on a slice of the image (inverse of worldToPatient)
+     */
+    [[nodiscard]] std::array<double, 3> patientToWorld(const SlicePlane& plane, vtkImageData* image, int slice,
+                                                       const Point3& patient);
+
+} // namespace isis::gui::measures
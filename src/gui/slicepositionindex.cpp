@@ -0,0 +1,292 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: slicepositionindex.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the per-series slice position index and reference lines
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "slicepositionindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+        using isis::gui::Vector3;
+
+        // Planes closer than about 2.5 degrees to parallel do not cross inside the image
+        constexpr double ParallelCosine = 0.999;
+
+        // Extent given to slices whose size is unknown, in mm
+        constexpr double UnboundedExtent = 1.0e6;
+
+        double dot(const Vector3& a, const Vector3& b)
+        {
+                return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        Vector3 subtract(const Vector3& a, const Vector3& b)
+        {
+                return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+        }
+
+        Vector3 interpolate(const Vector3& a, const Vector3& b, double t)
+        {
+                return {a[0] + (b[0] - a[0]) * t, a[1] + (b[1] - a[1]) * t, a[2] + (b[2] - a[2]) * t};
+        }
+
+        // Liang-Barsky clip of the segment to [0, width] x [0, height]
+        bool clipToRect(std::array<double, 4>& segment, double width, double height)
+        {
+                const double dx = segment[2] - segment[0];
+                const double dy = segment[3] - segment[1];
+                const double p[4] = {-dx, dx, -dy, dy};
+                const double q[4] = {segment[0], width - segment[0], segment[1], height - segment[1]};
+                double enter = 0.0;
+                double leave = 1.0;
+                for (int i = 0; i < 4; ++i)
+                {
+                        if (p[i] == 0.0)
+                        {
+                                if (q[i] < 0.0)
+                                {
+                                        return false;
+                                }
+                                continue;
+                        }
+                        const double t = q[i] / p[i];
+                        if (p[i] < 0.0)
+                        {
+                                enter = std::max(enter, t);
+                        }
+                        else
+                        {
+                                leave = std::min(leave, t);
+                        }
+                }
+                if (enter > leave)
+                {
+                        return false;
+                }
+                segment = {segment[0] + enter * dx, segment[1] + enter * dy,
+                           segment[0] + leave * dx, segment[1] + leave * dy};
+                return true;
+        }
+}
+
+isis::gui::Vector3 isis::gui::SliceGeometry::normal() const
+{
+        Vector3 normal = {row[1] * column[2] - row[2] * column[1],
+                          row[2] * column[0] - row[0] * column[2],
+                          row[0] * column[1] - row[1] * column[0]};
+        const double length = std::sqrt(dot(normal, normal));
+        if (length > 0.0 && std::isfinite(length))
+        {
+                normal = {normal[0] / length, normal[1] / length, normal[2] / length};
+        }
+        return normal;
+}
+
+isis::gui::Vector3 isis::gui::SliceGeometry::center() const
+{
+        return toPatient(std::max(columns - 1, 0) / 2.0, std::max(rows - 1, 0) / 2.0);
+}
+
+isis::gui::Vector3 isis::gui::SliceGeometry::toPatient(const double pixelX, const double pixelY) const
+{
+        const double x = pixelX * spacingX;
+        const double y = pixelY * spacingY;
+        return {origin[0] + x * row[0] + y * column[0],
+                origin[1] + x * row[1] + y * column[1],
+                origin[2] + x * row[2] + y * column[2]};
+}
+
+//-----------------------------------------------------------------------------
+isis::gui::SlicePositionIndex::SlicePositionIndex(std::string t_frameOfReferenceUID,
+        std::vector<SliceGeometry> t_slices)
+        : m_frameOfReferenceUID(std::move(t_frameOfReferenceUID))
+        , m_slices(std::move(t_slices))
+{
+        if (m_slices.empty())
+        {
+                return;
+        }
+
+        m_normal = m_slices.front().normal();
+        m_sorted.reserve(m_slices.size());
+        for (std::size_t i = 0; i < m_slices.size(); ++i)
+        {
+                m_sorted.push_back({dot(m_slices[i].origin, m_normal), static_cast<int>(i)});
+        }
+        std::stable_sort(m_sorted.begin(), m_sorted.end(),
+                [](const Entry& lhs, const Entry& rhs) { return lhs.position < rhs.position; });
+
+        std::vector<double> gaps;
+        gaps.reserve(m_sorted.size());
+        for (std::size_t i = 1; i < m_sorted.size(); ++i)
+        {
+                const double gap = m_sorted[i].position - m_sorted[i - 1].position;
+                if (gap > 1e-6)
+                {
+                        gaps.push_back(gap);
+                }
+        }
+        if (!gaps.empty())
+        {
+                std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+                m_spacing = gaps[gaps.size() / 2];
+        }
+}
+
+const isis::gui::SliceGeometry* isis::gui::SlicePositionIndex::slice(const int t_frameIndex) const
+{
+        if (t_frameIndex < 0 || static_cast<std::size_t>(t_frameIndex) >= m_slices.size())
+        {
+                return nullptr;
+        }
+        return &m_slices[static_cast<std::size_t>(t_frameIndex)];
+}
+
+std::optional<int> isis::gui::SlicePositionIndex::nearestFrame(const Vector3& t_point) const
+{
+        m_lastComparisons = 0;
+        if (m_sorted.empty())
+        {
+                return std::nullopt;
+        }
+
+        const double position = dot(t_point, m_normal);
+        const double margin = std::max(m_spacing, 1.0) / 2.0;
+        if (position < m_sorted.front().position - margin || position > m_sorted.back().position + margin)
+        {
+                return std::nullopt;
+        }
+
+        // First entry at or above the position
+        std::size_t low = 0;
+        std::size_t high = m_sorted.size();
+        while (low < high)
+        {
+                const std::size_t middle = low + (high - low) / 2;
+                ++m_lastComparisons;
+                if (m_sorted[middle].position < position)
+                {
+                        low = middle + 1;
+                }
+                else
+                {
+                        high = middle;
+                }
+        }
+
+        if (low == m_sorted.size())
+        {
+                return m_sorted.back().frameIndex;
+        }
+        if (low > 0 && position - m_sorted[low - 1].position <= m_sorted[low].position - position)
+        {
+                return m_sorted[low - 1].frameIndex;
+        }
+        return m_sorted[low].frameIndex;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<std::array<double, 4>> isis::gui::referenceLine(const SliceGeometry& t_target,
+        const SliceGeometry& t_source)
+{
+        const Vector3 targetNormal = t_target.normal();
+        if (std::abs(dot(targetNormal, t_source.normal())) > ParallelCosine
+                || t_target.columns <= 0 || t_target.rows <= 0
+                || !(t_target.spacingX > 0.0) || !(t_target.spacingY > 0.0))
+        {
+                return std::nullopt;
+        }
+
+        // Outline of the source image (pixel edges, not centres)
+        std::array<Vector3, 4> corners;
+        if (t_source.columns > 0 && t_source.rows > 0)
+        {
+                const double right = t_source.columns - 0.5;
+                const double bottom = t_source.rows - 0.5;
+                corners = {t_source.toPatient(-0.5, -0.5), t_source.toPatient(right, -0.5),
+                           t_source.toPatient(right, bottom), t_source.toPatient(-0.5, bottom)};
+        }
+        else
+        {
+                SliceGeometry unbounded = t_source;
+                unbounded.spacingX = 1.0;
+                unbounded.spacingY = 1.0;
+                corners = {unbounded.toPatient(-UnboundedExtent, -UnboundedExtent),
+                           unbounded.toPatient(UnboundedExtent, -UnboundedExtent),
+                           unbounded.toPatient(UnboundedExtent, UnboundedExtent),
+                           unbounded.toPatient(-UnboundedExtent, UnboundedExtent)};
+        }
+
+        // Where the outline crosses the target plane
+        std::array<double, 4> distances = {};
+        for (std::size_t i = 0; i < corners.size(); ++i)
+        {
+                distances[i] = dot(subtract(corners[i], t_target.origin), targetNormal);
+        }
+        std::vector<Vector3> crossings;
+        for (std::size_t i = 0; i < corners.size(); ++i)
+        {
+                const std::size_t next = (i + 1) % corners.size();
+                const double a = distances[i];
+                const double b = distances[next];
+                if (a == 0.0)
+                {
+                        crossings.push_back(corners[i]);
+                }
+                else if ((a < 0.0 && b > 0.0) || (a > 0.0 && b < 0.0))
+                {
+                        crossings.push_back(interpolate(corners[i], corners[next], a / (a - b)));
+                }
+        }
+        if (crossings.size() < 2)
+        {
+                return std::nullopt;
+        }
+
+        // Farthest pair, in case a corner lies on the plane
+        std::size_t first = 0;
+        std::size_t second = 1;
+        double longest = -1.0;
+        for (std::size_t i = 0; i < crossings.size(); ++i)
+        {
+                for (std::size_t j = i + 1; j < crossings.size(); ++j)
+                {
+                        const Vector3 delta = subtract(crossings[j], crossings[i]);
+                        const double length = dot(delta, delta);
+                        if (length > longest)
+                        {
+                                longest = length;
+                                first = i;
+                                second = j;
+                        }
+                }
+        }
+
+        const auto toPixel = [&t_target](const Vector3& point)
+        {
+                const Vector3 offset = subtract(point, t_target.origin);
+                return std::array<double, 2>{dot(offset, t_target.row) / t_target.spacingX + 0.5,
+                                             dot(offset, t_target.column) / t_target.spacingY + 0.5};
+        };
+        const auto start = toPixel(crossings[first]);
+        const auto end = toPixel(crossings[second]);
+        std::array<double, 4> segment = {start[0], start[1], end[0], end[1]};
+        if (!clipToRect(segment, t_target.columns, t_target.rows))
+        {
+                return std::nullopt;
+        }
+        return segment;
+}
@@ -0,0 +1,111 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: slicepositionindex.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Geometry of the slices of a series, with their positions along the slice
+ *      normal kept sorted so the slice nearest to a patient-space point is found
+ *      by binary search, and the segment where one slice plane crosses another
+ *      image, used to draw reference lines.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace isis::gui
+{
+        using Vector3 = std::array<double, 3>;
+
+        /**
+         * @brief Plane and extent of one displayed slice
+         */
+        struct SliceGeometry
+        {
+                Vector3 origin = {0.0, 0.0, 0.0};       // Image Position (Patient), centre of the first pixel
+                Vector3 row = {1.0, 0.0, 0.0};          // Direction of increasing column index
+                Vector3 column = {0.0, 1.0, 0.0};       // Direction of increasing row index
+                double spacingX = 1.0;                  // mm between columns
+                double spacingY = 1.0;                  // mm between rows
+                int columns = 0;
+                int rows = 0;
+
+                [[nodiscard]] Vector3 normal() const;
+                [[nodiscard]] Vector3 center() const;
+                [[nodiscard]] Vector3 toPatient(double pixelX, double pixelY) const;
+        };
+
+        /**
+         * @brief Slices of one series sorted by their position along the series normal
+         */
+        class SlicePositionIndex
+        {
+        public:
+                SlicePositionIndex() = default;
+
+                /**
+                 * @param t_frameOfReferenceUID Frame of reference shared by the slices
+                 * @param t_slices Slices in display (frame index) order
+                 */
+                SlicePositionIndex(std::string t_frameOfReferenceUID, std::vector<SliceGeometry> t_slices);
+
+                [[nodiscard]] bool isValid() const { return !m_sorted.empty(); }
+                [[nodiscard]] std::size_t size() const { return m_slices.size(); }
+                [[nodiscard]] const std::string& frameOfReferenceUID() const { return m_frameOfReferenceUID; }
+                [[nodiscard]] const Vector3& normal() const { return m_normal; }
+                [[nodiscard]] const SliceGeometry* slice(int t_frameIndex) const;
+
+                /**
+                 * @brief Median distance between neighbouring slices (mm)
+                 */
+                [[nodiscard]] double sliceSpacing() const { return m_spacing; }
+
+                /**
+                 * @brief Frame index of the slice nearest to a point
+                 *
+                 * Points farther than half a slice beyond the first or last slice
+                 * have no nearest slice.
+                 */
+                [[nodiscard]] std::optional<int> nearestFrame(const Vector3& t_point) const;
+
+                /**
+                 * @brief Slice comparisons visited by the last nearestFrame() call
+                 */
+                [[nodiscard]] std::size_t lastComparisons() const { return m_lastComparisons; }
+
+        private:
+                struct Entry
+                {
+                        double position = 0.0;
+                        int frameIndex = 0;
+                };
+
+                std::string m_frameOfReferenceUID;
+                std::vector<SliceGeometry> m_slices;
+                std::vector<Entry> m_sorted;
+                Vector3 m_normal = {0.0, 0.0, 1.0};
+                double m_spacing = 0.0;
+                mutable std::size_t m_lastComparisons = 0;
+        };
+
+        /**
+         * @brief Segment where the plane of one slice crosses the image of another
+         *
+         * The source slice is clipped to its own extent first, then to the target
+         * image. Coordinates are continuous pixel coordinates of the target image
+         * ({x0, y0, x1, y1}; pixel i covers [i, i + 1)). Nearly parallel planes
+         * have no reference line.
+         */
+        [[nodiscard]] std::optional<std::array<double, 4>> referenceLine(const SliceGeometry& t_target,
+                                                                         const SliceGeometry& t_source);
+}
@@ -0,0 +1,281 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: viewportlinker.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of viewport linking and reference lines
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "viewportlinker.h"
+
+#include <QLineF>
+#include <QVector>
+
+#include <cmath>
+
+#include "series.h"
+#include "widget2d.h"
+
+namespace
+{
+        double dot(const isis::gui::Vector3& a, const isis::gui::Vector3& b)
+        {
+                return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        struct ViewportState
+        {
+                isis::gui::Widget2D* widget = nullptr;
+                const isis::gui::SlicePositionIndex* index = nullptr;
+                int currentFrame = 0;
+                int targetFrame = 0;
+        };
+}
+
+isis::gui::ViewportLinker::ViewportLinker(QObject* parent)
+        : QObject(parent)
+{
+        m_flushTimer.setSingleShot(true);
+        m_flushTimer.setInterval(0);
+        connect(&m_flushTimer, &QTimer::timeout, this, &ViewportLinker::flush);
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::setEnabled(const bool t_enabled)
+{
+        if (m_enabled == t_enabled)
+        {
+                return;
+        }
+        m_enabled = t_enabled;
+        if (!m_enabled)
+        {
+                m_flushTimer.stop();
+                m_driver = nullptr;
+                clearReferenceLines();
+                return;
+        }
+        // Start from the active viewport when there is one; otherwise only draw lines
+        m_flushTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::setViewports(const std::vector<Widget2D*>& t_viewports)
+{
+        clearReferenceLines();
+        m_viewports.clear();
+        for (auto* viewport : t_viewports)
+        {
+                if (viewport)
+                {
+                        m_viewports.emplace_back(viewport);
+                }
+        }
+        m_driver = nullptr;
+        if (m_enabled)
+        {
+                m_flushTimer.start();
+        }
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::requestSync(Widget2D* t_viewport, const bool t_driving)
+{
+        if (!m_enabled || m_applying || !t_viewport)
+        {
+                return;
+        }
+        if (t_driving)
+        {
+                m_driver = t_viewport;
+        }
+        // Several scroll steps within one pass of the event loop give one update
+        if (!m_flushTimer.isActive())
+        {
+                m_flushTimer.start();
+        }
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::clear()
+{
+        m_flushTimer.stop();
+        m_driver = nullptr;
+        clearReferenceLines();
+        m_indexes.clear();
+}
+
+//-----------------------------------------------------------------------------
+const isis::gui::SlicePositionIndex* isis::gui::ViewportLinker::indexFor(core::Series* t_series)
+{
+        if (!t_series)
+        {
+                return nullptr;
+        }
+        const std::size_t imageCount = t_series->getSingleFrameImages().size();
+        auto it = m_indexes.find(t_series);
+        // Series still loading grow; rebuild when the slice count changes
+        if (it == m_indexes.end() || it->second.imageCount != imageCount)
+        {
+                CachedIndex cached;
+                cached.imageCount = imageCount;
+                cached.index = buildIndex(t_series);
+                it = m_indexes.insert_or_assign(t_series, std::move(cached)).first;
+        }
+        return it->second.index.isValid() ? &it->second.index : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+isis::gui::SlicePositionIndex isis::gui::ViewportLinker::buildIndex(core::Series* t_series)
+{
+        // Multi-frame instances carry no per-frame position here
+        if (!t_series->getMultiFrameImages().empty())
+        {
+                return {};
+        }
+
+        std::string frameOfReference;
+        std::vector<SliceGeometry> slices;
+        slices.reserve(t_series->getSingleFrameImages().size());
+        for (const auto& image : t_series->getSingleFrameImages())
+        {
+                if (!image->hasImagePositionPatient() || !image->hasImageOrientationPatient())
+                {
+                        return {};
+                }
+                if (frameOfReference.empty())
+                {
+                        frameOfReference = image->getFrameOfRefernceID();
+                }
+                SliceGeometry slice;
+                slice.origin = image->getImagePositionPatient();
+                slice.row = image->getImageOrientationRow();
+                slice.column = image->getImageOrientationColumn();
+                slice.spacingX = image->getPixelSpacingX() > 0.0 ? image->getPixelSpacingX() : 1.0;
+                slice.spacingY = image->getPixelSpacingY() > 0.0 ? image->getPixelSpacingY() : 1.0;
+                slice.columns = image->getColumns();
+                slice.rows = image->getRows();
+                slices.push_back(slice);
+        }
+        return {std::move(frameOfReference), std::move(slices)};
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::clearReferenceLines()
+{
+        for (const auto& viewport : m_viewports)
+        {
+                if (viewport)
+                {
+                        viewport->setReferenceLines({}, true);
+                }
+        }
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::ViewportLinker::flush()
+{
+        if (!m_enabled || m_applying)
+        {
+                return;
+        }
+
+        std::vector<ViewportState> states;
+        states.reserve(m_viewports.size());
+        for (const auto& viewport : m_viewports)
+        {
+                if (!viewport)
+                {
+                        continue;
+                }
+                ViewportState state;
+                state.widget = viewport.data();
+                state.index = indexFor(viewport->getSeries());
+                state.currentFrame = viewport->getCurrentFrameIndex();
+                state.targetFrame = state.currentFrame;
+                states.push_back(state);
+        }
+
+        // 1. Move the linked viewports to the slice nearest to the driving slice
+        const ViewportState* driver = nullptr;
+        for (const auto& state : states)
+        {
+                if (state.widget == m_driver.data() && state.index)
+                {
+                        driver = &state;
+                }
+        }
+        if (driver)
+        {
+                const SliceGeometry* drivingSlice = driver->index->slice(driver->currentFrame);
+                const std::string& frameOfReference = driver->index->frameOfReferenceUID();
+                if (drivingSlice && !frameOfReference.empty())
+                {
+                        const Vector3 point = drivingSlice->center();
+                        for (auto& state : states)
+                        {
+                                if (&state == driver || !state.index
+                                        || state.index->frameOfReferenceUID() != frameOfReference
+                                        || std::abs(dot(state.index->normal(), driver->index->normal())) < LinkCosine)
+                                {
+                                        continue;
+                                }
+                                if (const auto frame = state.index->nearestFrame(point))
+                                {
+                                        state.targetFrame = *frame;
+                                }
+                        }
+                }
+        }
+
+        // 2. Reference lines from the slices every viewport will show
+        std::vector<QVector<QLineF>> lines(states.size());
+        for (std::size_t target = 0; target < states.size(); ++target)
+        {
+                const auto* targetIndex = states[target].index;
+                const SliceGeometry* targetSlice = targetIndex ? targetIndex->slice(states[target].targetFrame) : nullptr;
+                if (!targetSlice || targetIndex->frameOfReferenceUID().empty())
+                {
+                        continue;
+                }
+                for (std::size_t source = 0; source < states.size(); ++source)
+                {
+                        const auto* sourceIndex = states[source].index;
+                        if (source == target || !sourceIndex
+                                || sourceIndex->frameOfReferenceUID() != targetIndex->frameOfReferenceUID())
+                        {
+                                continue;
+                        }
+                        const SliceGeometry* sourceSlice = sourceIndex->slice(states[source].targetFrame);
+                        if (!sourceSlice)
+                        {
+                                continue;
+                        }
+                        if (const auto segment = referenceLine(*targetSlice, *sourceSlice))
+                        {
+                                lines[target].append(QLineF((*segment)[0], (*segment)[1], (*segment)[2], (*segment)[3]));
+                        }
+                }
+        }
+
+        // 3. One render per viewport: a frame change repaints the lines with it
+        m_applying = true;
+        for (std::size_t i = 0; i < states.size(); ++i)
+        {
+                auto* widget = states[i].widget;
+                const bool frameChanged = states[i].targetFrame != states[i].currentFrame;
+                widget->setReferenceLines(lines[i], !frameChanged);
+                if (frameChanged)
+                {
+                        widget->showFrame(states[i].targetFrame);
+                }
+        }
+        m_applying = false;
+}
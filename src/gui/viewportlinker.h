@@ -0,0 +1,95 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: viewportlinker.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Optional linking of the 2D viewports: scrolling one viewport moves the
+ *      others showing a series of the same frame of reference to the slice
+ *      nearest in patient space, and each viewport draws the planes of the
+ *      others as reference lines. Changes are coalesced into one update of the
+ *      linked viewports per pass of the event loop.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include <unordered_map>
+#include <vector>
+
+#include "slicepositionindex.h"
+
+namespace isis::core
+{
+        class Series;
+}
+
+namespace isis::gui
+{
+        class Widget2D;
+
+        class ViewportLinker final : public QObject
+        {
+        Q_OBJECT
+        public:
+                explicit ViewportLinker(QObject* parent = nullptr);
+                ~ViewportLinker() override = default;
+
+                // Series whose slice normals differ by more than this are not scrolled together
+                static constexpr double LinkCosine = 0.866;     // 30 degrees
+
+                void setEnabled(bool t_enabled);
+                [[nodiscard]] bool isEnabled() const { return m_enabled; }
+
+                /**
+                 * @brief Viewports taking part in linking (the 2D viewports of the current layout)
+                 */
+                void setViewports(const std::vector<Widget2D*>& t_viewports);
+
+                /**
+                 * @brief Note that a viewport changed slice; the linked viewports follow on the next flush
+                 * @param t_viewport Viewport whose frame changed
+                 * @param t_driving true when the change comes from the user (the active viewport)
+                 */
+                void requestSync(Widget2D* t_viewport, bool t_driving);
+
+                /**
+                 * @brief Forget cached indexes (when the series are closed)
+                 */
+                void clear();
+
+                /**
+                 * @brief Position index of a series (nullptr if its slices have no usable geometry)
+                 */
+                [[nodiscard]] const SlicePositionIndex* indexFor(core::Series* t_series);
+
+        public slots:
+                void flush();
+
+        private:
+                struct CachedIndex
+                {
+                        std::size_t imageCount = 0;
+                        SlicePositionIndex index;
+                };
+
+                [[nodiscard]] static SlicePositionIndex buildIndex(core::Series* t_series);
+                void clearReferenceLines();
+
+                bool m_enabled = false;
+                bool m_applying = false;
+                std::vector<QPointer<Widget2D>> m_viewports = {};
+                QPointer<Widget2D> m_driver = {};
+                QTimer m_flushTimer = {};
+                std::unordered_map<const core::Series*, CachedIndex> m_indexes = {};
+        };
+}
@@ -180,7 +180,8 @@ void isis::gui::vtkWidget2DInteractorStyle::changeImage(int& t_index)
 		{
 			m_image = m_series->getSingleFrameImageByIndex(t_index);
 			refreshImage();
-			if (m_image->getModality() == "MR")
+			// Gzip'd images carry no window until their volume is decoded
+			if (m_image->getModality() == "MR" && m_image->getWindowWidth() > 0)
 			{
 				m_widget2D->updateOverlayWindowLevelApply(m_image->getWindowWidth(),
 					m_image->getWindowCenter(), false);
@@ -56,11 +56,17 @@
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkDataSetAttributes.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QByteArray>
 #include <QString>
+#include "utils/structuredlog.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
@@ -69,6 +75,8 @@ Q_LOGGING_CATEGORY(lcVtkWidget3D, "isis.gui.vtkwidget3d")
 namespace
 {
         constexpr double uniformRangeThreshold = 1e-5;
+        // Crops larger than this keep every n-th voxel so the mapper stays within budget
+        constexpr double maxCropVoxels = 256.0 * 1024.0 * 1024.0;
 
         struct GhostArrayInfo
         {
@@ -376,6 +384,7 @@ void isis::gui::vtkWidget3D::initBoxWidgetCallback()
 	m_boxWidgetCallback = vtkSmartPointer<vtkBoxWidget3DCallback>::New();
 	m_boxWidgetCallback->setVolume(m_volume);
 	m_boxWidget->AddObserver(vtkCommand::InteractionEvent, m_boxWidgetCallback);
+	m_boxWidget->AddObserver(vtkCommand::EndInteractionEvent, this, &vtkWidget3D::onBoxInteractionEnded);
 }
 
 //-----------------------------------------------------------------------------
@@ -724,6 +733,9 @@ bool isis::gui::vtkWidget3D::composeAndRenderVolume(const std::shared_ptr<VtkDic
 		m_volumeData.reset();
 		return false;
 	}
+	resetCrop();
+	m_fullStructure = vtkSmartPointer<vtkImageData>::New();
+	m_fullStructure->CopyStructure(m_volumeData->ImageData);
 	m_mapper->SetInputData(m_volumeData->ImageData);
 	applyWindowLevelToTransferFunction(window, level);
 	m_volume->SetMapper(m_mapper);
@@ -913,6 +925,188 @@ void isis::gui::vtkWidget3D::activateBoxWidget(const bool& t_flag)
 	m_boxWidget->SetEnabled(t_flag);
 }
 
+//-----------------------------------------------------------------------------
+bool isis::gui::vtkWidget3D::isCroppedTo(const int t_extent[6], const int t_stride) const
+{
+	if (!m_isCropped)
+	{
+		// Nothing to do for a box around the whole volume
+		return isFullExtent(t_extent, t_stride);
+	}
+	return t_stride == m_cropStride && std::equal(t_extent, t_extent + 6, m_cropExtent);
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::vtkWidget3D::isFullExtent(const int t_extent[6], const int t_stride) const
+{
+	int fullExtent[6] = {0, -1, 0, -1, 0, -1};
+	if (m_fullStructure)
+	{
+		m_fullStructure->GetExtent(fullExtent);
+	}
+	return t_stride == 1 && std::equal(t_extent, t_extent + 6, fullExtent);
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::vtkWidget3D::cropRegion(int t_extent[6], int& t_stride) const
+{
+	auto* const representation = m_boxWidget
+		? vtkBoxRepresentation::SafeDownCast(m_boxWidget->GetRepresentation())
+		: nullptr;
+	if (!representation || !m_fullStructure || !m_volume)
+	{
+		return false;
+	}
+
+	// The first eight points are the box corners in world coordinates
+	vtkNew<vtkPolyData> box;
+	representation->GetPolyData(box);
+	if (!box->GetPoints() || box->GetNumberOfPoints() < 8)
+	{
+		return false;
+	}
+	vtkNew<vtkMatrix4x4> worldToVolume;
+	vtkMatrix4x4::Invert(m_volume->GetMatrix(), worldToVolume);
+	double bounds[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	for (vtkIdType corner = 0; corner < 8; ++corner)
+	{
+		const double* const world = box->GetPoints()->GetPoint(corner);
+		const double point[4] = {world[0], world[1], world[2], 1.0};
+		double local[4] = {0.0, 0.0, 0.0, 1.0};
+		worldToVolume->MultiplyPoint(point, local);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			bounds[2 * axis] = corner == 0 ? local[axis] : std::min(bounds[2 * axis], local[axis]);
+			bounds[2 * axis + 1] = corner == 0 ? local[axis] : std::max(bounds[2 * axis + 1], local[axis]);
+		}
+	}
+	if (!core::SubVolumeExtractor::extentFromBounds(m_fullStructure, bounds, t_extent))
+	{
+		return false;
+	}
+
+	// Volume rendering needs at least two voxels along every axis
+	int fullExtent[6] = {0, -1, 0, -1, 0, -1};
+	m_fullStructure->GetExtent(fullExtent);
+	double voxels = 1.0;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (t_extent[2 * axis] == t_extent[2 * axis + 1])
+		{
+			if (t_extent[2 * axis + 1] < fullExtent[2 * axis + 1])
+			{
+				++t_extent[2 * axis + 1];
+			}
+			else if (t_extent[2 * axis] > fullExtent[2 * axis])
+			{
+				--t_extent[2 * axis];
+			}
+		}
+		voxels *= t_extent[2 * axis + 1] - t_extent[2 * axis] + 1;
+	}
+	t_stride = std::max(1, static_cast<int>(std::ceil(std::cbrt(voxels / maxCropVoxels))));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<isis::gui::VtkDicomVolume> isis::gui::vtkWidget3D::extractCrop(
+	const std::shared_ptr<VtkDicomVolume>& t_current,
+	const int t_extent[6],
+	const int t_stride,
+	QString* failureReason)
+{
+	if (!t_current)
+	{
+		return nullptr;
+	}
+	QElapsedTimer timer;
+	timer.start();
+
+	// A box inside the last crop is copied from it; anything else needs the full
+	// volume, which stays in the volume cache while the view shows the crop
+	std::shared_ptr<VtkDicomVolume> full;
+	if (!m_cropExtractor.canReuseLast(t_extent, t_stride))
+	{
+		full = acquireVolume(failureReason);
+		if (!full || !full->ImageData)
+		{
+			return nullptr;
+		}
+	}
+	if (full)
+	{
+		core::utils::telemetry().recordDuration("crop.acquire_volume", std::chrono::milliseconds(timer.elapsed()));
+	}
+	auto image = m_cropExtractor.extract(full ? full->ImageData.GetPointer() : nullptr, t_extent, t_stride);
+	if (!image)
+	{
+		if (failureReason)
+		{
+			*failureReason = QStringLiteral("Crop box does not match the volume extent.");
+		}
+		return nullptr;
+	}
+
+	auto cropped = std::make_shared<VtkDicomVolume>(*t_current);
+	cropped->ImageData = image;
+	core::utils::telemetry().increment(m_cropExtractor.lastWasIncremental() ? "crop.incremental" : "crop.full");
+	core::utils::telemetry().recordDuration("crop.extract", std::chrono::milliseconds(timer.elapsed()));
+	return cropped;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::vtkWidget3D::applyCrop(const std::shared_ptr<VtkDicomVolume>& t_volume,
+	const int t_extent[6],
+	const int t_stride)
+{
+	if (!t_volume || !t_volume->ImageData)
+	{
+		return;
+	}
+	m_volumeData = t_volume;
+	m_mapper->SetInputData(m_volumeData->ImageData);
+	std::copy(t_extent, t_extent + 6, m_cropExtent);
+	m_cropStride = t_stride;
+	m_isCropped = true;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::vtkWidget3D::restoreFullVolume(const std::shared_ptr<VtkDicomVolume>& t_volume)
+{
+	if (!t_volume || !t_volume->ImageData)
+	{
+		return false;
+	}
+	m_volumeData = t_volume;
+	m_mapper->SetInputData(m_volumeData->ImageData);
+	resetCrop();
+	syncBoxWidgetWithVolume();
+	qCInfo(lcVtkWidget3D) << "Crop undone, full volume restored";
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::vtkWidget3D::resetCrop()
+{
+	m_cropExtractor.reset();
+	m_isCropped = false;
+	m_cropStride = 1;
+	if (m_mapper)
+	{
+		m_mapper->RemoveAllClippingPlanes();
+	}
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::vtkWidget3D::onBoxInteractionEnded([[maybe_unused]] vtkObject* caller,
+	[[maybe_unused]] unsigned long eventId, [[maybe_unused]] void* callData)
+{
+	if (m_cropChanged)
+	{
+		m_cropChanged();
+	}
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::vtkWidget3D::updateFilter() const
 {
@@ -38,6 +38,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <QString>
 #include <string>
@@ -51,6 +52,7 @@
 #include "vtkwidget3dinteractorstyle.h"
 #include "vtkwidgetbase.h"
 #include "vtkdicomvolumeloader.h"
+#include "subvolumeextractor.h"
 
 namespace isis::gui
 {
@@ -77,6 +79,18 @@ namespace isis::gui
 		void activateBoxWidget(const bool& t_flag);
 		void updateFilter() const;
 
+		//crop
+		[[nodiscard]] bool isCropped() const { return m_isCropped; }
+		[[nodiscard]] bool isCroppedTo(const int t_extent[6], int t_stride) const;
+		[[nodiscard]] bool isFullExtent(const int t_extent[6], int t_stride) const;
+		[[nodiscard]] std::shared_ptr<VtkDicomVolume> currentVolume() const { return m_volumeData; }
+		void setCropChangedCallback(std::function<void()> t_callback) { m_cropChanged = std::move(t_callback); }
+		[[nodiscard]] bool cropRegion(int t_extent[6], int& t_stride) const;
+		[[nodiscard]] std::shared_ptr<VtkDicomVolume> extractCrop(const std::shared_ptr<VtkDicomVolume>& t_current,
+			const int t_extent[6], int t_stride, QString* failureReason);
+		void applyCrop(const std::shared_ptr<VtkDicomVolume>& t_volume, const int t_extent[6], int t_stride);
+		bool restoreFullVolume(const std::shared_ptr<VtkDicomVolume>& t_volume);
+
 	private:
 		std::unique_ptr<TransferFunction> m_transferFunction = {};
 		vtkSmartPointer<vtkWidget3DInteractorStyle> m_interactorStyle = {};
@@ -89,6 +103,12 @@ namespace isis::gui
         std::shared_ptr<VtkDicomVolume> m_volumeData = {};
         VtkDicomVolumeLoader m_volumeLoader = {};
 		std::unordered_map<std::string, TransferFunction::Preset> m_seriesPresetCache = {};
+		core::SubVolumeExtractor m_cropExtractor = {};
+		vtkSmartPointer<vtkImageData> m_fullStructure = {};
+		int m_cropExtent[6] = {0, -1, 0, -1, 0, -1};
+		int m_cropStride = 1;
+		bool m_isCropped = false;
+		std::function<void()> m_cropChanged = {};
 
 		void initWidget();
 		void initBoxWidget();
@@ -99,6 +119,8 @@ namespace isis::gui
 		[[nodiscard]] std::tuple<int, int> getWindowLevel(const std::shared_ptr<VtkDicomVolume>& volume) const;
 		void applyWindowLevelToTransferFunction(int window, int level);
 		void syncBoxWidgetWithVolume();
+		void resetCrop();
+		void onBoxInteractionEnded(vtkObject* caller, unsigned long eventId, void* callData);
 		std::string seriesCacheKey() const;
 		TransferFunction::Preset cachedPresetForSeries() const;
 		void rememberPresetForSeries(TransferFunction::Preset preset);
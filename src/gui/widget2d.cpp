@@ -888,6 +888,39 @@ void isis::gui::Widget2D::adjustFrameByStep(const int t_step)
         applyLoadedFrame(targetIndex);
 }
 
+void isis::gui::Widget2D::showFrame(const int t_frameIndex)
+{
+        if (!m_renderingActive || !m_imagePresenter)
+        {
+                return;
+        }
+        const int frameCount = std::max<int>(m_imagePresenter->frameCount(), 0);
+        if (frameCount <= 0)
+        {
+                return;
+        }
+        const int targetIndex = std::clamp(t_frameIndex, 0, frameCount - 1);
+        if (m_scroll)
+        {
+                const QSignalBlocker blocker(m_scroll);
+                m_scroll->setValue(targetIndex);
+        }
+        applyLoadedFrame(targetIndex);
+}
+
+void isis::gui::Widget2D::setReferenceLines(const QVector<QLineF>& t_lines, const bool t_refresh)
+{
+        if (m_referenceLines == t_lines)
+        {
+                return;
+        }
+        m_referenceLines = t_lines;
+        if (t_refresh && m_renderingActive)
+        {
+                refreshDisplayedFrame(false);
+        }
+}
+
 void isis::gui::Widget2D::applyWindowPreset(const double center, const double width)
 {
         if (!m_imagePresenter)
@@ -1158,6 +1191,8 @@ void isis::gui::Widget2D::resetView()
         m_renderingActive = false;
         m_currentFrameIndex = 0;
         m_cachedFrame = {};
+        m_referenceLines.clear();
+        m_pendingPresentation.reset();
         m_displayZoomFactor = 1.0;
         m_manualZoomFactor = 1.0;
         m_fitToWindowEnabled = false;
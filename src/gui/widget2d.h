@@ -42,6 +42,7 @@
 #include <QElapsedTimer>
 #include <QImage>
 #include <QLabel>
+#include <QLineF>
 #include <QPointer>
 #include <QResizeEvent>
 #include <QPoint>
@@ -151,6 +152,41 @@ namespace isis::gui
 
                 void setActiveTool(InteractionTool t_tool);
 
+                /**
+                 * Image shown for a frame index: the single-frame instance of that
+                 * slice, or the multi-frame instance the frame belongs to.
+                 */
+                [[nodiscard]] const core::Image* getFrameImage(int t_frameIndex) const
+                {
+                        return orientationSourceImage(t_frameIndex);
+                }
+
+                [[nodiscard]] int getCurrentFrameIndex() const { return m_currentFrameIndex; }
+                [[nodiscard]] std::shared_ptr<Widget2DImagePresenter> getImagePresenter() const { return m_imagePresenter; }
+
+                /**
+                 * Move to a frame without going through the scroll bar signals
+                 * (used by viewport linking).
+                 */
+                void showFrame(int t_frameIndex);
+
+                /**
+                 * Planes of other viewports crossing this image, in pixel
+                 * coordinates of the stored (untransformed) frame.
+                 */
+                void setReferenceLines(const QVector<QLineF>& t_lines, bool t_refresh);
+                [[nodiscard]] const QVector<QLineF>& getReferenceLines() const { return m_referenceLines; }
+
+                /**
+                 * Window and orientation to apply once the next series is loaded
+                 * (used by hanging protocols). A window width of 0 keeps the
+                 * window of the series; InvertColors toggles its photometric default.
+                 */
+                void setInitialPresentation(const Widget2dPresentationState& t_state)
+                {
+                        m_pendingPresentation = t_state;
+                }
+
                 void render() override;
                 void forceFrameMetricsUpdate();
                 void applyWindowPreset(double center, double width);
@@ -221,6 +257,8 @@ namespace isis::gui
                 CursorInfo m_lastCursorInfo = {};
                 bool m_hasCursorInfo = false;
                 QVector<WindowPreset> m_availableWindowPresets = {};
+                QVector<QLineF> m_referenceLines = {};
+                std::optional<Widget2dPresentationState> m_pendingPresentation = {};
 
                 void initView() override;
                 void initData() override;
@@ -2,6 +2,9 @@
 
 #include "widget2dframebuilder.h"
 
+#include "compressedimagedata.h"
+#include "dicomframesource.h"
+
 #include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QMutexLocker>
@@ -39,6 +42,16 @@ void Widget2DFrameCache::setVolume(const std::shared_ptr<const isis::core::Dicom
         m_volume = volume;
 }
 
+void Widget2DFrameCache::setFrameSource(const std::shared_ptr<const isis::core::DicomFrameSource>& source,
+        const std::size_t byteBudget)
+{
+        QMutexLocker locker(&m_cacheMutex);
+        m_frameSource = source;
+        m_byteBudget = byteBudget;
+        m_resident.clear();
+        m_residentIndex.clear();
+}
+
 void Widget2DFrameCache::ensureFrameCached(Widget2DImageFrame& frame)
 {
         const bool debugLoggingEnabled = Q_UNLIKELY(lcWidget2D().isDebugEnabled());
@@ -82,24 +95,34 @@ void Widget2DFrameCache::ensureFrameCached(Widget2DImageFrame& frame)
                 volumePixelInfo = volume->PixelInfo;
                 volumePixelInfoValid = true;
         }
+        const auto frameSource = m_frameSource;
         m_cacheMutex.unlock();
 
-        if (!volume || !volume->ImageData)
+        if (frameSource)
+        {
+                cacheFromSource(frame, *frameSource, frameIndex);
+                return;
+        }
+
+        // A volume holding compressed slices is decoded one frame at a time; it is never changed in place
+        const auto compressed = volume ? volume->CompressedScalars : nullptr;
+        if (!volume || (!volume->ImageData && !compressed))
         {
                 throw std::runtime_error("No DICOM volume available for frame caching.");
         }
 
-        auto* imageData = volume->ImageData.GetPointer();
+        auto* imageData = compressed ? nullptr : volume->ImageData.GetPointer();
         auto* pointData = imageData ? imageData->GetPointData() : nullptr;
         auto* scalars = pointData ? pointData->GetScalars() : nullptr;
-        if (!scalars)
+        if (!scalars && !compressed)
         {
                 throw std::runtime_error("Volume scalar data is unavailable.");
         }
 
-        const int width = frame.Width > 0 ? frame.Width : imageData->GetDimensions()[0];
-        const int height = frame.Height > 0 ? frame.Height : imageData->GetDimensions()[1];
-        const int components = std::max(frame.SamplesPerPixel, scalars->GetNumberOfComponents());
+        const int width = frame.Width > 0 ? frame.Width : (compressed ? compressed->width() : imageData->GetDimensions()[0]);
+        const int height = frame.Height > 0 ? frame.Height : (compressed ? compressed->height() : imageData->GetDimensions()[1]);
+        const int components = std::max(frame.SamplesPerPixel,
+                compressed ? compressed->components() : scalars->GetNumberOfComponents());
         const std::size_t bytesPerValue = Widget2DFrameBuilder::bytesPerSample(frame.ScalarType);
         if (bytesPerValue == 0)
         {
@@ -115,21 +138,30 @@ void Widget2DFrameCache::ensureFrameCached(Widget2DImageFrame& frame)
                 throw std::runtime_error("Frame data exceeds supported size.");
         }
 
-        const unsigned char* const dataBegin = static_cast<const unsigned char*>(scalars->GetVoidPointer(0));
-        if (!dataBegin)
+        const unsigned char* const dataBegin = scalars ? static_cast<const unsigned char*>(scalars->GetVoidPointer(0)) : nullptr;
+        if (!dataBegin && !compressed)
         {
                 throw std::runtime_error("Unable to access GDCM pixel buffer.");
         }
 
-        const vtkIdType tupleCount = scalars->GetNumberOfTuples();
-        const std::size_t totalByteCount = static_cast<std::size_t>(tupleCount)
-                * static_cast<std::size_t>(scalars->GetNumberOfComponents())
-                * static_cast<std::size_t>(scalars->GetDataTypeSize());
-
         const std::size_t offset = static_cast<std::size_t>(frameIndex) * frameByteCount;
-        if (offset + frameByteCount > totalByteCount)
+        if (compressed)
+        {
+                if (frameByteCount != compressed->sliceBytes() || frameIndex >= compressed->sliceCount())
+                {
+                        throw std::runtime_error("Requested frame index exceeds available scalar data.");
+                }
+        }
+        else
         {
-                throw std::runtime_error("Requested frame index exceeds available scalar data.");
+                const vtkIdType tupleCount = scalars->GetNumberOfTuples();
+                const std::size_t totalByteCount = static_cast<std::size_t>(tupleCount)
+                        * static_cast<std::size_t>(scalars->GetNumberOfComponents())
+                        * static_cast<std::size_t>(scalars->GetDataTypeSize());
+                if (offset + frameByteCount > totalByteCount)
+                {
+                        throw std::runtime_error("Requested frame index exceeds available scalar data.");
+                }
         }
 
         QElapsedTimer decodeTimer;
@@ -145,9 +177,16 @@ void Widget2DFrameCache::ensureFrameCached(Widget2DImageFrame& frame)
         try
         {
                 QByteArray frameBuffer(static_cast<int>(frameByteCount), Qt::Uninitialized);
-                std::memcpy(frameBuffer.data(),
-                        dataBegin + offset,
-                        frameByteCount);
+                if (!compressed)
+                {
+                        std::memcpy(frameBuffer.data(),
+                                dataBegin + offset,
+                                frameByteCount);
+                }
+                else if (!compressed->decompressSlice(frameIndex, frameBuffer.data()))
+                {
+                        throw std::runtime_error("Unable to decode the compressed frame.");
+                }
                 decodeDuration = decodeTimer.elapsed();
                 frameBytes = static_cast<std::size_t>(frameBuffer.size());
 
@@ -233,14 +272,123 @@ void Widget2DFrameCache::ensureFrameCached(Widget2DImageFrame& frame)
         }
 }
 
+Widget2DImageFrame Widget2DFrameCache::acquireFrame(Widget2DImageFrame& frame)
+{
+        // A frame decoded from a frame source may be released by another thread before it is copied
+        constexpr int maxAttempts = 3;
+        for (int attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+                ensureFrameCached(frame);
+                QMutexLocker locker(&m_cacheMutex);
+                if (frame.Cached)
+                {
+                        if (m_frameSource)
+                        {
+                                markRecentlyUsed(&frame);
+                        }
+                        return frame;
+                }
+        }
+        throw std::runtime_error("Frame was released before it could be used.");
+}
+
+void Widget2DFrameCache::cacheFromSource(Widget2DImageFrame& frame,
+        const isis::core::DicomFrameSource& source,
+        const int frameIndex)
+{
+        QElapsedTimer decodeTimer;
+        decodeTimer.start();
+
+        QByteArray frameBuffer;
+        isis::core::DicomPixelInfo pixelInfo = {};
+        try
+        {
+                const std::size_t frameByteCount = source.frameByteCount();
+                if (frameByteCount > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+                {
+                        throw std::runtime_error("Frame data exceeds supported size.");
+                }
+                frameBuffer = QByteArray(static_cast<int>(frameByteCount), Qt::Uninitialized);
+                source.readFrame(frameIndex, frameBuffer.data());
+                pixelInfo = source.pixelInfo(frameIndex);
+        }
+        catch (...)
+        {
+                m_cacheMutex.lock();
+                frame.Decoding = false;
+                m_decodeWait.wakeAll();
+                m_cacheMutex.unlock();
+                throw;
+        }
+        const qint64 decodeDuration = decodeTimer.elapsed();
+
+        QMutexLocker locker(&m_cacheMutex);
+        // Rescale and window come from the frame's own functional groups
+        frame.PixelInfo = pixelInfo;
+        frame.PixelInfo.SamplesPerPixel = 1;
+        frame.Width = source.width();
+        frame.Height = source.height();
+        frame.SamplesPerPixel = 1;
+        frame.Data = std::move(frameBuffer);
+        Widget2DFrameBuilder::calculateDefaultVOIWindow(frame);
+        frame.Cached = true;
+        frame.Decoding = false;
+        m_totalFrameBytes += static_cast<std::size_t>(frame.Data.size());
+        m_decodingDurationMs += decodeDuration;
+        markRecentlyUsed(&frame);
+        releaseOverBudget(&frame);
+        m_decodeWait.wakeAll();
+}
+
+void Widget2DFrameCache::markRecentlyUsed(Widget2DImageFrame* frame)
+{
+        const auto it = m_residentIndex.find(frame);
+        if (it != m_residentIndex.end())
+        {
+                m_resident.splice(m_resident.end(), m_resident, it->second);
+                return;
+        }
+        m_residentIndex.emplace(frame, m_resident.insert(m_resident.end(), frame));
+}
+
+void Widget2DFrameCache::releaseOverBudget(const Widget2DImageFrame* keep)
+{
+        auto it = m_resident.begin();
+        while (m_totalFrameBytes > m_byteBudget && it != m_resident.end())
+        {
+                Widget2DImageFrame* const candidate = *it;
+                if (candidate == keep || candidate->Decoding)
+                {
+                        ++it;
+                        continue;
+                }
+                // Renderers work on copies, so the pixels stay valid for them
+                m_totalFrameBytes -= std::min(m_totalFrameBytes, static_cast<std::size_t>(candidate->Data.size()));
+                candidate->Data = QByteArray();
+                candidate->Cached = false;
+                m_residentIndex.erase(candidate);
+                it = m_resident.erase(it);
+        }
+}
+
 void Widget2DFrameCache::prefetchAllFrames(QVector<Widget2DImageFrame>& frames)
 {
         QVector<Widget2DImageFrame*> framesToDecode;
         framesToDecode.reserve(frames.size());
 
         m_cacheMutex.lock();
-        for (Widget2DImageFrame& frame : frames)
+        // With a frame source only the leading frames that fit in half the budget are decoded
+        // ahead; the others are decoded when shown
+        int prefetchLimit = frames.size();
+        if (m_frameSource)
+        {
+                const std::size_t frameBytes = std::max<std::size_t>(m_frameSource->frameByteCount(), 1);
+                prefetchLimit = static_cast<int>(std::min<std::size_t>(
+                        static_cast<std::size_t>(frames.size()), m_byteBudget / 2 / frameBytes));
+        }
+        for (int index = 0; index < prefetchLimit; ++index)
         {
+                Widget2DImageFrame& frame = frames[index];
                 while (frame.Decoding)
                 {
                         m_decodeWait.wait(&m_cacheMutex);
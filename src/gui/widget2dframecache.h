@@ -12,7 +12,9 @@
 #pragma once
 
 #include <cstddef>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <QtGlobal>
 
 #include <QMutex>
@@ -21,6 +23,11 @@
 
 #include "widget2dimageframe.h"
 
+namespace isis::core
+{
+        class DicomFrameSource;
+}
+
 namespace isis::gui
 {
 	class Widget2DFrameCache
@@ -31,7 +38,20 @@ namespace isis::gui
 			qint64& decodingDurationMs);
 
                 void setVolume(const std::shared_ptr<const isis::core::DicomVolume>& volume);
+                /**
+                 * @brief Decode frames one at a time from a multi-frame file instead of the volume
+                 *
+                 * Decoded frames are kept up to byteBudget bytes; the least recently used
+                 * ones are released beyond it. Must be set again whenever the frames passed
+                 * to the cache are rebuilt.
+                 */
+                void setFrameSource(const std::shared_ptr<const isis::core::DicomFrameSource>& source,
+                        std::size_t byteBudget);
 		void ensureFrameCached(Widget2DImageFrame& frame);
+                /**
+                 * @brief Cached copy of a frame, safe to read while other frames are released
+                 */
+                Widget2DImageFrame acquireFrame(Widget2DImageFrame& frame);
 		void prefetchAllFrames(QVector<Widget2DImageFrame>& frames);
 
         private:
@@ -40,5 +60,15 @@ namespace isis::gui
                 qint64& m_decodingDurationMs;
                 QWaitCondition m_decodeWait;
                 std::weak_ptr<const isis::core::DicomVolume> m_volume;
+                std::shared_ptr<const isis::core::DicomFrameSource> m_frameSource;
+                std::size_t m_byteBudget = 0;
+                std::list<Widget2DImageFrame*> m_resident;
+                std::unordered_map<Widget2DImageFrame*, std::list<Widget2DImageFrame*>::iterator> m_residentIndex;
+
+                void cacheFromSource(Widget2DImageFrame& frame,
+                        const isis::core::DicomFrameSource& source,
+                        int frameIndex);
+                void markRecentlyUsed(Widget2DImageFrame* frame);
+                void releaseOverBudget(const Widget2DImageFrame* keep);
 	};
 }
@@ -8,8 +8,10 @@
 #include <QReadLocker>
 #include <QWriteLocker>
 
+#include "dicomframesource.h"
 #include "image.h"
 #include "series.h"
+#include "utils/structuredlog.h"
 #include "widget2dframebuilder.h"
 
 #include <vtkDataArray.h>
@@ -24,6 +26,22 @@ namespace
 {
         using isis::gui::Widget2DScalarType;
 
+        // Decoded frames kept per multi-frame object read frame by frame
+        constexpr std::size_t kFrameSourceCacheBytes = 256ull * 1024ull * 1024ull;
+
+        Widget2DScalarType frameSourceScalarType(const isis::core::DicomFrameSource& source)
+        {
+                switch (source.bitsAllocated())
+                {
+                case 8:
+                        return source.isSigned() ? Widget2DScalarType::Sint8 : Widget2DScalarType::Uint8;
+                case 32:
+                        return source.isSigned() ? Widget2DScalarType::Sint32 : Widget2DScalarType::Uint32;
+                default:
+                        return source.isSigned() ? Widget2DScalarType::Sint16 : Widget2DScalarType::Uint16;
+                }
+        }
+
         Widget2DScalarType mapVtkScalarTypeToWidgetScalar(const vtkDataArray* scalars)
         {
                 if (!scalars)
@@ -66,7 +84,7 @@ namespace isis::gui
         bool Widget2DImagePresenter::isValid() const
         {
         QReadLocker locker(&m_stateLock);
-        return !m_frames.isEmpty() && m_volume && m_volume->ImageData;
+        return !m_frames.isEmpty() && m_volume && (m_volume->ImageData || m_frameSource);
         }
 
         int Widget2DImagePresenter::frameCount() const
@@ -90,7 +108,14 @@ namespace isis::gui
                         return presenter;
                 }
 
-                presenter->rebuildFramesFromVolume(true);
+                if (presenter->m_frameSource)
+                {
+                        presenter->rebuildFramesFromSource(true);
+                }
+                else
+                {
+                        presenter->rebuildFramesFromVolume(true);
+                }
                 return presenter;
         }
 
@@ -107,6 +132,12 @@ namespace isis::gui
                 return loadVolumeForSeries(series);
         }
 
+        // Large enhanced objects: show the first frame without decoding the others
+        if (loadFrameSourceForImage(image))
+        {
+                return true;
+        }
+
         QString failureReason;
         auto volume = image->getDicomVolume(&failureReason);
         if (!volume || !volume->ImageData)
@@ -127,6 +158,33 @@ namespace isis::gui
         return true;
 }
 
+bool Widget2DImagePresenter::loadFrameSourceForImage(core::Image* image)
+{
+        std::shared_ptr<core::DicomFrameSource> source;
+        try
+        {
+                source = core::DicomFrameSource::open(image->getImagePath());
+        }
+        catch (const std::exception& ex)
+        {
+                qCWarning(lcWidget2D)
+                        << "Failed to read frames of"
+                        << QString::fromStdString(image->getImagePath())
+                        << "one at a time:" << ex.what();
+        }
+        if (!source || source->frameCount() == 0)
+        {
+                return false;
+        }
+
+        QWriteLocker locker(&m_stateLock);
+        m_volume = source->header();
+        m_frameSource = std::move(source);
+        m_usesSeriesVolume = false;
+        m_frameCache.setVolume(m_volume);
+        return true;
+}
+
 bool Widget2DImagePresenter::loadVolumeForSeries(core::Series* series)
         {
                 if (!series)
@@ -229,8 +287,74 @@ bool Widget2DImagePresenter::rebuildFramesFromVolume(const bool resetInitialStat
         m_frames = std::move(frames);
         recalculateFrameTelemetry();
 
-        if (resetInitialState && !m_frames.isEmpty())
+        if (resetInitialState)
+        {
+                primeInitialState();
+        }
+
+        return !m_frames.isEmpty();
+        }
+
+        bool Widget2DImagePresenter::rebuildFramesFromSource(const bool resetInitialState)
+        {
+                QWriteLocker locker(&m_stateLock);
+                if (!m_frameSource)
+                {
+                        m_frames.clear();
+                        m_slicePaths.clear();
+                        return false;
+                }
+
+                if (resetInitialState)
+                {
+                        m_initialState = {};
+                }
+
+                // Same display order as the volume path (last frame first), with frames sorted
+                // by their per-frame position rather than by file order
+                const std::vector<int> order = m_frameSource->spatialOrder();
+                const int frameCount = static_cast<int>(order.size());
+                const Widget2DScalarType scalarType = frameSourceScalarType(*m_frameSource);
+                Widget2DFrameBuilder frameBuilder(m_initialState);
+                QVector<FrameBuffer> frames;
+                frames.reserve(frameCount);
+                m_slicePaths.clear();
+                m_slicePaths.reserve(static_cast<std::size_t>(frameCount));
+                for (int displayIndex = 0; displayIndex < frameCount; ++displayIndex)
+                {
+                        const int sourceIndex = order[static_cast<std::size_t>(frameCount - 1 - displayIndex)];
+                        FrameBuffer buffer = frameBuilder.createFrame(m_frameSource->pixelInfo(sourceIndex),
+                                m_frameSource->width(),
+                                m_frameSource->height(),
+                                1,
+                                scalarType,
+                                sourceIndex,
+                                displayIndex == 0);
+                        buffer.SourcePath = std::to_string(sourceIndex);
+                        frames.append(std::move(buffer));
+                        m_slicePaths.emplace_back(std::to_string(sourceIndex));
+                }
+
+                m_frames = std::move(frames);
+                m_frameCache.setFrameSource(m_frameSource, kFrameSourceCacheBytes);
+                recalculateFrameTelemetry();
+
+                if (resetInitialState)
+                {
+                        primeInitialState();
+                }
+
+                core::utils::telemetry().increment("presenter.frames_on_demand");
+                return !m_frames.isEmpty();
+        }
+
+        void Widget2DImagePresenter::primeInitialState()
         {
+                if (m_frames.isEmpty())
+                {
+                        return;
+                }
+
                 try
                 {
                         m_frameCache.ensureFrameCached(m_frames[0]);
@@ -252,9 +376,6 @@ bool Widget2DImagePresenter::rebuildFramesFromVolume(const bool resetInitialStat
                 }
         }
 
-        return !m_frames.isEmpty();
-        }
-
         Widget2DImagePresenter::FrameBuffer Widget2DImagePresenter::createFrameBuffer(
                 const int frameIndex,
                 const int width,
@@ -461,10 +582,10 @@ bool Widget2DImagePresenter::rebuildFramesFromVolume(const bool resetInitialStat
                         return {};
                 }
 
-                FrameBuffer& frame = m_frames[frameIndex];
+                FrameBuffer frame;
                 try
                 {
-                        m_frameCache.ensureFrameCached(frame);
+                        frame = m_frameCache.acquireFrame(m_frames[frameIndex]);
                 }
                 catch (const std::exception& ex)
                 {
@@ -491,21 +612,21 @@ bool Widget2DImagePresenter::sampleValue(const int frameIndex, const int x, cons
                 return false;
         }
 
-        FrameBuffer& frame = m_frames[frameIndex];
-        if (x < 0 || y < 0 || x >= frame.Width || y >= frame.Height)
-        {
-                return false;
-        }
-
+        FrameBuffer frame;
         try
         {
-                m_frameCache.ensureFrameCached(frame);
+                frame = m_frameCache.acquireFrame(m_frames[frameIndex]);
         }
         catch (...)
         {
                 return false;
         }
 
+        if (x < 0 || y < 0 || x >= frame.Width || y >= frame.Height)
+        {
+                return false;
+        }
+
         if (frame.Data.isEmpty())
         {
                 return false;
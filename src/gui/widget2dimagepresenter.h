@@ -31,6 +31,7 @@ namespace isis::core
 {
         class Series;
         class Image;
+        class DicomFrameSource;
         struct DicomVolume;
 }
 
@@ -75,6 +76,7 @@ namespace isis::gui
                 Widget2dPresentationState m_initialState = {};
                 QVector<FrameBuffer> m_frames = {};
                 std::shared_ptr<const core::DicomVolume> m_volume = {};
+                std::shared_ptr<const core::DicomFrameSource> m_frameSource = {};
                 std::size_t m_totalFrameBytes = 0;
                 qint64 m_decodingDurationMs = 0;
                 mutable QMutex m_cacheMutex = {};
@@ -86,7 +88,10 @@ namespace isis::gui
 
                 bool loadVolumeForImage(core::Series* series, core::Image* image);
                 bool loadVolumeForSeries(core::Series* series);
+                bool loadFrameSourceForImage(core::Image* image);
                 bool rebuildFramesFromVolume(bool resetInitialState);
+                bool rebuildFramesFromSource(bool resetInitialState);
+                void primeInitialState();
                 FrameBuffer createFrameBuffer(int frameIndex,
                         int width,
                         int height,
@@ -51,6 +51,7 @@
 #include "widget2d.h"
 #include "widget2doverlayupdater.h"
 #include "widget2dimagepresenter.h"
+#include "widget2dpresenterregistry.h"
 #include "widget2dinteractor.h"
 #include "widget2drenderer.h"
 #include "widget2dstate.h"
@@ -231,6 +232,21 @@ namespace isis::gui
                 m_widget.m_imagePresenter = std::move(presenter);
                 const auto initialState = m_widget.m_imagePresenter->initialState();
                 m_widget.m_state.resetForNewSeries(initialState);
+                if (m_widget.m_pendingPresentation)
+                {
+                        const auto& requested = *m_widget.m_pendingPresentation;
+                        auto& presentation = m_widget.m_state.presentation();
+                        if (requested.WindowWidth > 0.0)
+                        {
+                                presentation.WindowCenter = requested.WindowCenter;
+                                presentation.WindowWidth = requested.WindowWidth;
+                        }
+                        presentation.InvertColors = presentation.InvertColors != requested.InvertColors;
+                        presentation.FlipHorizontal = requested.FlipHorizontal;
+                        presentation.FlipVertical = requested.FlipVertical;
+                        presentation.RotationSteps = requested.RotationSteps;
+                        m_widget.m_pendingPresentation.reset();
+                }
                 m_widget.updateAvailableWindowPresets();
                 const QString seriesUid = m_widget.m_series
                         ? QString::fromStdString(m_widget.m_series->getUID())
@@ -422,8 +438,8 @@ namespace isis::gui
                                 }));
                 }
 
-                m_imageLoadFuture = QtConcurrent::run(&Widget2DImagePresenter::load,
-                        m_widget.m_series,
+                // Viewports showing the same series share one decoded presenter
+                m_imageLoadFuture = Widget2DPresenterRegistry::instance().acquire(m_widget.m_series,
                         m_widget.m_image);
                 m_imageLoadWatcher->setFuture(m_imageLoadFuture);
         }
@@ -0,0 +1,86 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: widget2dpresenterregistry.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Implementation of the presenter registry shared by 2D viewports
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "widget2dpresenterregistry.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "image.h"
+#include "widget2dimagepresenter.h"
+
+isis::gui::Widget2DPresenterRegistry& isis::gui::Widget2DPresenterRegistry::instance()
+{
+        static Widget2DPresenterRegistry registry;
+        return registry;
+}
+
+//-----------------------------------------------------------------------------
+QFuture<isis::gui::Widget2DPresenterRegistry::PresenterPtr> isis::gui::Widget2DPresenterRegistry::acquire(
+        core::Series* t_series, core::Image* t_image)
+{
+        const Key key = {t_series, (t_image && t_image->getIsMultiFrame()) ? t_image : nullptr};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // An empty future counts as canceled: nothing is loading for that entry
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+                it = (it->second.presenter.expired() && it->second.pending.isCanceled() && !(it->first == key))
+                        ? m_entries.erase(it)
+                        : std::next(it);
+        }
+
+        auto& entry = m_entries[key];
+        if (auto presenter = entry.presenter.lock())
+        {
+                ++m_sharedLoads;
+                return QtFuture::makeReadyValueFuture(std::move(presenter));
+        }
+        if (!entry.pending.isCanceled())
+        {
+                ++m_sharedLoads;
+                return entry.pending;
+        }
+
+        // The registry keeps no strong reference once the load is done
+        entry.pending = QtConcurrent::run([this, key, t_series, t_image]() -> PresenterPtr
+        {
+                auto presenter = Widget2DImagePresenter::load(t_series, t_image);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (const auto it = m_entries.find(key); it != m_entries.end())
+                {
+                        if (presenter && presenter->isValid())
+                        {
+                                it->second.presenter = presenter;
+                        }
+                        it->second.pending = {};
+                }
+                return presenter;
+        });
+        return entry.pending;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::Widget2DPresenterRegistry::clear()
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t isis::gui::Widget2DPresenterRegistry::sharedLoads() const
+{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sharedLoads;
+}
@@ -0,0 +1,95 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: widget2dpresenterregistry.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Shares decoded series between 2D viewports. Viewports showing the same
+ *      series (with their own window, zoom and orientation) use one presenter,
+ *      and so one volume and one frame store; a viewport asking while another
+ *      is still decoding waits for the same load instead of starting its own.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <QFuture>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace isis::core
+{
+        class Image;
+        class Series;
+}
+
+namespace isis::gui
+{
+        class Widget2DImagePresenter;
+
+        class Widget2DPresenterRegistry
+        {
+        public:
+                using PresenterPtr = std::shared_ptr<Widget2DImagePresenter>;
+
+                [[nodiscard]] static Widget2DPresenterRegistry& instance();
+
+                /**
+                 * @brief Presenter of a series, loaded in the background unless a viewport already holds it
+                 *
+                 * Single-frame series share one presenter whatever image was
+                 * picked; each multi-frame instance has its own. Presenters are
+                 * kept only while a viewport holds them.
+                 */
+                [[nodiscard]] QFuture<PresenterPtr> acquire(core::Series* t_series, core::Image* t_image);
+
+                /**
+                 * @brief Forget all presenters (when the series are closed)
+                 */
+                void clear();
+
+                [[nodiscard]] std::size_t sharedLoads() const;
+
+        private:
+                struct Key
+                {
+                        const core::Series* series = nullptr;
+                        const core::Image* image = nullptr;
+
+                        bool operator==(const Key& t_other) const
+                        {
+                                return series == t_other.series && image == t_other.image;
+                        }
+                };
+
+                struct KeyHash
+                {
+                        std::size_t operator()(const Key& t_key) const
+                        {
+                                return std::hash<const void*>()(t_key.series) * 31u
+                                        ^ std::hash<const void*>()(t_key.image);
+                        }
+                };
+
+                struct Entry
+                {
+                        std::weak_ptr<Widget2DImagePresenter> presenter;
+                        QFuture<PresenterPtr> pending;
+                };
+
+                Widget2DPresenterRegistry() = default;
+
+                mutable std::mutex m_mutex;
+                std::unordered_map<Key, Entry, KeyHash> m_entries;
+                std::size_t m_sharedLoads = 0;
+        };
+}
@@ -42,6 +42,7 @@
 #include <QLabel>
 #include <QLoggingCategory>
 #include <QPainter>
+#include <QPen>
 #include <QPixmap>
 #include <algorithm>
 #include <cmath>
@@ -114,6 +115,7 @@ namespace isis::gui
                 {
                         pixmap = pixmap.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
                 }
+                paintReferenceLines(pixmap, frameSize);
 
                 if (m_widget.m_imageLabel)
                 {
@@ -217,6 +219,61 @@ namespace isis::gui
                 }
         }
 
+        void Widget2DRenderer::paintReferenceLines(QPixmap& t_pixmap, const QSize& t_frameSize) const
+        {
+                if (m_widget.m_referenceLines.isEmpty() || t_frameSize.isEmpty())
+                {
+                        return;
+                }
+
+                // Lines are in pixel coordinates of the stored image; apply the
+                // same flip and rotation as the rendered frame, then the zoom.
+                const Widget2DState& constState = m_state;
+                const auto& presentation = constState.presentation();
+                const int rotationSteps = ((presentation.RotationSteps % 4) + 4) % 4;
+                const bool swapped = (rotationSteps % 2) != 0;
+                const double width = swapped ? t_frameSize.height() : t_frameSize.width();
+                const double height = swapped ? t_frameSize.width() : t_frameSize.height();
+                const double scale = static_cast<double>(t_pixmap.width()) / static_cast<double>(t_frameSize.width());
+                const auto toDisplay = [&](QPointF point)
+                {
+                        if (presentation.FlipHorizontal)
+                        {
+                                point.setX(width - point.x());
+                        }
+                        if (presentation.FlipVertical)
+                        {
+                                point.setY(height - point.y());
+                        }
+                        switch (rotationSteps)
+                        {
+                        case 1:
+                                point = QPointF(height - point.y(), point.x());
+                                break;
+                        case 2:
+                                point = QPointF(width - point.x(), height - point.y());
+                                break;
+                        case 3:
+                                point = QPointF(point.y(), width - point.x());
+                                break;
+                        default:
+                                break;
+                        }
+                        return point * scale;
+                };
+
+                QPainter painter(&t_pixmap);
+                painter.setRenderHint(QPainter::Antialiasing);
+                QPen pen(QColor(255, 210, 0));
+                pen.setCosmetic(true);
+                pen.setWidthF(1.0);
+                painter.setPen(pen);
+                for (const QLineF& line : m_widget.m_referenceLines)
+                {
+                        painter.drawLine(QLineF(toDisplay(line.p1()), toDisplay(line.p2())));
+                }
+        }
+
         void Widget2DRenderer::hideOverlay()
         {
                 if (m_widget.m_overlayUpdater)
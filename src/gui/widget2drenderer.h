@@ -41,6 +41,8 @@
 #include <QObject>
 
 class QImage;
+class QPixmap;
+class QSize;
 
 namespace isis::gui
 {
@@ -60,6 +62,7 @@ namespace isis::gui
 
         private:
                 void updateOverlay(const QImage& t_frameImage, int t_frameIndex);
+                void paintReferenceLines(QPixmap& t_pixmap, const QSize& t_frameSize) const;
 
                 Widget2D& m_widget;
                 Widget2DState& m_state;
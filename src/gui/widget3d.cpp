@@ -50,6 +50,7 @@
 #include <QMetaObject>
 #include <QtConcurrent/qtconcurrentrun.h>
 #include <algorithm>
+#include <array>
 
 Q_DECLARE_LOGGING_CATEGORY(lcLoadingAnimation)
 Q_LOGGING_CATEGORY(lcWidget3D, "isis.gui.widget3d")
@@ -123,6 +124,10 @@ void isis::gui::Widget3D::render()
         }
         try
         {
+                // A crop still being extracted belongs to the previous volume
+                m_cropFuture.waitForFinished();
+                m_cropPending = false;
+                m_restorePending = false;
                 m_toolbar->getUI().toolButtonCrop->setVisible(false);
                 m_toolbar->getUI().comboBoxFilters->setVisible(false);
                 hideStatusOverlay();
@@ -150,6 +155,12 @@ bool isis::gui::Widget3D::eventFilter(QObject* watched, QEvent* event)
 		auto* const keyEvent = dynamic_cast<QKeyEvent*>(event);
 		const int key = keyEvent->key();
 		auto* const combo = m_toolbar->getUI().comboBoxFilters;
+		// Undoing the crop consumes the key, so no other undo handler sees it
+		if (keyEvent->matches(QKeySequence::Undo) && m_vtkWidget && (m_vtkWidget->isCropped() || m_cropBusy))
+		{
+			restoreFullVolume();
+			return true;
+		}
 		switch (key)
 		{
 		case Qt::Key_Left:
@@ -204,6 +215,136 @@ void isis::gui::Widget3D::onCropPressed(const bool& t_pressed) const
         }
 }
 
+//-----------------------------------------------------------------------------
+void isis::gui::Widget3D::onCropChanged()
+{
+        // Only one extraction at a time: the extractor reuses the buffer of the crop before the shown one
+        if (m_cropBusy)
+        {
+                m_cropPending = true;
+                return;
+        }
+        startCropExtraction();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::Widget3D::startCropExtraction()
+{
+        m_cropPending = false;
+        std::array<int, 6> extent = {};
+        int stride = 1;
+        const auto current = m_vtkWidget->currentVolume();
+        if (!current || !m_vtkWidget->cropRegion(extent.data(), stride)
+                || m_vtkWidget->isCroppedTo(extent.data(), stride))
+        {
+                return;
+        }
+        // A box back around the whole volume shows the full volume again rather than a copy of it
+        if (m_vtkWidget->isCropped() && m_vtkWidget->isFullExtent(extent.data(), stride))
+        {
+                restoreFullVolume();
+                return;
+        }
+
+        m_cropBusy = true;
+        qCInfo(lcWidget3D) << "Crop committed" << "seriesIdx" << m_seriesIndex << "stride" << stride;
+        m_cropFuture = QtConcurrent::run([this, current, extent, stride]()
+        {
+                QString failureReason;
+                std::shared_ptr<VtkDicomVolume> cropped;
+                try
+                {
+                        cropped = m_vtkWidget->extractCrop(current, extent.data(), stride, &failureReason);
+                }
+                catch (const std::exception& ex)
+                {
+                        failureReason = QString::fromUtf8(ex.what());
+                }
+                QMetaObject::invokeMethod(
+                        this,
+                        [this, current, cropped, extent, stride, failureReason]()
+                        {
+                                // Dropped when another volume was shown in the meantime
+                                if (cropped && m_vtkWidget->currentVolume() == current)
+                                {
+                                        m_vtkWidget->applyCrop(cropped, extent.data(), stride);
+                                        if (auto* const renderWindow = m_qtvtkWidget->renderWindow())
+                                        {
+                                                renderWindow->Render();
+                                        }
+                                }
+                                else if (!cropped)
+                                {
+                                        qCWarning(lcWidget3D) << "Crop extraction failed" << failureReason;
+                                }
+                                finishCropTask();
+                        },
+                        Qt::QueuedConnection);
+        });
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::Widget3D::restoreFullVolume()
+{
+        if (m_cropBusy)
+        {
+                m_cropPending = false;
+                m_restorePending = true;
+                return;
+        }
+        m_restorePending = false;
+        if (!m_vtkWidget->isCropped())
+        {
+                return;
+        }
+
+        // The full volume comes back from the volume cache, expanded there if it was compressed
+        m_cropBusy = true;
+        const auto current = m_vtkWidget->currentVolume();
+        m_cropFuture = QtConcurrent::run([this, current]()
+        {
+                QString failureReason;
+                std::shared_ptr<VtkDicomVolume> full;
+                try
+                {
+                        full = m_vtkWidget->acquireVolume(&failureReason);
+                }
+                catch (const std::exception& ex)
+                {
+                        failureReason = QString::fromUtf8(ex.what());
+                }
+                QMetaObject::invokeMethod(
+                        this,
+                        [this, current, full, failureReason]()
+                        {
+                                if (m_vtkWidget->currentVolume() == current && !m_vtkWidget->restoreFullVolume(full))
+                                {
+                                        qCWarning(lcWidget3D) << "Full volume unavailable for undoing the crop" << failureReason;
+                                }
+                                if (auto* const renderWindow = m_qtvtkWidget->renderWindow())
+                                {
+                                        renderWindow->Render();
+                                }
+                                finishCropTask();
+                        },
+                        Qt::QueuedConnection);
+        });
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::Widget3D::finishCropTask()
+{
+        m_cropBusy = false;
+        if (m_restorePending)
+        {
+                restoreFullVolume();
+        }
+        else if (m_cropPending)
+        {
+                startCropExtraction();
+        }
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::Widget3D::onActivateWidget(const bool& t_flag)
 {
@@ -298,6 +439,8 @@ void isis::gui::Widget3D::onRenderAsync(Widget3D* t_self)
                 {
                         QElapsedTimer composeTimer;
                         composeTimer.start();
+                        // Composing resets the crop extractor, which a crop started meanwhile may be using
+                        t_self->m_cropFuture.waitForFinished();
                         const bool success = t_self->m_vtkWidget->composeAndRenderVolume(volume, failureReason);
                         const qint64 composeDurationMs = composeTimer.elapsed();
                         qCInfo(lcWidget3D) << "vtkWidget3D::render completed"
@@ -345,6 +488,7 @@ void isis::gui::Widget3D::initData()
 	updateStatusOverlayGeometry();
 	m_vtkWidget = std::make_unique<vtkWidget3D>();
 	m_vtkWidget->setRenderWindow(m_renderWindow3D);
+	m_vtkWidget->setCropChangedCallback([this]() { onCropChanged(); });
 	m_toolbar = new ToolbarWidget3D(this);
 	m_vtkEvents = std::make_unique<vtkEventFilter>(this);
 	setWidgetType(WidgetType::widget3d);
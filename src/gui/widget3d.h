@@ -58,7 +58,7 @@ namespace isis::gui
 	Q_OBJECT
 	public:
 		explicit Widget3D(QWidget* parent = Q_NULLPTR);
-		~Widget3D() { m_future.waitForFinished(); }
+		~Widget3D() { m_future.waitForFinished(); m_cropFuture.waitForFinished(); }
 
 		//getters
 		[[nodiscard]] QFuture<void> getFuture() const { return m_future; }
@@ -86,6 +86,10 @@ namespace isis::gui
                 vtkSmartPointer<vtkGenericOpenGLRenderWindow> m_renderWindow3D = {};
                 std::unique_ptr<vtkWidget3D> m_vtkWidget = {};
                 QFuture<void> m_future = {};
+                QFuture<void> m_cropFuture = {};
+                bool m_cropBusy = false;
+                bool m_cropPending = false;
+                bool m_restorePending = false;
                 QElapsedTimer m_renderTimer = {};
 		QLabel* m_statusOverlay = nullptr;
 
@@ -98,6 +102,10 @@ namespace isis::gui
 		void hideStatusOverlay();
 		void updateStatusOverlayGeometry();
 		void static onRenderAsync(Widget3D* t_self);
+		void onCropChanged();
+		void startCropExtraction();
+		void restoreFullVolume();
+		void finishCropTask();
 	};
 }
 
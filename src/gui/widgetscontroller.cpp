@@ -39,25 +39,89 @@
 #include "widgetscontroller.h"
 #include "filesimporter.h"
 #include "widget2d.h"
+#include "widget2dpresenterregistry.h"
 #include "vtkwidget2d.h"
 #include "widget3d.h"
 #include "widgetmpr.h"
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QEvent>
 #include <QEventLoop>
+#include <QFileInfo>
 #include <QLoggingCategory>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <QString>
 #include <QStringList>
 #include <QtGlobal>
 #include <QVariant>
 #include <QVTKOpenGLNativeWidget.h>
 #include <QWidget>
+#include <vtkImageActor.h>
+#include <algorithm>
 #include <atomic>
 
 Q_LOGGING_CATEGORY(lcWidgetsController, "isis.gui.widgetscontroller")
 
+namespace
+{
+	// Reports go to the application data folder, which is never a share or the storage SCP's
+	// store; ISIS_SR_NEXT_TO_SERIES=1 writes them next to a writable series folder instead
+	bool writeReportsNextToSeries()
+	{
+		const QByteArray value = qgetenv("ISIS_SR_NEXT_TO_SERIES").trimmed().toLower();
+		return value == "1" || value == "true" || value == "yes" || value == "on";
+	}
+
+	QString appDataReportPath(const std::string& t_seriesUID)
+	{
+		return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+			+ QStringLiteral("/measurements")).filePath(
+			QStringLiteral("SR_%1.dcm").arg(QString::fromStdString(t_seriesUID)));
+	}
+
+	QString measurementReportPath(isis::core::Series* t_series)
+	{
+		const auto& images = t_series->getSingleFrameImages().empty()
+			? t_series->getMultiFrameImages()
+			: t_series->getSingleFrameImages();
+		if (writeReportsNextToSeries() && !images.empty())
+		{
+			const QFileInfo source(QString::fromStdString((*images.begin())->getImagePath()));
+			const QFileInfo folder(source.absolutePath());
+			if (folder.isDir() && folder.isWritable())
+			{
+				return QDir(folder.absoluteFilePath()).filePath(
+					QStringLiteral("SR_%1.dcm").arg(QString::fromStdString(t_series->getUID())));
+			}
+		}
+		return appDataReportPath(t_series->getUID());
+	}
+
+	isis::gui::vtkWidget2D* bridgedVtkWidget(const isis::gui::Widget2D* t_widget)
+	{
+		const QVariant property = t_widget->property(isis::gui::Widget2D::vtkWidgetPropertyName);
+		const auto rawValue = property.isValid()
+			? property.value<quintptr>()
+			: static_cast<quintptr>(0);
+		return rawValue != 0
+			? reinterpret_cast<isis::gui::vtkWidget2D*>(rawValue)
+			: nullptr;
+	}
+
+	isis::core::Image* displayImage(isis::core::Series* t_series)
+	{
+		const auto& images = t_series->getSingleFrameImages().empty()
+			? t_series->getMultiFrameImages()
+			: t_series->getSingleFrameImages();
+		return images.empty() ? nullptr : images.begin()->get();
+	}
+
+	// Import pauses shorter than this do not count as the end of an import
+	constexpr int HangingProtocolDelayMs = 500;
+}
+
 isis::gui::WidgetsController::WidgetsController()
 {
         initData();
@@ -69,7 +133,46 @@ void isis::gui::WidgetsController::initData()
 	m_widgetsRepository = std::make_unique<WidgetsRepository>();
 	m_widgetsContainer = std::make_unique<WidgetsContainer>();
 	m_widgetsContainer->setWidgetReference(&m_widgetsRepository->getWidgets());
-	m_measuresManager = std::make_unique<measures::MeasuresManager>();
+	m_annotationStore = std::make_shared<measures::AnnotationStore>();
+	m_reportService = std::make_unique<measures::MeasurementReportService>();
+	m_viewportLinker = std::make_unique<ViewportLinker>();
+	const QString protocolsPath = HangingProtocolEngine::defaultPath();
+	QString protocolsError;
+	if (QFileInfo::exists(protocolsPath))
+	{
+		if (!m_hangingProtocols.loadFromFile(protocolsPath, protocolsError))
+		{
+			qCWarning(lcWidgetsController) << "Using default hanging protocols:" << protocolsError;
+		}
+	}
+	else if (QDir().mkpath(QFileInfo(protocolsPath).absolutePath())
+		&& !m_hangingProtocols.saveToFile(protocolsPath, protocolsError))
+	{
+		qCWarning(lcWidgetsController) << "Could not write default hanging protocols:" << protocolsError;
+	}
+	m_hangingTimer.setSingleShot(true);
+	m_hangingTimer.setInterval(HangingProtocolDelayMs);
+	Q_UNUSED(connect(&m_hangingTimer, &QTimer::timeout, this,
+		[this]()
+		{
+			if (m_lastImportedSeries)
+			{
+				hangStudy(m_lastImportedSeries->getParentObject(), false);
+			}
+		}));
+	Q_UNUSED(connect(m_reportService.get(), &measures::MeasurementReportService::annotationsImported, this,
+		[this](const std::vector<measures::Annotation>& annotations)
+		{
+			const auto added = m_annotationStore->merge(annotations);
+			if (added > 0)
+			{
+				for (const auto& [widget, manager] : m_measuresManagers)
+				{
+					manager->refreshDisplayedAnnotations();
+				}
+			}
+			qCInfo(lcWidgetsController) << "Restored" << added << "measurements from reports";
+		}));
 }
 
 //-----------------------------------------------------------------------------
@@ -145,7 +248,7 @@ void isis::gui::WidgetsController::applyWindowPreset(double center, double width
 }
 
 //-----------------------------------------------------------------------------
-void isis::gui::WidgetsController::activateInteractionTool(InteractionTool tool) const
+void isis::gui::WidgetsController::activateInteractionTool(InteractionTool tool)
 {
         if (!m_activeWidget)
         {
@@ -158,57 +261,200 @@ void isis::gui::WidgetsController::activateInteractionTool(InteractionTool tool)
                 return;
         }
 
-        vtkWidget2D* vtkWidget = nullptr;
-        {
-                const QVariant property = widget2d->property(Widget2D::vtkWidgetPropertyName);
-                const auto rawValue = property.isValid()
-                        ? property.value<quintptr>()
-                        : static_cast<quintptr>(0);
-                if (rawValue != 0)
-                {
-                        vtkWidget = reinterpret_cast<vtkWidget2D*>(rawValue);
-                }
-        }
-
+        vtkWidget2D* const vtkWidget = bridgedVtkWidget(widget2d);
         auto* interactor = vtkWidget ? vtkWidget->getInteractor() : nullptr;
+        measures::MeasuresManager* const manager = measuresManager(widget2d);
         if (interactor)
         {
-                // Initialize measures manager if not already done
-                if (m_measuresManager && m_measuresManager->getCurrentToolType() == measures::MeasureToolType::None)
-                {
-                        // First initialization
-                        m_measuresManager->initialize(interactor);
-                }
+                // Binds the tools to the view's current render window
+                manager->initialize(interactor);
 
                 // Map InteractionTool to MeasureToolType and activate
                 switch (tool)
                 {
                 case InteractionTool::measureDistance:
-                        m_measuresManager->activateTool(measures::MeasureToolType::Distance);
+                        manager->activateTool(measures::MeasureToolType::Distance);
                         break;
                 case InteractionTool::measureAngle:
-                        m_measuresManager->activateTool(measures::MeasureToolType::Angle);
+                        manager->activateTool(measures::MeasureToolType::Angle);
                         break;
                 case InteractionTool::measureBiDimensional:
-                        m_measuresManager->activateTool(measures::MeasureToolType::BiDimensional);
+                        manager->activateTool(measures::MeasureToolType::BiDimensional);
                         break;
                 case InteractionTool::measureContour:
-                        m_measuresManager->activateTool(measures::MeasureToolType::Contour);
+                        manager->activateTool(measures::MeasureToolType::Contour);
                         break;
                 default:
                         // Deactivate measurement tools for other interaction modes
-                        m_measuresManager->deactivateCurrentTool();
+                        manager->deactivateCurrentTool();
                         break;
                 }
         }
-        else if (m_measuresManager)
+        else
         {
-                m_measuresManager->deactivateCurrentTool();
+                manager->deactivateCurrentTool();
         }
 
         widget2d->setActiveTool(tool);
 }
 
+//-----------------------------------------------------------------------------
+isis::gui::measures::MeasuresManager* isis::gui::WidgetsController::measuresManager(Widget2D* t_widget)
+{
+        auto& manager = m_measuresManagers[t_widget];
+        if (manager)
+        {
+                return manager.get();
+        }
+
+        manager = std::make_unique<measures::MeasuresManager>(m_annotationStore);
+        auto* const created = manager.get();
+        // What one view places or deletes shows up in the views of the same series
+        created->setStoreChangedCallback([this, created]()
+                {
+                        for (const auto& [widget, other] : m_measuresManagers)
+                        {
+                                if (other.get() != created)
+                                {
+                                        other->refreshDisplayedAnnotations();
+                                }
+                        }
+                });
+        Q_UNUSED(connect(t_widget, &QObject::destroyed, this,
+                [this, t_widget]()
+                {
+                        const auto found = m_measuresManagers.find(t_widget);
+                        if (found == m_measuresManagers.end())
+                        {
+                                return;
+                        }
+                        // Edits of a closed view are still exported
+                        for (const auto& seriesUID : found->second->takeModifiedSeries())
+                        {
+                                m_pendingMeasuredSeries.insert(seriesUID);
+                        }
+                        m_measuresManagers.erase(found);
+                }));
+        return created;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::WidgetsController::updateMeasuresSlice(Widget2D* t_widget, const int t_frameIndex)
+{
+        if (!t_widget || !t_widget->getSeries())
+        {
+                return;
+        }
+
+        // Frames of a multi-frame object are numbered within that instance, not the series
+        const core::Image* const displayed = t_widget->getImage();
+        const bool instanceFrames = displayed && displayed->getIsMultiFrame();
+        const core::Image* image = instanceFrames ? displayed : t_widget->getFrameImage(t_frameIndex);
+        if (!image)
+        {
+                return;
+        }
+
+        measures::SlicePlane plane;
+        if (image->hasImageOrientationPatient())
+        {
+                plane.row = image->getImageOrientationRow();
+                plane.column = image->getImageOrientationColumn();
+        }
+        if (image->hasImagePositionPatient())
+        {
+                plane.origin = image->getImagePositionPatient();
+        }
+        else
+        {
+                // Without a position, keep the frames 1 mm apart so each shows its own annotations
+                const auto normal = plane.normal();
+                plane.origin = {normal[0] * t_frameIndex, normal[1] * t_frameIndex, normal[2] * t_frameIndex};
+        }
+        plane.sopInstanceUID = image->getSOPInstanceUID();
+        plane.sopClassUID = image->getClassUID();
+        plane.frameOfReferenceUID = image->getFrameOfRefernceID();
+        plane.frameNumber = instanceFrames
+                ? std::clamp(t_frameIndex + 1, 1, std::max(image->getNumberOfFrames(), 1))
+                : 1;
+
+        // The view's image places the slice in world space; the tools report world positions
+        measures::MeasuresManager* const manager = measuresManager(t_widget);
+        vtkImageData* imageData = nullptr;
+        int slice = 0;
+        if (vtkWidget2D* const vtkWidget = bridgedVtkWidget(t_widget))
+        {
+                manager->initialize(vtkWidget->getInteractor());
+                if (const auto dcmWidget = vtkWidget->getDCMWidget())
+                {
+                        imageData = dcmWidget->GetImageActor() ? dcmWidget->GetImageActor()->GetInput() : nullptr;
+                        slice = dcmWidget->GetSlice();
+                }
+        }
+
+        m_measuredSeries[t_widget->getSeries()->getUID()] = t_widget->getSeries();
+        manager->setDisplayedSlice(t_widget->getSeries()->getUID(), plane, imageData, slice);
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::WidgetsController::importMeasurementReport(const QString& t_path) const
+{
+        m_reportService->importReport(t_path);
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::WidgetsController::exportMeasurements()
+{
+        if (!m_reportService)
+        {
+                return;
+        }
+
+        std::unordered_set<std::string> modifiedSeries = std::move(m_pendingMeasuredSeries);
+        m_pendingMeasuredSeries.clear();
+        for (const auto& [widget, manager] : m_measuresManagers)
+        {
+                for (const auto& seriesUID : manager->takeModifiedSeries())
+                {
+                        modifiedSeries.insert(seriesUID);
+                }
+        }
+
+        for (const auto& seriesUID : modifiedSeries)
+        {
+                const auto found = m_measuredSeries.find(seriesUID);
+                if (found == m_measuredSeries.end() || !found->second)
+                {
+                        continue;
+                }
+                core::Series* const series = found->second;
+
+                measures::MeasurementReportContext context;
+                context.seriesInstanceUID = seriesUID;
+                if (const auto* const study = series->getParentObject())
+                {
+                        context.studyInstanceUID = study->getUID();
+                        context.studyID = study->getID();
+                        context.studyDate = study->getDate();
+                        context.studyDescription = study->getDescription();
+                        if (const auto* const patient = study->getParentObject())
+                        {
+                                context.patientName = patient->getName();
+                                context.patientID = patient->getID();
+                                context.patientBirthDate = patient->getBirthDate();
+                        }
+                }
+
+                // A series whose measurements were all deleted gets an empty report replacing the old one
+                std::vector<measures::Annotation> annotations;
+                for (const auto* const annotation : m_annotationStore->annotations(seriesUID))
+                {
+                        annotations.push_back(*annotation);
+                }
+                m_reportService->exportReport(context, std::move(annotations), measurementReportPath(series));
+        }
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::WidgetsController::warmUpAdvancedViewers(QWidget* contextWidget)
 {
@@ -374,9 +620,21 @@ void isis::gui::WidgetsController::warmUpAdvancedViewers(QWidget* contextWidget)
 }
 
 //-----------------------------------------------------------------------------
-void isis::gui::WidgetsController::resetData() const
+void isis::gui::WidgetsController::resetData()
 {
 	waitForRenderingThreads();
+	m_annotationStore->clear();
+	m_pendingMeasuredSeries.clear();
+	for (const auto& [widget, manager] : m_measuresManagers)
+	{
+		manager->clearAllAnnotations();
+	}
+	m_measuredSeries.clear();
+	m_restoredReports.clear();
+	m_viewportLinker->clear();
+	m_hangingTimer.stop();
+	m_lastImportedSeries = nullptr;
+	m_hungStudies.clear();
 	const auto widgets = m_widgetsRepository->getWidgets();
 	for (const auto& widget : widgets)
 	{
@@ -385,6 +643,14 @@ void isis::gui::WidgetsController::resetData() const
 			widget->resetWidget();
 		}
 	}
+	Widget2DPresenterRegistry::instance().clear();
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::WidgetsController::setViewportLinking(const bool t_enabled)
+{
+	m_viewportLinker->setEnabled(t_enabled);
+	qCInfo(lcWidgetsController) << "Viewport linking" << (t_enabled ? "enabled" : "disabled");
 }
 
 //-----------------------------------------------------------------------------
@@ -449,6 +715,10 @@ void isis::gui::WidgetsController::setMaximize(TabWidget* t_widget) const
 //-----------------------------------------------------------------------------
 void isis::gui::WidgetsController::populateWidget(core::Series* t_series, core::Image* t_image)
 {
+        if (t_series)
+        {
+                m_lastImportedSeries = t_series;
+        }
         auto* const widget = findNextAvailableWidget();
         if (widget)
         {
@@ -466,43 +736,209 @@ void isis::gui::WidgetsController::populateWidget(core::Series* t_series, core::
                         widget2d->setIsImageLoaded(false);
                         return;
                 }
-                widget2d->setWidgetType(WidgetBase::WidgetType::widget2d);
-                widget2d->setRenderRequestSource(QStringLiteral("FilesImporter::populateWidget"));
-                widget2d->setSeries(t_series);
-                widget2d->setImage(t_image);
-                auto* const study = t_series->getParentObject();
-                widget2d->setIndexes(study->getParentObject()->getIndex(),
-                                     study->getIndex(), t_series->getIndex(),
-                                     t_image->getIndex());
-                widget2d->setIsImageLoaded(true);
+                showSeries(widget2d, t_series, t_image, QStringLiteral("FilesImporter::populateWidget"), true);
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::WidgetsController::showSeries(Widget2D* t_widget, core::Series* t_series, core::Image* t_image,
+        const QString& t_source, const bool t_activate)
+{
+        t_widget->setWidgetType(WidgetBase::WidgetType::widget2d);
+        t_widget->setRenderRequestSource(t_source);
+        t_widget->setSeries(t_series);
+        t_widget->setImage(t_image);
+        auto* const study = t_series->getParentObject();
+        t_widget->setIndexes(study->getParentObject()->getIndex(),
+                             study->getIndex(), t_series->getIndex(),
+                             t_image->getIndex());
+        t_widget->setIsImageLoaded(true);
+        // Measurements saved in the application data folder come back with the series
+        if (m_restoredReports.insert(t_series->getUID()).second)
+        {
+                const QString reportPath = appDataReportPath(t_series->getUID());
+                if (QFileInfo::exists(reportPath))
+                {
+                        importMeasurementReport(reportPath);
+                }
+        }
+        if (t_activate)
+        {
                 auto* const patient = study ? study->getParentObject() : nullptr;
                 emit seriesActivated(patient, study, t_series, t_image);
-                qCInfo(lcWidgetsController)
-                        << "Requesting render for series" << QString::fromStdString(t_series->getUID())
-                        << "(index" << t_series->getIndex() << ")"
-                        << "image" << QString::fromStdString(t_image->getSOPInstanceUID())
-                        << "(index" << t_image->getIndex() << ")"
-                        << "layout" << layoutToString(m_currentLayout);
-                widget2d->render();
-                connectVtkToolBridge(widget2d);
-                if (widget2d->wasRenderAbortedDueToMissingContext())
+        }
+        qCInfo(lcWidgetsController)
+                << "Requesting render for series" << QString::fromStdString(t_series->getUID())
+                << "(index" << t_series->getIndex() << ")"
+                << "image" << QString::fromStdString(t_image->getSOPInstanceUID())
+                << "(index" << t_image->getIndex() << ")"
+                << "layout" << layoutToString(m_currentLayout);
+        t_widget->render();
+        connectVtkToolBridge(t_widget);
+        if (t_widget->wasRenderAbortedDueToMissingContext())
+        {
+                qCWarning(lcWidgetsController)
+                        << "Widget2D render aborted due to missing context."
+                        << "seriesMissing" << (t_widget->getSeries() == nullptr)
+                        << "imageMissing" << (t_widget->getImage() == nullptr)
+                        << "trigger" << t_widget->getRenderRequestSource();
+                t_widget->setIsImageLoaded(false);
+                t_widget->clearRenderAbortedDueToMissingContext();
+                return false;
+        }
+        Q_UNUSED(connect(m_filesImporter,
+                &FilesImporter::refreshScrollValues,
+                t_widget,
+                &Widget2D::onRefreshScrollValues,
+                Qt::QueuedConnection));
+        t_widget->forceFrameMetricsUpdate();
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+void isis::gui::WidgetsController::onImportQueueDrained()
+{
+        if (m_lastImportedSeries)
+        {
+                m_hangingTimer.start();
+        }
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::WidgetsController::applyHangingProtocol()
+{
+        core::Series* series = m_activeWidget ? m_activeWidget->getTabbedWidget()->getSeries() : nullptr;
+        if (!series)
+        {
+                series = m_lastImportedSeries;
+        }
+        if (!series || !hangStudy(series->getParentObject(), true))
+        {
+                qCInfo(lcWidgetsController) << "No hanging protocol matches the displayed study";
+                return false;
+        }
+        return true;
+}
+
+//-----------------------------------------------------------------------------
+bool isis::gui::WidgetsController::hangStudy(core::Study* t_study, const bool t_force)
+{
+        auto* const patient = t_study ? t_study->getParentObject() : nullptr;
+        if (!patient)
+        {
+                return false;
+        }
+
+        // Priors are the earlier studies of the patient, most recent first
+        std::vector<core::Study*> studies;
+        for (const auto& study : patient->getStudies())
+        {
+                if (study.get() != t_study && !study->getDate().empty() && study->getDate() < t_study->getDate())
                 {
-                        qCWarning(lcWidgetsController)
-                                << "Widget2D render aborted due to missing context."
-                                << "seriesMissing" << (widget2d->getSeries() == nullptr)
-                                << "imageMissing" << (widget2d->getImage() == nullptr)
-                                << "trigger" << widget2d->getRenderRequestSource();
-                        widget2d->setIsImageLoaded(false);
-                        widget2d->clearRenderAbortedDueToMissingContext();
-                        return;
+                        studies.push_back(study.get());
                 }
-                Q_UNUSED(connect(m_filesImporter,
-                        &FilesImporter::refreshScrollValues,
-                        widget2d,
-                        &Widget2D::onRefreshScrollValues,
-                        Qt::QueuedConnection));
-                widget2d->forceFrameMetricsUpdate();
         }
+        std::stable_sort(studies.begin(), studies.end(), [](const core::Study* lhs, const core::Study* rhs)
+        {
+                return lhs->getDate() > rhs->getDate();
+        });
+        studies.insert(studies.begin(), t_study);
+
+        std::vector<HangingSeries> offered;
+        std::vector<core::Series*> candidates;
+        for (std::size_t prior = 0; prior < studies.size(); ++prior)
+        {
+                for (const auto& series : studies[prior]->getSeries())
+                {
+                        const auto* image = displayImage(series.get());
+                        if (!image)
+                        {
+                                continue;
+                        }
+                        HangingSeries info;
+                        info.modality = image->getModality();
+                        info.bodyPart = series->getBodyPartExamined();
+                        info.description = series->getDescription();
+                        info.studyDescription = studies[prior]->getDescription();
+                        info.prior = static_cast<int>(prior);
+                        offered.push_back(std::move(info));
+                        candidates.push_back(series.get());
+                }
+        }
+
+        const auto plan = m_hangingProtocols.match(offered);
+        if (!plan)
+        {
+                return false;
+        }
+        const auto layout = layoutFromString(plan->protocol->layout);
+        if (layout == WidgetsContainer::layouts::none)
+        {
+                qCWarning(lcWidgetsController) << "Hanging protocol" << QString::fromStdString(plan->protocol->name)
+                        << "has an unknown layout" << QString::fromStdString(plan->protocol->layout);
+                return false;
+        }
+
+        // Hang a study again only when more of its viewports can be filled
+        const int filled = plan->filledViewports();
+        auto& hung = m_hungStudies[t_study->getUID()];
+        if (!t_force && hung >= filled)
+        {
+                return false;
+        }
+        hung = filled;
+
+        // One layout change and one repaint for the whole protocol. Presenters of the
+        // viewports being replaced are kept until the new viewports have picked them up.
+        std::vector<std::shared_ptr<Widget2DImagePresenter>> retained;
+        m_widgetsContainer->setUpdatesEnabled(false);
+        for (auto* widget : m_widgetsRepository->getWidgets())
+        {
+                if (widget->getTabbedWidget()->getImage())
+                {
+                        if (auto* const widget2d = dynamic_cast<Widget2D*>(widget->getTabbedWidget()))
+                        {
+                                retained.push_back(widget2d->getImagePresenter());
+                        }
+                        widget->resetWidget();
+                }
+        }
+        createWidgets(layout);
+
+        const auto widgets = m_widgetsRepository->getWidgets();
+        bool activated = false;
+        for (std::size_t i = 0; i < plan->viewportSeries.size() && i < widgets.size(); ++i)
+        {
+                const int index = plan->viewportSeries[i];
+                auto* const widget2d = dynamic_cast<Widget2D*>(widgets[i]->getActiveTabbedWidget());
+                if (index < 0 || !widget2d)
+                {
+                        continue;
+                }
+                auto* const series = candidates[static_cast<std::size_t>(index)];
+                const auto& rule = plan->protocol->viewports[i];
+                Widget2dPresentationState presentation;
+                presentation.WindowCenter = rule.windowCenter;
+                presentation.WindowWidth = rule.windowWidth;
+                presentation.InvertColors = rule.invert;
+                presentation.FlipHorizontal = rule.flipHorizontal;
+                presentation.FlipVertical = rule.flipVertical;
+                presentation.RotationSteps = rule.rotationSteps;
+                widget2d->setInitialPresentation(presentation);
+                if (showSeries(widget2d, series, displayImage(series), QStringLiteral("HangingProtocol"), !activated))
+                {
+                        activated = true;
+                }
+        }
+        m_widgetsContainer->setUpdatesEnabled(true);
+
+        qCInfo(lcWidgetsController)
+                << "Applied hanging protocol" << QString::fromStdString(plan->protocol->name)
+                << "study" << QString::fromStdString(t_study->getUID())
+                << "layout" << layoutToString(layout)
+                << "viewports" << filled
+                << "score" << plan->score;
+        return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -526,6 +962,23 @@ const char* isis::gui::WidgetsController::layoutToString(const WidgetsContainer:
         }
 }
 
+//-----------------------------------------------------------------------------
+isis::gui::WidgetsContainer::layouts isis::gui::WidgetsController::layoutFromString(const std::string& t_layout)
+{
+        for (const auto layout : {WidgetsContainer::layouts::one,
+                WidgetsContainer::layouts::twoRowOneBottom,
+                WidgetsContainer::layouts::twoColumnOneRight,
+                WidgetsContainer::layouts::threeRowOneBottom,
+                WidgetsContainer::layouts::threeColumnOneRight})
+        {
+                if (t_layout == layoutToString(layout))
+                {
+                        return layout;
+                }
+        }
+        return WidgetsContainer::layouts::none;
+}
+
 //-----------------------------------------------------------------------------
 void isis::gui::WidgetsController::createRemoveWidgets(const std::size_t& t_nrWidgets) const
 {
@@ -541,6 +994,7 @@ void isis::gui::WidgetsController::createRemoveWidgets(const std::size_t& t_nrWi
 void isis::gui::WidgetsController::createConnections()
 {
         const auto widgets = m_widgetsRepository->getWidgets();
+        std::vector<Widget2D*> viewports;
         for (const auto& widget : widgets)
         {
                 Q_UNUSED(connect(widget, &TabWidget::focused, this,
@@ -550,9 +1004,13 @@ void isis::gui::WidgetsController::createConnections()
                 if (auto* const widget2d = dynamic_cast<Widget2D*>(widget->getTabbedWidget()))
                 {
                         connectVtkToolBridge(widget2d);
+                        viewports.push_back(widget2d);
                         Q_UNUSED(connect(widget2d, &Widget2D::frameMetricsChanged, this,
-                                [this, widget](const Widget2D::FrameMetrics& metrics)
+                                [this, widget, widget2d](const Widget2D::FrameMetrics& metrics)
                                 {
+                                        m_viewportLinker->requestSync(widget2d, widget == m_activeWidget);
+                                        // Every view draws the measurements of its own slice
+                                        updateMeasuresSlice(widget2d, metrics.frameIndex);
                                         if (widget == m_activeWidget)
                                         {
                                                 emit activeFrameMetricsChanged(metrics);
@@ -576,6 +1034,7 @@ void isis::gui::WidgetsController::createConnections()
                         }
                 }
         }
+        m_viewportLinker->setViewports(viewports);
 }
 
 //-----------------------------------------------------------------------------
@@ -38,9 +38,11 @@
 
 #pragma once
 #include <QObject>
+#include <QTimer>
 #include <QWidget>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 
 #include "widgetscontainer.h"
@@ -50,6 +52,9 @@
 #include "widgetbase.h"
 #include "widget2d.h"
 #include "measures/measuresmanager.h"
+#include "measures/measurementreportservice.h"
+#include "viewportlinker.h"
+#include "hangingprotocol.h"
 
 namespace isis::core
 {
@@ -84,15 +89,21 @@ namespace isis::gui
                 void createWidgetMPR3D(const WidgetBase::WidgetType& t_type);
 		void applyTransformation(const transformationType& t_type) const;
 		void warmUpAdvancedViewers(QWidget* contextWidget);
-		void resetData() const;
+		void resetData();
+		void exportMeasurements();
 		void waitForRenderingThreads() const;
+		void setViewportLinking(bool t_enabled);
+		bool applyHangingProtocol();
+		[[nodiscard]] bool isViewportLinkingEnabled() const { return m_viewportLinker->isEnabled(); }
 		
         public slots:
                 void setActiveWidget(TabWidget* t_widget);
                 void setMaximize(TabWidget* t_widget) const;
                 void populateWidget(core::Series* t_series, core::Image* t_image);
 		void applyWindowPreset(double center, double width);
-                void activateInteractionTool(InteractionTool tool) const;
+                void activateInteractionTool(InteractionTool tool);
+                void importMeasurementReport(const QString& t_path) const;
+                void onImportQueueDrained();
 
         signals:
                 void seriesActivated(core::Patient* patient, core::Study* study,
@@ -109,9 +120,25 @@ namespace isis::gui
                         vtkWidget2D* target = nullptr;
                 };
 
+                void updateMeasuresSlice(Widget2D* t_widget, int t_frameIndex);
+                measures::MeasuresManager* measuresManager(Widget2D* t_widget);
+                bool showSeries(Widget2D* t_widget, core::Series* t_series, core::Image* t_image,
+                        const QString& t_source, bool t_activate);
+                bool hangStudy(core::Study* t_study, bool t_force);
+
                 std::unique_ptr<WidgetsRepository> m_widgetsRepository = {};
                 std::unique_ptr<WidgetsContainer> m_widgetsContainer = {};
-                std::unique_ptr<measures::MeasuresManager> m_measuresManager = {};
+                std::shared_ptr<measures::AnnotationStore> m_annotationStore = {};
+                std::unordered_map<Widget2D*, std::unique_ptr<measures::MeasuresManager>> m_measuresManagers = {};     // One per 2D view, sharing m_annotationStore
+                std::unique_ptr<measures::MeasurementReportService> m_reportService = {};
+                std::unordered_map<std::string, core::Series*> m_measuredSeries = {};
+                std::unordered_set<std::string> m_pendingMeasuredSeries = {};   // Modified in views that were closed
+                std::unordered_set<std::string> m_restoredReports = {};         // Series whose saved report was looked up
+                std::unique_ptr<ViewportLinker> m_viewportLinker = {};
+                HangingProtocolEngine m_hangingProtocols = {};
+                QTimer m_hangingTimer = {};
+                core::Series* m_lastImportedSeries = {};
+                std::unordered_map<std::string, int> m_hungStudies = {};        // Study UID -> viewports filled
                 TabWidget* m_activeWidget = {};
                 FilesImporter* m_filesImporter = {};
                 WidgetsContainer::layouts m_currentLayout = WidgetsContainer::layouts::none;
@@ -152,6 +179,7 @@ namespace isis::gui
                 void connectVtkToolBridge(Widget2D* t_widget);
                 [[nodiscard]] std::size_t computeNumberWidgetsFromLayout(const WidgetsContainer::layouts& t_layout);
                 [[nodiscard]] static const char* layoutToString(const WidgetsContainer::layouts& t_layout);
+                [[nodiscard]] static WidgetsContainer::layouts layoutFromString(const std::string& t_layout);
                 [[nodiscard]] std::unique_ptr<WidgetBase> takeWarmedWidget(const WidgetBase::WidgetType& t_type);
         };
 }
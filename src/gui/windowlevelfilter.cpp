@@ -43,6 +43,8 @@
 
 #include <QLoggingCategory>
 
+#include "utils/structuredlog.h"
+
 Q_LOGGING_CATEGORY(lcWindowLevelFilter, "isis.gui.windowlevelfilter")
 
 isis::gui::WindowLevelFilter::WindowLevelFilter()
@@ -120,10 +122,9 @@ void isis::gui::WindowLevelFilter::setWindowWidthCenter(int t_width, int t_cente
 	m_windowLevelColors->SetLookupTable(m_lookupTable);
 	m_windowLevelColors->Update();
 
-	qInfo()
-		<< "[WindowLevelFilter] Applied window/level."
-		<< "Width:" << safeWidth
-		<< "Center:" << t_center
-		<< "Invert:" << m_invert;
+	core::utils::telemetry().increment("render.window_level_applied");
+	core::utils::logEvent(lcWindowLevelFilter(), core::utils::LogLevel::Debug,
+		"[WindowLevelFilter] Applied window/level.",
+		{{"width", safeWidth}, {"center", t_center}, {"invert", m_invert}});
 }
 
@@ -0,0 +1,258 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: annotationstore_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for AnnotationStore: only the annotations of the displayed
+ *      slice are returned, hit-testing picks the nearest segment, oblique series
+ *      are indexed in their own basis, and scrolling through a series carrying
+ *      thousands of annotations only walks a small part of the R-tree.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/gui/measures/annotationstore.h"
+#include "tests/testsupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int Slices = 400;
+        constexpr double SliceSpacing = 1.25;
+        constexpr int ManyAnnotations = 20000;
+
+        using isis::tests::require;
+
+        isis::gui::measures::SlicePlane axialSlice(int slice)
+        {
+                isis::gui::measures::SlicePlane plane;
+                plane.origin = {-250.0, -250.0, slice * SliceSpacing};
+                plane.sopInstanceUID = "1.2.3." + std::to_string(slice + 1);
+                return plane;
+        }
+
+        isis::gui::measures::Annotation distance(const std::string& series,
+                                                 const isis::gui::measures::SlicePlane& plane,
+                                                 double x1, double y1, double x2, double y2)
+        {
+                isis::gui::measures::Annotation annotation;
+                annotation.type = isis::gui::measures::AnnotationType::Distance;
+                annotation.seriesInstanceUID = series;
+                annotation.sopInstanceUID = plane.sopInstanceUID;
+                annotation.points = {plane.toPatient(x1, y1), plane.toPatient(x2, y2)};
+                return annotation;
+        }
+}
+
+int main()
+{
+        using namespace isis::gui::measures;
+
+        try
+        {
+                // Only the annotations of the displayed slice are visible
+                {
+                        AnnotationStore store;
+                        const AnnotationId first = store.add(distance("S1", axialSlice(10), 100, 100, 200, 100));
+                        const AnnotationId second = store.add(distance("S1", axialSlice(10), 300, 300, 300, 400));
+                        const AnnotationId other = store.add(distance("S1", axialSlice(11), 100, 100, 200, 100));
+                        store.add(distance("S2", axialSlice(10), 100, 100, 200, 100));
+
+                        Annotation angle;
+                        angle.type = AnnotationType::Angle;
+                        angle.seriesInstanceUID = "S1";
+                        angle.points = {axialSlice(20).toPatient(0, 0), axialSlice(20).toPatient(50, 50),
+                                        axialSlice(20).toPatient(100, 0)};
+                        const AnnotationId angleId = store.add(angle);
+
+                        require(store.count() == 5 && store.count("S1") == 4, "Annotations were not stored.");
+                        require(store.visibleOn("S1", axialSlice(10)) == std::vector<AnnotationId>({first, second}),
+                                "Wrong annotations on slice 10.");
+                        require(store.visibleOn("S1", axialSlice(11)) == std::vector<AnnotationId>({other}),
+                                "Wrong annotations on slice 11.");
+                        require(store.visibleOn("S1", axialSlice(12)).empty(), "Empty slice shows annotations.");
+                        require(store.visibleOn("S3", axialSlice(10)).empty(), "Unknown series shows annotations.");
+
+                        // Hit-testing: nearest segment within tolerance, on the displayed slice only
+                        const SlicePlane slice10 = axialSlice(10);
+                        require(store.hitTest("S1", slice10, slice10.toPatient(150, 102), 3.0) == first,
+                                "Point next to the distance line was not hit.");
+                        require(!store.hitTest("S1", slice10, slice10.toPatient(150, 110), 3.0),
+                                "Point far from every line was hit.");
+                        require(store.hitTest("S1", slice10, slice10.toPatient(301, 350), 3.0) == second,
+                                "Vertical line was not hit.");
+                        require(store.hitTest("S1", axialSlice(20), axialSlice(20).toPatient(75, 26), 2.0) == angleId,
+                                "Angle arm was not hit.");
+                        require(!store.hitTest("S1", axialSlice(20), axialSlice(20).toPatient(50, 0), 2.0),
+                                "Inside of the angle was hit.");
+
+                        // Edits and removals are seen by the next query
+                        require(store.update(first, {axialSlice(12).toPatient(0, 0), axialSlice(12).toPatient(10, 0)}),
+                                "Update was rejected.");
+                        require(store.visibleOn("S1", axialSlice(10)) == std::vector<AnnotationId>({second}),
+                                "Moved annotation still shows on its old slice.");
+                        require(store.visibleOn("S1", axialSlice(12)) == std::vector<AnnotationId>({first}),
+                                "Moved annotation is missing from its new slice.");
+                        require(store.remove(second) && !store.remove(second), "Remove did not report correctly.");
+                        require(store.visibleOn("S1", axialSlice(10)).empty(), "Removed annotation is still visible.");
+                        require(store.find(second) == nullptr && store.find(other) != nullptr, "find() is wrong.");
+
+                        // Frames of a multi-frame instance that shares one position stay apart
+                        SlicePlane frame1 = axialSlice(30);
+                        SlicePlane frame2 = frame1;
+                        frame2.frameNumber = 2;
+                        Annotation onFrame2 = distance("S1", frame2, 0, 0, 10, 0);
+                        onFrame2.frameNumber = 2;
+                        const AnnotationId frameId = store.add(onFrame2);
+                        require(store.visibleOn("S1", frame1).empty(), "Annotation of frame 2 shows on frame 1.");
+                        require(store.visibleOn("S1", frame2) == std::vector<AnnotationId>({frameId}),
+                                "Annotation of frame 2 is missing.");
+                        require(!store.hitTest("S1", frame1, frame1.toPatient(5, 0), 1.0),
+                                "Annotation of frame 2 is hit on frame 1.");
+
+                        // Reports read twice add their measurements once
+                        Annotation tracked = distance("S4", axialSlice(5), 0, 0, 10, 0);
+                        tracked.trackingUID = "2.25.1";
+                        Annotation untracked = distance("S4", axialSlice(5), 0, 20, 10, 20);
+                        require(store.merge({tracked, untracked}) == 2, "Report annotations were not merged.");
+                        require(store.merge({tracked}) == 0 && store.count("S4") == 2,
+                                "Annotation with a known tracking UID was added again.");
+                        store.clearSeries("S4");
+
+                        store.clearSeries("S1");
+                        require(store.count() == 1 && store.count("S2") == 1, "clearSeries removed the wrong series.");
+                }
+
+                // Oblique series are indexed in their own basis
+                {
+                        AnnotationStore store;
+                        SlicePlane oblique;
+                        oblique.row = {0.0, 0.70710678, 0.70710678};
+                        oblique.column = {0.0, 0.70710678, -0.70710678};
+                        const double spacing = 2.0;
+                        const Point3 normal = oblique.normal();
+
+                        std::vector<SlicePlane> planes;
+                        for (int i = 0; i < 5; ++i)
+                        {
+                                SlicePlane plane = oblique;
+                                plane.origin = {normal[0] * i * spacing, normal[1] * i * spacing, normal[2] * i * spacing};
+                                planes.push_back(plane);
+                        }
+
+                        Annotation contour;
+                        contour.type = AnnotationType::Contour;
+                        contour.closed = true;
+                        contour.seriesInstanceUID = "OBL";
+                        contour.points = {planes[3].toPatient(10, 10), planes[3].toPatient(40, 10),
+                                          planes[3].toPatient(40, 40), planes[3].toPatient(10, 40)};
+                        const AnnotationId id = store.add(contour);
+
+                        for (int i = 0; i < 5; ++i)
+                        {
+                                require(store.visibleOn("OBL", planes[i]).empty() == (i != 3),
+                                        "Oblique contour shows on slice " + std::to_string(i) + ".");
+                        }
+                        require(store.hitTest("OBL", planes[3], planes[3].toPatient(25, 39), 2.0) == id,
+                                "Closing edge of the contour was not hit.");
+                        require(!store.hitTest("OBL", planes[3], planes[3].toPatient(25, 25), 2.0),
+                                "Inside of the contour was hit.");
+                        require(std::abs(planes[3].toPlane(contour.points[2])[0] - 40.0) < 1e-6,
+                                "Plane coordinates do not round-trip.");
+                }
+
+                // Thousands of annotations: scrolling matches a full scan and stays cheap
+                {
+                        AnnotationStore store;
+                        std::mt19937 random(91);
+                        std::uniform_int_distribution<int> sliceOf(0, Slices - 1);
+                        std::uniform_real_distribution<double> coordinate(0.0, 480.0);
+                        std::uniform_real_distribution<double> extent(2.0, 20.0);
+
+                        std::vector<std::vector<AnnotationId>> expected(Slices);
+                        for (int i = 0; i < ManyAnnotations; ++i)
+                        {
+                                const int slice = sliceOf(random);
+                                const double x = coordinate(random);
+                                const double y = coordinate(random);
+                                const AnnotationId id = store.add(
+                                        distance("BIG", axialSlice(slice), x, y, x + extent(random), y + extent(random)));
+                                expected[slice].push_back(id);
+                        }
+
+                        // First query packs the tree
+                        require(store.visibleOn("BIG", axialSlice(0)) == expected[0], "Slice 0 does not match a full scan.");
+
+                        const auto start = std::chrono::steady_clock::now();
+                        std::size_t shown = 0;
+                        std::size_t maxVisited = 0;
+                        for (int pass = 0; pass < 5; ++pass)
+                        {
+                                for (int slice = 0; slice < Slices; ++slice)
+                                {
+                                        const auto visible = store.visibleOn("BIG", axialSlice(slice));
+                                        shown += visible.size();
+                                        maxVisited = std::max(maxVisited, store.index("BIG")->lastVisitedNodes());
+                                        if (pass == 0)
+                                        {
+                                                require(visible == expected[slice],
+                                                        "Slice " + std::to_string(slice) + " does not match a full scan.");
+                                        }
+                                }
+                        }
+                        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - start);
+                        const double perSliceMicroseconds = static_cast<double>(elapsed.count()) / (5.0 * Slices);
+
+                        require(shown == 5u * ManyAnnotations, "Scrolling did not show every annotation once per pass.");
+                        const std::size_t leaves = ManyAnnotations / AnnotationSpatialIndex::NodeCapacity;
+                        require(maxVisited < leaves / 10,
+                                "Slice query visited " + std::to_string(maxVisited) + " nodes out of "
+                                + std::to_string(leaves) + " leaves.");
+                        require(perSliceMicroseconds < 1000.0,
+                                "Slice query takes " + std::to_string(perSliceMicroseconds) + " us.");
+
+                        // Hit-testing on a crowded slice returns only annotations under the cursor
+                        const SlicePlane slice = axialSlice(200);
+                        for (const AnnotationId id : expected[200])
+                        {
+                                const Annotation* annotation = store.find(id);
+                                const Point3 start = slice.toPlane(annotation->points[0]);
+                                const Point3 end = slice.toPlane(annotation->points[1]);
+                                const auto hit = store.hitTest("BIG", slice,
+                                        slice.toPatient(0.5 * (start[0] + end[0]), 0.5 * (start[1] + end[1])), 0.5);
+                                require(hit.has_value(), "Midpoint of a line was not hit.");
+                                const Annotation* hitAnnotation = store.find(*hit);
+                                require(std::find(expected[200].begin(), expected[200].end(), *hit) != expected[200].end()
+                                        && hitAnnotation->sopInstanceUID == slice.sopInstanceUID,
+                                        "Hit an annotation of another slice.");
+                        }
+                        require(store.index("BIG")->lastVisitedNodes() < leaves / 10, "Hit-test walked most of the tree.");
+
+                        std::cout << "annotationstore_test: " << ManyAnnotations << " annotations, "
+                                  << perSliceMicroseconds << " us per slice, at most " << maxVisited
+                                  << " nodes visited" << std::endl;
+                }
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "annotationstore_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "annotationstore_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,361 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomframesource_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks frame-by-frame access to multi-frame objects: the first frame of a
+ *      3000-frame enhanced object is available without decoding the others, each
+ *      frame keeps the rescale and position of its functional group, and RLE
+ *      frames are found through the Basic or Extended Offset Table, one fragment
+ *      per frame, or the start of each codestream.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/dicomframesource.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcpixel.h>
+#include <dcmtk/dcmdata/dcpixseq.h>
+#include <dcmtk/dcmdata/dcpxitem.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int LargeFrames = 3000;
+        constexpr Uint16 LargeSize = 64;
+        constexpr int RleFrames = 3;
+        constexpr Uint16 RleSize = 16;
+
+        enum class RleLayout
+        {
+                FragmentPerFrame,
+                BasicOffsetTable,
+                ExtendedOffsetTable,
+                NoOffsetTable
+        };
+
+        using isis::tests::require;
+
+        void putImageAttributes(DcmDataset* ds, Uint16 size, int frames)
+        {
+                ds->putAndInsertString(DCM_SOPClassUID, UID_EnhancedCTImageStorage);
+                ds->putAndInsertString(DCM_SOPInstanceUID, "1.2.826.0.1.3680043.9.7433.9.1");
+                ds->putAndInsertString(DCM_PatientName, "Frame^Source");
+                ds->putAndInsertString(DCM_PatientID, "FRAME001");
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertString(DCM_NumberOfFrames, std::to_string(frames).c_str());
+                ds->putAndInsertUint16(DCM_Rows, size);
+                ds->putAndInsertUint16(DCM_Columns, size);
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                ds->putAndInsertUint16(DCM_BitsStored, 16);
+                ds->putAndInsertUint16(DCM_HighBit, 15);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+        }
+
+        Uint16 largePixel(int frame, int x)
+        {
+                return static_cast<Uint16>((frame + x) % 4096);
+        }
+
+        // Frame i lies at z = LargeFrames - 1 - i and has intercept -i
+        void writeLargeObject(const std::filesystem::path& path)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                putImageAttributes(ds, LargeSize, LargeFrames);
+
+                DcmItem* shared = nullptr;
+                DcmItem* orientation = nullptr;
+                require(ds->findOrCreateSequenceItem(DCM_SharedFunctionalGroupsSequence, shared).good()
+                        && shared->findOrCreateSequenceItem(DCM_PlaneOrientationSequence, orientation).good(),
+                        "Could not create the shared functional groups.");
+                orientation->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+
+                for (int i = 0; i < LargeFrames; ++i)
+                {
+                        DcmItem* frame = nullptr;
+                        DcmItem* position = nullptr;
+                        DcmItem* transformation = nullptr;
+                        require(ds->findOrCreateSequenceItem(DCM_PerFrameFunctionalGroupsSequence, frame, -2).good()
+                                && frame->findOrCreateSequenceItem(DCM_PlanePositionSequence, position).good()
+                                && frame->findOrCreateSequenceItem(DCM_PixelValueTransformationSequence, transformation).good(),
+                                "Could not create a frame item.");
+                        position->putAndInsertString(DCM_ImagePositionPatient,
+                                ("0\\0\\" + std::to_string(LargeFrames - 1 - i)).c_str());
+                        transformation->putAndInsertString(DCM_RescaleIntercept, std::to_string(-i).c_str());
+                        transformation->putAndInsertString(DCM_RescaleSlope, "1");
+                }
+
+                std::vector<Uint16> pixels(static_cast<std::size_t>(LargeSize) * LargeSize * LargeFrames);
+                for (int i = 0; i < LargeFrames; ++i)
+                {
+                        for (int pixel = 0; pixel < LargeSize * LargeSize; ++pixel)
+                        {
+                                pixels[static_cast<std::size_t>(i) * LargeSize * LargeSize + pixel] =
+                                        largePixel(i, pixel % LargeSize);
+                        }
+                }
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit);
+                require(cond.good(), std::string("Failed to write the large object: ") + cond.text());
+        }
+
+        Uint16 rlePixel(int frame, int pixel)
+        {
+                return static_cast<Uint16>(frame * 1000 + pixel);
+        }
+
+        // PackBits literal runs of 128 bytes; every plane of a 16x16 frame is two runs
+        void appendLiteral(std::vector<Uint8>& out, const std::vector<Uint8>& plane)
+        {
+                for (std::size_t start = 0; start < plane.size(); start += 128)
+                {
+                        const std::size_t count = std::min<std::size_t>(128, plane.size() - start);
+                        out.push_back(static_cast<Uint8>(count - 1));
+                        out.insert(out.end(), plane.begin() + start, plane.begin() + start + count);
+                }
+        }
+
+        void putUint32(std::vector<Uint8>& out, std::size_t position, Uint32 value)
+        {
+                for (int byte = 0; byte < 4; ++byte)
+                {
+                        out[position + byte] = static_cast<Uint8>(value >> (8 * byte));
+                }
+        }
+
+        // RLE frame: 64-byte header, then the high and low byte planes
+        std::vector<Uint8> encodeRleFrame(int frame, std::size_t& secondSegment)
+        {
+                std::vector<Uint8> high;
+                std::vector<Uint8> low;
+                for (int pixel = 0; pixel < RleSize * RleSize; ++pixel)
+                {
+                        high.push_back(static_cast<Uint8>(rlePixel(frame, pixel) >> 8));
+                        low.push_back(static_cast<Uint8>(rlePixel(frame, pixel) & 0xFF));
+                }
+                std::vector<Uint8> encoded(64, 0);
+                appendLiteral(encoded, high);
+                secondSegment = encoded.size();
+                appendLiteral(encoded, low);
+                putUint32(encoded, 0, 2);
+                putUint32(encoded, 4, 64);
+                putUint32(encoded, 8, static_cast<Uint32>(secondSegment));
+                return encoded;
+        }
+
+        DcmPixelItem* makeItem(const Uint8* data, std::size_t length)
+        {
+                auto* item = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+                if (length > 0)
+                {
+                        item->putUint8Array(data, static_cast<unsigned long>(length));
+                }
+                return item;
+        }
+
+        void writeRleObject(const std::filesystem::path& path, RleLayout layout)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                putImageAttributes(ds, RleSize, RleFrames);
+
+                std::vector<std::vector<Uint8>> fragments;
+                std::vector<Uint64> frameOffsets;
+                Uint64 position = 0;
+                for (int frame = 0; frame < RleFrames; ++frame)
+                {
+                        std::size_t split = 0;
+                        const std::vector<Uint8> encoded = encodeRleFrame(frame, split);
+                        frameOffsets.push_back(position);
+                        if (layout == RleLayout::FragmentPerFrame)
+                        {
+                                fragments.push_back(encoded);
+                        }
+                        else
+                        {
+                                fragments.emplace_back(encoded.begin(), encoded.begin() + split);
+                                fragments.emplace_back(encoded.begin() + split, encoded.end());
+                        }
+                        // Offsets count from the first fragment item, item headers included
+                        position = 0;
+                        for (const auto& fragment : fragments)
+                        {
+                                position += 8 + fragment.size();
+                        }
+                }
+
+                std::vector<Uint8> basicTable;
+                if (layout == RleLayout::BasicOffsetTable)
+                {
+                        basicTable.resize(frameOffsets.size() * 4);
+                        for (std::size_t frame = 0; frame < frameOffsets.size(); ++frame)
+                        {
+                                putUint32(basicTable, frame * 4, static_cast<Uint32>(frameOffsets[frame]));
+                        }
+                }
+                if (layout == RleLayout::ExtendedOffsetTable)
+                {
+                        std::vector<Uint8> extendedTable(frameOffsets.size() * 8, 0);
+                        for (std::size_t frame = 0; frame < frameOffsets.size(); ++frame)
+                        {
+                                for (int byte = 0; byte < 8; ++byte)
+                                {
+                                        extendedTable[frame * 8 + byte] = static_cast<Uint8>(frameOffsets[frame] >> (8 * byte));
+                                }
+                        }
+                        ds->putAndInsertUint8Array(DCM_ExtendedOffsetTable, extendedTable.data(),
+                                static_cast<unsigned long>(extendedTable.size()));
+                }
+
+                auto* sequence = new DcmPixelSequence(DcmTag(DCM_PixelSequenceTag));
+                sequence->insert(makeItem(basicTable.data(), basicTable.size()));
+                for (const auto& fragment : fragments)
+                {
+                        sequence->insert(makeItem(fragment.data(), fragment.size()));
+                }
+                auto* pixelData = new DcmPixelData(DCM_PixelData);
+                pixelData->putOriginalRepresentation(EXS_RLELossless, nullptr, sequence);
+                require(ds->insert(pixelData, true).good(), "Could not insert the RLE pixel data.");
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_RLELossless);
+                require(cond.good(), std::string("Failed to write the RLE object: ") + cond.text());
+        }
+
+        std::vector<Uint16> readFrame(const isis::core::DicomFrameSource& source, int frame)
+        {
+                std::vector<Uint16> pixels(source.frameByteCount() / sizeof(Uint16));
+                source.readFrame(frame, reinterpret_cast<char*>(pixels.data()));
+                return pixels;
+        }
+
+        void checkLargeObject(const std::filesystem::path& path)
+        {
+                using Clock = std::chrono::steady_clock;
+                const auto started = Clock::now();
+                const auto source = isis::core::DicomFrameSource::open(path.string());
+                require(source != nullptr, "Large native object was not opened frame by frame.");
+                const std::vector<Uint16> first = readFrame(*source, 0);
+                const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started);
+                require(elapsed.count() < 200,
+                        "First frame of the large object took " + std::to_string(elapsed.count()) + " ms.");
+
+                require(source->frameCount() == LargeFrames && !source->isEncapsulated(),
+                        "Large object frames were not located.");
+                require(first[5] == largePixel(0, 5), "First frame has wrong pixels.");
+                const std::vector<Uint16> last = readFrame(*source, LargeFrames - 1);
+                require(last[LargeSize + 7] == largePixel(LargeFrames - 1, 7), "Last frame has wrong pixels.");
+
+                const auto& info = source->frameInfo(1234);
+                require(info.HasPosition && info.Position[2] == LargeFrames - 1 - 1234,
+                        "Per-frame position was not read.");
+                require(source->pixelInfo(1234).RescaleIntercept == -1234.0,
+                        "Per-frame rescale intercept was not applied.");
+                require(source->header()->PixelInfo.RescaleIntercept == 0.0 && !source->header()->ImageData,
+                        "Header does not describe the first frame only.");
+
+                const std::vector<int> order = source->spatialOrder();
+                require(order.size() == static_cast<std::size_t>(LargeFrames)
+                        && order.front() == LargeFrames - 1 && order.back() == 0,
+                        "Frames are not sorted along the slice normal.");
+        }
+
+        void checkRleObject(const std::filesystem::path& path, RleLayout layout, const std::string& name)
+        {
+                writeRleObject(path, layout);
+                const auto source = isis::core::DicomFrameSource::open(path.string());
+                require(source != nullptr, name + ": frames were not located.");
+                require(source->isEncapsulated() && source->frameCount() == RleFrames, name + ": wrong frame count.");
+                for (const int frame : {2, 0, 1})
+                {
+                        const std::vector<Uint16> pixels = readFrame(*source, frame);
+                        require(pixels[0] == rlePixel(frame, 0) && pixels[255] == rlePixel(frame, 255),
+                                name + ": frame " + std::to_string(frame) + " decoded wrongly.");
+                }
+        }
+
+        void checkFragmentMapping()
+        {
+                using isis::core::DicomFrameSource;
+                const std::vector<std::uint64_t> positions = {0, 100, 250, 300, 420, 500};
+
+                auto starts = DicomFrameSource::mapFramesToFragments(positions, {0, 250, 420}, {}, 3);
+                require(starts == std::vector<std::size_t>({0, 2, 4, 6}), "Offset table was not followed.");
+
+                starts = DicomFrameSource::mapFramesToFragments(positions, {0, 260, 420}, {}, 3);
+                require(starts.empty(), "Offset between fragments was accepted.");
+
+                starts = DicomFrameSource::mapFramesToFragments(positions, {}, {}, 6);
+                require(starts == std::vector<std::size_t>({0, 1, 2, 3, 4, 5, 6}), "One fragment per frame not assumed.");
+
+                starts = DicomFrameSource::mapFramesToFragments(positions, {}, {}, 1);
+                require(starts == std::vector<std::size_t>({0, 6}), "Single frame does not span all fragments.");
+
+                const std::vector<bool> codestreams = {true, false, false, true, true, false};
+                starts = DicomFrameSource::mapFramesToFragments(positions, {}, codestreams, 3);
+                require(starts == std::vector<std::size_t>({0, 3, 4, 6}), "Codestream starts were not used.");
+
+                starts = DicomFrameSource::mapFramesToFragments(positions, {}, codestreams, 2);
+                require(starts.empty(), "Codestream starts accepted for the wrong frame count.");
+
+                starts = DicomFrameSource::mapFramesToFragments(positions, {}, {}, 3);
+                require(starts.empty(), "Fragments were assigned without any table.");
+
+                starts = DicomFrameSource::mapFramesToFragments({0, 10}, {}, {}, 3);
+                require(starts.empty(), "Fewer fragments than frames were accepted.");
+        }
+}
+
+int main()
+{
+        try
+        {
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_frame_source";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                checkFragmentMapping();
+
+                const auto largePath = tempRoot / "enhanced_ct.dcm";
+                writeLargeObject(largePath);
+                checkLargeObject(largePath);
+
+                checkRleObject(tempRoot / "rle_fragment_per_frame.dcm", RleLayout::FragmentPerFrame, "RLE one fragment per frame");
+                checkRleObject(tempRoot / "rle_basic_table.dcm", RleLayout::BasicOffsetTable, "RLE Basic Offset Table");
+                checkRleObject(tempRoot / "rle_extended_table.dcm", RleLayout::ExtendedOffsetTable, "RLE Extended Offset Table");
+                checkRleObject(tempRoot / "rle_no_table.dcm", RleLayout::NoOffsetTable, "RLE codestream starts");
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dicomframesource_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dicomframesource_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomparalleldecoder_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks that JPEG 2000, JPEG-LS and RLE slice series decoded on several
+ *      threads are bit-exact against one vtkGDCMImageReader2 over the series,
+ *      also when slices carry another rescale than the first.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/dicomparalleldecoder.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <gdcmImageChangeTransferSyntax.h>
+#include <gdcmImageReader.h>
+#include <gdcmImageWriter.h>
+
+#include <vtkGDCMImageReader2.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int SliceCount = 13;
+        constexpr Uint16 Columns = 64;
+        constexpr Uint16 Rows = 48;
+
+        using isis::tests::require;
+
+        Uint16 pixelValue(int slice, int x, int y)
+        {
+                return static_cast<Uint16>((slice * 97 + x * 13 + y * 7) % 3000);
+        }
+
+        void writeNativeSlice(const std::filesystem::path& path, int slice, const char* intercept)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                ds->putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage);
+                ds->putAndInsertString(DCM_SOPInstanceUID,
+                        ("1.2.826.0.1.3680043.9.7433.10.1." + std::to_string(slice + 1)).c_str());
+                ds->putAndInsertString(DCM_SeriesInstanceUID, "1.2.826.0.1.3680043.9.7433.10.2");
+                ds->putAndInsertString(DCM_PatientName, "Parallel^Decode");
+                ds->putAndInsertString(DCM_PatientID, "DECODE001");
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertString(DCM_InstanceNumber, std::to_string(slice + 1).c_str());
+                ds->putAndInsertString(DCM_ImagePositionPatient, ("0\\0\\" + std::to_string(slice * 2)).c_str());
+                ds->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+                ds->putAndInsertString(DCM_PixelSpacing, "0.5\\0.5");
+                ds->putAndInsertString(DCM_SliceThickness, "2");
+                ds->putAndInsertString(DCM_RescaleIntercept, intercept);
+                ds->putAndInsertString(DCM_RescaleSlope, "1");
+                ds->putAndInsertUint16(DCM_Rows, Rows);
+                ds->putAndInsertUint16(DCM_Columns, Columns);
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                ds->putAndInsertUint16(DCM_BitsStored, 12);
+                ds->putAndInsertUint16(DCM_HighBit, 11);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                std::vector<Uint16> pixels(static_cast<std::size_t>(Columns) * Rows);
+                for (int y = 0; y < Rows; ++y)
+                {
+                        for (int x = 0; x < Columns; ++x)
+                        {
+                                pixels[static_cast<std::size_t>(y) * Columns + x] = pixelValue(slice, x, y);
+                        }
+                }
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit);
+                require(cond.good(), std::string("Failed to write test slice: ") + cond.text());
+        }
+
+        void compress(const std::filesystem::path& path, const gdcm::TransferSyntax& transferSyntax)
+        {
+                gdcm::ImageReader reader;
+                reader.SetFileName(path.string().c_str());
+                require(reader.Read(), "Could not read " + path.string());
+
+                gdcm::ImageChangeTransferSyntax change;
+                change.SetTransferSyntax(transferSyntax);
+                change.SetInput(reader.GetImage());
+                require(change.Change(), std::string("Could not compress to ") + transferSyntax.GetString());
+
+                gdcm::ImageWriter writer;
+                writer.SetFileName(path.string().c_str());
+                writer.SetFile(reader.GetFile());
+                writer.SetImage(change.GetOutput());
+                require(writer.Write(), "Could not write " + path.string());
+        }
+
+        std::vector<std::string> writeSeries(const std::filesystem::path& folder,
+                const gdcm::TransferSyntax& transferSyntax, bool varyingRescale)
+        {
+                std::filesystem::create_directories(folder);
+                std::vector<std::string> paths;
+                for (int slice = 0; slice < SliceCount; ++slice)
+                {
+                        const auto path = folder / ("slice" + std::to_string(slice) + ".dcm");
+                        writeNativeSlice(path, slice, (varyingRescale && slice > 0) ? "-1000" : "-1024");
+                        compress(path, transferSyntax);
+                        paths.push_back(path.string());
+                }
+                return paths;
+        }
+
+        vtkSmartPointer<vtkGDCMImageReader2> makeReader(const std::vector<std::string>& paths)
+        {
+                vtkNew<vtkStringArray> names;
+                for (const auto& path : paths)
+                {
+                        names->InsertNextValue(path.c_str());
+                }
+                auto reader = vtkSmartPointer<vtkGDCMImageReader2>::New();
+                reader->SetFileNames(names);
+                return reader;
+        }
+
+        std::size_t scalarBytes(vtkImageData* image)
+        {
+                int dimensions[3] = {0, 0, 0};
+                image->GetDimensions(dimensions);
+                return static_cast<std::size_t>(dimensions[0]) * dimensions[1] * dimensions[2]
+                        * image->GetScalarSize() * image->GetNumberOfScalarComponents();
+        }
+
+        void checkBitExact(const std::filesystem::path& folder, const gdcm::TransferSyntax& transferSyntax,
+                bool varyingRescale = false)
+        {
+                const std::string name = std::string(transferSyntax.GetString()) + (varyingRescale ? " varying rescale" : "");
+                const auto paths = writeSeries(folder, transferSyntax, varyingRescale);
+
+                auto serial = makeReader(paths);
+                serial->Update();
+                vtkImageData* expected = serial->GetOutput();
+
+                auto reference = makeReader(paths);
+                reference->UpdateInformation();
+                isis::core::DicomParallelDecoder::Options options;
+                options.Threads = 4;
+                const isis::core::DicomParallelDecoder decoder(options);
+                const auto decoded = decoder.decodeSeries(paths, reference);
+                require(decoded != nullptr, name + ": series was not decoded in parallel.");
+
+                int expectedExtent[6] = {};
+                int decodedExtent[6] = {};
+                expected->GetExtent(expectedExtent);
+                decoded->GetExtent(decodedExtent);
+                require(std::memcmp(expectedExtent, decodedExtent, sizeof(expectedExtent)) == 0,
+                        name + ": extent differs from the single reader.");
+                require(decoded->GetScalarType() == expected->GetScalarType()
+                        && decoded->GetNumberOfScalarComponents() == expected->GetNumberOfScalarComponents(),
+                        name + ": scalar type differs from the single reader.");
+                require(decoded->GetSpacing()[0] == expected->GetSpacing()[0]
+                        && decoded->GetOrigin()[2] == expected->GetOrigin()[2],
+                        name + ": geometry differs from the single reader.");
+                require(std::memcmp(decoded->GetScalarPointer(), expected->GetScalarPointer(), scalarBytes(expected)) == 0,
+                        name + ": voxels differ from the single reader.");
+        }
+}
+
+int main()
+{
+        try
+        {
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_parallel_decode";
+                std::filesystem::remove_all(tempRoot);
+
+                checkBitExact(tempRoot / "j2k", gdcm::TransferSyntax::JPEG2000Lossless);
+                checkBitExact(tempRoot / "jpegls", gdcm::TransferSyntax::JPEGLSLossless);
+                checkBitExact(tempRoot / "rle", gdcm::TransferSyntax::RLELossless);
+
+                // One reader converts every slice with the rescale of the first one
+                checkBitExact(tempRoot / "varying", gdcm::TransferSyntax::RLELossless, true);
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dicomparalleldecoder_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dicomparalleldecoder_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomtagmodel_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for the properties dialog models: sequences are only
+ *      expanded on fetchMore(), pixel data is shown as its size without being
+ *      read, search reaches into unexpanded sequences, and the series diff keeps
+ *      only the attributes that change between instances.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/gui/dialogs/dicomtagmodel.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <QCoreApplication>
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr Uint16 ImageSize = 256;
+        constexpr int FrameGroups = 500;
+
+        using isis::tests::require;
+
+        void writeInstance(const std::filesystem::path& path, int instanceNumber)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                ds->putAndInsertString(DCM_SOPClassUID, UID_EnhancedCTImageStorage);
+                ds->putAndInsertString(DCM_SOPInstanceUID,
+                                       ("1.2.826.0.1.3680043.9.7433.8.1." + std::to_string(instanceNumber)).c_str());
+                ds->putAndInsertString(DCM_PatientName, "Tag^Browser");
+                ds->putAndInsertString(DCM_PatientID, "TAG001");
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertString(DCM_InstanceNumber, std::to_string(instanceNumber).c_str());
+
+                // Per-frame functional groups: many items, each with a nested sequence
+                for (int i = 0; i < FrameGroups; ++i)
+                {
+                        DcmItem* frame = nullptr;
+                        require(ds->findOrCreateSequenceItem(DCM_PerFrameFunctionalGroupsSequence, frame, -2).good(),
+                                "Could not create a frame item.");
+                        DcmItem* position = nullptr;
+                        require(frame->findOrCreateSequenceItem(DCM_PlanePositionSequence, position).good(),
+                                "Could not create a plane position item.");
+                        const std::string z = i == FrameGroups - 1 ? "NEEDLE" : std::to_string(i * 2.5 + instanceNumber);
+                        position->putAndInsertString(DCM_ImagePositionPatient, ("0\\0\\" + z).c_str());
+                }
+
+                ds->putAndInsertUint16(DCM_Rows, ImageSize);
+                ds->putAndInsertUint16(DCM_Columns, ImageSize);
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                std::vector<Uint16> pixels(ImageSize * ImageSize, 1000);
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(),
+                                            static_cast<unsigned long>(pixels.size()));
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit);
+                require(cond.good(), std::string("Failed to write test instance: ") + cond.text());
+        }
+
+        QModelIndex findTopLevel(const isis::gui::dialogs::DicomTagModel& model, const QString& tag)
+        {
+                for (int row = 0; row < model.rowCount(); ++row)
+                {
+                        const QModelIndex index = model.index(row, isis::gui::dialogs::DicomTagModel::TagColumn);
+                        if (index.data().toString() == tag)
+                        {
+                                return index;
+                        }
+                }
+                return QModelIndex();
+        }
+}
+
+int main()
+{
+        using namespace isis::gui::dialogs;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dicomtagmodel_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_tag_model";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                std::vector<std::string> paths;
+                for (int i = 1; i <= 3; ++i)
+                {
+                        const auto path = tempRoot / ("instance" + std::to_string(i) + ".dcm");
+                        writeInstance(path, i);
+                        paths.push_back(path.string());
+                }
+
+                DicomTagModel model;
+                QString error;
+                require(model.loadFile(QString::fromStdString(paths.front()), error),
+                        "File did not load: " + error.toStdString());
+
+                // Top level lists meta header and dataset; sequences are not expanded up front
+                const QModelIndex frames = findTopLevel(model, "(5200,9230)");
+                require(frames.isValid(), "Per-frame sequence missing from the top level.");
+                require(findTopLevel(model, "(0002,0010)").isValid(), "Meta header missing from the top level.");
+                require(model.hasChildren(frames), "Sequence reports no children.");
+                require(model.rowCount(frames) == 0, "Sequence was expanded before fetchMore().");
+                require(model.canFetchMore(frames), "Sequence cannot be fetched.");
+                model.fetchMore(frames);
+                require(model.rowCount(frames) == FrameGroups, "Expanded sequence has the wrong number of items.");
+                require(model.index(0, DicomTagModel::TagColumn, frames).data().toString() == "Item 1",
+                        "Sequence item is not labelled.");
+
+                // Pixel data is shown as its size and stays in the file
+                const QModelIndex pixels = findTopLevel(model, "(7FE0,0010)");
+                require(pixels.isValid(), "Pixel Data missing.");
+                const QString pixelValue = model.index(pixels.row(), DicomTagModel::ValueColumn).data().toString();
+                require(pixelValue == QString("<%1 bytes>").arg(ImageSize * ImageSize * 2),
+                        "Pixel Data is not shown as its size: " + pixelValue.toStdString());
+
+                // Search reaches the last frame, fetching only its parents
+                DicomTagModel fresh;
+                require(fresh.loadFile(QString::fromStdString(paths.front()), error), "File did not reload.");
+                require(!fresh.findNext("needle").isValid(), "Search ran without an index.");
+                fresh.setSearchIndex(std::make_shared<const DicomTagSearchIndex>(
+                        buildTagSearchIndex(QString::fromStdString(paths.back()))));
+                require(!fresh.hasSearchIndex(), "Index of another file was accepted.");
+                fresh.setSearchIndex(std::make_shared<const DicomTagSearchIndex>(
+                        buildTagSearchIndex(QString::fromStdString(paths.front()))));
+                require(fresh.hasSearchIndex(), "Search index was not set.");
+                const QModelIndex needle = fresh.findNext("needle");
+                require(needle.isValid(), "Value inside an unexpanded sequence was not found.");
+                require(needle.data().toString() == "(0020,0032)", "Search matched the wrong element.");
+                const QModelIndex planeItem = needle.parent();
+                const QModelIndex planeSequence = planeItem.parent();
+                const QModelIndex frameItem = planeSequence.parent();
+                require(frameItem.row() == FrameGroups - 1, "Match is not in the last frame.");
+                require(fresh.findNext("needle", needle) == needle, "Search did not wrap around to the only match.");
+                require(fresh.findNext("PATIENTNAME").data().toString() == "(0010,0010)",
+                        "Search by name is case sensitive.");
+                require(!fresh.findNext("no such text").isValid(), "Search matched missing text.");
+
+                // Editable tags are recorded without touching the file
+                const QModelIndex name = model.index(findTopLevel(model, "(0010,0010)").row(), DicomTagModel::ValueColumn);
+                require(model.flags(name) & Qt::ItemIsEditable, "Patient Name is not editable.");
+                require(model.setData(name, "Edited^Name", Qt::EditRole), "Edit was rejected.");
+                require(model.modifiedTags().value("0010,0010") == "Edited^Name", "Edit was not recorded.");
+                require(name.data().toString() == "Edited^Name", "Edited value is not shown.");
+                const QModelIndex modality = model.index(findTopLevel(model, "(0008,0060)").row(), DicomTagModel::ValueColumn);
+                require(!(model.flags(modality) & Qt::ItemIsEditable), "Modality is editable.");
+
+                // Only the attributes that change between instances are kept
+                std::atomic<bool> cancel{false};
+                const SeriesTagDiff diff = computeSeriesTagDiff(paths, cancel);
+                require(diff.instances.size() == 3 && diff.errors.isEmpty(), "Not every instance was compared.");
+
+                QStringList differing;
+                for (const auto& attribute : diff.attributes)
+                {
+                        require(attribute.values.size() == 3, "Attribute does not have one value per instance.");
+                        differing.append(attribute.path);
+                }
+                require(differing.contains("(0008,0018)") && differing.contains("(0020,0013)"),
+                        "Differing top-level attributes are missing.");
+                require(differing.contains("(5200,9230)[1].(0020,9113)[1].(0020,0032)"),
+                        "Differing nested attribute is missing.");
+                require(!differing.contains("(5200,9230)[500].(0020,9113)[1].(0020,0032)"),
+                        "Identical nested attribute was reported.");
+                require(!differing.contains("(0010,0010)") && !differing.contains("(7FE0,0010)"),
+                        "Identical attributes were reported.");
+
+                SeriesTagDiffModel diffModel;
+                diffModel.setDiff(diff);
+                require(diffModel.rowCount() == 3 && diffModel.columnCount() == static_cast<int>(diff.attributes.size()) + 1,
+                        "Diff table has the wrong shape.");
+
+                cancel = true;
+                require(computeSeriesTagDiff(paths, cancel).instances.isEmpty(), "Cancelled diff kept running.");
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dicomtagmodel_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dicomtagmodel_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dicomvolumecache_compression_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks that slice compression is lossless for integer, rescaled and
+ *      multi-component volumes with random access to single slices, and that
+ *      the volume cache keeps three CT-sized series resident in the memory of
+ *      one by compressing the series nobody holds into new volumes.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/compressedimagedata.h"
+#include "src/core/dicomvolumecache.h"
+#include "tests/testsupport.h"
+
+#include <vtkImageData.h>
+#include <vtkMatrix3x3.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int Width = 256;
+        constexpr int Height = 256;
+        constexpr int Slices = 64;
+
+        using isis::tests::require;
+
+        // Body in air with noisy soft tissue and bone, as rescaled CT values
+        double ctValue(int x, int y, int z, std::mt19937& random)
+        {
+                std::normal_distribution<double> noise(0.0, 12.0);
+                const double radius = std::hypot(x - Width / 2.0, y - Height / 2.0);
+                if (radius > Width * 0.45)
+                {
+                        return -1024.0;
+                }
+                const double tissue = radius > Width * 0.38 ? 700.0 + z : 40.0;
+                return std::round(tissue + noise(random));
+        }
+
+        vtkSmartPointer<vtkImageData> makeImage(int scalarType, int components, bool fractional = false)
+        {
+                auto image = vtkSmartPointer<vtkImageData>::New();
+                image->SetExtent(0, Width - 1, 0, Height - 1, 0, Slices - 1);
+                image->SetSpacing(0.7, 0.7, 2.5);
+                image->SetOrigin(-90.0, -80.0, 12.5);
+                image->SetDirectionMatrix(1, 0, 0, 0, 0, 1, 0, -1, 0);
+                image->AllocateScalars(scalarType, components);
+                image->GetPointData()->GetScalars()->SetName("Scalars");
+
+                std::mt19937 random(7);
+                vtkDataArray* const scalars = image->GetPointData()->GetScalars();
+                vtkIdType tuple = 0;
+                for (int z = 0; z < Slices; ++z)
+                {
+                        for (int y = 0; y < Height; ++y)
+                        {
+                                for (int x = 0; x < Width; ++x, ++tuple)
+                                {
+                                        for (int component = 0; component < components; ++component)
+                                        {
+                                                double value = ctValue(x, y, z, random);
+                                                if (scalarType == VTK_UNSIGNED_CHAR)
+                                                {
+                                                        value = std::fmod(std::abs(value) + component * 40.0, 256.0);
+                                                }
+                                                else if (fractional)
+                                                {
+                                                        value *= 0.37;
+                                                }
+                                                scalars->SetComponent(tuple, component, value);
+                                        }
+                                }
+                        }
+                }
+                return image;
+        }
+
+        std::size_t scalarBytes(vtkImageData* image)
+        {
+                return static_cast<std::size_t>(image->GetPointData()->GetScalars()->GetDataSize())
+                        * static_cast<std::size_t>(image->GetScalarSize());
+        }
+
+        bool sameImage(vtkImageData* expected, vtkImageData* actual)
+        {
+                int expectedExtent[6] = {};
+                int actualExtent[6] = {};
+                expected->GetExtent(expectedExtent);
+                actual->GetExtent(actualExtent);
+                return std::memcmp(expectedExtent, actualExtent, sizeof(expectedExtent)) == 0
+                        && expected->GetScalarType() == actual->GetScalarType()
+                        && expected->GetNumberOfScalarComponents() == actual->GetNumberOfScalarComponents()
+                        && std::memcmp(expected->GetSpacing(), actual->GetSpacing(), 3 * sizeof(double)) == 0
+                        && std::memcmp(expected->GetOrigin(), actual->GetOrigin(), 3 * sizeof(double)) == 0
+                        && std::memcmp(expected->GetDirectionMatrix()->GetData(),
+                                actual->GetDirectionMatrix()->GetData(), 9 * sizeof(double)) == 0
+                        && std::string(actual->GetPointData()->GetScalars()->GetName()) == "Scalars"
+                        && std::memcmp(expected->GetScalarPointer(), actual->GetScalarPointer(), scalarBytes(expected)) == 0;
+        }
+
+        void checkRoundTrip(const std::string& name, vtkImageData* image, double minimumRatio)
+        {
+                const auto compressed = isis::core::CompressedImageData::compress(image, 4);
+                require(compressed != nullptr, name + ": not compressed.");
+                const double ratio = static_cast<double>(compressed->expandedBytes())
+                        / static_cast<double>(compressed->compressedBytes());
+                require(ratio >= minimumRatio, name + ": compression ratio " + std::to_string(ratio) + " too low.");
+
+                const auto restored = compressed->decompress(4);
+                require(restored && sameImage(image, restored), name + ": decompressed volume differs.");
+
+                // Random access to one slice
+                std::vector<unsigned char> slice(compressed->sliceBytes());
+                const int index = Slices / 3;
+                require(compressed->decompressSlice(index, slice.data())
+                        && std::memcmp(slice.data(), static_cast<unsigned char*>(image->GetScalarPointer())
+                                + compressed->sliceBytes() * index, slice.size()) == 0,
+                        name + ": single slice differs.");
+                require(!compressed->decompressSlice(Slices, slice.data()), name + ": slice past the end decoded.");
+        }
+
+        void checkCache(const std::filesystem::path& folder)
+        {
+                auto& cache = isis::core::volumeCache();
+                const std::size_t seriesBytes = static_cast<std::size_t>(Width) * Height * Slices * sizeof(double);
+                // Room for one expanded series and a half
+                cache.setCapacityBytes(seriesBytes * 3 / 2);
+
+                std::vector<std::vector<std::string>> paths(3);
+                std::vector<vtkSmartPointer<vtkImageData>> originals(3);
+                int loads = 0;
+                const auto load = [&](int series)
+                {
+                        return cache.get("1.2.3", "1.2.3." + std::to_string(series), paths[series], [&, series]()
+                        {
+                                ++loads;
+                                auto volume = std::make_shared<isis::core::DicomVolume>();
+                                volume->ImageData = vtkSmartPointer<vtkImageData>::New();
+                                volume->ImageData->DeepCopy(originals[series]);
+                                return volume;
+                        });
+                };
+
+                for (int series = 0; series < 3; ++series)
+                {
+                        const auto path = folder / ("series" + std::to_string(series) + ".dcm");
+                        std::ofstream(path) << series;
+                        paths[series] = {path.string()};
+                        originals[series] = makeImage(VTK_DOUBLE, 1);
+                        originals[series]->GetPointData()->GetScalars()->SetComponent(0, 0, series);
+                        require(load(series) != nullptr, "Series not loaded.");
+                }
+                require(loads == 3, "Series loaded more than once.");
+                require(cache.residentBytes() <= seriesBytes * 3 / 2, "Cache grew past its capacity.");
+
+                // Compression swaps in a new volume and leaves the one handed out untouched
+                {
+                        const std::weak_ptr<isis::core::DicomVolume> watched = load(0);
+                        load(1);
+                        load(2);
+                        require(watched.expired(), "Compressed series kept its expanded volume alive.");
+                }
+
+                // All three stay resident: the inactive ones were compressed, not evicted
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                        for (int series = 0; series < 3; ++series)
+                        {
+                                const auto started = std::chrono::steady_clock::now();
+                                const auto volume = load(series);
+                                const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        std::chrono::steady_clock::now() - started);
+                                require(volume && volume->ImageData && sameImage(originals[series], volume->ImageData),
+                                        "Re-activated series differs from the loaded one.");
+                                std::cout << "series " << series << " re-activated in " << elapsed.count() << " ms\n";
+                        }
+                }
+                require(loads == 3, "A series was evicted and loaded again.");
+
+                // A series still held by a viewer is neither compressed nor changed
+                const auto held = load(0);
+                vtkImageData* const heldImage = held->ImageData;
+                load(1);
+                load(2);
+                require(held->ImageData == heldImage && sameImage(originals[0], heldImage),
+                        "A held series was compressed.");
+
+                cache.invalidateStudy("1.2.3");
+                require(cache.residentBytes() == 0, "Invalidated study still cached.");
+        }
+}
+
+int main()
+{
+        try
+        {
+                checkRoundTrip("rescaled CT", makeImage(VTK_DOUBLE, 1), 3.0);
+                checkRoundTrip("stored CT", makeImage(VTK_SHORT, 1), 1.5);
+                checkRoundTrip("RGB", makeImage(VTK_UNSIGNED_CHAR, 3), 1.0);
+
+                // Fractional values are kept raw and never lost
+                const auto fractional = makeImage(VTK_DOUBLE, 1, true);
+                const auto raw = isis::core::CompressedImageData::compress(fractional);
+                require(raw && sameImage(fractional, raw->decompress()), "Fractional volume differs.");
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_volume_cache_compression";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+                checkCache(tempRoot);
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dicomvolumecache_compression_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dicomvolumecache_compression_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,1106 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimse_loopback_benchmark.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      In-process DIMSE throughput benchmark and soak test. Starts DimseStorageSCP and
+ *      a minimal Study Root Q/R archive on loopback ports and drives the echo, query,
+ *      store and retrieve (C-MOVE and C-GET) services with synthetic objects.
+ *
+ *      Without arguments it runs one short cycle and fails if any object is lost, so
+ *      it doubles as a regression test. Options:
+ *          --count N               objects per transfer (default 20)
+ *          --size-kb K             pixel data per object (default 64)
+ *          --series S              series in the archive study (default 2)
+ *          --rounds R              query/echo repetitions per cycle (default 5)
+ *          --associations A        parallel associations for C-STORE (default 1)
+ *          --soak-minutes M        repeat cycles for M minutes and check for leaks
+ *          --max-rss-growth-mb X   allowed RSS growth after the first cycle (default 64)
+ *          --max-fd-growth F       allowed descriptor/handle growth (default 16)
+ *
+ *      Per-object latency of a transfer is the time from each C-STORE request
+ *      to its response, measured by the sender (the store service for C-STORE,
+ *      the loopback archive for C-MOVE and C-GET).
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseservices.h"
+#include "src/core/network/dimsestoragescp.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+#include <dcmtk/dcmnet/assoc.h>
+#include <dcmtk/dcmnet/dimse.h>
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+        constexpr int ScpPort = 11193;
+        constexpr int ArchivePort = 11194;
+        constexpr const char* ScpAE = "BENCH_SCP";
+        constexpr const char* ArchiveAE = "BENCH_ARCHIVE";
+        constexpr const char* ClientAE = "BENCH_SCU";
+        constexpr const char* ArchiveStudyUID = "1.2.826.0.1.3680043.9.7433.8.2";
+        constexpr const char* UploadStudyUID = "1.2.826.0.1.3680043.9.7433.8.1";
+
+        using Clock = std::chrono::steady_clock;
+
+        using isis::tests::require;
+
+        struct Options
+        {
+                int count = 20;
+                int sizeKb = 64;
+                int series = 2;
+                int rounds = 5;
+                int associations = 1;
+                double soakMinutes = 0.0;
+                double maxRssGrowthMb = 64.0;
+                long maxFdGrowth = 16;
+        };
+
+        Options parseOptions(int argc, char* argv[])
+        {
+                Options options;
+                for (int i = 1; i + 1 < argc; i += 2)
+                {
+                        const std::string name = argv[i];
+                        const std::string value = argv[i + 1];
+                        if (name == "--count") options.count = std::max(1, std::stoi(value));
+                        else if (name == "--size-kb") options.sizeKb = std::max(1, std::stoi(value));
+                        else if (name == "--series") options.series = std::max(1, std::stoi(value));
+                        else if (name == "--rounds") options.rounds = std::max(1, std::stoi(value));
+                        else if (name == "--associations") options.associations = std::max(1, std::stoi(value));
+                        else if (name == "--soak-minutes") options.soakMinutes = std::max(0.0, std::stod(value));
+                        else if (name == "--max-rss-growth-mb") options.maxRssGrowthMb = std::stod(value);
+                        else if (name == "--max-fd-growth") options.maxFdGrowth = std::stol(value);
+                        else throw std::runtime_error("Unknown option " + name);
+                }
+                return options;
+        }
+
+        // ---------------------------------------------------------------- objects
+
+        struct SyntheticObject
+        {
+                std::string seriesUID;
+                std::string sopInstanceUID;
+                std::unique_ptr<DcmDataset> dataset;
+        };
+
+        std::vector<SyntheticObject> makeObjects(const std::string& studyUID, const Options& options)
+        {
+                // 8-bit pixels, 1024 columns wide: one row per KB requested
+                const Uint16 columns = 1024;
+                const Uint16 rows = static_cast<Uint16>(std::min(options.sizeKb, 65535));
+                std::vector<Uint8> pixels(static_cast<std::size_t>(rows) * columns);
+
+                std::vector<SyntheticObject> objects;
+                objects.reserve(static_cast<std::size_t>(options.count));
+                for (int i = 0; i < options.count; ++i)
+                {
+                        const int series = i % options.series;
+                        SyntheticObject object;
+                        object.seriesUID = studyUID + "." + std::to_string(series + 1);
+                        object.sopInstanceUID = object.seriesUID + "." + std::to_string(i + 1);
+                        object.dataset = std::make_unique<DcmDataset>();
+
+                        DcmDataset* ds = object.dataset.get();
+                        ds->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+                        ds->putAndInsertString(DCM_SOPInstanceUID, object.sopInstanceUID.c_str());
+                        ds->putAndInsertString(DCM_StudyInstanceUID, studyUID.c_str());
+                        ds->putAndInsertString(DCM_SeriesInstanceUID, object.seriesUID.c_str());
+                        ds->putAndInsertString(DCM_PatientName, "Benchmark^Loopback");
+                        ds->putAndInsertString(DCM_PatientID, "BENCH");
+                        ds->putAndInsertString(DCM_StudyDate, "20250101");
+                        ds->putAndInsertString(DCM_Modality, "OT");
+                        ds->putAndInsertString(DCM_SeriesNumber, std::to_string(series + 1).c_str());
+                        ds->putAndInsertString(DCM_InstanceNumber, std::to_string(i + 1).c_str());
+                        ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                        ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                        ds->putAndInsertUint16(DCM_Rows, rows);
+                        ds->putAndInsertUint16(DCM_Columns, columns);
+                        ds->putAndInsertUint16(DCM_BitsAllocated, 8);
+                        ds->putAndInsertUint16(DCM_BitsStored, 8);
+                        ds->putAndInsertUint16(DCM_HighBit, 7);
+                        ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                        for (std::size_t p = 0; p < pixels.size(); ++p)
+                        {
+                                pixels[p] = static_cast<Uint8>((p * 7 + static_cast<std::size_t>(i) * 13) & 0xff);
+                        }
+                        ds->putAndInsertUint8Array(DCM_PixelData, pixels.data(),
+                                                   static_cast<unsigned long>(pixels.size()));
+                        objects.push_back(std::move(object));
+                }
+                return objects;
+        }
+
+        std::vector<std::string> writeObjects(const std::vector<SyntheticObject>& objects,
+                                              const std::filesystem::path& directory)
+        {
+                std::filesystem::create_directories(directory);
+                std::vector<std::string> paths;
+                for (const auto& object : objects)
+                {
+                        const auto path = (directory / (object.sopInstanceUID + ".dcm")).string();
+                        DcmFileFormat file(object.dataset.get());
+                        require(file.saveFile(path.c_str(), EXS_LittleEndianExplicit).good(),
+                                "Failed to write " + path);
+                        paths.push_back(path);
+                }
+                return paths;
+        }
+
+        // ---------------------------------------------------------------- archive
+
+        /**
+         * @brief Request-to-response times of C-STORE operations, from any thread
+         */
+        class LatencyRecorder
+        {
+        public:
+                void reset()
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_latenciesMs.clear();
+                }
+
+                void record(Clock::duration latency)
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_latenciesMs.push_back(std::chrono::duration<double, std::milli>(latency).count());
+                }
+
+                std::vector<double> latenciesMs() const
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        return m_latenciesMs;
+                }
+
+        private:
+                mutable std::mutex m_mutex;
+                std::vector<double> m_latenciesMs;
+        };
+
+        /**
+         * Minimal Study Root Q/R archive: C-ECHO, C-FIND at STUDY/SERIES/IMAGE level,
+         * C-MOVE to the benchmark SCP and C-GET on the same association. Every
+         * association is served on its own thread so pooled idle associations do not
+         * block new ones.
+         */
+        class LoopbackArchive
+        {
+        public:
+                explicit LoopbackArchive(const std::vector<SyntheticObject>& objects)
+                        : m_objects(objects)
+                {
+                }
+
+                ~LoopbackArchive() { stop(); }
+
+                // C-STORE sub-operations sent for C-MOVE and C-GET
+                LatencyRecorder& storeLatencies() { return m_storeLatencies; }
+
+                bool start()
+                {
+                        if (ASC_initializeNetwork(NET_ACCEPTOR, ArchivePort, 30, &m_network).bad() ||
+                            ASC_initializeNetwork(NET_REQUESTOR, 0, 30, &m_requestorNetwork).bad())
+                        {
+                                return false;
+                        }
+                        m_acceptThread = std::thread([this]() { run(); });
+                        return true;
+                }
+
+                void stop()
+                {
+                        m_stop = true;
+                        if (m_acceptThread.joinable())
+                        {
+                                m_acceptThread.join();
+                        }
+                        {
+                                std::lock_guard<std::mutex> lock(m_sessionsMutex);
+                                for (auto& session : m_sessions)
+                                {
+                                        if (session.joinable())
+                                        {
+                                                session.join();
+                                        }
+                                }
+                                m_sessions.clear();
+                        }
+                        if (m_network)
+                        {
+                                ASC_dropNetwork(&m_network);
+                        }
+                        if (m_requestorNetwork)
+                        {
+                                ASC_dropNetwork(&m_requestorNetwork);
+                        }
+                }
+
+        private:
+                void run()
+                {
+                        while (!m_stop)
+                        {
+                                T_ASC_Association* assoc = nullptr;
+                                OFCondition cond = ASC_receiveAssociation(m_network, &assoc, ASC_DEFAULTMAXPDU,
+                                                                          nullptr, nullptr, OFFalse, DUL_NOBLOCK, 1);
+                                if (cond.bad())
+                                {
+                                        if (assoc)
+                                        {
+                                                ASC_destroyAssociation(&assoc);
+                                        }
+                                        continue;
+                                }
+
+                                std::lock_guard<std::mutex> lock(m_sessionsMutex);
+                                m_sessions.emplace_back([this, assoc]() mutable {
+                                        acceptContexts(assoc);
+                                        if (ASC_acknowledgeAssociation(assoc).good())
+                                        {
+                                                serve(assoc);
+                                        }
+                                        ASC_dropSCPAssociation(assoc);
+                                        ASC_destroyAssociation(&assoc);
+                                });
+                        }
+                }
+
+                static void acceptContexts(T_ASC_Association* assoc)
+                {
+                        const char* transferSyntaxes[] = {
+                                UID_LittleEndianExplicitTransferSyntax,
+                                UID_LittleEndianImplicitTransferSyntax
+                        };
+                        const char* services[] = {
+                                UID_VerificationSOPClass,
+                                UID_FINDStudyRootQueryRetrieveInformationModel,
+                                UID_MOVEStudyRootQueryRetrieveInformationModel,
+                                UID_GETStudyRootQueryRetrieveInformationModel
+                        };
+                        ASC_acceptContextsWithPreferredTransferSyntaxes(assoc->params, services, 4,
+                                                                       transferSyntaxes, 2);
+
+                        // Storage contexts proposed with the SCP role carry C-GET sub-operations
+                        for (int i = 0; i < ASC_countPresentationContexts(assoc->params); ++i)
+                        {
+                                T_ASC_PresentationContext pc;
+                                ASC_getPresentationContext(assoc->params, i, &pc);
+                                const bool scpRole = pc.proposedRole == ASC_SC_ROLE_SCP ||
+                                                     pc.proposedRole == ASC_SC_ROLE_SCUSCP;
+                                if (dcmIsaStorageSOPClassUID(pc.abstractSyntax, ESSC_All) && scpRole)
+                                {
+                                        ASC_acceptPresentationContext(assoc->params, pc.presentationContextID,
+                                                                      UID_LittleEndianExplicitTransferSyntax,
+                                                                      ASC_SC_ROLE_SCP);
+                                }
+                        }
+                }
+
+                void serve(T_ASC_Association* assoc)
+                {
+                        while (!m_stop)
+                        {
+                                T_DIMSE_Message message;
+                                T_ASC_PresentationContextID presID = 0;
+                                OFCondition cond = DIMSE_receiveCommand(assoc, DIMSE_NONBLOCKING, 1,
+                                                                        &presID, &message, nullptr);
+                                if (cond == DIMSE_NODATAAVAILABLE)
+                                {
+                                        continue;
+                                }
+                                if (cond == DUL_PEERREQUESTEDRELEASE)
+                                {
+                                        ASC_acknowledgeRelease(assoc);
+                                        return;
+                                }
+                                if (cond.bad())
+                                {
+                                        return;
+                                }
+
+                                bool ok = true;
+                                switch (message.CommandField)
+                                {
+                                case DIMSE_C_ECHO_RQ:
+                                        ok = DIMSE_sendEchoResponse(assoc, presID, &message.msg.CEchoRQ,
+                                                                    STATUS_Success, nullptr).good();
+                                        break;
+                                case DIMSE_C_FIND_RQ:
+                                        ok = handleFind(assoc, presID, message.msg.CFindRQ);
+                                        break;
+                                case DIMSE_C_MOVE_RQ:
+                                        ok = handleMove(assoc, presID, message.msg.CMoveRQ);
+                                        break;
+                                case DIMSE_C_GET_RQ:
+                                        ok = handleGet(assoc, presID, message.msg.CGetRQ);
+                                        break;
+                                case DIMSE_C_CANCEL_RQ:
+                                        break;
+                                default:
+                                        ok = false;
+                                        break;
+                                }
+                                if (!ok)
+                                {
+                                        return;
+                                }
+                        }
+                }
+
+                bool receiveIdentifiers(T_ASC_Association* assoc, T_ASC_PresentationContextID presID,
+                                        std::string& level, std::string& seriesUID)
+                {
+                        DcmDataset* identifiers = nullptr;
+                        T_ASC_PresentationContextID dataPresID = presID;
+                        if (DIMSE_receiveDataSetInMemory(assoc, DIMSE_BLOCKING, 0, &dataPresID,
+                                                         &identifiers, nullptr, nullptr).bad())
+                        {
+                                return false;
+                        }
+                        OFString value;
+                        identifiers->findAndGetOFString(DCM_QueryRetrieveLevel, value);
+                        level = value.c_str();
+                        value.clear();
+                        identifiers->findAndGetOFString(DCM_SeriesInstanceUID, value);
+                        seriesUID = value.c_str();
+                        delete identifiers;
+                        return true;
+                }
+
+                std::vector<const SyntheticObject*> match(const std::string& seriesUID) const
+                {
+                        std::vector<const SyntheticObject*> matches;
+                        for (const auto& object : m_objects)
+                        {
+                                if (seriesUID.empty() || object.seriesUID == seriesUID)
+                                {
+                                        matches.push_back(&object);
+                                }
+                        }
+                        return matches;
+                }
+
+                bool handleFind(T_ASC_Association* assoc, T_ASC_PresentationContextID presID,
+                                T_DIMSE_C_FindRQ& request)
+                {
+                        std::string level;
+                        std::string seriesFilter;
+                        if (!receiveIdentifiers(assoc, presID, level, seriesFilter))
+                        {
+                                return false;
+                        }
+
+                        std::vector<std::unique_ptr<DcmDataset>> results;
+                        const auto addResult = [&](const SyntheticObject& object) {
+                                auto result = std::make_unique<DcmDataset>();
+                                result->putAndInsertString(DCM_QueryRetrieveLevel, level.c_str());
+                                result->putAndInsertString(DCM_StudyInstanceUID, ArchiveStudyUID);
+                                result->putAndInsertString(DCM_PatientName, "Benchmark^Loopback");
+                                result->putAndInsertString(DCM_PatientID, "BENCH");
+                                result->putAndInsertString(DCM_StudyDate, "20250101");
+                                result->putAndInsertString(DCM_ModalitiesInStudy, "OT");
+                                if (level != "STUDY")
+                                {
+                                        result->putAndInsertString(DCM_SeriesInstanceUID, object.seriesUID.c_str());
+                                        result->putAndInsertString(DCM_Modality, "OT");
+                                }
+                                if (level == "IMAGE")
+                                {
+                                        result->putAndInsertString(DCM_SOPInstanceUID, object.sopInstanceUID.c_str());
+                                        result->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+                                }
+                                results.push_back(std::move(result));
+                        };
+
+                        if (level == "STUDY")
+                        {
+                                addResult(m_objects.front());
+                        }
+                        else if (level == "SERIES")
+                        {
+                                std::vector<std::string> seen;
+                                for (const auto& object : m_objects)
+                                {
+                                        if (std::find(seen.begin(), seen.end(), object.seriesUID) == seen.end())
+                                        {
+                                                seen.push_back(object.seriesUID);
+                                                addResult(object);
+                                        }
+                                }
+                        }
+                        else
+                        {
+                                for (const auto* object : match(seriesFilter))
+                                {
+                                        addResult(*object);
+                                }
+                        }
+
+                        T_DIMSE_C_FindRSP response;
+                        std::memset(&response, 0, sizeof(response));
+                        response.MessageIDBeingRespondedTo = request.MessageID;
+                        OFStandard::strlcpy(response.AffectedSOPClassUID, request.AffectedSOPClassUID,
+                                            sizeof(response.AffectedSOPClassUID));
+                        response.opts = O_FIND_AFFECTEDSOPCLASSUID;
+
+                        for (auto& result : results)
+                        {
+                                response.DimseStatus = STATUS_Pending;
+                                if (DIMSE_sendFindResponse(assoc, presID, &request, &response,
+                                                           result.get(), nullptr).bad())
+                                {
+                                        return false;
+                                }
+                        }
+                        response.DimseStatus = STATUS_Success;
+                        return DIMSE_sendFindResponse(assoc, presID, &request, &response, nullptr, nullptr).good();
+                }
+
+                bool storeObject(T_ASC_Association* assoc, const SyntheticObject& object,
+                                 const char* moveOriginatorAE, DIC_US moveOriginatorID)
+                {
+                        const T_ASC_PresentationContextID presID =
+                                ASC_findAcceptedPresentationContextID(assoc, UID_SecondaryCaptureImageStorage);
+                        if (presID == 0)
+                        {
+                                return false;
+                        }
+
+                        T_DIMSE_C_StoreRQ request;
+                        std::memset(&request, 0, sizeof(request));
+                        request.MessageID = assoc->nextMsgID++;
+                        OFStandard::strlcpy(request.AffectedSOPClassUID, UID_SecondaryCaptureImageStorage,
+                                            sizeof(request.AffectedSOPClassUID));
+                        OFStandard::strlcpy(request.AffectedSOPInstanceUID, object.sopInstanceUID.c_str(),
+                                            sizeof(request.AffectedSOPInstanceUID));
+                        request.DataSetType = DIMSE_DATASET_PRESENT;
+                        request.Priority = DIMSE_PRIORITY_MEDIUM;
+                        if (moveOriginatorAE)
+                        {
+                                OFStandard::strlcpy(request.MoveOriginatorApplicationEntityTitle, moveOriginatorAE,
+                                                    sizeof(request.MoveOriginatorApplicationEntityTitle));
+                                request.MoveOriginatorID = moveOriginatorID;
+                                request.opts = O_STORE_MOVEORIGINATORAETITLE | O_STORE_MOVEORIGINATORID;
+                        }
+
+                        T_DIMSE_C_StoreRSP response;
+                        std::memset(&response, 0, sizeof(response));
+                        DcmDataset* statusDetail = nullptr;
+                        const auto started = Clock::now();
+                        const OFCondition cond = DIMSE_storeUser(assoc, presID, &request, nullptr,
+                                                                 object.dataset.get(), nullptr, nullptr,
+                                                                 DIMSE_BLOCKING, 0, &response, &statusDetail);
+                        m_storeLatencies.record(Clock::now() - started);
+                        delete statusDetail;
+                        return cond.good() && response.DimseStatus == STATUS_Success;
+                }
+
+                bool handleMove(T_ASC_Association* assoc, T_ASC_PresentationContextID presID,
+                                T_DIMSE_C_MoveRQ& request)
+                {
+                        std::string level;
+                        std::string seriesFilter;
+                        if (!receiveIdentifiers(assoc, presID, level, seriesFilter))
+                        {
+                                return false;
+                        }
+                        const auto matches = match(seriesFilter);
+
+                        T_DIMSE_C_MoveRSP response;
+                        std::memset(&response, 0, sizeof(response));
+                        response.MessageIDBeingRespondedTo = request.MessageID;
+                        OFStandard::strlcpy(response.AffectedSOPClassUID, request.AffectedSOPClassUID,
+                                            sizeof(response.AffectedSOPClassUID));
+                        response.DataSetType = DIMSE_DATASET_NULL;
+                        response.opts = O_MOVE_AFFECTEDSOPCLASSUID | O_MOVE_NUMBEROFCOMPLETEDSUBOPERATIONS |
+                                        O_MOVE_NUMBEROFFAILEDSUBOPERATIONS | O_MOVE_NUMBEROFWARNINGSUBOPERATIONS;
+
+                        // The only known destination is the Storage SCP under test
+                        T_ASC_Association* subAssoc = nullptr;
+                        if (std::string(request.MoveDestination) != ScpAE || !openSubAssociation(&subAssoc))
+                        {
+                                response.DimseStatus = STATUS_MOVE_Failed_MoveDestinationUnknown;
+                                return DIMSE_sendMoveResponse(assoc, presID, &request, &response,
+                                                              nullptr, nullptr).good();
+                        }
+
+                        const char* originator = assoc->params->DULparams.callingAPTitle;
+                        int completed = 0;
+                        int failed = 0;
+                        for (std::size_t i = 0; i < matches.size(); ++i)
+                        {
+                                if (storeObject(subAssoc, *matches[i], originator, request.MessageID))
+                                        ++completed;
+                                else
+                                        ++failed;
+
+                                const int remaining = static_cast<int>(matches.size() - i - 1);
+                                if (remaining > 0)
+                                {
+                                        response.DimseStatus = STATUS_Pending;
+                                        response.opts |= O_MOVE_NUMBEROFREMAININGSUBOPERATIONS;
+                                        response.NumberOfRemainingSubOperations = static_cast<DIC_US>(remaining);
+                                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                                        if (DIMSE_sendMoveResponse(assoc, presID, &request, &response,
+                                                                   nullptr, nullptr).bad())
+                                        {
+                                                break;
+                                        }
+                                }
+                        }
+
+                        ASC_releaseAssociation(subAssoc);
+                        ASC_destroyAssociation(&subAssoc);
+
+                        response.DimseStatus = failed == 0 ? STATUS_Success
+                                : STATUS_MOVE_Warning_SubOperationsCompleteOneOrMoreFailures;
+                        response.opts &= ~O_MOVE_NUMBEROFREMAININGSUBOPERATIONS;
+                        response.NumberOfRemainingSubOperations = 0;
+                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                        return DIMSE_sendMoveResponse(assoc, presID, &request, &response, nullptr, nullptr).good();
+                }
+
+                bool openSubAssociation(T_ASC_Association** subAssoc)
+                {
+                        T_ASC_Parameters* params = nullptr;
+                        if (ASC_createAssociationParameters(&params, ASC_DEFAULTMAXPDU).bad())
+                        {
+                                return false;
+                        }
+                        ASC_setAPTitles(params, ArchiveAE, ScpAE, nullptr);
+                        const std::string address = "127.0.0.1:" + std::to_string(ScpPort);
+                        ASC_setPresentationAddresses(params, "localhost", address.c_str());
+
+                        const char* transferSyntaxes[] = {
+                                UID_LittleEndianExplicitTransferSyntax,
+                                UID_LittleEndianImplicitTransferSyntax
+                        };
+                        ASC_addPresentationContext(params, 1, UID_SecondaryCaptureImageStorage,
+                                                   transferSyntaxes, 2);
+
+                        if (ASC_requestAssociation(m_requestorNetwork, params, subAssoc).bad())
+                        {
+                                if (*subAssoc)
+                                {
+                                        ASC_destroyAssociation(subAssoc);
+                                }
+                                else
+                                {
+                                        ASC_destroyAssociationParameters(&params);
+                                }
+                                return false;
+                        }
+                        return true;
+                }
+
+                bool handleGet(T_ASC_Association* assoc, T_ASC_PresentationContextID presID,
+                               T_DIMSE_C_GetRQ& request)
+                {
+                        std::string level;
+                        std::string seriesFilter;
+                        if (!receiveIdentifiers(assoc, presID, level, seriesFilter))
+                        {
+                                return false;
+                        }
+                        const auto matches = match(seriesFilter);
+
+                        T_DIMSE_C_GetRSP response;
+                        std::memset(&response, 0, sizeof(response));
+                        response.MessageIDBeingRespondedTo = request.MessageID;
+                        OFStandard::strlcpy(response.AffectedSOPClassUID, request.AffectedSOPClassUID,
+                                            sizeof(response.AffectedSOPClassUID));
+                        response.DataSetType = DIMSE_DATASET_NULL;
+                        response.opts = O_GET_AFFECTEDSOPCLASSUID | O_GET_NUMBEROFCOMPLETEDSUBOPERATIONS |
+                                        O_GET_NUMBEROFFAILEDSUBOPERATIONS | O_GET_NUMBEROFWARNINGSUBOPERATIONS;
+
+                        int completed = 0;
+                        int failed = 0;
+                        for (std::size_t i = 0; i < matches.size(); ++i)
+                        {
+                                if (storeObject(assoc, *matches[i], nullptr, 0))
+                                        ++completed;
+                                else
+                                        ++failed;
+
+                                const int remaining = static_cast<int>(matches.size() - i - 1);
+                                if (remaining > 0)
+                                {
+                                        response.DimseStatus = STATUS_Pending;
+                                        response.opts |= O_GET_NUMBEROFREMAININGSUBOPERATIONS;
+                                        response.NumberOfRemainingSubOperations = static_cast<DIC_US>(remaining);
+                                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                                        if (DIMSE_sendGetResponse(assoc, presID, &request, &response,
+                                                                  nullptr, nullptr).bad())
+                                        {
+                                                return false;
+                                        }
+                                }
+                        }
+
+                        response.DimseStatus = failed == 0 ? STATUS_Success
+                                : STATUS_GET_Warning_SubOperationsCompleteOneOrMoreFailures;
+                        response.opts &= ~O_GET_NUMBEROFREMAININGSUBOPERATIONS;
+                        response.NumberOfRemainingSubOperations = 0;
+                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                        return DIMSE_sendGetResponse(assoc, presID, &request, &response, nullptr, nullptr).good();
+                }
+
+                const std::vector<SyntheticObject>& m_objects;
+                T_ASC_Network* m_network = nullptr;
+                T_ASC_Network* m_requestorNetwork = nullptr;
+                std::thread m_acceptThread;
+                std::mutex m_sessionsMutex;
+                std::vector<std::thread> m_sessions;
+                std::atomic<bool> m_stop{false};
+                LatencyRecorder m_storeLatencies;
+        };
+
+        // ---------------------------------------------------------------- measurement
+
+        /**
+         * @brief Count and sizes of objects as they arrive at a receiver
+         */
+        class ArrivalRecorder
+        {
+        public:
+                void reset()
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_count = 0;
+                        m_bytes = 0;
+                }
+
+                void record(const std::string& path)
+                {
+                        std::error_code ec;
+                        const auto size = std::filesystem::file_size(path, ec);
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        ++m_count;
+                        m_bytes += ec ? 0 : static_cast<std::uint64_t>(size);
+                }
+
+                std::size_t count() const
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        return m_count;
+                }
+
+                std::uint64_t bytes() const
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        return m_bytes;
+                }
+
+        private:
+                mutable std::mutex m_mutex;
+                std::size_t m_count = 0;
+                std::uint64_t m_bytes = 0;
+        };
+
+        struct PhaseResult
+        {
+                std::string name;
+                std::size_t operations = 0;
+                std::uint64_t bytes = 0;
+                double seconds = 0.0;
+                std::vector<double> latenciesMs;
+                isis::core::network::LatencyHistogram latencyHistogram;     // Used instead when the service only reports buckets
+        };
+
+        double percentile(std::vector<double> values, double fraction)
+        {
+                if (values.empty())
+                {
+                        return 0.0;
+                }
+                std::sort(values.begin(), values.end());
+                const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+                return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+        }
+
+        double latencyPercentile(const PhaseResult& result, double fraction)
+        {
+                return result.latenciesMs.empty() ? result.latencyHistogram.percentile(fraction)
+                                                  : percentile(result.latenciesMs, fraction);
+        }
+
+        double elapsedSeconds(Clock::time_point start)
+        {
+                return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        void printResults(const std::vector<PhaseResult>& results)
+        {
+                std::cout << std::left << std::setw(26) << "phase"
+                          << std::right << std::setw(8) << "ops"
+                          << std::setw(12) << "ops/s"
+                          << std::setw(10) << "MB/s"
+                          << std::setw(11) << "p50 ms"
+                          << std::setw(11) << "p99 ms" << '\n';
+                for (const auto& result : results)
+                {
+                        const double seconds = std::max(result.seconds, 1e-9);
+                        std::cout << std::left << std::setw(26) << result.name
+                                  << std::right << std::setw(8) << result.operations
+                                  << std::fixed << std::setprecision(1)
+                                  << std::setw(12) << result.operations / seconds
+                                  << std::setw(10) << result.bytes / seconds / (1024.0 * 1024.0)
+                                  << std::setprecision(2)
+                                  << std::setw(11) << latencyPercentile(result, 0.50)
+                                  << std::setw(11) << latencyPercentile(result, 0.99) << '\n';
+                }
+                std::cout.unsetf(std::ios::fixed);
+        }
+
+        struct ResourceSample
+        {
+                long descriptors = 0;           // Open file descriptors (handles on Windows)
+                double rssMb = 0.0;
+        };
+
+        ResourceSample sampleResources()
+        {
+                ResourceSample sample;
+#ifdef _WIN32
+                DWORD handles = 0;
+                if (GetProcessHandleCount(GetCurrentProcess(), &handles))
+                {
+                        sample.descriptors = static_cast<long>(handles);
+                }
+                PROCESS_MEMORY_COUNTERS counters;
+                if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+                {
+                        sample.rssMb = counters.WorkingSetSize / (1024.0 * 1024.0);
+                }
+#else
+                std::error_code ec;
+                for (std::filesystem::directory_iterator it("/proc/self/fd", ec), end; !ec && it != end; it.increment(ec))
+                {
+                        ++sample.descriptors;
+                }
+                std::ifstream statm("/proc/self/statm");
+                long totalPages = 0;
+                long residentPages = 0;
+                if (statm >> totalPages >> residentPages)
+                {
+                        sample.rssMb = residentPages * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+                }
+#endif
+                return sample;
+        }
+
+        // ---------------------------------------------------------------- cycle
+
+        struct Harness
+        {
+                Options options;
+                std::filesystem::path root;
+                isis::core::network::DicomPeer scpPeer;
+                isis::core::network::DicomPeer archivePeer;
+                isis::core::network::LocalAEConfig client;
+                std::vector<std::string> uploadFiles;
+                std::size_t archiveObjects = 0;
+                std::size_t archiveSeries = 0;
+                ArrivalRecorder scpArrivals;
+                LatencyRecorder* archiveStoreLatencies = nullptr;
+        };
+
+        std::vector<PhaseResult> runCycle(Harness& harness)
+        {
+                using namespace isis::core::network;
+
+                std::vector<PhaseResult> results;
+                const int echoCount = harness.options.rounds * 4;
+
+                // Association setup: every echo negotiates, uses and releases a new association
+                {
+                        PhaseResult result{"C-ECHO (new association)"};
+                        const auto start = Clock::now();
+                        for (int i = 0; i < echoCount; ++i)
+                        {
+                                auto pool = std::make_shared<DimseConnectionPool>(1);
+                                DimseEchoService echo(pool, nullptr);
+                                const auto started = Clock::now();
+                                require(echo.performEcho(harness.archivePeer, harness.client, 10) == DimseStatus::Success,
+                                        "C-ECHO failed: " + echo.getLastError());
+                                pool->clear();
+                                result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+                                ++result.operations;
+                        }
+                        result.seconds = elapsedSeconds(start);
+                        results.push_back(std::move(result));
+                }
+
+                auto pool = std::make_shared<DimseConnectionPool>(static_cast<std::size_t>(harness.options.associations + 1));
+
+                // Pooled echo, for comparison with the setup cost above
+                {
+                        DimseEchoService echo(pool, nullptr);
+                        PhaseResult result{"C-ECHO (pooled)"};
+                        const auto start = Clock::now();
+                        for (int i = 0; i < echoCount; ++i)
+                        {
+                                const auto started = Clock::now();
+                                require(echo.performEcho(harness.archivePeer, harness.client, 10) == DimseStatus::Success,
+                                        "Pooled C-ECHO failed: " + echo.getLastError());
+                                result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+                                ++result.operations;
+                        }
+                        result.seconds = elapsedSeconds(start);
+                        results.push_back(std::move(result));
+                }
+
+                // C-STORE to the Storage SCP under test
+                {
+                        DimseStoreService store(pool, nullptr);
+                        store.setMaxAssociations(harness.options.associations);
+                        harness.scpArrivals.reset();
+                        const auto start = Clock::now();
+                        require(store.storeFiles(harness.scpPeer, harness.client, harness.uploadFiles) == DimseStatus::Success,
+                                "C-STORE failed: " + store.getLastError());
+                        PhaseResult result{"C-STORE"};
+                        result.seconds = elapsedSeconds(start);
+                        result.operations = harness.scpArrivals.count();
+                        result.bytes = harness.scpArrivals.bytes();
+                        for (const auto& stat : store.getAssociationStats())
+                        {
+                                result.latencyHistogram.merge(stat.latencies);
+                        }
+                        require(result.operations == harness.uploadFiles.size(), "C-STORE lost objects.");
+                        results.push_back(std::move(result));
+                }
+
+                // C-FIND at every level
+                {
+                        DimseQueryService query(pool, nullptr);
+                        PhaseResult result{"C-FIND (study/series/image)"};
+                        const auto start = Clock::now();
+                        for (int round = 0; round < harness.options.rounds; ++round)
+                        {
+                                QueryFilter filter;
+                                filter.patientID = "BENCH";
+                                std::vector<RemoteStudyInfo> studies;
+                                auto started = Clock::now();
+                                require(query.queryStudies(harness.archivePeer, harness.client, filter, studies) == DimseStatus::Success &&
+                                        studies.size() == 1, "STUDY level C-FIND failed.");
+                                result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+
+                                std::vector<RemoteSeriesInfo> series;
+                                started = Clock::now();
+                                require(query.querySeries(harness.archivePeer, harness.client, ArchiveStudyUID, series) == DimseStatus::Success &&
+                                        series.size() == harness.archiveSeries, "SERIES level C-FIND failed.");
+                                result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+
+                                std::size_t instances = 0;
+                                for (const auto& entry : series)
+                                {
+                                        std::vector<RemoteInstanceInfo> found;
+                                        started = Clock::now();
+                                        require(query.queryInstances(harness.archivePeer, harness.client, ArchiveStudyUID,
+                                                                     entry.seriesInstanceUID, found) == DimseStatus::Success,
+                                                "IMAGE level C-FIND failed.");
+                                        result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+                                        instances += found.size();
+                                }
+                                require(instances == harness.archiveObjects, "IMAGE level C-FIND missed instances.");
+                        }
+                        result.operations = result.latenciesMs.size();
+                        result.seconds = elapsedSeconds(start);
+                        results.push_back(std::move(result));
+                }
+
+                // C-MOVE from the archive to the Storage SCP
+                {
+                        DimseRetrieveService retrieve(pool, nullptr);
+                        harness.scpArrivals.reset();
+                        harness.archiveStoreLatencies->reset();
+                        const auto start = Clock::now();
+                        require(retrieve.retrieveMove(harness.archivePeer, harness.client, RetrieveTarget(ArchiveStudyUID), ScpAE)
+                                        == DimseStatus::Success,
+                                "C-MOVE failed: " + retrieve.getLastError());
+                        PhaseResult result{"C-MOVE"};
+                        result.seconds = elapsedSeconds(start);
+                        result.operations = harness.scpArrivals.count();
+                        result.bytes = harness.scpArrivals.bytes();
+                        result.latenciesMs = harness.archiveStoreLatencies->latenciesMs();
+                        require(result.operations == harness.archiveObjects, "C-MOVE lost objects.");
+                        results.push_back(std::move(result));
+                }
+
+                // C-GET over the outgoing association
+                {
+                        DimseRetrieveService retrieve(pool, nullptr);
+                        ArrivalRecorder arrivals;
+                        retrieve.setStorageReceivedCallback([&arrivals](const std::string& path) { arrivals.record(path); });
+
+                        LocalAEConfig getClient = harness.client;
+                        getClient.tempStoragePath = (harness.root / "cget").string();
+                        std::filesystem::remove_all(getClient.tempStoragePath);
+                        std::filesystem::create_directories(getClient.tempStoragePath);
+
+                        harness.archiveStoreLatencies->reset();
+                        const auto start = Clock::now();
+                        require(retrieve.retrieveGet(harness.archivePeer, getClient, RetrieveTarget(ArchiveStudyUID))
+                                        == DimseStatus::Success,
+                                "C-GET failed: " + retrieve.getLastError());
+                        PhaseResult result{"C-GET"};
+                        result.seconds = elapsedSeconds(start);
+                        result.operations = arrivals.count();
+                        result.bytes = arrivals.bytes();
+                        result.latenciesMs = harness.archiveStoreLatencies->latenciesMs();
+                        require(result.operations == harness.archiveObjects, "C-GET lost objects.");
+                        results.push_back(std::move(result));
+                }
+
+                pool->clear();
+                return results;
+        }
+}
+
+int main(int argc, char* argv[])
+{
+        using namespace isis::core::network;
+
+        try
+        {
+                const Options options = parseOptions(argc, argv);
+
+                int appArgc = 1;
+                char appName[] = "dimse_loopback_benchmark";
+                char* appArgv[] = {appName, nullptr};
+                QCoreApplication app(appArgc, appArgv);
+
+                Harness harness;
+                harness.options = options;
+                harness.root = std::filesystem::temp_directory_path() / "isis_dimse_benchmark";
+                std::filesystem::remove_all(harness.root);
+                std::filesystem::create_directories(harness.root);
+
+                const auto uploadObjects = makeObjects(UploadStudyUID, options);
+                harness.uploadFiles = writeObjects(uploadObjects, harness.root / "upload");
+                const auto archiveObjects = makeObjects(ArchiveStudyUID, options);
+                harness.archiveObjects = archiveObjects.size();
+                harness.archiveSeries = static_cast<std::size_t>(std::min(options.series, options.count));
+
+                LocalAEConfig scpConfig;
+                scpConfig.aeTitle = ScpAE;
+                scpConfig.storagePort = ScpPort;
+                scpConfig.tempStoragePath = (harness.root / "scp").string();
+                scpConfig.maxConnections = options.associations + 2;
+                scpConfig.maxAssociationsPerAE = 0;
+                DimseStorageSCP scp(scpConfig, nullptr);
+                scp.setStorageReceivedCallback([&harness](const std::string& path) { harness.scpArrivals.record(path); });
+                scp.setInstanceReceivedCallback([&harness](const isis::core::DicomInstanceHeader& header) {
+                        harness.scpArrivals.record(header.filePath);
+                });
+                require(scp.start(), "Storage SCP failed to start on the loopback port.");
+
+                LoopbackArchive archive(archiveObjects);
+                require(archive.start(), "Loopback archive failed to start.");
+                harness.archiveStoreLatencies = &archive.storeLatencies();
+
+                harness.scpPeer = DicomPeer("scp", "Storage SCP", ScpAE, "127.0.0.1", ScpPort);
+                harness.scpPeer.timeout = 30;
+                harness.archivePeer = DicomPeer("archive", "Archive", ArchiveAE, "127.0.0.1", ArchivePort);
+                harness.archivePeer.timeout = 30;
+                harness.client.aeTitle = ClientAE;
+                harness.client.tempStoragePath = (harness.root / "client").string();
+                harness.client.enableStorage = false;
+
+                std::cout << "DIMSE loopback benchmark: " << options.count << " objects of "
+                          << options.sizeKb << " KB, " << options.series << " series, "
+                          << options.associations << " store association(s)\n";
+
+                printResults(runCycle(harness));
+
+                if (options.soakMinutes > 0.0)
+                {
+                        // The first cycle warms up pools, caches and allocator arenas
+                        const ResourceSample baseline = sampleResources();
+                        ResourceSample peak = baseline;
+                        const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double, std::ratio<60>>(options.soakMinutes));
+
+                        std::size_t cycle = 1;
+                        while (Clock::now() < deadline)
+                        {
+                                runCycle(harness);
+                                ++cycle;
+                                const ResourceSample sample = sampleResources();
+                                peak.descriptors = std::max(peak.descriptors, sample.descriptors);
+                                peak.rssMb = std::max(peak.rssMb, sample.rssMb);
+                                std::cout << "soak cycle " << cycle << ": descriptors " << sample.descriptors
+                                          << ", RSS " << std::fixed << std::setprecision(1) << sample.rssMb << " MB"
+                                          << std::endl;
+                                std::cout.unsetf(std::ios::fixed);
+
+                                require(sample.descriptors - baseline.descriptors <= options.maxFdGrowth,
+                                        "Descriptor count grew from " + std::to_string(baseline.descriptors) +
+                                        " to " + std::to_string(sample.descriptors));
+                                require(sample.rssMb - baseline.rssMb <= options.maxRssGrowthMb,
+                                        "RSS grew from " + std::to_string(baseline.rssMb) +
+                                        " MB to " + std::to_string(sample.rssMb) + " MB");
+                        }
+                        std::cout << "soak: " << cycle << " cycles, peak descriptors " << peak.descriptors
+                                  << " (baseline " << baseline.descriptors << "), peak RSS " << peak.rssMb
+                                  << " MB (baseline " << baseline.rssMb << " MB)" << std::endl;
+                }
+
+                archive.stop();
+                scp.stop();
+                std::filesystem::remove_all(harness.root);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimse_loopback_benchmark failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimse_loopback_benchmark passed" << std::endl;
+        return EXIT_SUCCESS;
+}
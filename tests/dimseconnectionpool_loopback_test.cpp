@@ -0,0 +1,135 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseconnectionpool_loopback_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for DimseConnectionPool against an in-process Storage SCP:
+ *      per-peer bound, waiter deadlines, reuse after release and eviction of
+ *      associations closed by the peer.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseassociation.h"
+#include "src/core/network/dimsestoragescp.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+        constexpr int LoopbackPort = 11190;
+
+        using isis::tests::require;
+}
+
+int main()
+{
+        using namespace isis::core::network;
+        using namespace std::chrono_literals;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimseconnectionpool_loopback_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_dimse_pool_loopback";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                LocalAEConfig scpConfig;
+                scpConfig.aeTitle = "POOL_SCP";
+                scpConfig.storagePort = LoopbackPort;
+                scpConfig.tempStoragePath = tempRoot.string();
+                scpConfig.maxConnections = 4;
+                scpConfig.maxAssociationsPerAE = 0;
+
+                DimseStorageSCP scp(scpConfig, nullptr);
+                require(scp.start(), "Storage SCP failed to start on the loopback port.");
+
+                DicomPeer peer("loopback", "Loopback", "POOL_SCP", "127.0.0.1", LoopbackPort);
+                peer.timeout = 5;
+
+                LocalAEConfig client;
+                client.aeTitle = "POOL_SCU";
+
+                DimseConnectionPool pool(2);
+                pool.setAcquireTimeout(300ms);
+
+                // Per-peer bound: the third caller waits and gives up at its deadline
+                auto first = pool.acquire(peer, client);
+                auto second = pool.acquire(peer, client);
+                require(first && second, "Pool failed to open two associations to the loopback SCP.");
+                require(pool.getMetrics().inFlight == 2, "Pool does not report two associations in flight.");
+
+                const auto waitStart = std::chrono::steady_clock::now();
+                auto third = pool.acquire(peer, client);
+                const auto waited = std::chrono::steady_clock::now() - waitStart;
+                require(!third, "Pool handed out more associations than its per-peer bound.");
+                require(pool.getMetrics().acquireTimeouts == 1, "Acquire timeout was not counted.");
+                require(waited < 2s, "Saturated acquire did not honour its deadline.");
+
+                // A waiter is woken by a release and receives the released association
+                pool.setAcquireTimeout(5000ms);
+                std::shared_ptr<DimseAssociation> handedOver;
+                std::thread waiter([&]() { handedOver = pool.acquire(peer, client); });
+                std::this_thread::sleep_for(100ms);
+                DimseAssociation* const firstRaw = first.get();
+                pool.release(first);
+                first.reset();
+                waiter.join();
+
+                require(handedOver != nullptr, "Waiter did not receive the released association.");
+                require(handedOver.get() == firstRaw, "Released association was not reused.");
+                require(handedOver->sendEcho(5) == DimseStatus::Success, "Reused association failed C-ECHO.");
+
+                const ConnectionPoolMetrics afterReuse = pool.getMetrics();
+                require(afterReuse.reuses == 1, "Reuse was not counted.");
+                require(afterReuse.connectAttempts == 2, "Pool connected more often than necessary.");
+                require(afterReuse.reuseRate() > 0.0, "Reuse rate is zero after a reuse.");
+
+                pool.release(second);
+                pool.release(handedOver);
+                second.reset();
+                handedOver.reset();
+                require(pool.getPoolSize() == 2, "Released associations were not kept idle.");
+                require(pool.getActiveConnections() == 0, "Released associations are still counted in flight.");
+
+                // Associations released by the peer are evicted in the background
+                pool.setEvictionInterval(50ms);
+                scp.stop();
+                std::this_thread::sleep_for(600ms);
+                require(pool.getPoolSize() == 0, "Associations closed by the peer were not evicted.");
+                require(pool.getMetrics().evictions >= 2, "Evictions were not counted.");
+
+                auto afterStop = pool.acquire(peer, client);
+                require(!afterStop, "Acquire succeeded although the SCP is stopped.");
+                require(pool.getMetrics().connectFailures >= 1, "Connect failure was not counted.");
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimseconnectionpool_loopback_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimseconnectionpool_loopback_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
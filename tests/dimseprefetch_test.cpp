@@ -0,0 +1,162 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseprefetch_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for DimsePrefetchService: selection of relevant priors by
+ *      modality, age and count, series filtering by body part, and one lookup per
+ *      study. Lookups target a closed loopback port so the C-FIND fails fast.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseprefetchservice.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int ClosedPort = 11197;
+
+        using isis::tests::require;
+
+        isis::core::network::RemoteStudyInfo study(const std::string& uid, const std::string& date,
+                                                   const std::string& modality)
+        {
+                isis::core::network::RemoteStudyInfo info;
+                info.studyInstanceUID = uid;
+                info.studyDate = date;
+                info.modality = modality;
+                return info;
+        }
+
+        isis::core::network::RemoteSeriesInfo series(const std::string& modality, const std::string& bodyPart)
+        {
+                isis::core::network::RemoteSeriesInfo info;
+                info.seriesInstanceUID = "1.2.3";
+                info.modality = modality;
+                info.bodyPartExamined = bodyPart;
+                return info;
+        }
+}
+
+int main()
+{
+        using namespace isis::core::network;
+        using namespace std::chrono_literals;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimseprefetch_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                PrefetchStudy current;
+                current.patientID = "PAT-001";
+                current.studyInstanceUID = "1.0";
+                current.studyDate = "20250601";
+                current.modalities = {"CT"};
+                current.bodyPartExamined = "CHEST";
+
+                const std::vector<RemoteStudyInfo> candidates = {
+                        study("1.0", "20250601", "CT"),         // The current study itself
+                        study("1.1", "20240115", "CT"),
+                        study("1.2", "20250301", "CT\\PT"),
+                        study("1.3", "20250401", "MR"),         // Other modality
+                        study("1.4", "20250701", "CT"),         // Later than the current study
+                        study("1.5", "20100101", "CT"),         // Too old
+                        study("1.6", "20230601", "CT"),
+                        study("1.7", "", "CT"),                 // Unknown date
+                };
+
+                // Relevant priors, most recent first, capped at maxPriors
+                {
+                        PrefetchRules rules;
+                        rules.maxAgeDays = 3650;
+                        rules.maxPriors = 2;
+                        const auto priors = DimsePrefetchService::selectPriors(rules, current, candidates, "20251018");
+                        require(priors.size() == 2, "maxPriors was not applied.");
+                        require(priors[0].studyInstanceUID == "1.2" && priors[1].studyInstanceUID == "1.1",
+                                "Priors are not the most recent relevant ones.");
+
+                        rules.maxPriors = 0;
+                        rules.maxAgeDays = 0;
+                        rules.modalities = {"MR"};
+                        const auto all = DimsePrefetchService::selectPriors(rules, current, candidates, "20251018");
+                        require(all.size() == 6, "Extra modality, old or undated priors were not selected.");
+                        require(all.back().studyInstanceUID == "1.7", "Undated prior is not last.");
+
+                        rules.sameModality = false;
+                        rules.modalities.clear();
+                        require(DimsePrefetchService::selectPriors(rules, current, candidates, "20251018").size() == 6,
+                                "Without modality rules every earlier study is a prior.");
+                }
+
+                // Series of other body parts are dropped; unknown body parts are kept
+                {
+                        PrefetchRules rules;
+                        require(DimsePrefetchService::isRelevantSeries(rules, current, series("CT", "chest")),
+                                "Body part comparison is case sensitive.");
+                        require(!DimsePrefetchService::isRelevantSeries(rules, current, series("CT", "HEAD")),
+                                "Series of another body part was kept.");
+                        require(DimsePrefetchService::isRelevantSeries(rules, current, series("CT", "")),
+                                "Series without a body part was dropped.");
+                        require(!DimsePrefetchService::isRelevantSeries(rules, current, series("PT", "CHEST")),
+                                "Series of another modality was kept.");
+
+                        rules.matchBodyPart = false;
+                        require(DimsePrefetchService::isRelevantSeries(rules, current, series("CT", "HEAD")),
+                                "matchBodyPart = false still filtered by body part.");
+                }
+
+                // Disabled rules queue nothing; an enabled service looks a study up once
+                {
+                        auto pool = std::make_shared<DimseConnectionPool>(2);
+                        auto scheduler = std::make_shared<DimseRetrieveScheduler>(pool, nullptr);
+                        DimsePrefetchService service(pool, nullptr, scheduler);
+
+                        DicomPeer peer("closed", "Closed", "NOBODY", "127.0.0.1", ClosedPort);
+                        peer.timeout = 2;
+                        LocalAEConfig client;
+                        client.aeTitle = "PREFETCH_SCU";
+
+                        PrefetchRules rules;
+                        service.configure(rules, peer, client);
+                        require(!service.onStudyAvailable(current), "Disabled prefetch accepted a study.");
+
+                        rules.enabled = true;
+                        service.configure(rules, peer, client);
+                        service.start();
+                        require(service.onStudyAvailable(current), "Study was not queued.");
+                        require(!service.onStudyAvailable(current), "Study was looked up twice.");
+                        require(service.waitForIdle(10s), "Lookup against an unreachable peer did not finish.");
+                        require(scheduler->getQueuedCount() == 0, "Failed lookup queued retrieves.");
+                        require(!service.onStudyAvailable(current), "Failed lookup was retried before its backoff.");
+                        service.stop();
+                        pool->clear();
+                }
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimseprefetch_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimseprefetch_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
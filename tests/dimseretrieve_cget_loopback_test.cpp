@@ -0,0 +1,478 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseretrieve_cget_loopback_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for DimseRetrieveService::retrieveGet against an in-process
+ *      C-GET provider: sub-operations arrive on the requesting association, every
+ *      object is stored once with its pixel data intact, and SERIES level retrieves
+ *      move only the requested series.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseservices.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+#include <dcmtk/dcmnet/assoc.h>
+#include <dcmtk/dcmnet/dimse.h>
+
+#include <QCoreApplication>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+        constexpr int LoopbackPort = 11191;
+        constexpr const char* StudyUID = "1.2.826.0.1.3680043.9.7433.2.1";
+        constexpr const char* SeriesUIDs[] = {
+                "1.2.826.0.1.3680043.9.7433.2.1.1",
+                "1.2.826.0.1.3680043.9.7433.2.1.2"
+        };
+        constexpr int InstancesPerSeries[] = {3, 2};
+        constexpr int ImageSize = 64;
+
+        using isis::tests::require;
+
+        std::uint64_t fnv1a(const Uint8* data, unsigned long length)
+        {
+                std::uint64_t hash = 1469598103934665603ULL;
+                for (unsigned long i = 0; i < length; ++i)
+                {
+                        hash ^= data[i];
+                        hash *= 1099511628211ULL;
+                }
+                return hash;
+        }
+
+        std::uint64_t pixelChecksum(DcmDataset* dataset)
+        {
+                const Uint8* pixels = nullptr;
+                unsigned long count = 0;
+                if (dataset->findAndGetUint8Array(DCM_PixelData, pixels, &count).bad() || !pixels)
+                {
+                        return 0;
+                }
+                return fnv1a(pixels, count);
+        }
+
+        struct TestObject
+        {
+                std::string seriesUID;
+                std::string sopInstanceUID;
+                std::unique_ptr<DcmDataset> dataset;
+                std::uint64_t checksum = 0;
+        };
+
+        std::vector<TestObject> makeObjects()
+        {
+                std::vector<TestObject> objects;
+                for (int series = 0; series < 2; ++series)
+                {
+                        for (int instance = 1; instance <= InstancesPerSeries[series]; ++instance)
+                        {
+                                TestObject object;
+                                object.seriesUID = SeriesUIDs[series];
+                                object.sopInstanceUID = object.seriesUID + "." + std::to_string(instance);
+                                object.dataset = std::make_unique<DcmDataset>();
+
+                                DcmDataset* ds = object.dataset.get();
+                                ds->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+                                ds->putAndInsertString(DCM_SOPInstanceUID, object.sopInstanceUID.c_str());
+                                ds->putAndInsertString(DCM_StudyInstanceUID, StudyUID);
+                                ds->putAndInsertString(DCM_SeriesInstanceUID, object.seriesUID.c_str());
+                                ds->putAndInsertString(DCM_Modality, "OT");
+                                ds->putAndInsertString(DCM_InstanceNumber, std::to_string(instance).c_str());
+                                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                                ds->putAndInsertUint16(DCM_Rows, ImageSize);
+                                ds->putAndInsertUint16(DCM_Columns, ImageSize);
+                                ds->putAndInsertUint16(DCM_BitsAllocated, 8);
+                                ds->putAndInsertUint16(DCM_BitsStored, 8);
+                                ds->putAndInsertUint16(DCM_HighBit, 7);
+                                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                                std::vector<Uint8> pixels(ImageSize * ImageSize);
+                                for (std::size_t i = 0; i < pixels.size(); ++i)
+                                {
+                                        pixels[i] = static_cast<Uint8>((i * (series + 3) + instance * 17) & 0xff);
+                                }
+                                ds->putAndInsertUint8Array(DCM_PixelData, pixels.data(),
+                                                           static_cast<unsigned long>(pixels.size()));
+                                object.checksum = fnv1a(pixels.data(), static_cast<unsigned long>(pixels.size()));
+                                objects.push_back(std::move(object));
+                        }
+                }
+                return objects;
+        }
+
+        /**
+         * Minimal Study Root C-GET provider: accepts the Q/R context and storage
+         * contexts proposed with the SCP role, and answers every C-GET with C-STORE
+         * sub-operations on the same association.
+         */
+        class LoopbackGetProvider
+        {
+        public:
+                explicit LoopbackGetProvider(const std::vector<TestObject>& objects)
+                        : m_objects(objects)
+                {
+                }
+
+                ~LoopbackGetProvider() { stop(); }
+
+                bool start()
+                {
+                        if (ASC_initializeNetwork(NET_ACCEPTOR, LoopbackPort, 30, &m_network).bad())
+                        {
+                                return false;
+                        }
+                        m_thread = std::thread([this]() { run(); });
+                        return true;
+                }
+
+                void stop()
+                {
+                        m_stop = true;
+                        if (m_thread.joinable())
+                        {
+                                m_thread.join();
+                        }
+                        if (m_network)
+                        {
+                                ASC_dropNetwork(&m_network);
+                        }
+                }
+
+                int getRequests() const { return m_getRequests.load(); }
+
+        private:
+                void run()
+                {
+                        while (!m_stop)
+                        {
+                                T_ASC_Association* assoc = nullptr;
+                                OFCondition cond = ASC_receiveAssociation(m_network, &assoc, ASC_DEFAULTMAXPDU,
+                                                                          nullptr, nullptr, OFFalse, DUL_NOBLOCK, 1);
+                                if (cond.bad())
+                                {
+                                        if (assoc)
+                                        {
+                                                ASC_destroyAssociation(&assoc);
+                                        }
+                                        continue;
+                                }
+
+                                acceptContexts(assoc);
+                                if (ASC_acknowledgeAssociation(assoc).good())
+                                {
+                                        serve(assoc);
+                                }
+                                ASC_dropSCPAssociation(assoc);
+                                ASC_destroyAssociation(&assoc);
+                        }
+                }
+
+                static void acceptContexts(T_ASC_Association* assoc)
+                {
+                        const char* transferSyntaxes[] = {
+                                UID_LittleEndianExplicitTransferSyntax,
+                                UID_LittleEndianImplicitTransferSyntax
+                        };
+                        const char* services[] = {
+                                UID_GETStudyRootQueryRetrieveInformationModel,
+                                UID_VerificationSOPClass
+                        };
+                        ASC_acceptContextsWithPreferredTransferSyntaxes(assoc->params, services, 2,
+                                                                       transferSyntaxes, 2);
+
+                        for (int i = 0; i < ASC_countPresentationContexts(assoc->params); ++i)
+                        {
+                                T_ASC_PresentationContext pc;
+                                ASC_getPresentationContext(assoc->params, i, &pc);
+                                const bool scpRole = pc.proposedRole == ASC_SC_ROLE_SCP ||
+                                                     pc.proposedRole == ASC_SC_ROLE_SCUSCP;
+                                if (dcmIsaStorageSOPClassUID(pc.abstractSyntax, ESSC_All) && scpRole)
+                                {
+                                        ASC_acceptPresentationContext(assoc->params, pc.presentationContextID,
+                                                                      UID_LittleEndianExplicitTransferSyntax,
+                                                                      ASC_SC_ROLE_SCP);
+                                }
+                        }
+                }
+
+                void serve(T_ASC_Association* assoc)
+                {
+                        while (!m_stop)
+                        {
+                                T_DIMSE_Message message;
+                                T_ASC_PresentationContextID presID = 0;
+                                OFCondition cond = DIMSE_receiveCommand(assoc, DIMSE_NONBLOCKING, 1,
+                                                                        &presID, &message, nullptr);
+                                if (cond == DIMSE_NODATAAVAILABLE)
+                                {
+                                        continue;
+                                }
+                                if (cond == DUL_PEERREQUESTEDRELEASE)
+                                {
+                                        ASC_acknowledgeRelease(assoc);
+                                        return;
+                                }
+                                if (cond.bad())
+                                {
+                                        return;
+                                }
+
+                                if (message.CommandField == DIMSE_C_ECHO_RQ)
+                                {
+                                        DIMSE_sendEchoResponse(assoc, presID, &message.msg.CEchoRQ,
+                                                               STATUS_Success, nullptr);
+                                }
+                                else if (message.CommandField == DIMSE_C_GET_RQ)
+                                {
+                                        if (!handleGet(assoc, presID, message.msg.CGetRQ))
+                                        {
+                                                return;
+                                        }
+                                }
+                        }
+                }
+
+                bool handleGet(T_ASC_Association* assoc, T_ASC_PresentationContextID presID,
+                               T_DIMSE_C_GetRQ& request)
+                {
+                        m_getRequests++;
+
+                        DcmDataset* identifiers = nullptr;
+                        T_ASC_PresentationContextID dataPresID = presID;
+                        if (DIMSE_receiveDataSetInMemory(assoc, DIMSE_BLOCKING, 0, &dataPresID,
+                                                         &identifiers, nullptr, nullptr).bad())
+                        {
+                                return false;
+                        }
+
+                        OFString seriesFilter;
+                        identifiers->findAndGetOFString(DCM_SeriesInstanceUID, seriesFilter);
+                        delete identifiers;
+
+                        std::vector<const TestObject*> matches;
+                        for (const auto& object : m_objects)
+                        {
+                                if (seriesFilter.empty() || object.seriesUID == seriesFilter.c_str())
+                                {
+                                        matches.push_back(&object);
+                                }
+                        }
+
+                        T_DIMSE_C_GetRSP response;
+                        std::memset(&response, 0, sizeof(response));
+                        response.MessageIDBeingRespondedTo = request.MessageID;
+                        OFStandard::strlcpy(response.AffectedSOPClassUID, request.AffectedSOPClassUID,
+                                            sizeof(response.AffectedSOPClassUID));
+                        response.DataSetType = DIMSE_DATASET_NULL;
+                        response.opts = O_GET_AFFECTEDSOPCLASSUID | O_GET_NUMBEROFCOMPLETEDSUBOPERATIONS |
+                                        O_GET_NUMBEROFFAILEDSUBOPERATIONS | O_GET_NUMBEROFWARNINGSUBOPERATIONS;
+
+                        int completed = 0;
+                        int failed = 0;
+                        for (std::size_t i = 0; i < matches.size(); ++i)
+                        {
+                                const TestObject& object = *matches[i];
+                                const T_ASC_PresentationContextID storePresID = ASC_findAcceptedPresentationContextID(
+                                        assoc, UID_SecondaryCaptureImageStorage);
+
+                                T_DIMSE_C_StoreRQ storeRequest;
+                                std::memset(&storeRequest, 0, sizeof(storeRequest));
+                                storeRequest.MessageID = assoc->nextMsgID++;
+                                OFStandard::strlcpy(storeRequest.AffectedSOPClassUID, UID_SecondaryCaptureImageStorage,
+                                                    sizeof(storeRequest.AffectedSOPClassUID));
+                                OFStandard::strlcpy(storeRequest.AffectedSOPInstanceUID, object.sopInstanceUID.c_str(),
+                                                    sizeof(storeRequest.AffectedSOPInstanceUID));
+                                storeRequest.DataSetType = DIMSE_DATASET_PRESENT;
+                                storeRequest.Priority = DIMSE_PRIORITY_MEDIUM;
+
+                                T_DIMSE_C_StoreRSP storeResponse;
+                                std::memset(&storeResponse, 0, sizeof(storeResponse));
+                                DcmDataset* statusDetail = nullptr;
+                                OFCondition cond = storePresID == 0 ? DIMSE_NOVALIDPRESENTATIONCONTEXTID :
+                                        DIMSE_storeUser(assoc, storePresID, &storeRequest, nullptr,
+                                                        object.dataset.get(), nullptr, nullptr,
+                                                        DIMSE_BLOCKING, 0, &storeResponse, &statusDetail);
+                                delete statusDetail;
+
+                                if (cond.good() && storeResponse.DimseStatus == STATUS_Success)
+                                {
+                                        completed++;
+                                }
+                                else
+                                {
+                                        failed++;
+                                }
+
+                                const int remaining = static_cast<int>(matches.size() - i - 1);
+                                if (remaining > 0)
+                                {
+                                        response.DimseStatus = STATUS_Pending;
+                                        response.opts |= O_GET_NUMBEROFREMAININGSUBOPERATIONS;
+                                        response.NumberOfRemainingSubOperations = static_cast<DIC_US>(remaining);
+                                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                                        if (DIMSE_sendGetResponse(assoc, presID, &request, &response,
+                                                                  nullptr, nullptr).bad())
+                                        {
+                                                return false;
+                                        }
+                                }
+                        }
+
+                        response.DimseStatus = failed == 0 ? STATUS_Success
+                                : STATUS_GET_Warning_SubOperationsCompleteOneOrMoreFailures;
+                        response.opts &= ~O_GET_NUMBEROFREMAININGSUBOPERATIONS;
+                        response.NumberOfRemainingSubOperations = 0;
+                        response.NumberOfCompletedSubOperations = static_cast<DIC_US>(completed);
+                        response.NumberOfFailedSubOperations = static_cast<DIC_US>(failed);
+                        return DIMSE_sendGetResponse(assoc, presID, &request, &response, nullptr, nullptr).good();
+                }
+
+                const std::vector<TestObject>& m_objects;
+                T_ASC_Network* m_network = nullptr;
+                std::thread m_thread;
+                std::atomic<bool> m_stop{false};
+                std::atomic<int> m_getRequests{0};
+        };
+
+        std::map<std::string, std::uint64_t> readReceived(const std::filesystem::path& directory,
+                                                          std::size_t& partialFiles)
+        {
+                std::map<std::string, std::uint64_t> received;
+                partialFiles = 0;
+                for (const auto& entry : std::filesystem::directory_iterator(directory))
+                {
+                        if (entry.path().extension() == ".part")
+                        {
+                                partialFiles++;
+                                continue;
+                        }
+
+                        DcmFileFormat file;
+                        require(file.loadFile(entry.path().string().c_str()).good(),
+                                "Received file is not readable DICOM: " + entry.path().string());
+                        OFString sopInstanceUID;
+                        file.getDataset()->findAndGetOFString(DCM_SOPInstanceUID, sopInstanceUID);
+                        received[sopInstanceUID.c_str()] = pixelChecksum(file.getDataset());
+                }
+                return received;
+        }
+}
+
+int main()
+{
+        using namespace isis::core::network;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimseretrieve_cget_loopback_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_dimse_cget_loopback";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                const std::vector<TestObject> objects = makeObjects();
+                LoopbackGetProvider provider(objects);
+                require(provider.start(), "C-GET provider failed to start on the loopback port.");
+
+                DicomPeer peer("loopback", "Loopback", "GET_SCP", "127.0.0.1", LoopbackPort);
+                peer.timeout = 10;
+                peer.useCGet = true;
+
+                LocalAEConfig client;
+                client.aeTitle = "GET_SCU";
+                client.enableStorage = false;   // C-GET must not depend on the Storage SCP
+
+                auto pool = std::make_shared<DimseConnectionPool>(2);
+                DimseRetrieveService service(pool, nullptr);
+
+                std::vector<std::string> callbackFiles;
+                service.setStorageReceivedCallback([&](const std::string& path) { callbackFiles.push_back(path); });
+
+                // STUDY level: every object arrives once, bit-identical pixel data
+                const auto studyDir = tempRoot / "study";
+                client.tempStoragePath = studyDir.string();
+
+                double lastProgress = -1.0;
+                int progressCalls = 0;
+                DimseStatus status = service.retrieve(peer, client, RetrieveTarget(StudyUID),
+                        [&](double progress, const std::string&) {
+                                require(progress >= lastProgress, "C-GET progress went backwards.");
+                                lastProgress = progress;
+                                progressCalls++;
+                        });
+
+                require(status == DimseStatus::Success, "Study C-GET failed: " + service.getLastError());
+                require(service.getReceivedCount() == static_cast<int>(objects.size()),
+                        "Study C-GET reported a wrong object count.");
+                require(callbackFiles.size() == objects.size(), "Storage callback was not invoked per object.");
+                require(progressCalls > 1 && lastProgress == 1.0, "C-GET progress was not reported.");
+
+                std::size_t partialFiles = 0;
+                auto received = readReceived(studyDir, partialFiles);
+                require(partialFiles == 0, "Partial files were left behind.");
+                require(received.size() == objects.size(), "Study C-GET stored a wrong number of files.");
+                for (const auto& object : objects)
+                {
+                        auto it = received.find(object.sopInstanceUID);
+                        require(it != received.end(), "Missing object " + object.sopInstanceUID);
+                        require(it->second == object.checksum, "Pixel data differs for " + object.sopInstanceUID);
+                }
+
+                // SERIES level: only the requested series is moved
+                const auto seriesDir = tempRoot / "series";
+                client.tempStoragePath = seriesDir.string();
+                status = service.retrieveSeries(peer, client, StudyUID, SeriesUIDs[1]);
+                require(status == DimseStatus::Success, "Series C-GET failed: " + service.getLastError());
+                require(service.getReceivedCount() == InstancesPerSeries[1],
+                        "Series C-GET moved objects outside the series.");
+
+                received = readReceived(seriesDir, partialFiles);
+                require(received.size() == static_cast<std::size_t>(InstancesPerSeries[1]),
+                        "Series C-GET stored a wrong number of files.");
+
+                // The association was released back to the pool and reused
+                require(provider.getRequests() == 2, "Provider did not see two C-GET requests.");
+                require(pool->getMetrics().reuses >= 1, "C-GET association was not reused.");
+
+                pool->clear();
+                provider.stop();
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimseretrieve_cget_loopback_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimseretrieve_cget_loopback_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,281 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimseretrievescheduler_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for DimseRetrieveScheduler without a remote peer: priority
+ *      order, reprioritization, per-peer bound, retry backoff, skipping instances
+ *      already on disk, holding background jobs for interactive ones and
+ *      cancellation of queued jobs. Retrieves target a closed loopback port so
+ *      every network attempt fails fast.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseretrievescheduler.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int ClosedPort = 11192;
+
+        using isis::tests::require;
+
+        isis::core::network::RetrieveTarget seriesTarget(const std::string& seriesUID)
+        {
+                isis::core::network::RetrieveTarget target("1.2.826.0.1.3680043.9.7433.3.1");
+                target.seriesInstanceUID = seriesUID;
+                return target;
+        }
+
+        /**
+         * @brief Records the order in which jobs start and the peak number running at once
+         */
+        struct JobRecorder
+        {
+                std::mutex mutex;
+                std::vector<std::uint64_t> startOrder;
+                std::set<std::uint64_t> running;
+                std::size_t peakRunning = 0;
+
+                void operator()(const isis::core::network::RetrieveJobStatus& status)
+                {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (status.state == isis::core::network::RetrieveJobState::Running)
+                        {
+                                if (running.insert(status.id).second &&
+                                    std::find(startOrder.begin(), startOrder.end(), status.id) == startOrder.end())
+                                {
+                                        startOrder.push_back(status.id);
+                                }
+                                peakRunning = std::max(peakRunning, running.size());
+                        }
+                        else
+                        {
+                                running.erase(status.id);
+                        }
+                }
+        };
+}
+
+int main()
+{
+        using namespace isis::core::network;
+        using namespace std::chrono_literals;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimseretrievescheduler_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_dimse_scheduler";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                DicomPeer peer("closed", "Closed", "NOBODY", "127.0.0.1", ClosedPort);
+                peer.timeout = 2;
+
+                LocalAEConfig client;
+                client.aeTitle = "SCHED_SCU";
+                client.tempStoragePath = tempRoot.string();
+
+                auto pool = std::make_shared<DimseConnectionPool>(4);
+
+                // Priority order, then submission order; setPriority() moves a queued job ahead
+                {
+                        RetrieveSchedulerOptions options;
+                        options.workerCount = 1;
+                        options.maxAttempts = 1;
+                        DimseRetrieveScheduler scheduler(pool, nullptr, options);
+                        auto recorder = std::make_shared<JobRecorder>();
+                        scheduler.setJobCallback([recorder](const RetrieveJobStatus& s) { (*recorder)(s); });
+
+                        const auto background = scheduler.submit(peer, client, seriesTarget("1.1"), RetrievePriority::Background);
+                        const auto promoted = scheduler.submit(peer, client, seriesTarget("1.2"), RetrievePriority::Background);
+                        const auto prefetch = scheduler.submit(peer, client, seriesTarget("1.3"), RetrievePriority::Prefetch);
+                        const auto interactive = scheduler.submit(peer, client, seriesTarget("1.4"), RetrievePriority::Interactive);
+                        require(scheduler.getQueuedCount() == 4, "Jobs were not queued before start().");
+                        require(scheduler.setPriority(promoted, RetrievePriority::Interactive), "setPriority failed.");
+
+                        scheduler.start();
+                        require(scheduler.waitForIdle(30s), "Scheduler did not drain its queue.");
+
+                        const std::vector<std::uint64_t> expected = {interactive, promoted, prefetch, background};
+                        require(recorder->startOrder == expected, "Jobs did not start in priority order.");
+
+                        RetrieveJobStatus status;
+                        require(scheduler.getJob(background, status), "Finished job was not kept in the history.");
+                        require(status.state == RetrieveJobState::Failed && status.attempts == 1,
+                                "Unreachable peer did not fail the job after one attempt.");
+                        require(!status.lastError.empty(), "Failed job carries no error.");
+                }
+
+                // Per-peer bound holds even with more workers than allowed retrieves
+                {
+                        RetrieveSchedulerOptions options;
+                        options.workerCount = 4;
+                        options.maxConcurrentPerPeer = 1;
+                        options.maxAttempts = 1;
+                        DimseRetrieveScheduler scheduler(pool, nullptr, options);
+                        auto recorder = std::make_shared<JobRecorder>();
+                        scheduler.setJobCallback([recorder](const RetrieveJobStatus& s) { (*recorder)(s); });
+
+                        for (int i = 0; i < 6; ++i)
+                        {
+                                scheduler.submit(peer, client, seriesTarget("2." + std::to_string(i)),
+                                                 RetrievePriority::Prefetch);
+                        }
+                        scheduler.start();
+                        require(scheduler.waitForIdle(30s), "Scheduler did not drain its queue.");
+                        require(recorder->startOrder.size() == 6, "Not every job ran.");
+                        require(recorder->peakRunning == 1, "More than one job ran against the peer at once.");
+                }
+
+                // Failed attempts are retried after an exponentially growing delay
+                {
+                        RetrieveSchedulerOptions options;
+                        options.workerCount = 1;
+                        options.maxAttempts = 3;
+                        options.retryBaseDelay = 150ms;
+                        DimseRetrieveScheduler scheduler(pool, nullptr, options);
+                        scheduler.start();
+
+                        const auto started = std::chrono::steady_clock::now();
+                        const auto id = scheduler.submit(peer, client, seriesTarget("3.1"), RetrievePriority::Interactive);
+                        require(scheduler.waitForIdle(30s), "Retried job did not finish.");
+                        const auto elapsed = std::chrono::steady_clock::now() - started;
+
+                        RetrieveJobStatus status;
+                        require(scheduler.getJob(id, status), "Retried job missing from the history.");
+                        require(status.state == RetrieveJobState::Failed && status.attempts == 3,
+                                "Job was not attempted maxAttempts times.");
+                        require(elapsed >= 450ms, "Retries did not wait for the backoff delay (150 + 300 ms).");
+                }
+
+                // Instances already on disk are not requested again
+                {
+                        const std::vector<std::string> present = {"1.2.3.4.1", "1.2.3.4.2"};
+                        for (const auto& uid : present)
+                        {
+                                std::ofstream(tempRoot / (uid + ".dcm")) << "DICM";
+                        }
+
+                        DimseRetrieveScheduler scheduler(pool, nullptr);
+                        // Skipped instances are still imported: the store outlives the session
+                        std::mutex importedMutex;
+                        std::vector<std::string> imported;
+                        scheduler.setStorageReceivedCallback([&](const std::string& path) {
+                                std::lock_guard<std::mutex> lock(importedMutex);
+                                imported.push_back(path);
+                        });
+                        scheduler.start();
+
+                        RetrieveTarget target = seriesTarget("4.1");
+                        target.sopInstanceUIDs = present;
+                        const auto id = scheduler.submit(peer, client, target, RetrievePriority::Interactive);
+                        require(scheduler.waitForIdle(10s), "Skipped job did not finish.");
+
+                        RetrieveJobStatus status;
+                        require(scheduler.getJob(id, status), "Skipped job missing from the history.");
+                        require(status.state == RetrieveJobState::Skipped, "Local instances were retrieved again.");
+                        require(status.instancesSkipped == 2 && status.instancesExpected == 2,
+                                "Skipped instances were not counted.");
+                        {
+                                std::lock_guard<std::mutex> lock(importedMutex);
+                                require(imported.size() == 2, "Skipped local instances were not imported.");
+                        }
+
+                        // A custom lookup replaces the file check
+                        scheduler.setLocalInstanceLookup([](const std::string& uid) { return uid == "9.9.9"; });
+                        target.sopInstanceUIDs = {"9.9.9"};
+                        const auto customId = scheduler.submit(peer, client, target, RetrievePriority::Interactive);
+                        require(scheduler.waitForIdle(10s), "Lookup job did not finish.");
+                        require(scheduler.getJob(customId, status) && status.state == RetrieveJobState::Skipped,
+                                "Custom instance lookup was not used.");
+                }
+
+                // Non-Interactive jobs wait while an Interactive one is queued or running, even in its backoff
+                {
+                        RetrieveSchedulerOptions options;
+                        options.workerCount = 2;
+                        options.maxAttempts = 2;
+                        options.retryBaseDelay = 300ms;
+                        DimseRetrieveScheduler scheduler(pool, nullptr, options);
+
+                        std::mutex mutex;
+                        std::chrono::steady_clock::time_point interactiveFinished{};
+                        std::chrono::steady_clock::time_point prefetchStarted{};
+                        std::uint64_t interactive = 0;
+                        scheduler.setJobCallback([&](const RetrieveJobStatus& s) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                const auto now = std::chrono::steady_clock::now();
+                                if (s.id == interactive && s.isFinished())
+                                        interactiveFinished = now;
+                                else if (s.id != interactive && s.state == RetrieveJobState::Running &&
+                                         prefetchStarted == std::chrono::steady_clock::time_point{})
+                                        prefetchStarted = now;
+                        });
+
+                        {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                interactive = scheduler.submit(peer, client, seriesTarget("6.1"), RetrievePriority::Interactive);
+                        }
+                        scheduler.submit(peer, client, seriesTarget("6.2"), RetrievePriority::Prefetch);
+                        scheduler.start();
+                        require(scheduler.waitForIdle(30s), "Scheduler did not drain its queue.");
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        require(interactiveFinished != std::chrono::steady_clock::time_point{} &&
+                                prefetchStarted != std::chrono::steady_clock::time_point{},
+                                "Jobs did not run.");
+                        require(prefetchStarted >= interactiveFinished,
+                                "Prefetch job started while the Interactive job was still active.");
+                }
+
+                // Queued jobs are cancelled without touching the network
+                {
+                        DimseRetrieveScheduler scheduler(pool, nullptr);
+                        const auto id = scheduler.submit(peer, client, seriesTarget("5.1"), RetrievePriority::Background);
+                        require(scheduler.cancel(id), "cancel() did not find the job.");
+                        require(scheduler.getQueuedCount() == 0, "Cancelled job is still queued.");
+
+                        RetrieveJobStatus status;
+                        require(scheduler.getJob(id, status) && status.state == RetrieveJobState::Cancelled,
+                                "Cancelled job has the wrong state.");
+                        require(status.attempts == 0, "Cancelled job was attempted.");
+                }
+
+                pool->clear();
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimseretrievescheduler_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimseretrievescheduler_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimsestorageindex_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for DimseStorageIndex: hierarchical placement, study/series
+ *      lookup, duplicate policies, journal replay (including a torn last line),
+ *      least-recently-used and retention purging.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimsestorageindex.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr const char* StudyUID = "1.2.826.0.1.3680043.9.7433.6.1";
+        constexpr const char* SeriesUID = "1.2.826.0.1.3680043.9.7433.6.1.1";
+
+        using isis::tests::require;
+
+        isis::core::DicomInstanceHeader headerFor(const std::string& sopInstanceUID,
+                                                  const std::string& seriesUID = SeriesUID)
+        {
+                isis::core::DicomInstanceHeader header;
+                header.setValue(0x0002, 0x0010, "1.2.840.10008.1.2.1");
+                header.setValue(0x0008, 0x0016, "1.2.840.10008.5.1.4.1.1.2");
+                header.setValue(0x0008, 0x0018, sopInstanceUID);
+                header.setValue(0x0010, 0x0020, "PAT-001");
+                header.setValue(0x0020, 0x000D, StudyUID);
+                header.setValue(0x0020, 0x000E, seriesUID);
+                return header;
+        }
+
+        std::string writeReceived(const std::filesystem::path& directory, const std::string& name,
+                                  const std::string& content)
+        {
+                const auto path = directory / (name + ".part");
+                std::ofstream(path, std::ios::binary) << content;
+                return path.string();
+        }
+
+        std::string readAll(const std::string& path)
+        {
+                std::ifstream input(path, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+}
+
+int main()
+{
+        using namespace isis::core::network;
+        namespace fs = std::filesystem;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimsestorageindex_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto root = fs::temp_directory_path() / "isis_storage_index";
+                const auto incoming = root / "incoming";
+                fs::remove_all(root);
+                fs::create_directories(incoming);
+
+                // Objects are filed under fan-out/patient/study/series and indexed
+                {
+                        DimseStorageIndex index(root.string());
+                        require(index.open(), "Index did not open.");
+
+                        StorageIndexRecord record;
+                        for (int i = 1; i <= 3; ++i)
+                        {
+                                const std::string uid = std::string(SeriesUID) + "." + std::to_string(i);
+                                const auto result = index.commit(writeReceived(incoming, uid, "object " + std::to_string(i)),
+                                                                 headerFor(uid), "MODALITY", record);
+                                require(result == StorageCommitResult::Stored, "Object was not stored.");
+                        }
+                        const std::string otherSeries = std::string(StudyUID) + ".2";
+                        require(index.commit(writeReceived(incoming, otherSeries + ".1", "other"),
+                                             headerFor(otherSeries + ".1", otherSeries), "MODALITY", record)
+                                        == StorageCommitResult::Stored,
+                                "Object of the second series was not stored.");
+
+                        require(index.size() == 4, "Index does not hold every object.");
+                        require(index.getStudyRecords(StudyUID).size() == 4, "Study lookup is incomplete.");
+                        require(index.getSeriesRecords(SeriesUID).size() == 3, "Series lookup is incomplete.");
+
+                        require(index.find(std::string(SeriesUID) + ".2", record), "Object not found by SOP UID.");
+                        const auto expected = DimseStorageIndex::relativePathFor("PAT-001", StudyUID, SeriesUID,
+                                                                                 std::string(SeriesUID) + ".2");
+                        require(record.relativePath == expected, "Object not filed at its hierarchical path.");
+                        require(record.relativePath.find("PAT-001") == std::string::npos,
+                                "Patient ID leaked into the path.");
+                        require(record.relativePath.substr(0, 3) == record.patientKey.substr(0, 2) + "/",
+                                "Fan-out folder does not match the patient key.");
+                        require(fs::is_regular_file(index.absolutePath(record)), "Filed object is missing.");
+                        require(record.size == std::string("object 2").size(), "Size not recorded.");
+                        require(record.transferSyntaxUID == "1.2.840.10008.1.2.1", "Transfer syntax not recorded.");
+                        require(record.callingAE == "MODALITY", "Calling AE not recorded.");
+                        require(fs::is_empty(incoming), "Received file left in the incoming folder.");
+                }
+
+                const std::string duplicateUID = std::string(SeriesUID) + ".1";
+
+                // KeepExisting discards the new copy; Replace overwrites it
+                {
+                        DimseStorageIndex keep(root.string(), DuplicateSopPolicy::KeepExisting);
+                        require(keep.open(), "Index did not reopen.");
+                        require(keep.size() == 4, "Journal replay lost objects.");
+
+                        StorageIndexRecord record;
+                        const auto received = writeReceived(incoming, duplicateUID, "second copy");
+                        require(keep.commit(received, headerFor(duplicateUID), "MODALITY", record)
+                                        == StorageCommitResult::DuplicateDiscarded,
+                                "Duplicate was not discarded.");
+                        require(!fs::exists(received), "Discarded copy was left on disk.");
+                        require(readAll(keep.absolutePath(record)) == "object 1", "Existing copy was overwritten.");
+                }
+                {
+                        DimseStorageIndex replace(root.string(), DuplicateSopPolicy::Replace);
+                        require(replace.open(), "Index did not reopen.");
+
+                        StorageIndexRecord record;
+                        require(replace.commit(writeReceived(incoming, duplicateUID, "third copy"),
+                                               headerFor(duplicateUID), "MODALITY", record)
+                                        == StorageCommitResult::Replaced,
+                                "Duplicate was not replaced.");
+                        require(readAll(replace.absolutePath(record)) == "third copy", "Replacement not stored.");
+                        require(replace.size() == 4, "Replacement added a second entry.");
+                }
+
+                // A torn last line is dropped and does not corrupt later appends
+                {
+                        std::ofstream(root / "storage-index.tsv", std::ios::binary | std::ios::app)
+                                << "1700000000000\t9.9.9\t1.2";
+                        DimseStorageIndex index(root.string());
+                        require(index.open(), "Index with a torn line did not open.");
+                        require(index.size() == 4 && !index.contains("9.9.9"), "Torn line was replayed.");
+
+                        const std::string uid = std::string(SeriesUID) + ".4";
+                        StorageIndexRecord record;
+                        require(index.commit(writeReceived(incoming, uid, "object 4"), headerFor(uid), "MODALITY", record)
+                                        == StorageCommitResult::Stored,
+                                "Object after a torn line was not stored.");
+                }
+                {
+                        DimseStorageIndex index(root.string());
+                        require(index.open(), "Index did not reopen.");
+                        require(index.size() == 5, "Append after a torn line was lost.");
+                }
+
+                // The least recently used studies go first; kept studies are never purged
+                {
+                        DimseStorageIndex index(root.string());
+                        require(index.open(), "Index did not reopen.");
+                        const auto before = index.totalBytes();
+                        require(before > 0, "Stored bytes are not counted.");
+
+                        StorageIndexRecord record;
+                        const std::vector<std::string> studies = {"1.2.826.0.1.3680043.9.7433.6.7",
+                                                                  "1.2.826.0.1.3680043.9.7433.6.8",
+                                                                  "1.2.826.0.1.3680043.9.7433.6.9"};
+                        for (const auto& study : studies)
+                        {
+                                auto header = headerFor(study + ".1.1", study + ".1");
+                                header.setValue(0x0020, 0x000D, study);
+                                require(index.commit(writeReceived(incoming, study, std::string(1000, 'x')), header,
+                                                     "MODALITY", record) == StorageCommitResult::Stored,
+                                        "Object of another study was not stored.");
+                        }
+                        require(index.totalBytes() == before + 3000, "Stored bytes do not add up.");
+
+                        // Oldest use: studies[1], then studies[0]; studies[2] is kept
+                        index.touchStudy(studies[0]);
+                        index.touchStudy(StudyUID);
+                        const auto removed = index.purgeLeastRecentlyUsed(before + 1000, {studies[2]});
+                        require(removed == 2, "Purge did not stop once the store fit.");
+                        require(index.getStudyRecords(studies[1]).empty() && index.getStudyRecords(studies[0]).empty(),
+                                "Least recently used studies were kept.");
+                        require(index.getStudyRecords(studies[2]).size() == 1, "Kept study was purged.");
+                        require(index.getStudyRecords(StudyUID).size() == 5, "Recently used study was purged.");
+                        require(index.totalBytes() == before + 1000, "Purged bytes still counted.");
+                        require(index.purgeLeastRecentlyUsed(0, {StudyUID, studies[2]}) == 0,
+                                "Kept studies were purged below the quota.");
+
+                        require(index.purgeLeastRecentlyUsed(before, {StudyUID}) == 1, "Quota purge failed.");
+                }
+
+                // Purging removes expired objects, their empty folders and their index entries
+                {
+                        DimseStorageIndex index(root.string());
+                        require(index.open(), "Index did not reopen.");
+                        const auto removed = index.purgeOlderThan(std::chrono::system_clock::now() + std::chrono::seconds(1));
+                        require(removed == 5, "Expired objects were not purged.");
+                        require(index.size() == 0, "Purged objects are still indexed.");
+
+                        std::size_t remaining = 0;
+                        for (const auto& entry : fs::recursive_directory_iterator(root))
+                        {
+                                if (entry.is_regular_file() && entry.path().extension() == ".dcm")
+                                {
+                                        ++remaining;
+                                }
+                        }
+                        require(remaining == 0, "Purged files remain on disk.");
+                }
+                {
+                        DimseStorageIndex index(root.string());
+                        require(index.open() && index.size() == 0, "Compacted journal still lists purged objects.");
+                }
+
+                fs::remove_all(root);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimsestorageindex_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimsestorageindex_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
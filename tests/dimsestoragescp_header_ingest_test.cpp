@@ -0,0 +1,176 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimsestoragescp_header_ingest_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Regression test for the direct ingest of SCP-received objects: the header read
+ *      by readReceivedInstanceHeader() must stop before Pixel Data and produce the same
+ *      repository entries as the regular file import path.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/corecontroller.h"
+#include "src/core/network/dimsestoragescp.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <QCoreApplication>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr Uint16 ImageSize = 8;
+
+        using isis::tests::require;
+
+        bool nearlyEqual(double lhs, double rhs)
+        {
+                return std::abs(lhs - rhs) < 1e-6;
+        }
+
+        void writeInstance(const std::filesystem::path& path, const char* sopInstanceUID, const char* position)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                ds->putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage);
+                ds->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID);
+                ds->putAndInsertString(DCM_StudyInstanceUID, "1.2.826.0.1.3680043.9.7433.5.1");
+                ds->putAndInsertString(DCM_SeriesInstanceUID, "1.2.826.0.1.3680043.9.7433.5.1.1");
+                ds->putAndInsertString(DCM_PatientName, "Ingest^Header");
+                ds->putAndInsertString(DCM_PatientID, "HDR001");
+                ds->putAndInsertString(DCM_PatientAge, "042Y");
+                ds->putAndInsertString(DCM_StudyDescription, "Header ingest");
+                ds->putAndInsertString(DCM_SeriesDescription, "Axial");
+                ds->putAndInsertString(DCM_SeriesNumber, "3");
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertString(DCM_InstanceNumber, "7");
+                ds->putAndInsertString(DCM_FrameOfReferenceUID, "1.2.826.0.1.3680043.9.7433.5.2");
+                ds->putAndInsertString(DCM_ImagePositionPatient, position);
+                ds->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+                ds->putAndInsertString(DCM_PixelSpacing, "0.5\\0.75");
+                ds->putAndInsertString(DCM_WindowCenter, "40");
+                ds->putAndInsertString(DCM_WindowWidth, "400");
+                ds->putAndInsertString(DCM_RescaleIntercept, "-1024");
+                ds->putAndInsertString(DCM_RescaleSlope, "1");
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                ds->putAndInsertUint16(DCM_Rows, ImageSize);
+                ds->putAndInsertUint16(DCM_Columns, ImageSize);
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                ds->putAndInsertUint16(DCM_BitsStored, 16);
+                ds->putAndInsertUint16(DCM_HighBit, 15);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                std::vector<Uint16> pixels(ImageSize * ImageSize, 1000);
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(),
+                                            static_cast<unsigned long>(pixels.size()));
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit);
+                require(cond.good(), std::string("Failed to write test instance: ") + cond.text());
+        }
+}
+
+int main()
+{
+        using namespace isis::core;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimsestoragescp_header_ingest_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_header_ingest";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                const auto firstPath = tempRoot / "1.2.826.0.1.3680043.9.7433.5.3.1.dcm";
+                const auto secondPath = tempRoot / "1.2.826.0.1.3680043.9.7433.5.3.2.dcm";
+                writeInstance(firstPath, "1.2.826.0.1.3680043.9.7433.5.3.1", "-100\\-120.5\\30");
+                writeInstance(secondPath, "1.2.826.0.1.3680043.9.7433.5.3.2", "-100\\-120.5\\32.5");
+
+                // Header parse: values as strings, padding trimmed, no pixel data
+                DicomInstanceHeader header;
+                require(network::readReceivedInstanceHeader(firstPath.string(), header),
+                        "Header of a valid instance was not parsed.");
+                require(header.filePath == firstPath.string(), "Header does not point at the stored file.");
+                require(header.getValue(0x0010, 0x0010) == "Ingest^Header", "Patient name was not read.");
+                require(header.getValue(0x0028, 0x0010) == "8", "Rows were not converted to a string.");
+                require(header.getValue(0x0028, 0x0030) == "0.5\\0.75", "Multi-valued spacing was not joined.");
+                require(header.getValue(0x0020, 0x0032) == "-100\\-120.5\\30", "Position was not read.");
+                require(header.values.count(DicomInstanceHeader::makeKey(0x7FE0, 0x0010)) == 0,
+                        "Pixel data leaked into the header.");
+
+                // Unreadable files are reported so the SCP falls back to the file callback
+                DicomInstanceHeader missing;
+                require(!network::readReceivedInstanceHeader((tempRoot / "missing.dcm").string(), missing),
+                        "Missing file produced a header.");
+
+                // The parsed header builds the same repository entries as the file import
+                CoreController parsed;
+                parsed.readParsedData(header);
+                DicomInstanceHeader secondHeader;
+                require(network::readReceivedInstanceHeader(secondPath.string(), secondHeader),
+                        "Header of the second instance was not parsed.");
+                parsed.readParsedData(secondHeader);
+
+                CoreController fromFiles;
+                fromFiles.readData(firstPath.string());
+                fromFiles.readData(secondPath.string());
+
+                require(parsed.getPatients().size() == 1, "Instances of one patient created several patients.");
+                require(parsed.getLastSeriesSize() == 2, "Second slice was not added to the series.");
+                require(parsed.getLastSeriesSize() == fromFiles.getLastSeriesSize(),
+                        "Series sizes differ from the file import.");
+
+                const Image* image = parsed.getLastImage();
+                const Image* reference = fromFiles.getLastImage();
+                require(image && reference, "No image inserted.");
+                require(image->getImagePath() == secondPath.string(), "Image path was not kept.");
+                require(image->getSOPInstanceUID() == reference->getSOPInstanceUID(), "SOP Instance UID differs.");
+                require(image->getWindowCenter() == 40 && image->getWindowWidth() == 400,
+                        "Window/level differs from the header.");
+                require(image->getWindowCenter() == reference->getWindowCenter() &&
+                        image->getWindowWidth() == reference->getWindowWidth(),
+                        "Window/level differs from the file import.");
+                require(nearlyEqual(image->getPixelSpacingX(), reference->getPixelSpacingX()) &&
+                        nearlyEqual(image->getPixelSpacingY(), reference->getPixelSpacingY()),
+                        "Pixel spacing differs from the file import.");
+                require(image->getImagePositionPatient() == reference->getImagePositionPatient(),
+                        "Image position differs from the file import.");
+                require(image->getImageOrientationRow() == reference->getImageOrientationRow() &&
+                        image->getImageOrientationColumn() == reference->getImageOrientationColumn(),
+                        "Image orientation differs from the file import.");
+                require(image->getInstanceNumber() == 7, "Instance number was not read.");
+                require(image->getFrameOfRefernceID() == reference->getFrameOfRefernceID(),
+                        "Frame of reference differs from the file import.");
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimsestoragescp_header_ingest_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimsestoragescp_header_ingest_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,336 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: dimsestore_compression_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Loopback test for compressed C-STORE transfers: a peer with compressStore set
+ *      sends images as JPEG-LS lossless and other objects as Deflate, the Storage SCP
+ *      keeps them in the negotiated syntax, and the decoded pixels match the source
+ *      exactly. Peers without compression and SCPs that refuse it fall back to
+ *      uncompressed transfers.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/network/dimseservices.h"
+#include "src/core/network/dimsestoragescp.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcmetinf.h>
+#include <dcmtk/dcmdata/dcuid.h>
+#include <dcmtk/dcmdata/dcxfer.h>
+#include <dcmtk/dcmjpls/djdecode.h>
+
+#include <QCoreApplication>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+        constexpr int CompressingScpPort = 11195;
+        constexpr int PlainScpPort = 11196;
+        constexpr const char* StudyUID = "1.2.826.0.1.3680043.9.7433.9.1";
+        constexpr const char* SeriesUID = "1.2.826.0.1.3680043.9.7433.9.1.1";
+        constexpr Uint16 Rows = 64;
+        constexpr Uint16 Columns = 48;
+
+        using isis::tests::require;
+
+        void addCommonAttributes(DcmDataset* ds, const char* sopClassUID, const std::string& sopInstanceUID)
+        {
+                ds->putAndInsertString(DCM_SOPClassUID, sopClassUID);
+                ds->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID.c_str());
+                ds->putAndInsertString(DCM_StudyInstanceUID, StudyUID);
+                ds->putAndInsertString(DCM_SeriesInstanceUID, SeriesUID);
+                ds->putAndInsertString(DCM_PatientName, "Compression^Loopback");
+                ds->putAndInsertString(DCM_PatientID, "CMP001");
+        }
+
+        // 16-bit CT with a full-range pattern, so any lossy step would show
+        std::vector<Uint16> writeCtImage(const std::filesystem::path& path, const std::string& sopInstanceUID)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                addCommonAttributes(ds, UID_CTImageStorage, sopInstanceUID);
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                ds->putAndInsertUint16(DCM_Rows, Rows);
+                ds->putAndInsertUint16(DCM_Columns, Columns);
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                ds->putAndInsertUint16(DCM_BitsStored, 16);
+                ds->putAndInsertUint16(DCM_HighBit, 15);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                std::vector<Uint16> pixels(static_cast<std::size_t>(Rows) * Columns);
+                for (std::size_t i = 0; i < pixels.size(); ++i)
+                {
+                        pixels[i] = static_cast<Uint16>((i * 2654435761u) >> 7);
+                }
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+                require(fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit).good(),
+                        "Failed to write CT image.");
+                return pixels;
+        }
+
+        std::vector<Uint8> writeRgbImage(const std::filesystem::path& path, const std::string& sopInstanceUID)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                addCommonAttributes(ds, UID_SecondaryCaptureImageStorage, sopInstanceUID);
+                ds->putAndInsertString(DCM_Modality, "OT");
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 3);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "RGB");
+                ds->putAndInsertUint16(DCM_PlanarConfiguration, 0);
+                ds->putAndInsertUint16(DCM_Rows, Rows);
+                ds->putAndInsertUint16(DCM_Columns, Columns);
+                ds->putAndInsertUint16(DCM_BitsAllocated, 8);
+                ds->putAndInsertUint16(DCM_BitsStored, 8);
+                ds->putAndInsertUint16(DCM_HighBit, 7);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                std::vector<Uint8> pixels(static_cast<std::size_t>(Rows) * Columns * 3);
+                for (std::size_t i = 0; i < pixels.size(); ++i)
+                {
+                        pixels[i] = static_cast<Uint8>((i * 31) ^ (i >> 5));
+                }
+                ds->putAndInsertUint8Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+                require(fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianImplicit).good(),
+                        "Failed to write RGB image.");
+                return pixels;
+        }
+
+        // Without pixel data: only Deflate applies
+        void writeDocument(const std::filesystem::path& path, const std::string& sopInstanceUID)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                addCommonAttributes(ds, UID_EncapsulatedPDFStorage, sopInstanceUID);
+                ds->putAndInsertString(DCM_Modality, "DOC");
+                ds->putAndInsertString(DCM_DocumentTitle, std::string(512, 'A').c_str());
+                ds->putAndInsertString(DCM_MIMETypeOfEncapsulatedDocument, "application/pdf");
+                require(fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit).good(),
+                        "Failed to write document.");
+        }
+
+        class Receiver
+        {
+        public:
+                void record(const std::string& path)
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        DcmFileFormat fileFormat;
+                        OFString sopInstanceUID;
+                        if (fileFormat.loadFile(path.c_str()).good() &&
+                            fileFormat.getDataset()->findAndGetOFString(DCM_SOPInstanceUID, sopInstanceUID).good())
+                        {
+                                m_paths[sopInstanceUID.c_str()] = path;
+                        }
+                }
+
+                std::string pathOf(const std::string& sopInstanceUID)
+                {
+                        // The callback runs on the SCP worker after the response has been sent
+                        for (int i = 0; i < 100; ++i)
+                        {
+                                {
+                                        std::lock_guard<std::mutex> lock(m_mutex);
+                                        const auto it = m_paths.find(sopInstanceUID);
+                                        if (it != m_paths.end())
+                                        {
+                                                return it->second;
+                                        }
+                                }
+                                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                        }
+                        throw std::runtime_error("Object " + sopInstanceUID + " was not received.");
+                }
+
+                void clear()
+                {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_paths.clear();
+                }
+
+        private:
+                std::mutex m_mutex;
+                std::map<std::string, std::string> m_paths;
+        };
+
+        std::string storedSyntax(DcmFileFormat& fileFormat)
+        {
+                OFString transferSyntax;
+                fileFormat.getMetaInfo()->findAndGetOFString(DCM_TransferSyntaxUID, transferSyntax);
+                return transferSyntax.c_str();
+        }
+
+        // Load a received file, check the syntax it was kept in and decode it
+        void loadReceived(const std::string& path, const char* expectedSyntax, DcmFileFormat& fileFormat)
+        {
+                require(fileFormat.loadFile(path.c_str()).good(), "Received file is unreadable: " + path);
+                require(storedSyntax(fileFormat) == expectedSyntax,
+                        "Received file kept as " + storedSyntax(fileFormat) + ", expected " + expectedSyntax);
+                require(fileFormat.getDataset()->chooseRepresentation(EXS_LittleEndianExplicit, nullptr).good(),
+                        "Received file could not be decoded: " + path);
+        }
+
+        void requireSamePixels(const std::string& path, const char* expectedSyntax, const std::vector<Uint16>& expected)
+        {
+                DcmFileFormat fileFormat;
+                loadReceived(path, expectedSyntax, fileFormat);
+                const Uint16* pixels = nullptr;
+                unsigned long count = 0;
+                require(fileFormat.getDataset()->findAndGetUint16Array(DCM_PixelData, pixels, &count).good() &&
+                        count == expected.size(), "Decoded 16-bit pixel data has the wrong size.");
+                require(std::equal(expected.begin(), expected.end(), pixels), "16-bit pixels changed in transfer.");
+        }
+
+        void requireSamePixels(const std::string& path, const char* expectedSyntax, const std::vector<Uint8>& expected)
+        {
+                DcmFileFormat fileFormat;
+                loadReceived(path, expectedSyntax, fileFormat);
+                const Uint8* pixels = nullptr;
+                unsigned long count = 0;
+                require(fileFormat.getDataset()->findAndGetUint8Array(DCM_PixelData, pixels, &count).good() &&
+                        count == expected.size(), "Decoded 8-bit pixel data has the wrong size.");
+                require(std::equal(expected.begin(), expected.end(), pixels), "RGB pixels changed in transfer.");
+        }
+}
+
+int main()
+{
+        using namespace isis::core::network;
+        namespace fs = std::filesystem;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "dimsestore_compression_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                DJLSDecoderRegistration::registerCodecs();
+
+                const auto root = fs::temp_directory_path() / "isis_store_compression";
+                fs::remove_all(root);
+                fs::create_directories(root / "source");
+
+                const std::string ctUID = std::string(SeriesUID) + ".1";
+                const std::string rgbUID = std::string(SeriesUID) + ".2";
+                const std::string docUID = std::string(SeriesUID) + ".3";
+                const auto ctPixels = writeCtImage(root / "source" / "ct.dcm", ctUID);
+                const auto rgbPixels = writeRgbImage(root / "source" / "rgb.dcm", rgbUID);
+                writeDocument(root / "source" / "doc.dcm", docUID);
+                const std::vector<std::string> files = {
+                        (root / "source" / "ct.dcm").string(),
+                        (root / "source" / "rgb.dcm").string(),
+                        (root / "source" / "doc.dcm").string()
+                };
+
+                Receiver received;
+                LocalAEConfig scpConfig;
+                scpConfig.aeTitle = "CMP_SCP";
+                scpConfig.storagePort = CompressingScpPort;
+                scpConfig.tempStoragePath = (root / "compressing").string();
+                scpConfig.hierarchicalStorage = false;
+                scpConfig.maxAssociationsPerAE = 0;
+                DimseStorageSCP compressingScp(scpConfig, nullptr);
+                compressingScp.setStorageReceivedCallback([&received](const std::string& path) { received.record(path); });
+                require(compressingScp.start(), "Compressing Storage SCP failed to start.");
+
+                LocalAEConfig plainConfig = scpConfig;
+                plainConfig.aeTitle = "PLAIN_SCP";
+                plainConfig.storagePort = PlainScpPort;
+                plainConfig.tempStoragePath = (root / "plain").string();
+                plainConfig.acceptCompressed = false;
+                DimseStorageSCP plainScp(plainConfig, nullptr);
+                plainScp.setStorageReceivedCallback([&received](const std::string& path) { received.record(path); });
+                require(plainScp.start(), "Uncompressed Storage SCP failed to start.");
+
+                LocalAEConfig client;
+                client.aeTitle = "CMP_SCU";
+                client.enableStorage = false;
+
+                auto pool = std::make_shared<DimseConnectionPool>(2);
+                DimseStoreService store(pool, nullptr);
+                store.setMaxAssociations(1);
+
+                // Images go out as JPEG-LS lossless, the document as Deflate; all are kept as is
+                DicomPeer compressingPeer("cmp", "Compressing", "CMP_SCP", "127.0.0.1", CompressingScpPort);
+                compressingPeer.compressStore = true;
+                require(store.storeFiles(compressingPeer, client, files) == DimseStatus::Success,
+                        "Compressed C-STORE failed: " + store.getLastError());
+                requireSamePixels(received.pathOf(ctUID), UID_JPEGLSLosslessTransferSyntax, ctPixels);
+                requireSamePixels(received.pathOf(rgbUID), UID_JPEGLSLosslessTransferSyntax, rgbPixels);
+                {
+                        DcmFileFormat document;
+                        loadReceived(received.pathOf(docUID), UID_DeflatedExplicitVRLittleEndianTransferSyntax, document);
+                        OFString title;
+                        document.getDataset()->findAndGetOFString(DCM_DocumentTitle, title);
+                        require(title == OFString(512, 'A'), "Deflated document changed in transfer.");
+                }
+                require(fs::file_size(received.pathOf(ctUID)) < fs::file_size(files[0]),
+                        "JPEG-LS object is not smaller than the uncompressed source.");
+
+                // A JPEG-LS file is then forwarded as stored, without recompression
+                received.clear();
+                require(store.storeFile(compressingPeer, client, compressingScp.getStorageDirectory() + "/" + ctUID + ".dcm")
+                                == DimseStatus::Success,
+                        "Forwarding a compressed file failed: " + store.getLastError());
+                requireSamePixels(received.pathOf(ctUID), UID_JPEGLSLosslessTransferSyntax, ctPixels);
+                pool->clear();
+
+                // Without compression the peer gets the uncompressed defaults
+                received.clear();
+                DicomPeer uncompressedPeer = compressingPeer;
+                uncompressedPeer.compressStore = false;
+                require(store.storeFiles(uncompressedPeer, client, files) == DimseStatus::Success,
+                        "Uncompressed C-STORE failed: " + store.getLastError());
+                requireSamePixels(received.pathOf(ctUID), UID_LittleEndianExplicitTransferSyntax, ctPixels);
+                requireSamePixels(received.pathOf(rgbUID), UID_LittleEndianExplicitTransferSyntax, rgbPixels);
+                pool->clear();
+
+                // An SCP that refuses compression gets uncompressed objects from a compressing peer
+                received.clear();
+                DicomPeer plainPeer("plain", "Plain", "PLAIN_SCP", "127.0.0.1", PlainScpPort);
+                plainPeer.compressStore = true;
+                require(store.storeFiles(plainPeer, client, files) == DimseStatus::Success,
+                        "C-STORE to the uncompressed SCP failed: " + store.getLastError());
+                requireSamePixels(received.pathOf(ctUID), UID_LittleEndianExplicitTransferSyntax, ctPixels);
+                requireSamePixels(received.pathOf(rgbUID), UID_LittleEndianExplicitTransferSyntax, rgbPixels);
+                {
+                        DcmFileFormat document;
+                        loadReceived(received.pathOf(docUID), UID_LittleEndianExplicitTransferSyntax, document);
+                }
+
+                pool->clear();
+                compressingScp.stop();
+                plainScp.stop();
+                DJLSDecoderRegistration::cleanup();
+                fs::remove_all(root);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "dimsestore_compression_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "dimsestore_compression_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: gzipinputstream_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks the streaming gzip input: bytes and seeks through small buffers
+ *      match the original file, concatenated members are read through, GDCM
+ *      parses the header of a .dcm.gz without its pixel data, and a gzip'd
+ *      series loads into the same volume as the plain series, with a window
+ *      taken from its pixel range.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/dicomseriesloader.h"
+#include "src/core/gzipinputstream.h"
+#include "tests/testsupport.h"
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <gdcmReader.h>
+
+#include <vtkImageData.h>
+#include <vtk_zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr int SliceCount = 6;
+        constexpr Uint16 ImageSize = 32;
+
+        using isis::tests::require;
+
+        std::string readAll(const std::filesystem::path& path)
+        {
+                std::ifstream file(path, std::ios::binary);
+                return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        }
+
+        std::string gzip(const std::string& data)
+        {
+                z_stream stream = {};
+                require(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK,
+                        "Could not start deflate.");
+                std::string compressed(deflateBound(&stream, static_cast<uLong>(data.size())) + 32, '\0');
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+                stream.avail_in = static_cast<uInt>(data.size());
+                stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+                stream.avail_out = static_cast<uInt>(compressed.size());
+                require(deflate(&stream, Z_FINISH) == Z_STREAM_END, "Could not deflate.");
+                compressed.resize(stream.total_out);
+                deflateEnd(&stream);
+                return compressed;
+        }
+
+        void writeFile(const std::filesystem::path& path, const std::string& data)
+        {
+                std::ofstream file(path, std::ios::binary);
+                file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                require(static_cast<bool>(file), "Could not write " + path.string());
+        }
+
+        void writeSlice(const std::filesystem::path& path, int slice)
+        {
+                DcmFileFormat fileFormat;
+                DcmDataset* ds = fileFormat.getDataset();
+                ds->putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage);
+                ds->putAndInsertString(DCM_SOPInstanceUID,
+                        ("1.2.826.0.1.3680043.9.7433.11.1." + std::to_string(slice + 1)).c_str());
+                ds->putAndInsertString(DCM_SeriesInstanceUID, "1.2.826.0.1.3680043.9.7433.11.2");
+                ds->putAndInsertString(DCM_PatientName, "Gzip^Import");
+                ds->putAndInsertString(DCM_PatientID, "GZIP001");
+                ds->putAndInsertString(DCM_Modality, "CT");
+                ds->putAndInsertString(DCM_InstanceNumber, std::to_string(slice + 1).c_str());
+                ds->putAndInsertString(DCM_ImagePositionPatient, ("-10\\-20\\" + std::to_string(slice * 3)).c_str());
+                ds->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+                ds->putAndInsertString(DCM_PixelSpacing, "0.75\\0.75");
+                ds->putAndInsertString(DCM_SliceThickness, "3");
+                ds->putAndInsertUint16(DCM_Rows, ImageSize);
+                ds->putAndInsertUint16(DCM_Columns, ImageSize);
+                ds->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+                ds->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                ds->putAndInsertUint16(DCM_BitsAllocated, 16);
+                ds->putAndInsertUint16(DCM_BitsStored, 16);
+                ds->putAndInsertUint16(DCM_HighBit, 15);
+                ds->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+                std::vector<Uint16> pixels(static_cast<std::size_t>(ImageSize) * ImageSize);
+                for (std::size_t pixel = 0; pixel < pixels.size(); ++pixel)
+                {
+                        pixels[pixel] = static_cast<Uint16>(slice * 1000 + pixel);
+                }
+                ds->putAndInsertUint16Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+
+                const OFCondition cond = fileFormat.saveFile(path.string().c_str(), EXS_LittleEndianExplicit);
+                require(cond.good(), std::string("Failed to write test slice: ") + cond.text());
+        }
+
+        std::string readStream(std::istream& stream)
+        {
+                std::string data;
+                char chunk[777];
+                while (stream.read(chunk, sizeof(chunk)) || stream.gcount() > 0)
+                {
+                        data.append(chunk, static_cast<std::size_t>(stream.gcount()));
+                }
+                return data;
+        }
+
+        void checkStream(const std::filesystem::path& plainPath, const std::filesystem::path& gzipPath)
+        {
+                const std::string original = readAll(plainPath);
+                require(isis::core::GzipInputStream::isGzipFile(gzipPath.string())
+                        && !isis::core::GzipInputStream::isGzipFile(plainPath.string()), "Gzip magic not recognised.");
+
+                isis::core::GzipInputStream stream(gzipPath.string(), 1024);
+                require(readStream(stream) == original, "Inflated bytes differ from the original.");
+
+                // Forward, backward and end-relative seeks across buffer boundaries
+                stream.clear();
+                char bytes[16] = {};
+                for (const std::streamoff offset : {std::streamoff(3000), std::streamoff(132), std::streamoff(1500)})
+                {
+                        require(static_cast<bool>(stream.seekg(offset)) && stream.read(bytes, sizeof(bytes))
+                                && std::string(bytes, sizeof(bytes)) == original.substr(static_cast<std::size_t>(offset), sizeof(bytes)),
+                                "Seek to " + std::to_string(offset) + " read the wrong bytes.");
+                        require(stream.tellg() == offset + static_cast<std::streamoff>(sizeof(bytes)), "tellg is wrong after a seek.");
+                }
+                stream.seekg(0, std::ios::end);
+                require(stream.tellg() == static_cast<std::streamoff>(original.size()), "End of stream has the wrong offset.");
+
+                // Two gzip members one after the other
+                const auto twoMembers = gzipPath.parent_path() / "two_members.dcm.gz";
+                const std::size_t half = original.size() / 2;
+                writeFile(twoMembers, gzip(original.substr(0, half)) + gzip(original.substr(half)));
+                isis::core::GzipInputStream concatenated(twoMembers.string(), 1024);
+                require(readStream(concatenated) == original, "Second gzip member was not read.");
+
+                isis::core::GzipInputStream missing((gzipPath.parent_path() / "missing.dcm.gz").string());
+                require(!missing, "Missing file opened.");
+        }
+
+        void checkHeaderOnlyParse(const std::filesystem::path& gzipPath)
+        {
+                isis::core::GzipInputStream stream(gzipPath.string());
+                gdcm::Reader reader;
+                reader.SetStream(stream);
+                require(reader.ReadUpToTag(gdcm::Tag(0x7fe0, 0x0010)), "Header of the .dcm.gz was not parsed.");
+                const gdcm::DataSet& dataSet = reader.GetFile().GetDataSet();
+                require(dataSet.FindDataElement(gdcm::Tag(0x0010, 0x0020)), "Patient ID missing from the parsed header.");
+                const gdcm::ByteValue* patientId = dataSet.GetDataElement(gdcm::Tag(0x0010, 0x0020)).GetByteValue();
+                require(patientId && std::string(patientId->GetPointer(), patientId->GetLength()).rfind("GZIP001", 0) == 0,
+                        "Patient ID read from the .dcm.gz is wrong.");
+                require(!dataSet.FindDataElement(gdcm::Tag(0x7fe0, 0x0010)), "Pixel data was read with the header.");
+        }
+
+        void checkSeries(const std::vector<std::string>& plainPaths, std::vector<std::string> gzipPaths)
+        {
+                // Given out of order: the gzip path sorts along the slice normal like the plain one
+                std::reverse(gzipPaths.begin(), gzipPaths.end());
+                const auto plain = isis::core::seriesloader::loadVolumeFromSeries(plainPaths);
+                const auto inflated = isis::core::seriesloader::loadVolumeFromSeries(gzipPaths);
+                require(plain && plain->ImageData && inflated && inflated->ImageData, "Series volume not loaded.");
+
+                int plainDimensions[3] = {};
+                int inflatedDimensions[3] = {};
+                plain->ImageData->GetDimensions(plainDimensions);
+                inflated->ImageData->GetDimensions(inflatedDimensions);
+                require(std::equal(std::begin(plainDimensions), std::end(plainDimensions), std::begin(inflatedDimensions))
+                        && inflatedDimensions[2] == SliceCount, "Gzip series has the wrong dimensions.");
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        require(std::abs(plain->Geometry.Origin[axis] - inflated->Geometry.Origin[axis]) < 1e-6
+                                && std::abs(plain->Geometry.Spacing[axis] - inflated->Geometry.Spacing[axis]) < 1e-6,
+                                "Gzip series geometry differs from the plain series.");
+                }
+                for (int z = 0; z < SliceCount; ++z)
+                {
+                        for (int y = 0; y < ImageSize; y += 7)
+                        {
+                                for (int x = 0; x < ImageSize; x += 5)
+                                {
+                                        require(plain->ImageData->GetScalarComponentAsDouble(x, y, z, 0)
+                                                == inflated->ImageData->GetScalarComponentAsDouble(x, y, z, 0),
+                                                "Gzip series voxel differs from the plain series.");
+                                }
+                        }
+                }
+                require(inflated->SourceFiles.front() == gzipPaths.back(), "Gzip series slices were not sorted.");
+
+                // No window in the headers: it comes from the decoded values
+                double range[2] = {};
+                inflated->ImageData->GetScalarRange(range);
+                require(std::abs(inflated->PixelInfo.WindowWidth - (range[1] - range[0])) < 1e-6
+                        && std::abs(inflated->PixelInfo.WindowCenter - (range[0] + range[1]) * 0.5) < 1e-6,
+                        "Gzip series window was not taken from its pixel range.");
+        }
+}
+
+int main()
+{
+        try
+        {
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_gzip_import";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot / "plain");
+                std::filesystem::create_directories(tempRoot / "gzip");
+
+                std::vector<std::string> plainPaths;
+                std::vector<std::string> gzipPaths;
+                for (int slice = 0; slice < SliceCount; ++slice)
+                {
+                        const auto plainPath = tempRoot / "plain" / ("slice" + std::to_string(slice) + ".dcm");
+                        const auto gzipPath = tempRoot / "gzip" / ("slice" + std::to_string(slice) + ".dcm.gz");
+                        writeSlice(plainPath, slice);
+                        writeFile(gzipPath, gzip(readAll(plainPath)));
+                        plainPaths.push_back(plainPath.string());
+                        gzipPaths.push_back(gzipPath.string());
+                }
+
+                checkStream(plainPaths.front(), gzipPaths.front());
+                checkHeaderOnlyParse(gzipPaths.front());
+                checkSeries(plainPaths, gzipPaths);
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "gzipinputstream_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "gzipinputstream_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
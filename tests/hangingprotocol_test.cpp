@@ -0,0 +1,140 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: hangingprotocol_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks the hanging protocol engine: a chest CT is recognised from its
+ *      body part or its descriptions and shown twice with two windows, brain
+ *      MR sequences go to their own viewports, a study with a prior is shown
+ *      next to the prior series with the same description, unrelated studies
+ *      match nothing, and protocols survive a round trip through JSON.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/gui/hangingprotocol.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryDir>
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        using isis::tests::require;
+
+        isis::gui::HangingSeries series(const std::string& modality, const std::string& description,
+                                        int prior = 0, const std::string& bodyPart = {})
+        {
+                isis::gui::HangingSeries offered;
+                offered.modality = modality;
+                offered.description = description;
+                offered.bodyPart = bodyPart;
+                offered.prior = prior;
+                return offered;
+        }
+
+        std::string protocolName(const std::optional<isis::gui::HangingPlan>& plan)
+        {
+                return plan ? plan->protocol->name : std::string("none");
+        }
+}
+
+int main(int argc, char* argv[])
+{
+        using namespace isis::gui;
+        QCoreApplication app(argc, argv);
+
+        try
+        {
+                const HangingProtocolEngine engine;
+
+                // Chest CT named only in the series description
+                const std::vector<HangingSeries> chest = {series("CT", "Thorax 1.0 B70f"), series("CT", "Scout")};
+                auto plan = engine.match(chest);
+                require(protocolName(plan) == "CT Chest", "Chest CT matched " + protocolName(plan) + ".");
+                require(plan->viewportSeries.size() == 2 && plan->viewportSeries[0] == 0
+                        && plan->viewportSeries[1] == 0, "Chest CT viewports do not share the first series.");
+                require(plan->protocol->viewports[0].windowWidth == 1500.0
+                        && plan->protocol->viewports[1].windowWidth == 400.0, "Chest CT windows are wrong.");
+
+                // Body Part Examined alone is enough
+                plan = engine.match({series("CT", "Axial 5mm", 0, "CHEST")});
+                require(protocolName(plan) == "CT Chest", "Body part CHEST matched " + protocolName(plan) + ".");
+
+                // Brain MR: each sequence in its own viewport, whatever the import order
+                const std::vector<HangingSeries> brain = {
+                        series("MR", "t2_tse_tra", 0, "HEAD"),
+                        series("MR", "localizer", 0, "HEAD"),
+                        series("MR", "t1_mprage_sag", 0, "HEAD"),
+                        series("MR", "t2_flair_tra", 0, "HEAD")};
+                plan = engine.match(brain);
+                require(protocolName(plan) == "MR Brain", "Brain MR matched " + protocolName(plan) + ".");
+                require(plan->viewportSeries == std::vector<int>({2, 3, 0}), "Brain MR sequences are misplaced.");
+
+                // Current study next to the prior series with the same description
+                const std::vector<HangingSeries> comparison = {
+                        series("CT", "Abdomen venous"),
+                        series("CT", "Abdomen arterial", 1),
+                        series("CT", "Abdomen venous", 1),
+                        series("CT", "Abdomen venous", 2)};
+                plan = engine.match(comparison);
+                require(protocolName(plan) == "CT with prior", "CT with prior matched " + protocolName(plan) + ".");
+                require(plan->viewportSeries == std::vector<int>({0, 2}), "Prior with the same description not chosen.");
+
+                // A chest CT with a prior is still hung as a chest CT
+                plan = engine.match({series("CT", "Thorax"), series("CT", "Thorax", 1)});
+                require(protocolName(plan) == "CT Chest", "Chest CT with prior matched " + protocolName(plan) + ".");
+
+                // Nothing for an ultrasound study, nor for a prior without a current study
+                require(!engine.match({series("US", "Liver")}).has_value(), "Ultrasound study matched a protocol.");
+                require(!engine.match({series("CT", "Thorax", 1)}).has_value(), "Prior alone matched a protocol.");
+                require(!engine.match({}).has_value(), "No series matched a protocol.");
+
+                // Round trip through the JSON file
+                QTemporaryDir directory;
+                require(directory.isValid(), "Could not create a temporary folder.");
+                const QString path = QDir(directory.path()).filePath(QStringLiteral("hanging_protocols.json"));
+                HangingProtocolEngine custom;
+                auto protocols = custom.protocols();
+                protocols[0].viewports[1].rotationSteps = 1;
+                protocols[0].viewports[1].flipHorizontal = true;
+                protocols[0].viewports[1].invert = true;
+                custom.setProtocols(protocols);
+                QString error;
+                require(custom.saveToFile(path, error), "Could not save protocols: " + error.toStdString());
+
+                HangingProtocolEngine loaded;
+                loaded.setProtocols({});
+                require(loaded.loadFromFile(path, error), "Could not load protocols: " + error.toStdString());
+                require(loaded.protocols().size() == protocols.size(), "Protocols were lost in the round trip.");
+                const auto& rule = loaded.protocols()[0].viewports[1];
+                require(rule.sameAs == 0 && rule.windowCenter == 40.0 && rule.windowWidth == 400.0
+                        && rule.rotationSteps == 1 && rule.flipHorizontal && !rule.flipVertical && rule.invert,
+                        "Viewport rule changed in the round trip.");
+                require(protocolName(loaded.match(comparison)) == "CT with prior", "Loaded protocols match differently.");
+
+                require(!loaded.loadFromFile(QDir(directory.path()).filePath(QStringLiteral("missing.json")), error)
+                        && !error.isEmpty(), "Missing file was loaded.");
+                require(loaded.protocols().size() == protocols.size(), "Failed load replaced the protocols.");
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "hangingprotocol_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "hangingprotocol_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
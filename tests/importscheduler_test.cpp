@@ -0,0 +1,171 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: importscheduler_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks the import queue: a folder scan waits while the queue is full,
+ *      the folders of the opened series jump ahead of queued scans, cancelling
+ *      a folder drops its paths and releases its waiting scan, and the
+ *      statistics follow.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/importscheduler.h"
+#include "tests/testsupport.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+        using isis::core::ImportScheduler;
+
+        using isis::tests::require;
+
+        std::string popPath(ImportScheduler& scheduler)
+        {
+                const auto item = scheduler.tryPop();
+                require(item.has_value(), "Queue unexpectedly empty.");
+                scheduler.markImported();
+                return item->Path;
+        }
+
+        void checkBackpressure()
+        {
+                constexpr int Capacity = 8;
+                constexpr int Files = 100;
+                ImportScheduler scheduler(Capacity);
+                scheduler.beginRoot("/share");
+
+                std::atomic<int> scanned{0};
+                std::thread scan([&]()
+                {
+                        for (int file = 0; file < Files; ++file)
+                        {
+                                if (!scheduler.pushScanned("/share", "/share/a/" + std::to_string(file) + ".dcm"))
+                                {
+                                        break;
+                                }
+                                ++scanned;
+                        }
+                        scheduler.endRoot("/share");
+                });
+
+                // The scan stops at the bound until the consumer takes paths
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                require(scanned == Capacity, "Scan did not stop at the queue bound.");
+                require(scheduler.statistics().Queued == Capacity && scheduler.statistics().ScanWaits == 1,
+                        "Statistics do not show the full queue.");
+
+                // Paths come out in the order they were found
+                for (int file = 0; file < Files; ++file)
+                {
+                        while (scheduler.isEmpty())
+                        {
+                                std::this_thread::yield();
+                        }
+                        require(popPath(scheduler) == "/share/a/" + std::to_string(file) + ".dcm",
+                                "Scanned paths out of order.");
+                        require(scheduler.statistics().Queued <= Capacity, "Queue grew past its bound.");
+                }
+                scan.join();
+                require(scheduler.statistics().Imported == Files && scheduler.activeRoots().empty(),
+                        "Finished scan still reported.");
+        }
+
+        void checkPriorities()
+        {
+                ImportScheduler scheduler(64);
+                scheduler.beginRoot("/studies");
+                for (const char* path : {"/studies/ct/1.dcm", "/studies/mr/1.dcm", "/studies/ct/2.dcm", "/studies/mr/2.dcm"})
+                {
+                        require(scheduler.pushScanned("/studies", path), "Scanned path refused.");
+                }
+                scheduler.push("/picked/one.dcm");
+
+                // Single files go before folder scans
+                require(popPath(scheduler) == "/picked/one.dcm", "Picked file did not go first.");
+
+                // Opening a series in /studies/mr moves its folder ahead, now and for later paths
+                scheduler.prioritizeFoldersOf({"/studies/mr/1.dcm"});
+                require(scheduler.pushScanned("/studies", "/studies/ct/3.dcm")
+                        && scheduler.pushScanned("/studies", "/studies/mr/3.dcm"), "Scanned path refused.");
+                const std::vector<std::string> expected = {
+                        "/studies/mr/1.dcm", "/studies/mr/2.dcm", "/studies/mr/3.dcm",
+                        "/studies/ct/1.dcm", "/studies/ct/2.dcm", "/studies/ct/3.dcm"};
+                for (const auto& path : expected)
+                {
+                        require(popPath(scheduler) == path, "Priority order wrong at " + path);
+                }
+                require(!scheduler.tryPop(), "Queue not empty.");
+        }
+
+        void checkCancellation()
+        {
+                ImportScheduler scheduler(4);
+                scheduler.beginRoot("/big");
+                scheduler.beginRoot("/small");
+                require(scheduler.pushScanned("/small", "/small/1.dcm"), "Scanned path refused.");
+
+                std::atomic<bool> stopped{false};
+                std::thread scan([&]()
+                {
+                        for (int file = 0; scheduler.pushScanned("/big", "/big/" + std::to_string(file) + ".dcm"); ++file)
+                        {
+                        }
+                        scheduler.endRoot("/big");
+                        stopped = true;
+                });
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                require(!stopped, "Scan did not wait for room.");
+
+                // Cancelling releases the waiting scan and keeps the other folder
+                require(scheduler.cancelRoot("/big") == 3, "Cancelled folder kept queued paths.");
+                scan.join();
+                require(stopped, "Cancelled scan did not stop.");
+                require(popPath(scheduler) == "/small/1.dcm" && !scheduler.tryPop(), "Other folder lost its path.");
+                const auto statistics = scheduler.statistics();
+                require(statistics.Cancelled == 3 && statistics.Queued == 0, "Cancelled paths not counted.");
+                require(scheduler.activeRoots() == std::vector<std::string>{"/small"}, "Active folders wrong.");
+
+                // Scanning the folder again clears the cancellation
+                scheduler.beginRoot("/big");
+                require(scheduler.pushScanned("/big", "/big/again.dcm"), "Folder stayed cancelled.");
+
+                // Closing releases scans for a stop; reset accepts paths again
+                scheduler.close();
+                require(!scheduler.pushScanned("/small", "/small/2.dcm"), "Closed queue accepted a scan.");
+                scheduler.reset();
+                require(scheduler.isEmpty() && scheduler.activeRoots().empty(), "Reset kept paths.");
+        }
+}
+
+int main()
+{
+        try
+        {
+                checkBackpressure();
+                checkPriorities();
+                checkCancellation();
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "importscheduler_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "importscheduler_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,344 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: measurementreport_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Round-trip test for the DICOM SR measurement report: distances, angles,
+ *      bidimensional and contour measurements written to a TID 1500 report are
+ *      read back with the same coordinates, source references and values,
+ *      positions picked in a 2D view of an oblique series are written at their
+ *      patient coordinates, and the background service batches imports and
+ *      coalesces repeated exports.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/gui/measures/measurementreport.h"
+#include "src/gui/measures/measurementreportservice.h"
+#include "src/gui/measures/slicegeometry.h"
+#include "tests/testsupport.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        // Coordinates are stored as FL (32-bit) in SCOORD3D
+        constexpr double CoordinateTolerance = 1e-3;
+        constexpr double ValueTolerance = 1e-3;
+
+        const std::string SeriesUID = "1.2.826.0.1.3680043.9.7433.92.1";
+        const std::string CTImageStorage = "1.2.840.10008.5.1.4.1.1.2";
+        const std::string EnhancedCTImageStorage = "1.2.840.10008.5.1.4.1.1.2.1";
+
+        using isis::tests::require;
+
+        isis::gui::measures::SlicePlane slice(int index)
+        {
+                isis::gui::measures::SlicePlane plane;
+                plane.origin = {-180.5, -201.25, -40.0 + index * 2.5};
+                plane.sopInstanceUID = "1.2.826.0.1.3680043.9.7433.92.2." + std::to_string(index + 1);
+                plane.sopClassUID = CTImageStorage;
+                plane.frameOfReferenceUID = "1.2.826.0.1.3680043.9.7433.92.3";
+                return plane;
+        }
+
+        isis::gui::measures::Annotation annotationOn(const isis::gui::measures::SlicePlane& plane,
+                                                     isis::gui::measures::AnnotationType type,
+                                                     const std::vector<std::pair<double, double>>& points)
+        {
+                isis::gui::measures::Annotation annotation;
+                annotation.type = type;
+                annotation.seriesInstanceUID = SeriesUID;
+                annotation.sopInstanceUID = plane.sopInstanceUID;
+                annotation.sopClassUID = plane.sopClassUID;
+                annotation.frameOfReferenceUID = plane.frameOfReferenceUID;
+                annotation.frameNumber = plane.frameNumber;
+                annotation.trackingUID = isis::gui::measures::generateTrackingUID();
+                for (const auto& [x, y] : points)
+                {
+                        annotation.points.push_back(plane.toPatient(x, y));
+                }
+                return annotation;
+        }
+
+        std::vector<isis::gui::measures::Annotation> sampleAnnotations()
+        {
+                using namespace isis::gui::measures;
+
+                std::vector<Annotation> annotations;
+                Annotation distance = annotationOn(slice(10), AnnotationType::Distance, {{12.5, 30.0}, {92.5, 90.0}});
+                distance.label = "Lesion A";
+                annotations.push_back(distance);
+                annotations.push_back(annotationOn(slice(11), AnnotationType::Angle, {{0.0, 50.0}, {50.0, 50.0}, {50.0, 0.0}}));
+                annotations.push_back(annotationOn(slice(12), AnnotationType::BiDimensional,
+                                                   {{100.0, 100.0}, {160.0, 100.0}, {130.0, 80.0}, {130.0, 120.0}}));
+
+                Annotation contour = annotationOn(slice(13), AnnotationType::Contour,
+                                                  {{10.0, 10.0}, {50.0, 10.0}, {50.0, 40.0}, {10.0, 40.0}});
+                contour.closed = true;
+                annotations.push_back(contour);
+
+                // Frame of a multi-frame instance
+                SlicePlane frame = slice(14);
+                frame.sopClassUID = EnhancedCTImageStorage;
+                frame.frameNumber = 7;
+                annotations.push_back(annotationOn(frame, AnnotationType::Distance, {{0.0, 0.0}, {0.0, 25.0}}));
+                return annotations;
+        }
+
+        std::vector<const isis::gui::measures::Annotation*> pointers(
+                const std::vector<isis::gui::measures::Annotation>& annotations)
+        {
+                std::vector<const isis::gui::measures::Annotation*> result;
+                for (const auto& annotation : annotations)
+                {
+                        result.push_back(&annotation);
+                }
+                return result;
+        }
+
+        void compare(const isis::gui::measures::Annotation& expected, const isis::gui::measures::Annotation& actual,
+                     const std::vector<isis::gui::measures::MeasurementValue>& values, const std::string& name)
+        {
+                using namespace isis::gui::measures;
+
+                require(actual.type == expected.type, name + ": type was not restored.");
+                require(actual.closed == expected.closed, name + ": closed flag was not restored.");
+                require(actual.trackingUID == expected.trackingUID, name + ": tracking UID changed.");
+                require(actual.seriesInstanceUID == expected.seriesInstanceUID, name + ": series was not restored.");
+                require(actual.sopInstanceUID == expected.sopInstanceUID
+                        && actual.sopClassUID == expected.sopClassUID, name + ": source image was not restored.");
+                require(actual.frameOfReferenceUID == expected.frameOfReferenceUID,
+                        name + ": frame of reference was not restored.");
+                require(actual.frameNumber == expected.frameNumber, name + ": frame number was not restored.");
+                require(actual.points.size() == expected.points.size(), name + ": wrong number of points.");
+                for (std::size_t i = 0; i < expected.points.size(); ++i)
+                {
+                        for (int axis = 0; axis < 3; ++axis)
+                        {
+                                require(std::abs(actual.points[i][axis] - expected.points[i][axis]) < CoordinateTolerance,
+                                        name + ": point " + std::to_string(i) + " moved.");
+                        }
+                }
+
+                const auto expectedValues = measurementValues(expected);
+                require(values.size() == expectedValues.size() && !values.empty(), name + ": wrong number of values.");
+                for (std::size_t i = 0; i < values.size(); ++i)
+                {
+                        require(values[i].code == expectedValues[i].code && values[i].scheme == expectedValues[i].scheme
+                                && values[i].unit == expectedValues[i].unit, name + ": value is coded differently.");
+                        require(std::abs(values[i].value - expectedValues[i].value) < ValueTolerance,
+                                name + ": " + values[i].meaning + " is " + std::to_string(values[i].value)
+                                + ", expected " + std::to_string(expectedValues[i].value) + ".");
+                }
+        }
+
+        // Points picked in a 2D view are stored at the patient position of the picked pixel
+        void checkViewGeometry(const isis::gui::measures::MeasurementReportContext& context, const std::string& path)
+        {
+                using namespace isis::gui::measures;
+
+                // Oblique slices 0.7 mm apart in plane, 2.5 mm between slices
+                const double spacing[3] = {0.7, 0.7, 2.5};
+                const Point3 firstPosition = {-120.0, 35.5, 210.0};
+                constexpr int SliceIndex = 6;
+
+                SlicePlane plane = slice(0);
+                plane.row = {0.8, 0.6, 0.0};
+                plane.column = {0.0, 0.0, -1.0};
+                const Point3 normal = plane.normal();
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        plane.origin[axis] = firstPosition[axis] + SliceIndex * spacing[2] * normal[axis];
+                }
+
+                // The loader puts the volume origin at the first Image Position; the view may add the orientation
+                for (const bool oriented : {false, true})
+                {
+                        auto image = vtkSmartPointer<vtkImageData>::New();
+                        image->SetDimensions(512, 512, 12);
+                        image->SetSpacing(spacing);
+                        image->SetOrigin(firstPosition.data());
+                        if (oriented)
+                        {
+                                image->SetDirectionMatrix(plane.row[0], plane.column[0], normal[0],
+                                                          plane.row[1], plane.column[1], normal[1],
+                                                          plane.row[2], plane.column[2], normal[2]);
+                        }
+                        const std::string name = oriented ? "Oriented view" : "View";
+
+                        Annotation annotation = annotationOn(plane, AnnotationType::Distance, {});
+                        std::vector<Point3> expected;
+                        const std::array<std::array<double, 2>, 2> pixels = {{{100.0, 200.0}, {250.5, 310.25}}};
+                        for (const auto& pixel : pixels)
+                        {
+                                const double index[3] = {pixel[0], pixel[1], static_cast<double>(SliceIndex)};
+                                std::array<double, 3> world = {};
+                                image->TransformContinuousIndexToPhysicalPoint(index, world.data());
+                                annotation.points.push_back(worldToPatient(plane, image, world));
+                                expected.push_back(plane.toPatient(pixel[0] * spacing[0], pixel[1] * spacing[1]));
+
+                                const auto back = patientToWorld(plane, image, SliceIndex, annotation.points.back());
+                                for (int axis = 0; axis < 3; ++axis)
+                                {
+                                        require(std::abs(back[axis] - world[axis]) < 1e-6,
+                                                name + ": patient position does not map back to the picked pixel.");
+                                }
+                        }
+
+                        std::string error;
+                        require(writeMeasurementReport(context, {&annotation}, path, error),
+                                name + ": report was not written: " + error);
+                        MeasurementReport report;
+                        require(readMeasurementReport(path, report, error) && report.annotations.size() == 1,
+                                name + ": report was not read: " + error);
+                        const auto& points = report.annotations[0].points;
+                        require(points.size() == expected.size(), name + ": wrong number of points.");
+                        for (std::size_t i = 0; i < expected.size(); ++i)
+                        {
+                                for (int axis = 0; axis < 3; ++axis)
+                                {
+                                        require(std::abs(points[i][axis] - expected[i][axis]) < CoordinateTolerance,
+                                                name + ": point " + std::to_string(i) + " is not at the picked pixel.");
+                                }
+                        }
+                }
+        }
+}
+
+int main()
+{
+        using namespace isis::gui::measures;
+
+        try
+        {
+                int argc = 1;
+                char appName[] = "measurementreport_test";
+                char* argv[] = {appName, nullptr};
+                QCoreApplication app(argc, argv);
+
+                const auto tempRoot = std::filesystem::temp_directory_path() / "isis_measurement_report";
+                std::filesystem::remove_all(tempRoot);
+                std::filesystem::create_directories(tempRoot);
+
+                // Values derived from the geometry
+                const auto annotations = sampleAnnotations();
+                require(std::abs(measurementValues(annotations[0])[0].value - 100.0) < 1e-9, "Distance is wrong.");
+                require(std::abs(measurementValues(annotations[1])[0].value - 90.0) < 1e-9, "Angle is wrong.");
+                const auto bidimensional = measurementValues(annotations[2]);
+                require(std::abs(bidimensional[0].value - 60.0) < 1e-9 && std::abs(bidimensional[1].value - 40.0) < 1e-9,
+                        "Axes are wrong.");
+                const auto contour = measurementValues(annotations[3]);
+                require(std::abs(contour[0].value - 1200.0) < 1e-9 && std::abs(contour[1].value - 140.0) < 1e-9,
+                        "Area or perimeter is wrong.");
+
+                // Write and read back
+                MeasurementReportContext context;
+                context.patientName = "Report^Round^Trip";
+                context.patientID = "SR092";
+                context.studyInstanceUID = "1.2.826.0.1.3680043.9.7433.92.4";
+                context.studyDate = "20250102";
+                context.seriesInstanceUID = SeriesUID;
+
+                const std::string path = (tempRoot / "report.dcm").string();
+                std::string error;
+                require(writeMeasurementReport(context, pointers(annotations), path, error),
+                        "Report was not written: " + error);
+
+                MeasurementReport report;
+                require(readMeasurementReport(path, report, error), "Report was not read: " + error);
+                require(report.context.patientID == context.patientID
+                        && report.context.studyInstanceUID == context.studyInstanceUID,
+                        "Report is not in the source study.");
+                require(report.context.seriesInstanceUID == SeriesUID, "Evidence does not list the source series.");
+                require(report.annotations.size() == annotations.size() && report.values.size() == annotations.size(),
+                        "Report holds " + std::to_string(report.annotations.size()) + " of "
+                        + std::to_string(annotations.size()) + " measurements.");
+                for (std::size_t i = 0; i < annotations.size(); ++i)
+                {
+                        compare(annotations[i], report.annotations[i], report.values[i],
+                                "Measurement " + std::to_string(i + 1));
+                }
+                require(report.annotations[0].label == "Lesion A", "Label was not restored.");
+
+                // Reports without a source frame of reference still carry 3D coordinates
+                std::vector<Annotation> withoutFrame = {annotations[0]};
+                withoutFrame[0].frameOfReferenceUID.clear();
+                require(writeMeasurementReport(context, pointers(withoutFrame), path, error),
+                        "Report without a frame of reference was not written: " + error);
+                require(readMeasurementReport(path, report, error) && report.annotations.size() == 1
+                        && !report.annotations[0].frameOfReferenceUID.empty(),
+                        "Report without a frame of reference did not round-trip.");
+
+                checkViewGeometry(context, path);
+
+                // Service: repeated exports of one file are coalesced, imports arrive in batches
+                MeasurementReportService service;
+                std::vector<Annotation> imported;
+                int batches = 0;
+                QObject::connect(&service, &MeasurementReportService::annotationsImported,
+                        [&](const std::vector<Annotation>& batch)
+                        {
+                                imported.insert(imported.end(), batch.begin(), batch.end());
+                                ++batches;
+                        });
+
+                std::vector<QString> reportPaths;
+                for (int i = 0; i < 3; ++i)
+                {
+                        const QString reportPath = QString::fromStdString(
+                                (tempRoot / ("series" + std::to_string(i)) / "SR.dcm").string());
+                        service.exportReport(context, {annotations[0]}, reportPath);
+                        service.exportReport(context, annotations, reportPath);
+                        reportPaths.push_back(reportPath);
+                }
+                service.waitForDone();
+
+                for (const QString& reportPath : reportPaths)
+                {
+                        service.importReport(reportPath);
+                }
+                service.importReport(QString::fromStdString((tempRoot / "missing.dcm").string()));
+                service.waitForDone();
+
+                QEventLoop loop;
+                QTimer::singleShot(0, &loop, &QEventLoop::quit);
+                loop.exec();
+                QCoreApplication::processEvents();
+
+                require(imported.size() == 3 * annotations.size(),
+                        "Service imported " + std::to_string(imported.size()) + " measurements; the latest export of "
+                        + "each file should hold " + std::to_string(annotations.size()) + ".");
+                require(batches >= 1 && batches <= 3, "Imports were not batched.");
+                compare(annotations[3], imported[3], measurementValues(imported[3]), "Imported contour");
+
+                std::filesystem::remove_all(tempRoot);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "measurementreport_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "measurementreport_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: slicepositionindex_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks the slice position index used by viewport linking: the nearest
+ *      slice found by binary search matches a full scan in a logarithmic number
+ *      of comparisons, points beyond the series have no slice, and reference
+ *      lines of crossing planes land where expected while parallel planes give
+ *      none.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/gui/slicepositionindex.h"
+#include "tests/testsupport.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        constexpr double Tolerance = 1e-6;
+        const std::string FrameOfReference = "1.2.826.0.1.3680043.9.7433.93.1";
+
+        using isis::tests::require;
+
+        isis::gui::SliceGeometry axial(double z)
+        {
+                isis::gui::SliceGeometry slice;
+                slice.origin = {-125.0, -125.0, z};
+                slice.row = {1.0, 0.0, 0.0};
+                slice.column = {0.0, 1.0, 0.0};
+                slice.spacingX = 0.5;
+                slice.spacingY = 0.5;
+                slice.columns = 512;
+                slice.rows = 512;
+                return slice;
+        }
+
+        isis::gui::SliceGeometry sagittal(double x)
+        {
+                isis::gui::SliceGeometry slice;
+                slice.origin = {x, -125.0, 100.0};
+                slice.row = {0.0, 1.0, 0.0};
+                slice.column = {0.0, 0.0, -1.0};
+                slice.spacingX = 1.0;
+                slice.spacingY = 1.0;
+                slice.columns = 250;
+                slice.rows = 200;
+                return slice;
+        }
+
+        int nearestByScan(const std::vector<isis::gui::SliceGeometry>& slices, double z)
+        {
+                int best = 0;
+                for (std::size_t i = 1; i < slices.size(); ++i)
+                {
+                        if (std::abs(slices[i].origin[2] - z) < std::abs(slices[best].origin[2] - z))
+                        {
+                                best = static_cast<int>(i);
+                        }
+                }
+                return best;
+        }
+}
+
+int main()
+{
+        using namespace isis::gui;
+
+        try
+        {
+                // Slices given out of order, 2.5 mm apart, from z = -200
+                constexpr int sliceCount = 300;
+                std::vector<SliceGeometry> slices;
+                for (int i = 0; i < sliceCount; ++i)
+                {
+                        slices.push_back(axial(-200.0 + ((i * 37) % sliceCount) * 2.5));
+                }
+                const SlicePositionIndex index(FrameOfReference, slices);
+                require(index.isValid() && index.size() == slices.size(), "Index is empty.");
+                require(std::abs(index.sliceSpacing() - 2.5) < Tolerance,
+                        "Slice spacing is " + std::to_string(index.sliceSpacing()) + ", expected 2.5.");
+
+                const auto maxComparisons = static_cast<std::size_t>(std::ceil(std::log2(sliceCount))) + 1;
+                std::mt19937 generator(93);
+                std::uniform_real_distribution<double> positions(-201.0, 548.5);
+                for (int i = 0; i < 2000; ++i)
+                {
+                        const double z = positions(generator);
+                        const auto frame = index.nearestFrame({10.0, -30.0, z});
+                        require(frame.has_value(), "No slice found at z = " + std::to_string(z) + ".");
+                        require(std::abs(slices[*frame].origin[2] - z)
+                                <= std::abs(slices[nearestByScan(slices, z)].origin[2] - z) + Tolerance,
+                                "Slice at z = " + std::to_string(z) + " is not the nearest.");
+                        require(index.lastComparisons() <= maxComparisons,
+                                "Lookup took " + std::to_string(index.lastComparisons()) + " comparisons.");
+                }
+
+                // Exact positions map to their own frame
+                for (int frame = 0; frame < sliceCount; frame += 17)
+                {
+                        require(index.nearestFrame(slices[frame].center()) == frame, "Slice does not map to itself.");
+                }
+
+                // Beyond half a slice outside the series
+                require(!index.nearestFrame({0.0, 0.0, -203.0}).has_value(), "Point below the series has a slice.");
+                require(!index.nearestFrame({0.0, 0.0, 551.0}).has_value(), "Point above the series has a slice.");
+                require(!SlicePositionIndex().nearestFrame({0.0, 0.0, 0.0}).has_value(), "Empty index has a slice.");
+
+                // Sagittal plane at x = 0 crosses the axial image at column 250, top to bottom
+                const auto line = referenceLine(axial(0.0), sagittal(0.0));
+                require(line.has_value(), "Orthogonal planes have no reference line.");
+                require(std::abs((*line)[0] - 250.5) < Tolerance && std::abs((*line)[2] - 250.5) < Tolerance,
+                        "Reference line is not at column 250.");
+                require(std::abs(std::abs((*line)[3] - (*line)[1]) - 499.5) < Tolerance,
+                        "Reference line does not span the sagittal extent.");
+
+                // Axial plane at z = 0 crosses the sagittal image at row 100, across its width
+                const auto back = referenceLine(sagittal(0.0), axial(0.0));
+                require(back.has_value() && std::abs((*back)[1] - 100.5) < Tolerance
+                        && std::abs((*back)[3] - 100.5) < Tolerance, "Axial line is not at row 100.");
+                require(std::abs(std::abs((*back)[2] - (*back)[0]) - 249.75) < Tolerance,
+                        "Axial line does not span the sagittal image.");
+
+                // Parallel planes, and planes that miss the image
+                require(!referenceLine(axial(0.0), axial(10.0)).has_value(), "Parallel planes have a reference line.");
+                require(!referenceLine(sagittal(0.0), axial(150.0)).has_value(),
+                        "Plane above the image has a reference line.");
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "slicepositionindex_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "slicepositionindex_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
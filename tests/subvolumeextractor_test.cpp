@@ -0,0 +1,187 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: subvolumeextractor_test.cpp
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Checks the 3D crop extraction: physical bounds map to the voxel box,
+ *      the copied voxels and geometry match the full volume with and without
+ *      downsampling, and a shrinking box is copied from the last result into
+ *      a reused buffer.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#include "src/core/subvolumeextractor.h"
+#include "tests/testsupport.h"
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+        using isis::core::SubVolumeExtractor;
+
+        constexpr int Width = 64;
+        constexpr int Height = 48;
+        constexpr int Slices = 40;
+
+        using isis::tests::require;
+
+        short voxelValue(int x, int y, int z)
+        {
+                return static_cast<short>(x + 100 * y + 10000 * (z % 3) - z);
+        }
+
+        vtkSmartPointer<vtkImageData> makeVolume()
+        {
+                auto image = vtkSmartPointer<vtkImageData>::New();
+                image->SetDimensions(Width, Height, Slices);
+                image->SetSpacing(0.5, 0.5, 2.0);
+                image->SetOrigin(-16.0, 10.0, 100.0);
+                image->AllocateScalars(VTK_SHORT, 1);
+                image->GetPointData()->GetScalars()->SetName("Scalars");
+                auto* voxels = static_cast<short*>(image->GetScalarPointer());
+                for (int z = 0; z < Slices; ++z)
+                {
+                        for (int y = 0; y < Height; ++y)
+                        {
+                                for (int x = 0; x < Width; ++x)
+                                {
+                                        *voxels++ = voxelValue(x, y, z);
+                                }
+                        }
+                }
+                return image;
+        }
+
+        void checkCrop(vtkImageData* full, vtkImageData* crop, const int extent[6], int stride)
+        {
+                int dimensions[3] = {};
+                crop->GetDimensions(dimensions);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        require(dimensions[axis] == (extent[2 * axis + 1] - extent[2 * axis]) / stride + 1,
+                                "Crop dimensions wrong.");
+                        require(std::abs(crop->GetSpacing()[axis] - full->GetSpacing()[axis] * stride) < 1e-9,
+                                "Crop spacing wrong.");
+                }
+                require(std::string(crop->GetPointData()->GetScalars()->GetName()) == "Scalars",
+                        "Crop lost the scalar name.");
+
+                // Every kept voxel sits where it was in the full volume
+                for (int z = 0; z < dimensions[2]; ++z)
+                {
+                        for (int y = 0; y < dimensions[1]; ++y)
+                        {
+                                for (int x = 0; x < dimensions[0]; ++x)
+                                {
+                                        const int source[3] = {
+                                                extent[0] + x * stride, extent[2] + y * stride, extent[4] + z * stride};
+                                        const short value = *static_cast<short*>(crop->GetScalarPointer(x, y, z));
+                                        require(value == voxelValue(source[0], source[1], source[2]), "Crop voxel differs.");
+                                }
+                        }
+                }
+                double expected[3] = {};
+                double actual[3] = {};
+                const int first[3] = {extent[0], extent[2], extent[4]};
+                const int origin[3] = {0, 0, 0};
+                full->TransformIndexToPhysicalPoint(first, expected);
+                crop->TransformIndexToPhysicalPoint(origin, actual);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                        require(std::abs(expected[axis] - actual[axis]) < 1e-9, "Crop moved in space.");
+                }
+        }
+
+        void checkBounds(vtkImageData* full)
+        {
+                // Half a voxel either side still covers the voxel
+                const double bounds[6] = {-16.0 + 0.5 * 10.2, -16.0 + 0.5 * 20.7, 10.0, 12.0, 90.0, 110.0};
+                int extent[6] = {};
+                require(SubVolumeExtractor::extentFromBounds(full, bounds, extent), "Bounds missed the volume.");
+                require(extent[0] == 10 && extent[1] == 21 && extent[2] == 0 && extent[3] == 4
+                        && extent[4] == 0 && extent[5] == 5, "Bounds mapped to the wrong voxels.");
+
+                const double outside[6] = {500.0, 600.0, 10.0, 12.0, 100.0, 110.0};
+                require(!SubVolumeExtractor::extentFromBounds(full, outside, extent), "Bounds outside the volume accepted.");
+        }
+
+        void checkExtraction(vtkImageData* full)
+        {
+                SubVolumeExtractor extractor;
+                const int first[6] = {4, 59, 2, 45, 1, 38};
+                const auto crop = extractor.extract(full, first, 1, 4);
+                require(crop && !extractor.lastWasIncremental(), "First crop not taken from the full volume.");
+                checkCrop(full, crop, first, 1);
+
+                // A smaller box comes from the last crop and needs no full volume
+                const int second[6] = {10, 40, 5, 30, 8, 20};
+                require(extractor.canReuseLast(second, 1), "Smaller box not reused.");
+                const auto smaller = extractor.extract(nullptr, second, 1, 4);
+                require(smaller && extractor.lastWasIncremental(), "Smaller box not copied from the last crop.");
+                checkCrop(full, smaller, second, 1);
+                checkCrop(full, crop, first, 1);
+
+                // The buffer of the first crop is reused for the next one
+                const void* const firstBuffer = crop->GetScalarPointer();
+                const int third[6] = {12, 30, 6, 20, 10, 18};
+                const auto smallest = extractor.extract(nullptr, third, 1, 4);
+                require(smallest && smallest->GetScalarPointer() == firstBuffer, "Shrinking box allocated a new buffer.");
+                checkCrop(full, smallest, third, 1);
+
+                // A larger box goes back to the full volume
+                const int larger[6] = {0, 63, 0, 47, 0, 39};
+                require(!extractor.canReuseLast(larger, 1), "Larger box reused the last crop.");
+                require(!extractor.extract(nullptr, larger, 1), "Larger box extracted without the full volume.");
+                const auto whole = extractor.extract(full, larger, 1);
+                require(whole && !extractor.lastWasIncremental(), "Larger box not taken from the full volume.");
+                checkCrop(full, whole, larger, 1);
+
+                // Downsampled crops, then a shrink on the kept voxels
+                const int sampled[6] = {1, 62, 3, 44, 0, 39};
+                const auto coarse = extractor.extract(full, sampled, 2, 4);
+                require(coarse && !extractor.lastWasIncremental(), "Downsampled crop not taken from the full volume.");
+                checkCrop(full, coarse, sampled, 2);
+                const int inner[6] = {5, 41, 7, 40, 4, 30};
+                require(extractor.canReuseLast(inner, 2), "Aligned smaller box not reused.");
+                const auto coarseInner = extractor.extract(nullptr, inner, 2, 4);
+                require(coarseInner && extractor.lastWasIncremental(), "Aligned smaller box not reused.");
+                checkCrop(full, coarseInner, inner, 2);
+                const int misaligned[6] = {6, 41, 7, 40, 4, 30};
+                require(!extractor.canReuseLast(misaligned, 2), "Box between kept voxels reused.");
+
+                extractor.reset();
+                require(!extractor.canReuseLast(inner, 2), "Reset kept the last crop.");
+                checkCrop(full, coarseInner, inner, 2);
+        }
+}
+
+int main()
+{
+        try
+        {
+                const auto full = makeVolume();
+                checkBounds(full);
+                checkExtraction(full);
+        }
+        catch (const std::exception& ex)
+        {
+                std::cerr << "subvolumeextractor_test failed: " << ex.what() << '\n';
+                return EXIT_FAILURE;
+        }
+
+        std::cout << "subvolumeextractor_test passed" << std::endl;
+        return EXIT_SUCCESS;
+}
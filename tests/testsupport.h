@@ -0,0 +1,33 @@
+/*
+ * ------------------------------------------------------------------------------------
+ *  File: testsupport.h
+ *  Project: Isis DICOM Viewer
+ *
+ *  Copyright (c) 2025  Thales Matheus Mendonca Santos
+ *
+ *  Description:
+ *      Check helper shared by the standalone regression tests.
+ *
+ *  License:
+ *      Apache License 2.0
+ * ------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace isis::tests
+{
+        /**
+         * @brief Fail the test with message unless condition holds
+         */
+        inline void require(bool condition, const std::string& message)
+        {
+                if (!condition)
+                {
+                        throw std::runtime_error(message);
+                }
+        }
+} // namespace isis::tests